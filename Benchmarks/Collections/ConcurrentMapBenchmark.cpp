@@ -0,0 +1,203 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the library is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_SUPPORT_SOURCE 1
+
+#include "Nuclex/Support/Config.h"
+#include "Nuclex/Support/Collections/ConcurrentHashMap.h"
+
+#include <atomic> // for std::atomic
+#include <thread> // for std::thread
+#include <vector> // for std::vector
+#include <mutex> // for std::mutex
+#include <unordered_map> // for std::unordered_map
+
+#include <celero/Celero.h>
+
+namespace {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Number of distinct keys the benchmarked operations pick from</summary>
+  const std::size_t KeyCount = 4096;
+
+  /// <summary>Number of operations each thread performs on the map</summary>
+  const std::size_t OperationsPerThread = 65536;
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Standard unordered map guarded by a mutex, the usual way to share a map</summary>
+  /// <typeparam name="TKey">Type of the key the map uses</typeparam>
+  /// <typeparam name="TValue">Type of values that are stored in the map</typeparam>
+  template<typename TKey, typename TValue>
+  class MutexUnorderedMap {
+
+    /// <summary>Tries to insert an element into the map</summary>
+    /// <param name="key">Key under which the value will be stored</param>
+    /// <param name="value">Value that will be stored</param>
+    /// <returns>True if the element was inserted, false if the key already existed</returns>
+    public: bool TryInsert(const TKey &key, const TValue &value) {
+      std::lock_guard<std::mutex> mapLock(this->mutex);
+      return this->map.emplace(key, value).second;
+    }
+
+    /// <summary>Tries to look up an element in the map</summary>
+    /// <param name="key">Key of the element that will be looked up</param>
+    /// <param name="value">Receives a copy of the value stored in the map</param>
+    /// <returns>True if the element was found, false otherwise</returns>
+    public: bool TryGet(const TKey &key, TValue &value) {
+      std::lock_guard<std::mutex> mapLock(this->mutex);
+      typename std::unordered_map<TKey, TValue>::const_iterator iterator = this->map.find(key);
+      if(iterator == this->map.end()) {
+        return false;
+      }
+      value = iterator->second;
+      return true;
+    }
+
+    /// <summary>Removes the specified element from the map if it exists</summary>
+    /// <param name="key">Key of the element that will be removed</param>
+    /// <returns>True if the element was removed, false if it didn't exist</returns>
+    public: bool TryRemove(const TKey &key) {
+      std::lock_guard<std::mutex> mapLock(this->mutex);
+      return (this->map.erase(key) > 0);
+    }
+
+    /// <summary>Mutex that serializes all accesses to the map</summary>
+    private: std::mutex mutex;
+    /// <summary>Map that is being shared</summary>
+    private: std::unordered_map<TKey, TValue> map;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Runs a mix of mostly lookups with a few insertions and removals on a map</summary>
+  /// <typeparam name="TMap">Type of map that will be benchmarked</typeparam>
+  /// <param name="threadCount">Number of threads accessing the map at the same time</param>
+  /// <returns>
+  ///   A value dependent on the operation that can be used to prevent the optimizer
+  ///   from optimizing the entire method call away
+  /// </returns>
+  template<typename TMap>
+  std::size_t accessReadMostly(std::size_t threadCount) {
+    TMap map;
+    for(std::size_t key = 0; key < KeyCount; key += 2) {
+      map.TryInsert(key, key);
+    }
+
+    std::atomic<std::size_t> result(0);
+    std::atomic<bool> startSignal(false);
+
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount);
+    for(std::size_t thread = 0; thread < threadCount; ++thread) {
+      threads.emplace_back(
+        [&, thread] {
+          while(!startSignal.load(std::memory_order_acquire)) {
+            std::this_thread::yield();
+          }
+
+          // One in sixteen operations modifies the map, the rest are lookups
+          std::size_t sum = 0;
+          std::size_t key = thread * 977;
+          for(std::size_t index = 0; index < OperationsPerThread; ++index) {
+            key = (key + 2654435761U) & (KeyCount - 1);
+            if((index & 15) == 0) {
+              if(!map.TryInsert(key, key)) {
+                map.TryRemove(key);
+              }
+            } else {
+              std::size_t value;
+              if(map.TryGet(key, value)) {
+                sum += value;
+              }
+            }
+          }
+          result.fetch_add(sum, std::memory_order_relaxed);
+        }
+      );
+    }
+
+    startSignal.store(true, std::memory_order_release);
+    for(std::thread &thread : threads) {
+      thread.join();
+    }
+
+    return result.load(std::memory_order_relaxed);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Mutex-guarded unordered map with the keys and values used in the benchmark</summary>
+  typedef MutexUnorderedMap<std::size_t, std::size_t> MutexMap;
+
+  /// <summary>Concurrent hash map with the keys and values used in the benchmark</summary>
+  typedef Nuclex::Support::Collections::ConcurrentHashMap<std::size_t, std::size_t> HashMap;
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // anonymous namespace
+
+namespace Nuclex { namespace Support { namespace Collections {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  BASELINE(MapReadMostlyOneThread, MutexUnorderedMap, 30, 10) {
+    celero::DoNotOptimizeAway(accessReadMostly<MutexMap>(1));
+  }
+
+  BENCHMARK(MapReadMostlyOneThread, ConcurrentHashMap, 30, 10) {
+    celero::DoNotOptimizeAway(accessReadMostly<HashMap>(1));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  BASELINE(MapReadMostlyTwoThreads, MutexUnorderedMap, 30, 10) {
+    celero::DoNotOptimizeAway(accessReadMostly<MutexMap>(2));
+  }
+
+  BENCHMARK(MapReadMostlyTwoThreads, ConcurrentHashMap, 30, 10) {
+    celero::DoNotOptimizeAway(accessReadMostly<HashMap>(2));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  BASELINE(MapReadMostlyFourThreads, MutexUnorderedMap, 30, 10) {
+    celero::DoNotOptimizeAway(accessReadMostly<MutexMap>(4));
+  }
+
+  BENCHMARK(MapReadMostlyFourThreads, ConcurrentHashMap, 30, 10) {
+    celero::DoNotOptimizeAway(accessReadMostly<HashMap>(4));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  BASELINE(MapReadMostlyEightThreads, MutexUnorderedMap, 30, 10) {
+    celero::DoNotOptimizeAway(accessReadMostly<MutexMap>(8));
+  }
+
+  BENCHMARK(MapReadMostlyEightThreads, ConcurrentHashMap, 30, 10) {
+    celero::DoNotOptimizeAway(accessReadMostly<HashMap>(8));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Collections
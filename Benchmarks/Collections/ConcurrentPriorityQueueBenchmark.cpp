@@ -0,0 +1,202 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the library is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_SUPPORT_SOURCE 1
+
+#include "Nuclex/Support/Config.h"
+#include "Nuclex/Support/Collections/ConcurrentPriorityQueue.h"
+#include "Nuclex/Support/Collections/ConcurrentMultiQueue.h"
+
+#include <atomic> // for std::atomic
+#include <thread> // for std::thread
+#include <vector> // for std::vector
+#include <mutex> // for std::mutex
+#include <queue> // for std::priority_queue
+#include <functional> // for std::greater
+
+#include <celero/Celero.h>
+
+namespace {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Number of elements each producer thread appends to the queue</summary>
+  const std::size_t ElementsPerProducer = 16384;
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Standard priority queue guarded by a mutex, the usual way to share one</summary>
+  /// <typeparam name="TElement">Type of elements that will be stored in the queue</typeparam>
+  template<typename TElement>
+  class MutexPriorityQueue {
+
+    /// <summary>Appends an element to the queue</summary>
+    /// <param name="element">Element that will be appended</param>
+    /// <returns>True if the element was appended</returns>
+    public: bool TryAppend(const TElement &element) {
+      std::lock_guard<std::mutex> queueLock(this->mutex);
+      this->queue.push(element);
+      return true;
+    }
+
+    /// <summary>Tries to take the smallest element from the queue</summary>
+    /// <param name="element">Receives the element taken from the queue</param>
+    /// <returns>True if an element was taken, false if the queue was empty</returns>
+    public: bool TryTakeMin(TElement &element) {
+      std::lock_guard<std::mutex> queueLock(this->mutex);
+      if(this->queue.empty()) {
+        return false;
+      }
+      element = this->queue.top();
+      this->queue.pop();
+      return true;
+    }
+
+    /// <summary>Mutex that serializes all accesses to the queue</summary>
+    private: std::mutex mutex;
+    /// <summary>Queue that is being shared</summary>
+    private: std::priority_queue<
+      TElement, std::vector<TElement>, std::greater<TElement>
+    > queue;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Moves elements through a priority queue from producers to consumers</summary>
+  /// <typeparam name="TQueue">Type of priority queue that will be benchmarked</typeparam>
+  /// <param name="threadPairCount">Number of producer threads and of consumer threads</param>
+  /// <returns>
+  ///   A value dependent on the operation that can be used to prevent the optimizer
+  ///   from optimizing the entire method call away
+  /// </returns>
+  template<typename TQueue>
+  std::size_t transferElements(std::size_t threadPairCount) {
+    TQueue queue;
+    std::atomic<std::size_t> takenCount(0);
+    std::atomic<std::size_t> result(0);
+    std::atomic<bool> startSignal(false);
+
+    const std::size_t totalCount = ElementsPerProducer * threadPairCount;
+
+    std::vector<std::thread> threads;
+    threads.reserve(threadPairCount * 2);
+    for(std::size_t thread = 0; thread < threadPairCount; ++thread) {
+      threads.emplace_back(
+        [&, thread] {
+          while(!startSignal.load(std::memory_order_acquire)) {
+            std::this_thread::yield();
+          }
+
+          // Scrambled priorities, like deadlines of tasks scheduled from different places
+          for(std::size_t index = 0; index < ElementsPerProducer; ++index) {
+            queue.TryAppend((index * 7919 + thread) & 0xFFFFF);
+          }
+        }
+      );
+      threads.emplace_back(
+        [&] {
+          while(!startSignal.load(std::memory_order_acquire)) {
+            std::this_thread::yield();
+          }
+
+          std::size_t sum = 0;
+          std::size_t element;
+          while(takenCount.load(std::memory_order_relaxed) < totalCount) {
+            if(queue.TryTakeMin(element)) {
+              sum += element;
+              takenCount.fetch_add(1, std::memory_order_relaxed);
+            }
+          }
+          result.fetch_add(sum, std::memory_order_relaxed);
+        }
+      );
+    }
+
+    startSignal.store(true, std::memory_order_release);
+    for(std::thread &thread : threads) {
+      thread.join();
+    }
+
+    return result.load(std::memory_order_relaxed);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Mutex-guarded priority queue with the elements used in the benchmark</summary>
+  typedef MutexPriorityQueue<std::size_t> MutexQueue;
+
+  /// <summary>Skip list priority queue with the elements used in the benchmark</summary>
+  typedef Nuclex::Support::Collections::ConcurrentPriorityQueue<std::size_t> SkipListQueue;
+
+  /// <summary>Relaxed priority queue with the elements used in the benchmark</summary>
+  typedef Nuclex::Support::Collections::ConcurrentMultiQueue<std::size_t> MultiQueue;
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // anonymous namespace
+
+namespace Nuclex { namespace Support { namespace Collections {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  BASELINE(PriorityQueueTransferOneThreadPair, MutexPriorityQueue, 30, 10) {
+    celero::DoNotOptimizeAway(transferElements<MutexQueue>(1));
+  }
+
+  BENCHMARK(PriorityQueueTransferOneThreadPair, ConcurrentPriorityQueue, 30, 10) {
+    celero::DoNotOptimizeAway(transferElements<SkipListQueue>(1));
+  }
+
+  BENCHMARK(PriorityQueueTransferOneThreadPair, ConcurrentMultiQueue, 30, 10) {
+    celero::DoNotOptimizeAway(transferElements<MultiQueue>(1));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  BASELINE(PriorityQueueTransferFourThreadPairs, MutexPriorityQueue, 30, 10) {
+    celero::DoNotOptimizeAway(transferElements<MutexQueue>(4));
+  }
+
+  BENCHMARK(PriorityQueueTransferFourThreadPairs, ConcurrentPriorityQueue, 30, 10) {
+    celero::DoNotOptimizeAway(transferElements<SkipListQueue>(4));
+  }
+
+  BENCHMARK(PriorityQueueTransferFourThreadPairs, ConcurrentMultiQueue, 30, 10) {
+    celero::DoNotOptimizeAway(transferElements<MultiQueue>(4));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  BASELINE(PriorityQueueTransferSixteenThreadPairs, MutexPriorityQueue, 30, 10) {
+    celero::DoNotOptimizeAway(transferElements<MutexQueue>(16));
+  }
+
+  BENCHMARK(PriorityQueueTransferSixteenThreadPairs, ConcurrentPriorityQueue, 30, 10) {
+    celero::DoNotOptimizeAway(transferElements<SkipListQueue>(16));
+  }
+
+  BENCHMARK(PriorityQueueTransferSixteenThreadPairs, ConcurrentMultiQueue, 30, 10) {
+    celero::DoNotOptimizeAway(transferElements<MultiQueue>(16));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Collections
@@ -0,0 +1,211 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the library is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_SUPPORT_SOURCE 1
+
+#include "Nuclex/Support/Config.h"
+#include "Nuclex/Support/Collections/ConcurrentSegmentedQueue.h"
+#include "Nuclex/Support/Collections/ConcurrentRingBuffer.h"
+
+#include <atomic> // for std::atomic
+#include <thread> // for std::thread
+#include <vector> // for std::vector
+
+#include <concurrentqueue.h> // for moodycamel::ConcurrentQueue
+#include <celero/Celero.h>
+
+namespace {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Number of elements each producer thread appends to the queue</summary>
+  const std::size_t ElementsPerProducer = 65536;
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Adapts moodycamel's ConcurrentQueue to the ConcurrentCollection methods</summary>
+  /// <typeparam name="TElement">Type of elements that will be stored in the queue</typeparam>
+  template<typename TElement>
+  class MoodyCamelQueue {
+
+    /// <summary>Appends an element to the queue</summary>
+    /// <param name="element">Element that will be appended</param>
+    /// <returns>True if the element was appended</returns>
+    public: bool TryAppend(const TElement &element) {
+      return this->queue.enqueue(element);
+    }
+
+    /// <summary>Tries to take an element from the queue</summary>
+    /// <param name="element">Receives the element taken from the queue</param>
+    /// <returns>True if an element was taken, false if the queue was empty</returns>
+    public: bool TryTake(TElement &element) {
+      return this->queue.try_dequeue(element);
+    }
+
+    /// <summary>Queue that is being adapted</summary>
+    private: moodycamel::ConcurrentQueue<TElement> queue;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Bounded MPMC ring buffer large enough to never run full in the benchmark</summary>
+  /// <typeparam name="TElement">Type of elements that will be stored in the buffer</typeparam>
+  template<typename TElement>
+  class MpmcRingBuffer : public Nuclex::Support::Collections::ConcurrentRingBuffer<
+    TElement,
+    Nuclex::Support::Collections::ConcurrentAccessBehavior::MultipleProducersMultipleConsumers
+  > {
+
+    /// <summary>Initializes a new ring buffer</summary>
+    public: MpmcRingBuffer() :
+      Nuclex::Support::Collections::ConcurrentRingBuffer<
+        TElement,
+        Nuclex::Support::Collections::ConcurrentAccessBehavior::MultipleProducersMultipleConsumers
+      >(65536) {}
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Moves elements through a queue from producer threads to consumer threads</summary>
+  /// <typeparam name="TQueue">Type of queue that will be benchmarked</typeparam>
+  /// <param name="threadPairCount">Number of producer threads and of consumer threads</param>
+  /// <returns>
+  ///   A value dependent on the operation that can be used to prevent the optimizer
+  ///   from optimizing the entire method call away
+  /// </returns>
+  template<typename TQueue>
+  std::size_t transferElements(std::size_t threadPairCount) {
+    TQueue queue;
+    std::atomic<std::size_t> takenCount(0);
+    std::atomic<std::size_t> result(0);
+    std::atomic<bool> startSignal(false);
+
+    const std::size_t totalCount = ElementsPerProducer * threadPairCount;
+
+    std::vector<std::thread> threads;
+    threads.reserve(threadPairCount * 2);
+    for(std::size_t thread = 0; thread < threadPairCount; ++thread) {
+      threads.emplace_back(
+        [&] {
+          while(!startSignal.load(std::memory_order_acquire)) {
+            std::this_thread::yield();
+          }
+
+          for(std::size_t index = 0; index < ElementsPerProducer; ++index) {
+            while(!queue.TryAppend(index)) {
+              std::this_thread::yield();
+            }
+          }
+        }
+      );
+      threads.emplace_back(
+        [&] {
+          while(!startSignal.load(std::memory_order_acquire)) {
+            std::this_thread::yield();
+          }
+
+          std::size_t sum = 0;
+          std::size_t element;
+          while(takenCount.load(std::memory_order_relaxed) < totalCount) {
+            if(queue.TryTake(element)) {
+              sum += element;
+              takenCount.fetch_add(1, std::memory_order_relaxed);
+            }
+          }
+          result.fetch_add(sum, std::memory_order_relaxed);
+        }
+      );
+    }
+
+    startSignal.store(true, std::memory_order_release);
+    for(std::thread &thread : threads) {
+      thread.join();
+    }
+
+    return result.load(std::memory_order_relaxed);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // anonymous namespace
+
+namespace Nuclex { namespace Support { namespace Collections {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  BASELINE(QueueTransferOneThreadPair, MoodyCamelQueue, 30, 10) {
+    celero::DoNotOptimizeAway(transferElements<MoodyCamelQueue<std::size_t>>(1));
+  }
+
+  BENCHMARK(QueueTransferOneThreadPair, ConcurrentSegmentedQueue, 30, 10) {
+    celero::DoNotOptimizeAway(transferElements<ConcurrentSegmentedQueue<std::size_t>>(1));
+  }
+
+  BENCHMARK(QueueTransferOneThreadPair, ConcurrentRingBuffer, 30, 10) {
+    celero::DoNotOptimizeAway(transferElements<MpmcRingBuffer<std::size_t>>(1));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  BASELINE(QueueTransferTwoThreadPairs, MoodyCamelQueue, 30, 10) {
+    celero::DoNotOptimizeAway(transferElements<MoodyCamelQueue<std::size_t>>(2));
+  }
+
+  BENCHMARK(QueueTransferTwoThreadPairs, ConcurrentSegmentedQueue, 30, 10) {
+    celero::DoNotOptimizeAway(transferElements<ConcurrentSegmentedQueue<std::size_t>>(2));
+  }
+
+  BENCHMARK(QueueTransferTwoThreadPairs, ConcurrentRingBuffer, 30, 10) {
+    celero::DoNotOptimizeAway(transferElements<MpmcRingBuffer<std::size_t>>(2));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  BASELINE(QueueTransferFourThreadPairs, MoodyCamelQueue, 30, 10) {
+    celero::DoNotOptimizeAway(transferElements<MoodyCamelQueue<std::size_t>>(4));
+  }
+
+  BENCHMARK(QueueTransferFourThreadPairs, ConcurrentSegmentedQueue, 30, 10) {
+    celero::DoNotOptimizeAway(transferElements<ConcurrentSegmentedQueue<std::size_t>>(4));
+  }
+
+  BENCHMARK(QueueTransferFourThreadPairs, ConcurrentRingBuffer, 30, 10) {
+    celero::DoNotOptimizeAway(transferElements<MpmcRingBuffer<std::size_t>>(4));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  BASELINE(QueueTransferEightThreadPairs, MoodyCamelQueue, 30, 10) {
+    celero::DoNotOptimizeAway(transferElements<MoodyCamelQueue<std::size_t>>(8));
+  }
+
+  BENCHMARK(QueueTransferEightThreadPairs, ConcurrentSegmentedQueue, 30, 10) {
+    celero::DoNotOptimizeAway(transferElements<ConcurrentSegmentedQueue<std::size_t>>(8));
+  }
+
+  BENCHMARK(QueueTransferEightThreadPairs, ConcurrentRingBuffer, 30, 10) {
+    celero::DoNotOptimizeAway(transferElements<MpmcRingBuffer<std::size_t>>(8));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Collections
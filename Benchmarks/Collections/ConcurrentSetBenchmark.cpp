@@ -0,0 +1,157 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the library is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_SUPPORT_SOURCE 1
+
+#include "Nuclex/Support/Config.h"
+#include "Nuclex/Support/Collections/ConcurrentHashSet.h"
+
+#include <atomic> // for std::atomic
+#include <thread> // for std::thread
+#include <vector> // for std::vector
+
+#include <celero/Celero.h>
+
+namespace {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Number of keys stored in the set</summary>
+  const std::size_t KeyCount = 262144;
+
+  /// <summary>Number of membership checks each thread performs</summary>
+  const std::size_t ChecksPerThread = 262144;
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Hash set without a Bloom filter</summary>
+  class UnfilteredSet : public Nuclex::Support::Collections::ConcurrentHashSet<std::size_t> {
+
+    /// <summary>Initializes a new unfiltered set</summary>
+    public: UnfilteredSet() :
+      Nuclex::Support::Collections::ConcurrentHashSet<std::size_t>(KeyCount) {}
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Hash set with a Bloom filter sized for the number of keys</summary>
+  class FilteredSet : public Nuclex::Support::Collections::ConcurrentHashSet<std::size_t> {
+
+    /// <summary>Initializes a new filtered set</summary>
+    public: FilteredSet() :
+      Nuclex::Support::Collections::ConcurrentHashSet<std::size_t>(KeyCount, KeyCount) {}
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Checks a set for keys, nearly all of which are not in the set</summary>
+  /// <typeparam name="TSet">Type of set that will be benchmarked</typeparam>
+  /// <param name="set">Set that will be checked for keys</param>
+  /// <param name="threadCount">Number of threads checking the set at the same time</param>
+  /// <returns>
+  ///   A value dependent on the operation that can be used to prevent the optimizer
+  ///   from optimizing the entire method call away
+  /// </returns>
+  template<typename TSet>
+  std::size_t checkMostlyMissingKeys(const TSet &set, std::size_t threadCount) {
+    std::atomic<std::size_t> result(0);
+    std::atomic<bool> startSignal(false);
+
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount);
+    for(std::size_t thread = 0; thread < threadCount; ++thread) {
+      threads.emplace_back(
+        [&, thread] {
+          while(!startSignal.load(std::memory_order_acquire)) {
+            std::this_thread::yield();
+          }
+
+          // The set holds every 64th key, so one in 64 checks will be a hit
+          std::size_t foundCount = 0;
+          std::size_t key = thread * 104729;
+          for(std::size_t index = 0; index < ChecksPerThread; ++index) {
+            key = (key + 2654435761U) & (KeyCount * 64 - 1);
+            if(set.Contains(key)) {
+              ++foundCount;
+            }
+          }
+          result.fetch_add(foundCount, std::memory_order_relaxed);
+        }
+      );
+    }
+
+    startSignal.store(true, std::memory_order_release);
+    for(std::thread &thread : threads) {
+      thread.join();
+    }
+
+    return result.load(std::memory_order_relaxed);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Creates a set of the specified type filled with the benchmark's keys</summary>
+  /// <typeparam name="TSet">Type of set that will be created</typeparam>
+  /// <returns>The filled set</returns>
+  template<typename TSet>
+  const TSet &getFilledSet() {
+    static TSet set;
+    static bool isFilled = false;
+    if(!isFilled) {
+      for(std::size_t key = 0; key < KeyCount; ++key) {
+        set.TryInsert(key * 64);
+      }
+      isFilled = true;
+    }
+
+    return set;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // anonymous namespace
+
+namespace Nuclex { namespace Support { namespace Collections {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  BASELINE(SetMostlyMissingOneThread, Unfiltered, 30, 10) {
+    celero::DoNotOptimizeAway(checkMostlyMissingKeys(getFilledSet<UnfilteredSet>(), 1));
+  }
+
+  BENCHMARK(SetMostlyMissingOneThread, BloomFiltered, 30, 10) {
+    celero::DoNotOptimizeAway(checkMostlyMissingKeys(getFilledSet<FilteredSet>(), 1));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  BASELINE(SetMostlyMissingFourThreads, Unfiltered, 30, 10) {
+    celero::DoNotOptimizeAway(checkMostlyMissingKeys(getFilledSet<UnfilteredSet>(), 4));
+  }
+
+  BENCHMARK(SetMostlyMissingFourThreads, BloomFiltered, 30, 10) {
+    celero::DoNotOptimizeAway(checkMostlyMissingKeys(getFilledSet<FilteredSet>(), 4));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Collections
@@ -0,0 +1,233 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the library is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_SUPPORT_SOURCE 1
+
+#include "Nuclex/Support/Config.h"
+#include "Nuclex/Support/Threading/ReaderWriterLock.h"
+#include "Nuclex/Support/Threading/Mutex.h"
+
+#if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+
+#include <atomic> // for std::atomic
+#include <mutex> // for std::mutex
+#include <shared_mutex> // for std::shared_mutex
+#include <thread> // for std::thread
+#include <vector> // for std::vector
+
+#include <celero/Celero.h>
+
+namespace {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Number of times each thread acquires and releases the lock</summary>
+  const std::size_t LockIterationCount = 16384;
+
+  /// <summary>Once per how many iterations a thread takes the exclusive lock</summary>
+  const std::size_t WriteInterval = 256;
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Lets a number of threads hammer a lock with shared and exclusive locks</summary>
+  /// <typeparam name="TLock">Type of lock that will be benchmarked</typeparam>
+  /// <param name="threadCount">Number of threads that will access the lock</param>
+  /// <param name="writeInterval">
+  ///   Once per how many iterations a thread takes the exclusive lock, 0 for never
+  /// </param>
+  /// <returns>
+  ///   A value dependent on the operation that can be used to prevent the optimizer
+  ///   from optimizing the entire method call away
+  /// </returns>
+  template<typename TLock>
+  std::size_t hammerLock(std::size_t threadCount, std::size_t writeInterval) {
+    TLock lock;
+    std::size_t protectedValue = 1;
+    std::atomic<std::size_t> result(0);
+    std::atomic<bool> startSignal(false);
+
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount);
+    for(std::size_t thread = 0; thread < threadCount; ++thread) {
+      threads.emplace_back(
+        [&, thread] {
+          while(!startSignal.load(std::memory_order_acquire)) {
+            std::this_thread::yield();
+          }
+
+          std::size_t sum = 0;
+          for(std::size_t index = 0; index < LockIterationCount; ++index) {
+            if((writeInterval != 0) && (((index + thread) % writeInterval) == 0)) {
+              lock.lock();
+              ++protectedValue;
+              lock.unlock();
+            } else {
+              lock.lock_shared();
+              sum += protectedValue;
+              lock.unlock_shared();
+            }
+          }
+          result.fetch_add(sum, std::memory_order_relaxed);
+        }
+      );
+    }
+
+    startSignal.store(true, std::memory_order_release);
+    for(std::thread &thread : threads) {
+      thread.join();
+    }
+
+    return result.load(std::memory_order_relaxed);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Lets a number of threads increment a counter protected by a mutex</summary>
+  /// <typeparam name="TMutex">Type of mutex that will be benchmarked</typeparam>
+  /// <param name="threadCount">Number of threads that will access the mutex</param>
+  /// <returns>
+  ///   A value dependent on the operation that can be used to prevent the optimizer
+  ///   from optimizing the entire method call away
+  /// </returns>
+  template<typename TMutex>
+  std::size_t hammerMutex(std::size_t threadCount) {
+    TMutex mutex;
+    std::size_t protectedValue = 0;
+
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount);
+    for(std::size_t thread = 0; thread < threadCount; ++thread) {
+      threads.emplace_back(
+        [&mutex, &protectedValue] {
+          for(std::size_t index = 0; index < LockIterationCount; ++index) {
+            std::lock_guard<TMutex> lockScope(mutex);
+            ++protectedValue;
+          }
+        }
+      );
+    }
+    for(std::thread &thread : threads) {
+      thread.join();
+    }
+
+    return protectedValue;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // anonymous namespace
+
+namespace Nuclex { namespace Support { namespace Threading {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  BASELINE(SharedLockOneReader, StdSharedMutex, 30, 10) {
+    celero::DoNotOptimizeAway(hammerLock<std::shared_mutex>(1, 0));
+  }
+
+  BENCHMARK(SharedLockOneReader, ReaderWriterLock, 30, 10) {
+    celero::DoNotOptimizeAway(hammerLock<ReaderWriterLock>(1, 0));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  BASELINE(SharedLockTwoReaders, StdSharedMutex, 30, 10) {
+    celero::DoNotOptimizeAway(hammerLock<std::shared_mutex>(2, 0));
+  }
+
+  BENCHMARK(SharedLockTwoReaders, ReaderWriterLock, 30, 10) {
+    celero::DoNotOptimizeAway(hammerLock<ReaderWriterLock>(2, 0));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  BASELINE(SharedLockFourReaders, StdSharedMutex, 30, 10) {
+    celero::DoNotOptimizeAway(hammerLock<std::shared_mutex>(4, 0));
+  }
+
+  BENCHMARK(SharedLockFourReaders, ReaderWriterLock, 30, 10) {
+    celero::DoNotOptimizeAway(hammerLock<ReaderWriterLock>(4, 0));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  BASELINE(SharedLockEightReaders, StdSharedMutex, 30, 10) {
+    celero::DoNotOptimizeAway(hammerLock<std::shared_mutex>(8, 0));
+  }
+
+  BENCHMARK(SharedLockEightReaders, ReaderWriterLock, 30, 10) {
+    celero::DoNotOptimizeAway(hammerLock<ReaderWriterLock>(8, 0));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  BASELINE(SharedLockSixteenReaders, StdSharedMutex, 30, 10) {
+    celero::DoNotOptimizeAway(hammerLock<std::shared_mutex>(16, 0));
+  }
+
+  BENCHMARK(SharedLockSixteenReaders, ReaderWriterLock, 30, 10) {
+    celero::DoNotOptimizeAway(hammerLock<ReaderWriterLock>(16, 0));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  BASELINE(SharedLockThirtyTwoReaders, StdSharedMutex, 30, 10) {
+    celero::DoNotOptimizeAway(hammerLock<std::shared_mutex>(32, 0));
+  }
+
+  BENCHMARK(SharedLockThirtyTwoReaders, ReaderWriterLock, 30, 10) {
+    celero::DoNotOptimizeAway(hammerLock<ReaderWriterLock>(32, 0));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  BASELINE(SharedLockSixtyFourReaders, StdSharedMutex, 30, 10) {
+    celero::DoNotOptimizeAway(hammerLock<std::shared_mutex>(64, 0));
+  }
+
+  BENCHMARK(SharedLockSixtyFourReaders, ReaderWriterLock, 30, 10) {
+    celero::DoNotOptimizeAway(hammerLock<ReaderWriterLock>(64, 0));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  BASELINE(SharedLockEightThreadsWithWriters, StdSharedMutex, 30, 10) {
+    celero::DoNotOptimizeAway(hammerLock<std::shared_mutex>(8, WriteInterval));
+  }
+
+  BENCHMARK(SharedLockEightThreadsWithWriters, ReaderWriterLock, 30, 10) {
+    celero::DoNotOptimizeAway(hammerLock<ReaderWriterLock>(8, WriteInterval));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  BASELINE(ExclusiveLockFourThreads, StdMutex, 30, 10) {
+    celero::DoNotOptimizeAway(hammerMutex<std::mutex>(4));
+  }
+
+  BENCHMARK(ExclusiveLockFourThreads, Mutex, 30, 10) {
+    celero::DoNotOptimizeAway(hammerMutex<Mutex>(4));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Threading
+
+#endif // defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
@@ -0,0 +1,342 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the library is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_SUPPORT_SOURCE 1
+
+#include "Nuclex/Support/Config.h"
+#include "Nuclex/Support/Threading/ThreadPool.h"
+#include "Nuclex/Support/Threading/Latch.h"
+
+#include <atomic> // for std::atomic
+#include <functional> // for std::ref
+
+#include <celero/Celero.h>
+
+namespace {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Number of fine-grained tasks spawned in each benchmark run</summary>
+  const std::size_t FineGrainedTaskCount = 4096;
+
+  /// <summary>Number of tasks the fine-grained tasks are spawned from</summary>
+  const std::size_t SpawningTaskCount = 16;
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Does a tiny amount of work, like a fine-grained task would</summary>
+  /// <param name="seed">Value from which the result will be calculated</param>
+  /// <param name="result">Accumulator the result will be added to</param>
+  /// <param name="remainingTasks">Latch that will be counted down when done</param>
+  void doFineGrainedWork(
+    std::size_t seed,
+    std::atomic<std::size_t> &result,
+    Nuclex::Support::Threading::Latch &remainingTasks
+  ) {
+    std::size_t value = seed;
+    for(std::size_t index = 0; index < 64; ++index) {
+      value = value * 6364136223846793005ULL + 1442695040888963407ULL;
+    }
+
+    result.fetch_add(value, std::memory_order_relaxed);
+    remainingTasks.CountDown();
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Spawns a large number of fine-grained tasks from within the thread pool</summary>
+  /// <param name="threadPool">Thread pool the tasks will be executed in</param>
+  /// <returns>
+  ///   A value dependent on the operation that can be used to prevent the optimizer
+  ///   from optimizing the entire method call away
+  /// </returns>
+  std::size_t runFineGrainedTasks(Nuclex::Support::Threading::ThreadPool &threadPool) {
+    using Nuclex::Support::Threading::Latch;
+
+    std::atomic<std::size_t> result(0);
+    Latch remainingTasks(FineGrainedTaskCount);
+
+    // The fine-grained tasks are spawned by tasks running in the thread pool,
+    // so they will end up in the worker threads' own deques and get stolen by
+    // the other worker threads.
+    for(std::size_t spawner = 0; spawner < SpawningTaskCount; ++spawner) {
+      threadPool.Schedule(
+        [&threadPool, &result, &remainingTasks, spawner] {
+          std::size_t taskCount = FineGrainedTaskCount / SpawningTaskCount;
+          for(std::size_t task = 0; task < taskCount; ++task) {
+            threadPool.Schedule(
+              &doFineGrainedWork,
+              spawner * taskCount + task, std::ref(result), std::ref(remainingTasks)
+            );
+          }
+        }
+      );
+    }
+
+    remainingTasks.Wait();
+    return result.load(std::memory_order_relaxed);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Submits fine-grained tasks via Schedule(), discarding the futures</summary>
+  /// <param name="threadPool">Thread pool the tasks will be executed in</param>
+  /// <returns>
+  ///   A value dependent on the operation that can be used to prevent the optimizer
+  ///   from optimizing the entire method call away
+  /// </returns>
+  std::size_t scheduleFineGrainedTasks(Nuclex::Support::Threading::ThreadPool &threadPool) {
+    using Nuclex::Support::Threading::Latch;
+
+    std::atomic<std::size_t> result(0);
+    Latch remainingTasks(FineGrainedTaskCount);
+
+    for(std::size_t task = 0; task < FineGrainedTaskCount; ++task) {
+      threadPool.Schedule(
+        &doFineGrainedWork, task, std::ref(result), std::ref(remainingTasks)
+      );
+    }
+
+    remainingTasks.Wait();
+    return result.load(std::memory_order_relaxed);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Submits fine-grained tasks via Post()</summary>
+  /// <param name="threadPool">Thread pool the tasks will be executed in</param>
+  /// <returns>
+  ///   A value dependent on the operation that can be used to prevent the optimizer
+  ///   from optimizing the entire method call away
+  /// </returns>
+  std::size_t postFineGrainedTasks(Nuclex::Support::Threading::ThreadPool &threadPool) {
+    using Nuclex::Support::Threading::Latch;
+
+    std::atomic<std::size_t> result(0);
+    Latch remainingTasks(FineGrainedTaskCount);
+
+    for(std::size_t task = 0; task < FineGrainedTaskCount; ++task) {
+      threadPool.Post(
+        &doFineGrainedWork, task, std::ref(result), std::ref(remainingTasks)
+      );
+    }
+
+    remainingTasks.Wait();
+    return result.load(std::memory_order_relaxed);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Submits fine-grained tasks via PostBulk()</summary>
+  /// <param name="threadPool">Thread pool the tasks will be executed in</param>
+  /// <returns>
+  ///   A value dependent on the operation that can be used to prevent the optimizer
+  ///   from optimizing the entire method call away
+  /// </returns>
+  std::size_t postFineGrainedTasksInBulk(Nuclex::Support::Threading::ThreadPool &threadPool) {
+    using Nuclex::Support::Threading::Latch;
+
+    std::atomic<std::size_t> result(0);
+    Latch remainingTasks(FineGrainedTaskCount);
+
+    threadPool.PostBulk(
+      FineGrainedTaskCount,
+      [&result, &remainingTasks](std::size_t task) {
+        doFineGrainedWork(task, result, remainingTasks);
+      }
+    );
+
+    remainingTasks.Wait();
+    return result.load(std::memory_order_relaxed);
+  }
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Number of elements processed by the data-parallel benchmarks</summary>
+  const std::size_t ParallelElementCount = 65536;
+
+  /// <summary>Number of elements per task when splitting work by hand</summary>
+  const std::size_t ParallelGrainSize = 256;
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Does a little bit of work on a range of elements</summary>
+  /// <param name="begin">Index of the first element that will be processed</param>
+  /// <param name="end">Index one past the last element that will be processed</param>
+  /// <param name="result">Accumulator the result will be added to</param>
+  void processElements(std::size_t begin, std::size_t end, std::atomic<std::size_t> &result) {
+    std::size_t value = 0;
+    for(std::size_t index = begin; index < end; ++index) {
+      value += index * 6364136223846793005ULL + 1442695040888963407ULL;
+    }
+    result.fetch_add(value, std::memory_order_relaxed);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Processes a range by splitting it into tasks scheduled one by one</summary>
+  /// <param name="threadPool">Thread pool the tasks will be executed in</param>
+  /// <returns>
+  ///   A value dependent on the operation that can be used to prevent the optimizer
+  ///   from optimizing the entire method call away
+  /// </returns>
+  std::size_t processRangeViaSchedule(Nuclex::Support::Threading::ThreadPool &threadPool) {
+    using Nuclex::Support::Threading::Latch;
+
+    std::atomic<std::size_t> result(0);
+    Latch remainingTasks(ParallelElementCount / ParallelGrainSize);
+
+    for(std::size_t begin = 0; begin < ParallelElementCount; begin += ParallelGrainSize) {
+      threadPool.Schedule(
+        [begin, &result, &remainingTasks] {
+          processElements(begin, begin + ParallelGrainSize, result);
+          remainingTasks.CountDown();
+        }
+      );
+    }
+
+    remainingTasks.Wait();
+    return result.load(std::memory_order_relaxed);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Processes a range using the thread pool's ParallelFor() method</summary>
+  /// <param name="threadPool">Thread pool the range will be processed in</param>
+  /// <returns>
+  ///   A value dependent on the operation that can be used to prevent the optimizer
+  ///   from optimizing the entire method call away
+  /// </returns>
+  std::size_t processRangeViaParallelFor(Nuclex::Support::Threading::ThreadPool &threadPool) {
+    std::atomic<std::size_t> result(0);
+
+    threadPool.ParallelFor(
+      0, ParallelElementCount, ParallelGrainSize,
+      [&result](std::size_t begin, std::size_t end) {
+        processElements(begin, end, result);
+      }
+    );
+
+    return result.load(std::memory_order_relaxed);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Provides a thread pool with the specified number of threads</summary>
+  /// <typeparam name="ThreadCount">Number of threads the thread pool will have</typeparam>
+  /// <returns>The thread pool with the requested number of threads</returns>
+  /// <remarks>
+  ///   Thread pools are kept around for the lifetime of the process so that
+  ///   the benchmark measures task throughput rather than thread creation.
+  /// </remarks>
+  template<std::size_t ThreadCount>
+  Nuclex::Support::Threading::ThreadPool &getThreadPool() {
+    static Nuclex::Support::Threading::ThreadPool threadPool(ThreadCount, ThreadCount);
+    return threadPool;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // anonymous namespace
+
+namespace Nuclex { namespace Support { namespace Threading {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  BASELINE(ThreadPoolFineGrainedTasks, OneThread, 30, 10) {
+    celero::DoNotOptimizeAway(
+      runFineGrainedTasks(getThreadPool<1>())
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  BENCHMARK(ThreadPoolFineGrainedTasks, TwoThreads, 30, 10) {
+    celero::DoNotOptimizeAway(
+      runFineGrainedTasks(getThreadPool<2>())
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  BENCHMARK(ThreadPoolFineGrainedTasks, FourThreads, 30, 10) {
+    celero::DoNotOptimizeAway(
+      runFineGrainedTasks(getThreadPool<4>())
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  BENCHMARK(ThreadPoolFineGrainedTasks, EightThreads, 30, 10) {
+    celero::DoNotOptimizeAway(
+      runFineGrainedTasks(getThreadPool<8>())
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  BENCHMARK(ThreadPoolFineGrainedTasks, SixteenThreads, 30, 10) {
+    celero::DoNotOptimizeAway(
+      runFineGrainedTasks(getThreadPool<16>())
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  BASELINE(ThreadPoolTaskSubmission, ViaSchedule, 30, 10) {
+    celero::DoNotOptimizeAway(
+      scheduleFineGrainedTasks(getThreadPool<4>())
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  BENCHMARK(ThreadPoolTaskSubmission, ViaPost, 30, 10) {
+    celero::DoNotOptimizeAway(
+      postFineGrainedTasks(getThreadPool<4>())
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  BENCHMARK(ThreadPoolTaskSubmission, ViaPostBulk, 30, 10) {
+    celero::DoNotOptimizeAway(
+      postFineGrainedTasksInBulk(getThreadPool<4>())
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  BASELINE(ThreadPoolDataParallel, ViaSchedule, 30, 10) {
+    celero::DoNotOptimizeAway(
+      processRangeViaSchedule(getThreadPool<4>())
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  BENCHMARK(ThreadPoolDataParallel, ViaParallelFor, 30, 10) {
+    celero::DoNotOptimizeAway(
+      processRangeViaParallelFor(getThreadPool<4>())
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Threading
@@ -0,0 +1,200 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+#ifndef NUCLEX_SUPPORT_COLLECTIONS_CONCURRENTBLOOMFILTER_H
+#define NUCLEX_SUPPORT_COLLECTIONS_CONCURRENTBLOOMFILTER_H
+
+#include "Nuclex/Support/Config.h"
+#include "Nuclex/Support/BitTricks.h" // for BitTricks::GetUpperPowerOfTwo()
+
+#include <cstddef> // for std::size_t
+#include <cstdint> // for std::uint64_t
+#include <atomic> // for std::atomic
+#include <memory> // for std::unique_ptr
+#include <functional> // for std::hash
+
+namespace Nuclex { namespace Support { namespace Collections {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Bloom filter that can be used from any number of threads</summary>
+  /// <typeparam name="TKey">Type of the keys the filter will keep track of</typeparam>
+  /// <typeparam name="THash">Hash function that will be used for the keys</typeparam>
+  /// <remarks>
+  ///   <para>
+  ///     <strong>Thread safety:</strong> any number of threads, lock-free
+  ///   </para>
+  ///   <para>
+  ///     A Bloom filter answers whether a key might have been inserted. It can report keys
+  ///     that were never inserted (false positives), but never misses one that was. It is
+  ///     meant to sit in front of a larger container to skip most lookups of missing keys.
+  ///   </para>
+  ///   <para>
+  ///     This is a blocked Bloom filter: all bits of a key are in the same 64 byte block,
+  ///     one bit in each of the block's eight words. A lookup thus touches a single cache
+  ///     line, no matter how large the filter is. Bits are only written if they're not set
+  ///     yet, so inserting keys that are already known doesn't steal cache lines from
+  ///     other threads.
+  ///   </para>
+  ///   <para>
+  ///     Keys cannot be removed from a Bloom filter. If many keys are removed from the
+  ///     container the filter sits in front of, it slowly loses its effectiveness.
+  ///   </para>
+  /// </remarks>
+  template<typename TKey, typename THash = std::hash<TKey>>
+  class ConcurrentBloomFilter {
+
+    /// <summary>Number of filter bits that are reserved for each expected key</summary>
+    /// <remarks>
+    ///   With one bit per word of a 64 byte block, this results in about one false
+    ///   positive in 1000 lookups if the filter holds the number of keys it was sized for.
+    /// </remarks>
+    public: static const constexpr std::size_t BitsPerKey = 16;
+
+    /// <summary>Initializes a new Bloom filter</summary>
+    /// <param name="expectedKeyCount">
+    ///   Number of keys the filter should be able to hold with a low false positive rate
+    /// </param>
+    public: explicit ConcurrentBloomFilter(std::size_t expectedKeyCount) :
+      blockCount(getBlockCount(expectedKeyCount)),
+      blockShift(static_cast<unsigned char>(
+        64 - BitTricks::GetLogBase2(static_cast<std::uint64_t>(this->blockCount))
+      )),
+      blocks(new Block[this->blockCount]),
+      hasher() {
+      Clear();
+    }
+
+    /// <summary>Records a key in the filter</summary>
+    /// <param name="key">Key that will be recorded</param>
+    public: void Insert(const TKey &key) {
+      std::uint64_t hash = mixHash(this->hasher(key));
+      Block &block = this->blocks[getBlockIndex(hash)];
+      for(std::size_t index = 0; index < WordsPerBlock; ++index) {
+        std::uint64_t mask = std::uint64_t(1) << ((hash >> (index * 6)) & 63);
+        if((block.Words[index].load(std::memory_order_relaxed) & mask) == 0) {
+          block.Words[index].fetch_or(mask, std::memory_order_release);
+        }
+      }
+    }
+
+    /// <summary>Checks whether a key might have been recorded in the filter</summary>
+    /// <param name="key">Key that will be checked</param>
+    /// <returns>False if the key was never recorded, true if it might have been</returns>
+    public: bool MightContain(const TKey &key) const {
+      std::uint64_t hash = mixHash(this->hasher(key));
+      const Block &block = this->blocks[getBlockIndex(hash)];
+      for(std::size_t index = 0; index < WordsPerBlock; ++index) {
+        std::uint64_t mask = std::uint64_t(1) << ((hash >> (index * 6)) & 63);
+        if((block.Words[index].load(std::memory_order_acquire) & mask) == 0) {
+          return false;
+        }
+      }
+
+      return true;
+    }
+
+    /// <summary>Forgets all keys that were recorded in the filter</summary>
+    /// <remarks>
+    ///   Keys inserted while the filter is being cleared may or may not be forgotten.
+    /// </remarks>
+    public: void Clear() {
+      for(std::size_t blockIndex = 0; blockIndex < this->blockCount; ++blockIndex) {
+        for(std::size_t index = 0; index < WordsPerBlock; ++index) {
+          this->blocks[blockIndex].Words[index].store(0, std::memory_order_relaxed);
+        }
+      }
+      std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    /// <summary>Number of 64 bit words in each block of the filter</summary>
+    private: static const constexpr std::size_t WordsPerBlock = 8;
+
+    #pragma region struct Block
+
+    /// <summary>Group of filter bits that fills exactly one cache line</summary>
+    private: struct alignas(64) Block {
+
+      /// <summary>Words holding the filter bits, each key sets one bit per word</summary>
+      public: std::atomic<std::uint64_t> Words[WordsPerBlock];
+
+    };
+
+    #pragma endregion // struct Block
+
+    /// <summary>Calculates the number of blocks for the expected number of keys</summary>
+    /// <param name="expectedKeyCount">Number of keys the filter should hold</param>
+    /// <returns>The number of blocks the filter should have, a power of two</returns>
+    private: static std::size_t getBlockCount(std::size_t expectedKeyCount) {
+      std::uint64_t blockCount = (
+        static_cast<std::uint64_t>(expectedKeyCount) * BitsPerKey + 511
+      ) / 512;
+      if(blockCount < 2) {
+        return 2; // Keeps the block shift below 64
+      }
+
+      return static_cast<std::size_t>(BitTricks::GetUpperPowerOfTwo(blockCount));
+    }
+
+    /// <summary>Picks the block that holds the bits for a hash</summary>
+    /// <param name="hash">Mixed hash of the key whose block will be picked</param>
+    /// <returns>The index of the block responsible for the hash</returns>
+    /// <remarks>
+    ///   The bits within the block are chosen by the lower 48 bits of the hash. Taking
+    ///   the upper bits of a multiplication makes the block depend on all bits instead.
+    /// </remarks>
+    private: std::size_t getBlockIndex(std::uint64_t hash) const {
+      return static_cast<std::size_t>((hash * 0x9E3779B97F4A7C15ULL) >> this->blockShift);
+    }
+
+    /// <summary>Spreads the bits of a hash over 64 bits</summary>
+    /// <param name="hash">Hash that will be mixed</param>
+    /// <returns>The mixed hash</returns>
+    /// <remarks>
+    ///   Standard library hashes for integers often return the integer itself, which
+    ///   would set the same few bits in every block.
+    /// </remarks>
+    private: static std::uint64_t mixHash(std::size_t hash) {
+      std::uint64_t mixed = static_cast<std::uint64_t>(hash);
+      mixed ^= mixed >> 33;
+      mixed *= 0xFF51AFD7ED558CCDULL;
+      mixed ^= mixed >> 33;
+      mixed *= 0xC4CEB9FE1A85EC53ULL;
+      return mixed ^ (mixed >> 33);
+    }
+
+    private: ConcurrentBloomFilter(const ConcurrentBloomFilter &) = delete;
+    private: ConcurrentBloomFilter &operator =(const ConcurrentBloomFilter &) = delete;
+
+    /// <summary>Number of blocks in the filter, always a power of two</summary>
+    private: const std::size_t blockCount;
+    /// <summary>Right shift that turns a 64 bit product into a block index</summary>
+    private: const unsigned char blockShift;
+    /// <summary>Blocks holding the filter bits</summary>
+    private: const std::unique_ptr<Block[]> blocks;
+    /// <summary>Calculates the hashes of keys</summary>
+    private: THash hasher;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Collections
+
+#endif // NUCLEX_SUPPORT_COLLECTIONS_CONCURRENTBLOOMFILTER_H
@@ -0,0 +1,177 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+#ifndef NUCLEX_SUPPORT_COLLECTIONS_CONCURRENTHASHMAP_H
+#define NUCLEX_SUPPORT_COLLECTIONS_CONCURRENTHASHMAP_H
+
+#include "Nuclex/Support/Config.h"
+#include "Nuclex/Support/Collections/ConcurrentMap.h"
+#include "Nuclex/Support/Collections/ConcurrentHashTable.h" // for ConcurrentHashTable
+
+#include <cstddef> // for std::size_t
+#include <atomic> // for std::atomic
+#include <functional> // for std::hash, std::equal_to
+
+namespace Nuclex { namespace Support { namespace Collections {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Hash map that can be used from any number of threads</summary>
+  /// <typeparam name="TKey">Type of the key the map uses</typeparam>
+  /// <typeparam name="TValue">Type of values that are stored in the map</typeparam>
+  /// <typeparam name="THash">Hash function that will be used for the keys</typeparam>
+  /// <typeparam name="TEqual">Comparison function that will be used for the keys</typeparam>
+  /// <remarks>
+  ///   <para>
+  ///     <strong>Thread safety:</strong> any number of threads, lookups are lock-free,
+  ///     insertions and removals lock a single bucket
+  ///   </para>
+  ///   <para>
+  ///     <strong>Container type:</strong> chained hash table that grows in the background
+  ///   </para>
+  ///   <para>
+  ///     Lookups only read memory, so a map that is mostly read from scales with the number
+  ///     of threads. Writers to different buckets don't get in each other's way either.
+  ///     When the map grows, the buckets are moved a few at a time by the threads inserting
+  ///     and removing elements rather than all at once by whoever triggered the resize.
+  ///   </para>
+  ///   <para>
+  ///     Stored values are never modified. <see cref="TryGet" /> and <see cref="TryTake" />
+  ///     hand out copies, so the value type must be copy-constructible and a value that
+  ///     is expensive to copy is best stored through a <c>std::shared_ptr</c>.
+  ///   </para>
+  /// </remarks>
+  template<
+    typename TKey, typename TValue,
+    typename THash = std::hash<TKey>, typename TEqual = std::equal_to<TKey>
+  >
+  class ConcurrentHashMap : public ConcurrentMap<TKey, TValue> {
+
+    /// <summary>Initializes a new concurrent hash map</summary>
+    /// <param name="initialBucketCount">
+    ///   Number of buckets the map starts out with, will be rounded up to a power of two
+    /// </param>
+    public: explicit ConcurrentHashMap(std::size_t initialBucketCount = 16) :
+      table(initialBucketCount) {}
+
+    /// <summary>Destroys the map and all elements still in it</summary>
+    /// <remarks>
+    ///   No other thread may access the map anymore when it is destroyed.
+    /// </remarks>
+    public: ~ConcurrentHashMap() override = default;
+
+    /// <summary>Tries to insert an element into the map</summary>
+    /// <param name="key">Key under which the value can be looked up later</param>
+    /// <param name="value">Value that will be stored under its key in the map</param>
+    /// <returns>True if the element was inserted, false if the key already existed</returns>
+    public: bool TryInsert(const TKey &key, const TValue &value) override {
+      return this->table.Insert(
+        key, [&key, &value](std::size_t hash) { return new Node(hash, key, value); }
+      );
+    }
+
+    /// <summary>Tries to look up an element in the map</summary>
+    /// <param name="key">Key of the element that will be looked up</param>
+    /// <param name="value">Will receive a copy of the value stored in the map</param>
+    /// <returns>True if an element was found, false if the key didn't exist</returns>
+    public: bool TryGet(const TKey &key, TValue &value) const override {
+      return this->table.Find(key, [&value](const Node &node) { value = node.Value; });
+    }
+
+    /// <summary>Tries to take an element from the map (removing it)</summary>
+    /// <param name="key">Key of the element that will be taken from the map</param>
+    /// <param name="value">Will receive the value taken from the map</param>
+    /// <returns>
+    ///   True if an element was taken from the map, false if the key didn't exist
+    /// </returns>
+    /// <remarks>
+    ///   Concurrent lookups may still be copying the value, so it is copied rather than
+    ///   moved out. If the copy throws, the element remains in the map.
+    /// </remarks>
+    public: bool TryTake(const TKey &key, TValue &value) override {
+      return this->table.Remove(key, [&value](const Node &node) { value = node.Value; });
+    }
+
+    /// <summary>Removes the specified element from the map if it exists</summary>
+    /// <param name="key">Key of the element that will be removed if present</param>
+    /// <returns>True if the element was found and removed, false otherwise</returns>
+    public: bool TryRemove(const TKey &key) override {
+      return this->table.Remove(key, [](const Node &) {});
+    }
+
+    /// <summary>Counts the number of elements currently in the map</summary>
+    /// <returns>
+    ///   The approximate number of elements that had been in the map during the call
+    /// </returns>
+    public: std::size_t Count() const override {
+      return this->table.Count();
+    }
+
+    /// <summary>Checks if the map is empty</summary>
+    /// <returns>True if the map had been empty during the call</returns>
+    public: bool IsEmpty() const override {
+      return (this->table.Count() == 0);
+    }
+
+    #pragma region struct Node
+
+    /// <summary>Stores a key and its value in the hash table</summary>
+    private: struct Node {
+
+      /// <summary>Initializes a new node</summary>
+      /// <param name="hash">Hash of the key</param>
+      /// <param name="key">Key the value is stored under</param>
+      /// <param name="value">Value that is stored in the node</param>
+      public: Node(std::size_t hash, const TKey &key, const TValue &value) :
+        Hash(hash),
+        Key(key),
+        Value(value),
+        Next(nullptr) {}
+
+      /// <summary>Initializes a copy of a node when the hash table is resized</summary>
+      /// <param name="other">Node that will be copied</param>
+      public: Node(const Node &other) :
+        Hash(other.Hash),
+        Key(other.Key),
+        Value(other.Value),
+        Next(nullptr) {}
+
+      /// <summary>Hash of the key</summary>
+      public: const std::size_t Hash;
+      /// <summary>Key the value is stored under</summary>
+      public: const TKey Key;
+      /// <summary>Value that is stored in the node</summary>
+      public: const TValue Value;
+      /// <summary>Next node in the same bucket</summary>
+      public: std::atomic<Node *> Next;
+
+    };
+
+    #pragma endregion // struct Node
+
+    /// <summary>Hash table storing the map's elements</summary>
+    private: ConcurrentHashTable<TKey, Node, THash, TEqual> table;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Collections
+
+#endif // NUCLEX_SUPPORT_COLLECTIONS_CONCURRENTHASHMAP_H
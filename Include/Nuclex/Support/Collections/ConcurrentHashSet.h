@@ -0,0 +1,180 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+#ifndef NUCLEX_SUPPORT_COLLECTIONS_CONCURRENTHASHSET_H
+#define NUCLEX_SUPPORT_COLLECTIONS_CONCURRENTHASHSET_H
+
+#include "Nuclex/Support/Config.h"
+#include "Nuclex/Support/Collections/ConcurrentSet.h"
+#include "Nuclex/Support/Collections/ConcurrentHashTable.h" // for ConcurrentHashTable
+#include "Nuclex/Support/Collections/ConcurrentBloomFilter.h" // for ConcurrentBloomFilter
+
+#include <cstddef> // for std::size_t
+#include <atomic> // for std::atomic
+#include <memory> // for std::unique_ptr
+#include <functional> // for std::hash, std::equal_to
+
+namespace Nuclex { namespace Support { namespace Collections {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Hash set that can be used from any number of threads</summary>
+  /// <typeparam name="TKey">Type of the key the set will keep track of</typeparam>
+  /// <typeparam name="THash">Hash function that will be used for the keys</typeparam>
+  /// <typeparam name="TEqual">Comparison function that will be used for the keys</typeparam>
+  /// <remarks>
+  ///   <para>
+  ///     <strong>Thread safety:</strong> any number of threads, lookups are lock-free,
+  ///     insertions and removals lock a single bucket
+  ///   </para>
+  ///   <para>
+  ///     <strong>Container type:</strong> chained hash table that grows in the background,
+  ///     optionally behind a Bloom filter
+  ///   </para>
+  ///   <para>
+  ///     This uses the same hash table as <see cref="ConcurrentHashMap" />, so lookups
+  ///     never wait and resizing happens a few buckets at a time.
+  ///   </para>
+  ///   <para>
+  ///     If the set is mostly checked for keys it doesn't contain, it can be given
+  ///     a <see cref="ConcurrentBloomFilter" /> sized for the number of keys it is expected
+  ///     to hold. Most checks for missing keys are then answered by reading a single cache
+  ///     line of the filter without hashing into the table and walking its chains. Removed
+  ///     keys stay in the filter, so this is best for sets that keys are rarely removed from.
+  ///   </para>
+  /// </remarks>
+  template<
+    typename TKey, typename THash = std::hash<TKey>, typename TEqual = std::equal_to<TKey>
+  >
+  class ConcurrentHashSet : public ConcurrentSet<TKey> {
+
+    /// <summary>Initializes a new concurrent hash set</summary>
+    /// <param name="initialBucketCount">
+    ///   Number of buckets the set starts out with, will be rounded up to a power of two
+    /// </param>
+    /// <param name="filteredKeyCount">
+    ///   Number of keys the Bloom filter in front of the set should be sized for,
+    ///   0 to not use a Bloom filter
+    /// </param>
+    public: explicit ConcurrentHashSet(
+      std::size_t initialBucketCount = 16, std::size_t filteredKeyCount = 0
+    ) :
+      table(initialBucketCount),
+      filter(
+        (filteredKeyCount == 0) ? nullptr : new ConcurrentBloomFilter<TKey, THash>(
+          filteredKeyCount
+        )
+      ) {}
+
+    /// <summary>Destroys the set and all keys still in it</summary>
+    /// <remarks>
+    ///   No other thread may access the set anymore when it is destroyed.
+    /// </remarks>
+    public: ~ConcurrentHashSet() override = default;
+
+    /// <summary>Tries to insert a key into the set</summary>
+    /// <param name="key">Key that will be inserted into the set</param>
+    /// <returns>True if the key was inserted, false if the key already existed</returns>
+    public: bool TryInsert(const TKey &key) override {
+      if(static_cast<bool>(this->filter)) {
+        this->filter->Insert(key); // Before the table, so the filter never misses a key
+      }
+
+      return this->table.Insert(
+        key, [&key](std::size_t hash) { return new Node(hash, key); }
+      );
+    }
+
+    /// <summary>Tries to remove a key from the set</summary>
+    /// <param name="key">Key that will be removed from the set</param>
+    /// <returns>True if the key was removed from the set, false if the key didn't exist</returns>
+    public: bool TryRemove(const TKey &key) override {
+      return this->table.Remove(key, [](const Node &) {});
+    }
+
+    /// <summary>Checks whether the set contains the specified key</summary>
+    /// <param name="key">Key the set will be checked for</param>
+    /// <returns>True if the key had been in the set during the call</returns>
+    public: bool Contains(const TKey &key) const override {
+      if(static_cast<bool>(this->filter)) {
+        if(!this->filter->MightContain(key)) {
+          return false;
+        }
+      }
+
+      return this->table.Find(key, [](const Node &) {});
+    }
+
+    /// <summary>Counts the number of keys currently in the set</summary>
+    /// <returns>
+    ///   The approximate number of keys that had been in the set during the call
+    /// </returns>
+    public: std::size_t Count() const override {
+      return this->table.Count();
+    }
+
+    /// <summary>Checks if the set is empty</summary>
+    /// <returns>True if the set had been empty during the call</returns>
+    public: bool IsEmpty() const override {
+      return (this->table.Count() == 0);
+    }
+
+    #pragma region struct Node
+
+    /// <summary>Stores a key in the hash table</summary>
+    private: struct Node {
+
+      /// <summary>Initializes a new node</summary>
+      /// <param name="hash">Hash of the key</param>
+      /// <param name="key">Key that is stored in the node</param>
+      public: Node(std::size_t hash, const TKey &key) :
+        Hash(hash),
+        Key(key),
+        Next(nullptr) {}
+
+      /// <summary>Initializes a copy of a node when the hash table is resized</summary>
+      /// <param name="other">Node that will be copied</param>
+      public: Node(const Node &other) :
+        Hash(other.Hash),
+        Key(other.Key),
+        Next(nullptr) {}
+
+      /// <summary>Hash of the key</summary>
+      public: const std::size_t Hash;
+      /// <summary>Key that is stored in the node</summary>
+      public: const TKey Key;
+      /// <summary>Next node in the same bucket</summary>
+      public: std::atomic<Node *> Next;
+
+    };
+
+    #pragma endregion // struct Node
+
+    /// <summary>Hash table storing the set's keys</summary>
+    private: ConcurrentHashTable<TKey, Node, THash, TEqual> table;
+    /// <summary>Filter that rules out most keys not in the set, if enabled</summary>
+    private: const std::unique_ptr<ConcurrentBloomFilter<TKey, THash>> filter;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Collections
+
+#endif // NUCLEX_SUPPORT_COLLECTIONS_CONCURRENTHASHSET_H
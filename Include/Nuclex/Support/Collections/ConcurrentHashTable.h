@@ -0,0 +1,525 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+#ifndef NUCLEX_SUPPORT_COLLECTIONS_CONCURRENTHASHTABLE_H
+#define NUCLEX_SUPPORT_COLLECTIONS_CONCURRENTHASHTABLE_H
+
+#include "Nuclex/Support/Config.h"
+#include "Nuclex/Support/BitTricks.h" // for BitTricks::GetUpperPowerOfTwo()
+#include "Nuclex/Support/Threading/EpochDomain.h" // for EpochDomain
+
+#include <cstddef> // for std::size_t, std::ptrdiff_t
+#include <cstdint> // for std::uintptr_t, std::uint64_t
+#include <atomic> // for std::atomic
+#include <memory> // for std::unique_ptr
+#include <thread> // for std::this_thread::yield()
+
+namespace Nuclex { namespace Support { namespace Collections {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Hash table shared by the concurrent hash map and hash set</summary>
+  /// <typeparam name="TKey">Type of the keys the table is indexed by</typeparam>
+  /// <typeparam name="TNode">
+  ///   Type of the nodes that are stored in the table. Must provide a <c>Hash</c>, a <c>Key</c>
+  ///   and a <c>std::atomic&lt;TNode *&gt; Next</c> member and a copy constructor that copies
+  ///   everything but the <c>Next</c> member.
+  /// </typeparam>
+  /// <typeparam name="THash">Hash function that will be used for the keys</typeparam>
+  /// <typeparam name="TEqual">Comparison function that will be used for the keys</typeparam>
+  /// <remarks>
+  ///   <para>
+  ///     This is the machinery behind <see cref="ConcurrentHashMap" /> and not meant to be
+  ///     used on its own. Each bucket holds a singly linked chain of immutable nodes.
+  ///   </para>
+  ///   <para>
+  ///     Lookups never wait: they run inside an <see cref="Threading::EpochDomain" /> read
+  ///     scope and simply walk the chain. Inserts and removals lock only the bucket they
+  ///     modify through a bit in the bucket's head pointer. Removed nodes are unlinked so
+  ///     that concurrent readers can still walk past them and are freed by the epoch domain
+  ///     once no reader can be looking at them anymore.
+  ///   </para>
+  ///   <para>
+  ///     When the table gets too full, a table with twice the buckets is attached to it.
+  ///     Every insert or removal then moves a few buckets over by copying their nodes and
+  ///     marking the old bucket as moved, which sends lookups and modifications for its
+  ///     keys to the new table. Once all buckets are moved, the new table replaces the
+  ///     old one. The world is never stopped for the resize.
+  ///   </para>
+  /// </remarks>
+  template<typename TKey, typename TNode, typename THash, typename TEqual>
+  class ConcurrentHashTable {
+
+    /// <summary>Number of counters the element count is spread over</summary>
+    public: static const constexpr std::size_t CountStripeCount = 16;
+    /// <summary>Number of buckets each modification moves over while resizing</summary>
+    public: static const constexpr std::size_t MigrationBatchSize = 16;
+
+    /// <summary>Initializes a new concurrent hash table</summary>
+    /// <param name="initialBucketCount">Number of buckets the table starts out with</param>
+    public: explicit ConcurrentHashTable(std::size_t initialBucketCount) :
+      current(new Table(BitTricks::GetUpperPowerOfTwo(
+        (initialBucketCount < 16) ? std::size_t(16) : initialBucketCount
+      ))),
+      countStripes(),
+      reclamation(),
+      hasher(),
+      comparer() {
+      for(std::size_t index = 0; index < CountStripeCount; ++index) {
+        this->countStripes[index].Count.store(0, std::memory_order_relaxed);
+      }
+    }
+
+    /// <summary>Destroys the hash table and all nodes in it</summary>
+    /// <remarks>
+    ///   No other thread may access the table anymore when it is destroyed.
+    /// </remarks>
+    public: ~ConcurrentHashTable() {
+      Table *table = this->current.load(std::memory_order_acquire);
+      while(table != nullptr) {
+        Table *next = table->Next.load(std::memory_order_relaxed);
+        deleteTable(table);
+        table = next;
+      }
+    }
+
+    /// <summary>Looks up the node for a key and lets a callback inspect it</summary>
+    /// <typeparam name="TCallback">Type of callback that will be invoked</typeparam>
+    /// <param name="key">Key whose node will be looked up</param>
+    /// <param name="found">Invoked with the node if it was found</param>
+    /// <returns>True if the key was found, false otherwise</returns>
+    /// <remarks>
+    ///   The node is guaranteed to stay alive while the callback runs, but other
+    ///   threads may remove it from the table at the same time.
+    /// </remarks>
+    public: template<typename TCallback>
+    bool Find(const TKey &key, TCallback &&found) const {
+      Threading::EpochDomain::ReadScope scope(this->reclamation);
+
+      std::size_t hash = mixHash(this->hasher(key));
+      const Table *table = this->current.load(std::memory_order_acquire);
+      for(;;) {
+        std::uintptr_t head = table->GetBucket(hash).load(std::memory_order_acquire);
+        if(unlikely((head & MovedBit) != 0)) {
+          table = table->Next.load(std::memory_order_acquire);
+          continue;
+        }
+
+        const TNode *node = toNode(head);
+        while(node != nullptr) {
+          if((node->Hash == hash) && this->comparer(node->Key, key)) {
+            found(*node);
+            return true;
+          }
+          node = node->Next.load(std::memory_order_acquire);
+        }
+
+        return false;
+      }
+    }
+
+    /// <summary>Inserts a node for a key unless the key is already present</summary>
+    /// <typeparam name="TFactory">Type of the factory creating the node</typeparam>
+    /// <param name="key">Key for which a node will be inserted</param>
+    /// <param name="createNode">
+    ///   Invoked with the key's hash to create the node if the key is not present yet
+    /// </param>
+    /// <returns>True if the node was inserted, false if the key was already present</returns>
+    public: template<typename TFactory>
+    bool Insert(const TKey &key, TFactory &&createNode) {
+      Threading::EpochDomain::ReadScope scope(this->reclamation);
+
+      std::size_t hash = mixHash(this->hasher(key));
+      Table *table = this->current.load(std::memory_order_acquire);
+      helpMigrate(table);
+
+      for(;;) {
+        std::atomic<std::uintptr_t> &bucket = table->GetBucket(hash);
+        std::uintptr_t head = lockBucket(bucket);
+        if(unlikely((head & MovedBit) != 0)) {
+          table = table->Next.load(std::memory_order_acquire);
+          continue;
+        }
+
+        for(TNode *node = toNode(head); node != nullptr; node = nextNode(node)) {
+          if((node->Hash == hash) && this->comparer(node->Key, key)) {
+            bucket.store(head, std::memory_order_release);
+            return false;
+          }
+        }
+
+        TNode *newNode;
+        try {
+          newNode = createNode(hash);
+        }
+        catch(...) {
+          bucket.store(head, std::memory_order_release);
+          throw;
+        }
+        newNode->Next.store(toNode(head), std::memory_order_relaxed);
+        bucket.store(reinterpret_cast<std::uintptr_t>(newNode), std::memory_order_release);
+
+        adjustCount(table, hash, +1);
+        return true;
+      }
+    }
+
+    /// <summary>Removes the node for a key if it is present</summary>
+    /// <typeparam name="TCallback">Type of callback that will be invoked</typeparam>
+    /// <param name="key">Key whose node will be removed</param>
+    /// <param name="removing">Invoked with the node before it is removed</param>
+    /// <returns>True if the node was removed, false if the key was not present</returns>
+    /// <remarks>
+    ///   If the callback throws, the node is not removed.
+    /// </remarks>
+    public: template<typename TCallback>
+    bool Remove(const TKey &key, TCallback &&removing) {
+      Threading::EpochDomain::ReadScope scope(this->reclamation);
+
+      std::size_t hash = mixHash(this->hasher(key));
+      Table *table = this->current.load(std::memory_order_acquire);
+      helpMigrate(table);
+
+      for(;;) {
+        std::atomic<std::uintptr_t> &bucket = table->GetBucket(hash);
+        std::uintptr_t head = lockBucket(bucket);
+        if(unlikely((head & MovedBit) != 0)) {
+          table = table->Next.load(std::memory_order_acquire);
+          continue;
+        }
+
+        TNode *previous = nullptr;
+        for(TNode *node = toNode(head); node != nullptr; node = nextNode(node)) {
+          if((node->Hash == hash) && this->comparer(node->Key, key)) {
+            try {
+              removing(static_cast<const TNode &>(*node));
+            }
+            catch(...) {
+              bucket.store(head, std::memory_order_release);
+              throw;
+            }
+
+            // Readers currently standing on the node can still follow its next pointer
+            if(previous == nullptr) {
+              bucket.store(
+                reinterpret_cast<std::uintptr_t>(nextNode(node)), std::memory_order_release
+              );
+            } else {
+              previous->Next.store(nextNode(node), std::memory_order_release);
+              bucket.store(head, std::memory_order_release);
+            }
+
+            this->reclamation.Retire(node);
+            adjustCount(table, hash, -1);
+            return true;
+          }
+          previous = node;
+        }
+
+        bucket.store(head, std::memory_order_release);
+        return false;
+      }
+    }
+
+    /// <summary>Counts the number of nodes currently in the table</summary>
+    /// <returns>
+    ///   The approximate number of nodes that had been in the table during the call
+    /// </returns>
+    public: std::size_t Count() const {
+      std::ptrdiff_t count = 0;
+      for(std::size_t index = 0; index < CountStripeCount; ++index) {
+        count += this->countStripes[index].Count.load(std::memory_order_relaxed);
+      }
+
+      return (count > 0) ? static_cast<std::size_t>(count) : 0;
+    }
+
+    /// <summary>Flag in a bucket's head pointer that is set while a writer holds it</summary>
+    private: static const constexpr std::uintptr_t LockedBit = 1;
+    /// <summary>Flag in a bucket's head pointer that is set once it has been moved</summary>
+    private: static const constexpr std::uintptr_t MovedBit = 2;
+
+    #pragma region struct CountStripe
+
+    /// <summary>Counter for part of the nodes on its own cache line</summary>
+    private: struct alignas(64) CountStripe {
+
+      /// <summary>Number of nodes added minus number of nodes removed</summary>
+      public: std::atomic<std::ptrdiff_t> Count;
+
+    };
+
+    #pragma endregion // struct CountStripe
+
+    #pragma region struct Table
+
+    /// <summary>Array of buckets and the state of its migration to a larger table</summary>
+    private: struct Table {
+
+      /// <summary>Initializes a new table with empty buckets</summary>
+      /// <param name="bucketCount">Number of buckets, must be a power of two</param>
+      public: explicit Table(std::size_t bucketCount) :
+        BucketCount(bucketCount),
+        Buckets(new std::atomic<std::uintptr_t>[bucketCount]),
+        Next(nullptr),
+        MigrationIndex(0),
+        MigratedCount(0) {
+        for(std::size_t index = 0; index < bucketCount; ++index) {
+          this->Buckets[index].store(0, std::memory_order_relaxed);
+        }
+      }
+
+      /// <summary>Looks up the bucket responsible for the specified hash</summary>
+      /// <param name="hash">Hash whose bucket will be looked up</param>
+      /// <returns>The bucket responsible for the hash</returns>
+      public: std::atomic<std::uintptr_t> &GetBucket(std::size_t hash) const {
+        return this->Buckets[hash & (this->BucketCount - 1)];
+      }
+
+      /// <summary>Number of buckets in the table, always a power of two</summary>
+      public: const std::size_t BucketCount;
+      /// <summary>Head pointers of the node chains with lock and moved flags</summary>
+      public: const std::unique_ptr<std::atomic<std::uintptr_t>[]> Buckets;
+      /// <summary>Larger table the buckets are being moved to</summary>
+      public: std::atomic<Table *> Next;
+      /// <summary>Index of the next bucket a thread helping with the move will look at</summary>
+      public: std::atomic<std::size_t> MigrationIndex;
+      /// <summary>Number of buckets that have been moved to the next table</summary>
+      public: std::atomic<std::size_t> MigratedCount;
+
+    };
+
+    #pragma endregion // struct Table
+
+    /// <summary>Spreads the bits of a hash so that the low bits can pick a bucket</summary>
+    /// <param name="hash">Hash that will be mixed</param>
+    /// <returns>The mixed hash</returns>
+    /// <remarks>
+    ///   Standard library hashes for integers often return the integer itself, which would
+    ///   put keys that are multiples of the bucket count all into the same bucket.
+    /// </remarks>
+    private: static std::size_t mixHash(std::size_t hash) {
+      std::uint64_t mixed = static_cast<std::uint64_t>(hash) * 0x9E3779B97F4A7C15ULL;
+      return static_cast<std::size_t>(mixed ^ (mixed >> 32));
+    }
+
+    /// <summary>Extracts the node pointer from a bucket's head pointer</summary>
+    /// <param name="head">Head pointer including the lock and moved flags</param>
+    /// <returns>The first node in the bucket</returns>
+    private: static TNode *toNode(std::uintptr_t head) {
+      return reinterpret_cast<TNode *>(head & ~(LockedBit | MovedBit));
+    }
+
+    /// <summary>Looks up the node following the specified node</summary>
+    /// <param name="node">Node whose successor will be looked up</param>
+    /// <returns>The node following the specified node</returns>
+    private: static TNode *nextNode(const TNode *node) {
+      return node->Next.load(std::memory_order_acquire);
+    }
+
+    /// <summary>Locks a bucket unless it has been moved to the next table</summary>
+    /// <param name="bucket">Bucket that will be locked</param>
+    /// <returns>
+    ///   The bucket's head pointer without the lock flag or with the moved flag set if
+    ///   the bucket has been moved, in which case it wasn't locked
+    /// </returns>
+    private: static std::uintptr_t lockBucket(std::atomic<std::uintptr_t> &bucket) {
+      std::size_t spinCount = 0;
+      std::uintptr_t head = bucket.load(std::memory_order_relaxed);
+      for(;;) {
+        if(unlikely((head & MovedBit) != 0)) {
+          return head;
+        }
+        if(likely((head & LockedBit) == 0)) {
+          bool wasLocked = bucket.compare_exchange_weak(
+            head, head | LockedBit, std::memory_order_acquire, std::memory_order_relaxed
+          );
+          if(likely(wasLocked)) {
+            return head;
+          }
+        } else {
+          ++spinCount;
+          if((spinCount & 63) == 0) {
+            std::this_thread::yield();
+          }
+          head = bucket.load(std::memory_order_relaxed);
+        }
+      }
+    }
+
+    /// <summary>Updates the node count and starts a resize if the table got too full</summary>
+    /// <param name="table">Table the node was added to or removed from</param>
+    /// <param name="hash">Hash of the node that was added or removed</param>
+    /// <param name="difference">Number of nodes that were added or removed</param>
+    private: void adjustCount(Table *table, std::size_t hash, std::ptrdiff_t difference) {
+      CountStripe &stripe = this->countStripes[hash & (CountStripeCount - 1)];
+      std::ptrdiff_t stripeCount = stripe.Count.fetch_add(
+        difference, std::memory_order_relaxed
+      ) + difference;
+
+      // If the stripes saw an equal share of the nodes, this would be the total. Only
+      // when it suggests the table is full are all stripes summed up, since inserts can
+      // land unevenly on the stripes. Aim for an average of one node per bucket.
+      std::size_t estimatedCount = static_cast<std::size_t>(stripeCount) * CountStripeCount;
+      if((difference > 0) && (stripeCount > 0) && (estimatedCount > table->BucketCount)) {
+        if(table == this->current.load(std::memory_order_relaxed)) {
+          if(table->Next.load(std::memory_order_relaxed) == nullptr) {
+            if(Count() > table->BucketCount) {
+              startResize(table);
+            }
+          }
+        }
+      }
+    }
+
+    /// <summary>Attaches a larger table to move the buckets into</summary>
+    /// <param name="table">Table that has gotten too full</param>
+    private: void startResize(Table *table) {
+      Table *newTable = new Table(table->BucketCount * 2);
+      Table *expected = nullptr;
+      bool wasAttached = table->Next.compare_exchange_strong(
+        expected, newTable, std::memory_order_release, std::memory_order_relaxed
+      );
+      if(!wasAttached) {
+        delete newTable;
+      }
+    }
+
+    /// <summary>Moves a few buckets to the next table if a resize is in progress</summary>
+    /// <param name="table">Table that may be in the process of being resized</param>
+    private: void helpMigrate(Table *table) {
+      Table *newTable = table->Next.load(std::memory_order_acquire);
+      if(likely(newTable == nullptr)) {
+        return;
+      }
+      if(table->MigratedCount.load(std::memory_order_relaxed) >= table->BucketCount) {
+        return;
+      }
+
+      // Buckets are claimed by locking them, the index only spreads helpers out. It wraps
+      // around, so a bucket skipped because moving it failed will be visited again.
+      std::size_t startIndex = table->MigrationIndex.fetch_add(
+        MigrationBatchSize, std::memory_order_relaxed
+      );
+      std::size_t movedCount = 0;
+      for(std::size_t index = 0; index < MigrationBatchSize; ++index) {
+        std::atomic<std::uintptr_t> &bucket = table->Buckets[
+          (startIndex + index) & (table->BucketCount - 1)
+        ];
+        if((bucket.load(std::memory_order_relaxed) & MovedBit) == 0) {
+          if(migrateBucket(bucket, *newTable)) {
+            ++movedCount;
+          }
+        }
+      }
+
+      // Whoever moves the last bucket puts the new table in charge
+      if(movedCount > 0) {
+        std::size_t totalMovedCount = table->MigratedCount.fetch_add(
+          movedCount, std::memory_order_acq_rel
+        ) + movedCount;
+        if(totalMovedCount == table->BucketCount) {
+          this->current.store(newTable, std::memory_order_release);
+          this->reclamation.Retire(table, &ConcurrentHashTable::deleteTable);
+        }
+      }
+    }
+
+    /// <summary>Copies a bucket's nodes into the next table and marks it as moved</summary>
+    /// <param name="bucket">Bucket that will be moved</param>
+    /// <param name="newTable">Table the bucket's nodes will be copied into</param>
+    /// <returns>True if the bucket was moved, false if another thread moved it</returns>
+    private: bool migrateBucket(std::atomic<std::uintptr_t> &bucket, Table &newTable) {
+      std::uintptr_t head = lockBucket(bucket);
+      if((head & MovedBit) != 0) {
+        return false;
+      }
+
+      // Copy all nodes before touching the new table, so if copying fails, the bucket
+      // can be left as it is
+      TNode *copies = nullptr;
+      try {
+        for(TNode *node = toNode(head); node != nullptr; node = nextNode(node)) {
+          TNode *copy = new TNode(*node);
+          copy->Next.store(copies, std::memory_order_relaxed);
+          copies = copy;
+        }
+      }
+      catch(...) {
+        deleteChain(copies);
+        bucket.store(head, std::memory_order_release);
+        throw;
+      }
+
+      while(copies != nullptr) {
+        TNode *copy = copies;
+        copies = nextNode(copy);
+
+        std::atomic<std::uintptr_t> &newBucket = newTable.GetBucket(copy->Hash);
+        std::uintptr_t newHead = lockBucket(newBucket);
+        copy->Next.store(toNode(newHead), std::memory_order_relaxed);
+        newBucket.store(reinterpret_cast<std::uintptr_t>(copy), std::memory_order_release);
+      }
+
+      // The old nodes stay in the bucket so they're freed together with the table
+      bucket.store(head | MovedBit | LockedBit, std::memory_order_release);
+      return true;
+    }
+
+    /// <summary>Frees a chain of nodes</summary>
+    /// <param name="node">First node in the chain</param>
+    private: static void deleteChain(TNode *node) {
+      while(node != nullptr) {
+        TNode *next = nextNode(node);
+        delete node;
+        node = next;
+      }
+    }
+
+    /// <summary>Frees a table and all nodes still in it</summary>
+    /// <param name="table">Table that will be freed</param>
+    private: static void deleteTable(void *table) {
+      Table *retired = static_cast<Table *>(table);
+      for(std::size_t index = 0; index < retired->BucketCount; ++index) {
+        deleteChain(toNode(retired->Buckets[index].load(std::memory_order_relaxed)));
+      }
+      delete retired;
+    }
+
+    private: ConcurrentHashTable(const ConcurrentHashTable &) = delete;
+    private: ConcurrentHashTable &operator =(const ConcurrentHashTable &) = delete;
+
+    /// <summary>Table lookups start in, may be attached to a larger table</summary>
+    private: std::atomic<Table *> current;
+    /// <summary>Counters that together track the number of nodes</summary>
+    private: CountStripe countStripes[CountStripeCount];
+    /// <summary>Keeps removed nodes and replaced tables alive while readers need them</summary>
+    private: Threading::EpochDomain reclamation;
+    /// <summary>Calculates the hashes of keys</summary>
+    private: THash hasher;
+    /// <summary>Compares keys for equality</summary>
+    private: TEqual comparer;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Collections
+
+#endif // NUCLEX_SUPPORT_COLLECTIONS_CONCURRENTHASHTABLE_H
@@ -57,15 +57,17 @@ namespace Nuclex { namespace Support { namespace Collections {
     public: virtual bool TryInsert(const TKey &key, TValue &&value) = 0;
 #endif
 
-#if 0 // Unsure because it would require thread-safe assignment op in the stored value
     /// <summary>Tries to look up an element in the map</summary>
     /// <param name="key">Key of the element that will be looked up</param>
-    /// <param name="value">Will receive the value taken from the map</param>
+    /// <param name="value">Will receive a copy of the value stored in the map</param>
     /// <returns>
     ///   True if an element was found, false if the key didn't exist (anymore?)
     /// </returns>
+    /// <remarks>
+    ///   The value is copied out while the map guarantees that the stored value is neither
+    ///   modified nor destroyed, so the value type needs no thread-safe assignment.
+    /// </remarks>
     public: virtual bool TryGet(const TKey &key, TValue &value) const = 0;
-#endif
 
     /// <summary>Tries to take an element from the map (removing it)</summary>
     /// <param name="key">Key of the element that will be taken from the map</param>
@@ -0,0 +1,351 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+#ifndef NUCLEX_SUPPORT_COLLECTIONS_CONCURRENTMULTIQUEUE_H
+#define NUCLEX_SUPPORT_COLLECTIONS_CONCURRENTMULTIQUEUE_H
+
+#include "Nuclex/Support/Config.h"
+
+#if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+
+#include "Nuclex/Support/Collections/ConcurrentCollection.h"
+#include "Nuclex/Support/Threading/Mutex.h" // for Mutex
+#include "Nuclex/Support/BitTricks.h" // for BitTricks::XorShiftRandom()
+#include "Nuclex/Support/ScopeGuard.h" // for ON_SCOPE_EXIT
+
+#include <cstddef> // for std::size_t
+#include <cstdint> // for std::uintptr_t, std::uint64_t
+#include <atomic> // for std::atomic
+#include <memory> // for std::unique_ptr
+#include <vector> // for std::vector
+#include <algorithm> // for std::push_heap(), std::pop_heap()
+#include <functional> // for std::less
+#include <thread> // for std::thread::hardware_concurrency()
+
+namespace Nuclex { namespace Support { namespace Collections {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Priority queue with relaxed ordering that scales to many threads</summary>
+  /// <typeparam name="TElement">Type of elements stored in the queue</typeparam>
+  /// <typeparam name="TCompare">Comparison that decides which element comes first</typeparam>
+  /// <remarks>
+  ///   <para>
+  ///     <strong>Thread safety:</strong> any number of producers and consumers, locking
+  ///   </para>
+  ///   <para>
+  ///     <strong>Container type:</strong> several binary heaps, each with its own mutex
+  ///   </para>
+  ///   <para>
+  ///     This is the MultiQueue by Rihani, Sanders and Dementiev. Elements are appended
+  ///     to a randomly chosen heap. Taking an element looks at the smallest elements of
+  ///     two randomly chosen heaps and takes the smaller one. A thread that finds a heap
+  ///     locked simply picks another one, so threads rarely wait for each other.
+  ///   </para>
+  ///   <para>
+  ///     The element taken is not necessarily the smallest one in the queue, but one of
+  ///     the smallest. With twice as many heaps as threads, the taken element is usually
+  ///     among the first few dozen elements, which is good enough for scheduling work by
+  ///     deadline. If exact order is required, use <see cref="ConcurrentPriorityQueue" />.
+  ///   </para>
+  ///   <para>
+  ///     Because elements can be moved out while the heap is locked, taking an element
+  ///     moves it rather than copying it. If moving the element throws, the exception is
+  ///     passed on and the element stays in the queue.
+  ///   </para>
+  /// </remarks>
+  template<typename TElement, typename TCompare = std::less<TElement>>
+  class ConcurrentMultiQueue : public ConcurrentCollection<
+    TElement, ConcurrentAccessBehavior::MultipleProducersMultipleConsumers
+  > {
+
+    /// <summary>Initializes a new concurrent multi queue</summary>
+    /// <param name="heapCount">
+    ///   Number of heaps the elements are spread over, 0 to use twice the number of
+    ///   processors in the system
+    /// </param>
+    public: explicit ConcurrentMultiQueue(std::size_t heapCount = 0) :
+      heapCount(getHeapCount(heapCount)),
+      heaps(new Heap[this->heapCount]),
+      comparer() {}
+
+    /// <summary>Destroys the queue and all elements still in it</summary>
+    public: ~ConcurrentMultiQueue() override = default;
+
+    /// <summary>Inserts an element into the queue</summary>
+    /// <param name="element">Element that will be inserted into the queue</param>
+    /// <returns>Always true, the queue is unbounded</returns>
+    public: bool TryAppend(const TElement &element) override {
+      Heap &heap = lockRandomHeap();
+      ON_SCOPE_EXIT { heap.Lock.Unlock(); };
+
+      heap.Elements.push_back(element);
+      std::push_heap(heap.Elements.begin(), heap.Elements.end(), LaterFirst(this->comparer));
+      heap.Count.store(heap.Elements.size(), std::memory_order_relaxed);
+
+      return true;
+    }
+
+    /// <summary>Takes one of the smallest elements from the queue</summary>
+    /// <param name="element">Will receive the element taken from the queue</param>
+    /// <returns>True if an element was taken, false if the queue was empty</returns>
+    /// <remarks>
+    ///   This is the same as <see cref="TryTakeMin" />.
+    /// </remarks>
+    public: bool TryTake(TElement &element) override {
+      return TryTakeMin(element);
+    }
+
+    /// <summary>Takes one of the smallest elements from the queue</summary>
+    /// <param name="element">Will receive the element taken from the queue</param>
+    /// <returns>True if an element was taken, false if the queue was empty</returns>
+    public: bool TryTakeMin(TElement &element) {
+      if(this->heapCount < 2) {
+        return takeFromAnyHeap(element);
+      }
+
+      for(std::size_t attempt = 0; attempt < MaximumAttemptCount; ++attempt) {
+        std::uint64_t random = getRandomNumber();
+        Heap *first = &this->heaps[static_cast<std::size_t>(random % this->heapCount)];
+        Heap *second = &this->heaps[
+          static_cast<std::size_t>((random >> 32) % this->heapCount)
+        ];
+        if(isEmpty(*first) && isEmpty(*second)) {
+          continue;
+        }
+        if(!first->Lock.TryLock()) {
+          continue;
+        }
+        ON_SCOPE_EXIT { first->Lock.Unlock(); };
+
+        // If the second heap is busy or the same, settle for the first one
+        if((second == first) || !second->Lock.TryLock()) {
+          if(first->Elements.empty()) {
+            continue;
+          }
+          takeFromHeap(*first, element);
+          return true;
+        }
+        ON_SCOPE_EXIT { second->Lock.Unlock(); };
+
+        Heap *chosen = pickHeapWithSmallerTop(*first, *second);
+        if(chosen != nullptr) {
+          takeFromHeap(*chosen, element);
+          return true;
+        }
+      }
+
+      // Either the queue is almost empty or the heaps are very busy
+      return takeFromAnyHeap(element);
+    }
+
+    /// <summary>Counts the number of elements currently in the queue</summary>
+    /// <returns>
+    ///   The approximate number of elements that had been in the queue during the call
+    /// </returns>
+    public: std::size_t Count() const override {
+      std::size_t count = 0;
+      for(std::size_t index = 0; index < this->heapCount; ++index) {
+        count += this->heaps[index].Count.load(std::memory_order_relaxed);
+      }
+
+      return count;
+    }
+
+    /// <summary>Checks if the queue is empty</summary>
+    /// <returns>True if the queue had been empty during the call</returns>
+    public: bool IsEmpty() const override {
+      for(std::size_t index = 0; index < this->heapCount; ++index) {
+        if(!isEmpty(this->heaps[index])) {
+          return false;
+        }
+      }
+
+      return true;
+    }
+
+    /// <summary>Number of random picks before heaps are tried one by one</summary>
+    private: static const constexpr std::size_t MaximumAttemptCount = 4;
+
+    #pragma region struct Heap
+
+    /// <summary>Binary heap holding part of the elements</summary>
+    private: struct alignas(64) Heap {
+
+      /// <summary>Initializes a new, empty heap</summary>
+      public: Heap() :
+        Lock(),
+        Elements(),
+        Count(0) {}
+
+      /// <summary>Must be held to access the elements</summary>
+      public: Threading::Mutex Lock;
+      /// <summary>Elements arranged as a binary heap with the smallest element first</summary>
+      public: std::vector<TElement> Elements;
+      /// <summary>Number of elements in the heap, readable without the lock</summary>
+      public: std::atomic<std::size_t> Count;
+
+    };
+
+    #pragma endregion // struct Heap
+
+    #pragma region struct LaterFirst
+
+    /// <summary>Reverses the comparison so the standard heap puts the smallest first</summary>
+    private: struct LaterFirst {
+
+      /// <summary>Initializes a new reversed comparison</summary>
+      /// <param name="comparer">Comparison that will be reversed</param>
+      public: explicit LaterFirst(const TCompare &comparer) :
+        comparer(comparer) {}
+
+      /// <summary>Checks whether the left element comes after the right one</summary>
+      /// <param name="left">Element that will be checked</param>
+      /// <param name="right">Element the checked element will be compared against</param>
+      /// <returns>True if the left element comes after the right one</returns>
+      public: bool operator()(const TElement &left, const TElement &right) const {
+        return this->comparer(right, left);
+      }
+
+      /// <summary>Comparison that is being reversed</summary>
+      private: const TCompare &comparer;
+
+    };
+
+    #pragma endregion // struct LaterFirst
+
+    /// <summary>Decides how many heaps to use if no number was specified</summary>
+    /// <param name="heapCount">Number of heaps requested by the user</param>
+    /// <returns>The number of heaps the queue will use</returns>
+    private: static std::size_t getHeapCount(std::size_t heapCount) {
+      if(heapCount > 0) {
+        return heapCount;
+      }
+
+      std::size_t processorCount = std::thread::hardware_concurrency();
+      return (processorCount < 2) ? 4 : (processorCount * 2);
+    }
+
+    /// <summary>Generates a random number for picking heaps</summary>
+    /// <returns>A random number</returns>
+    private: static std::uint64_t getRandomNumber() {
+      thread_local std::uint64_t state = reinterpret_cast<std::uintptr_t>(&state) | 1;
+      state = BitTricks::XorShiftRandom(state);
+      return state;
+    }
+
+    /// <summary>Checks whether a heap looks empty without locking it</summary>
+    /// <param name="heap">Heap that will be checked</param>
+    /// <returns>True if the heap looked empty</returns>
+    private: static bool isEmpty(const Heap &heap) {
+      return (heap.Count.load(std::memory_order_relaxed) == 0);
+    }
+
+    /// <summary>Locks a randomly chosen heap, preferring heaps nobody else is using</summary>
+    /// <returns>The heap that has been locked</returns>
+    private: Heap &lockRandomHeap() {
+      for(std::size_t attempt = 0; attempt < MaximumAttemptCount; ++attempt) {
+        Heap &heap = this->heaps[static_cast<std::size_t>(getRandomNumber() % this->heapCount)];
+        if(heap.Lock.TryLock()) {
+          return heap;
+        }
+      }
+
+      Heap &heap = this->heaps[static_cast<std::size_t>(getRandomNumber() % this->heapCount)];
+      heap.Lock.Lock();
+      return heap;
+    }
+
+    /// <summary>Picks whichever of two locked heaps has the smaller first element</summary>
+    /// <param name="first">First heap that will be considered</param>
+    /// <param name="second">Second heap that will be considered</param>
+    /// <returns>The heap with the smaller first element or null if both are empty</returns>
+    private: Heap *pickHeapWithSmallerTop(Heap &first, Heap &second) const {
+      if(first.Elements.empty()) {
+        return second.Elements.empty() ? nullptr : &second;
+      }
+      if(second.Elements.empty()) {
+        return &first;
+      }
+
+      if(this->comparer(second.Elements.front(), first.Elements.front())) {
+        return &second;
+      } else {
+        return &first;
+      }
+    }
+
+    /// <summary>Takes the first element from a locked heap that is not empty</summary>
+    /// <param name="heap">Heap the element will be taken from</param>
+    /// <param name="element">Will receive the element taken from the heap</param>
+    private: void takeFromHeap(Heap &heap, TElement &element) {
+      std::pop_heap(heap.Elements.begin(), heap.Elements.end(), LaterFirst(this->comparer));
+      try {
+        element = std::move(heap.Elements.back());
+      }
+      catch(...) {
+        std::push_heap(heap.Elements.begin(), heap.Elements.end(), LaterFirst(this->comparer));
+        throw;
+      }
+
+      heap.Elements.pop_back();
+      heap.Count.store(heap.Elements.size(), std::memory_order_relaxed);
+    }
+
+    /// <summary>Goes through all heaps and takes an element from the first non-empty one</summary>
+    /// <param name="element">Will receive the element taken from the queue</param>
+    /// <returns>True if an element was taken, false if all heaps were empty</returns>
+    private: bool takeFromAnyHeap(TElement &element) {
+      std::size_t startIndex = static_cast<std::size_t>(getRandomNumber() % this->heapCount);
+      for(std::size_t index = 0; index < this->heapCount; ++index) {
+        Heap &heap = this->heaps[(startIndex + index) % this->heapCount];
+        if(isEmpty(heap)) {
+          continue;
+        }
+
+        heap.Lock.Lock();
+        ON_SCOPE_EXIT { heap.Lock.Unlock(); };
+        if(!heap.Elements.empty()) {
+          takeFromHeap(heap, element);
+          return true;
+        }
+      }
+
+      return false;
+    }
+
+    private: ConcurrentMultiQueue(const ConcurrentMultiQueue &) = delete;
+    private: ConcurrentMultiQueue &operator =(const ConcurrentMultiQueue &) = delete;
+
+    /// <summary>Number of heaps the elements are spread over</summary>
+    private: const std::size_t heapCount;
+    /// <summary>Heaps holding the elements</summary>
+    private: const std::unique_ptr<Heap[]> heaps;
+    /// <summary>Decides which of two elements comes first</summary>
+    private: TCompare comparer;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Collections
+
+#endif // defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+
+#endif // NUCLEX_SUPPORT_COLLECTIONS_CONCURRENTMULTIQUEUE_H
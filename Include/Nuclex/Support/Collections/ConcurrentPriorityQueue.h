@@ -0,0 +1,438 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+#ifndef NUCLEX_SUPPORT_COLLECTIONS_CONCURRENTPRIORITYQUEUE_H
+#define NUCLEX_SUPPORT_COLLECTIONS_CONCURRENTPRIORITYQUEUE_H
+
+#include "Nuclex/Support/Config.h"
+#include "Nuclex/Support/Collections/ConcurrentCollection.h"
+#include "Nuclex/Support/Threading/EpochDomain.h" // for EpochDomain
+#include "Nuclex/Support/BitTricks.h" // for BitTricks::XorShiftRandom()
+
+#include <cstddef> // for std::size_t, std::ptrdiff_t
+#include <cstdint> // for std::uintptr_t, std::uint64_t
+#include <atomic> // for std::atomic
+#include <functional> // for std::less
+
+namespace Nuclex { namespace Support { namespace Collections {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Priority queue that can be used from any number of threads</summary>
+  /// <typeparam name="TElement">Type of elements stored in the queue</typeparam>
+  /// <typeparam name="TCompare">Comparison that decides which element comes first</typeparam>
+  /// <remarks>
+  ///   <para>
+  ///     <strong>Thread safety:</strong> any number of producers and consumers, lock-free
+  ///   </para>
+  ///   <para>
+  ///     <strong>Container type:</strong> skip list ordered by priority
+  ///   </para>
+  ///   <para>
+  ///     This follows Hakan Sundell's lock-free priority queue (see the paper in
+  ///     the Documents directory): elements are kept sorted in a skip list, appending
+  ///     inserts an element at its place and taking claims the first element that no
+  ///     other thread has claimed yet. Links are marked before they're cut, so inserting
+  ///     and taking threads never lock each other out. Instead of the paper's reference
+  ///     counting, removed nodes are freed through an <see cref="Threading::EpochDomain" />.
+  ///   </para>
+  ///   <para>
+  ///     Taking an element is only guaranteed to return the smallest element if no other
+  ///     thread appends an element at the same time. An element appended while a thread
+  ///     is looking for the smallest element may be skipped by that thread. Elements that
+  ///     compare as equal are taken in no particular order.
+  ///   </para>
+  ///   <para>
+  ///     Because other threads may still compare against an element while it is being
+  ///     taken, it is copied out of the queue rather than moved. If copying it throws,
+  ///     the exception is passed on and the element stays in the queue.
+  ///   </para>
+  ///   <para>
+  ///     All threads taking elements compete for the front of the queue. If the order
+  ///     of elements doesn't have to be exact, <see cref="ConcurrentMultiQueue" /> will
+  ///     scale much better with the number of threads.
+  ///   </para>
+  /// </remarks>
+  template<typename TElement, typename TCompare = std::less<TElement>>
+  class ConcurrentPriorityQueue : public ConcurrentCollection<
+    TElement, ConcurrentAccessBehavior::MultipleProducersMultipleConsumers
+  > {
+
+    /// <summary>Maximum number of levels in the skip list</summary>
+    /// <remarks>
+    ///   Each level holds about a quarter of the nodes in the level below it, so this
+    ///   is enough for the queue to stay fast with billions of elements in it.
+    /// </remarks>
+    public: static const constexpr std::size_t MaximumHeight = 16;
+
+    /// <summary>Initializes a new concurrent priority queue</summary>
+    public: ConcurrentPriorityQueue() :
+      head(),
+      count(0),
+      reclamation(),
+      comparer() {}
+
+    /// <summary>Destroys the queue and all elements still in it</summary>
+    /// <remarks>
+    ///   No other thread may access the queue anymore when it is destroyed.
+    /// </remarks>
+    public: ~ConcurrentPriorityQueue() override {
+      Node *node = toNode(this->head.Next[0].load(std::memory_order_acquire));
+      while(node != nullptr) {
+        Node *next = toNode(node->Next[0].load(std::memory_order_relaxed));
+        delete node;
+        node = next;
+      }
+    }
+
+    /// <summary>Inserts an element into the queue</summary>
+    /// <param name="element">Element that will be inserted into the queue</param>
+    /// <returns>Always true, the queue is unbounded</returns>
+    public: bool TryAppend(const TElement &element) override {
+      Node *node = new Node(element, getRandomHeight());
+      {
+        Threading::EpochDomain::ReadScope scope(this->reclamation);
+        insertNode(node);
+      }
+
+      this->count.fetch_add(1, std::memory_order_relaxed);
+      return true;
+    }
+
+    /// <summary>Takes the smallest element from the queue</summary>
+    /// <param name="element">Will receive the element taken from the queue</param>
+    /// <returns>True if an element was taken, false if the queue was empty</returns>
+    /// <remarks>
+    ///   This is the same as <see cref="TryTakeMin" />.
+    /// </remarks>
+    public: bool TryTake(TElement &element) override {
+      return TryTakeMin(element);
+    }
+
+    /// <summary>Takes the smallest element from the queue</summary>
+    /// <param name="element">Will receive the element taken from the queue</param>
+    /// <returns>True if an element was taken, false if the queue was empty</returns>
+    public: bool TryTakeMin(TElement &element) {
+      Threading::EpochDomain::ReadScope scope(this->reclamation);
+
+      Node *node = toNode(this->head.Next[0].load(std::memory_order_acquire));
+      while(node != nullptr) {
+        if(!node->IsTaken.load(std::memory_order_relaxed)) {
+          if(!node->IsTaken.exchange(true, std::memory_order_acquire)) {
+            try {
+              element = node->Element;
+            }
+            catch(...) {
+              node->IsTaken.store(false, std::memory_order_release);
+              throw;
+            }
+
+            removeNode(node);
+            this->count.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+          }
+        }
+
+        node = toNode(node->Next[0].load(std::memory_order_acquire));
+      }
+
+      return false;
+    }
+
+    /// <summary>Counts the number of elements currently in the queue</summary>
+    /// <returns>
+    ///   The approximate number of elements that had been in the queue during the call
+    /// </returns>
+    public: std::size_t Count() const override {
+      std::ptrdiff_t currentCount = this->count.load(std::memory_order_relaxed);
+      return (currentCount > 0) ? static_cast<std::size_t>(currentCount) : 0;
+    }
+
+    /// <summary>Checks if the queue is empty</summary>
+    /// <returns>True if the queue had been empty during the call</returns>
+    public: bool IsEmpty() const override {
+      return (this->count.load(std::memory_order_relaxed) <= 0);
+    }
+
+    /// <summary>Flag in a link that is set when the node holding the link is removed</summary>
+    private: static const constexpr std::uintptr_t MarkedBit = 1;
+    /// <summary>Flag in a node's state set once the inserting thread is done with it</summary>
+    private: static const constexpr std::uint8_t InsertedFlag = 1;
+    /// <summary>Flag in a node's state set once the taking thread is done with it</summary>
+    private: static const constexpr std::uint8_t RemovedFlag = 2;
+
+    #pragma region struct Tower
+
+    /// <summary>Links to the following nodes on each level of the skip list</summary>
+    private: struct Tower {
+
+      /// <summary>Initializes a new tower with all links empty</summary>
+      public: Tower() {
+        for(std::size_t level = 0; level < MaximumHeight; ++level) {
+          this->Next[level].store(0, std::memory_order_relaxed);
+        }
+      }
+
+      /// <summary>Next node on each level, with the marked flag</summary>
+      public: std::atomic<std::uintptr_t> Next[MaximumHeight];
+
+    };
+
+    #pragma endregion // struct Tower
+
+    #pragma region struct Node
+
+    /// <summary>Stores an element in the skip list</summary>
+    private: struct Node : public Tower {
+
+      /// <summary>Initializes a new node</summary>
+      /// <param name="element">Element that will be stored in the node</param>
+      /// <param name="height">Number of levels the node will be linked into</param>
+      public: Node(const TElement &element, std::size_t height) :
+        Tower(),
+        Element(element),
+        Height(height),
+        IsTaken(false),
+        State(0) {}
+
+      /// <summary>Element that is stored in the node</summary>
+      public: const TElement Element;
+      /// <summary>Number of levels the node will be linked into</summary>
+      public: const std::size_t Height;
+      /// <summary>Whether a thread has claimed the element</summary>
+      public: std::atomic<bool> IsTaken;
+      /// <summary>Whether the inserting and taking threads are done with the node</summary>
+      public: std::atomic<std::uint8_t> State;
+
+    };
+
+    #pragma endregion // struct Node
+
+    /// <summary>Extracts the node pointer from a link</summary>
+    /// <param name="link">Link including the marked flag</param>
+    /// <returns>The node the link points to</returns>
+    private: static Node *toNode(std::uintptr_t link) {
+      return reinterpret_cast<Node *>(link & ~MarkedBit);
+    }
+
+    /// <summary>Turns a node pointer into an unmarked link</summary>
+    /// <param name="node">Node the link will point to</param>
+    /// <returns>A link to the node</returns>
+    private: static std::uintptr_t toLink(const Node *node) {
+      return reinterpret_cast<std::uintptr_t>(node);
+    }
+
+    /// <summary>Picks the number of levels for a new node</summary>
+    /// <returns>The number of levels the new node will be linked into</returns>
+    private: static std::size_t getRandomHeight() {
+      thread_local std::uint64_t state = reinterpret_cast<std::uintptr_t>(&state) | 1;
+      state = BitTricks::XorShiftRandom(state);
+
+      std::uint64_t bits = state;
+      std::size_t height = 1;
+      while(((bits & 3) == 0) && (height < MaximumHeight)) {
+        ++height;
+        bits >>= 2;
+      }
+
+      return height;
+    }
+
+    /// <summary>Checks whether a node comes before another node in the skip list</summary>
+    /// <param name="node">Node that will be checked</param>
+    /// <param name="other">Node it will be compared against</param>
+    /// <returns>True if the node comes before the other node</returns>
+    /// <remarks>
+    ///   Nodes with equal elements are ordered by their address, so each node has
+    ///   a unique place in the skip list.
+    /// </remarks>
+    private: bool isBefore(const Node &node, const Node &other) const {
+      if(this->comparer(node.Element, other.Element)) {
+        return true;
+      }
+      if(this->comparer(other.Element, node.Element)) {
+        return false;
+      }
+
+      return std::less<const Node *>()(&node, &other);
+    }
+
+    /// <summary>Looks for the place of a node on each level of the skip list</summary>
+    /// <param name="key">Node whose place will be looked for</param>
+    /// <param name="predecessors">Receives the tower before the place on each level</param>
+    /// <param name="successors">Receives the node after the place on each level</param>
+    /// <remarks>
+    ///   Any removed nodes encountered on the way are unlinked. If the key itself has
+    ///   been removed, it is thus no longer linked on any level afterwards.
+    /// </remarks>
+    private: void findPlace(const Node &key, Tower **predecessors, Node **successors) {
+      for(;;) {
+        Tower *predecessor = &this->head;
+        bool mustRetry = false;
+
+        std::size_t level = MaximumHeight;
+        while(level > 0) {
+          --level;
+
+          Node *current = toNode(predecessor->Next[level].load(std::memory_order_acquire));
+          while(current != nullptr) {
+            std::uintptr_t successor = current->Next[level].load(std::memory_order_acquire);
+            if((successor & MarkedBit) != 0) {
+              std::uintptr_t expected = toLink(current);
+              bool wasUnlinked = predecessor->Next[level].compare_exchange_strong(
+                expected, successor & ~MarkedBit,
+                std::memory_order_acq_rel, std::memory_order_relaxed
+              );
+              if(unlikely(!wasUnlinked)) {
+                mustRetry = true; // The predecessor was removed or a node was inserted
+                break;
+              }
+              current = toNode(successor);
+            } else if(isBefore(*current, key)) {
+              predecessor = current;
+              current = toNode(successor);
+            } else {
+              break;
+            }
+          }
+          if(unlikely(mustRetry)) {
+            break;
+          }
+
+          predecessors[level] = predecessor;
+          successors[level] = current;
+        }
+
+        if(likely(!mustRetry)) {
+          return;
+        }
+      }
+    }
+
+    /// <summary>Links a new node into the skip list</summary>
+    /// <param name="node">Node that will be linked into the skip list</param>
+    private: void insertNode(Node *node) {
+      Tower *predecessors[MaximumHeight];
+      Node *successors[MaximumHeight];
+
+      // Once the node is linked on the lowest level, it is part of the queue
+      for(;;) {
+        findPlace(*node, predecessors, successors);
+        for(std::size_t level = 0; level < node->Height; ++level) {
+          node->Next[level].store(toLink(successors[level]), std::memory_order_relaxed);
+        }
+
+        std::uintptr_t expected = toLink(successors[0]);
+        bool wasLinked = predecessors[0]->Next[0].compare_exchange_strong(
+          expected, toLink(node), std::memory_order_release, std::memory_order_relaxed
+        );
+        if(likely(wasLinked)) {
+          break;
+        }
+      }
+
+      // The upper levels only speed up the search. If the node is taken while it is
+      // still being linked, the remaining levels are skipped.
+      for(std::size_t level = 1; level < node->Height; ++level) {
+        bool isRemoved = false;
+        for(;;) {
+          std::uintptr_t link = node->Next[level].load(std::memory_order_acquire);
+          if((link & MarkedBit) != 0) {
+            isRemoved = true;
+            break;
+          }
+          if(toNode(link) != successors[level]) {
+            bool wasUpdated = node->Next[level].compare_exchange_strong(
+              link, toLink(successors[level]),
+              std::memory_order_release, std::memory_order_relaxed
+            );
+            if(!wasUpdated) {
+              continue; // The node was taken, the link is marked now
+            }
+          }
+
+          std::uintptr_t expected = toLink(successors[level]);
+          bool wasLinked = predecessors[level]->Next[level].compare_exchange_strong(
+            expected, toLink(node), std::memory_order_release, std::memory_order_relaxed
+          );
+          if(likely(wasLinked)) {
+            break;
+          }
+
+          findPlace(*node, predecessors, successors);
+        }
+        if(isRemoved) {
+          break;
+        }
+      }
+
+      finishNode(node, InsertedFlag);
+    }
+
+    /// <summary>Removes a node that has been claimed from the skip list</summary>
+    /// <param name="node">Node that will be removed</param>
+    private: void removeNode(Node *node) {
+      for(std::size_t level = node->Height; level > 0;) {
+        --level;
+        node->Next[level].fetch_or(MarkedBit, std::memory_order_acq_rel);
+      }
+
+      finishNode(node, RemovedFlag);
+    }
+
+    /// <summary>Records that the inserting or taking thread is done with a node</summary>
+    /// <param name="node">Node the inserting or taking thread is done with</param>
+    /// <param name="flag">Flag of the thread that is done with the node</param>
+    /// <remarks>
+    ///   A node can be taken while it is still being linked into the upper levels. Only
+    ///   when both threads are done can all links to the node be cut, so whichever thread
+    ///   finishes second unlinks the node and hands it to the epoch domain.
+    /// </remarks>
+    private: void finishNode(Node *node, std::uint8_t flag) {
+      std::uint8_t previousState = node->State.fetch_or(flag, std::memory_order_acq_rel);
+      if(previousState == 0) {
+        return; // The other thread is still busy with the node
+      }
+
+      Tower *predecessors[MaximumHeight];
+      Node *successors[MaximumHeight];
+      findPlace(*node, predecessors, successors);
+
+      this->reclamation.Retire(node);
+    }
+
+    private: ConcurrentPriorityQueue(const ConcurrentPriorityQueue &) = delete;
+    private: ConcurrentPriorityQueue &operator =(const ConcurrentPriorityQueue &) = delete;
+
+    /// <summary>Links to the first node on each level of the skip list</summary>
+    private: alignas(64) Tower head;
+    /// <summary>Number of elements currently in the queue</summary>
+    private: alignas(64) std::atomic<std::ptrdiff_t> count;
+    /// <summary>Keeps removed nodes alive while other threads may still look at them</summary>
+    private: Threading::EpochDomain reclamation;
+    /// <summary>Decides which of two elements comes first</summary>
+    private: TCompare comparer;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Collections
+
+#endif // NUCLEX_SUPPORT_COLLECTIONS_CONCURRENTPRIORITYQUEUE_H
@@ -0,0 +1,391 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+#if !defined(NUCLEX_SUPPORT_COLLECTIONS_CONCURRENTRINGBUFFER_H)
+#error This header must be included via ConcurrentRingBuffer.h
+#endif
+
+namespace Nuclex { namespace Support { namespace Collections {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Fixed-size circular buffer for any number of producers and consumers</summary>
+  /// <typeparam name="TElement">Type of elements stored in the buffer</typeparam>
+  /// <remarks>
+  ///   <para>
+  ///     This is Dmitry Vyukov's bounded MPMC queue. Each slot carries a sequence number
+  ///     that tells whether it is free for the producer at a given position (sequence equals
+  ///     the position) or filled for the consumer at a given position (sequence equals the
+  ///     position plus one). Producers and consumers claim positions with a compare-and-swap
+  ///     on their respective index only after checking the slot's sequence number, so
+  ///     a failed append or take never modifies shared state.
+  ///   </para>
+  ///   <para>
+  ///     Batch operations check the sequence numbers of several consecutive slots and
+  ///     claim all of them with a single compare-and-swap.
+  ///   </para>
+  ///   <para>
+  ///     If copying an element throws while appending, the claimed slot is published
+  ///     empty and consumers skip it. If moving an element out throws while taking,
+  ///     the element is destroyed and lost. Taking a batch requires elements that can be
+  ///     move-assigned without throwing since a batch of claimed slots can neither be
+  ///     handed back to the buffer nor partially delivered through an exception.
+  ///   </para>
+  /// </remarks>
+  template<typename TElement>
+  class ConcurrentRingBuffer<
+    TElement, ConcurrentAccessBehavior::MultipleProducersMultipleConsumers
+  > : public ConcurrentCollection<
+    TElement, ConcurrentAccessBehavior::MultipleProducersMultipleConsumers
+  > {
+
+    /// <summary>Initializes a new concurrent ring buffer</summary>
+    /// <param name="capacity">
+    ///   Minimum number of elements the buffer can hold, rounded up to a power of two
+    ///   of at least 2
+    /// </param>
+    public: explicit ConcurrentRingBuffer(std::size_t capacity) :
+      capacity(getSlotCount(capacity)),
+      slots(new Slot[getSlotCount(capacity)]),
+      writeIndex(0),
+      readIndex(0) {
+      for(std::size_t index = 0; index < this->capacity; ++index) {
+        this->slots[index].Sequence.store(index, std::memory_order_relaxed);
+      }
+    }
+
+    /// <summary>Destroys the ring buffer and all elements still in it</summary>
+    public: ~ConcurrentRingBuffer() override {
+      std::size_t endIndex = this->writeIndex.load(std::memory_order_acquire);
+      for(
+        std::size_t index = this->readIndex.load(std::memory_order_acquire);
+        index != endIndex;
+        ++index
+      ) {
+        Slot &slot = getSlot(index);
+        if(slot.HoldsElement) {
+          reinterpret_cast<TElement *>(slot.Storage)->~TElement();
+        }
+      }
+    }
+
+    /// <summary>Looks up the number of elements the buffer can hold</summary>
+    /// <returns>The maximum number of elements the buffer can hold</returns>
+    public: std::size_t GetCapacity() const {
+      return this->capacity;
+    }
+
+    /// <summary>Tries to append an element to the buffer</summary>
+    /// <param name="element">Element that will be appended to the buffer</param>
+    /// <returns>True if the element was appended, false if the buffer was full</returns>
+    public: bool TryAppend(const TElement &element) override {
+      std::size_t position = this->writeIndex.load(std::memory_order_relaxed);
+      for(;;) {
+        std::ptrdiff_t difference = static_cast<std::ptrdiff_t>(
+          getSlot(position).Sequence.load(std::memory_order_acquire) - position
+        );
+        if(likely(difference == 0)) {
+          bool wasClaimed = this->writeIndex.compare_exchange_weak(
+            position, position + 1, std::memory_order_relaxed
+          );
+          if(likely(wasClaimed)) {
+            break;
+          }
+        } else if(difference < 0) {
+          return false; // Slot still holds the element from the previous lap, buffer is full
+        } else {
+          position = this->writeIndex.load(std::memory_order_relaxed);
+        }
+      }
+
+      fillSlot(position, element);
+      return true;
+    }
+
+    /// <summary>Tries to append a batch of elements to the buffer</summary>
+    /// <param name="first">Address of the first element that will be appended</param>
+    /// <param name="count">Number of elements that should be appended</param>
+    /// <returns>The number of elements that were appended, less if the buffer was full</returns>
+    public: std::size_t TryAppend(const TElement *first, std::size_t count) {
+      if(unlikely(count == 0)) {
+        return 0;
+      }
+
+      std::size_t position = this->writeIndex.load(std::memory_order_relaxed);
+      for(;;) {
+
+        // See how many consecutive slots are free for this lap. Once a slot is seen free,
+        // it stays free until the producer who claimed its position fills it.
+        std::size_t freeSlotCount = 0;
+        std::ptrdiff_t difference;
+        do {
+          difference = static_cast<std::ptrdiff_t>(
+            getSlot(position + freeSlotCount).Sequence.load(std::memory_order_acquire) -
+            (position + freeSlotCount)
+          );
+          if(difference != 0) {
+            break;
+          }
+          ++freeSlotCount;
+        } while(freeSlotCount < count);
+
+        if(freeSlotCount == 0) {
+          if(difference < 0) {
+            return 0; // Slot still holds the element from the previous lap, buffer is full
+          }
+          position = this->writeIndex.load(std::memory_order_relaxed);
+        } else {
+          bool wereClaimed = this->writeIndex.compare_exchange_weak(
+            position, position + freeSlotCount, std::memory_order_relaxed
+          );
+          if(likely(wereClaimed)) {
+            count = freeSlotCount;
+            break;
+          }
+        }
+
+      } // for(;;)
+
+      std::size_t appendedCount = 0;
+      try {
+        while(appendedCount < count) {
+          fillSlot(position + appendedCount, first[appendedCount]);
+          ++appendedCount;
+        }
+      }
+      catch(...) {
+        ++appendedCount; // fillSlot() already published the failed slot as empty
+        while(appendedCount < count) {
+          publishEmptySlot(position + appendedCount);
+          ++appendedCount;
+        }
+        throw;
+      }
+
+      return count;
+    }
+
+    /// <summary>Tries to take an element from the buffer</summary>
+    /// <param name="element">Will receive the element taken from the buffer</param>
+    /// <returns>True if an element was taken, false if the buffer was empty</returns>
+    public: bool TryTake(TElement &element) override {
+      std::size_t position = this->readIndex.load(std::memory_order_relaxed);
+      for(;;) {
+        Slot &slot = getSlot(position);
+        std::ptrdiff_t difference = static_cast<std::ptrdiff_t>(
+          slot.Sequence.load(std::memory_order_acquire) - (position + 1)
+        );
+        if(likely(difference == 0)) {
+          bool wasClaimed = this->readIndex.compare_exchange_weak(
+            position, position + 1, std::memory_order_relaxed
+          );
+          if(likely(wasClaimed)) {
+            if(likely(emptySlot(position, &element))) {
+              return true;
+            }
+            position = this->readIndex.load(std::memory_order_relaxed); // skip empty slot
+          }
+        } else if(difference < 0) {
+          return false; // Slot hasn't been filled for this lap yet, buffer is empty
+        } else {
+          position = this->readIndex.load(std::memory_order_relaxed);
+        }
+      }
+    }
+
+    /// <summary>Tries to take a batch of elements from the buffer</summary>
+    /// <param name="first">Address at which the taken elements will be stored</param>
+    /// <param name="maximumCount">Maximum number of elements that will be taken</param>
+    /// <returns>The number of elements that were taken, less if the buffer ran empty</returns>
+    public: std::size_t TryTake(TElement *first, std::size_t maximumCount) {
+      static_assert(
+        std::is_nothrow_move_assignable<TElement>::value &&
+        u8"Taking a batch of elements requires a non-throwing move assignment operator"
+      );
+      if(unlikely(maximumCount == 0)) {
+        return 0;
+      }
+
+      std::size_t position = this->readIndex.load(std::memory_order_relaxed);
+      std::size_t claimedCount;
+      for(;;) {
+
+        // See how many consecutive slots are filled for this lap. Once a slot is seen
+        // filled, it stays filled until the consumer who claimed its position empties it.
+        claimedCount = 0;
+        std::ptrdiff_t difference;
+        do {
+          difference = static_cast<std::ptrdiff_t>(
+            getSlot(position + claimedCount).Sequence.load(std::memory_order_acquire) -
+            (position + claimedCount + 1)
+          );
+          if(difference != 0) {
+            break;
+          }
+          ++claimedCount;
+        } while(claimedCount < maximumCount);
+
+        if(claimedCount == 0) {
+          if(difference < 0) {
+            return 0; // Slot hasn't been filled for this lap yet, buffer is empty
+          }
+          position = this->readIndex.load(std::memory_order_relaxed);
+        } else {
+          bool wereClaimed = this->readIndex.compare_exchange_weak(
+            position, position + claimedCount, std::memory_order_relaxed
+          );
+          if(likely(wereClaimed)) {
+            break;
+          }
+        }
+
+      } // for(;;)
+
+      std::size_t takenCount = 0;
+      for(std::size_t index = 0; index < claimedCount; ++index) {
+        if(emptySlot(position + index, first + takenCount)) {
+          ++takenCount;
+        }
+      }
+
+      // If all claimed slots were published empty by failed appends, try again
+      if(unlikely(takenCount == 0)) {
+        return TryTake(first, maximumCount);
+      }
+
+      return takenCount;
+    }
+
+    /// <summary>Counts the number of elements currently in the buffer</summary>
+    /// <returns>
+    ///   The approximate number of elements that had been in the buffer during the call
+    /// </returns>
+    public: std::size_t Count() const override {
+      std::size_t index = this->readIndex.load(std::memory_order_acquire);
+      std::size_t count = this->writeIndex.load(std::memory_order_acquire) - index;
+      return (count < this->capacity) ? count : this->capacity;
+    }
+
+    /// <summary>Checks if the buffer is empty</summary>
+    /// <returns>True if the buffer had been empty during the call</returns>
+    public: bool IsEmpty() const override {
+      std::size_t index = this->readIndex.load(std::memory_order_acquire);
+      return (this->writeIndex.load(std::memory_order_acquire) == index);
+    }
+
+    #pragma region struct Slot
+
+    /// <summary>Sequence number and uninitialized memory for one element</summary>
+    private: struct Slot {
+
+      /// <summary>Position for which the slot is free or, plus one, filled</summary>
+      public: std::atomic<std::size_t> Sequence;
+      /// <summary>False if copying the element failed and the slot should be skipped</summary>
+      public: bool HoldsElement;
+      /// <summary>Memory in which the element is constructed</summary>
+      public: alignas(TElement) std::uint8_t Storage[sizeof(TElement)];
+
+    };
+
+    #pragma endregion // struct Slot
+
+    /// <summary>Looks up the slot for the specified position</summary>
+    /// <param name="position">Position whose slot will be returned</param>
+    /// <returns>The slot for the specified position</returns>
+    private: Slot &getSlot(std::size_t position) const {
+      return this->slots[position & (this->capacity - 1)];
+    }
+
+    /// <summary>Copies an element into a claimed slot and hands it to the consumers</summary>
+    /// <param name="position">Position the calling producer has claimed</param>
+    /// <param name="element">Element that will be copied into the slot</param>
+    private: void fillSlot(std::size_t position, const TElement &element) {
+      Slot &slot = getSlot(position);
+      try {
+        new(slot.Storage) TElement(element);
+      }
+      catch(...) {
+        publishEmptySlot(position);
+        throw;
+      }
+
+      slot.HoldsElement = true;
+      slot.Sequence.store(position + 1, std::memory_order_release);
+    }
+
+    /// <summary>Hands a claimed slot to the consumers without an element in it</summary>
+    /// <param name="position">Position the calling producer has claimed</param>
+    private: void publishEmptySlot(std::size_t position) {
+      Slot &slot = getSlot(position);
+      slot.HoldsElement = false;
+      slot.Sequence.store(position + 1, std::memory_order_release);
+    }
+
+    /// <summary>Moves the element out of a claimed slot and hands it to the producers</summary>
+    /// <param name="position">Position the calling consumer has claimed</param>
+    /// <param name="element">Receives the element</param>
+    /// <returns>True if the slot held an element, false if it was published empty</returns>
+    private: bool emptySlot(std::size_t position, TElement *element) {
+      Slot &slot = getSlot(position);
+      if(unlikely(!slot.HoldsElement)) {
+        slot.Sequence.store(position + this->capacity, std::memory_order_release);
+        return false;
+      }
+
+      TElement *stored = reinterpret_cast<TElement *>(slot.Storage);
+      ON_SCOPE_EXIT {
+        stored->~TElement();
+        slot.Sequence.store(position + this->capacity, std::memory_order_release);
+      };
+      *element = std::move(*stored);
+
+      return true;
+    }
+
+    /// <summary>Calculates the number of slots for the requested capacity</summary>
+    /// <param name="capacity">Number of elements the buffer should be able to hold</param>
+    /// <returns>The number of slots, a power of two of at least 2</returns>
+    /// <remarks>
+    ///   A slot's sequence number tells producers and consumers whether the slot is full
+    ///   or free by comparing it against their position. With a single slot, the positions
+    ///   of a full and a free slot are indistinguishable, so at least two slots are used.
+    /// </remarks>
+    private: static std::size_t getSlotCount(std::size_t capacity) {
+      if(capacity < 2) {
+        return 2;
+      }
+
+      return static_cast<std::size_t>(BitTricks::GetUpperPowerOfTwo(capacity));
+    }
+
+    /// <summary>Number of elements the buffer can hold, always a power of two</summary>
+    private: const std::size_t capacity;
+    /// <summary>Slots holding the elements and their sequence numbers</summary>
+    private: const std::unique_ptr<Slot[]> slots;
+
+    /// <summary>Next position producers will claim</summary>
+    private: alignas(64) std::atomic<std::size_t> writeIndex;
+    /// <summary>Next position consumers will claim</summary>
+    private: alignas(64) std::atomic<std::size_t> readIndex;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Collections
@@ -0,0 +1,253 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+#if !defined(NUCLEX_SUPPORT_COLLECTIONS_CONCURRENTRINGBUFFER_H)
+#error This header must be included via ConcurrentRingBuffer.h
+#endif
+
+namespace Nuclex { namespace Support { namespace Collections {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Fixed-size circular buffer for one producer thread and one consumer thread</summary>
+  /// <typeparam name="TElement">Type of elements stored in the buffer</typeparam>
+  /// <remarks>
+  ///   <para>
+  ///     Only a single thread may append elements and only a single (other) thread may
+  ///     take elements at any given time. No read-modify-write operations are needed, each
+  ///     side only publishes its position with a release store.
+  ///   </para>
+  ///   <para>
+  ///     The producer's and the consumer's positions live on separate cache lines, each
+  ///     together with a cached copy of the other side's position. The other side's cache
+  ///     line is only touched when the cached position says the buffer is full (producer)
+  ///     or empty (consumer), so while the buffer is neither, both threads work entirely
+  ///     within their own cache lines.
+  ///   </para>
+  /// </remarks>
+  template<typename TElement>
+  class ConcurrentRingBuffer<
+    TElement, ConcurrentAccessBehavior::SingleProducerSingleConsumer
+  > : public ConcurrentCollection<
+    TElement, ConcurrentAccessBehavior::SingleProducerSingleConsumer
+  > {
+
+    /// <summary>Initializes a new concurrent ring buffer</summary>
+    /// <param name="capacity">
+    ///   Minimum number of elements the buffer can hold, rounded up to a power of two
+    ///   of at least 2
+    /// </param>
+    public: explicit ConcurrentRingBuffer(std::size_t capacity) :
+      capacity(getSlotCount(capacity)),
+      slots(new Slot[getSlotCount(capacity)]),
+      writeIndex(0),
+      cachedReadIndex(0),
+      readIndex(0),
+      cachedWriteIndex(0) {}
+
+    /// <summary>Destroys the ring buffer and all elements still in it</summary>
+    public: ~ConcurrentRingBuffer() override {
+      std::size_t endIndex = this->writeIndex.load(std::memory_order_acquire);
+      std::size_t index = this->readIndex.load(std::memory_order_acquire);
+      while(index != endIndex) {
+        getElement(index)->~TElement();
+        ++index;
+      }
+    }
+
+    /// <summary>Looks up the number of elements the buffer can hold</summary>
+    /// <returns>The maximum number of elements the buffer can hold</returns>
+    public: std::size_t GetCapacity() const {
+      return this->capacity;
+    }
+
+    /// <summary>Tries to append an element to the buffer</summary>
+    /// <param name="element">Element that will be appended to the buffer</param>
+    /// <returns>True if the element was appended, false if the buffer was full</returns>
+    /// <remarks>
+    ///   This method may only be called from the producer thread.
+    /// </remarks>
+    public: bool TryAppend(const TElement &element) override {
+      std::size_t index = this->writeIndex.load(std::memory_order_relaxed);
+      if(unlikely(index - this->cachedReadIndex >= this->capacity)) {
+        this->cachedReadIndex = this->readIndex.load(std::memory_order_acquire);
+        if(index - this->cachedReadIndex >= this->capacity) {
+          return false;
+        }
+      }
+
+      new(getElement(index)) TElement(element);
+      this->writeIndex.store(index + 1, std::memory_order_release);
+      return true;
+    }
+
+    /// <summary>Tries to append a batch of elements to the buffer</summary>
+    /// <param name="first">Address of the first element that will be appended</param>
+    /// <param name="count">Number of elements that should be appended</param>
+    /// <returns>The number of elements that were appended, less if the buffer was full</returns>
+    /// <remarks>
+    ///   This method may only be called from the producer thread. All appended elements
+    ///   are made visible to the consumer at once.
+    /// </remarks>
+    public: std::size_t TryAppend(const TElement *first, std::size_t count) {
+      std::size_t index = this->writeIndex.load(std::memory_order_relaxed);
+      if(unlikely(this->capacity - (index - this->cachedReadIndex) < count)) {
+        this->cachedReadIndex = this->readIndex.load(std::memory_order_acquire);
+        std::size_t freeSlotCount = this->capacity - (index - this->cachedReadIndex);
+        if(freeSlotCount < count) {
+          count = freeSlotCount;
+        }
+      }
+
+      // Publish whatever has been constructed, even if a copy constructor throws
+      std::size_t appendedCount = 0;
+      ON_SCOPE_EXIT {
+        this->writeIndex.store(index + appendedCount, std::memory_order_release);
+      };
+      while(appendedCount < count) {
+        new(getElement(index + appendedCount)) TElement(first[appendedCount]);
+        ++appendedCount;
+      }
+
+      return appendedCount;
+    }
+
+    /// <summary>Tries to take an element from the buffer</summary>
+    /// <param name="element">Will receive the element taken from the buffer</param>
+    /// <returns>True if an element was taken, false if the buffer was empty</returns>
+    /// <remarks>
+    ///   This method may only be called from the consumer thread.
+    /// </remarks>
+    public: bool TryTake(TElement &element) override {
+      std::size_t index = this->readIndex.load(std::memory_order_relaxed);
+      if(unlikely(index == this->cachedWriteIndex)) {
+        this->cachedWriteIndex = this->writeIndex.load(std::memory_order_acquire);
+        if(index == this->cachedWriteIndex) {
+          return false;
+        }
+      }
+
+      TElement *stored = getElement(index);
+      element = std::move(*stored);
+      stored->~TElement();
+      this->readIndex.store(index + 1, std::memory_order_release);
+      return true;
+    }
+
+    /// <summary>Tries to take a batch of elements from the buffer</summary>
+    /// <param name="first">Address at which the taken elements will be stored</param>
+    /// <param name="maximumCount">Maximum number of elements that will be taken</param>
+    /// <returns>The number of elements that were taken, less if the buffer ran empty</returns>
+    /// <remarks>
+    ///   This method may only be called from the consumer thread. All slots freed by
+    ///   taking the elements are handed back to the producer at once.
+    /// </remarks>
+    public: std::size_t TryTake(TElement *first, std::size_t maximumCount) {
+      std::size_t index = this->readIndex.load(std::memory_order_relaxed);
+      if(unlikely(this->cachedWriteIndex - index < maximumCount)) {
+        this->cachedWriteIndex = this->writeIndex.load(std::memory_order_acquire);
+        if(this->cachedWriteIndex - index < maximumCount) {
+          maximumCount = this->cachedWriteIndex - index;
+        }
+      }
+
+      // Hand back whatever has been taken, even if a move assignment throws
+      std::size_t takenCount = 0;
+      ON_SCOPE_EXIT {
+        this->readIndex.store(index + takenCount, std::memory_order_release);
+      };
+      while(takenCount < maximumCount) {
+        TElement *stored = getElement(index + takenCount);
+        first[takenCount] = std::move(*stored);
+        stored->~TElement();
+        ++takenCount;
+      }
+
+      return takenCount;
+    }
+
+    /// <summary>Counts the number of elements currently in the buffer</summary>
+    /// <returns>
+    ///   The approximate number of elements that had been in the buffer during the call
+    /// </returns>
+    public: std::size_t Count() const override {
+      std::size_t index = this->readIndex.load(std::memory_order_acquire);
+      return this->writeIndex.load(std::memory_order_acquire) - index;
+    }
+
+    /// <summary>Checks if the buffer is empty</summary>
+    /// <returns>True if the buffer had been empty during the call</returns>
+    public: bool IsEmpty() const override {
+      std::size_t index = this->readIndex.load(std::memory_order_acquire);
+      return (this->writeIndex.load(std::memory_order_acquire) == index);
+    }
+
+    #pragma region struct Slot
+
+    /// <summary>Uninitialized memory for one element</summary>
+    private: struct Slot {
+
+      /// <summary>Memory in which the element is constructed</summary>
+      public: alignas(TElement) std::uint8_t Storage[sizeof(TElement)];
+
+    };
+
+    #pragma endregion // struct Slot
+
+    /// <summary>Looks up the element stored for the specified position</summary>
+    /// <param name="index">Position whose element will be returned</param>
+    /// <returns>The element stored for the specified position</returns>
+    private: TElement *getElement(std::size_t index) {
+      return reinterpret_cast<TElement *>(this->slots[index & (this->capacity - 1)].Storage);
+    }
+
+    /// <summary>Calculates the number of slots for the requested capacity</summary>
+    /// <param name="capacity">Number of elements the buffer should be able to hold</param>
+    /// <returns>The number of slots, a power of two of at least 2</returns>
+    /// <remarks>
+    ///   A single slot would work here, but the other variants need at least two slots,
+    ///   so the capacity is rounded up the same way for all of them.
+    /// </remarks>
+    private: static std::size_t getSlotCount(std::size_t capacity) {
+      if(capacity < 2) {
+        return 2;
+      }
+
+      return static_cast<std::size_t>(BitTricks::GetUpperPowerOfTwo(capacity));
+    }
+
+    /// <summary>Number of elements the buffer can hold, always a power of two</summary>
+    private: const std::size_t capacity;
+    /// <summary>Memory holding the elements</summary>
+    private: const std::unique_ptr<Slot[]> slots;
+
+    /// <summary>Position at which the producer will write the next element</summary>
+    private: alignas(64) std::atomic<std::size_t> writeIndex;
+    /// <summary>Last read position the producer has seen, owned by the producer</summary>
+    private: std::size_t cachedReadIndex;
+    /// <summary>Position from which the consumer will read the next element</summary>
+    private: alignas(64) std::atomic<std::size_t> readIndex;
+    /// <summary>Last write position the consumer has seen, owned by the consumer</summary>
+    private: std::size_t cachedWriteIndex;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Collections
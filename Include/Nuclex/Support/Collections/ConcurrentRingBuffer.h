@@ -0,0 +1,77 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+#ifndef NUCLEX_SUPPORT_COLLECTIONS_CONCURRENTRINGBUFFER_H
+#define NUCLEX_SUPPORT_COLLECTIONS_CONCURRENTRINGBUFFER_H
+
+#include "Nuclex/Support/Config.h"
+#include "Nuclex/Support/Collections/ConcurrentCollection.h"
+#include "Nuclex/Support/BitTricks.h" // for BitTricks::GetUpperPowerOfTwo()
+#include "Nuclex/Support/ScopeGuard.h" // for ON_SCOPE_EXIT
+
+#include <cstddef> // for std::size_t
+#include <cstdint> // for std::uint8_t
+#include <atomic> // for std::atomic
+#include <memory> // for std::unique_ptr
+#include <new> // for placement new
+#include <type_traits> // for std::is_nothrow_move_assignable
+#include <cassert> // for assert()
+
+namespace Nuclex { namespace Support { namespace Collections {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Fixed-size circular buffer that can safely be used from multiple threads</summary>
+  /// <typeparam name="TElement">Type of elements stored in the buffer</typeparam>
+  /// <typeparam name="accessBehavior">How the buffer may be accessed by threads</typeparam>
+  /// <remarks>
+  ///   <para>
+  ///     <strong>Thread safety:</strong> depends on the chosen access behavior, lock-free
+  ///   </para>
+  ///   <para>
+  ///     <strong>Container type:</strong> bounded ring buffer with batch operations
+  ///   </para>
+  ///   <para>
+  ///     The buffer never allocates after construction. Its capacity is rounded up to
+  ///     the next power of two so positions can be mapped to slots by masking. Appending
+  ///     fails when the buffer is full, taking fails when it is empty.
+  ///   </para>
+  ///   <para>
+  ///     All variants provide batch versions of <see cref="TryAppend" /> and
+  ///     <see cref="TryTake" /> which transfer as many elements as possible with
+  ///     a single atomic publication (SPSC) or a single compare-and-swap (MPSC, MPMC).
+  ///   </para>
+  /// </remarks>
+  template<
+    typename TElement,
+    ConcurrentAccessBehavior accessBehavior = (
+      ConcurrentAccessBehavior::MultipleProducersMultipleConsumers
+    )
+  >
+  class ConcurrentRingBuffer;
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Collections
+
+#include "Nuclex/Support/Collections/ConcurrentRingBuffer.SPSC.inl"
+#include "Nuclex/Support/Collections/ConcurrentRingBuffer.MPSC.inl"
+#include "Nuclex/Support/Collections/ConcurrentRingBuffer.MPMC.inl"
+
+#endif // NUCLEX_SUPPORT_COLLECTIONS_CONCURRENTRINGBUFFER_H
@@ -0,0 +1,456 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+#ifndef NUCLEX_SUPPORT_COLLECTIONS_CONCURRENTSEGMENTEDQUEUE_H
+#define NUCLEX_SUPPORT_COLLECTIONS_CONCURRENTSEGMENTEDQUEUE_H
+
+#include "Nuclex/Support/Config.h"
+#include "Nuclex/Support/Collections/ConcurrentCollection.h"
+#include "Nuclex/Support/Threading/HazardPointerDomain.h" // for HazardPointerDomain
+#include "Nuclex/Support/ScopeGuard.h" // for ON_SCOPE_EXIT
+
+#include <cstddef> // for std::size_t
+#include <cstdint> // for std::uint8_t, std::uint32_t
+#include <atomic> // for std::atomic
+#include <new> // for placement new
+
+namespace Nuclex { namespace Support { namespace Collections {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Unbounded queue for any number of producers and consumers</summary>
+  /// <typeparam name="TElement">Type of elements stored in the queue</typeparam>
+  /// <remarks>
+  ///   <para>
+  ///     <strong>Thread safety:</strong> any number of producers and consumers, lock-free
+  ///   </para>
+  ///   <para>
+  ///     <strong>Container type:</strong> unbounded linked list of fixed-size segments
+  ///   </para>
+  ///   <para>
+  ///     Following Adam Morrison's observation (see the paper in the Documents directory)
+  ///     that a contended fetch-and-add scales far better than a contended compare-and-swap,
+  ///     producers and consumers claim slots by incrementing a segment's write or read index.
+  ///     Each slot is then settled by one atomic exchange between its producer and consumer:
+  ///     if the consumer arrives first, it marks the slot as taken and the producer tries
+  ///     again with a new slot. This is the same idea as the paper's CRQ, but with elements
+  ///     stored next to a 32 bit state word instead of a double-width compare-and-swap.
+  ///   </para>
+  ///   <para>
+  ///     When a segment's slots are used up, a producer links a new segment. Drained segments
+  ///     are unlinked by consumers and handed to a <see cref="HazardPointerDomain" />, which
+  ///     returns them to a free list once no thread is looking at them anymore. Under steady
+  ///     traffic, the queue thus cycles through a few segments without allocating memory.
+  ///   </para>
+  ///   <para>
+  ///     If copying an element throws while appending, the exception is passed on and
+  ///     the element is not appended. If moving an element out throws while taking,
+  ///     the element is destroyed and lost.
+  ///   </para>
+  /// </remarks>
+  template<typename TElement>
+  class ConcurrentSegmentedQueue : public ConcurrentCollection<
+    TElement, ConcurrentAccessBehavior::MultipleProducersMultipleConsumers
+  > {
+
+    /// <summary>Number of elements each segment can hold</summary>
+    public: static const constexpr std::size_t SegmentSize = 512;
+
+    /// <summary>Maximum number of drained segments kept around for reuse</summary>
+    public: static const constexpr std::size_t MaximumRecycledSegmentCount = 16;
+
+    /// <summary>Initializes a new concurrent segmented queue</summary>
+    public: ConcurrentSegmentedQueue() :
+      head(nullptr),
+      tail(nullptr),
+      recycledSegments(nullptr),
+      recycledSegmentCount(0),
+      reclamation() {
+      Segment *segment = new Segment(this);
+      this->head.store(segment, std::memory_order_relaxed);
+      this->tail.store(segment, std::memory_order_release);
+    }
+
+    /// <summary>Destroys the queue and all elements still in it</summary>
+    /// <remarks>
+    ///   No other thread may access the queue anymore when it is destroyed.
+    /// </remarks>
+    public: ~ConcurrentSegmentedQueue() override {
+      Segment *segment = this->head.load(std::memory_order_acquire);
+      while(segment != nullptr) {
+        Segment *next = segment->Next.load(std::memory_order_relaxed);
+        segment->DestroyRemainingElements();
+        delete segment;
+        segment = next;
+      }
+
+      // Nobody holds hazard pointers anymore, so this recycles all retired segments
+      this->reclamation.Reclaim();
+
+      segment = this->recycledSegments.load(std::memory_order_acquire);
+      while(segment != nullptr) {
+        Segment *next = segment->Next.load(std::memory_order_relaxed);
+        delete segment;
+        segment = next;
+      }
+    }
+
+    /// <summary>Appends an element to the queue</summary>
+    /// <param name="element">Element that will be appended to the queue</param>
+    /// <returns>Always true, the queue is unbounded</returns>
+    public: bool TryAppend(const TElement &element) override {
+      Threading::HazardPointerDomain::Guard guard(this->reclamation);
+      for(;;) {
+        Segment *segment = guard.Protect(this->tail);
+
+        std::size_t index = segment->WriteIndex.fetch_add(1, std::memory_order_relaxed);
+        if(unlikely(index >= SegmentSize)) {
+          if(appendSegment(segment, element)) {
+            return true;
+          }
+          continue;
+        }
+
+        Slot &slot = segment->Slots[index];
+        if(unlikely(slot.State.load(std::memory_order_relaxed) != Empty)) {
+          continue; // A consumer already gave up on this slot
+        }
+
+        try {
+          new(slot.Storage) TElement(element);
+        }
+        catch(...) {
+          slot.State.store(Taken, std::memory_order_relaxed); // Consumers skip the slot
+          throw;
+        }
+
+        std::uint32_t expected = Empty;
+        bool wasFilled = slot.State.compare_exchange_strong(
+          expected, Filled, std::memory_order_release, std::memory_order_relaxed
+        );
+        if(likely(wasFilled)) {
+          return true;
+        }
+
+        // A consumer gave up on the slot while we were copying the element into it
+        reinterpret_cast<TElement *>(slot.Storage)->~TElement();
+      }
+    }
+
+    /// <summary>Tries to take an element from the queue</summary>
+    /// <param name="element">Will receive the element taken from the queue</param>
+    /// <returns>True if an element was taken, false if the queue was empty</returns>
+    public: bool TryTake(TElement &element) override {
+      Threading::HazardPointerDomain::Guard guard(this->reclamation);
+      for(;;) {
+        Segment *segment = guard.Protect(this->head);
+
+        // Check before claiming a slot, otherwise consumers polling an empty queue
+        // would use up all the slots producers are about to fill
+        std::size_t readIndex = segment->ReadIndex.load(std::memory_order_relaxed);
+        if(readIndex >= segment->WriteIndex.load(std::memory_order_relaxed)) {
+          if(segment->Next.load(std::memory_order_acquire) == nullptr) {
+            return false;
+          }
+        }
+
+        std::size_t index = segment->ReadIndex.fetch_add(1, std::memory_order_relaxed);
+        if(unlikely(index >= SegmentSize)) {
+          Segment *next = segment->Next.load(std::memory_order_acquire);
+          if(next == nullptr) {
+            return false;
+          }
+
+          // The tail must never point to an unlinked segment, so move it along first
+          Segment *expected = segment;
+          this->tail.compare_exchange_strong(
+            expected, next, std::memory_order_release, std::memory_order_relaxed
+          );
+
+          expected = segment;
+          bool wasUnlinked = this->head.compare_exchange_strong(
+            expected, next, std::memory_order_release, std::memory_order_relaxed
+          );
+          if(wasUnlinked) {
+            guard.Reset();
+            this->reclamation.Retire(segment, &ConcurrentSegmentedQueue::recycleRetiredSegment);
+            this->reclamation.Reclaim();
+          }
+          continue;
+        }
+
+        // Settle the slot with its producer. If the producer hasn't filled it yet,
+        // the slot is marked as taken and the producer will try another slot.
+        Slot &slot = segment->Slots[index];
+        std::uint32_t state = slot.State.exchange(Taken, std::memory_order_acquire);
+        if(likely(state == Filled)) {
+          TElement *stored = reinterpret_cast<TElement *>(slot.Storage);
+          ON_SCOPE_EXIT { stored->~TElement(); };
+          element = std::move(*stored);
+          return true;
+        }
+      }
+    }
+
+    /// <summary>Counts the number of elements currently in the queue</summary>
+    /// <returns>
+    ///   The approximate number of elements that had been in the queue during the call
+    /// </returns>
+    public: std::size_t Count() const override {
+      Threading::HazardPointerDomain::Guard headGuard(this->reclamation);
+      Threading::HazardPointerDomain::Guard tailGuard(this->reclamation);
+
+      const Segment *first = headGuard.Protect(this->head);
+      const Segment *last = tailGuard.Protect(this->tail);
+
+      std::size_t readCount = first->ReadIndex.load(std::memory_order_relaxed);
+      if(readCount > SegmentSize) {
+        readCount = SegmentSize;
+      }
+      std::size_t writeCount = last->WriteIndex.load(std::memory_order_relaxed);
+      if(writeCount > SegmentSize) {
+        writeCount = SegmentSize;
+      }
+
+      readCount += first->Ordinal * SegmentSize;
+      writeCount += last->Ordinal * SegmentSize;
+      return (writeCount > readCount) ? (writeCount - readCount) : 0;
+    }
+
+    /// <summary>Checks if the queue is empty</summary>
+    /// <returns>True if the queue had been empty during the call</returns>
+    public: bool IsEmpty() const override {
+      return (Count() == 0);
+    }
+
+    /// <summary>State of a slot that has not been filled or taken yet</summary>
+    private: static const constexpr std::uint32_t Empty = 0;
+    /// <summary>State of a slot into which a producer has put an element</summary>
+    private: static const constexpr std::uint32_t Filled = 1;
+    /// <summary>State of a slot that a consumer has taken or given up on</summary>
+    private: static const constexpr std::uint32_t Taken = 2;
+
+    #pragma region struct Slot
+
+    /// <summary>State word and uninitialized memory for one element</summary>
+    private: struct Slot {
+
+      /// <summary>Whether the slot is empty, filled or taken</summary>
+      public: std::atomic<std::uint32_t> State;
+      /// <summary>Memory in which the element is constructed</summary>
+      public: alignas(TElement) std::uint8_t Storage[sizeof(TElement)];
+
+    };
+
+    #pragma endregion // struct Slot
+
+    #pragma region struct Segment
+
+    /// <summary>Fixed-size chunk of slots, linked to the next segment</summary>
+    private: struct Segment {
+
+      /// <summary>Initializes a new segment belonging to the specified queue</summary>
+      /// <param name="owner">Queue the segment belongs to</param>
+      public: explicit Segment(ConcurrentSegmentedQueue *owner) :
+        WriteIndex(0),
+        ReadIndex(0),
+        Next(nullptr),
+        Owner(owner),
+        Ordinal(0) {
+        for(std::size_t index = 0; index < SegmentSize; ++index) {
+          this->Slots[index].State.store(Empty, std::memory_order_relaxed);
+        }
+      }
+
+      /// <summary>Prepares a recycled segment to be linked into the queue again</summary>
+      public: void Reset() {
+        this->WriteIndex.store(0, std::memory_order_relaxed);
+        this->ReadIndex.store(0, std::memory_order_relaxed);
+        this->Next.store(nullptr, std::memory_order_relaxed);
+        for(std::size_t index = 0; index < SegmentSize; ++index) {
+          this->Slots[index].State.store(Empty, std::memory_order_relaxed);
+        }
+      }
+
+      /// <summary>Destroys the elements that have been appended but not taken</summary>
+      public: void DestroyRemainingElements() {
+        for(std::size_t index = 0; index < SegmentSize; ++index) {
+          Slot &slot = this->Slots[index];
+          if(slot.State.load(std::memory_order_relaxed) == Filled) {
+            reinterpret_cast<TElement *>(slot.Storage)->~TElement();
+          }
+        }
+      }
+
+      /// <summary>Index of the next slot producers will claim</summary>
+      public: alignas(64) std::atomic<std::size_t> WriteIndex;
+      /// <summary>Index of the next slot consumers will claim</summary>
+      public: alignas(64) std::atomic<std::size_t> ReadIndex;
+      /// <summary>Segment following this one or the next recycled segment</summary>
+      public: alignas(64) std::atomic<Segment *> Next;
+      /// <summary>Queue the segment belongs to</summary>
+      public: ConcurrentSegmentedQueue *Owner;
+      /// <summary>Number of segments that have been linked before this one</summary>
+      public: std::size_t Ordinal;
+      /// <summary>Slots holding the elements</summary>
+      public: Slot Slots[SegmentSize];
+
+    };
+
+    #pragma endregion // struct Segment
+
+    /// <summary>Links a new segment after a full segment</summary>
+    /// <param name="segment">Segment whose slots have all been claimed</param>
+    /// <param name="element">Element that will be put into the new segment</param>
+    /// <returns>
+    ///   True if the new segment holding the element was linked, false if another
+    ///   segment has already been linked and the caller should try again
+    /// </returns>
+    private: bool appendSegment(Segment *segment, const TElement &element) {
+      if(segment != this->tail.load(std::memory_order_relaxed)) {
+        return false; // Somebody else already linked a new segment and moved the tail
+      }
+
+      Segment *next = segment->Next.load(std::memory_order_acquire);
+      if(next != nullptr) {
+        this->tail.compare_exchange_strong(
+          segment, next, std::memory_order_release, std::memory_order_relaxed
+        );
+        return false;
+      }
+
+      // Prepare a segment with the element already in its first slot, so the element
+      // is appended in the same instant the segment gets linked
+      Segment *newSegment = takeRecycledSegment();
+      try {
+        new(newSegment->Slots[0].Storage) TElement(element);
+      }
+      catch(...) {
+        recycleSegment(newSegment);
+        throw;
+      }
+      newSegment->Slots[0].State.store(Filled, std::memory_order_relaxed);
+      newSegment->WriteIndex.store(1, std::memory_order_relaxed);
+      newSegment->Ordinal = segment->Ordinal + 1;
+
+      bool wasLinked = segment->Next.compare_exchange_strong(
+        next, newSegment, std::memory_order_release, std::memory_order_acquire
+      );
+      if(likely(wasLinked)) {
+        this->tail.compare_exchange_strong(
+          segment, newSegment, std::memory_order_release, std::memory_order_relaxed
+        );
+        return true;
+      }
+
+      // Another producer was faster, help it move the tail and try again there
+      reinterpret_cast<TElement *>(newSegment->Slots[0].Storage)->~TElement();
+      recycleSegment(newSegment);
+      this->tail.compare_exchange_strong(
+        segment, next, std::memory_order_release, std::memory_order_relaxed
+      );
+      return false;
+    }
+
+    /// <summary>Takes a segment from the free list or allocates a new one</summary>
+    /// <returns>An empty segment that is not linked into the queue</returns>
+    private: Segment *takeRecycledSegment() {
+
+      // Taking the whole list avoids the ABA problem of popping single segments
+      Segment *segment = this->recycledSegments.exchange(nullptr, std::memory_order_acquire);
+      if(segment == nullptr) {
+        return new Segment(this);
+      }
+      this->recycledSegmentCount.fetch_sub(1, std::memory_order_relaxed);
+
+      // Put the remaining segments back. Pushing needs no protection against ABA.
+      Segment *first = segment->Next.load(std::memory_order_relaxed);
+      if(first != nullptr) {
+        Segment *last = first;
+        for(;;) {
+          Segment *next = last->Next.load(std::memory_order_relaxed);
+          if(next == nullptr) {
+            break;
+          }
+          last = next;
+        }
+
+        Segment *top = this->recycledSegments.load(std::memory_order_relaxed);
+        do {
+          last->Next.store(top, std::memory_order_relaxed);
+        } while(
+          !this->recycledSegments.compare_exchange_weak(
+            top, first, std::memory_order_release, std::memory_order_relaxed
+          )
+        );
+      }
+
+      segment->Reset();
+      return segment;
+
+    }
+
+    /// <summary>Puts a segment on the free list or frees it if the list is full</summary>
+    /// <param name="segment">Segment that is no longer linked into the queue</param>
+    private: void recycleSegment(Segment *segment) {
+      std::size_t count = this->recycledSegmentCount.fetch_add(1, std::memory_order_relaxed);
+      if(count >= MaximumRecycledSegmentCount) {
+        this->recycledSegmentCount.fetch_sub(1, std::memory_order_relaxed);
+        delete segment;
+        return;
+      }
+
+      Segment *top = this->recycledSegments.load(std::memory_order_relaxed);
+      do {
+        segment->Next.store(top, std::memory_order_relaxed);
+      } while(
+        !this->recycledSegments.compare_exchange_weak(
+          top, segment, std::memory_order_release, std::memory_order_relaxed
+        )
+      );
+    }
+
+    /// <summary>Called by the hazard pointer domain when a segment can be reused</summary>
+    /// <param name="segment">Segment no thread is looking at anymore</param>
+    private: static void recycleRetiredSegment(void *segment) {
+      Segment *retired = static_cast<Segment *>(segment);
+      retired->Owner->recycleSegment(retired);
+    }
+
+    private: ConcurrentSegmentedQueue(const ConcurrentSegmentedQueue &) = delete;
+    private: ConcurrentSegmentedQueue &operator =(const ConcurrentSegmentedQueue &) = delete;
+
+    /// <summary>Segment consumers are taking elements from</summary>
+    private: alignas(64) std::atomic<Segment *> head;
+    /// <summary>Segment producers are appending elements to</summary>
+    private: alignas(64) std::atomic<Segment *> tail;
+    /// <summary>Drained segments that can be reused</summary>
+    private: alignas(64) std::atomic<Segment *> recycledSegments;
+    /// <summary>Number of segments in the free list</summary>
+    private: std::atomic<std::size_t> recycledSegmentCount;
+    /// <summary>Keeps drained segments alive while threads are still looking at them</summary>
+    private: Threading::HazardPointerDomain reclamation;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Collections
+
+#endif // NUCLEX_SUPPORT_COLLECTIONS_CONCURRENTSEGMENTEDQUEUE_H
@@ -48,6 +48,11 @@ namespace Nuclex { namespace Support { namespace Collections {
     /// </returns>
     public: virtual bool TryRemove(const TKey &key) = 0;
 
+    /// <summary>Checks whether the set contains the specified key</summary>
+    /// <param name="key">Key the set will be checked for</param>
+    /// <returns>True if the key had been in the set during the call</returns>
+    public: virtual bool Contains(const TKey &key) const = 0;
+
     /// <summary>Counts the numebr of keys currently in the set</summary>
     /// <returns>
     ///   The approximate number of keys that had been in the set during the call
@@ -173,7 +173,7 @@ limitations under the License.
 
 #if defined(_MSC_VER)
   #define NUCLEX_SUPPORT_CPU_YIELD _mm_pause()
-#elif defined(__arm__)
+#elif defined(__arm__) || defined(__aarch64__)
   #define NUCLEX_SUPPORT_CPU_YIELD asm volatile("yield")
 #else
   #define NUCLEX_SUPPORT_CPU_YIELD __builtin_ia32_pause()
@@ -24,10 +24,10 @@ limitations under the License.
 
 #if defined(NUCLEX_SUPPORT_WINDOWS) || defined(NUCLEX_SUPPORT_LINUX)
 
+#include "Nuclex/Support/Threading/Gate.h" // for Gate
+
 #include <exception> // for std::exception
 #include <thread> // for std::thread
-#include <mutex> // for std::mutex
-#include <condition_variable> // for std::condition_variable
 #include <atomic> // for std::atomic
 #include <chrono> // for std::chrono::microseconds
 #include <memory> // for std::shared_ptr
@@ -88,6 +88,13 @@ namespace Nuclex { namespace Support { namespace Threading {
   ///     probably want to at least wrap <see cref="Join" /> with a custom return value that
   ///     your <see cref="DoWork" /> override stores upon finishing.
   ///   </para>
+  ///   <para>
+  ///     When constructed with a thread pool, the job occupies a worker thread only while
+  ///     <see cref="DoWork" /> is executing. A restart is queued to the thread pool as
+  ///     a new task rather than looping on the same worker thread, and any number of
+  ///     <see cref="StartOrRestart" /> calls arriving before that task runs are coalesced
+  ///     into a single run.
+  ///   </para>
   /// </remarks>
   class NUCLEX_SUPPORT_TYPE ConcurrentJob {
 
@@ -162,7 +169,8 @@ namespace Nuclex { namespace Support { namespace Threading {
     ///   If the work being performed takes more than a few milliseconds, you should regularly
     ///   check if the job has been cancelled. If the job is cancelled, this method should just
     ///   return. When a restart or another execution is scheduled, the <see cref="DoWork" />
-    ///   method will run on the same thread again right away.
+    ///   method will run on the same thread again right away (or, if the job is using
+    ///   a thread pool, it will be queued to the thread pool again).
     /// </remarks>
     protected: NUCLEX_SUPPORT_API virtual void DoWork(
       const std::shared_ptr<const StopToken> &canceler
@@ -181,6 +189,29 @@ namespace Nuclex { namespace Support { namespace Threading {
 
     // ----------------------------------------------------------------------------------------- //
 
+    /// <summary>Starts a new background thread or queues a thread pool task</summary>
+    /// <param name="idleStatus">
+    ///   Status field from before the job was scheduled, restored if launching fails
+    /// </param>
+    /// <remarks>
+    ///   Must be called after the status has been changed from idle to scheduled.
+    ///   If the thread or thread pool task cannot be created, the job is put back into
+    ///   its previous idle status before the exception is passed on to the caller.
+    /// </remarks>
+    private: void launch(std::size_t idleStatus);
+
+    /// <summary>Runs the background job, called in the thread or thread pool</summary>
+    /// <remarks>
+    ///   This takes care of the status transitions before and after each call to
+    ///   <see cref="DoWork" /> and of repeating the call if a restart was requested.
+    /// </remarks>
+    private: void runDoWork();
+
+    // ----------------------------------------------------------------------------------------- //
+
+    /// <summary>Stop source and outcome of a single run of the background job</summary>
+    private: struct RunState;
+
     /// <summary>Thread that is running in the background</summary>
     /// <remarks>
     ///   This is used if concurrent job is constructed without a thread pool
@@ -188,21 +219,26 @@ namespace Nuclex { namespace Support { namespace Threading {
     private: std::thread backgroundThread;
     /// <summary>If set, the concurrent job uses the thread pool to run workers</summary>
     private: ThreadPool *threadPool;
-    /// <summary>Whether the current thread is still running</summary>
-    private: std::atomic<int> status;
-    /// <summary>Needs to be be held when changing the state of the thread</summary>
-    private: std::mutex stateMutex;
-    /// <summary>Used to ask background worker to cancel when needed</summary>
-    private: std::shared_ptr<StopSource> stopTrigger;
-    /// <summary>Used to wait for the thread to start running</summary>
+    /// <summary>Current status of the job and number of the current run</summary>
+    /// <remarks>
+    ///   All status transitions are done by compare-and-swap on this value. The run
+    ///   number prevents a thread that canceled a run from mistaking a later run
+    ///   for the one it canceled.
+    /// </remarks>
+    private: std::atomic<std::size_t> status;
+    /// <summary>Open whenever the job is neither scheduled nor running</summary>
+    /// <remarks>
+    ///   Threads blocking in <see cref="Wait" /> or <see cref="Join" /> wait on this gate.
+    ///   The gate is closed by the thread that schedules a run and opened by the worker
+    ///   right before it moves the job into an idle status.
+    /// </remarks>
+    private: Gate idleGate;
+    /// <summary>State of the current or most recent run of the job</summary>
     /// <remarks>
-    ///   The <see cref="StartOrRestart" /> method waits until the thread is actually running
-    ///   and has the <see cref="status" /> flag set before returning. That ensures there
-    ///   is no confusion about the state if two threads call <see cref="StartOrRestart" />.
+    ///   Replaced by the worker at the start of each run and only accessed via
+    ///   std::atomic_load() and std::atomic_store() since other threads may be reading it.
     /// </remarks>
-    private: std::condition_variable statusChangedCondition;
-    /// <summary>Records any exception that has happened in the background thread</summary>
-    private: std::exception_ptr error;
+    private: std::shared_ptr<RunState> currentRun;
 
   };
 
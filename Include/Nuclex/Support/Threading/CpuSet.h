@@ -0,0 +1,174 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+#ifndef NUCLEX_SUPPORT_THREADING_CPUSET_H
+#define NUCLEX_SUPPORT_THREADING_CPUSET_H
+
+#include "Nuclex/Support/Config.h"
+
+#include <cstddef> // for std::size_t
+#include <cstdint> // for std::uint64_t
+#include <string> // for std::string
+#include <vector> // for std::vector
+
+namespace Nuclex { namespace Support { namespace Threading {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Set of logical CPUs, not limited in the number of CPUs it can hold</summary>
+  /// <remarks>
+  ///   <para>
+  ///     Used to select the CPUs a thread may run on and to describe the CPUs belonging
+  ///     to a NUMA node. Unlike the plain 64 bit masks taken by the older affinity methods
+  ///     in <see cref="Thread" />, this can address any number of CPUs, so it keeps working
+  ///     on systems with more than 64 logical CPUs.
+  ///   </para>
+  ///   <para>
+  ///     CPU indices are the ones used by the operating system. On Windows, where CPUs
+  ///     are organized in processor groups of up to 64 CPUs, the index is the processor
+  ///     group times 64 plus the CPU's number within its group.
+  ///   </para>
+  /// </remarks>
+  class NUCLEX_SUPPORT_TYPE CpuSet {
+
+    /// <summary>Creates a CPU set from a 64 bit CPU affinity mask</summary>
+    /// <param name="affinityMask">Bit mask in which each bit represents a CPU</param>
+    /// <returns>A CPU set containing the CPUs whose bits were set in the mask</returns>
+    public: NUCLEX_SUPPORT_API static CpuSet FromMask(std::uint64_t affinityMask);
+
+    /// <summary>Parses a CPU list in the format used by the Linux kernel</summary>
+    /// <param name="cpuList">CPU list such as &quot;0-3,8,10-11&quot;</param>
+    /// <returns>A CPU set containing the CPUs in the list</returns>
+    /// <remarks>
+    ///   This is the format in which sysfs (/sys/devices/system/cpu/online and
+    ///   similar files) and tools such as taskset or numactl report CPUs. Malformed
+    ///   lists and CPU indices of 8192 or above cause an std::invalid_argument exception.
+    /// </remarks>
+    public: NUCLEX_SUPPORT_API static CpuSet Parse(const std::string &cpuList);
+
+    /// <summary>Initializes a new, empty CPU set</summary>
+    public: CpuSet() = default;
+
+    /// <summary>Adds a CPU to the set</summary>
+    /// <param name="cpuIndex">Index of the CPU that will be added</param>
+    public: NUCLEX_SUPPORT_API void Add(std::size_t cpuIndex);
+
+    /// <summary>Removes a CPU from the set</summary>
+    /// <param name="cpuIndex">Index of the CPU that will be removed</param>
+    public: NUCLEX_SUPPORT_API void Remove(std::size_t cpuIndex);
+
+    /// <summary>Checks whether the set contains the specified CPU</summary>
+    /// <param name="cpuIndex">Index of the CPU that will be checked</param>
+    /// <returns>True if the CPU is in the set, false otherwise</returns>
+    public: bool Contains(std::size_t cpuIndex) const {
+      std::size_t wordIndex = cpuIndex / 64;
+      return (
+        (wordIndex < this->words.size()) &&
+        ((this->words[wordIndex] & (std::uint64_t(1) << (cpuIndex % 64))) != 0)
+      );
+    }
+
+    /// <summary>Removes all CPUs from the set</summary>
+    public: void Clear() {
+      this->words.clear();
+    }
+
+    /// <summary>Checks whether the set contains no CPUs</summary>
+    /// <returns>True if the set is empty, false if it contains any CPUs</returns>
+    public: NUCLEX_SUPPORT_API bool IsEmpty() const;
+
+    /// <summary>Counts the number of CPUs in the set</summary>
+    /// <returns>The number of CPUs in the set</returns>
+    public: NUCLEX_SUPPORT_API std::size_t Count() const;
+
+    /// <summary>Determines the index one past the highest CPU in the set</summary>
+    /// <returns>The index one past the highest CPU in the set, 0 if the set is empty</returns>
+    public: NUCLEX_SUPPORT_API std::size_t GetUpperBound() const;
+
+    /// <summary>Lists the indices of all CPUs in the set</summary>
+    /// <returns>The indices of all CPUs in the set in ascending order</returns>
+    public: NUCLEX_SUPPORT_API std::vector<std::size_t> GetIndices() const;
+
+    /// <summary>Converts the set into a 64 bit CPU affinity mask</summary>
+    /// <returns>A bit mask with the bits for the first 64 CPUs in the set</returns>
+    /// <remarks>
+    ///   CPUs with an index of 64 or higher cannot be represented and are dropped.
+    /// </remarks>
+    public: std::uint64_t ToMask() const {
+      return this->words.empty() ? 0 : this->words[0];
+    }
+
+    /// <summary>Formats the set as a CPU list in the format used by the Linux kernel</summary>
+    /// <returns>A CPU list such as &quot;0-3,8,10-11&quot;</returns>
+    public: NUCLEX_SUPPORT_API std::string ToString() const;
+
+    /// <summary>Checks whether this set contains the same CPUs as another set</summary>
+    /// <param name="other">Other set that will be compared</param>
+    /// <returns>True if both sets contain the same CPUs</returns>
+    public: NUCLEX_SUPPORT_API bool operator ==(const CpuSet &other) const;
+
+    /// <summary>Checks whether this set contains different CPUs than another set</summary>
+    /// <param name="other">Other set that will be compared</param>
+    /// <returns>True if the sets contain different CPUs</returns>
+    public: bool operator !=(const CpuSet &other) const {
+      return !operator ==(other);
+    }
+
+    /// <summary>Adds all CPUs in another set to this set</summary>
+    /// <param name="other">Set whose CPUs will be added</param>
+    /// <returns>This set</returns>
+    public: NUCLEX_SUPPORT_API CpuSet &operator |=(const CpuSet &other);
+
+    /// <summary>Removes all CPUs from this set that are not in another set</summary>
+    /// <param name="other">Set whose CPUs will be kept</param>
+    /// <returns>This set</returns>
+    public: NUCLEX_SUPPORT_API CpuSet &operator &=(const CpuSet &other);
+
+    /// <summary>Forms the union of this set and another set</summary>
+    /// <param name="other">Set that will be united with this set</param>
+    /// <returns>A new set containing the CPUs of both sets</returns>
+    public: CpuSet operator |(const CpuSet &other) const {
+      CpuSet result(*this);
+      result |= other;
+      return result;
+    }
+
+    /// <summary>Forms the intersection of this set and another set</summary>
+    /// <param name="other">Set that will be intersected with this set</param>
+    /// <returns>A new set containing only the CPUs present in both sets</returns>
+    public: CpuSet operator &(const CpuSet &other) const {
+      CpuSet result(*this);
+      result &= other;
+      return result;
+    }
+
+    /// <summary>Bits for the CPUs in the set, 64 CPUs per word</summary>
+    /// <remarks>
+    ///   Trailing zero words are always trimmed, so two sets with equal CPUs
+    ///   have equal word vectors.
+    /// </remarks>
+    private: std::vector<std::uint64_t> words;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Threading
+
+#endif // NUCLEX_SUPPORT_THREADING_CPUSET_H
@@ -0,0 +1,121 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+#ifndef NUCLEX_SUPPORT_THREADING_CPUTOPOLOGY_H
+#define NUCLEX_SUPPORT_THREADING_CPUTOPOLOGY_H
+
+#include "Nuclex/Support/Config.h"
+#include "Nuclex/Support/Threading/CpuSet.h"
+
+#include <cstddef> // for std::size_t
+#include <vector> // for std::vector
+
+namespace Nuclex { namespace Support { namespace Threading {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Describes which CPUs a system has and how they are grouped</summary>
+  /// <remarks>
+  ///   <para>
+  ///     On systems with multiple CPU sockets, each socket usually has its own memory
+  ///     controller and memory attached to it. Such a group of CPUs and memory forms
+  ///     a NUMA node. CPUs can access the memory of other NUMA nodes, too, but at a higher
+  ///     latency and with limited bandwidth, so threads working on the same data are
+  ///     best kept within the same NUMA node.
+  ///   </para>
+  ///   <para>
+  ///     On Linux, the topology is read from /sys/devices/system/cpu and
+  ///     /sys/devices/system/node. On Windows, it is queried from the NUMA API, which
+  ///     only reports the first processor group of NUMA nodes spanning several groups.
+  ///     If no NUMA information is available (for example in some containers), all
+  ///     online CPUs are reported as a single NUMA node.
+  ///   </para>
+  ///   <para>
+  ///     NUMA nodes are numbered from zero without gaps. Nodes that have memory but
+  ///     no CPUs are left out, so the node indices may differ from the operating
+  ///     system's node numbers on exotic systems.
+  ///   </para>
+  /// </remarks>
+  class NUCLEX_SUPPORT_TYPE CpuTopology {
+
+    /// <summary>Queries the CPU topology of the system the process is running on</summary>
+    /// <returns>The system's CPU topology</returns>
+    public: NUCLEX_SUPPORT_API static CpuTopology Query();
+
+    /// <summary>Determines the CPU the calling thread is currently running on</summary>
+    /// <returns>The index of the CPU the calling thread is running on</returns>
+    /// <remarks>
+    ///   Unless the thread's affinity is limited to a single CPU, the operating system
+    ///   may move the thread to another CPU at any time, so treat this as a hint.
+    /// </remarks>
+    public: NUCLEX_SUPPORT_API static std::size_t GetCurrentCpuIndex();
+
+    /// <summary>Retrieves the set of CPUs that are online</summary>
+    /// <returns>A set containing all CPUs that are currently online</returns>
+    public: const CpuSet &GetOnlineCpus() const {
+      return this->onlineCpus;
+    }
+
+    /// <summary>Counts the number of NUMA nodes in the system</summary>
+    /// <returns>The number of NUMA nodes that have CPUs, at least 1</returns>
+    public: std::size_t CountNumaNodes() const {
+      return this->numaNodeCpus.size();
+    }
+
+    /// <summary>Retrieves the CPUs belonging to a NUMA node</summary>
+    /// <param name="nodeIndex">Index of the NUMA node whose CPUs will be returned</param>
+    /// <returns>The set of online CPUs belonging to the NUMA node</returns>
+    public: const CpuSet &GetNumaNodeCpus(std::size_t nodeIndex) const {
+      return this->numaNodeCpus.at(nodeIndex);
+    }
+
+    /// <summary>Looks up the NUMA node a CPU belongs to</summary>
+    /// <param name="cpuIndex">Index of the CPU whose NUMA node will be looked up</param>
+    /// <returns>The index of the NUMA node, 0 if the CPU is unknown</returns>
+    public: NUCLEX_SUPPORT_API std::size_t GetNumaNodeOfCpu(std::size_t cpuIndex) const;
+
+    /// <summary>Counts the number of physical CPU cores in the system</summary>
+    /// <returns>The number of physical cores, at least 1</returns>
+    /// <remarks>
+    ///   With simultaneous multithreading (&quot;HyperThreading&quot;), a physical core
+    ///   shows up as two or more logical CPUs that share the core's execution units.
+    /// </remarks>
+    public: std::size_t CountPhysicalCores() const {
+      return this->physicalCoreCount;
+    }
+
+    /// <summary>Initializes a new, empty CPU topology</summary>
+    private: CpuTopology();
+
+    /// <summary>Set of CPUs that are currently online</summary>
+    private: CpuSet onlineCpus;
+    /// <summary>CPUs belonging to each NUMA node</summary>
+    private: std::vector<CpuSet> numaNodeCpus;
+    /// <summary>NUMA node index for each CPU index</summary>
+    private: std::vector<std::size_t> cpuNumaNodes;
+    /// <summary>Number of physical CPU cores</summary>
+    private: std::size_t physicalCoreCount;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Threading
+
+#endif // NUCLEX_SUPPORT_THREADING_CPUTOPOLOGY_H
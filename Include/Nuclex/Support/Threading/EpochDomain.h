@@ -0,0 +1,160 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+#ifndef NUCLEX_SUPPORT_THREADING_EPOCHDOMAIN_H
+#define NUCLEX_SUPPORT_THREADING_EPOCHDOMAIN_H
+
+#include "Nuclex/Support/Config.h"
+
+#include <atomic> // for std::atomic
+#include <cstddef> // for std::size_t
+
+namespace Nuclex { namespace Support { namespace Threading {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  class ReclamationRecord;
+  struct RetiredInstance;
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Frees retired objects once no reader can be looking at them anymore</summary>
+  /// <remarks>
+  ///   <para>
+  ///     This is epoch-based reclamation. Readers wrap their accesses to a shared data
+  ///     structure in a <see cref="ReadScope" />, which announces the global epoch the thread
+  ///     entered in through a record only that thread writes to. Readers therefore take no
+  ///     lock and do no atomic read-modify-write operations on shared memory.
+  ///   </para>
+  ///   <para>
+  ///     Writers unlink objects from the data structure, then hand them to
+  ///     <see cref="Retire" />. Retired objects are tagged with the current epoch. The epoch
+  ///     only advances when all readers have caught up with it, so once it has advanced
+  ///     twice past an object's tag, no reader that could have seen the object is left.
+  ///   </para>
+  ///   <para>
+  ///     The epoch and the reader records are shared by all domains, so a read scope
+  ///     in one domain also holds back reclamation in all other domains. Each domain has
+  ///     its own list of retired objects, which it frees when it is destroyed.
+  ///   </para>
+  ///   <para>
+  ///     Compared to the <see cref="HazardPointerDomain" />, entering a read scope is cheaper
+  ///     and protects any number of objects, but a single reader stalled inside a read
+  ///     scope prevents all retired objects from being freed.
+  ///   </para>
+  /// </remarks>
+  class NUCLEX_SUPPORT_TYPE EpochDomain {
+
+    #pragma region class ReadScope
+
+    /// <summary>Keeps retired objects from being freed while it exists</summary>
+    /// <remarks>
+    ///   Read scopes can be nested. They must be destroyed by the thread that created them.
+    /// </remarks>
+    public: class ReadScope {
+
+      /// <summary>Enters a read section in the specified domain</summary>
+      /// <param name="domain">Domain in which the read section will be entered</param>
+      public: explicit ReadScope(const EpochDomain &domain) :
+        record(EpochDomain::enterReadSection()) {
+        (void)domain;
+      }
+
+      /// <summary>Takes over the read section of another read scope</summary>
+      /// <param name="other">Read scope that will be taken over</param>
+      public: ReadScope(ReadScope &&other) noexcept :
+        record(other.record) {
+        other.record = nullptr;
+      }
+
+      /// <summary>Leaves the read section, allowing retired objects to be freed</summary>
+      public: ~ReadScope() {
+        if(this->record != nullptr) {
+          EpochDomain::leaveReadSection(this->record);
+        }
+      }
+
+      private: ReadScope(const ReadScope &) = delete;
+      private: ReadScope &operator =(const ReadScope &) = delete;
+      private: ReadScope &operator =(ReadScope &&) = delete;
+
+      /// <summary>Reclamation record of the thread that created the read scope</summary>
+      private: ReclamationRecord *record;
+
+    };
+
+    #pragma endregion // class ReadScope
+
+    /// <summary>Initializes a new epoch domain</summary>
+    public: NUCLEX_SUPPORT_API EpochDomain();
+
+    /// <summary>Frees all objects that have been retired through the domain</summary>
+    /// <remarks>
+    ///   Nobody may be reading objects managed by the domain anymore when it is destroyed.
+    /// </remarks>
+    public: NUCLEX_SUPPORT_API ~EpochDomain();
+
+    /// <summary>Hands an unlinked object to the domain to free it when it's safe</summary>
+    /// <typeparam name="TObject">Type of object that will be freed</typeparam>
+    /// <param name="instance">Object that will be freed through the delete operator</param>
+    public: template<typename TObject>
+    void Retire(TObject *instance) noexcept {
+      Retire(instance, [](void *object) { delete static_cast<TObject *>(object); });
+    }
+
+    /// <summary>Hands an unlinked object to the domain to free it when it's safe</summary>
+    /// <param name="instance">Object that will be freed</param>
+    /// <param name="deleter">Method that will be called to free the object</param>
+    /// <remarks>
+    ///   The object must already be unreachable for new readers. If the domain can't
+    ///   allocate the few bytes needed to keep track of the object, it is leaked rather
+    ///   than risking that a reader accesses freed memory.
+    /// </remarks>
+    public: NUCLEX_SUPPORT_API void Retire(void *instance, void (*deleter)(void *)) noexcept;
+
+    /// <summary>Frees all retired objects that no reader can be looking at anymore</summary>
+    /// <remarks>
+    ///   This is done automatically every few retirements. Call it by hand if objects
+    ///   are retired rarely and should be freed soon after.
+    /// </remarks>
+    public: NUCLEX_SUPPORT_API void Reclaim() noexcept;
+
+    /// <summary>Announces that the calling thread is about to read</summary>
+    /// <returns>The calling thread's reclamation record, needed to leave again</returns>
+    private: NUCLEX_SUPPORT_API static ReclamationRecord *enterReadSection();
+
+    /// <summary>Announces that the calling thread has finished reading</summary>
+    /// <param name="record">Record returned when the read section was entered</param>
+    private: NUCLEX_SUPPORT_API static void leaveReadSection(ReclamationRecord *record) noexcept;
+
+    private: EpochDomain(const EpochDomain &) = delete;
+    private: EpochDomain &operator =(const EpochDomain &) = delete;
+
+    /// <summary>Objects that have been retired and not freed yet</summary>
+    private: std::atomic<RetiredInstance *> retiredInstances;
+    /// <summary>Number of objects retired since the last reclamation</summary>
+    private: std::atomic<std::size_t> retiredCount;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Threading
+
+#endif // NUCLEX_SUPPORT_THREADING_EPOCHDOMAIN_H
@@ -24,11 +24,18 @@ limitations under the License.
 
 #include <cstdint> // for std::uint32_t
 #include <chrono> // for std::chrono::microseconds
+#include <atomic> // for std::atomic
+#include <functional> // for std::function
 
 namespace Nuclex { namespace Support { namespace Threading {
 
   // ------------------------------------------------------------------------------------------- //
 
+  class ThreadPool;
+  class AsyncWaitList;
+
+  // ------------------------------------------------------------------------------------------- //
+
   /// <summary>Lets threads through only if opened</summary>
   /// <remarks>
   ///   <para>
@@ -89,8 +96,62 @@ namespace Nuclex { namespace Support { namespace Threading {
 
     //public: void WaitUntil(const std::chrono::time_point< &patience);
 
+    /// <summary>Sets how long a waiting thread may spin before it goes to sleep</summary>
+    /// <param name="maximumSpinCount">
+    ///   Maximum number of spin iterations, 0 disables spinning entirely
+    /// </param>
+    /// <remarks>
+    ///   <para>
+    ///     Sending a thread to sleep and waking it up again takes a system call on each
+    ///     side. If the gate is typically opened within microseconds, briefly busy-waiting is
+    ///     much cheaper. The number of iterations actually spun adapts to how long recent
+    ///     waits took, this only sets the upper limit.
+    ///   </para>
+    ///   <para>
+    ///     By default, up to 1000 iterations are spun on systems with more than one CPU
+    ///     and spinning is disabled on single-CPU systems. Only the Linux and Windows
+    ///     implementations spin, on other platforms this setting has no effect.
+    ///   </para>
+    /// </remarks>
+    public: NUCLEX_SUPPORT_API void SetMaximumSpinCount(std::size_t maximumSpinCount);
+
+#if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+    /// <summary>Runs a continuation on a thread pool once the gate is open</summary>
+    /// <param name="threadPool">Thread pool the continuation will be posted to</param>
+    /// <param name="continuation">Continuation that will run once the gate is open</param>
+    /// <remarks>
+    ///   <para>
+    ///     Instead of blocking the calling thread, the continuation is stored and posted to the
+    ///     specified thread pool once the gate opens. If the gate already is open, the continuation
+    ///     is posted right away. This lets a large number of operations wait on the gate without
+    ///     tying up one thread for each.
+    ///   </para>
+    ///   <para>
+    ///     Like any task posted to a thread pool, the continuation must not throw.
+    ///     If the gate or the thread pool is destroyed before the continuation could
+    ///     run, the continuation is destroyed without being called.
+    ///   </para>
+    /// </remarks>
+    public: NUCLEX_SUPPORT_API void WaitAsync(
+      ThreadPool &threadPool, std::function<void()> continuation
+    );
+#endif
+
     // ----------------------------------------------------------------------------------------- //
 
+#if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+    /// <summary>Lets multi-object waits sleep on the gate's wait word</summary>
+    friend class MultiWait;
+
+    /// <summary>Checks whether the gate is currently open</summary>
+    /// <returns>True if the gate is open, false if it is closed</returns>
+    private: bool isOpen() const;
+
+    /// <summary>Retrieves the word threads sleep on while the gate is closed</summary>
+    /// <returns>The wait word, which is 0 while the gate is closed</returns>
+    private: const volatile std::uint32_t &getWaitWord() const;
+#endif
+
     /// <summary>Structure to hold platform dependent process and file handles</summary>
     private: struct PlatformDependentImplementationData;
     /// <summary>Accesses the platform dependent implementation data container</summary>
@@ -108,11 +169,15 @@ namespace Nuclex { namespace Support { namespace Threading {
       ///   This avoids a micro-allocation for the implenmentation data structure in most cases.
       /// </remarks>
 #if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
-      alignas(8) unsigned char implementationDataBuffer[sizeof(std::uint32_t)];
+      alignas(8) unsigned char implementationDataBuffer[sizeof(std::uint32_t) * 3];
 #else // Posix
       unsigned char implementationDataBuffer[96];
 #endif
     };
+#if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+    /// <summary>Continuations waiting for the gate to open, created on demand</summary>
+    private: std::atomic<AsyncWaitList *> asyncWaitList;
+#endif
 
   };
 
@@ -0,0 +1,193 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+#ifndef NUCLEX_SUPPORT_THREADING_HAZARDPOINTERDOMAIN_H
+#define NUCLEX_SUPPORT_THREADING_HAZARDPOINTERDOMAIN_H
+
+#include "Nuclex/Support/Config.h"
+
+#include <atomic> // for std::atomic
+#include <cstddef> // for std::size_t
+
+namespace Nuclex { namespace Support { namespace Threading {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  class ReclamationRecord;
+  struct RetiredInstance;
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Frees retired objects once no thread holds a hazard pointer to them</summary>
+  /// <remarks>
+  ///   <para>
+  ///     This implements the hazard pointers described by Maged Michael (see the article
+  ///     in the Documents directory). Before a thread dereferences a pointer it loaded from
+  ///     a shared data structure, it publishes the pointer through a <see cref="Guard" />
+  ///     and checks that the data structure still contains it. Publishing writes to a slot
+  ///     only that thread writes to, so readers don't contend with each other.
+  ///   </para>
+  ///   <para>
+  ///     Writers unlink objects from the data structure, then hand them to
+  ///     <see cref="Retire" />. A retired object is freed once no hazard pointer points to it.
+  ///   </para>
+  ///   <para>
+  ///     Compared to the <see cref="EpochDomain" />, every protected pointer costs a guard
+  ///     and a fence, but a stalled reader only prevents the objects it is actually
+  ///     pointing to from being freed. The hazard slots are shared by all domains, each
+  ///     domain has its own list of retired objects which it frees when it is destroyed.
+  ///   </para>
+  /// </remarks>
+  class NUCLEX_SUPPORT_TYPE HazardPointerDomain {
+
+    #pragma region class Guard
+
+    /// <summary>Hazard pointer that keeps the object it points to from being freed</summary>
+    /// <remarks>
+    ///   Each guard occupies a hazard slot until it is destroyed. Guards are cheap to
+    ///   create as long as a thread doesn't hold more than a handful at the same time.
+    ///   They must be destroyed by the thread that created them.
+    /// </remarks>
+    public: class Guard {
+
+      /// <summary>Initializes a new guard for objects in the specified domain</summary>
+      /// <param name="domain">Domain whose objects the guard will protect</param>
+      public: explicit Guard(const HazardPointerDomain &domain) :
+        record(nullptr),
+        slot(HazardPointerDomain::takeHazardSlot(this->record)) {
+        (void)domain;
+      }
+
+      /// <summary>Stops protecting the object and gives the hazard slot back</summary>
+      public: ~Guard() {
+        HazardPointerDomain::giveBackHazardSlot(this->record, this->slot);
+      }
+
+      /// <summary>Loads a pointer and protects the object it points to</summary>
+      /// <typeparam name="TObject">Type of object the pointer points to</typeparam>
+      /// <param name="source">Shared location the pointer will be loaded from</param>
+      /// <returns>The loaded pointer, safe to dereference until the guard changes</returns>
+      public: template<typename TObject>
+      TObject *Protect(const std::atomic<TObject *> &source) noexcept {
+        TObject *pointer = source.load(std::memory_order_relaxed);
+        for(;;) {
+          this->slot->store(pointer, std::memory_order_relaxed);
+          std::atomic_thread_fence(std::memory_order_seq_cst);
+
+          // If the source still holds the pointer, it had not been retired when
+          // the hazard pointer became visible, so reclaiming threads will see it
+          TObject *confirmed = source.load(std::memory_order_acquire);
+          if(likely(confirmed == pointer)) {
+            return pointer;
+          }
+          pointer = confirmed;
+        }
+      }
+
+      /// <summary>Protects an object the caller will validate on its own</summary>
+      /// <param name="pointer">Pointer to the object that will be protected</param>
+      /// <remarks>
+      ///   The object is only protected if the caller checks that it is still reachable
+      ///   after this call, like <see cref="Protect" /> does.
+      /// </remarks>
+      public: void Set(const void *pointer) noexcept {
+        this->slot->store(pointer, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+      }
+
+      /// <summary>Stops protecting the object the guard was protecting</summary>
+      public: void Reset() noexcept {
+        this->slot->store(nullptr, std::memory_order_release);
+      }
+
+      private: Guard(const Guard &) = delete;
+      private: Guard &operator =(const Guard &) = delete;
+
+      /// <summary>Record the hazard slot was taken from</summary>
+      private: ReclamationRecord *record;
+      /// <summary>Hazard slot through which the guard publishes its pointer</summary>
+      private: std::atomic<const void *> *slot;
+
+    };
+
+    #pragma endregion // class Guard
+
+    /// <summary>Initializes a new hazard pointer domain</summary>
+    public: NUCLEX_SUPPORT_API HazardPointerDomain();
+
+    /// <summary>Frees all objects that have been retired through the domain</summary>
+    /// <remarks>
+    ///   No guard may be protecting objects of the domain anymore when it is destroyed.
+    /// </remarks>
+    public: NUCLEX_SUPPORT_API ~HazardPointerDomain();
+
+    /// <summary>Hands an unlinked object to the domain to free it when it's safe</summary>
+    /// <typeparam name="TObject">Type of object that will be freed</typeparam>
+    /// <param name="instance">Object that will be freed through the delete operator</param>
+    public: template<typename TObject>
+    void Retire(TObject *instance) noexcept {
+      Retire(instance, [](void *object) { delete static_cast<TObject *>(object); });
+    }
+
+    /// <summary>Hands an unlinked object to the domain to free it when it's safe</summary>
+    /// <param name="instance">Object that will be freed</param>
+    /// <param name="deleter">Method that will be called to free the object</param>
+    /// <remarks>
+    ///   The object must already be unreachable for new readers. If the domain can't
+    ///   allocate the few bytes needed to keep track of the object, it is leaked rather
+    ///   than risking that a reader accesses freed memory.
+    /// </remarks>
+    public: NUCLEX_SUPPORT_API void Retire(void *instance, void (*deleter)(void *)) noexcept;
+
+    /// <summary>Frees all retired objects that are not protected by any guard</summary>
+    /// <remarks>
+    ///   This is done automatically every few retirements. Call it by hand if objects
+    ///   are retired rarely and should be freed soon after.
+    /// </remarks>
+    public: NUCLEX_SUPPORT_API void Reclaim() noexcept;
+
+    /// <summary>Takes a hazard slot for the calling thread</summary>
+    /// <param name="record">Receives the record the hazard slot was taken from</param>
+    /// <returns>The hazard slot the calling thread can publish its pointer in</returns>
+    private: NUCLEX_SUPPORT_API static std::atomic<const void *> *takeHazardSlot(
+      ReclamationRecord *&record
+    );
+
+    /// <summary>Gives a hazard slot taken by the calling thread back</summary>
+    /// <param name="record">Record the hazard slot was taken from</param>
+    /// <param name="slot">Hazard slot that will be given back</param>
+    private: NUCLEX_SUPPORT_API static void giveBackHazardSlot(
+      ReclamationRecord *record, std::atomic<const void *> *slot
+    ) noexcept;
+
+    private: HazardPointerDomain(const HazardPointerDomain &) = delete;
+    private: HazardPointerDomain &operator =(const HazardPointerDomain &) = delete;
+
+    /// <summary>Objects that have been retired and not freed yet</summary>
+    private: std::atomic<RetiredInstance *> retiredInstances;
+    /// <summary>Number of objects retired since the last reclamation</summary>
+    private: std::atomic<std::size_t> retiredCount;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Threading
+
+#endif // NUCLEX_SUPPORT_THREADING_HAZARDPOINTERDOMAIN_H
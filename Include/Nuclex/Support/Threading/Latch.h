@@ -23,12 +23,20 @@ limitations under the License.
 #include "Nuclex/Support/Config.h"
 
 #include <cstddef> // for std::size_t
+#include <cstdint> // for std::uint32_t
 #include <chrono> // for std::chrono::microseconds
+#include <atomic> // for std::atomic
+#include <functional> // for std::function
 
 namespace Nuclex { namespace Support { namespace Threading {
 
   // ------------------------------------------------------------------------------------------- //
 
+  class ThreadPool;
+  class AsyncWaitList;
+
+  // ------------------------------------------------------------------------------------------- //
+
   /// <summary>Blocks threads unless its counter has reached zero</summary>
   /// <remarks>
   ///   <para>
@@ -94,6 +102,49 @@ namespace Nuclex { namespace Support { namespace Threading {
 
     //public: void WaitUntil(const std::chrono::time_point< &patience);
 
+    /// <summary>Sets how long a waiting thread may spin before it goes to sleep</summary>
+    /// <param name="maximumSpinCount">
+    ///   Maximum number of spin iterations, 0 disables spinning entirely
+    /// </param>
+    /// <remarks>
+    ///   <para>
+    ///     Sending a thread to sleep and waking it up again takes a system call on each
+    ///     side. If the latch typically reaches zero within microseconds, briefly busy-waiting is
+    ///     much cheaper. The number of iterations actually spun adapts to how long recent
+    ///     waits took, this only sets the upper limit.
+    ///   </para>
+    ///   <para>
+    ///     By default, up to 1000 iterations are spun on systems with more than one CPU
+    ///     and spinning is disabled on single-CPU systems. Only the Linux and Windows
+    ///     implementations spin, on other platforms this setting has no effect.
+    ///   </para>
+    /// </remarks>
+    public: NUCLEX_SUPPORT_API void SetMaximumSpinCount(std::size_t maximumSpinCount);
+
+#if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+    /// <summary>Runs a continuation on a thread pool once the latch reaches zero</summary>
+    /// <param name="threadPool">Thread pool the continuation will be posted to</param>
+    /// <param name="continuation">
+    ///   Continuation that will run once the latch's count has reached zero
+    /// </param>
+    /// <remarks>
+    ///   <para>
+    ///     Instead of blocking the calling thread, the continuation is stored and posted to the
+    ///     specified thread pool once the latch's count reaches zero. If the count already is zero,
+    ///     the continuation is posted right away. This lets a large number of operations wait on
+    ///     the latch without tying up one thread for each.
+    ///   </para>
+    ///   <para>
+    ///     Like any task posted to a thread pool, the continuation must not throw.
+    ///     If the latch or the thread pool is destroyed before the continuation could
+    ///     run, the continuation is destroyed without being called.
+    ///   </para>
+    /// </remarks>
+    public: NUCLEX_SUPPORT_API void WaitAsync(
+      ThreadPool &threadPool, std::function<void()> continuation
+    );
+#endif
+
     // ----------------------------------------------------------------------------------------- //
 
     /// <summary>Structure to hold platform dependent process and file handles</summary>
@@ -105,10 +156,16 @@ namespace Nuclex { namespace Support { namespace Threading {
     /// <returns>A reference to the platform dependent implementation data</returns>
     private: PlatformDependentImplementationData &getImplementationData();
 #if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
-    alignas(8) unsigned char implementationDataBuffer[sizeof(std::size_t) * 2];
+    alignas(8) unsigned char implementationDataBuffer[
+      sizeof(std::size_t) * 2 + sizeof(std::uint32_t) * 2
+    ];
 #else // Posix
     unsigned char implementationDataBuffer[96];
 #endif
+#if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+    /// <summary>Continuations waiting for the count to reach zero, created on demand</summary>
+    private: std::atomic<AsyncWaitList *> asyncWaitList;
+#endif
 
   };
 
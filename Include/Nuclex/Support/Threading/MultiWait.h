@@ -0,0 +1,267 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+#ifndef NUCLEX_SUPPORT_THREADING_MULTIWAIT_H
+#define NUCLEX_SUPPORT_THREADING_MULTIWAIT_H
+
+#include "Nuclex/Support/Config.h"
+
+// Multi-object waits sit directly on the wait words of the Gate, Semaphore and StopToken,
+// which only exist in the futex (Linux) and WaitOnAddress() (Windows) implementations
+#if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+
+#include <cstddef> // for std::size_t
+#include <cstdint> // for std::uint32_t
+#include <chrono> // for std::chrono::microseconds, std::chrono::steady_clock
+#include <initializer_list> // for std::initializer_list
+
+namespace Nuclex { namespace Support { namespace Threading {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  class Gate;
+  class Semaphore;
+  class StopToken;
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Waits on several gates, semaphores and stop tokens at the same time</summary>
+  /// <remarks>
+  ///   <para>
+  ///     A thread can block until any (or all) of a set of synchronization primitives let
+  ///     it through: a <see cref="Gate" /> is passed when it is open, a
+  ///     <see cref="Semaphore" /> is passed by taking one of its tickets and a
+  ///     <see cref="StopToken" /> is passed when it has been canceled.
+  ///   </para>
+  ///   <para>
+  ///     On Linux 5.16 and later, the thread sleeps on the wait words of all primitives at
+  ///     once via futex_waitv(). Elsewhere, it sleeps on a global word that all primitives
+  ///     bump when they let threads through while somebody is waiting this way, so
+  ///     multi-object waits may wake up for unrelated primitives, but never miss one.
+  ///   </para>
+  ///   <example>
+  ///     <code>
+  ///       std::size_t index = MultiWait::WaitAny({ workAvailable, pauseGate, *stopToken });
+  ///       if(index == 0) { processWork(); } // took a ticket from the semaphore
+  ///     </code>
+  ///   </example>
+  /// </remarks>
+  class NUCLEX_SUPPORT_TYPE MultiWait {
+
+    #pragma region class Target
+
+    /// <summary>Synchronization primitive that can be part of a multi-object wait</summary>
+    /// <remarks>
+    ///   Implicitly constructed from gates, semaphores and stop tokens, so they can be
+    ///   passed to the wait methods directly. The primitive must outlive the wait.
+    /// </remarks>
+    public: class Target {
+
+      /// <summary>Waits for the specified gate to be open</summary>
+      /// <param name="gate">Gate that will be waited on</param>
+      public: Target(Gate &gate) :
+        kind(Kind::Gate),
+        object(&gate) {}
+
+      /// <summary>Waits for the specified semaphore to hand out a ticket</summary>
+      /// <param name="semaphore">Semaphore that will be waited on</param>
+      public: Target(Semaphore &semaphore) :
+        kind(Kind::Semaphore),
+        object(&semaphore) {}
+
+      /// <summary>Waits for the specified stop token to be canceled</summary>
+      /// <param name="stopToken">Stop token that will be waited on</param>
+      public: Target(const StopToken &stopToken) :
+        kind(Kind::StopToken),
+        object(&stopToken) {}
+
+      /// <summary>Kinds of synchronization primitives that can be waited on</summary>
+      private: enum class Kind {
+        /// <summary>The target is a gate</summary>
+        Gate,
+        /// <summary>The target is a semaphore</summary>
+        Semaphore,
+        /// <summary>The target is a stop token</summary>
+        StopToken
+      };
+
+      /// <summary>Lets the multi-object wait access the waited-on primitive</summary>
+      friend class MultiWait;
+
+      /// <summary>Kind of synchronization primitive being waited on</summary>
+      private: Kind kind;
+      /// <summary>Synchronization primitive being waited on</summary>
+      private: const void *object;
+
+    };
+
+    #pragma endregion // class Target
+
+    /// <summary>Returned by the timed wait methods when the timeout was reached</summary>
+    public: static const constexpr std::size_t TimedOut = static_cast<std::size_t>(-1);
+
+    /// <summary>Waits until any of the targets lets the calling thread through</summary>
+    /// <param name="targets">Gates, semaphores and stop tokens to wait on</param>
+    /// <returns>The index of the target that let the thread through</returns>
+    /// <remarks>
+    ///   Targets are checked in order, so if several targets let the thread through,
+    ///   the one listed first wins. Only the semaphore at the returned index, if any,
+    ///   gives up a ticket.
+    /// </remarks>
+    public: static std::size_t WaitAny(std::initializer_list<Target> targets) {
+      return WaitAny(targets.begin(), targets.size());
+    }
+
+    /// <summary>Waits until any of the targets lets the calling thread through</summary>
+    /// <param name="targets">Gates, semaphores and stop tokens to wait on</param>
+    /// <param name="targetCount">Number of targets to wait on</param>
+    /// <returns>The index of the target that let the thread through</returns>
+    /// <remarks>
+    ///   Targets are checked in order, so if several targets let the thread through,
+    ///   the one listed first wins. Only the semaphore at the returned index, if any,
+    ///   gives up a ticket.
+    /// </remarks>
+    public: NUCLEX_SUPPORT_API static std::size_t WaitAny(
+      const Target *targets, std::size_t targetCount
+    );
+
+    /// <summary>
+    ///   Waits until any of the targets lets the calling thread through or a timeout
+    /// </summary>
+    /// <param name="targets">Gates, semaphores and stop tokens to wait on</param>
+    /// <param name="patience">Maximum amount of time to wait</param>
+    /// <returns>
+    ///   The index of the target that let the thread through or <see cref="TimedOut" />
+    /// </returns>
+    public: static std::size_t WaitAnyFor(
+      std::initializer_list<Target> targets, const std::chrono::microseconds &patience
+    ) {
+      return WaitAnyFor(targets.begin(), targets.size(), patience);
+    }
+
+    /// <summary>
+    ///   Waits until any of the targets lets the calling thread through or a timeout
+    /// </summary>
+    /// <param name="targets">Gates, semaphores and stop tokens to wait on</param>
+    /// <param name="targetCount">Number of targets to wait on</param>
+    /// <param name="patience">Maximum amount of time to wait</param>
+    /// <returns>
+    ///   The index of the target that let the thread through or <see cref="TimedOut" />
+    /// </returns>
+    public: NUCLEX_SUPPORT_API static std::size_t WaitAnyFor(
+      const Target *targets, std::size_t targetCount, const std::chrono::microseconds &patience
+    );
+
+    /// <summary>Waits until all of the targets let the calling thread through</summary>
+    /// <param name="targets">Gates, semaphores and stop tokens to wait on</param>
+    /// <remarks>
+    ///   One ticket is taken from each semaphore. Tickets are taken as soon as they become
+    ///   available and held while waiting for the other targets.
+    /// </remarks>
+    public: static void WaitAll(std::initializer_list<Target> targets) {
+      WaitAll(targets.begin(), targets.size());
+    }
+
+    /// <summary>Waits until all of the targets let the calling thread through</summary>
+    /// <param name="targets">Gates, semaphores and stop tokens to wait on</param>
+    /// <param name="targetCount">Number of targets to wait on</param>
+    /// <remarks>
+    ///   One ticket is taken from each semaphore. Tickets are taken as soon as they become
+    ///   available and held while waiting for the other targets.
+    /// </remarks>
+    public: NUCLEX_SUPPORT_API static void WaitAll(
+      const Target *targets, std::size_t targetCount
+    );
+
+    /// <summary>
+    ///   Waits until all of the targets let the calling thread through or a timeout
+    /// </summary>
+    /// <param name="targets">Gates, semaphores and stop tokens to wait on</param>
+    /// <param name="patience">Maximum amount of time to wait</param>
+    /// <returns>True if all targets let the thread through, false on timeout</returns>
+    /// <remarks>
+    ///   If the wait times out, tickets already taken from semaphores are given back.
+    /// </remarks>
+    public: static bool WaitAllFor(
+      std::initializer_list<Target> targets, const std::chrono::microseconds &patience
+    ) {
+      return WaitAllFor(targets.begin(), targets.size(), patience);
+    }
+
+    /// <summary>
+    ///   Waits until all of the targets let the calling thread through or a timeout
+    /// </summary>
+    /// <param name="targets">Gates, semaphores and stop tokens to wait on</param>
+    /// <param name="targetCount">Number of targets to wait on</param>
+    /// <param name="patience">Maximum amount of time to wait</param>
+    /// <returns>True if all targets let the thread through, false on timeout</returns>
+    /// <remarks>
+    ///   If the wait times out, tickets already taken from semaphores are given back.
+    /// </remarks>
+    public: NUCLEX_SUPPORT_API static bool WaitAllFor(
+      const Target *targets, std::size_t targetCount, const std::chrono::microseconds &patience
+    );
+
+    /// <summary>Waits until any of the targets lets the thread through</summary>
+    /// <param name="targets">Gates, semaphores and stop tokens to wait on</param>
+    /// <param name="targetCount">Number of targets to wait on</param>
+    /// <param name="deadline">Time at which the wait fails, null to wait forever</param>
+    /// <returns>
+    ///   The index of the target that let the thread through or <see cref="TimedOut" />
+    /// </returns>
+    private: static std::size_t waitAny(
+      const Target *targets,
+      std::size_t targetCount,
+      const std::chrono::steady_clock::time_point *deadline
+    );
+
+    /// <summary>Waits until all of the targets let the thread through</summary>
+    /// <param name="targets">Gates, semaphores and stop tokens to wait on</param>
+    /// <param name="targetCount">Number of targets to wait on</param>
+    /// <param name="deadline">Time at which the wait fails, null to wait forever</param>
+    /// <returns>True if all targets let the thread through, false on timeout</returns>
+    private: static bool waitAll(
+      const Target *targets,
+      std::size_t targetCount,
+      const std::chrono::steady_clock::time_point *deadline
+    );
+
+    /// <summary>Checks whether a target lets the thread through right now</summary>
+    /// <param name="target">Target that will be checked</param>
+    /// <returns>True if the target let the thread through</returns>
+    /// <remarks>For semaphores, a ticket is taken if this returns true</remarks>
+    private: static bool tryPass(const Target &target);
+
+    /// <summary>Readies a target for sleeping on its wait word</summary>
+    /// <param name="target">Target whose wait word will be returned</param>
+    /// <returns>
+    ///   The word to sleep on while it is 0 or null if the target has meanwhile
+    ///   become passable
+    /// </returns>
+    private: static const volatile std::uint32_t *prepareToWait(const Target &target);
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Threading
+
+#endif // defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+
+#endif // NUCLEX_SUPPORT_THREADING_MULTIWAIT_H
@@ -0,0 +1,129 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+#ifndef NUCLEX_SUPPORT_THREADING_MUTEX_H
+#define NUCLEX_SUPPORT_THREADING_MUTEX_H
+
+#include "Nuclex/Support/Config.h"
+
+// The mutex sits directly on the futex (Linux) or WaitOnAddress() (Windows) API,
+// there is no implementation for other platforms
+#if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+
+#include <cstdint> // for std::uint32_t
+#include <cstddef> // for std::size_t
+
+namespace Nuclex { namespace Support { namespace Threading {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Lets only one thread at a time enter a critical section</summary>
+  /// <remarks>
+  ///   <para>
+  ///     This is a lightweight mutex built directly on the operating system's ability to
+  ///     let threads sleep on a memory address (futex on Linux, WaitOnAddress() on
+  ///     Windows). Locking and unlocking an uncontended mutex is a single atomic operation
+  ///     each, the kernel is only involved when a thread actually has to sleep.
+  ///   </para>
+  ///   <para>
+  ///     Like the <see cref="Gate" /> and <see cref="Semaphore" />, a thread that finds
+  ///     the mutex locked will spin for a short, self-tuning duration before it goes to
+  ///     sleep, since critical sections are usually short.
+  ///   </para>
+  ///   <para>
+  ///     The mutex is not recursive and not fair. It also provides the lowercase lock(),
+  ///     try_lock() and unlock() methods so it can be used with std::lock_guard,
+  ///     std::unique_lock and std::scoped_lock.
+  ///   </para>
+  /// </remarks>
+  class NUCLEX_SUPPORT_TYPE Mutex {
+
+    /// <summary>Initializes a new, unlocked mutex</summary>
+    public: NUCLEX_SUPPORT_API Mutex();
+
+    /// <summary>Frees all resources owned by the mutex</summary>
+    /// <remarks>
+    ///   The mutex must not be locked when it is destroyed.
+    /// </remarks>
+    public: NUCLEX_SUPPORT_API ~Mutex();
+
+    // ----------------------------------------------------------------------------------------- //
+
+    /// <summary>Locks the mutex, waiting for another thread to unlock it if needed</summary>
+    public: NUCLEX_SUPPORT_API void Lock();
+
+    /// <summary>Locks the mutex if it is not currently locked</summary>
+    /// <returns>True if the mutex was locked, false if it was already locked</returns>
+    public: NUCLEX_SUPPORT_API bool TryLock();
+
+    /// <summary>Unlocks the mutex, letting the next waiting thread in</summary>
+    /// <remarks>
+    ///   Must only be called by the thread that locked the mutex.
+    /// </remarks>
+    public: NUCLEX_SUPPORT_API void Unlock();
+
+    /// <summary>Sets how long a waiting thread may spin before it goes to sleep</summary>
+    /// <param name="maximumSpinCount">
+    ///   Maximum number of spin iterations, 0 disables spinning entirely
+    /// </param>
+    /// <remarks>
+    ///   See <see cref="Gate.SetMaximumSpinCount" /> for details.
+    /// </remarks>
+    public: NUCLEX_SUPPORT_API void SetMaximumSpinCount(std::size_t maximumSpinCount);
+
+    // ----------------------------------------------------------------------------------------- //
+
+    /// <summary>Locks the mutex, provided for std::lock_guard and friends</summary>
+    public: void lock() { Lock(); }
+
+    /// <summary>Locks the mutex if possible, provided for std::unique_lock</summary>
+    /// <returns>True if the mutex was locked, false if it was already locked</returns>
+    public: bool try_lock() { return TryLock(); }
+
+    /// <summary>Unlocks the mutex, provided for std::lock_guard and friends</summary>
+    public: void unlock() { Unlock(); }
+
+    // ----------------------------------------------------------------------------------------- //
+
+    private: Mutex(const Mutex &) = delete;
+    private: Mutex &operator =(const Mutex &) = delete;
+
+    /// <summary>Structure to hold the mutex' lock word and spinner</summary>
+    private: struct PlatformDependentImplementationData;
+    /// <summary>Accesses the platform dependent implementation data container</summary>
+    /// <returns>A reference to the platform dependent implementation data</returns>
+    private: PlatformDependentImplementationData &getImplementationData();
+
+    /// <summary>Holds the platform dependent implementation data</summary>
+    /// <remarks>
+    ///   The implementation data consists of the lock word and the adaptive spinner,
+    ///   which is internal to the library. Keeping it in a buffer avoids exposing it
+    ///   without needing a heap allocation.
+    /// </remarks>
+    private: alignas(8) unsigned char implementationDataBuffer[sizeof(std::uint32_t) * 3];
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Threading
+
+#endif // defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+
+#endif // NUCLEX_SUPPORT_THREADING_MUTEX_H
@@ -0,0 +1,210 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+#ifndef NUCLEX_SUPPORT_THREADING_READMOSTLY_H
+#define NUCLEX_SUPPORT_THREADING_READMOSTLY_H
+
+#include "Nuclex/Support/Config.h"
+#include "Nuclex/Support/Threading/EpochDomain.h"
+
+#include <atomic> // for std::atomic
+#include <mutex> // for std::mutex, std::lock_guard
+#include <memory> // for std::unique_ptr
+#include <utility> // for std::move(), std::forward()
+
+namespace Nuclex { namespace Support { namespace Threading {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Value that is read constantly and only replaced once in a while</summary>
+  /// <typeparam name="TValue">Type of value that will be published to the readers</typeparam>
+  /// <remarks>
+  ///   <para>
+  ///     Intended for things like configuration snapshots or routing tables that many
+  ///     threads consult all the time. Readers take no lock and do no atomic read-modify-write
+  ///     operations, they only store to a record owned by their thread and then get
+  ///     a pointer to the current value, so readers on different cores never contend.
+  ///   </para>
+  ///   <para>
+  ///     Writers never modify the value in place. They create a new value, publish it
+  ///     and the old value is freed once all readers that might still be looking at it
+  ///     are finished, which is tracked by an <see cref="EpochDomain" />. Writers are
+  ///     serialized by a mutex.
+  ///   </para>
+  ///   <para>
+  ///     A <see cref="ReadScope" /> should be short-lived since it holds back
+  ///     the reclamation of all replaced values, not just of the one it is looking at.
+  ///     It must be destroyed by the thread that created it.
+  ///   </para>
+  ///   <example>
+  ///     <code>
+  ///       ReadMostly&lt;Settings&gt; settings;
+  ///
+  ///       // Any number of threads
+  ///       {
+  ///         ReadMostly&lt;Settings&gt;::ReadScope current = settings.Read();
+  ///         useTimeout(current-&gt;Timeout);
+  ///       }
+  ///
+  ///       // Once in a while
+  ///       settings.Update([](Settings &amp;newSettings) { newSettings.Timeout = 10; });
+  ///     </code>
+  ///   </example>
+  /// </remarks>
+  template<typename TValue>
+  class ReadMostly {
+
+    #pragma region class ReadScope
+
+    /// <summary>Grants access to the value that was current when reading began</summary>
+    public: class ReadScope {
+
+      /// <summary>Begins reading the current value of a read-mostly value</summary>
+      /// <param name="owner">Read-mostly value whose current value will be read</param>
+      public: explicit ReadScope(const ReadMostly &owner) :
+        epochScope(owner.reclamation),
+        value(owner.current.load(std::memory_order_seq_cst)) {}
+
+      /// <summary>Takes over the read section of another read scope</summary>
+      /// <param name="other">Read scope that will be taken over</param>
+      public: ReadScope(ReadScope &&other) noexcept = default;
+
+      /// <summary>Accesses the value the read scope is looking at</summary>
+      /// <returns>The value that was current when the read scope was created</returns>
+      public: const TValue &operator *() const noexcept { return *this->value; }
+
+      /// <summary>Accesses the members of the value the read scope is looking at</summary>
+      /// <returns>The value that was current when the read scope was created</returns>
+      public: const TValue *operator ->() const noexcept { return this->value; }
+
+      private: ReadScope(const ReadScope &) = delete;
+      private: ReadScope &operator =(const ReadScope &) = delete;
+      private: ReadScope &operator =(ReadScope &&) = delete;
+
+      /// <summary>Keeps the value from being freed while the read scope exists</summary>
+      private: EpochDomain::ReadScope epochScope;
+      /// <summary>Value that was current when the read scope was created</summary>
+      private: const TValue *value;
+
+    };
+
+    #pragma endregion // class ReadScope
+
+    /// <summary>Initializes a new read-mostly value with a default-constructed value</summary>
+    public: ReadMostly() :
+      updateMutex(),
+      reclamation(),
+      current(new TValue()) {}
+
+    /// <summary>Initializes a new read-mostly value as a copy of an existing value</summary>
+    /// <param name="initialValue">Value that will be published initially</param>
+    public: explicit ReadMostly(const TValue &initialValue) :
+      updateMutex(),
+      reclamation(),
+      current(new TValue(initialValue)) {}
+
+    /// <summary>Initializes a new read-mostly value by moving in an existing value</summary>
+    /// <param name="initialValue">Value that will be published initially</param>
+    public: explicit ReadMostly(TValue &&initialValue) :
+      updateMutex(),
+      reclamation(),
+      current(new TValue(std::move(initialValue))) {}
+
+    /// <summary>Frees the current value and all replaced values</summary>
+    /// <remarks>
+    ///   No thread may be reading or updating the value when it is destroyed.
+    /// </remarks>
+    public: ~ReadMostly() {
+      delete this->current.load(std::memory_order_relaxed);
+    }
+
+    /// <summary>Begins reading the current value</summary>
+    /// <returns>A read scope through which the current value can be accessed</returns>
+    public: ReadScope Read() const {
+      return ReadScope(*this);
+    }
+
+    /// <summary>Returns a copy of the current value</summary>
+    /// <returns>A copy of the value that is currently published</returns>
+    public: TValue Load() const {
+      return *Read();
+    }
+
+    /// <summary>Publishes a new value, replacing the current one</summary>
+    /// <param name="newValue">Value that will be published</param>
+    public: void Publish(const TValue &newValue) {
+      std::unique_ptr<TValue> published(new TValue(newValue));
+      std::lock_guard<std::mutex> updateScope(this->updateMutex);
+      replace(std::move(published));
+    }
+
+    /// <summary>Publishes a new value, replacing the current one</summary>
+    /// <param name="newValue">Value that will be moved in and published</param>
+    public: void Publish(TValue &&newValue) {
+      std::unique_ptr<TValue> published(new TValue(std::move(newValue)));
+      std::lock_guard<std::mutex> updateScope(this->updateMutex);
+      replace(std::move(published));
+    }
+
+    /// <summary>Publishes a modified copy of the current value</summary>
+    /// <typeparam name="TUpdater">Type of the method that will modify the copy</typeparam>
+    /// <param name="updater">Method that will be called to modify the copy</param>
+    /// <remarks>
+    ///   Updates are serialized, so no other update can slip in between copying
+    ///   the current value and publishing the modified copy. If the updater throws,
+    ///   the current value stays published.
+    /// </remarks>
+    public: template<typename TUpdater>
+    void Update(TUpdater &&updater) {
+      std::lock_guard<std::mutex> updateScope(this->updateMutex);
+
+      std::unique_ptr<TValue> published(
+        new TValue(*this->current.load(std::memory_order_relaxed))
+      );
+      std::forward<TUpdater>(updater)(*published);
+      replace(std::move(published));
+    }
+
+    /// <summary>Publishes a new value and retires the one it replaced</summary>
+    /// <param name="published">Value that will be published</param>
+    private: void replace(std::unique_ptr<TValue> published) {
+      TValue *replaced = this->current.exchange(published.release(), std::memory_order_seq_cst);
+      this->reclamation.Retire(replaced);
+
+      // Values are replaced rarely, so don't wait for a whole batch to pile up
+      this->reclamation.Reclaim();
+    }
+
+    private: ReadMostly(const ReadMostly &) = delete;
+    private: ReadMostly &operator =(const ReadMostly &) = delete;
+
+    /// <summary>Held by writers while they replace the value</summary>
+    private: std::mutex updateMutex;
+    /// <summary>Frees replaced values once no reader can see them anymore</summary>
+    private: EpochDomain reclamation;
+    /// <summary>Value that is currently published to the readers</summary>
+    private: std::atomic<TValue *> current;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Threading
+
+#endif // NUCLEX_SUPPORT_THREADING_READMOSTLY_H
@@ -0,0 +1,164 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+#ifndef NUCLEX_SUPPORT_THREADING_READERWRITERLOCK_H
+#define NUCLEX_SUPPORT_THREADING_READERWRITERLOCK_H
+
+#include "Nuclex/Support/Config.h"
+
+// The reader/writer lock sits directly on the futex (Linux) or WaitOnAddress() (Windows)
+// API, there is no implementation for other platforms
+#if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+
+#include "Nuclex/Support/Threading/Mutex.h"
+
+#include <atomic> // for std::atomic
+#include <cstdint> // for std::uint32_t
+#include <cstddef> // for std::size_t
+
+namespace Nuclex { namespace Support { namespace Threading {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Lets many readers or a single writer enter a critical section</summary>
+  /// <remarks>
+  ///   <para>
+  ///     Most reader/writer locks (including std::shared_mutex) keep a single counter of
+  ///     active readers. Even though readers don't block each other, every reader has to
+  ///     modify that counter, so the cache line holding it bounces between all CPU cores
+  ///     and read-mostly code stops scaling beyond a handful of threads.
+  ///   </para>
+  ///   <para>
+  ///     This lock keeps one reader counter per CPU core, each on its own cache line.
+  ///     A thread always uses the same counter, threads are spread over the counters as
+  ///     they first take a read lock. Taking a read lock only touches the thread's own
+  ///     counter and reads the writer flag, which stays in every core's cache while no
+  ///     writer is around.
+  ///   </para>
+  ///   <para>
+  ///     The price is paid by writers: a writer raises the writer flag, then has to look
+  ///     at every reader counter and wait until all of them have drained. While the writer
+  ///     flag is raised, new readers back off and wait for the writer to finish, so
+  ///     writers cannot be starved by a continuous stream of readers. Use this lock where
+  ///     reads vastly outnumber writes.
+  ///   </para>
+  ///   <para>
+  ///     The lock is not recursive. It provides the lowercase lock(), unlock(),
+  ///     lock_shared() and unlock_shared() methods so it can be used with std::unique_lock
+  ///     and std::shared_lock.
+  ///   </para>
+  /// </remarks>
+  class NUCLEX_SUPPORT_TYPE ReaderWriterLock {
+
+    /// <summary>Initializes a new reader/writer lock</summary>
+    public: NUCLEX_SUPPORT_API ReaderWriterLock();
+
+    /// <summary>Frees all resources owned by the reader/writer lock</summary>
+    /// <remarks>
+    ///   The lock must not be held by any reader or writer when it is destroyed.
+    /// </remarks>
+    public: NUCLEX_SUPPORT_API ~ReaderWriterLock();
+
+    // ----------------------------------------------------------------------------------------- //
+
+    /// <summary>Locks for reading, waiting for a writer to finish if needed</summary>
+    public: NUCLEX_SUPPORT_API void LockShared();
+
+    /// <summary>Locks for reading if no writer holds or is waiting for the lock</summary>
+    /// <returns>True if the lock was taken, false if a writer was in the way</returns>
+    public: NUCLEX_SUPPORT_API bool TryLockShared();
+
+    /// <summary>Releases a read lock taken by the calling thread</summary>
+    public: NUCLEX_SUPPORT_API void UnlockShared();
+
+    /// <summary>Locks for writing, waiting for all readers and writers to leave</summary>
+    public: NUCLEX_SUPPORT_API void Lock();
+
+    /// <summary>Locks for writing if nobody else holds the lock</summary>
+    /// <returns>True if the lock was taken, false if readers or a writer were in the way</returns>
+    public: NUCLEX_SUPPORT_API bool TryLock();
+
+    /// <summary>Releases the write lock</summary>
+    public: NUCLEX_SUPPORT_API void Unlock();
+
+    // ----------------------------------------------------------------------------------------- //
+
+    /// <summary>Locks for reading, provided for std::shared_lock</summary>
+    public: void lock_shared() { LockShared(); }
+
+    /// <summary>Locks for reading if possible, provided for std::shared_lock</summary>
+    /// <returns>True if the lock was taken, false if a writer was in the way</returns>
+    public: bool try_lock_shared() { return TryLockShared(); }
+
+    /// <summary>Releases a read lock, provided for std::shared_lock</summary>
+    public: void unlock_shared() { UnlockShared(); }
+
+    /// <summary>Locks for writing, provided for std::unique_lock and friends</summary>
+    public: void lock() { Lock(); }
+
+    /// <summary>Locks for writing if possible, provided for std::unique_lock</summary>
+    /// <returns>True if the lock was taken, false if readers or a writer were in the way</returns>
+    public: bool try_lock() { return TryLock(); }
+
+    /// <summary>Releases the write lock, provided for std::unique_lock and friends</summary>
+    public: void unlock() { Unlock(); }
+
+    // ----------------------------------------------------------------------------------------- //
+
+    private: ReaderWriterLock(const ReaderWriterLock &) = delete;
+    private: ReaderWriterLock &operator =(const ReaderWriterLock &) = delete;
+
+    /// <summary>Looks up the reader counter the calling thread uses</summary>
+    /// <returns>The reader counter for the calling thread</returns>
+    private: std::atomic<std::size_t> &getReaderCount();
+
+    /// <summary>Leaves the reader counter and notifies a waiting writer if needed</summary>
+    /// <param name="readerCount">Reader counter that will be decremented</param>
+    private: void leaveReaderCount(std::atomic<std::size_t> &readerCount);
+
+    /// <summary>Waits until all readers have left their counters</summary>
+    private: void waitForReadersToDrain();
+
+    /// <summary>Reader counter padded to fill an entire cache line</summary>
+    private: struct ReaderSlot;
+
+    /// <summary>One reader counter per CPU core, each on its own cache line</summary>
+    private: ReaderSlot *readerSlots;
+    /// <summary>Bit mask to turn a thread's slot number into an index</summary>
+    private: std::size_t readerSlotMask;
+    /// <summary>Non-zero while a writer holds or is waiting for the lock</summary>
+    /// <remarks>
+    ///   Readers sleep on this word while a writer is around. It is 1 if no reader
+    ///   is sleeping and 2 if a reader may be sleeping and needs to be woken up.
+    /// </remarks>
+    private: std::atomic<std::uint32_t> writerWord;
+    /// <summary>Changed by readers leaving while a writer is waiting for them</summary>
+    private: std::atomic<std::uint32_t> drainWord;
+    /// <summary>Makes writers take turns so only one writer at a time waits for readers</summary>
+    private: Mutex writerMutex;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Threading
+
+#endif // defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+
+#endif // NUCLEX_SUPPORT_THREADING_READERWRITERLOCK_H
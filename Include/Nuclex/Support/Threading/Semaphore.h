@@ -23,12 +23,20 @@ limitations under the License.
 #include "Nuclex/Support/Config.h"
 
 #include <cstddef> // for std::size_t
+#include <cstdint> // for std::uint32_t
 #include <chrono> // for std::chrono::microseconds
+#include <atomic> // for std::atomic
+#include <functional> // for std::function
 
 namespace Nuclex { namespace Support { namespace Threading {
 
   // ------------------------------------------------------------------------------------------- //
 
+  class ThreadPool;
+  class AsyncWaitList;
+
+  // ------------------------------------------------------------------------------------------- //
+
   /// <summary>Lets only a specific number of threads enter at the same time</summary>
   /// <remarks>
   ///   <para>
@@ -100,18 +108,93 @@ namespace Nuclex { namespace Support { namespace Threading {
 
     //public: void WaitUntilThenDecrement(const std::chrono::time_point< &patience);
 
+    /// <summary>Sets how long a waiting thread may spin before it goes to sleep</summary>
+    /// <param name="maximumSpinCount">
+    ///   Maximum number of spin iterations, 0 disables spinning entirely
+    /// </param>
+    /// <remarks>
+    ///   <para>
+    ///     Sending a thread to sleep and waking it up again takes a system call on each
+    ///     side. If the semaphore is typically posted to within microseconds, briefly
+    ///     busy-waiting is much cheaper. The number of iterations actually spun adapts
+    ///     to how long recent waits took, this only sets the upper limit.
+    ///   </para>
+    ///   <para>
+    ///     By default, up to 1000 iterations are spun on systems with more than one CPU
+    ///     and spinning is disabled on single-CPU systems. Only the Linux and Windows
+    ///     implementations spin, on other platforms this setting has no effect.
+    ///   </para>
+    /// </remarks>
+    public: NUCLEX_SUPPORT_API void SetMaximumSpinCount(std::size_t maximumSpinCount);
+
+#if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+    /// <summary>
+    ///   Runs a continuation on a thread pool once the semaphore could be decremented
+    /// </summary>
+    /// <param name="threadPool">Thread pool the continuation will be posted to</param>
+    /// <param name="continuation">
+    ///   Continuation that will run after the semaphore has been decremented for it
+    /// </param>
+    /// <remarks>
+    ///   <para>
+    ///     Instead of blocking the calling thread, the continuation is stored and posted to the
+    ///     specified thread pool once the semaphore has a ticket for it. If a ticket is available,
+    ///     the continuation is posted right away. This lets a large number of operations wait on
+    ///     the semaphore without tying up one thread for each.
+    ///   </para>
+    ///   <para>
+    ///     Like any task posted to a thread pool, the continuation must not throw.
+    ///     If the semaphore or the thread pool is destroyed before the continuation could
+    ///     run, the continuation is destroyed without being called.
+    ///   </para>
+    /// </remarks>
+    public: NUCLEX_SUPPORT_API void WaitThenDecrementAsync(
+      ThreadPool &threadPool, std::function<void()> continuation
+    );
+#endif
+
     // ----------------------------------------------------------------------------------------- //
 
+#if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+    /// <summary>Lets multi-object waits sleep on the semaphore's wait word</summary>
+    friend class MultiWait;
+
+    /// <summary>Adds tickets and wakes up threads blocked on the semaphore</summary>
+    /// <param name="count">Number of tickets that will be added</param>
+    /// <remarks>
+    ///   Unlike <see cref="Post" />, this does not hand tickets to asynchronous waiters.
+    ///   It is used to return tickets that were taken for a continuation that could
+    ///   not be posted to its thread pool.
+    /// </remarks>
+    private: void admit(std::size_t count);
+
+    /// <summary>Takes a ticket from the semaphore if one is available</summary>
+    /// <returns>True if a ticket was taken, false if none were available</returns>
+    private: bool tryDecrement();
+
+    /// <summary>Marks the semaphore as having sleepers unless tickets are available</summary>
+    /// <returns>
+    ///   The word to sleep on while it is 0 or null if tickets have become available
+    /// </returns>
+    private: const volatile std::uint32_t *prepareToWait();
+#endif
+
     /// <summary>Structure to hold platform dependent process and file handles</summary>
     private: struct PlatformDependentImplementationData;
     /// <summary>Accesses the platform dependent implementation data container</summary>
     /// <returns>A reference to the platform dependent implementation data</returns>
     private: PlatformDependentImplementationData &getImplementationData();
 #if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
-    alignas(8) unsigned char implementationDataBuffer[sizeof(std::size_t) * 2];
+    alignas(8) unsigned char implementationDataBuffer[
+      sizeof(std::size_t) * 2 + sizeof(std::uint32_t) * 2
+    ];
 #else // Posix
     unsigned char implementationDataBuffer[96];
 #endif
+#if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+    /// <summary>Continuations waiting for a ticket, created on demand</summary>
+    private: std::atomic<AsyncWaitList *> asyncWaitList;
+#endif
 
   };
 
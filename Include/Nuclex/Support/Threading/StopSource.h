@@ -33,8 +33,6 @@ limitations under the License.
 #include "Nuclex/Support/Config.h"
 #include "Nuclex/Support/Threading/StopToken.h"
 
-#include <cassert> // for assert()
-
 namespace Nuclex { namespace Support { namespace Threading {
 
   // ------------------------------------------------------------------------------------------- //
@@ -83,13 +81,11 @@ namespace Nuclex { namespace Support { namespace Threading {
     ///   Optional reason for the cancellation, included in exception message when
     ///   <see cref="StopToken.ThrowIfCanceled" /> is used.
     /// </param>
-    public: NUCLEX_SUPPORT_API void Cancel(const std::string &reason = std::string()) {
-      assert((IsCanceled() == false) && u8"Cancellation is triggered only once");
-
-      this->CancellationReason = reason;
-      std::atomic_thread_fence(std::memory_order::memory_order_release);
-      this->Canceled.store(true, std::memory_order::memory_order_relaxed);
-    }
+    /// <remarks>
+    ///   Threads waiting for the stop token through <see cref="MultiWait" /> are woken up
+    ///   right away.
+    /// </remarks>
+    public: NUCLEX_SUPPORT_API void Cancel(const std::string &reason = std::string());
 
     // ----------------------------------------------------------------------------------------- //
 
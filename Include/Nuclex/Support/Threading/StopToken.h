@@ -25,6 +25,7 @@ limitations under the License.
 
 #include <memory> // for std::enable_shared_from_this, std::shared_ptr
 #include <atomic> // for std::atomic
+#include <cstdint> // for std::uint32_t
 
 namespace Nuclex { namespace Support { namespace Threading {
 
@@ -35,7 +36,7 @@ namespace Nuclex { namespace Support { namespace Threading {
 
     /// <summary>Initializes a new stop token</summary>
     protected: NUCLEX_SUPPORT_API StopToken() :
-      Canceled(false), CancellationReason() {}
+      Canceled(0), CancellationReason() {}
 
     /// <summary>Frees all resources owned by the stop token</summary>
     public: NUCLEX_SUPPORT_API virtual ~StopToken() = default;
@@ -44,7 +45,7 @@ namespace Nuclex { namespace Support { namespace Threading {
 
     /// <summary>Checks whether a cancellation has occured</summary>
     public: NUCLEX_SUPPORT_API bool IsCanceled() const {
-      return this->Canceled.load(std::memory_order::memory_order_relaxed);
+      return (this->Canceled.load(std::memory_order::memory_order_relaxed) != 0);
     }
 
     /// <summary>Throws an exception if a cancellation has occured</summary>
@@ -57,8 +58,11 @@ namespace Nuclex { namespace Support { namespace Threading {
 
     // ----------------------------------------------------------------------------------------- //
 
-    /// <summary>Cancellation reason, doubles are cancellation flag if set</summary>
-    protected: std::atomic<bool> Canceled;
+    /// <summary>Lets multi-object waits sleep until the stop token is canceled</summary>
+    friend class MultiWait;
+
+    /// <summary>Cancellation flag, 1 if canceled, threads can sleep on it while it's 0</summary>
+    protected: std::atomic<std::uint32_t> Canceled;
     /// <summary>Why cancellation happened, optionally provided by the canceling side</summary>
     protected: std::string CancellationReason;
 
@@ -0,0 +1,251 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+#ifndef NUCLEX_SUPPORT_THREADING_STRAND_H
+#define NUCLEX_SUPPORT_THREADING_STRAND_H
+
+#include "Nuclex/Support/Config.h"
+
+// The strand executes its tasks on the thread pool, which is currently only
+// implemented for Linux and Windows
+#if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+
+#include <memory> // for std::shared_ptr
+#include <future> // for std::future, std::packaged_task
+#include <functional> // for std::bind()
+#include <tuple> // for std::tuple, std::apply()
+#include <type_traits> // for std::decay, std::invoke_result
+
+namespace Nuclex { namespace Support { namespace Threading {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  class ThreadPool;
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Executes tasks on a thread pool one after another in submission order</summary>
+  /// <remarks>
+  ///   <para>
+  ///     A strand gives the same guarantees as a dedicated worker thread with a queue:
+  ///     tasks run in the order they were submitted and never overlap, so state only
+  ///     touched by the tasks of one strand needs no locking. But instead of occupying
+  ///     a thread, the strand borrows a worker thread of a shared thread pool whenever
+  ///     it has tasks queued, so you can have one strand per connection, per file or
+  ///     per document without ending up with thousands of threads.
+  ///   </para>
+  ///   <para>
+  ///     Submitting a task only pushes it onto a lock-free list. Only when the strand was
+  ///     idle is a single drain task posted to the thread pool, which then executes all
+  ///     tasks that were submitted in the meantime in one go. To keep a busy strand from
+  ///     monopolizing a worker thread, the drain task steps aside after a batch of tasks
+  ///     and posts itself to the thread pool again.
+  ///   </para>
+  ///   <para>
+  ///     Tasks do not all need to run on the same worker thread, only one at a time.
+  ///     Everything a task did is visible to the next task of the strand.
+  ///   </para>
+  ///   <para>
+  ///     Destroying the strand does not cancel or wait for its tasks. Tasks already
+  ///     submitted will still be executed by the thread pool as usual (or be dropped if
+  ///     the thread pool is destroyed first). The thread pool must outlive the strand.
+  ///   </para>
+  /// </remarks>
+  class NUCLEX_SUPPORT_TYPE Strand {
+
+    #pragma region class Task
+
+    /// <summary>Base class for the tasks queued in a strand</summary>
+    private: class Task {
+
+      /// <summary>Initializes a new task</summary>
+      public: Task() : Next(nullptr) {}
+      /// <summary>Frees all resources owned by the task</summary>
+      public: virtual ~Task() = default;
+      /// <summary>Executes the task</summary>
+      public: virtual void operator()() noexcept = 0;
+
+      /// <summary>Next task in the strand's queue, used by the strand</summary>
+      public: Task *Next;
+
+    };
+
+    #pragma endregion // class Task
+
+    /// <summary>Initializes a new strand executing its tasks on a thread pool</summary>
+    /// <param name="threadPool">Thread pool that will execute the strand's tasks</param>
+    public: NUCLEX_SUPPORT_API Strand(ThreadPool &threadPool);
+
+    /// <summary>Destroys the strand, letting already submitted tasks run</summary>
+    public: NUCLEX_SUPPORT_API ~Strand();
+
+    /// <summary>Schedules a task to run after all tasks submitted before it</summary>
+    /// <typeparam name="TMethod">
+    ///   Type of the method that will be run on a worker thread
+    /// </typeparam>
+    /// <typeparam name="TArguments">
+    ///   Type of the arguments that will be passed to the method when it is called
+    /// </typeparam>
+    /// <param name="method">Method that will be called from a worker thread</param>
+    /// <param name="arguments">Argument values that will be passed to the method</param>
+    /// <returns>
+    ///   An std::future instance that will provide the result returned by the method
+    /// </returns>
+    /// <remarks>
+    ///   Like with <see cref="ThreadPool.Schedule" />, if the thread pool is destroyed
+    ///   before the task ran, the future will throw an std::future_error of type
+    ///   broken_promise in std::future::get().
+    /// </remarks>
+    public: template<typename TMethod, typename... TArguments>
+    inline std::future<typename std::invoke_result<TMethod, TArguments...>::type>
+    Schedule(TMethod &&method, TArguments &&... arguments);
+
+    /// <summary>Posts a task without a result to run after all tasks submitted before it</summary>
+    /// <typeparam name="TMethod">
+    ///   Type of the method that will be run on a worker thread
+    /// </typeparam>
+    /// <typeparam name="TArguments">
+    ///   Type of the arguments that will be passed to the method when it is called
+    /// </typeparam>
+    /// <param name="method">Method that will be called from a worker thread</param>
+    /// <param name="arguments">Argument values that will be passed to the method</param>
+    /// <remarks>
+    ///   This is the fire-and-forget variant of <see cref="Schedule" />. Just like with
+    ///   <see cref="ThreadPool.Post" />, there is nobody to hand an exception to, so
+    ///   if the method throws, std::terminate() is called.
+    /// </remarks>
+    public: template<typename TMethod, typename... TArguments>
+    inline void Post(TMethod &&method, TArguments &&... arguments);
+
+    /// <summary>Checks whether the calling thread is executing a task of this strand</summary>
+    /// <returns>True if called from within one of this strand's tasks</returns>
+    public: NUCLEX_SUPPORT_API bool IsRunningInThisThread() const;
+
+    private: Strand(const Strand &) = delete;
+    private: Strand &operator =(const Strand &) = delete;
+
+    /// <summary>Queues a task and starts draining the strand if it was idle</summary>
+    /// <param name="task">Task that will be queued, the strand takes ownership</param>
+    private: NUCLEX_SUPPORT_API void submit(Task *task);
+
+    /// <summary>Structure holding the state shared with the drain task</summary>
+    private: struct State;
+
+    /// <summary>State shared with the drain task, which may run after the strand is gone</summary>
+    private: std::shared_ptr<State> state;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+  template<typename TMethod, typename... TArguments>
+  inline std::future<typename std::invoke_result<TMethod, TArguments...>::type>
+  Strand::Schedule(TMethod &&method, TArguments &&... arguments) {
+    typedef typename std::invoke_result<TMethod, TArguments...>::type ResultType;
+    typedef std::packaged_task<ResultType()> TaskType;
+
+    #pragma region struct PackagedTask
+
+    /// <summary>Custom packaged task that carries the method and parameters</summary>
+    struct PackagedTask : public Task {
+
+      /// <summary>Initializes the packaged task</summary>
+      /// <param name="method">Method that should be called back by the strand</param>
+      /// <param name="arguments">Arguments to save until the invocation</param>
+      public: PackagedTask(TMethod &&method, TArguments &&... arguments) :
+        Task(),
+        Callback(
+          std::bind(std::forward<TMethod>(method), std::forward<TArguments>(arguments)...)
+        ) {}
+
+      /// <summary>Terminates the task. If the task was not executed, cancels it</summary>
+      public: ~PackagedTask() override = default;
+
+      /// <summary>Executes the task, exceptions are delivered through the future</summary>
+      public: void operator()() noexcept override {
+        this->Callback();
+      }
+
+      /// <summary>Stored method pointer and arguments that will be called back</summary>
+      public: TaskType Callback;
+
+    };
+
+    #pragma endregion // struct PackagedTask
+
+    PackagedTask *packagedTask = new PackagedTask(
+      std::forward<TMethod>(method), std::forward<TArguments>(arguments)...
+    );
+
+    // Grab the future before submitting, the task may be executed and destroyed
+    // before submit() even returns
+    std::future<ResultType> result = packagedTask->Callback.get_future();
+    submit(packagedTask);
+
+    return result;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  template<typename TMethod, typename... TArguments>
+  inline void Strand::Post(TMethod &&method, TArguments &&... arguments) {
+
+    #pragma region struct PostedTask
+
+    /// <summary>Task that carries the method and its arguments</summary>
+    struct PostedTask : public Task {
+
+      /// <summary>Initializes the posted task</summary>
+      /// <param name="method">Method that will be called back</param>
+      /// <param name="arguments">Arguments to save until the invocation</param>
+      public: PostedTask(TMethod &&method, TArguments &&... arguments) :
+        Task(),
+        Method(std::forward<TMethod>(method)),
+        Arguments(std::forward<TArguments>(arguments)...) {}
+
+      /// <summary>Frees all resources owned by the task</summary>
+      public: ~PostedTask() override = default;
+
+      /// <summary>Executes the task</summary>
+      public: void operator()() noexcept override {
+        std::apply(std::move(this->Method), std::move(this->Arguments));
+      }
+
+      /// <summary>Method that will be called back</summary>
+      public: typename std::decay<TMethod>::type Method;
+      /// <summary>Arguments that will be passed to the method</summary>
+      public: std::tuple<typename std::decay<TArguments>::type...> Arguments;
+
+    };
+
+    #pragma endregion // struct PostedTask
+
+    submit(
+      new PostedTask(std::forward<TMethod>(method), std::forward<TArguments>(arguments)...)
+    );
+
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Threading
+
+#endif // defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+
+#endif // NUCLEX_SUPPORT_THREADING_STRAND_H
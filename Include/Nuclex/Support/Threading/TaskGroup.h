@@ -0,0 +1,201 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+#ifndef NUCLEX_SUPPORT_THREADING_TASKGROUP_H
+#define NUCLEX_SUPPORT_THREADING_TASKGROUP_H
+
+#include "Nuclex/Support/Config.h"
+
+// The task group schedules its tasks on the thread pool, which is currently only
+// implemented for Linux and Windows
+#if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+
+#include <exception> // for std::exception_ptr
+#include <memory> // for std::shared_ptr
+#include <tuple> // for std::tuple, std::apply()
+#include <type_traits> // for std::decay
+#include <vector> // for std::vector
+
+namespace Nuclex { namespace Support { namespace Threading {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  class ThreadPool;
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Runs a group of tasks on a thread pool and waits for all of them</summary>
+  /// <remarks>
+  ///   <para>
+  ///     This is for the common fork-join pattern where a piece of work is split into
+  ///     a number of tasks and the caller can only continue once all of them are done:
+  ///   </para>
+  ///   <example>
+  ///     <code>
+  ///       TaskGroup group(myThreadPool);
+  ///       for(std::size_t index = 0; index &lt; meshes.size(); ++index) {
+  ///         group.Run(&amp;optimizeMesh, std::ref(meshes[index]));
+  ///       }
+  ///       group.Wait(); // rethrows the first exception if any of the tasks threw
+  ///     </code>
+  ///   </example>
+  ///   <para>
+  ///     Unlike waiting on the std::futures returned by <see cref="ThreadPool.Schedule" />,
+  ///     waiting on a task group does not just block the calling thread. Tasks of the group
+  ///     that have not been picked up by a worker thread yet are executed by the waiting
+  ///     thread itself. Thus, waiting for a task group from within a thread pool task
+  ///     (even on a thread pool where all worker threads are doing the same) will always
+  ///     make progress rather than starving the thread pool of workers.
+  ///   </para>
+  ///   <para>
+  ///     Tasks can be added to the group from any thread, including from within tasks of
+  ///     the group, for as long as someone is still going to call <see cref="Wait" />.
+  ///     Exceptions thrown by the tasks are collected. <see cref="Wait" /> rethrows
+  ///     the first one, all of them can be obtained via <see cref="GetExceptions" />.
+  ///   </para>
+  ///   <para>
+  ///     If the thread pool is destroyed while tasks of the group are still queued,
+  ///     these tasks are not lost, they will be executed by the thread calling Wait().
+  ///   </para>
+  /// </remarks>
+  class NUCLEX_SUPPORT_TYPE TaskGroup {
+
+    #pragma region class Task
+
+    /// <summary>Base class for the tasks executed by the task group</summary>
+    private: class Task {
+
+      /// <summary>Frees all resources owned by the task</summary>
+      public: virtual ~Task() = default;
+      /// <summary>Executes the task</summary>
+      public: virtual void operator()() = 0;
+
+    };
+
+    #pragma endregion // class Task
+
+    /// <summary>Initializes a new task group running its tasks on a thread pool</summary>
+    /// <param name="threadPool">Thread pool the tasks will be scheduled on</param>
+    public: NUCLEX_SUPPORT_API TaskGroup(ThreadPool &threadPool);
+
+    /// <summary>Waits for all tasks of the group and destroys the group</summary>
+    /// <remarks>
+    ///   Exceptions thrown by the tasks are discarded here, call <see cref="Wait" />
+    ///   before the group is destroyed if you want to know about them.
+    /// </remarks>
+    public: NUCLEX_SUPPORT_API ~TaskGroup();
+
+    /// <summary>Adds a task to the group</summary>
+    /// <typeparam name="TMethod">
+    ///   Type of the method that will be run on a worker thread or the waiting thread
+    /// </typeparam>
+    /// <typeparam name="TArguments">
+    ///   Type of the arguments that will be passed to the method when it is called
+    /// </typeparam>
+    /// <param name="method">Method that will be called</param>
+    /// <param name="arguments">Argument values that will be passed to the method</param>
+    /// <remarks>
+    ///   <para>
+    ///     Like with std::thread, the method and its arguments are copied or moved into
+    ///     the task and the method's return value, if any, is discarded.
+    ///   </para>
+    ///   <para>
+    ///     Once the task is added, this method does not fail. If no helper could be posted
+    ///     to the thread pool, the task simply waits for <see cref="Wait" /> to execute
+    ///     it. If this method throws, the task was not added and will not run.
+    ///   </para>
+    /// </remarks>
+    public: template<typename TMethod, typename... TArguments>
+    inline void Run(TMethod &&method, TArguments &&... arguments);
+
+    /// <summary>Waits until all tasks of the group have completed</summary>
+    /// <remarks>
+    ///   While waiting, the calling thread executes tasks of the group that have not
+    ///   been started yet. If any of the tasks threw an exception, the first exception
+    ///   is rethrown after all tasks have completed.
+    /// </remarks>
+    public: NUCLEX_SUPPORT_API void Wait();
+
+    /// <summary>Retrieves the exceptions the tasks of the group have thrown so far</summary>
+    /// <returns>All exceptions thrown by the tasks, in the order they were caught</returns>
+    public: NUCLEX_SUPPORT_API std::vector<std::exception_ptr> GetExceptions() const;
+
+    private: TaskGroup(const TaskGroup &) = delete;
+    private: TaskGroup &operator =(const TaskGroup &) = delete;
+
+    /// <summary>Hands a task to the group and schedules it on the thread pool</summary>
+    /// <param name="task">Task that will be added, the group takes ownership</param>
+    private: NUCLEX_SUPPORT_API void add(Task *task);
+
+    /// <summary>Structure holding the state shared with the scheduled tasks</summary>
+    private: struct State;
+
+    /// <summary>Thread pool the tasks are scheduled on</summary>
+    private: ThreadPool &threadPool;
+    /// <summary>State shared with the tasks, which may run after the group is gone</summary>
+    private: std::shared_ptr<State> state;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+  template<typename TMethod, typename... TArguments>
+  inline void TaskGroup::Run(TMethod &&method, TArguments &&... arguments) {
+
+    #pragma region struct GroupTask
+
+    /// <summary>Task that carries the method and its arguments</summary>
+    struct GroupTask : public Task {
+
+      /// <summary>Initializes the group task</summary>
+      /// <param name="method">Method that will be called back</param>
+      /// <param name="arguments">Arguments to save until the invocation</param>
+      public: GroupTask(TMethod &&method, TArguments &&... arguments) :
+        Task(),
+        Method(std::forward<TMethod>(method)),
+        Arguments(std::forward<TArguments>(arguments)...) {}
+
+      /// <summary>Frees all resources owned by the task</summary>
+      public: ~GroupTask() override = default;
+
+      /// <summary>Executes the task</summary>
+      public: void operator()() override {
+        std::apply(std::move(this->Method), std::move(this->Arguments));
+      }
+
+      /// <summary>Method that will be called back</summary>
+      public: typename std::decay<TMethod>::type Method;
+      /// <summary>Arguments that will be passed to the method</summary>
+      public: std::tuple<typename std::decay<TArguments>::type...> Arguments;
+
+    };
+
+    #pragma endregion // struct GroupTask
+
+    add(new GroupTask(std::forward<TMethod>(method), std::forward<TArguments>(arguments)...));
+
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Threading
+
+#endif // defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+
+#endif // NUCLEX_SUPPORT_THREADING_TASKGROUP_H
@@ -0,0 +1,458 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+#ifndef NUCLEX_SUPPORT_THREADING_TASKHANDLE_H
+#define NUCLEX_SUPPORT_THREADING_TASKHANDLE_H
+
+#include "Nuclex/Support/Config.h"
+#include "Nuclex/Support/Threading/Gate.h"
+
+#include <cstddef> // for std::size_t
+#include <atomic> // for std::atomic
+#include <exception> // for std::exception_ptr
+#include <initializer_list> // for std::initializer_list
+#include <tuple> // for std::tuple, std::apply()
+#include <type_traits> // for std::decay
+#include <vector> // for std::vector
+#include <chrono> // for std::chrono::microseconds
+
+namespace Nuclex { namespace Support { namespace Threading {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  class ThreadPool;
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Refers to a task in a graph of tasks executed by a thread pool</summary>
+  /// <remarks>
+  ///   <para>
+  ///     Task handles are obtained by calling <see cref="ThreadPool.Spawn" />. Unlike with
+  ///     the std::future returned by <see cref="ThreadPool.Schedule" />, you can attach
+  ///     further tasks to a task handle that will be executed as soon as the task
+  ///     completes, without any thread having to wait for it:
+  ///   </para>
+  ///   <example>
+  ///     <code>
+  ///       TaskHandle load = myThreadPool.Spawn(&amp;loadMesh, u8"tree.mesh");
+  ///       TaskHandle bake = load.Then(&amp;bakeLighting);
+  ///       TaskHandle ready = TaskHandle::WhenAll({ bake, myThreadPool.Spawn(&amp;loadSounds) });
+  ///
+  ///       ready.Wait(); // Only needed if a thread outside of the thread pool needs to wait
+  ///     </code>
+  ///   </example>
+  ///   <para>
+  ///     Tasks in the graph carry no result, pass any data you need via the method's
+  ///     arguments or lambda captures. If a task throws, all tasks depending on it are
+  ///     skipped and complete with the same exception, which can be obtained via
+  ///     <see cref="Get" />. If the thread pool is destroyed before a task could run,
+  ///     it completes with an std::future_error of type broken_promise. If the task could
+  ///     not be handed to the thread pool at all, it completes with the error that caused it.
+  ///   </para>
+  ///   <para>
+  ///     Task handles are cheap to copy (an intrusive reference count is incremented).
+  ///     The task keeps running even if all handles to it are dropped.
+  ///   </para>
+  /// </remarks>
+  class NUCLEX_SUPPORT_TYPE TaskHandle {
+
+    friend class ThreadPool;
+
+    #pragma region class Node
+
+    /// <summary>Node in the task graph, tracking predecessors and successors</summary>
+    private: class Node {
+
+      #pragma region struct Successor
+
+      /// <summary>Entry in the list of successors that need to be notified</summary>
+      public: struct Successor {
+
+        /// <summary>Node that will be notified when its predecessor completes</summary>
+        public: Node *Target;
+        /// <summary>Next entry in the list of successors</summary>
+        public: Successor *Next;
+
+      };
+
+      #pragma endregion // struct Successor
+
+      /// <summary>Initializes a new task graph node</summary>
+      /// <param name="threadPool">Thread pool on which the node's method will run</param>
+      /// <param name="predecessorCount">
+      ///   Number of predecessors that need to complete before the node runs
+      /// </param>
+      /// <param name="completesOnFirst">
+      ///   Whether the node runs when its first predecessor completes rather than
+      ///   when all its predecessors have completed
+      /// </param>
+      /// <param name="hasMethod">Whether the node has a method to execute</param>
+      public: NUCLEX_SUPPORT_API Node(
+        ThreadPool *threadPool,
+        std::size_t predecessorCount,
+        bool completesOnFirst = false,
+        bool hasMethod = false
+      );
+
+      /// <summary>Frees all memory owned by the node</summary>
+      public: NUCLEX_SUPPORT_API virtual ~Node();
+
+      /// <summary>Increments the reference count of the node</summary>
+      public: void AddReference() noexcept {
+        this->referenceCount.fetch_add(1, std::memory_order_relaxed);
+      }
+
+      /// <summary>Decrements the reference count, deleting the node if it reaches zero</summary>
+      public: void Release() noexcept {
+        std::size_t previousCount = this->referenceCount.fetch_sub(
+          1, std::memory_order_acq_rel
+        );
+        if(previousCount == 1) {
+          delete this;
+        }
+      }
+
+      /// <summary>Registers a node that will be notified when this node completes</summary>
+      /// <param name="successor">Node that depends on this node</param>
+      /// <remarks>
+      ///   If this node has already completed, the successor is notified immediately.
+      ///   The first successor is stored inside the node, only further successors
+      ///   require an allocation.
+      /// </remarks>
+      public: NUCLEX_SUPPORT_API void AddSuccessor(Node *successor);
+
+      /// <summary>Called by a predecessor when it has completed</summary>
+      /// <param name="error">Exception the predecessor failed with, if any</param>
+      public: NUCLEX_SUPPORT_API void NotifyPredecessorCompleted(
+        const std::exception_ptr &error
+      );
+
+      /// <summary>Runs the node's method or completes the node if it has none</summary>
+      /// <remarks>
+      ///   Called when all predecessors have completed. If the node has a method and
+      ///   none of its predecessors failed, the method is posted to the thread pool.
+      /// </remarks>
+      public: void Start();
+
+      /// <summary>Executes the node's method. Called on a thread pool thread</summary>
+      public: void Execute() noexcept;
+
+      /// <summary>Completes the node as canceled without executing its method</summary>
+      public: void Cancel() noexcept;
+
+      /// <summary>Checks whether the node has completed</summary>
+      /// <returns>True if the node has completed, false otherwise</returns>
+      public: bool IsCompleted() const noexcept {
+        return this->isCompleted.load(std::memory_order_acquire);
+      }
+
+      /// <summary>Waits for the node to complete</summary>
+      public: void Wait() const {
+        this->completionGate.Wait();
+      }
+
+      /// <summary>Waits for the node to complete or for the patience time to elapse</summary>
+      /// <param name="patience">How long to wait for the node to complete</param>
+      /// <returns>True if the node completed, false if the patience time elapsed</returns>
+      public: bool WaitFor(const std::chrono::microseconds &patience) const {
+        return this->completionGate.WaitFor(patience);
+      }
+
+      /// <summary>Retrieves the exception the node has failed with</summary>
+      /// <returns>The exception the node failed with or an empty pointer</returns>
+      /// <remarks>
+      ///   Only valid after the node has completed.
+      /// </remarks>
+      public: const std::exception_ptr &GetError() const noexcept {
+        return this->error;
+      }
+
+      /// <summary>Thread pool on which the node's method runs</summary>
+      public: ThreadPool *GetThreadPool() const noexcept {
+        return this->threadPool;
+      }
+
+      /// <summary>Executes the method carried by the node</summary>
+      protected: virtual void invoke() {}
+
+      /// <summary>Marks the node as completed and notifies its successors</summary>
+      private: void complete() noexcept;
+
+      /// <summary>Task posted to the thread pool to execute the node</summary>
+      private: struct Execution;
+
+      /// <summary>Marks the list of successors as closed once the node has completed</summary>
+      private: static Successor closedSuccessorList;
+
+      /// <summary>Thread pool on which the node's method will run</summary>
+      private: ThreadPool *threadPool;
+      /// <summary>Number of handles and other nodes referencing this node</summary>
+      private: std::atomic<std::size_t> referenceCount;
+      /// <summary>Number of predecessors that still need to complete</summary>
+      private: std::atomic<std::size_t> pendingPredecessorCount;
+      /// <summary>Whether a predecessor has already reported an error</summary>
+      private: std::atomic<bool> hasFailedPredecessor;
+      /// <summary>Whether the node runs when its first predecessor completes</summary>
+      private: bool completesOnFirst;
+      /// <summary>Whether the node has a method that needs to be executed</summary>
+      private: bool hasMethod;
+      /// <summary>Nodes that will be notified when this node completes</summary>
+      private: std::atomic<Successor *> successors;
+      /// <summary>Whether the embedded successor entry has been used up</summary>
+      private: std::atomic<bool> isFirstSuccessorTaken;
+      /// <summary>Embedded entry for the first successor, saves an allocation</summary>
+      private: Successor firstSuccessor;
+      /// <summary>Exception the node or one of its predecessors has failed with</summary>
+      private: std::exception_ptr error;
+      /// <summary>Whether the node has completed</summary>
+      private: std::atomic<bool> isCompleted;
+      /// <summary>Opened when the node has completed</summary>
+      private: Gate completionGate;
+
+    };
+
+    #pragma endregion // class Node
+
+    #pragma region class MethodNode
+
+    /// <summary>Task graph node that calls a method with the stored arguments</summary>
+    /// <typeparam name="TMethod">Type of method that will be called</typeparam>
+    /// <typeparam name="TArguments">Arguments that will be passed to the method</typeparam>
+    private: template<typename TMethod, typename... TArguments>
+    class MethodNode : public Node {
+
+      /// <summary>Initializes a new method node</summary>
+      /// <param name="threadPool">Thread pool on which the method will run</param>
+      /// <param name="predecessorCount">
+      ///   Number of predecessors that need to complete before the method runs
+      /// </param>
+      /// <param name="method">Method that will be called</param>
+      /// <param name="arguments">Arguments that will be passed to the method</param>
+      public: MethodNode(
+        ThreadPool *threadPool, std::size_t predecessorCount,
+        TMethod &&method, TArguments &&... arguments
+      ) :
+        Node(threadPool, predecessorCount, false, true),
+        method(std::forward<TMethod>(method)),
+        arguments(std::forward<TArguments>(arguments)...) {}
+
+      /// <summary>Frees all resources owned by the method node</summary>
+      public: ~MethodNode() override = default;
+
+      /// <summary>Calls the method with the stored arguments</summary>
+      protected: void invoke() override {
+        std::apply(std::move(this->method), std::move(this->arguments));
+      }
+
+      /// <summary>Method that will be called</summary>
+      private: typename std::decay<TMethod>::type method;
+      /// <summary>Arguments that will be passed to the method</summary>
+      private: std::tuple<typename std::decay<TArguments>::type...> arguments;
+
+    };
+
+    #pragma endregion // class MethodNode
+
+    /// <summary>Creates a task handle that completes when all tasks have completed</summary>
+    /// <param name="tasks">Tasks that need to complete</param>
+    /// <returns>A task handle that completes when all tasks have completed</returns>
+    /// <remarks>
+    ///   If any of the tasks fails, the returned task handle fails with the same
+    ///   exception once all tasks have completed. If no tasks are specified,
+    ///   the returned task handle is completed right away.
+    /// </remarks>
+    public: NUCLEX_SUPPORT_API static TaskHandle WhenAll(const std::vector<TaskHandle> &tasks);
+
+    /// <summary>Creates a task handle that completes when all tasks have completed</summary>
+    /// <param name="tasks">Tasks that need to complete</param>
+    /// <returns>A task handle that completes when all tasks have completed</returns>
+    public: static TaskHandle WhenAll(std::initializer_list<TaskHandle> tasks) {
+      return WhenAll(std::vector<TaskHandle>(tasks));
+    }
+
+    /// <summary>Creates a task handle that completes when any task has completed</summary>
+    /// <param name="tasks">Tasks of which one needs to complete</param>
+    /// <returns>A task handle that completes when the first task has completed</returns>
+    /// <remarks>
+    ///   The returned task handle completes in the same way (success or failure) as
+    ///   the first task that completes. At least one task has to be specified.
+    /// </remarks>
+    public: NUCLEX_SUPPORT_API static TaskHandle WhenAny(const std::vector<TaskHandle> &tasks);
+
+    /// <summary>Creates a task handle that completes when any task has completed</summary>
+    /// <param name="tasks">Tasks of which one needs to complete</param>
+    /// <returns>A task handle that completes when the first task has completed</returns>
+    public: static TaskHandle WhenAny(std::initializer_list<TaskHandle> tasks) {
+      return WhenAny(std::vector<TaskHandle>(tasks));
+    }
+
+    /// <summary>Initializes an empty task handle that refers to no task</summary>
+    /// <remarks>
+    ///   Except for <see cref="IsValid" /> and assignment, all methods throw
+    ///   an std::invalid_argument exception when called on an empty task handle.
+    /// </remarks>
+    public: TaskHandle() noexcept : node(nullptr) {}
+
+    /// <summary>Initializes a task handle referring to the same task as another</summary>
+    /// <param name="other">Task handle whose task will be referenced</param>
+    public: TaskHandle(const TaskHandle &other) noexcept : node(other.node) {
+      if(this->node != nullptr) {
+        this->node->AddReference();
+      }
+    }
+
+    /// <summary>Takes over the task referenced by another task handle</summary>
+    /// <param name="other">Task handle whose task will be taken over</param>
+    public: TaskHandle(TaskHandle &&other) noexcept : node(other.node) {
+      other.node = nullptr;
+    }
+
+    /// <summary>Drops the reference to the task</summary>
+    public: ~TaskHandle() {
+      if(this->node != nullptr) {
+        this->node->Release();
+      }
+    }
+
+    /// <summary>Checks whether the task handle refers to a task</summary>
+    /// <returns>True if the task handle refers to a task, false if it is empty</returns>
+    public: bool IsValid() const noexcept {
+      return (this->node != nullptr);
+    }
+
+    /// <summary>Checks whether the task has completed</summary>
+    /// <returns>True if the task has completed (successfully or not)</returns>
+    public: bool IsCompleted() const {
+      requireNode();
+      return this->node->IsCompleted();
+    }
+
+    /// <summary>Waits for the task to complete</summary>
+    /// <remarks>
+    ///   This blocks the calling thread. Do not use it from within a task running
+    ///   on the thread pool, attach a continuation via <see cref="Then" /> instead.
+    /// </remarks>
+    public: void Wait() const {
+      requireNode();
+      this->node->Wait();
+    }
+
+    /// <summary>Waits for the task to complete or for the patience time to elapse</summary>
+    /// <param name="patience">How long to wait for the task to complete</param>
+    /// <returns>True if the task completed, false if the patience time elapsed</returns>
+    public: bool WaitFor(const std::chrono::microseconds &patience) const {
+      requireNode();
+      return this->node->WaitFor(patience);
+    }
+
+    /// <summary>Waits for the task to complete and rethrows its exception, if any</summary>
+    public: NUCLEX_SUPPORT_API void Get() const;
+
+    /// <summary>Schedules a method to run after the task has completed</summary>
+    /// <typeparam name="TMethod">Type of the method that will be called</typeparam>
+    /// <typeparam name="TArguments">
+    ///   Type of the arguments that will be passed to the method
+    /// </typeparam>
+    /// <param name="method">Method that will be called</param>
+    /// <param name="arguments">Arguments that will be passed to the method</param>
+    /// <returns>A task handle for the continuation</returns>
+    /// <remarks>
+    ///   The continuation runs on the same thread pool as this task. If this task fails,
+    ///   the continuation is not run and completes with the same exception.
+    /// </remarks>
+    public: template<typename TMethod, typename... TArguments>
+    TaskHandle Then(TMethod &&method, TArguments &&... arguments) const;
+
+    /// <summary>Makes this handle refer to the same task as another handle</summary>
+    /// <param name="other">Task handle whose task will be referenced</param>
+    /// <returns>This task handle</returns>
+    public: TaskHandle &operator =(const TaskHandle &other) noexcept {
+      if(other.node != nullptr) {
+        other.node->AddReference();
+      }
+      if(this->node != nullptr) {
+        this->node->Release();
+      }
+      this->node = other.node;
+      return *this;
+    }
+
+    /// <summary>Takes over the task referenced by another task handle</summary>
+    /// <param name="other">Task handle whose task will be taken over</param>
+    /// <returns>This task handle</returns>
+    public: TaskHandle &operator =(TaskHandle &&other) noexcept {
+      if(this != &other) {
+        if(this->node != nullptr) {
+          this->node->Release();
+        }
+        this->node = other.node;
+        other.node = nullptr;
+      }
+      return *this;
+    }
+
+    /// <summary>Initializes a task handle taking over the reference to a node</summary>
+    /// <param name="node">Node the task handle will refer to</param>
+    private: explicit TaskHandle(Node *node) noexcept : node(node) {}
+
+    /// <summary>Throws an exception if the task handle does not refer to a task</summary>
+    private: void requireNode() const {
+      if(unlikely(this->node == nullptr)) {
+        throwEmptyHandleError();
+      }
+    }
+
+    /// <summary>Throws the exception reported for empty task handles</summary>
+    private: [[noreturn]] NUCLEX_SUPPORT_API static void throwEmptyHandleError();
+
+    /// <summary>
+    ///   Adds a freshly created node to the graph, either starting it right away or
+    ///   registering it as a successor of the specified predecessors
+    /// </summary>
+    /// <param name="node">Node that will be added to the graph</param>
+    /// <param name="predecessors">Tasks the node depends on, can be empty</param>
+    /// <param name="predecessorCount">Number of tasks the node depends on</param>
+    /// <returns>A task handle referring to the node</returns>
+    private: NUCLEX_SUPPORT_API static TaskHandle attach(
+      Node *node, const TaskHandle *predecessors, std::size_t predecessorCount
+    );
+
+    /// <summary>Task graph node this handle refers to</summary>
+    private: Node *node;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+  template<typename TMethod, typename... TArguments>
+  TaskHandle TaskHandle::Then(TMethod &&method, TArguments &&... arguments) const {
+    requireNode();
+
+    Node *continuation = new MethodNode<TMethod, TArguments...>(
+      this->node->GetThreadPool(), 1,
+      std::forward<TMethod>(method), std::forward<TArguments>(arguments)...
+    );
+    return attach(continuation, this, 1);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Threading
+
+#endif // NUCLEX_SUPPORT_THREADING_TASKHANDLE_H
@@ -21,6 +21,7 @@ limitations under the License.
 #define NUCLEX_SUPPORT_THREADING_THREAD_H
 
 #include "Nuclex/Support/Config.h"
+#include "Nuclex/Support/Threading/CpuSet.h"
 
 #include <cstddef> // for std::size_t
 #include <cstdint> // for for std::uintptr_t
@@ -34,11 +35,16 @@ namespace Nuclex { namespace Support { namespace Threading {
   /// <summary>Provides supporting methods for threads</summary>
   /// <remarks>
   ///   <para>
-  ///     The thread affinity methods provided by this class are limited to 64 CPUs and
-  ///     do not provide any methods for querying NUMA nodes (i.e. systems where CPUs are
-  ///     provided by two or more physical chips). For situations where extreme thread
-  ///     utilization is needed (i.e. AI, raytracing, containers shared among large numbers
-  ///     of threads), please use pthreads, libnuma or a portable wrapper.
+  ///     The thread affinity methods taking a bit mask are limited to 64 CPUs. On systems
+  ///     with more CPUs, use the overloads taking a <see cref="CpuSet" /> instead, which
+  ///     can address any number of CPUs. To find out which CPUs belong to which NUMA node
+  ///     (i.e. on systems where CPUs are provided by two or more physical chips), see
+  ///     the <see cref="CpuTopology" /> class.
+  ///   </para>
+  ///   <para>
+  ///     On Windows, a thread can only be assigned to CPUs within a single processor
+  ///     group (a group of up to 64 CPUs), so a CPU set spanning multiple processor groups
+  ///     cannot be applied to a thread.
   ///   </para>
   /// </remarks>
   class NUCLEX_SUPPORT_TYPE Thread {
@@ -157,6 +163,44 @@ namespace Nuclex { namespace Support { namespace Threading {
     /// </remarks>
     public: NUCLEX_SUPPORT_API static void SetCpuAffinityMask(std::uint64_t affinityMask);
 
+    /// <summary>Checks which CPUs a thread is allowed to run on</summary>
+    /// <param name="threadId">Thread whose CPU affinity will be retrieved</param>
+    /// <returns>The set of CPUs the thread is allowed to run on</returns>
+    /// <remarks>
+    ///   Unlike <see cref="GetCpuAffinityMask" />, this is not limited to the first
+    ///   64 CPUs in the system.
+    /// </remarks>
+    public: NUCLEX_SUPPORT_API static CpuSet GetCpuAffinity(std::uintptr_t threadId);
+
+    /// <summary>Checks which CPUs the calling thread is allowed to run on</summary>
+    /// <returns>The set of CPUs the calling thread is allowed to run on</returns>
+    /// <remarks>
+    ///   Unlike <see cref="GetCpuAffinityMask" />, this is not limited to the first
+    ///   64 CPUs in the system.
+    /// </remarks>
+    public: NUCLEX_SUPPORT_API static CpuSet GetCpuAffinity();
+
+    /// <summary>Selects the CPUs on which a thread is allowed to run</summary>
+    /// <param name="threadId">ID of the thread whose CPU affinity will be changed</param>
+    /// <param name="cpus">Set of CPUs the thread can run on</param>
+    /// <remarks>
+    ///   See <see cref="SetCpuAffinityMask" /> for a short description of why you may
+    ///   or may not want to adjust CPU affinity for a thread. An empty CPU set results
+    ///   in an std::invalid_argument exception.
+    /// </remarks>
+    public: NUCLEX_SUPPORT_API static void SetCpuAffinity(
+      std::uintptr_t threadId, const CpuSet &cpus
+    );
+
+    /// <summary>Selects the CPUs on which the calling thread is allowed to run</summary>
+    /// <param name="cpus">Set of CPUs the calling thread can run on</param>
+    /// <remarks>
+    ///   See <see cref="SetCpuAffinityMask" /> for a short description of why you may
+    ///   or may not want to adjust CPU affinity for a thread. An empty CPU set results
+    ///   in an std::invalid_argument exception.
+    /// </remarks>
+    public: NUCLEX_SUPPORT_API static void SetCpuAffinity(const CpuSet &cpus);
+
     private: Thread(const Thread &) = delete;
     private: Thread&operator =(const Thread &) = delete;
 
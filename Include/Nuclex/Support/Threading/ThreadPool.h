@@ -28,14 +28,31 @@ limitations under the License.
 // remove this check and give it a try if your system is Posix but not Linux...
 #if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
 
+#include "Nuclex/Support/Threading/Latch.h" // for Latch
+#include "Nuclex/Support/Threading/StopToken.h" // for StopToken
+#include "Nuclex/Support/Threading/TaskHandle.h" // for TaskHandle
+
 #include <cstddef> // for std::size_t
+#include <cstdint> // for std::uint64_t
+#include <array> // for std::array
+#include <chrono> // for std::chrono::microseconds
 #include <future> // for std::packaged_task, std::future
 #include <functional> // for std::bind
+#include <tuple> // for std::tuple, std::apply()
+#include <type_traits> // for std::decay
+#include <atomic> // for std::atomic
+#include <memory> // for std::shared_ptr
+#include <exception> // for std::exception_ptr
+#include <algorithm> // for std::min(), std::max()
 
 namespace Nuclex { namespace Support { namespace Threading {
 
   // ------------------------------------------------------------------------------------------- //
 
+  class ThreadPoolTimerQueue;
+
+  // ------------------------------------------------------------------------------------------- //
+
   /// <summary>Distributes tasks to several threads</summary>
   /// <remarks>
   ///   <para>
@@ -79,6 +96,184 @@ namespace Nuclex { namespace Support { namespace Threading {
   /// </remarks>
   class NUCLEX_SUPPORT_TYPE ThreadPool {
 
+    /// <summary>Runs the timer thread that starts delayed and periodic tasks</summary>
+    friend class ThreadPoolTimerQueue;
+
+    #pragma region enum class Priority
+
+    /// <summary>Priority lanes into which tasks can be scheduled</summary>
+    /// <remarks>
+    ///   <para>
+    ///     Each priority has its own queue. Worker threads take tasks from the higher
+    ///     priority lanes first, so latency-critical tasks do not have to wait behind
+    ///     a backlog of background work.
+    ///   </para>
+    ///   <para>
+    ///     To prevent lower priority tasks from starving when the higher lanes are
+    ///     saturated, every few tasks the worker threads look at the lanes in reverse
+    ///     order. Background work thus still progresses, just at a reduced rate.
+    ///   </para>
+    ///   <para>
+    ///     The implementation based on the Windows thread pool API maps the priorities to
+    ///     the thread pool's callback priorities (high, normal and low). Lower priority
+    ///     tasks are then only protected from starvation as far as the Windows thread pool
+    ///     itself does so. Windows versions without callback priorities ignore them.
+    ///   </para>
+    /// </remarks>
+    public: enum class Priority {
+
+      /// <summary>Latency-critical tasks that should run as soon as possible</summary>
+      High = 0,
+      /// <summary>Regular tasks, used when no priority is specified</summary>
+      Normal = 1,
+      /// <summary>Background tasks that can wait until there's nothing else to do</summary>
+      Low = 2
+
+    };
+
+    #pragma endregion // enum class Priority
+
+    #pragma region enum class NumaMode
+
+    /// <summary>How the thread pool deals with NUMA nodes</summary>
+    /// <remarks>
+    ///   <para>
+    ///     On systems with more than one CPU socket, each socket usually forms a NUMA node
+    ///     with its own memory. Accessing memory that belongs to another NUMA node is slower,
+    ///     so tasks working on the same data should preferrably run within the same node.
+    ///   </para>
+    ///   <para>
+    ///     The implementation based on the Windows thread pool API ignores this setting.
+    ///   </para>
+    /// </remarks>
+    public: enum class NumaMode {
+
+      /// <summary>Worker threads can run on any CPU, the scheduler decides</summary>
+      Ignored = 0,
+      /// <summary>Worker threads are pinned to the CPUs of one NUMA node each</summary>
+      /// <remarks>
+      ///   Worker threads are distributed round-robin over the NUMA nodes. Tasks scheduled
+      ///   from outside of the thread pool are queued for the NUMA node the scheduling
+      ///   thread is running on and idle workers steal from workers of their own NUMA
+      ///   node before they try workers of other nodes.
+      /// </remarks>
+      PinnedPerNode = 1
+
+    };
+
+    #pragma endregion // enum class NumaMode
+
+    #pragma region struct SizingOptions
+
+    /// <summary>Thresholds that control how the thread pool grows and shrinks</summary>
+    /// <remarks>
+    ///   <para>
+    ///     Between the minimum and maximum thread count, the thread pool adjusts its number
+    ///     of threads to the load. Every sample interval (if there is work queued), it looks
+    ///     at how many tasks are waiting, how quickly tasks are being completed and how many
+    ///     worker threads are stuck in a task. From this it decides whether to add threads.
+    ///   </para>
+    ///   <para>
+    ///     If the queued tasks would have to wait longer than the queue delay threshold or
+    ///     worker threads are blocked, threads are added quickly (the thread count can double
+    ///     with each sample). Otherwise, under a steady load, threads are added or removed
+    ///     one at a time, keeping a change only if it improved throughput (hill climbing).
+    ///   </para>
+    ///   <para>
+    ///     Idle threads exit once they had nothing to do for the idle shut down delay, but
+    ///     only one thread per sample interval and never shortly after the thread pool grew,
+    ///     so that a burst of work does not lead to threads being created and destroyed
+    ///     over and over.
+    ///   </para>
+    ///   <para>
+    ///     The implementation based on the Windows thread pool API ignores these settings.
+    ///   </para>
+    /// </remarks>
+    public: struct SizingOptions {
+
+      /// <summary>How often the thread pool re-evaluates its number of threads</summary>
+      public: std::chrono::microseconds SampleInterval = std::chrono::microseconds(10000);
+      /// <summary>Estimated wait time of queued tasks above which threads are added</summary>
+      public: std::chrono::microseconds QueueDelayThreshold = std::chrono::microseconds(1000);
+      /// <summary>Time after which a worker stuck in the same task counts as blocked</summary>
+      /// <remarks>
+      ///   Each blocked worker thread (waiting on I/O or a mutex, for example) is compensated
+      ///   with an additional thread while there are tasks waiting in the queue.
+      /// </remarks>
+      public: std::chrono::microseconds BlockedWorkerThreshold = (
+        std::chrono::microseconds(100000)
+      );
+      /// <summary>How long a worker has to be idle before it may exit</summary>
+      public: std::chrono::microseconds IdleShutDownDelay = std::chrono::microseconds(500000);
+      /// <summary>Relative change in throughput the hill climbing treats as significant</summary>
+      /// <remarks>
+      ///   When the thread pool tries running one more (or one less) thread, it only keeps
+      ///   going in that direction if throughput improved by at least this fraction.
+      /// </remarks>
+      public: float ThroughputGainThreshold = 0.05f;
+
+    };
+
+    #pragma endregion // struct SizingOptions
+
+    #pragma region struct Statistics
+
+    /// <summary>Snapshot of the thread pool's counters</summary>
+    /// <remarks>
+    ///   <para>
+    ///     The worker threads only update counters of their own, so keeping the statistics
+    ///     costs next to nothing. Taking a snapshot adds up the counters of all worker
+    ///     threads, so the numbers are not an atomic snapshot, but each one is accurate.
+    ///   </para>
+    ///   <para>
+    ///     Both histograms count tasks by their duration in microseconds on a log2 scale:
+    ///     bucket 0 holds tasks below 1 microsecond, bucket <c>n</c> holds tasks taking
+    ///     from 2^(n-1) up to 2^n microseconds and the last bucket also holds everything
+    ///     longer than that. To avoid querying the clock for each and every task, only one
+    ///     in a few tasks is timed (see ThreadPoolConfig::TimingSampleInterval), so the
+    ///     histograms show the distribution rather than the number of tasks.
+    ///   </para>
+    ///   <para>
+    ///     The implementation based on the Windows thread pool API only provides
+    ///     the number of task memory allocations.
+    ///   </para>
+    /// </remarks>
+    public: struct Statistics {
+
+      /// <summary>Number of buckets in the duration histograms</summary>
+      public: static const constexpr std::size_t HistogramBucketCount = 24;
+
+      /// <summary>Number of tasks waiting for a worker thread</summary>
+      public: std::size_t QueuedTaskCount;
+      /// <summary>Number of tasks currently being executed</summary>
+      public: std::size_t RunningTaskCount;
+      /// <summary>Number of worker threads currently alive</summary>
+      public: std::size_t ThreadCount;
+      /// <summary>Number of worker threads currently sleeping for lack of work</summary>
+      public: std::size_t IdleThreadCount;
+      /// <summary>Total number of tasks executed since the thread pool was created</summary>
+      public: std::size_t CompletedTaskCount;
+      /// <summary>Number of tasks worker threads stole from other worker threads</summary>
+      public: std::size_t StolenTaskCount;
+      /// <summary>Number of tasks dropped without running due to cancellation</summary>
+      /// <remarks>
+      ///   Includes tasks whose stop token was canceled and tasks that were still queued
+      ///   when the thread pool was shut down.
+      /// </remarks>
+      public: std::size_t CanceledTaskCount;
+      /// <summary>Number of tasks that could reuse the memory of an earlier task</summary>
+      public: std::size_t TaskMemoryReuseCount;
+      /// <summary>Number of tasks for which new memory had to be allocated</summary>
+      public: std::size_t TaskMemoryAllocationCount;
+      /// <summary>How long the timed tasks waited in the queue before they were run</summary>
+      public: std::array<std::size_t, HistogramBucketCount> QueueWaitHistogram;
+      /// <summary>How long the timed tasks took to execute</summary>
+      public: std::array<std::size_t, HistogramBucketCount> ExecutionTimeHistogram;
+
+    };
+
+    #pragma endregion // struct Statistics
+
     #pragma region class Task
 
     /// <summary>Base class for tasks that get executed by the thread pool</summary>
@@ -92,10 +287,124 @@ namespace Nuclex { namespace Support { namespace Threading {
       /// <summary>Executes the task. Is called on the thread pool thread</summary>
       public: virtual void operator()() = 0;
 
+      /// <summary>Stop token through which the task can be canceled, may be empty</summary>
+      /// <remarks>
+      ///   Checked when a worker thread takes the task from the queue. If the token has
+      ///   been canceled by then, the task is destroyed without ever being executed.
+      /// </remarks>
+      public: std::shared_ptr<const StopToken> CancellationToken;
+
     };
 
     #pragma endregion // class Task
 
+    #pragma region class TimerTask
+
+    /// <summary>Base class for delayed and periodic tasks</summary>
+    /// <remarks>
+    ///   Only used internally. Apart from the callback, the members are bookkeeping
+    ///   owned by the timer thread, which links the task into its timing wheel.
+    /// </remarks>
+    private: class TimerTask {
+
+      /// <summary>State of a timer that is waiting to become due</summary>
+      public: static const constexpr int Pending = 0;
+      /// <summary>State of a timer that has been canceled by the user</summary>
+      public: static const constexpr int Canceled = 1;
+      /// <summary>State of a timer that fired or was discarded by the thread pool</summary>
+      public: static const constexpr int Finished = 2;
+
+      /// <summary>Initializes a new timer task</summary>
+      public: TimerTask() :
+        Previous(nullptr),
+        Next(nullptr),
+        DueTick(0),
+        SlotIndex(std::size_t(-1)),
+        IntervalTicks(0),
+        Owner(nullptr),
+        State(Pending),
+        IsQueued(false),
+        SelfReference() {}
+
+      /// <summary>Terminates the timer task</summary>
+      public: virtual ~TimerTask() = default;
+      /// <summary>Executes the task. Is called on a thread pool thread</summary>
+      public: virtual void operator()() noexcept = 0;
+
+      /// <summary>Previous timer in the same slot of the timing wheel</summary>
+      public: TimerTask *Previous;
+      /// <summary>Next timer in the same slot of the timing wheel</summary>
+      public: TimerTask *Next;
+      /// <summary>Tick of the timer thread's clock at which the task is due</summary>
+      public: std::uint64_t DueTick;
+      /// <summary>Index of the timing wheel slot the timer is linked into</summary>
+      public: std::size_t SlotIndex;
+      /// <summary>Ticks between executions for periodic tasks, 0 for one-shot tasks</summary>
+      public: std::uint64_t IntervalTicks;
+      /// <summary>Thread pool the task was scheduled on</summary>
+      public: ThreadPool *Owner;
+      /// <summary>Whether the timer is pending, canceled or finished</summary>
+      public: std::atomic<int> State;
+      /// <summary>Whether an execution of the periodic task is waiting or running</summary>
+      public: std::atomic<bool> IsQueued;
+      /// <summary>Keeps the task alive while it is linked into the timing wheel</summary>
+      public: std::shared_ptr<TimerTask> SelfReference;
+
+    };
+
+    #pragma endregion // class TimerTask
+
+    #pragma region class Timer
+
+    /// <summary>Handle through which a delayed or periodic task can be canceled</summary>
+    /// <remarks>
+    ///   Dropping the handle does not cancel the task. The handle can safely outlive
+    ///   the thread pool, a thread pool being destroyed discards all of its timers.
+    /// </remarks>
+    public: class Timer {
+
+      /// <summary>Initializes an empty timer handle</summary>
+      public: Timer() = default;
+
+      /// <summary>Initializes a timer handle for the specified task</summary>
+      /// <param name="task">Delayed or periodic task the handle refers to</param>
+      public: explicit Timer(const std::shared_ptr<TimerTask> &task) : task(task) {}
+
+      /// <summary>Checks whether the timer is still waiting to run</summary>
+      /// <returns>
+      ///   True for a delayed task that has not become due and for a periodic task
+      ///   that has not been canceled, false otherwise
+      /// </returns>
+      public: bool IsPending() const {
+        return (
+          static_cast<bool>(this->task) &&
+          (this->task->State.load(std::memory_order_acquire) == TimerTask::Pending)
+        );
+      }
+
+      /// <summary>Cancels the timer</summary>
+      /// <returns>
+      ///   True if the timer was canceled, false if it had already fired, had already
+      ///   been canceled or the handle is empty
+      /// </returns>
+      /// <remarks>
+      ///   A periodic task will not run again after this returns, unless an execution
+      ///   had already started. Canceling takes constant time.
+      /// </remarks>
+      public: bool Cancel() {
+        if(!static_cast<bool>(this->task)) {
+          return false;
+        }
+        return ThreadPool::cancelTimer(*this->task);
+      }
+
+      /// <summary>Delayed or periodic task the handle refers to</summary>
+      private: std::shared_ptr<TimerTask> task;
+
+    };
+
+    #pragma endregion // class Timer
+
     /// <summary>Determines a good base number of threads to keep active</summary>
     /// <returns>The default minimum number of threads for new thread pools</returns>
     public: NUCLEX_SUPPORT_API static std::size_t GetDefaultMinimumThreadCount();
@@ -113,9 +422,13 @@ namespace Nuclex { namespace Support { namespace Threading {
     /// <param name="maximumThreadCount">
     ///   Highest number of threads to which the thread pool can grow under load
     /// </param>
+    /// <param name="numaMode">
+    ///   Whether to pin worker threads to NUMA nodes and keep tasks within their node
+    /// </param>
     public: NUCLEX_SUPPORT_API ThreadPool(
       std::size_t minimumThreadCount = GetDefaultMinimumThreadCount(),
-      std::size_t maximumThreadCount = GetDefaultMaximumThreadCount()
+      std::size_t maximumThreadCount = GetDefaultMaximumThreadCount(),
+      NumaMode numaMode = NumaMode::Ignored
     );
 
     /// <summary>Stops all threads and frees all resources used</summary>
@@ -123,6 +436,24 @@ namespace Nuclex { namespace Support { namespace Threading {
 
     // ----------------------------------------------------------------------------------------- //
 
+    /// <summary>Retrieves the thresholds that control how the thread pool is sized</summary>
+    /// <returns>The thresholds currently used to grow and shrink the thread pool</returns>
+    public: NUCLEX_SUPPORT_API SizingOptions GetSizingOptions() const;
+
+    /// <summary>Changes the thresholds that control how the thread pool is sized</summary>
+    /// <param name="options">New thresholds the thread pool will use</param>
+    /// <remarks>
+    ///   This can be called at any time, even while tasks are running. The new thresholds
+    ///   take effect with the next sample the thread pool takes.
+    /// </remarks>
+    public: NUCLEX_SUPPORT_API void SetSizingOptions(const SizingOptions &options);
+
+    /// <summary>Takes a snapshot of the thread pool's counters</summary>
+    /// <returns>The current values of the thread pool's counters</returns>
+    public: NUCLEX_SUPPORT_API Statistics GetStatistics() const;
+
+    // ----------------------------------------------------------------------------------------- //
+
     /// <summary>Schedules a task to be executed on a worker thread</summary>
     /// <typeparam name="TMethod">
     ///   Type of the method that will be run on a worker thread
@@ -176,6 +507,333 @@ namespace Nuclex { namespace Support { namespace Threading {
     inline std::future<typename std::invoke_result<TMethod, TArguments...>::type>
     Schedule(TMethod &&method, TArguments &&... arguments);
 
+    /// <summary>Posts a task to be executed on a worker thread without a result</summary>
+    /// <typeparam name="TMethod">
+    ///   Type of the method that will be run on a worker thread
+    /// </typeparam>
+    /// <typeparam name="TArguments">
+    ///   Type of the arguments that will be passed to the method when it is called
+    /// </typeparam>
+    /// <param name="method">Method that will be called from a worker thread</param>
+    /// <param name="arguments">Argument values that will be passed to the method</param>
+    /// <remarks>
+    ///   <para>
+    ///     This is the fire-and-forget variant of <see cref="Schedule" />. The method and
+    ///     its arguments are stored directly in the thread pool's recycled task memory,
+    ///     there is no std::packaged_task and no shared state for an std::future, so
+    ///     posting a task that fits into the recycled task memory does not allocate.
+    ///   </para>
+    ///   <para>
+    ///     Like with std::thread, the method and its arguments are copied or moved into
+    ///     the task and the method's return value, if any, is discarded. If the thread
+    ///     pool is destroyed before starting on the task, the task is simply destroyed
+    ///     without ever being called.
+    ///   </para>
+    ///   <para>
+    ///     Also like with std::thread, there is nobody to hand an exception to, so
+    ///     the method must not throw. An exception escaping from it will end up
+    ///     calling std::terminate().
+    ///   </para>
+    /// </remarks>
+    public: template<typename TMethod, typename... TArguments>
+    inline void Post(TMethod &&method, TArguments &&... arguments);
+
+    /// <summary>Schedules a task with the specified priority</summary>
+    /// <typeparam name="TMethod">
+    ///   Type of the method that will be run on a worker thread
+    /// </typeparam>
+    /// <typeparam name="TArguments">
+    ///   Type of the arguments that will be passed to the method when it is called
+    /// </typeparam>
+    /// <param name="priority">Priority lane the task will be scheduled in</param>
+    /// <param name="method">Method that will be called from a worker thread</param>
+    /// <param name="arguments">Argument values that will be passed to the method</param>
+    /// <returns>
+    ///   An std::future instance that will provide the result returned by the method
+    /// </returns>
+    /// <remarks>
+    ///   Behaves exactly like <see cref="Schedule" /> otherwise.
+    /// </remarks>
+    public: template<typename TMethod, typename... TArguments>
+    inline std::future<typename std::invoke_result<TMethod, TArguments...>::type>
+    ScheduleWithPriority(Priority priority, TMethod &&method, TArguments &&... arguments);
+
+    /// <summary>Posts a task with the specified priority without a result</summary>
+    /// <typeparam name="TMethod">
+    ///   Type of the method that will be run on a worker thread
+    /// </typeparam>
+    /// <typeparam name="TArguments">
+    ///   Type of the arguments that will be passed to the method when it is called
+    /// </typeparam>
+    /// <param name="priority">Priority lane the task will be posted to</param>
+    /// <param name="method">Method that will be called from a worker thread</param>
+    /// <param name="arguments">Argument values that will be passed to the method</param>
+    /// <remarks>
+    ///   Behaves exactly like <see cref="Post" /> otherwise.
+    /// </remarks>
+    public: template<typename TMethod, typename... TArguments>
+    inline void PostWithPriority(
+      Priority priority, TMethod &&method, TArguments &&... arguments
+    );
+
+    /// <summary>Schedules a task that is dropped if canceled before it starts</summary>
+    /// <typeparam name="TMethod">
+    ///   Type of the method that will be run on a worker thread
+    /// </typeparam>
+    /// <typeparam name="TArguments">
+    ///   Type of the arguments that will be passed to the method when it is called
+    /// </typeparam>
+    /// <param name="stopToken">Stop token through which the task can be canceled</param>
+    /// <param name="method">Method that will be called from a worker thread</param>
+    /// <param name="arguments">Argument values that will be passed to the method</param>
+    /// <returns>
+    ///   An std::future instance that will provide the result returned by the method
+    /// </returns>
+    /// <remarks>
+    ///   <para>
+    ///     The stop token is checked when a worker thread takes the task from the queue.
+    ///     If cancellation has been requested by then, the task is destroyed without
+    ///     being executed and the returned future completes with an std::future_error of
+    ///     type broken_promise, just like for tasks that were still queued when the thread
+    ///     pool was destroyed.
+    ///   </para>
+    ///   <para>
+    ///     Once the method has started, the thread pool does not interfere anymore. If
+    ///     the method runs for a long time, it can check the stop token by itself.
+    ///   </para>
+    /// </remarks>
+    public: template<typename TMethod, typename... TArguments>
+    inline std::future<typename std::invoke_result<TMethod, TArguments...>::type>
+    ScheduleWithStopToken(
+      const std::shared_ptr<const StopToken> &stopToken,
+      TMethod &&method, TArguments &&... arguments
+    );
+
+    /// <summary>Posts a task that is dropped if canceled before it starts</summary>
+    /// <typeparam name="TMethod">
+    ///   Type of the method that will be run on a worker thread
+    /// </typeparam>
+    /// <typeparam name="TArguments">
+    ///   Type of the arguments that will be passed to the method when it is called
+    /// </typeparam>
+    /// <param name="stopToken">Stop token through which the task can be canceled</param>
+    /// <param name="method">Method that will be called from a worker thread</param>
+    /// <param name="arguments">Argument values that will be passed to the method</param>
+    /// <remarks>
+    ///   Behaves like <see cref="Post" />, but if cancellation has been requested through
+    ///   the stop token by the time a worker thread takes the task from the queue,
+    ///   the task is destroyed without being executed.
+    /// </remarks>
+    public: template<typename TMethod, typename... TArguments>
+    inline void PostWithStopToken(
+      const std::shared_ptr<const StopToken> &stopToken,
+      TMethod &&method, TArguments &&... arguments
+    );
+
+    /// <summary>Posts a task that will be executed after the specified delay</summary>
+    /// <typeparam name="TMethod">
+    ///   Type of the method that will be run on a worker thread
+    /// </typeparam>
+    /// <typeparam name="TArguments">
+    ///   Type of the arguments that will be passed to the method when it is called
+    /// </typeparam>
+    /// <param name="delay">Time that will pass before the task is posted</param>
+    /// <param name="method">Method that will be called from a worker thread</param>
+    /// <param name="arguments">Argument values that will be passed to the method</param>
+    /// <returns>A handle through which the task can be canceled</returns>
+    /// <remarks>
+    ///   <para>
+    ///     Instead of occupying a thread that sleeps until the delay has passed, the task is
+    ///     put into a timing wheel watched by a single timer thread (started when the first
+    ///     timer is scheduled). Scheduling and canceling take constant time, so keeping
+    ///     huge numbers of timeouts around is cheap.
+    ///   </para>
+    ///   <para>
+    ///     The timer thread has a resolution of one millisecond. A task is never posted
+    ///     before its delay has passed, but once due, it competes with all other tasks for
+    ///     the worker threads. Like with <see cref="Post" />, the method must not throw and
+    ///     tasks still pending when the thread pool is destroyed never run.
+    ///   </para>
+    /// </remarks>
+    public: template<typename TMethod, typename... TArguments>
+    inline Timer ScheduleAfter(
+      std::chrono::microseconds delay, TMethod &&method, TArguments &&... arguments
+    );
+
+    /// <summary>Posts a task repeatedly at the specified interval</summary>
+    /// <typeparam name="TMethod">
+    ///   Type of the method that will be run on a worker thread
+    /// </typeparam>
+    /// <typeparam name="TArguments">
+    ///   Type of the arguments that will be passed to the method when it is called
+    /// </typeparam>
+    /// <param name="interval">Time between executions of the task</param>
+    /// <param name="method">Method that will be called from a worker thread</param>
+    /// <param name="arguments">Argument values that will be passed to the method</param>
+    /// <returns>A handle through which the task can be canceled</returns>
+    /// <remarks>
+    ///   <para>
+    ///     The first execution happens one interval after this call. The task keeps being
+    ///     executed until it is canceled through the returned handle or the thread pool is
+    ///     destroyed. The method and its arguments are kept for all executions, so
+    ///     the arguments are passed to the method as lvalues.
+    ///   </para>
+    ///   <para>
+    ///     Executions never overlap. If the task is still waiting or running when its next
+    ///     execution becomes due, that execution is skipped. Otherwise, this behaves
+    ///     like <see cref="ScheduleAfter" />.
+    ///   </para>
+    /// </remarks>
+    public: template<typename TMethod, typename... TArguments>
+    inline Timer ScheduleEvery(
+      std::chrono::microseconds interval, TMethod &&method, TArguments &&... arguments
+    );
+
+    /// <summary>Posts a batch of tasks to be executed on worker threads</summary>
+    /// <typeparam name="TMethod">
+    ///   Type of the method that will be run on the worker threads
+    /// </typeparam>
+    /// <param name="count">Number of tasks that will be posted</param>
+    /// <param name="method">
+    ///   Method that will be called once for each task with the task's index
+    /// </param>
+    /// <remarks>
+    ///   <para>
+    ///     This behaves like calling <see cref="Post" /> in a loop with the loop index as
+    ///     the argument, but the tasks are handed to the thread pool in batches, each
+    ///     requiring only one queue operation and one wake-up of the worker threads.
+    ///   </para>
+    ///   <para>
+    ///     The method is stored only once and shared by all tasks, so it will be called
+    ///     from multiple threads at the same time. It must not throw, an exception escaping
+    ///     from it will end up calling std::terminate().
+    ///   </para>
+    /// </remarks>
+    public: template<typename TMethod>
+    inline void PostBulk(std::size_t count, TMethod &&method);
+
+    /// <summary>Processes a range of indices in parallel on the thread pool</summary>
+    /// <typeparam name="TMethod">
+    ///   Type of the method that will process the chunks of the range
+    /// </typeparam>
+    /// <param name="begin">Index at which processing will begin</param>
+    /// <param name="end">Index one past the last index that will be processed</param>
+    /// <param name="grainSize">
+    ///   Smallest number of indices that will be handed to the method in one call
+    /// </param>
+    /// <param name="method">
+    ///   Method that will be called with the beginning and end of each chunk
+    /// </param>
+    /// <remarks>
+    ///   <para>
+    ///     The range is handed out in chunks, starting with large chunks and shrinking
+    ///     them down to the grain size as the range is used up, so that all threads run
+    ///     out of work at roughly the same time. The calling thread processes chunks, too,
+    ///     and this method only returns after the whole range has been processed.
+    ///   </para>
+    ///   <example>
+    ///     <code>
+    ///       myThreadPool.ParallelFor(
+    ///         0, pixels.size(), 1024,
+    ///         [&amp;pixels](std::size_t begin, std::size_t end) {
+    ///           for(std::size_t index = begin; index &lt; end; ++index) {
+    ///             pixels[index] = gammaCorrect(pixels[index]);
+    ///           }
+    ///         }
+    ///       );
+    ///     </code>
+    ///   </example>
+    ///   <para>
+    ///     Because the calling thread takes part, it is safe to call this method from
+    ///     within a task running on the thread pool. If the method throws, no further
+    ///     chunks will be started and the first exception is rethrown once all chunks
+    ///     already in progress have completed.
+    ///   </para>
+    /// </remarks>
+    public: template<typename TMethod>
+    inline void ParallelFor(
+      std::size_t begin, std::size_t end, std::size_t grainSize, TMethod &&method
+    );
+
+    /// <summary>Starts a task that can be the root of a task graph</summary>
+    /// <typeparam name="TMethod">
+    ///   Type of the method that will be run on a worker thread
+    /// </typeparam>
+    /// <typeparam name="TArguments">
+    ///   Type of the arguments that will be passed to the method when it is called
+    /// </typeparam>
+    /// <param name="method">Method that will be called from a worker thread</param>
+    /// <param name="arguments">Argument values that will be passed to the method</param>
+    /// <returns>A task handle through which continuations can be attached</returns>
+    /// <remarks>
+    ///   <para>
+    ///     Use this instead of <see cref="Schedule" /> when further work depends on
+    ///     the task. Continuations attached via <see cref="TaskHandle.Then" /> or joined
+    ///     via <see cref="TaskHandle.WhenAll" /> are posted to the thread pool by
+    ///     whichever thread completes their last dependency, so no worker thread is
+    ///     ever blocked waiting for another task.
+    ///   </para>
+    ///   <para>
+    ///     If the method throws, the exception is carried through the task graph and
+    ///     rethrown by <see cref="TaskHandle.Get" />. If the thread pool is destroyed
+    ///     before the task could run, it completes with an std::future_error of type
+    ///     broken_promise.
+    ///   </para>
+    /// </remarks>
+    public: template<typename TMethod, typename... TArguments>
+    inline TaskHandle Spawn(TMethod &&method, TArguments &&... arguments);
+
+    // ----------------------------------------------------------------------------------------- //
+
+    /// <summary>Stores a method and its arguments in a timer task</summary>
+    /// <param name="method">Method that will be called from a worker thread</param>
+    /// <param name="arguments">Argument values that will be passed to the method</param>
+    /// <returns>The new timer task</returns>
+    private: template<typename TMethod, typename... TArguments>
+    inline static std::shared_ptr<TimerTask> makeTimerTask(
+      TMethod &&method, TArguments &&... arguments
+    );
+
+    /// <summary>Hands a timer task to the timer thread</summary>
+    /// <param name="task">Timer task that will be scheduled</param>
+    /// <param name="delay">Time until the task will be posted the first time</param>
+    /// <param name="interval">Time between executions, zero for one-shot tasks</param>
+    private: NUCLEX_SUPPORT_API void startTimer(
+      const std::shared_ptr<TimerTask> &task,
+      std::chrono::microseconds delay, std::chrono::microseconds interval
+    );
+
+    /// <summary>Cancels a timer task</summary>
+    /// <param name="task">Timer task that will be canceled</param>
+    /// <returns>True if the timer was canceled, false if it wasn't pending anymore</returns>
+    private: NUCLEX_SUPPORT_API static bool cancelTimer(TimerTask &task);
+
+    /// <summary>Packages a method and its arguments into a task and submits it</summary>
+    /// <param name="priority">Priority lane the task will be scheduled in</param>
+    /// <param name="stopToken">Stop token through which the task can be canceled</param>
+    /// <param name="method">Method that will be called from a worker thread</param>
+    /// <param name="arguments">Argument values that will be passed to the method</param>
+    /// <returns>
+    ///   An std::future instance that will provide the result returned by the method
+    /// </returns>
+    private: template<typename TMethod, typename... TArguments>
+    inline std::future<typename std::invoke_result<TMethod, TArguments...>::type>
+    schedulePackagedTask(
+      Priority priority, std::shared_ptr<const StopToken> &&stopToken,
+      TMethod &&method, TArguments &&... arguments
+    );
+
+    /// <summary>Stores a method and its arguments in a task and submits it</summary>
+    /// <param name="priority">Priority lane the task will be posted to</param>
+    /// <param name="stopToken">Stop token through which the task can be canceled</param>
+    /// <param name="method">Method that will be called from a worker thread</param>
+    /// <param name="arguments">Argument values that will be passed to the method</param>
+    private: template<typename TMethod, typename... TArguments>
+    inline void postTask(
+      Priority priority, std::shared_ptr<const StopToken> &&stopToken,
+      TMethod &&method, TArguments &&... arguments
+    );
+
     // ----------------------------------------------------------------------------------------- //
 
     /// <summary>
@@ -190,7 +848,38 @@ namespace Nuclex { namespace Support { namespace Threading {
     /// </summary>
     /// <param name="taskMemory">Memory block returned by getOrCreateTaskMemory</param>
     /// <param name="task">Task that will be submitted</param>
-    private: NUCLEX_SUPPORT_API void submitTask(std::uint8_t *taskMemory, Task *task);
+    /// <param name="priority">Priority lane the task will be submitted to</param>
+    private: NUCLEX_SUPPORT_API void submitTask(
+      std::uint8_t *taskMemory, Task *task, Priority priority = Priority::Normal
+    );
+
+    /// <summary>
+    ///   Submits a batch of tasks (created via getOrCreateTaskMemory()) to the thread pool
+    /// </summary>
+    /// <param name="taskMemories">Memory blocks returned by getOrCreateTaskMemory</param>
+    /// <param name="tasks">Tasks that will be submitted</param>
+    /// <param name="count">
+    ///   Number of tasks in the batch, must not exceed the bulk submission batch size
+    /// </param>
+    private: NUCLEX_SUPPORT_API void submitTasks(
+      std::uint8_t *const *taskMemories, Task *const *tasks, std::size_t count
+    );
+
+    /// <summary>
+    ///   Frees memory obtained from getOrCreateTaskMemory() that is not going to be submitted
+    /// </summary>
+    /// <param name="taskMemory">Memory block that will be freed</param>
+    /// <remarks>
+    ///   The task constructed in the memory block needs to be destroyed before this.
+    /// </remarks>
+    private: NUCLEX_SUPPORT_API void discardTaskMemory(std::uint8_t *taskMemory);
+
+    /// <summary>Retrieves the maximum number of threads the thread pool can run</summary>
+    /// <returns>The maximum number of threads specified when creating the thread pool</returns>
+    private: NUCLEX_SUPPORT_API std::size_t getMaximumThreadCount() const;
+
+    /// <summary>Maximum number of tasks that are handed to submitTasks() at once</summary>
+    private: static const constexpr std::size_t BulkSubmissionBatchSize = 64;
 
     /// <summary>Structure to hold platform dependent thread and sync objects</summary>
     private: struct PlatformDependentImplementation;
@@ -204,6 +893,46 @@ namespace Nuclex { namespace Support { namespace Threading {
   template<typename TMethod, typename... TArguments>
   inline std::future<typename std::invoke_result<TMethod, TArguments...>::type>
   ThreadPool::Schedule(TMethod &&method, TArguments &&... arguments) {
+    return ScheduleWithPriority(
+      Priority::Normal, std::forward<TMethod>(method), std::forward<TArguments>(arguments)...
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  template<typename TMethod, typename... TArguments>
+  inline std::future<typename std::invoke_result<TMethod, TArguments...>::type>
+  ThreadPool::ScheduleWithPriority(
+    Priority priority, TMethod &&method, TArguments &&... arguments
+  ) {
+    return schedulePackagedTask(
+      priority, std::shared_ptr<const StopToken>(),
+      std::forward<TMethod>(method), std::forward<TArguments>(arguments)...
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  template<typename TMethod, typename... TArguments>
+  inline std::future<typename std::invoke_result<TMethod, TArguments...>::type>
+  ThreadPool::ScheduleWithStopToken(
+    const std::shared_ptr<const StopToken> &stopToken,
+    TMethod &&method, TArguments &&... arguments
+  ) {
+    return schedulePackagedTask(
+      Priority::Normal, std::shared_ptr<const StopToken>(stopToken),
+      std::forward<TMethod>(method), std::forward<TArguments>(arguments)...
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  template<typename TMethod, typename... TArguments>
+  inline std::future<typename std::invoke_result<TMethod, TArguments...>::type>
+  ThreadPool::schedulePackagedTask(
+    Priority priority, std::shared_ptr<const StopToken> &&stopToken,
+    TMethod &&method, TArguments &&... arguments
+  ) {
     typedef typename std::invoke_result<TMethod, TArguments...>::type ResultType;
     typedef std::packaged_task<ResultType()> TaskType;
 
@@ -242,6 +971,7 @@ namespace Nuclex { namespace Support { namespace Threading {
     PackagedTask *packagedTask = new(taskMemory) PackagedTask(
       std::forward<TMethod>(method), std::forward<TArguments>(arguments)...
     );
+    packagedTask->CancellationToken = std::move(stopToken);
 
     // Grab the result before scheduling the task. If the stars are aligned and
     // the thread pool is churning, it may otherwise happen that the task is
@@ -249,15 +979,435 @@ namespace Nuclex { namespace Support { namespace Threading {
     std::future<ResultType> result = packagedTask->Callback.get_future();
 
     // Schedule for execution. The task will either be executed (default) or
-    // destroyed if the thread pool shuts down, both outcomes will result in
-    // the future completing with either a result or in an error state.
-    submitTask(taskMemory, packagedTask);
+    // destroyed if it is canceled or the thread pool shuts down, all outcomes will
+    // result in the future completing with either a result or in an error state.
+    submitTask(taskMemory, packagedTask, priority);
 
     return result;
   }
 
   // ------------------------------------------------------------------------------------------- //
 
+  template<typename TMethod, typename... TArguments>
+  inline void ThreadPool::Post(TMethod &&method, TArguments &&... arguments) {
+    PostWithPriority(
+      Priority::Normal, std::forward<TMethod>(method), std::forward<TArguments>(arguments)...
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  template<typename TMethod, typename... TArguments>
+  inline void ThreadPool::PostWithPriority(
+    Priority priority, TMethod &&method, TArguments &&... arguments
+  ) {
+    postTask(
+      priority, std::shared_ptr<const StopToken>(),
+      std::forward<TMethod>(method), std::forward<TArguments>(arguments)...
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  template<typename TMethod, typename... TArguments>
+  inline void ThreadPool::PostWithStopToken(
+    const std::shared_ptr<const StopToken> &stopToken,
+    TMethod &&method, TArguments &&... arguments
+  ) {
+    postTask(
+      Priority::Normal, std::shared_ptr<const StopToken>(stopToken),
+      std::forward<TMethod>(method), std::forward<TArguments>(arguments)...
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  template<typename TMethod, typename... TArguments>
+  inline void ThreadPool::postTask(
+    Priority priority, std::shared_ptr<const StopToken> &&stopToken,
+    TMethod &&method, TArguments &&... arguments
+  ) {
+
+    #pragma region struct PostedTask
+
+    /// <summary>Task that carries the method and its arguments without a result</summary>
+    struct PostedTask : public Task {
+
+      /// <summary>Initializes the posted task</summary>
+      /// <param name="method">Method that should be called back by the thread pool</param>
+      /// <param name="arguments">Arguments to save until the invocation</param>
+      public: PostedTask(TMethod &&method, TArguments &&... arguments) :
+        Task(),
+        Method(std::forward<TMethod>(method)),
+        Arguments(std::forward<TArguments>(arguments)...) {}
+
+      /// <summary>Terminates the task. If the task was not executed, cancels it</summary>
+      public: ~PostedTask() override = default;
+
+      /// <summary>Executes the task. Is called on the thread pool thread</summary>
+      public: void operator()() noexcept override {
+        std::apply(std::move(this->Method), std::move(this->Arguments));
+      }
+
+      /// <summary>Method that will be called back</summary>
+      public: typename std::decay<TMethod>::type Method;
+      /// <summary>Arguments that will be passed to the method</summary>
+      public: std::tuple<typename std::decay<TArguments>::type...> Arguments;
+
+    };
+
+    #pragma endregion // struct PostedTask
+
+    // Construct the task in the recycled task memory. Unlike Schedule(), there's
+    // nothing else to allocate, the method and arguments live in the task itself.
+    std::uint8_t *taskMemory = getOrCreateTaskMemory(sizeof(PostedTask));
+    PostedTask *postedTask = new(taskMemory) PostedTask(
+      std::forward<TMethod>(method), std::forward<TArguments>(arguments)...
+    );
+    postedTask->CancellationToken = std::move(stopToken);
+
+    // Schedule for execution. The task will either be executed (default) or
+    // destroyed if it is canceled or the thread pool shuts down.
+    submitTask(taskMemory, postedTask, priority);
+
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  template<typename TMethod, typename... TArguments>
+  inline ThreadPool::Timer ThreadPool::ScheduleAfter(
+    std::chrono::microseconds delay, TMethod &&method, TArguments &&... arguments
+  ) {
+    std::shared_ptr<TimerTask> task = makeTimerTask(
+      std::forward<TMethod>(method), std::forward<TArguments>(arguments)...
+    );
+    startTimer(task, delay, std::chrono::microseconds(0));
+    return Timer(task);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  template<typename TMethod, typename... TArguments>
+  inline ThreadPool::Timer ThreadPool::ScheduleEvery(
+    std::chrono::microseconds interval, TMethod &&method, TArguments &&... arguments
+  ) {
+    std::shared_ptr<TimerTask> task = makeTimerTask(
+      std::forward<TMethod>(method), std::forward<TArguments>(arguments)...
+    );
+    startTimer(task, interval, interval);
+    return Timer(task);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  template<typename TMethod, typename... TArguments>
+  inline std::shared_ptr<ThreadPool::TimerTask> ThreadPool::makeTimerTask(
+    TMethod &&method, TArguments &&... arguments
+  ) {
+
+    #pragma region struct StoredTimerTask
+
+    /// <summary>Timer task that carries the method and its arguments</summary>
+    struct StoredTimerTask : public TimerTask {
+
+      /// <summary>Initializes the timer task</summary>
+      /// <param name="method">Method that should be called back by the thread pool</param>
+      /// <param name="arguments">Arguments to save until the invocation</param>
+      public: StoredTimerTask(TMethod &&method, TArguments &&... arguments) :
+        TimerTask(),
+        Method(std::forward<TMethod>(method)),
+        Arguments(std::forward<TArguments>(arguments)...) {}
+
+      /// <summary>Terminates the timer task</summary>
+      public: ~StoredTimerTask() override = default;
+
+      /// <summary>Executes the task. Is called on a thread pool thread</summary>
+      public: void operator()() noexcept override {
+        std::apply(this->Method, this->Arguments);
+      }
+
+      /// <summary>Method that will be called back</summary>
+      public: typename std::decay<TMethod>::type Method;
+      /// <summary>Arguments that will be passed to the method</summary>
+      public: std::tuple<typename std::decay<TArguments>::type...> Arguments;
+
+    };
+
+    #pragma endregion // struct StoredTimerTask
+
+    return std::make_shared<StoredTimerTask>(
+      std::forward<TMethod>(method), std::forward<TArguments>(arguments)...
+    );
+
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  template<typename TMethod>
+  inline void ThreadPool::PostBulk(std::size_t count, TMethod &&method) {
+    if(unlikely(count == 0)) {
+      return;
+    }
+
+    #pragma region struct SharedMethod
+
+    /// <summary>Method shared by all tasks of the batch</summary>
+    struct SharedMethod {
+
+      /// <summary>Initializes the shared method</summary>
+      /// <param name="method">Method that will be called by the tasks</param>
+      /// <param name="referenceCount">Number of tasks that will be referencing it</param>
+      public: SharedMethod(TMethod &&method, std::size_t referenceCount) :
+        Method(std::forward<TMethod>(method)),
+        ReferenceCount(referenceCount) {}
+
+      /// <summary>Drops the specified number of references to the shared method</summary>
+      /// <param name="count">Number of references that will be dropped</param>
+      public: void Release(std::size_t count) {
+        std::size_t previousCount = this->ReferenceCount.fetch_sub(
+          count, std::memory_order_acq_rel
+        );
+        if(previousCount == count) {
+          delete this;
+        }
+      }
+
+      /// <summary>Method that will be called back</summary>
+      public: typename std::decay<TMethod>::type Method;
+      /// <summary>Number of tasks still referencing the shared method</summary>
+      public: std::atomic<std::size_t> ReferenceCount;
+
+    };
+
+    #pragma endregion // struct SharedMethod
+
+    #pragma region struct BulkTask
+
+    /// <summary>Task that calls the shared method with its index</summary>
+    struct BulkTask : public Task {
+
+      /// <summary>Initializes the bulk task</summary>
+      /// <param name="sharedMethod">Method shared by all tasks in the batch</param>
+      /// <param name="index">Index that will be passed to the method</param>
+      public: BulkTask(SharedMethod *sharedMethod, std::size_t index) :
+        Task(),
+        Shared(sharedMethod),
+        Index(index) {}
+
+      /// <summary>Terminates the task. If the task was not executed, cancels it</summary>
+      public: ~BulkTask() override {
+        this->Shared->Release(1);
+      }
+
+      /// <summary>Executes the task. Is called on the thread pool thread</summary>
+      public: void operator()() noexcept override {
+        this->Shared->Method(this->Index);
+      }
+
+      /// <summary>Method shared by all tasks in the batch</summary>
+      public: SharedMethod *Shared;
+      /// <summary>Index that will be passed to the method</summary>
+      public: std::size_t Index;
+
+    };
+
+    #pragma endregion // struct BulkTask
+
+    // The method is stored once and each task holds a reference to it. The reference
+    // count starts out covering all tasks so that no increments are needed.
+    SharedMethod *sharedMethod = new SharedMethod(std::forward<TMethod>(method), count);
+
+    std::uint8_t *taskMemories[BulkSubmissionBatchSize];
+    Task *tasks[BulkSubmissionBatchSize];
+
+    std::size_t index = 0;
+    while(index < count) {
+      std::size_t batchCount = std::min(count - index, BulkSubmissionBatchSize);
+
+      // Construct the tasks for this batch. If we fail midway, the tasks of this batch
+      // and all tasks that have not been created yet give up their references.
+      std::size_t constructedCount = 0;
+      try {
+        while(constructedCount < batchCount) {
+          taskMemories[constructedCount] = getOrCreateTaskMemory(sizeof(BulkTask));
+          tasks[constructedCount] = new(taskMemories[constructedCount]) BulkTask(
+            sharedMethod, index + constructedCount
+          );
+          ++constructedCount;
+        }
+      }
+      catch(...) {
+        std::size_t unconstructedCount = count - index - constructedCount;
+        while(constructedCount > 0) {
+          --constructedCount;
+          tasks[constructedCount]->~Task();
+          discardTaskMemory(taskMemories[constructedCount]);
+        }
+        sharedMethod->Release(unconstructedCount);
+        throw;
+      }
+
+      // Hand the whole batch to the thread pool. If this fails, the thread pool
+      // has already destroyed the batch's tasks, we only need to take care of
+      // the references held for the tasks we didn't get to create.
+      try {
+        submitTasks(taskMemories, tasks, batchCount);
+      }
+      catch(...) {
+        std::size_t unconstructedCount = count - index - batchCount;
+        if(unconstructedCount > 0) {
+          sharedMethod->Release(unconstructedCount);
+        }
+        throw;
+      }
+
+      index += batchCount;
+    }
+
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  template<typename TMethod>
+  inline void ThreadPool::ParallelFor(
+    std::size_t begin, std::size_t end, std::size_t grainSize, TMethod &&method
+  ) {
+    if(unlikely(begin >= end)) {
+      return;
+    }
+    if(unlikely(grainSize == 0)) {
+      grainSize = 1;
+    }
+
+    #pragma region struct ParallelForState
+
+    /// <summary>Keeps track of the range being processed</summary>
+    /// <remarks>
+    ///   This is shared by the calling thread and the helper tasks. Helpers might only
+    ///   start running after the range has been fully processed, which is why
+    ///   the state lives on the heap rather than on the caller's stack.
+    /// </remarks>
+    struct ParallelForState {
+
+      /// <summary>Initializes the parallel for state</summary>
+      /// <param name="method">Method that will process the chunks</param>
+      /// <param name="begin">Index at which processing will begin</param>
+      /// <param name="end">Index one past the last index that will be processed</param>
+      /// <param name="grainSize">Smallest number of indices to process in one chunk</param>
+      /// <param name="chunkDivisor">Fraction of the remaining indices to take per chunk</param>
+      public: ParallelForState(
+        typename std::remove_reference<TMethod>::type &method,
+        std::size_t begin, std::size_t end, std::size_t grainSize, std::size_t chunkDivisor
+      ) :
+        Method(method),
+        NextIndex(begin),
+        End(end),
+        GrainSize(grainSize),
+        ChunkDivisor(chunkDivisor),
+        RemainingIndices(end - begin),
+        HasFailed(false),
+        Error() {}
+
+      /// <summary>Claims and processes the next chunk of the range</summary>
+      /// <returns>True if a chunk was processed, false if the range is used up</returns>
+      public: bool ProcessChunk() noexcept {
+        std::size_t chunkBegin = this->NextIndex.load(std::memory_order_relaxed);
+        std::size_t chunkSize;
+        do {
+          if(chunkBegin >= this->End) {
+            return false;
+          }
+
+          // Take a fraction of the remaining indices, so chunks start out large
+          // and shrink down to the grain size as the range is used up
+          std::size_t remainingCount = this->End - chunkBegin;
+          chunkSize = std::min(
+            std::max(remainingCount / this->ChunkDivisor, this->GrainSize), remainingCount
+          );
+        } while(
+          !this->NextIndex.compare_exchange_weak(
+            chunkBegin, chunkBegin + chunkSize,
+            std::memory_order_relaxed, std::memory_order_relaxed
+          )
+        );
+
+        // Once a chunk has failed, the remaining chunks are only counted down
+        if(likely(!this->HasFailed.load(std::memory_order_relaxed))) {
+          try {
+            this->Method(chunkBegin, chunkBegin + chunkSize);
+          }
+          catch(...) {
+            if(!this->HasFailed.exchange(true, std::memory_order_relaxed)) {
+              this->Error = std::current_exception();
+            }
+          }
+        }
+
+        this->RemainingIndices.CountDown(chunkSize);
+        return true;
+      }
+
+      /// <summary>Method that processes the chunks</summary>
+      public: typename std::remove_reference<TMethod>::type &Method;
+      /// <summary>Index at which the next chunk begins</summary>
+      public: std::atomic<std::size_t> NextIndex;
+      /// <summary>Index one past the last index that will be processed</summary>
+      public: std::size_t End;
+      /// <summary>Smallest number of indices to process in one chunk</summary>
+      public: std::size_t GrainSize;
+      /// <summary>Fraction of the remaining indices that will be taken per chunk</summary>
+      public: std::size_t ChunkDivisor;
+      /// <summary>Counts down the indices as the chunks are completed</summary>
+      public: Latch RemainingIndices;
+      /// <summary>Whether processing of a chunk has failed with an exception</summary>
+      public: std::atomic<bool> HasFailed;
+      /// <summary>Exception thrown by the first chunk that failed</summary>
+      public: std::exception_ptr Error;
+
+    };
+
+    #pragma endregion // struct ParallelForState
+
+    // Post as many helpers as could usefully take part, each taking chunks until
+    // the range is used up. Helpers that only start when the work is done simply exit.
+    std::size_t chunkCount = (end - begin + grainSize - 1) / grainSize;
+    std::size_t helperCount = std::min(chunkCount - 1, getMaximumThreadCount());
+
+    std::shared_ptr<ParallelForState> state = std::make_shared<ParallelForState>(
+      method, begin, end, grainSize, (helperCount + 1) * 2
+    );
+    if(helperCount > 0) {
+      PostBulk(
+        helperCount,
+        [state](std::size_t) {
+          while(state->ProcessChunk()) {}
+        }
+      );
+    }
+
+    // Take part in the work ourselves. This also guarantees progress if the thread
+    // pool's worker threads are all busy or if we're running on a worker thread.
+    while(state->ProcessChunk()) {}
+
+    // The range is used up, but some chunks may still be in progress on other threads
+    state->RemainingIndices.Wait();
+    if(unlikely(state->HasFailed.load(std::memory_order_relaxed))) {
+      std::rethrow_exception(state->Error);
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  template<typename TMethod, typename... TArguments>
+  inline TaskHandle ThreadPool::Spawn(TMethod &&method, TArguments &&... arguments) {
+    TaskHandle::Node *node = new TaskHandle::MethodNode<TMethod, TArguments...>(
+      this, 0, std::forward<TMethod>(method), std::forward<TArguments>(arguments)...
+    );
+    return TaskHandle::attach(node, nullptr, 0);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
 }}} // namespace Nuclex::Support::Threading
 
 #endif // defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
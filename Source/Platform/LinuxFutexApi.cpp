@@ -31,7 +31,90 @@ limitations under the License.
 #include <linux/futex.h> // for futex constants
 #include <unistd.h> // for ::syscall()
 #include <limits.h> // for INT_MAX
-#include <sys/syscall.h> // for ::SYS_futex
+#include <sys/syscall.h> // for ::SYS_futex, ::SYS_futex_waitv
+#include <time.h> // for ::clock_gettime()
+
+// futex_waitv() was added in Linux 5.16. Older kernel headers don't declare it, but
+// the syscall number is the same on all architectures, so we can still try it.
+#if !defined(SYS_futex_waitv)
+#define SYS_futex_waitv 449
+#endif
+#if !defined(FUTEX_32)
+#define FUTEX_32 2
+
+/// <summary>Futex word and expected value as passed to futex_waitv()</summary>
+struct futex_waitv {
+  /// <summary>Value the futex word is expected to have</summary>
+  std::uint64_t val;
+  /// <summary>Address of the futex word</summary>
+  std::uint64_t uaddr;
+  /// <summary>Size of the futex word and whether it is process-private</summary>
+  std::uint32_t flags;
+  /// <summary>Reserved, must be zero</summary>
+  std::uint32_t __reserved;
+};
+#endif
+
+namespace {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Calls futex_waitv() for the specified futex words</summary>
+  /// <param name="targets">Futex words that will be watched for changes</param>
+  /// <param name="targetCount">Number of futex words being watched</param>
+  /// <param name="deadline">Absolute monotonic time at which to give up, may be null</param>
+  /// <returns>The reason why the wait has ended</returns>
+  Nuclex::Support::Platform::LinuxFutexApi::WaitResult waitMultiple(
+    const Nuclex::Support::Platform::LinuxFutexApi::WaitTarget *targets,
+    std::size_t targetCount,
+    const struct ::timespec *deadline
+  ) {
+    typedef Nuclex::Support::Platform::LinuxFutexApi LinuxFutexApi;
+
+    struct ::futex_waitv waiters[LinuxFutexApi::MaximumWaitTargetCount];
+    for(std::size_t index = 0; index < targetCount; ++index) {
+      waiters[index].val = targets[index].ComparisonValue;
+      waiters[index].uaddr = reinterpret_cast<std::uintptr_t>(targets[index].FutexWord);
+      waiters[index].flags = FUTEX_32 | FUTEX_PRIVATE_FLAG;
+      waiters[index].__reserved = 0;
+    }
+
+    // Futex WaitV (Linux 5.16+)
+    // https://docs.kernel.org/userspace-api/futex2.html
+    //
+    // Sleeps until any of the futex words is woken. Like FUTEX_WAIT, the values are
+    // checked atomically with going to sleep and the call fails with EAGAIN if any
+    // of the futex words doesn't have the expected value.
+    long result = ::syscall(
+      SYS_futex_waitv, // syscall id
+      waiters, // futex words and their expected values
+      static_cast<unsigned int>(targetCount), // number of futex words
+      static_cast<unsigned int>(0), // flags -> must be 0
+      deadline, // absolute timeout -> or null for infinite
+      static_cast<int>(CLOCK_MONOTONIC) // clock the timeout refers to
+    );
+    if(unlikely(result == -1)) {
+      int errorNumber = errno;
+      if(likely(errorNumber == EAGAIN)) { // Some futex word did not have its expected value
+        return LinuxFutexApi::WaitResult::ValueChanged;
+      } else if(likely(errorNumber == ETIMEDOUT)) { // Timeout, wait failed
+        return LinuxFutexApi::WaitResult::TimedOut;
+      } else if(errorNumber != EINTR) {
+        Nuclex::Support::Platform::PosixApi::ThrowExceptionForSystemError(
+          u8"Could not sleep on multiple futex words via futex_waitv", errorNumber
+        );
+      }
+
+      return LinuxFutexApi::WaitResult::Interrupted;
+    }
+
+    // On success, futex_waitv() returns the index of the futex word that was woken
+    return LinuxFutexApi::WaitResult::ValueChanged;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // anonymous namespace
 
 namespace Nuclex { namespace Support { namespace Platform {
 
@@ -118,6 +201,62 @@ namespace Nuclex { namespace Support { namespace Platform {
 
   // ------------------------------------------------------------------------------------------- //
 
+  bool LinuxFutexApi::IsPrivateFutexWaitMultipleSupported() {
+    static const bool isSupported = []() {
+
+      // Calling futex_waitv() with zero futex words is invalid, so kernels that know
+      // the syscall fail with EINVAL while older kernels fail with ENOSYS.
+      long result = ::syscall(
+        SYS_futex_waitv,
+        static_cast<struct ::futex_waitv *>(nullptr),
+        static_cast<unsigned int>(0),
+        static_cast<unsigned int>(0),
+        static_cast<struct ::timespec *>(nullptr),
+        static_cast<int>(CLOCK_MONOTONIC)
+      );
+      return (result != -1) || (errno != ENOSYS);
+
+    }();
+
+    return isSupported;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  LinuxFutexApi::WaitResult LinuxFutexApi::PrivateFutexWaitMultiple(
+    const WaitTarget *targets, std::size_t targetCount
+  ) {
+    return waitMultiple(targets, targetCount, nullptr);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  LinuxFutexApi::WaitResult LinuxFutexApi::PrivateFutexWaitMultiple(
+    const WaitTarget *targets, std::size_t targetCount, const ::timespec &patience
+  ) {
+
+    // Unlike FUTEX_WAIT, futex_waitv() takes an absolute timeout
+    struct ::timespec deadline;
+    int result = ::clock_gettime(CLOCK_MONOTONIC, &deadline);
+    if(unlikely(result == -1)) {
+      int errorNumber = errno;
+      Nuclex::Support::Platform::PosixApi::ThrowExceptionForSystemError(
+        u8"Could not get monotonic time for futex wait", errorNumber
+      );
+    }
+
+    deadline.tv_sec += patience.tv_sec;
+    deadline.tv_nsec += patience.tv_nsec;
+    if(deadline.tv_nsec >= 1000000000) {
+      deadline.tv_nsec -= 1000000000;
+      ++deadline.tv_sec;
+    }
+
+    return waitMultiple(targets, targetCount, &deadline);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
   void LinuxFutexApi::PrivateFutexWakeSingle(const volatile std::uint32_t &futexWord) {
 
     // Futex Wake (Linux 2.6.0+)
@@ -60,6 +60,23 @@ namespace Nuclex { namespace Support { namespace Platform {
 
     #pragma endregion // enum WaitResult
 
+    #pragma region struct WaitTarget
+
+    /// <summary>Futex word and the value it is expected to have while waiting</summary>
+    public: struct WaitTarget {
+
+      /// <summary>Futex word that will be watched for changes</summary>
+      public: const volatile std::uint32_t *FutexWord;
+      /// <summary>Value the futex word is expected to have</summary>
+      public: std::uint32_t ComparisonValue;
+
+    };
+
+    #pragma endregion // struct WaitTarget
+
+    /// <summary>Maximum number of futex words that can be waited on at once</summary>
+    public: static const constexpr std::size_t MaximumWaitTargetCount = 128;
+
     /// <summary>Waits for a private futex variable to change its value</summary>
     /// <param name="futexWord">Futex word that will be watched for changed</param>
     /// <param name="comparisonValue">
@@ -91,6 +108,40 @@ namespace Nuclex { namespace Support { namespace Platform {
       const ::timespec &patience
     );
 
+    /// <summary>Checks whether the kernel can wait on several futex words at once</summary>
+    /// <returns>True if futex_waitv() is available, false otherwise</returns>
+    /// <remarks>
+    ///   futex_waitv() was added in Linux 5.16. The check is only done once, subsequent
+    ///   calls return the remembered result.
+    /// </remarks>
+    public: static bool IsPrivateFutexWaitMultipleSupported();
+
+    /// <summary>Waits for any of several private futex words to change their values</summary>
+    /// <param name="targets">Futex words that will be watched for changes</param>
+    /// <param name="targetCount">
+    ///   Number of futex words being watched, at most <see cref="MaximumWaitTargetCount" />
+    /// </param>
+    /// <returns>
+    ///   The reason why the wait method has returned. This method will never report back
+    ///   <see cref="WaitResult::TimedOut" /> as a reason because it does not time out.
+    /// </returns>
+    public: static WaitResult PrivateFutexWaitMultiple(
+      const WaitTarget *targets, std::size_t targetCount
+    );
+
+    /// <summary>Waits for any of several private futex words to change their values</summary>
+    /// <param name="targets">Futex words that will be watched for changes</param>
+    /// <param name="targetCount">
+    ///   Number of futex words being watched, at most <see cref="MaximumWaitTargetCount" />
+    /// </param>
+    /// <param name="patience">
+    ///   Maximum amount of time to wait before returning even when no value changes
+    /// </param>
+    /// <returns>The reason why the wait method has returned</returns>
+    public: static WaitResult PrivateFutexWaitMultiple(
+      const WaitTarget *targets, std::size_t targetCount, const ::timespec &patience
+    );
+
     /// <summary>Wakes a single thread waiting for a futex word to change</summary>
     /// <param name="futexWord">Futex word that is being watched by threads</param>
     public: static void PrivateFutexWakeSingle(
@@ -0,0 +1,237 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+#ifndef NUCLEX_SUPPORT_THREADING_ADAPTIVESPINNER_H
+#define NUCLEX_SUPPORT_THREADING_ADAPTIVESPINNER_H
+
+#include "Nuclex/Support/Config.h"
+
+#if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+
+#include <algorithm> // for std::min(), std::max()
+#include <atomic> // for std::atomic
+#include <chrono> // for std::chrono::steady_clock
+#include <cstdint> // for std::uint32_t
+#include <thread> // for std::this_thread::yield(), std::thread::hardware_concurrency()
+
+#if defined(_MSC_VER)
+#include <intrin.h> // for _mm_pause()
+#endif
+
+namespace Nuclex { namespace Support { namespace Threading {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Busy-waits for a short, self-tuning duration before a thread goes to sleep</summary>
+  /// <remarks>
+  ///   <para>
+  ///     Used by the <see cref="Gate" />, <see cref="Latch" /> and <see cref="Semaphore" />.
+  ///     Sending a thread to sleep on a futex (or via WaitOnAddress() on Windows) costs
+  ///     a system call and waking it up costs another one on the signaling side, plus
+  ///     the scheduler latency until the woken thread runs again. For hand-offs that
+  ///     complete within microseconds, spinning for a bit is much cheaper.
+  ///   </para>
+  ///   <para>
+  ///     The number of iterations spun adapts to how long recent waits took: if a spin
+  ///     succeeds, the budget moves towards twice the number of iterations it needed.
+  ///     If the thread had to sleep but was woken up again very quickly, the budget
+  ///     grows, and if it slept for a long time, the budget shrinks so that threads
+  ///     waiting on rarely signaled primitives do not waste CPU time.
+  ///   </para>
+  ///   <para>
+  ///     The budget is shared by all threads waiting on the same primitive and updated
+  ///     without synchronization. Lost updates merely make the estimate a bit less precise.
+  ///   </para>
+  /// </remarks>
+  class AdaptiveSpinner {
+
+    /// <summary>Maximum number of spin iterations used unless changed by the user</summary>
+    /// <remarks>
+    ///   The x86 pause instruction takes between 10 and 140 cycles depending on
+    ///   the CPU, so this caps spinning at a few dozen microseconds.
+    /// </remarks>
+    public: static const constexpr std::uint32_t DefaultMaximumSpinCount = 1000;
+
+    /// <summary>Lowest spin budget, so short waits can be detected again</summary>
+    public: static const constexpr std::uint32_t MinimumSpinBudget = 16;
+
+    /// <summary>Spin budget a new instance starts out with</summary>
+    public: static const constexpr std::uint32_t InitialSpinBudget = 100;
+
+    /// <summary>Sleeps shorter than this make the spin budget grow</summary>
+    public: static const constexpr std::chrono::microseconds ShortSleepThreshold = (
+      std::chrono::microseconds(50)
+    );
+
+    /// <summary>Spin iterations after which the thread yields its time slice once</summary>
+    /// <remarks>
+    ///   If there are more runnable threads than CPUs, the thread we're waiting on
+    ///   may not even be running. Yielding once in a while gives it a chance.
+    /// </remarks>
+    public: static const constexpr std::uint32_t YieldInterval = 64;
+
+    #pragma region class SleepMeasurement
+
+    /// <summary>Measures how long a thread slept and adjusts the spin budget</summary>
+    /// <remarks>
+    ///   Create this after spinning failed and before going to sleep. When it goes out
+    ///   of scope, the elapsed time is fed back into the spinner.
+    /// </remarks>
+    public: class SleepMeasurement {
+
+      /// <summary>Starts measuring the time a thread sleeps</summary>
+      /// <param name="spinner">Spinner whose budget will be adjusted</param>
+      /// <param name="isEnabled">
+      ///   Whether to measure at all, lets timed waits with zero patience opt out
+      /// </param>
+      public: SleepMeasurement(AdaptiveSpinner &spinner, bool isEnabled = true) :
+        spinner(spinner),
+        isActive(isEnabled && (spinner.maximumSpinCount.load(std::memory_order_relaxed) > 0)),
+        startTime() {
+        if(this->isActive) {
+          this->startTime = std::chrono::steady_clock::now();
+        }
+      }
+
+      /// <summary>Adjusts the spin budget of the spinner to the time slept</summary>
+      public: ~SleepMeasurement() {
+        if(this->isActive) {
+          this->spinner.adaptToSleep(std::chrono::steady_clock::now() - this->startTime);
+        }
+      }
+
+      private: SleepMeasurement(const SleepMeasurement &) = delete;
+      private: SleepMeasurement &operator =(const SleepMeasurement &) = delete;
+
+      /// <summary>Spinner whose spin budget will be adjusted</summary>
+      private: AdaptiveSpinner &spinner;
+      /// <summary>Whether spinning is enabled and the sleep is being measured</summary>
+      private: bool isActive;
+      /// <summary>Time at which the thread was about to go to sleep</summary>
+      private: std::chrono::steady_clock::time_point startTime;
+
+    };
+
+    #pragma endregion // class SleepMeasurement
+
+    /// <summary>Determines the default maximum spin count for the system</summary>
+    /// <returns>The default maximum number of spin iterations</returns>
+    /// <remarks>
+    ///   On a system with just one CPU, spinning is pointless because the thread that
+    ///   would end the wait cannot run while we're spinning, so it is disabled.
+    /// </remarks>
+    public: static std::uint32_t GetDefaultMaximumSpinCount() {
+      static const std::uint32_t defaultMaximumSpinCount = (
+        (std::thread::hardware_concurrency() > 1) ? DefaultMaximumSpinCount : 0
+      );
+      return defaultMaximumSpinCount;
+    }
+
+    /// <summary>Initializes a new adaptive spinner using the default spin limit</summary>
+    public: AdaptiveSpinner() :
+      maximumSpinCount(GetDefaultMaximumSpinCount()),
+      spinBudget(std::min(InitialSpinBudget, GetDefaultMaximumSpinCount())) {}
+
+    /// <summary>Changes the maximum number of iterations the spinner may spin</summary>
+    /// <param name="maximumSpinCount">New maximum number of spin iterations</param>
+    public: void SetMaximumSpinCount(std::uint32_t maximumSpinCount) {
+      this->maximumSpinCount.store(maximumSpinCount, std::memory_order_relaxed);
+      this->spinBudget.store(
+        std::min(InitialSpinBudget, maximumSpinCount), std::memory_order_relaxed
+      );
+    }
+
+    /// <summary>Busy-waits until a condition becomes true or the spin budget runs out</summary>
+    /// <typeparam name="TCondition">Type of the condition that will be checked</typeparam>
+    /// <param name="condition">Condition that will be checked on each iteration</param>
+    /// <returns>True if the condition became true, false if the spin budget ran out</returns>
+    public: template<typename TCondition>
+    bool SpinUntil(TCondition &&condition) {
+      std::uint32_t budget = this->spinBudget.load(std::memory_order_relaxed);
+      if(budget == 0) {
+        return false; // Spinning disabled
+      }
+
+      // If the condition is already true, we learn nothing about the spin budget
+      if(condition()) {
+        return true;
+      }
+
+      for(std::uint32_t iteration = 1; iteration < budget; ++iteration) {
+        if((iteration % YieldInterval) == 0) {
+          std::this_thread::yield();
+        } else {
+          NUCLEX_SUPPORT_CPU_YIELD;
+        }
+
+        if(condition()) {
+          adaptToSpin(iteration);
+          return true;
+        }
+      }
+
+      return false;
+    }
+
+    /// <summary>Moves the spin budget towards twice the iterations a spin needed</summary>
+    /// <param name="iterationCount">Number of iterations the spin needed</param>
+    private: void adaptToSpin(std::uint32_t iterationCount) {
+      std::uint32_t maximum = this->maximumSpinCount.load(std::memory_order_relaxed);
+      std::uint32_t target = std::max(
+        std::min(iterationCount, maximum / 2) * 2, std::min(MinimumSpinBudget, maximum)
+      );
+
+      std::uint32_t budget = this->spinBudget.load(std::memory_order_relaxed);
+      if(target > budget) {
+        budget += (target - budget + 7) / 8;
+      } else {
+        budget -= (budget - target) / 8;
+      }
+      this->spinBudget.store(budget, std::memory_order_relaxed);
+    }
+
+    /// <summary>Grows or shrinks the spin budget depending on how long a thread slept</summary>
+    /// <param name="sleepDuration">Time the thread spent sleeping</param>
+    private: void adaptToSleep(std::chrono::steady_clock::duration sleepDuration) {
+      std::uint32_t maximum = this->maximumSpinCount.load(std::memory_order_relaxed);
+      std::uint32_t budget = this->spinBudget.load(std::memory_order_relaxed);
+      if(sleepDuration < ShortSleepThreshold) {
+        budget = static_cast<std::uint32_t>(
+          std::min<std::uint64_t>(std::uint64_t(budget) * 2 + MinimumSpinBudget, maximum)
+        );
+      } else {
+        budget = std::max(budget - budget / 8, std::min(MinimumSpinBudget, maximum));
+      }
+      this->spinBudget.store(budget, std::memory_order_relaxed);
+    }
+
+    /// <summary>Maximum number of iterations the spin budget can grow to</summary>
+    private: std::atomic<std::uint32_t> maximumSpinCount;
+    /// <summary>Number of iterations a waiting thread currently spins</summary>
+    private: std::atomic<std::uint32_t> spinBudget;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Threading
+
+#endif // defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+
+#endif // NUCLEX_SUPPORT_THREADING_ADAPTIVESPINNER_H
@@ -0,0 +1,377 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+#ifndef NUCLEX_SUPPORT_THREADING_ASYNCWAITLIST_H
+#define NUCLEX_SUPPORT_THREADING_ASYNCWAITLIST_H
+
+#include "Nuclex/Support/Config.h"
+
+#if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+
+#include "Nuclex/Support/Threading/ThreadPool.h" // for ThreadPool
+
+#include <atomic> // for std::atomic
+#include <mutex> // for std::mutex
+#include <functional> // for std::function
+#include <cstddef> // for std::size_t
+
+#include "Nuclex/Support/ScopeGuard.h" // for ON_SCOPE_EXIT
+
+namespace Nuclex { namespace Support { namespace Threading {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Continuations waiting for a synchronization primitive to let them through</summary>
+  /// <remarks>
+  ///   <para>
+  ///     Used by the <see cref="Gate" />, <see cref="Latch" /> and <see cref="Semaphore" />
+  ///     to wait asynchronously: instead of blocking a thread, a continuation is stored in
+  ///     this list and posted to a thread pool once the primitive lets it through.
+  ///   </para>
+  ///   <para>
+  ///     The list is only created when the first asynchronous wait happens, so primitives
+  ///     that are only ever waited on by threads pay nothing but a single pointer check.
+  ///     Both sides of the handshake use sequentially consistent ordering: a waiter first
+  ///     announces itself, then checks the primitive while a signaling thread first changes
+  ///     the primitive, then checks for announced waiters. One of them will always see
+  ///     the other, so no continuation can be left behind.
+  ///   </para>
+  ///   <para>
+  ///     Continuations are posted to their thread pools after the list's mutex has been
+  ///     released. If posting fails, the waiter is put back at the front of the list
+  ///     and whatever the primitive handed out for it (i.e. a semaphore ticket) is given
+  ///     back, so the waiter will have another chance at the next state change. Posting
+  ///     failures are never thrown from the signaling methods of the primitives.
+  ///   </para>
+  /// </remarks>
+  class AsyncWaitList {
+
+    #pragma region struct Waiter
+
+    /// <summary>Continuation waiting to be let through</summary>
+    private: struct Waiter {
+
+      /// <summary>Thread pool the continuation will be posted to</summary>
+      public: ThreadPool *TargetThreadPool;
+      /// <summary>Continuation that will be posted to the thread pool</summary>
+      public: std::function<void()> Continuation;
+      /// <summary>Next waiter in the list</summary>
+      public: Waiter *Next;
+
+    };
+
+    #pragma endregion // struct Waiter
+
+    #pragma region struct PostedWaiter
+
+    /// <summary>Task posted to a thread pool to run a waiter's continuation</summary>
+    /// <remarks>
+    ///   Owns the waiter while it is inside the thread pool. If the thread pool is
+    ///   destroyed before it got to run, the waiter is destroyed without being called.
+    /// </remarks>
+    private: struct PostedWaiter {
+
+      /// <summary>Initializes a new posted waiter for the specified waiter</summary>
+      /// <param name="waiter">Waiter whose continuation will be run</param>
+      public: explicit PostedWaiter(Waiter *waiter) : waiter(waiter) {}
+
+      /// <summary>Takes over the waiter from another posted waiter</summary>
+      /// <param name="other">Posted waiter whose waiter will be taken over</param>
+      public: PostedWaiter(PostedWaiter &&other) noexcept : waiter(other.waiter) {
+        other.waiter = nullptr;
+      }
+
+      /// <summary>Destroys the waiter if it is still owned</summary>
+      public: ~PostedWaiter() {
+        delete this->waiter;
+      }
+
+      /// <summary>Runs the waiter's continuation. Called on a thread pool thread</summary>
+      public: void operator()() {
+        Waiter *runWaiter = this->waiter;
+        this->waiter = nullptr;
+        ON_SCOPE_EXIT { delete runWaiter; };
+        runWaiter->Continuation();
+      }
+
+      /// <summary>Gives up ownership of the waiter, if the posted waiter still owns it</summary>
+      /// <returns>The waiter or null if it was taken over by another posted waiter</returns>
+      public: Waiter *Release() noexcept {
+        Waiter *releasedWaiter = this->waiter;
+        this->waiter = nullptr;
+        return releasedWaiter;
+      }
+
+      /// <summary>Waiter whose continuation will be run</summary>
+      private: Waiter *waiter;
+
+    };
+
+    #pragma endregion // struct PostedWaiter
+
+    /// <summary>Fetches the wait list stored in a slot, creating it if needed</summary>
+    /// <param name="slot">Slot holding the wait list, may be null</param>
+    /// <returns>The wait list stored in the slot</returns>
+    public: static AsyncWaitList &GetOrCreate(std::atomic<AsyncWaitList *> &slot) {
+      AsyncWaitList *existing = slot.load(std::memory_order_acquire);
+      if(likely(existing != nullptr)) {
+        return *existing;
+      }
+
+      AsyncWaitList *created = new AsyncWaitList();
+      if(slot.compare_exchange_strong(existing, created, std::memory_order_seq_cst)) {
+        return *created;
+      } else {
+        delete created;
+        return *existing;
+      }
+    }
+
+    /// <summary>Dispatches waiters after the primitive has changed state</summary>
+    /// <typeparam name="TTryPass">Type of the method checking if a waiter can pass</typeparam>
+    /// <param name="slot">Slot holding the wait list, may be null</param>
+    /// <param name="tryPass">
+    ///   Method that checks (and consumes, if needed) the primitive's state for
+    ///   a single waiter, returning true if the waiter can pass
+    /// </param>
+    /// <remarks>
+    ///   Must be called after every state change of the primitive that could let
+    ///   a waiter through. Costs a fence and a pointer check if nobody waits.
+    /// </remarks>
+    public: template<typename TTryPass>
+    static void DispatchIfWaiting(std::atomic<AsyncWaitList *> &slot, TTryPass &&tryPass) {
+      DispatchIfWaiting(slot, tryPass, []() {});
+    }
+
+    /// <summary>Dispatches waiters after the primitive has changed state</summary>
+    /// <typeparam name="TTryPass">Type of the method checking if a waiter can pass</typeparam>
+    /// <typeparam name="TGiveBack">Type of the method undoing a successful pass</typeparam>
+    /// <param name="slot">Slot holding the wait list, may be null</param>
+    /// <param name="tryPass">
+    ///   Method that checks (and consumes, if needed) the primitive's state for
+    ///   a single waiter, returning true if the waiter can pass
+    /// </param>
+    /// <param name="giveBack">
+    ///   Method that gives back what <paramref name="tryPass" /> consumed for a waiter
+    ///   whose continuation could not be posted. Must not dispatch waiters itself.
+    /// </param>
+    public: template<typename TTryPass, typename TGiveBack>
+    static void DispatchIfWaiting(
+      std::atomic<AsyncWaitList *> &slot, TTryPass &&tryPass, TGiveBack &&giveBack
+    ) {
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+
+      AsyncWaitList *list = slot.load(std::memory_order_acquire);
+      if(unlikely(list != nullptr)) {
+        if(list->waiterCount.load(std::memory_order_seq_cst) > 0) {
+          list->Dispatch(tryPass, giveBack);
+        }
+      }
+    }
+
+    /// <summary>Frees all resources owned by the wait list</summary>
+    /// <remarks>
+    ///   Continuations still waiting are destroyed without being called.
+    /// </remarks>
+    public: ~AsyncWaitList() {
+      while(this->first != nullptr) {
+        Waiter *next = this->first->Next;
+        delete this->first;
+        this->first = next;
+      }
+    }
+
+    /// <summary>Adds a continuation that will be posted once the primitive lets it pass</summary>
+    /// <typeparam name="TTryPass">Type of the method checking if a waiter can pass</typeparam>
+    /// <param name="threadPool">Thread pool the continuation will be posted to</param>
+    /// <param name="continuation">Continuation that will be posted</param>
+    /// <param name="tryPass">
+    ///   Method that checks (and consumes, if needed) the primitive's state for
+    ///   a single waiter, returning true if the waiter can pass
+    /// </param>
+    public: template<typename TTryPass>
+    void Add(
+      ThreadPool &threadPool, std::function<void()> &&continuation, TTryPass &&tryPass
+    ) {
+      Add(threadPool, std::move(continuation), tryPass, []() {});
+    }
+
+    /// <summary>Adds a continuation that will be posted once the primitive lets it pass</summary>
+    /// <typeparam name="TTryPass">Type of the method checking if a waiter can pass</typeparam>
+    /// <typeparam name="TGiveBack">Type of the method undoing a successful pass</typeparam>
+    /// <param name="threadPool">Thread pool the continuation will be posted to</param>
+    /// <param name="continuation">Continuation that will be posted</param>
+    /// <param name="tryPass">
+    ///   Method that checks (and consumes, if needed) the primitive's state for
+    ///   a single waiter, returning true if the waiter can pass
+    /// </param>
+    /// <param name="giveBack">
+    ///   Method that gives back what <paramref name="tryPass" /> consumed for a waiter
+    ///   whose continuation could not be posted. Must not dispatch waiters itself.
+    /// </param>
+    public: template<typename TTryPass, typename TGiveBack>
+    void Add(
+      ThreadPool &threadPool, std::function<void()> &&continuation,
+      TTryPass &&tryPass, TGiveBack &&giveBack
+    ) {
+      Waiter *waiter = new Waiter { &threadPool, std::move(continuation), nullptr };
+
+      // Announce the waiter before checking the primitive's state (see remarks on class)
+      this->waiterCount.fetch_add(1, std::memory_order_seq_cst);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      {
+        std::lock_guard<std::mutex> waiterScope(this->mutex);
+        if(this->last == nullptr) {
+          this->first = waiter;
+        } else {
+          this->last->Next = waiter;
+        }
+        this->last = waiter;
+      }
+
+      // The primitive may have let us through already, in which case the signaling
+      // thread may or may not have seen the waiter. Dispatch ourselves to be sure.
+      Dispatch(tryPass, giveBack);
+    }
+
+    /// <summary>Posts waiting continuations for as long as the primitive lets them pass</summary>
+    /// <typeparam name="TTryPass">Type of the method checking if a waiter can pass</typeparam>
+    /// <typeparam name="TGiveBack">Type of the method undoing a successful pass</typeparam>
+    /// <param name="tryPass">
+    ///   Method that checks (and consumes, if needed) the primitive's state for
+    ///   a single waiter, returning true if the waiter can pass
+    /// </param>
+    /// <param name="giveBack">
+    ///   Method that gives back what <paramref name="tryPass" /> consumed for a waiter
+    ///   whose continuation could not be posted
+    /// </param>
+    private: template<typename TTryPass, typename TGiveBack>
+    void Dispatch(TTryPass &tryPass, TGiveBack &giveBack) {
+
+      // Take all waiters that can pass off the list while holding the lock. They are
+      // posted after the lock is released so the thread pool is never called under it.
+      Waiter *passedFirst = nullptr;
+      Waiter *passedLast = nullptr;
+      {
+        std::lock_guard<std::mutex> waiterScope(this->mutex);
+
+        while(this->first != nullptr) {
+          if(!tryPass()) {
+            break;
+          }
+
+          Waiter *waiter = this->first;
+          this->first = waiter->Next;
+          if(this->first == nullptr) {
+            this->last = nullptr;
+          }
+          this->waiterCount.fetch_sub(1, std::memory_order_relaxed);
+
+          waiter->Next = nullptr;
+          if(passedLast == nullptr) {
+            passedFirst = waiter;
+          } else {
+            passedLast->Next = waiter;
+          }
+          passedLast = waiter;
+        }
+      }
+
+      while(passedFirst != nullptr) {
+        Waiter *waiter = passedFirst;
+        passedFirst = waiter->Next;
+
+        PostedWaiter postedWaiter(waiter);
+        try {
+          waiter->TargetThreadPool->Post(std::move(postedWaiter));
+        }
+        catch(...) {
+
+          // If the thread pool failed before it took over the waiter, the waiter goes
+          // back into the list, otherwise the thread pool has destroyed it already
+          waiter = postedWaiter.Release();
+          if(waiter != nullptr) {
+            waiter->Next = passedFirst;
+            passedFirst = waiter;
+          }
+          std::size_t unpostedCount = requeue(passedFirst) + ((waiter == nullptr) ? 1 : 0);
+
+          // None of these waiters got through, so return what was consumed for them
+          while(unpostedCount > 0) {
+            giveBack();
+            --unpostedCount;
+          }
+          return;
+        }
+      }
+
+    }
+
+    /// <summary>Puts waiters that could not be posted back at the front of the list</summary>
+    /// <param name="waiters">Waiters that will be put back, may be null</param>
+    /// <returns>The number of waiters that were put back</returns>
+    private: std::size_t requeue(Waiter *waiters) {
+      if(waiters == nullptr) {
+        return 0;
+      }
+
+      std::size_t waiterCount = 1;
+      Waiter *waitersLast = waiters;
+      while(waitersLast->Next != nullptr) {
+        waitersLast = waitersLast->Next;
+        ++waiterCount;
+      }
+
+      std::lock_guard<std::mutex> waiterScope(this->mutex);
+
+      waitersLast->Next = this->first;
+      this->first = waiters;
+      if(this->last == nullptr) {
+        this->last = waitersLast;
+      }
+      this->waiterCount.fetch_add(waiterCount, std::memory_order_seq_cst);
+
+      return waiterCount;
+    }
+
+    /// <summary>Initializes a new, empty wait list</summary>
+    private: AsyncWaitList() :
+      waiterCount(0),
+      mutex(),
+      first(nullptr),
+      last(nullptr) {}
+
+    /// <summary>Number of waiters announced or in the list</summary>
+    private: std::atomic<std::size_t> waiterCount;
+    /// <summary>Must be held when accessing the list of waiters</summary>
+    private: std::mutex mutex;
+    /// <summary>First waiter in the list, will be let through first</summary>
+    private: Waiter *first;
+    /// <summary>Last waiter in the list</summary>
+    private: Waiter *last;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Threading
+
+#endif // defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+
+#endif // NUCLEX_SUPPORT_THREADING_ASYNCWAITLIST_H
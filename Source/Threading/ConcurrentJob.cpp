@@ -32,7 +32,12 @@ namespace {
   // ------------------------------------------------------------------------------------------- //
 
   /// <summary>Statuses a concurrent job can be in</summary>
-  enum class Status : int {
+  /// <remarks>
+  ///   The status is stored in the lowest bits of the concurrent job's status field,
+  ///   the remaining bits count the runs of the job. All values below
+  ///   <see cref="Scheduled" /> are idle statuses.
+  /// </remarks>
+  enum class Status : std::size_t {
 
     /// <summary>Concurrent job is stopped</summary>
     Stopped = 0,
@@ -42,138 +47,50 @@ namespace {
     Succeeded = 2,
 
     /// <summary>Concurrent job is waiting to run</summary>
-    Scheduled = -1,
+    Scheduled = 3,
     /// <summary>Concurrent job is currently executing</summary>
-    Running = -2,
-    /// <summayr>Concurrent job is executing and was signaled to cancel</summary>
-    Canceling = -3,
-    /// <summayr>Concurrent job is executing, canceled and should restart immediately</summary>
-    CancelingWithRestart = -4
+    Running = 4,
+    /// <summary>Concurrent job is executing and was signaled to cancel</summary>
+    Canceling = 5,
+    /// <summary>Concurrent job is executing, canceled and should restart immediately</summary>
+    CancelingWithRestart = 6
 
   };
 
   // ------------------------------------------------------------------------------------------- //
-  
-  /// <summary>Manages calling the DoWork() method of a concurrent job</summary>
-  /// <param name="self">This pointer of the concurrent job instance</param>
-  /// <param name="doWorkMethod">Pointer to the DoWork() method</param>
-  /// <param name="status">Atomic integer maintaining the concurrent job's status</param>
-  /// <param name="stateMutex">Mutex that must be held when changing the job's state</param>
-  /// <param name="stopTrigger">Souce of stop tokens, changes after each cancel</param>
-  /// <param name="statusChangedCondition">
-  ///   Condition variable by which users of the concurrent job can wait for completion
-  /// </param>
-  /// <param name="error">Records any error that happens in the worker thread</param>
-  /// <remarks>
-  ///   <para>
-  ///     This could as well be a private method, possible with a private static method to
-  ///     call it, but I wanted to keep this part of the implementation out of the public
-  ///     header. There's a lot going on here, including re-running jobs and handling precise
-  ///     state transitions the way the concurrent job class expects them.
-  ///   </para>
-  ///   <para>
-  ///     This kind of implementation is pretty efficient, but it's only feasible for code
-  ///     like this, which provides a set-in-stone helper class that doesn't need to keep
-  ///     evolving and updating its design.
-  ///   </para>
-  /// </remarks>
-  void callDoWorkOnConcurrentJob(
-    Nuclex::Support::Threading::ConcurrentJob *self,
-    void (Nuclex::Support::Threading::ConcurrentJob::*doWorkMethod)(
-      const std::shared_ptr<const Nuclex::Support::Threading::StopToken> &stopToken
-    ),
-    std::atomic<int> *status,
-    std::mutex *stateMutex,
-    std::shared_ptr<Nuclex::Support::Threading::StopSource> *stopTrigger,
-    std::condition_variable *statusChangedCondition,
-    std::exception_ptr *error
-  ) {
-
-    // Update the job's state to 'Running' and pick up the currently valid
-    // stop token (it will be replaced by a new one if cancellation was used).
-    std::shared_ptr<const Nuclex::Support::Threading::StopToken> stopToken;
-    {
-      bool notifyAllAndReturn = false;
-      {
-        std::unique_lock<std::mutex> stateMutexScope(*stateMutex);
-
-        int currentStatus = status->load(std::memory_order::memory_order_consume);
-        if(currentStatus == static_cast<int>(Status::Canceling)) {
-          status->store(
-            static_cast<int>(Status::Stopped),
-            std::memory_order::memory_order_release
-          );
-          notifyAllAndReturn = true;
-        } else {
-          status->store(
-            static_cast<int>(Status::Running),
-            std::memory_order::memory_order_release
-          );
-
-          stopToken = stopTrigger->get()->GetToken();
-        }
-      } // mutex lock
-
-      if(notifyAllAndReturn) {
-        statusChangedCondition->notify_all();
-        return;
-      }
-    } // scope for notifyAllAndReturn
 
-    // We run the status wrangling and DoWork() invocation in a loop because it may be
-    // restarted any number of times and we handle this here to reduce the complexity
-    // (and chance for mistakes) of the user's overriden DoWork() implementation.
-    for(;;) {
+  /// <summary>Bits of the status field that hold the status</summary>
+  const constexpr std::size_t StatusMask = 7;
 
-      // Invoke the DoWork() method to let the derived class do its background work.
-      std::exception_ptr currentError;
-      try {
-        (self->*doWorkMethod)(stopToken);
-      }
-      catch(const std::exception &) {
-        currentError = std::current_exception();
-      }
+  /// <summary>Value added to the status field for each new run of the job</summary>
+  const constexpr std::size_t RunIncrement = StatusMask + 1;
 
-      // The DoWork() method returned, one way or another. If a restart was pending,
-      // we'll just clear the cancel status and run it again right away. Otherwise,
-      // a transition to either the succeeded or failed state is needed.
-      {
-        std::unique_lock<std::mutex> stateMutexScope(*stateMutex);
-
-        int currentStatus = status->load(std::memory_order::memory_order_consume);
-        if(currentStatus == static_cast<int>(Status::CancelingWithRestart)) {
-          status->store(
-            static_cast<int>(Status::Running),
-            std::memory_order::memory_order_release
-          );
+  // ------------------------------------------------------------------------------------------- //
 
-          // If the status was 'Canceling' or 'CancelingWithRestart', a new stop source
-          // will have been created to provide a fresh, uncanceled stop token
-          stopToken = stopTrigger->get()->GetToken();
-          continue;
-        }
+  /// <summary>Extracts the status from a concurrent job's status field</summary>
+  /// <param name="statusField">Status field from which the status will be extracted</param>
+  /// <returns>The status stored in the status field</returns>
+  Status getStatus(std::size_t statusField) {
+    return static_cast<Status>(statusField & StatusMask);
+  }
 
-        // The DoWork() method exited and no restart was scheduled, so the concurrent job
-        // is now done and remains in either the failed or succeeded state.
-        if(static_cast<bool>(currentError)) {
-          *error = currentError;
-          status->store(
-            static_cast<int>(Status::Failed),
-            std::memory_order::memory_order_release
-          );
-        } else {
-          status->store(
-            static_cast<int>(Status::Succeeded),
-            std::memory_order::memory_order_release
-          );
-        }
+  // ------------------------------------------------------------------------------------------- //
 
-        break;
-      } // mutex lock
+  /// <summary>Replaces the status in a concurrent job's status field</summary>
+  /// <param name="statusField">Status field in which the status will be replaced</param>
+  /// <param name="status">New status that will be stored in the status field</param>
+  /// <returns>The status field with the new status</returns>
+  std::size_t withStatus(std::size_t statusField, Status status) {
+    return (statusField & ~StatusMask) | static_cast<std::size_t>(status);
+  }
 
-    } // for(;;)
+  // ------------------------------------------------------------------------------------------- //
 
-    statusChangedCondition->notify_all();
+  /// <summary>Checks whether a status indicates that the job is idle</summary>
+  /// <param name="status">Status that will be checked</param>
+  /// <returns>True if the job is neither scheduled nor running</returns>
+  bool isIdle(Status status) {
+    return (status < Status::Scheduled);
   }
 
   // ------------------------------------------------------------------------------------------- //
@@ -184,25 +101,52 @@ namespace Nuclex { namespace Support { namespace Threading {
 
   // ------------------------------------------------------------------------------------------- //
 
+  /// <summary>Stop source and outcome of a single run of the background job</summary>
+  /// <remarks>
+  ///   <para>
+  ///     Each run gets its own instance. A thread canceling the job reads the current
+  ///     run state first, then changes the status from 'Running' to 'Canceling'. Because
+  ///     the status field also carries the run number, the status change fails if
+  ///     another run has started in the meantime, so the stop source it cancels is
+  ///     guaranteed to belong to the run that was executing when the status changed.
+  ///   </para>
+  ///   <para>
+  ///     The same goes for <see cref="ConcurrentJob.Join" /> picking up the exception of
+  ///     a failed run. Since each run records its error in its own instance, a new run
+  ///     started by another thread cannot overwrite the exception being rethrown.
+  ///   </para>
+  /// </remarks>
+  struct ConcurrentJob::RunState {
+
+    /// <summary>Initializes a new run state with a fresh stop source</summary>
+    public: RunState() :
+      StopTrigger(StopSource::Create()),
+      Error() {}
+
+    /// <summary>Used to ask the background worker to cancel this run</summary>
+    public: std::shared_ptr<StopSource> StopTrigger;
+    /// <summary>Records any exception that happened in the run</summary>
+    public: std::exception_ptr Error;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
   ConcurrentJob::ConcurrentJob() :
     backgroundThread(),
     threadPool(nullptr),
-    status(static_cast<int>(Status::Stopped)),
-    stateMutex(),
-    stopTrigger(), // leave empty until needed
-    statusChangedCondition(),
-    error() {}
+    status(static_cast<std::size_t>(Status::Stopped)),
+    idleGate(true),
+    currentRun() {}
 
   // ------------------------------------------------------------------------------------------- //
 
   ConcurrentJob::ConcurrentJob(ThreadPool &threadPool) :
     backgroundThread(),
     threadPool(&threadPool),
-    status(static_cast<int>(Status::Stopped)),
-    stateMutex(),
-    stopTrigger(), // leave empty until needed
-    statusChangedCondition(),
-    error() {}
+    status(static_cast<std::size_t>(Status::Stopped)),
+    idleGate(true),
+    currentRun() {}
 
   // ------------------------------------------------------------------------------------------- //
 
@@ -210,22 +154,8 @@ namespace Nuclex { namespace Support { namespace Threading {
     Cancel();
 
     // Wait until the background thread has finished. We could use Join() here,
-    // but we don't want an exception to be re-thrown in the destructor.    
-    for(;;) {
-
-      // Mutex lock scope
-      {
-        std::unique_lock<std::mutex> stateMutexScope(this->stateMutex);
-
-        int currentStatus = this->status.load(std::memory_order::memory_order_consume);
-        if(currentStatus >= 0) {
-          break;
-        }
-
-        this->statusChangedCondition.wait(stateMutexScope);
-      }
-
-    } // for(;;)
+    // but we don't want an exception to be re-thrown in the destructor.
+    Wait();
 
     // Finally, if the background thread was running, join it to prevent
     // the platform's standard C++ library from calling std::terminate() out of frustration.
@@ -237,260 +167,325 @@ namespace Nuclex { namespace Support { namespace Threading {
   // ------------------------------------------------------------------------------------------- //
 
   bool ConcurrentJob::IsRunning() const {
-    int currentStatus = this->status.load(std::memory_order::memory_order_relaxed);
-    return (currentStatus < 0);
+    std::size_t currentStatus = this->status.load(std::memory_order::memory_order_relaxed);
+    return !isIdle(getStatus(currentStatus));
   }
 
   // ------------------------------------------------------------------------------------------- //
 
   void ConcurrentJob::Start() {
-
-    // Figure out if a worker is already running
-    bool startNewWorker = false;
-    {
-      std::unique_lock<std::mutex> stateMutexScope(this->stateMutex);
-
-      int currentStatus = this->status.load(std::memory_order::memory_order_consume);
-      if(currentStatus == static_cast<int>(Status::Canceling)) {
-        this->status.store( // Already canceled, ask to repeat DoWork() call
-          static_cast<int>(Status::CancelingWithRestart),
-          std::memory_order::memory_order_release
-        );
-      } else if(currentStatus >= 0) { // If the worker was not running, start a new one
-        this->status.store(
-          static_cast<int>(Status::Scheduled),
-          std::memory_order::memory_order_release
+    std::size_t currentStatus = this->status.load(std::memory_order::memory_order_acquire);
+    for(;;) {
+      Status status = getStatus(currentStatus);
+      if(status == Status::Canceling) { // Already canceled, ask to repeat DoWork() call
+        bool wasChanged = this->status.compare_exchange_weak(
+          currentStatus, withStatus(currentStatus, Status::CancelingWithRestart),
+          std::memory_order::memory_order_acq_rel, std::memory_order::memory_order_acquire
         );
-        if(!static_cast<bool>(this->stopTrigger)) {
-          this->stopTrigger = StopSource::Create();
+        if(wasChanged) {
+          return;
         }
-        startNewWorker = true;
-      }
-    } // mutex lock
-
-    // If, at the time we were holding the lock, no worker was running or
-    // scheduled to run, start a new one here.
-    if(startNewWorker) {
-      if(this->threadPool == nullptr) {
-        std::thread callDoWorkThread(
-          &callDoWorkOnConcurrentJob,
-          this,
-          &ConcurrentJob::DoWork,
-          &this->status,
-          &this->stateMutex,
-          &this->stopTrigger,
-          &this->statusChangedCondition,
-          &this->error
+      } else if(isIdle(status)) { // If the worker was not running, start a new one
+        bool wasChanged = this->status.compare_exchange_weak(
+          currentStatus, withStatus(currentStatus, Status::Scheduled),
+          std::memory_order::memory_order_acq_rel, std::memory_order::memory_order_acquire
         );
-
-        // If any prior thread was being held, it will be destroyed here.
-        this->backgroundThread.swap(callDoWorkThread);
-        if(callDoWorkThread.joinable()) {
-          callDoWorkThread.join();
+        if(wasChanged) {
+          launch(currentStatus);
+          return;
         }
-      } else {
-        this->threadPool->Schedule(
-          &callDoWorkOnConcurrentJob,
-          this,
-          &ConcurrentJob::DoWork,
-          &this->status,
-          &this->stateMutex,
-          &this->stopTrigger,
-          &this->statusChangedCondition,
-          &this->error
-        );
+      } else { // Scheduled, running or restarting, nothing to do
+        return;
       }
-    }
+    } // for(;;)
   }
 
   // ------------------------------------------------------------------------------------------- //
 
   void ConcurrentJob::StartOrRestart() {
-
-    // Figure out if we can order the already running worker to cancel and restart
-    // or whether we have to schedule a new execution of the worker.
-    bool startNewWorker = false;
-    {
-      std::unique_lock<std::mutex> stateMutexScope(this->stateMutex);
-
-      int currentStatus = this->status.load(std::memory_order::memory_order_consume);
-      if(currentStatus == static_cast<int>(Status::Running)) {
-        this->status.store( // Currently running, cancel and repeat DoWork() call
-          static_cast<int>(Status::CancelingWithRestart),
-          std::memory_order::memory_order_release
+    std::size_t currentStatus = this->status.load(std::memory_order::memory_order_acquire);
+    for(;;) {
+      Status status = getStatus(currentStatus);
+      if(status == Status::Running) { // Currently running, cancel and repeat DoWork() call
+        std::shared_ptr<RunState> run = std::atomic_load(&this->currentRun);
+        bool wasChanged = this->status.compare_exchange_weak(
+          currentStatus, withStatus(currentStatus, Status::CancelingWithRestart),
+          std::memory_order::memory_order_acq_rel, std::memory_order::memory_order_acquire
         );
-        this->stopTrigger->Cancel();
-        this->stopTrigger = StopSource::Create();
-      } else if(currentStatus == static_cast<int>(Status::Canceling)) {
-        this->status.store( // Already canceled, ask to repeat DoWork() call
-          static_cast<int>(Status::CancelingWithRestart),
-          std::memory_order::memory_order_release
+        if(wasChanged) {
+          run->StopTrigger->Cancel();
+          return;
+        }
+      } else if(status == Status::Canceling) { // Already canceled, ask to repeat DoWork()
+        bool wasChanged = this->status.compare_exchange_weak(
+          currentStatus, withStatus(currentStatus, Status::CancelingWithRestart),
+          std::memory_order::memory_order_acq_rel, std::memory_order::memory_order_acquire
         );
-      } else if(currentStatus >= 0) { // If the worker was not running, start a new one
-        this->status.store(
-          static_cast<int>(Status::Scheduled),
-          std::memory_order::memory_order_release
+        if(wasChanged) {
+          return;
+        }
+      } else if(isIdle(status)) { // If the worker was not running, start a new one
+        bool wasChanged = this->status.compare_exchange_weak(
+          currentStatus, withStatus(currentStatus, Status::Scheduled),
+          std::memory_order::memory_order_acq_rel, std::memory_order::memory_order_acquire
         );
-        if(!static_cast<bool>(this->stopTrigger)) {
-          this->stopTrigger = StopSource::Create();
+        if(wasChanged) {
+          launch(currentStatus);
+          return;
         }
-        startNewWorker = true;
+      } else { // Scheduled or restart already requested, the next run will pick it up
+        return;
       }
-    } // mutex lock
+    } // for(;;)
+  }
 
-    // If, at the time we were holding the lock, no worker was running or
-    // scheduled to run, start a new one here.
-    if(startNewWorker) {
-      if(this->threadPool == nullptr) {
-        std::thread callDoWorkThread(
-          &callDoWorkOnConcurrentJob,
-          this,
-          &ConcurrentJob::DoWork,
-          &this->status,
-          &this->stateMutex,
-          &this->stopTrigger,
-          &this->statusChangedCondition,
-          &this->error
-        );
+  // ------------------------------------------------------------------------------------------- //
 
-        // If any prior thread was being held, it will be destroyed here.
-        this->backgroundThread.swap(callDoWorkThread);
-        if(callDoWorkThread.joinable()) {
-          callDoWorkThread.join();
+  void ConcurrentJob::Cancel() {
+    std::size_t currentStatus = this->status.load(std::memory_order::memory_order_acquire);
+    for(;;) {
+      Status status = getStatus(currentStatus);
+      if(status == Status::Running) {
+        std::shared_ptr<RunState> run = std::atomic_load(&this->currentRun);
+        bool wasChanged = this->status.compare_exchange_weak(
+          currentStatus, withStatus(currentStatus, Status::Canceling),
+          std::memory_order::memory_order_acq_rel, std::memory_order::memory_order_acquire
+        );
+        if(wasChanged) {
+          run->StopTrigger->Cancel();
+          return;
         }
-      } else {
-        this->threadPool->Schedule(
-          &callDoWorkOnConcurrentJob,
-          this,
-          &ConcurrentJob::DoWork,
-          &this->status,
-          &this->stateMutex,
-          &this->stopTrigger,
-          &this->statusChangedCondition,
-          &this->error
+      } else if(
+        (status == Status::Scheduled) || (status == Status::CancelingWithRestart)
+      ) {
+        bool wasChanged = this->status.compare_exchange_weak(
+          currentStatus, withStatus(currentStatus, Status::Canceling),
+          std::memory_order::memory_order_acq_rel, std::memory_order::memory_order_acquire
         );
+        if(wasChanged) {
+          return;
+        }
+      } else { // Idle or already canceling
+        return;
       }
-    }
+    } // for(;;)
   }
 
   // ------------------------------------------------------------------------------------------- //
 
-  void ConcurrentJob::Cancel() {
-    std::unique_lock<std::mutex> stateMutexScope(this->stateMutex);
-
-    int currentStatus = this->status.load(std::memory_order::memory_order_consume);
-    if(
-      (currentStatus == static_cast<int>(Status::Running)) ||
-      (currentStatus == static_cast<int>(Status::Scheduled))
-    ) {
-      this->status.store(
-        static_cast<int>(Status::Canceling),
-        std::memory_order::memory_order_release
-      );
-      this->stopTrigger->Cancel();
-      this->stopTrigger = StopSource::Create();
-    } else if(currentStatus == static_cast<int>(Status::CancelingWithRestart)) {
-      this->status.store(
-        static_cast<int>(Status::Canceling),
-        std::memory_order::memory_order_release
-      );
-    }
+  bool ConcurrentJob::Wait(
+    std::chrono::microseconds patience /* = std::chrono::microseconds() */
+  ) {
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now() + patience;
+    for(;;) {
+      std::size_t currentStatus = this->status.load(std::memory_order::memory_order_acquire);
+      if(isIdle(getStatus(currentStatus))) {
+        return true;
+      }
+
+      // The gate is opened right before the worker changes the status, so we may
+      // briefly find the gate open while the status is still running. In that case,
+      // we'll just loop until the status change becomes visible.
+      if(patience.count() == 0) {
+        this->idleGate.Wait();
+      } else {
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if(now >= end) {
+          return false;
+        }
+        bool isOpen = this->idleGate.WaitFor(
+          std::chrono::duration_cast<std::chrono::microseconds>(end - now)
+        );
+        if(!isOpen) {
+          return false;
+        }
+      }
+    } // for(;;)
   }
 
   // ------------------------------------------------------------------------------------------- //
 
-  bool ConcurrentJob::Wait(
+  bool ConcurrentJob::Join(
     std::chrono::microseconds patience /* = std::chrono::microseconds() */
   ) {
-    std::chrono::time_point end = std::chrono::steady_clock::now() + patience;
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now() + patience;
     for(;;) {
-      
-      // Extra scope for mutex so it is dropped and reacquired (needlessly?).
-      // The condition_variable::wait_until() will already make the mutex lockable
-      // for the background thread, but this feels less spooky to me.
-      {
-        std::unique_lock<std::mutex> stateMutexScope(this->stateMutex);
-
-        int currentStatus = this->status.load(std::memory_order::memory_order_consume);
-        switch(currentStatus) {
-          case static_cast<int>(Status::Stopped):
-          case static_cast<int>(Status::Succeeded):
-          case static_cast<int>(Status::Failed): {
+      std::size_t currentStatus = this->status.load(std::memory_order::memory_order_acquire);
+      switch(getStatus(currentStatus)) {
+        case Status::Stopped: {
+          return true;
+        }
+        case Status::Succeeded: {
+          bool wasChanged = this->status.compare_exchange_strong(
+            currentStatus, withStatus(currentStatus, Status::Stopped),
+            std::memory_order::memory_order_acq_rel, std::memory_order::memory_order_acquire
+          );
+          if(wasChanged) {
             return true;
           }
+          continue; // Restarted by another thread, wait for the new run
         }
-
-        // This will open the mutex for other threads to enter and wait until the condition
-        // variable is signaled. The worker thread signals the condition variable whenever
-        // a status change occurs that would be intersting to this specific line of code.
-        if(patience.count() == 0) {
-          this->statusChangedCondition.wait(stateMutexScope);
-        } else {
-          std::cv_status result = this->statusChangedCondition.wait_until(stateMutexScope, end);
-          if(result == std::cv_status::timeout) {
-            return false; // If the wait timed out, 
+        case Status::Failed: {
+          std::shared_ptr<RunState> run = std::atomic_load(&this->currentRun);
+          bool wasChanged = this->status.compare_exchange_strong(
+            currentStatus, withStatus(currentStatus, Status::Stopped),
+            std::memory_order::memory_order_acq_rel, std::memory_order::memory_order_acquire
+          );
+          if(wasChanged) {
+            std::rethrow_exception(run->Error);
           }
+          continue; // Restarted by another thread, wait for the new run
         }
-      } // mutex scope
+        default: {
+          break;
+        }
+      }
 
+      // Not idle, wait for the worker to open the gate (see Wait() for details)
+      if(patience.count() == 0) {
+        this->idleGate.Wait();
+      } else {
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if(now >= end) {
+          return false;
+        }
+        bool isOpen = this->idleGate.WaitFor(
+          std::chrono::duration_cast<std::chrono::microseconds>(end - now)
+        );
+        if(!isOpen) {
+          return false;
+        }
+      }
     } // for(;;)
+  }
 
-    // Could call thread::join() here, but another thread might have called StartOrRestaty()
-    // already and we'd be sitting here until the whole operation is done...
+  // ------------------------------------------------------------------------------------------- //
+
+  void ConcurrentJob::launch(std::size_t idleStatus) {
+    this->idleGate.Close();
+
+    // If no thread or thread pool task could be created, nobody is going to pick up
+    // the job, so we have to take it back to idle. The status may have been changed to
+    // 'Canceling' or 'CancelingWithRestart' in the meantime, but all these transitions
+    // expect a worker to eventually finish, so we simply overwrite them.
+    std::thread callDoWorkThread;
+    try {
+      if(this->threadPool == nullptr) {
+        std::thread newThread(&ConcurrentJob::runDoWork, this);
+        callDoWorkThread.swap(newThread);
+      } else {
+        this->threadPool->Post(&ConcurrentJob::runDoWork, this);
+      }
+    }
+    catch(...) {
+      this->status.store(idleStatus, std::memory_order::memory_order_release);
+      this->idleGate.Open();
+      throw;
+    }
+
+    // If any prior thread was being held, it will be destroyed here.
+    if(callDoWorkThread.joinable()) {
+      this->backgroundThread.swap(callDoWorkThread);
+      if(callDoWorkThread.joinable()) {
+        callDoWorkThread.join();
+      }
+    }
   }
 
   // ------------------------------------------------------------------------------------------- //
 
-  bool ConcurrentJob::Join(
-    std::chrono::microseconds patience /* = std::chrono::microseconds() */
-  ) {
-    std::chrono::time_point end = std::chrono::steady_clock::now() + patience;
+  void ConcurrentJob::runDoWork() {
+    std::size_t currentStatus = this->status.load(std::memory_order::memory_order_acquire);
+
+    // We run the status wrangling and DoWork() invocation in a loop because it may be
+    // restarted any number of times and we handle this here to reduce the complexity
+    // (and chance for mistakes) of the user's overriden DoWork() implementation.
     for(;;) {
-      
-      // Extra scope for mutex so it is dropped and reacquired (needlessly?).
-      // The condition_variable::wait_until() will already make the mutex lockable
-      // for the background thread, but this feels less spooky to me.
-      {
-        std::unique_lock<std::mutex> stateMutexScope(this->stateMutex);
-
-        int currentStatus = this->status.load(std::memory_order::memory_order_consume);
-        switch(currentStatus) {
-          case static_cast<int>(Status::Stopped): {
-            return true;
-          }
-          case static_cast<int>(Status::Succeeded): {
-            this->status.store(
-              static_cast<int>(Status::Stopped),
-              std::memory_order::memory_order_release
-            );
-            return true;
+
+      // Begin a new run. Its state has to be visible before the status says 'Running'
+      // so that threads canceling the run are guaranteed to find the right stop source.
+      std::shared_ptr<RunState> run = std::make_shared<RunState>();
+      for(;;) {
+        if(getStatus(currentStatus) == Status::Canceling) {
+          this->idleGate.Open();
+          bool wasChanged = this->status.compare_exchange_weak(
+            currentStatus, withStatus(currentStatus, Status::Stopped),
+            std::memory_order::memory_order_acq_rel, std::memory_order::memory_order_acquire
+          );
+          if(wasChanged) {
+            return; // After this, the concurrent job may be destroyed at any time
           }
-          case static_cast<int>(Status::Failed): {
-            this->status.store(
-              static_cast<int>(Status::Stopped),
-              std::memory_order::memory_order_release
-            );
-            std::rethrow_exception(this->error);
+          this->idleGate.Close(); // The job was restarted before we could stop
+        } else { // Scheduled or restart requested
+          std::atomic_store(&this->currentRun, run);
+          std::size_t runningStatus = withStatus(
+            currentStatus + RunIncrement, Status::Running
+          );
+          bool wasChanged = this->status.compare_exchange_weak(
+            currentStatus, runningStatus,
+            std::memory_order::memory_order_acq_rel, std::memory_order::memory_order_acquire
+          );
+          if(wasChanged) {
+            currentStatus = runningStatus;
+            break;
           }
         }
+      }
 
-        // This will open the mutex for other threads to enter and wait until the condition
-        // variable is signaled. The worker thread signals the condition variable whenever
-        // a status change occurs that would be intersting to this specific line of code.
-        if(patience.count() == 0) {
-          this->statusChangedCondition.wait(stateMutexScope);
-        } else {
-          std::cv_status result = this->statusChangedCondition.wait_until(stateMutexScope, end);
-          if(result == std::cv_status::timeout) {
-            return false; // If the wait timed out, 
+      // Invoke the DoWork() method to let the derived class do its background work.
+      try {
+        DoWork(run->StopTrigger->GetToken());
+      }
+      catch(...) {
+        run->Error = std::current_exception();
+      }
+
+      // The DoWork() method returned, one way or another. If a restart was requested,
+      // we either run it again right away or, on a thread pool, queue the job again so
+      // the worker thread is free in between (or run it again here if that fails).
+      // Otherwise, the job ends up in either the succeeded or the failed state.
+      for(;;) {
+        if(getStatus(currentStatus) == Status::CancelingWithRestart) {
+          if(this->threadPool == nullptr) {
+            break;
           }
+
+          bool wasChanged = this->status.compare_exchange_weak(
+            currentStatus, withStatus(currentStatus, Status::Scheduled),
+            std::memory_order::memory_order_acq_rel, std::memory_order::memory_order_acquire
+          );
+          if(wasChanged) {
+            try {
+              this->threadPool->Post(&ConcurrentJob::runDoWork, this);
+            }
+            catch(...) {
+              // If the job could not be queued again, nobody else is going to pick it up,
+              // so run it again right here, just like a job on its own thread would.
+              currentStatus = this->status.load(std::memory_order::memory_order_acquire);
+              break;
+            }
+            return;
+          }
+        } else { // Running or canceling
+          Status finalStatus = static_cast<bool>(run->Error) ? (
+            Status::Failed
+          ) : (
+            Status::Succeeded
+          );
+
+          this->idleGate.Open();
+          bool wasChanged = this->status.compare_exchange_weak(
+            currentStatus, withStatus(currentStatus, finalStatus),
+            std::memory_order::memory_order_acq_rel, std::memory_order::memory_order_acquire
+          );
+          if(wasChanged) {
+            return; // After this, the concurrent job may be destroyed at any time
+          }
+          this->idleGate.Close(); // A restart was requested before we could finish
         }
-      } // mutex scope
+      } // for(;;)
 
     } // for(;;)
-
-    // Could call thread::join() here, but another thread might have called StartOrRestaty()
-    // already and we'd be sitting here until the whole operation is done...
   }
 
   // ------------------------------------------------------------------------------------------- //
@@ -0,0 +1,278 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the library is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_SUPPORT_SOURCE 1
+
+#include "Nuclex/Support/Threading/CpuSet.h"
+#include "Nuclex/Support/BitTricks.h" // for BitTricks::CountBits()
+
+#include <stdexcept> // for std::invalid_argument
+#include <cctype> // for std::isspace()
+#include <algorithm> // for std::min()
+
+namespace {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Number of CPUs that can appear in a parsed CPU list</summary>
+  /// <remarks>
+  ///   This is the most CPUs a Linux kernel can be configured for (NR_CPUS). It is above
+  ///   CPU_SETSIZE because affinity is changed with dynamically allocated CPU sets, and
+  ///   also covers the CPU indices Windows can form from its processor groups.
+  /// </remarks>
+  const constexpr std::size_t CpuIndexLimit = 8192;
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Parses a decimal CPU index from a CPU list</summary>
+  /// <param name="cpuList">CPU list from which the index will be parsed</param>
+  /// <param name="position">
+  ///   Position at which the index starts, will be moved past the index
+  /// </param>
+  /// <returns>The parsed CPU index</returns>
+  std::size_t parseCpuIndex(const std::string &cpuList, std::string::size_type &position) {
+    std::string::size_type start = position;
+
+    std::size_t cpuIndex = 0;
+    while(position < cpuList.length()) {
+      char current = cpuList[position];
+      if((current < '0') || (current > '9')) {
+        break;
+      }
+      cpuIndex = cpuIndex * 10 + static_cast<std::size_t>(current - '0');
+      if(unlikely(cpuIndex >= CpuIndexLimit)) { // Also guards against overflow
+        throw std::invalid_argument(u8"CPU list contains a CPU index that is out of range");
+      }
+      ++position;
+    }
+
+    if(unlikely(position == start)) {
+      throw std::invalid_argument(u8"CPU list contains an invalid entry");
+    }
+
+    return cpuIndex;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Appends a range of CPUs to a CPU list string</summary>
+  /// <param name="cpuList">CPU list to which the range will be appended</param>
+  /// <param name="first">Index of the first CPU in the range</param>
+  /// <param name="last">Index of the last CPU in the range</param>
+  void appendCpuRange(std::string &cpuList, std::size_t first, std::size_t last) {
+    if(!cpuList.empty()) {
+      cpuList.push_back(',');
+    }
+
+    cpuList.append(std::to_string(first));
+    if(last != first) {
+      cpuList.push_back('-');
+      cpuList.append(std::to_string(last));
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // anonymous namespace
+
+namespace Nuclex { namespace Support { namespace Threading {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  CpuSet CpuSet::FromMask(std::uint64_t affinityMask) {
+    CpuSet result;
+    if(affinityMask != 0) {
+      result.words.push_back(affinityMask);
+    }
+    return result;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  CpuSet CpuSet::Parse(const std::string &cpuList) {
+    CpuSet result;
+
+    std::string::size_type position = 0;
+    std::string::size_type length = cpuList.length();
+    for(;;) {
+
+      // Skip whitespace, sysfs files end with a line break and empty lists are valid
+      while((position < length) && std::isspace(static_cast<unsigned char>(cpuList[position]))) {
+        ++position;
+      }
+      if(position >= length) {
+        break;
+      }
+
+      // Each entry is either a single CPU or a range of CPUs
+      std::size_t first = parseCpuIndex(cpuList, position);
+      std::size_t last = first;
+      if((position < length) && (cpuList[position] == '-')) {
+        ++position;
+        last = parseCpuIndex(cpuList, position);
+        if(unlikely(last < first)) {
+          throw std::invalid_argument(u8"CPU list contains a reversed range");
+        }
+      }
+      for(std::size_t cpuIndex = first; cpuIndex <= last; ++cpuIndex) {
+        result.Add(cpuIndex);
+      }
+
+      if((position < length) && (cpuList[position] == ',')) {
+        ++position;
+      }
+    }
+
+    return result;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void CpuSet::Add(std::size_t cpuIndex) {
+    std::size_t wordIndex = cpuIndex / 64;
+    if(wordIndex >= this->words.size()) {
+      this->words.resize(wordIndex + 1, 0);
+    }
+
+    this->words[wordIndex] |= (std::uint64_t(1) << (cpuIndex % 64));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void CpuSet::Remove(std::size_t cpuIndex) {
+    std::size_t wordIndex = cpuIndex / 64;
+    if(wordIndex < this->words.size()) {
+      this->words[wordIndex] &= ~(std::uint64_t(1) << (cpuIndex % 64));
+      while(!this->words.empty() && (this->words.back() == 0)) {
+        this->words.pop_back();
+      }
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  bool CpuSet::IsEmpty() const {
+    return this->words.empty();
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::size_t CpuSet::Count() const {
+    std::size_t count = 0;
+    for(std::size_t index = 0; index < this->words.size(); ++index) {
+      count += BitTricks::CountBits(this->words[index]);
+    }
+    return count;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::size_t CpuSet::GetUpperBound() const {
+    if(this->words.empty()) {
+      return 0;
+    }
+
+    std::size_t wordCount = this->words.size();
+    return (
+      (wordCount * 64) - BitTricks::CountLeadingZeroBits(this->words[wordCount - 1])
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::vector<std::size_t> CpuSet::GetIndices() const {
+    std::vector<std::size_t> indices;
+    indices.reserve(Count());
+
+    for(std::size_t wordIndex = 0; wordIndex < this->words.size(); ++wordIndex) {
+      std::uint64_t word = this->words[wordIndex];
+      for(std::size_t bitIndex = 0; word != 0; ++bitIndex, word >>= 1) {
+        if((word & 1) != 0) {
+          indices.push_back(wordIndex * 64 + bitIndex);
+        }
+      }
+    }
+
+    return indices;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::string CpuSet::ToString() const {
+    std::string cpuList;
+
+    // Collapse consecutive CPUs into ranges as the Linux kernel does
+    std::vector<std::size_t> indices = GetIndices();
+    std::size_t count = indices.size();
+    std::size_t index = 0;
+    while(index < count) {
+      std::size_t first = indices[index];
+      std::size_t last = first;
+      while((index + 1 < count) && (indices[index + 1] == last + 1)) {
+        ++index;
+        ++last;
+      }
+
+      appendCpuRange(cpuList, first, last);
+      ++index;
+    }
+
+    return cpuList;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  bool CpuSet::operator ==(const CpuSet &other) const {
+    return (this->words == other.words);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  CpuSet &CpuSet::operator |=(const CpuSet &other) {
+    if(other.words.size() > this->words.size()) {
+      this->words.resize(other.words.size(), 0);
+    }
+
+    for(std::size_t index = 0; index < other.words.size(); ++index) {
+      this->words[index] |= other.words[index];
+    }
+
+    return *this;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  CpuSet &CpuSet::operator &=(const CpuSet &other) {
+    std::size_t commonWordCount = std::min(this->words.size(), other.words.size());
+    this->words.resize(commonWordCount);
+
+    for(std::size_t index = 0; index < commonWordCount; ++index) {
+      this->words[index] &= other.words[index];
+    }
+    while(!this->words.empty() && (this->words.back() == 0)) {
+      this->words.pop_back();
+    }
+
+    return *this;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Threading
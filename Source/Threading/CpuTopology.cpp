@@ -0,0 +1,332 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the library is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_SUPPORT_SOURCE 1
+
+#include "Nuclex/Support/Threading/CpuTopology.h"
+
+#if defined(NUCLEX_SUPPORT_LINUX)
+#include <sched.h> // for ::sched_getcpu()
+#include <fcntl.h> // for ::open()
+#include <unistd.h> // for ::read(), ::close()
+#include <sys/sysinfo.h> // for ::get_nprocs()
+#include <set> // for std::set
+#include <utility> // for std::pair
+#elif defined(NUCLEX_SUPPORT_WINDOWS)
+#include "../Platform/WindowsApi.h" // for ::GetNumaHighestNodeNumber() and more
+#include <memory> // for std::unique_ptr
+#else
+#include <unistd.h> // for ::sysconf()
+#endif
+
+#include <string> // for std::string
+#include <stdexcept> // for std::invalid_argument
+
+namespace {
+
+  // ------------------------------------------------------------------------------------------- //
+#if defined(NUCLEX_SUPPORT_LINUX)
+  /// <summary>Reads a small text file such as the ones provided by sysfs</summary>
+  /// <param name="path">Absolute path of the file that will be read</param>
+  /// <param name="contents">Receives the contents of the file</param>
+  /// <returns>True if the file was read, false if it could not be opened</returns>
+  /// <remarks>
+  ///   Missing files are expected (containers, older kernels, exotic hardware), so this
+  ///   does not throw but leaves it to the caller to fall back to some default.
+  /// </remarks>
+  bool tryReadTextFile(const std::string &path, std::string &contents) {
+    int fileDescriptor = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if(fileDescriptor == -1) {
+      return false;
+    }
+
+    contents.clear();
+
+    char buffer[256];
+    for(;;) {
+      ::ssize_t readByteCount = ::read(fileDescriptor, buffer, sizeof(buffer));
+      if(readByteCount <= 0) {
+        break;
+      }
+      contents.append(buffer, static_cast<std::size_t>(readByteCount));
+    }
+
+    ::close(fileDescriptor);
+    return true;
+  }
+#endif // defined(NUCLEX_SUPPORT_LINUX)
+  // ------------------------------------------------------------------------------------------- //
+#if defined(NUCLEX_SUPPORT_LINUX)
+  /// <summary>Reads a CPU list from a sysfs file</summary>
+  /// <param name="path">Absolute path of the sysfs file holding the CPU list</param>
+  /// <param name="cpuSet">Receives the CPUs listed in the file</param>
+  /// <returns>True if the CPU list was read, false if it was unavailable</returns>
+  bool tryReadCpuList(const std::string &path, Nuclex::Support::Threading::CpuSet &cpuSet) {
+    std::string cpuList;
+    if(!tryReadTextFile(path, cpuList)) {
+      return false;
+    }
+
+    try {
+      cpuSet = Nuclex::Support::Threading::CpuSet::Parse(cpuList);
+    }
+    catch(const std::invalid_argument &) {
+      return false;
+    }
+
+    return true;
+  }
+#endif // defined(NUCLEX_SUPPORT_LINUX)
+  // ------------------------------------------------------------------------------------------- //
+#if defined(NUCLEX_SUPPORT_WINDOWS)
+  /// <summary>Adds the CPUs of a processor group affinity to a CPU set</summary>
+  /// <param name="cpuSet">CPU set the CPUs will be added to</param>
+  /// <param name="groupAffinity">Processor group and mask of CPUs in the group</param>
+  void addGroupAffinity(
+    Nuclex::Support::Threading::CpuSet &cpuSet, const ::GROUP_AFFINITY &groupAffinity
+  ) {
+    std::size_t firstCpuIndex = static_cast<std::size_t>(groupAffinity.Group) * 64;
+    for(std::size_t bitIndex = 0; bitIndex < 64; ++bitIndex) {
+      if((static_cast<std::uint64_t>(groupAffinity.Mask) & (std::uint64_t(1) << bitIndex)) != 0) {
+        cpuSet.Add(firstCpuIndex + bitIndex);
+      }
+    }
+  }
+#endif // defined(NUCLEX_SUPPORT_WINDOWS)
+  // ------------------------------------------------------------------------------------------- //
+
+} // anonymous namespace
+
+namespace Nuclex { namespace Support { namespace Threading {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  CpuTopology::CpuTopology() :
+    onlineCpus(),
+    numaNodeCpus(),
+    cpuNumaNodes(),
+    physicalCoreCount(1) {}
+
+  // ------------------------------------------------------------------------------------------- //
+#if defined(NUCLEX_SUPPORT_LINUX)
+  CpuTopology CpuTopology::Query() {
+    static const std::string cpuDirectory(u8"/sys/devices/system/cpu/");
+    static const std::string nodeDirectory(u8"/sys/devices/system/node/");
+
+    CpuTopology topology;
+
+    // Figure out which CPUs are online. If sysfs isn't mounted, assume that
+    // the CPUs reported by the C library are numbered without gaps.
+    if(!tryReadCpuList(cpuDirectory + u8"online", topology.onlineCpus)) {
+      int processorCount = ::get_nprocs();
+      for(int index = 0; index < processorCount; ++index) {
+        topology.onlineCpus.Add(static_cast<std::size_t>(index));
+      }
+    }
+
+    // Collect the CPUs of each NUMA node. Nodes without CPUs (memory-only nodes
+    // or nodes whose CPUs are all offline) are skipped.
+    CpuSet nodeIndices;
+    if(tryReadCpuList(nodeDirectory + u8"online", nodeIndices)) {
+      std::vector<std::size_t> nodeNumbers = nodeIndices.GetIndices();
+      for(std::size_t index = 0; index < nodeNumbers.size(); ++index) {
+        CpuSet nodeCpus;
+        std::string path = (
+          nodeDirectory + u8"node" + std::to_string(nodeNumbers[index]) + u8"/cpulist"
+        );
+        if(tryReadCpuList(path, nodeCpus)) {
+          nodeCpus &= topology.onlineCpus;
+          if(!nodeCpus.IsEmpty()) {
+            topology.numaNodeCpus.push_back(nodeCpus);
+          }
+        }
+      }
+    }
+    if(topology.numaNodeCpus.empty()) {
+      topology.numaNodeCpus.push_back(topology.onlineCpus);
+    }
+
+    // Count the physical cores by looking for distinct (package, core) pairs.
+    // If the files are missing, each logical CPU is assumed to be a physical core.
+    std::vector<std::size_t> cpuIndices = topology.onlineCpus.GetIndices();
+    {
+      std::set<std::pair<std::string, std::string>> physicalCores;
+      for(std::size_t index = 0; index < cpuIndices.size(); ++index) {
+        std::string topologyDirectory = (
+          cpuDirectory + u8"cpu" + std::to_string(cpuIndices[index]) + u8"/topology/"
+        );
+
+        std::pair<std::string, std::string> packageAndCore;
+        bool isKnown = (
+          tryReadTextFile(topologyDirectory + u8"physical_package_id", packageAndCore.first) &&
+          tryReadTextFile(topologyDirectory + u8"core_id", packageAndCore.second)
+        );
+        if(!isKnown) {
+          packageAndCore.first.assign(u8"cpu");
+          packageAndCore.second = std::to_string(cpuIndices[index]);
+        }
+
+        physicalCores.insert(packageAndCore);
+      }
+      if(!physicalCores.empty()) {
+        topology.physicalCoreCount = physicalCores.size();
+      }
+    }
+
+    // Build the reverse lookup table from CPU index to NUMA node
+    topology.cpuNumaNodes.resize(topology.onlineCpus.GetUpperBound(), 0);
+    for(std::size_t nodeIndex = 0; nodeIndex < topology.numaNodeCpus.size(); ++nodeIndex) {
+      std::vector<std::size_t> nodeCpuIndices = topology.numaNodeCpus[nodeIndex].GetIndices();
+      for(std::size_t index = 0; index < nodeCpuIndices.size(); ++index) {
+        topology.cpuNumaNodes[nodeCpuIndices[index]] = nodeIndex;
+      }
+    }
+
+    return topology;
+  }
+#endif // defined(NUCLEX_SUPPORT_LINUX)
+  // ------------------------------------------------------------------------------------------- //
+#if defined(NUCLEX_SUPPORT_WINDOWS)
+  CpuTopology CpuTopology::Query() {
+    CpuTopology topology;
+
+    // Windows hands out CPUs in processor groups of up to 64 CPUs each
+    {
+      WORD groupCount = ::GetActiveProcessorGroupCount();
+      for(WORD groupIndex = 0; groupIndex < groupCount; ++groupIndex) {
+        DWORD processorCount = ::GetActiveProcessorCount(groupIndex);
+        for(DWORD index = 0; index < processorCount; ++index) {
+          topology.onlineCpus.Add(static_cast<std::size_t>(groupIndex) * 64 + index);
+        }
+      }
+    }
+
+    // Collect the CPUs of each NUMA node
+    ULONG highestNodeNumber = 0;
+    if(::GetNumaHighestNodeNumber(&highestNodeNumber) != FALSE) {
+      for(ULONG nodeNumber = 0; nodeNumber <= highestNodeNumber; ++nodeNumber) {
+        ::GROUP_AFFINITY groupAffinity = {0};
+        BOOL result = ::GetNumaNodeProcessorMaskEx(
+          static_cast<USHORT>(nodeNumber), &groupAffinity
+        );
+        if(result != FALSE) {
+          CpuSet nodeCpus;
+          addGroupAffinity(nodeCpus, groupAffinity);
+          nodeCpus &= topology.onlineCpus;
+          if(!nodeCpus.IsEmpty()) {
+            topology.numaNodeCpus.push_back(nodeCpus);
+          }
+        }
+      }
+    }
+    if(topology.numaNodeCpus.empty()) {
+      topology.numaNodeCpus.push_back(topology.onlineCpus);
+    }
+
+    // Count the physical cores. The first call only reports the required buffer size.
+    {
+      DWORD byteCount = 0;
+      ::GetLogicalProcessorInformationEx(::RelationProcessorCore, nullptr, &byteCount);
+      if(byteCount > 0) {
+        std::unique_ptr<std::uint8_t[]> buffer(new std::uint8_t[byteCount]);
+        ::SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX *information = (
+          reinterpret_cast<::SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX *>(buffer.get())
+        );
+        BOOL result = ::GetLogicalProcessorInformationEx(
+          ::RelationProcessorCore, information, &byteCount
+        );
+        if(result != FALSE) {
+          std::size_t coreCount = 0;
+          for(DWORD offset = 0; offset < byteCount; ++coreCount) {
+            offset += reinterpret_cast<::SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX *>(
+              buffer.get() + offset
+            )->Size;
+          }
+          if(coreCount > 0) {
+            topology.physicalCoreCount = coreCount;
+          }
+        }
+      }
+    }
+
+    // Build the reverse lookup table from CPU index to NUMA node
+    topology.cpuNumaNodes.resize(topology.onlineCpus.GetUpperBound(), 0);
+    for(std::size_t nodeIndex = 0; nodeIndex < topology.numaNodeCpus.size(); ++nodeIndex) {
+      std::vector<std::size_t> nodeCpuIndices = topology.numaNodeCpus[nodeIndex].GetIndices();
+      for(std::size_t index = 0; index < nodeCpuIndices.size(); ++index) {
+        topology.cpuNumaNodes[nodeCpuIndices[index]] = nodeIndex;
+      }
+    }
+
+    return topology;
+  }
+#endif // defined(NUCLEX_SUPPORT_WINDOWS)
+  // ------------------------------------------------------------------------------------------- //
+#if !defined(NUCLEX_SUPPORT_LINUX) && !defined(NUCLEX_SUPPORT_WINDOWS)
+  CpuTopology CpuTopology::Query() {
+    CpuTopology topology;
+
+    // Plain Posix has no way to query NUMA nodes, so report a single node
+    long processorCount = ::sysconf(_SC_NPROCESSORS_ONLN);
+    for(long index = 0; index < processorCount; ++index) {
+      topology.onlineCpus.Add(static_cast<std::size_t>(index));
+    }
+    if(topology.onlineCpus.IsEmpty()) {
+      topology.onlineCpus.Add(0);
+    }
+
+    topology.numaNodeCpus.push_back(topology.onlineCpus);
+    topology.cpuNumaNodes.resize(topology.onlineCpus.GetUpperBound(), 0);
+    topology.physicalCoreCount = topology.onlineCpus.Count();
+
+    return topology;
+  }
+#endif // !defined(NUCLEX_SUPPORT_LINUX) && !defined(NUCLEX_SUPPORT_WINDOWS)
+  // ------------------------------------------------------------------------------------------- //
+
+  std::size_t CpuTopology::GetCurrentCpuIndex() {
+#if defined(NUCLEX_SUPPORT_LINUX)
+    int cpuIndex = ::sched_getcpu();
+    return (cpuIndex < 0) ? 0 : static_cast<std::size_t>(cpuIndex);
+#elif defined(NUCLEX_SUPPORT_WINDOWS)
+    ::PROCESSOR_NUMBER processorNumber;
+    ::GetCurrentProcessorNumberEx(&processorNumber);
+    return (
+      static_cast<std::size_t>(processorNumber.Group) * 64 +
+      static_cast<std::size_t>(processorNumber.Number)
+    );
+#else
+    return 0;
+#endif
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::size_t CpuTopology::GetNumaNodeOfCpu(std::size_t cpuIndex) const {
+    if(cpuIndex < this->cpuNumaNodes.size()) {
+      return this->cpuNumaNodes[cpuIndex];
+    } else {
+      return 0;
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Threading
@@ -0,0 +1,173 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the library is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_SUPPORT_SOURCE 1
+#include "Nuclex/Support/Threading/EpochDomain.h"
+#include "ReclamationRecord.h" // for ReclamationRecord, RetiredInstance
+
+#include <new> // for std::nothrow
+
+namespace {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Number of retired objects after which a domain tries to free them</summary>
+  const constexpr std::size_t ReclaimThreshold = 64;
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Epoch the system is currently in, starts at 1 because 0 means idle</summary>
+  std::atomic<std::uint64_t> globalEpoch(1);
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Advances the global epoch if all readers have caught up with it</summary>
+  /// <returns>True if the epoch was advanced, false if a reader is lagging behind</returns>
+  bool tryAdvanceGlobalEpoch() noexcept {
+    using Nuclex::Support::Threading::ReclamationRecord;
+
+    // Pairs with the fence in enterReadSection(). Either the reader's announcement
+    // is visible here or the reader will not see the objects that were just unlinked.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    std::uint64_t epoch = globalEpoch.load(std::memory_order_seq_cst);
+    ReclamationRecord *record = ReclamationRecord::GetFirst();
+    while(record != nullptr) {
+      std::uint64_t readerEpoch = record->Epoch.load(std::memory_order_seq_cst);
+      if((readerEpoch != 0) && (readerEpoch != epoch)) {
+        return false;
+      }
+      record = record->Next;
+    }
+
+    // If another thread advanced the epoch in the meantime, that's just as good
+    globalEpoch.compare_exchange_strong(epoch, epoch + 1, std::memory_order_seq_cst);
+    return true;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // anonymous namespace
+
+namespace Nuclex { namespace Support { namespace Threading {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  EpochDomain::EpochDomain() :
+    retiredInstances(nullptr),
+    retiredCount(0) {}
+
+  // ------------------------------------------------------------------------------------------- //
+
+  EpochDomain::~EpochDomain() {
+    FreeRetiredInstances(this->retiredInstances.load(std::memory_order_acquire));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void EpochDomain::Retire(void *instance, void (*deleter)(void *)) noexcept {
+    RetiredInstance *retired = new(std::nothrow) RetiredInstance;
+    if(unlikely(retired == nullptr)) {
+      return; // Leaking the instance is the only safe thing to do
+    }
+
+    // The caller has unlinked the instance before retiring it, so any reader that
+    // entered after the epoch read here can not see the instance anymore.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    retired->Instance = instance;
+    retired->Deleter = deleter;
+    retired->Epoch = globalEpoch.load(std::memory_order_seq_cst);
+    PushRetiredInstances(this->retiredInstances, retired, retired);
+
+    std::size_t count = this->retiredCount.fetch_add(1, std::memory_order_relaxed) + 1;
+    if(count >= ReclaimThreshold) {
+      Reclaim();
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void EpochDomain::Reclaim() noexcept {
+    this->retiredCount.store(0, std::memory_order_relaxed);
+
+    RetiredInstance *retired = this->retiredInstances.exchange(
+      nullptr, std::memory_order_acquire
+    );
+    if(retired == nullptr) {
+      return;
+    }
+
+    // Instances retired in epoch E may still be seen by readers that entered in E,
+    // but once the epoch reached E + 2, all of those readers must have left. If no
+    // readers are active, advancing twice here lets the instances go right away.
+    if(tryAdvanceGlobalEpoch()) {
+      tryAdvanceGlobalEpoch();
+    }
+    std::uint64_t epoch = globalEpoch.load(std::memory_order_seq_cst);
+
+    RetiredInstance *firstKept = nullptr, *lastKept = nullptr;
+    RetiredInstance *firstFreed = nullptr;
+    while(retired != nullptr) {
+      RetiredInstance *next = retired->Next;
+      if(retired->Epoch + 2 <= epoch) {
+        retired->Next = firstFreed;
+        firstFreed = retired;
+      } else {
+        retired->Next = firstKept;
+        firstKept = retired;
+        if(lastKept == nullptr) {
+          lastKept = retired;
+        }
+      }
+      retired = next;
+    }
+
+    if(firstKept != nullptr) {
+      PushRetiredInstances(this->retiredInstances, firstKept, lastKept);
+    }
+    FreeRetiredInstances(firstFreed);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  ReclamationRecord *EpochDomain::enterReadSection() {
+    ReclamationRecord &record = ReclamationRecord::GetForCurrentThread();
+
+    // Only the outermost read section announces an epoch. Nested read sections are
+    // covered by it because nothing can be freed before the outermost one ends.
+    if(record.EpochNestingDepth++ == 0) {
+      record.Epoch.store(globalEpoch.load(std::memory_order_relaxed), std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+
+    return &record;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void EpochDomain::leaveReadSection(ReclamationRecord *record) noexcept {
+    if(--record->EpochNestingDepth == 0) {
+      record->Epoch.store(0, std::memory_order_release);
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Threading
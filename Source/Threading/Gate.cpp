@@ -36,6 +36,12 @@ limitations under the License.
 
 #include <atomic> // for std::atomic
 
+#if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+#include "AsyncWaitList.h" // for AsyncWaitList
+#include "AdaptiveSpinner.h" // for AdaptiveSpinner
+#include "MultiWaitNotifier.h" // for MultiWaitNotifier
+#endif
+
 #if !defined(NUCLEX_SUPPORT_LINUX) && !defined(NUCLEX_SUPPORT_WINDOWS)
   // Just some safety checks to make sure pthread_condattr_setclock() is available.
   // https://www.gnu.org/software/libc/manual/html_node/Feature-Test-Macros.html
@@ -52,6 +58,8 @@ limitations under the License.
 #endif
 
 #include <cassert> // for assert()
+#include <algorithm> // for std::min()
+#include <limits> // for std::numeric_limits
 
 namespace Nuclex { namespace Support { namespace Threading {
 
@@ -73,6 +81,10 @@ namespace Nuclex { namespace Support { namespace Threading {
 #elif defined(NUCLEX_SUPPORT_WINDOWS)
     /// <summary>Stores the current state of the wait varable</summary>
     public: volatile std::uint32_t WaitWord;
+#endif
+#if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+    /// <summary>Lets waiting threads spin briefly before they go to sleep</summary>
+    public: mutable AdaptiveSpinner Spinner;
 #else // Posix
     /// <summary>Whether the gate is currently open</summary>
     public: std::atomic<bool> IsOpen;
@@ -89,14 +101,16 @@ namespace Nuclex { namespace Support { namespace Threading {
   Gate::PlatformDependentImplementationData::PlatformDependentImplementationData(
     bool initiallyOpen
   ) :
-    FutexWord(initiallyOpen ? 1 : 0) {}
+    FutexWord(initiallyOpen ? 1 : 0),
+    Spinner() {}
 #endif
   // ------------------------------------------------------------------------------------------- //
 #if defined(NUCLEX_SUPPORT_WINDOWS)
   Gate::PlatformDependentImplementationData::PlatformDependentImplementationData(
     bool initiallyOpen
   ) :
-    WaitWord(initiallyOpen ? 1 : 0) {}
+    WaitWord(initiallyOpen ? 1 : 0),
+    Spinner() {}
 #endif
   // ------------------------------------------------------------------------------------------- //
 #if !defined(NUCLEX_SUPPORT_LINUX) && !defined(NUCLEX_SUPPORT_WINDOWS) // -> Posix
@@ -158,15 +172,35 @@ namespace Nuclex { namespace Support { namespace Threading {
       u8"Private implementation data for Nuclex::Support::Threading::Gate fits in buffer"
     );
     new(this->implementationDataBuffer) PlatformDependentImplementationData(initiallyOpen);
+#if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+    this->asyncWaitList.store(nullptr, std::memory_order_relaxed);
+#endif
   }
 
   // ------------------------------------------------------------------------------------------- //
 
   Gate::~Gate() {
+#if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+    delete this->asyncWaitList.load(std::memory_order_acquire);
+#endif
     getImplementationData().~PlatformDependentImplementationData();
   }
 
   // ------------------------------------------------------------------------------------------- //
+
+  void Gate::SetMaximumSpinCount(std::size_t maximumSpinCount) {
+#if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+    getImplementationData().Spinner.SetMaximumSpinCount(
+      static_cast<std::uint32_t>(
+        std::min<std::size_t>(maximumSpinCount, std::numeric_limits<std::uint32_t>::max())
+      )
+    );
+#else
+    (void)maximumSpinCount; // The pthreads-based implementation always sleeps right away
+#endif
+  }
+
+  // ------------------------------------------------------------------------------------------- //
 #if defined(NUCLEX_SUPPORT_LINUX)
   void Gate::Open() {
     PlatformDependentImplementationData &impl = getImplementationData();
@@ -180,6 +214,13 @@ namespace Nuclex { namespace Support { namespace Threading {
     // This will signal other threads sitting in the Gate::Wait() method to
     // re-check the gate's status and resume running
     Platform::LinuxFutexApi::PrivateFutexWakeAll(impl.FutexWord);
+    MultiWaitNotifier::NotifyIfWaiting();
+
+    // Post any continuations that were waiting asynchronously for the gate to open
+    AsyncWaitList::DispatchIfWaiting(
+      this->asyncWaitList,
+      [&impl]() { return (__atomic_load_n(&impl.FutexWord, __ATOMIC_ACQUIRE) != 0); }
+    );
   }
 #endif
   // ------------------------------------------------------------------------------------------- //
@@ -198,6 +239,16 @@ namespace Nuclex { namespace Support { namespace Threading {
     // the gate's state and resume running
     //
     Platform::WindowsSyncApi::WakeByAddressAll(impl.WaitWord);
+    MultiWaitNotifier::NotifyIfWaiting();
+
+    // Post any continuations that were waiting asynchronously for the gate to open
+    AsyncWaitList::DispatchIfWaiting(
+      this->asyncWaitList,
+      [&impl]() {
+        std::atomic_thread_fence(std::memory_order::memory_order_acquire);
+        return (impl.WaitWord != 0);
+      }
+    );
   }
 #endif
   // ------------------------------------------------------------------------------------------- //
@@ -262,6 +313,48 @@ namespace Nuclex { namespace Support { namespace Threading {
 #endif
   // ------------------------------------------------------------------------------------------- //
 
+#if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+  void Gate::WaitAsync(ThreadPool &threadPool, std::function<void()> continuation) {
+    PlatformDependentImplementationData &impl = getImplementationData();
+
+    AsyncWaitList::GetOrCreate(this->asyncWaitList).Add(
+      threadPool, std::move(continuation),
+      [&impl]() {
+#if defined(NUCLEX_SUPPORT_LINUX)
+        return (__atomic_load_n(&impl.FutexWord, __ATOMIC_ACQUIRE) != 0);
+#else
+        std::atomic_thread_fence(std::memory_order::memory_order_acquire);
+        return (impl.WaitWord != 0);
+#endif
+      }
+    );
+  }
+#endif
+  // ------------------------------------------------------------------------------------------- //
+#if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+  bool Gate::isOpen() const {
+    const PlatformDependentImplementationData &impl = getImplementationData();
+#if defined(NUCLEX_SUPPORT_LINUX)
+    return (__atomic_load_n(&impl.FutexWord, __ATOMIC_ACQUIRE) != 0);
+#else
+    bool isOpen = (impl.WaitWord != 0);
+    std::atomic_thread_fence(std::memory_order::memory_order_acquire);
+    return isOpen;
+#endif
+  }
+#endif
+  // ------------------------------------------------------------------------------------------- //
+#if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+  const volatile std::uint32_t &Gate::getWaitWord() const {
+#if defined(NUCLEX_SUPPORT_LINUX)
+    return getImplementationData().FutexWord;
+#else
+    return getImplementationData().WaitWord;
+#endif
+  }
+#endif
+  // ------------------------------------------------------------------------------------------- //
+
   void Gate::Set(bool opened) {
     if(opened) {
       Open();
@@ -283,6 +376,16 @@ namespace Nuclex { namespace Support { namespace Threading {
       return; // Gate was open
     }
 
+    // Busy-wait for a short while before going to sleep. If the gate is opened
+    // within microseconds, this saves the system calls on both sides.
+    bool wasOpened = impl.Spinner.SpinUntil(
+      [&impl]() { return (__atomic_load_n(&impl.FutexWord, __ATOMIC_CONSUME) != 0); }
+    );
+    if(wasOpened) {
+      return; // Gate was opened while spinning
+    }
+    AdaptiveSpinner::SleepMeasurement sleepMeasurement(impl.Spinner);
+
     // Be ready to check multiple times in case of EINTR
     for(;;) {
 
@@ -318,6 +421,16 @@ namespace Nuclex { namespace Support { namespace Threading {
       return; // Gate was open
     }
 
+    // Busy-wait for a short while before going to sleep. If the gate is opened
+    // within microseconds, this saves the system calls on both sides.
+    bool wasOpened = impl.Spinner.SpinUntil(
+      [&impl]() { return (impl.WaitWord != 0); }
+    );
+    if(wasOpened) {
+      return; // Gate was opened while spinning
+    }
+    AdaptiveSpinner::SleepMeasurement sleepMeasurement(impl.Spinner);
+
     // Be ready to check multiple times in case of spurious wakeups
     for(;;) {
 
@@ -387,6 +500,18 @@ namespace Nuclex { namespace Support { namespace Threading {
       return true; // Gate was open
     }
 
+    // Busy-wait for a short while before going to sleep. If the gate is opened
+    // within microseconds, this saves the system calls on both sides.
+    if(patience.count() > 0) {
+      bool wasOpened = impl.Spinner.SpinUntil(
+        [&impl]() { return (__atomic_load_n(&impl.FutexWord, __ATOMIC_CONSUME) != 0); }
+      );
+      if(wasOpened) {
+        return true; // Gate was opened while spinning
+      }
+    }
+    AdaptiveSpinner::SleepMeasurement sleepMeasurement(impl.Spinner, patience.count() > 0);
+
     // Query the time, but don't do anything with it yet (the futex wait is
     // relative, so unless we get EINTR, the time isn't even needed)
     struct ::timespec startTime;
@@ -461,6 +586,18 @@ namespace Nuclex { namespace Support { namespace Threading {
       return true; // Gate was open
     }
 
+    // Busy-wait for a short while before going to sleep. If the gate is opened
+    // within microseconds, this saves the system calls on both sides.
+    if(patience.count() > 0) {
+      bool wasOpened = impl.Spinner.SpinUntil(
+        [&impl]() { return (impl.WaitWord != 0); }
+      );
+      if(wasOpened) {
+        return true; // Gate was opened while spinning
+      }
+    }
+    AdaptiveSpinner::SleepMeasurement sleepMeasurement(impl.Spinner, patience.count() > 0);
+
     // Query the tick counter, but don't do anything with it yet (the wait time is
     // relative, so unless we get a spurious wait, the tick counter isn't even needed)
     std::chrono::milliseconds startTickCount(::GetTickCount64());
@@ -0,0 +1,176 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the library is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_SUPPORT_SOURCE 1
+#include "Nuclex/Support/Threading/HazardPointerDomain.h"
+#include "ReclamationRecord.h" // for ReclamationRecord, RetiredInstance
+
+#include <new> // for std::nothrow
+#include <vector> // for std::vector
+#include <algorithm> // for std::sort(), std::binary_search()
+
+namespace {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Number of retired objects after which a domain tries to free them</summary>
+  const constexpr std::size_t ReclaimThreshold = 64;
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Collects the pointers currently protected by any thread</summary>
+  /// <param name="hazards">Receives the protected pointers in sorted order</param>
+  void collectHazards(std::vector<const void *> &hazards) {
+    using Nuclex::Support::Threading::ReclamationRecord;
+
+    // Pairs with the fence in Guard::Protect(). Either the guard's hazard pointer is
+    // visible here or the guard will see that the object has already been unlinked.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    ReclamationRecord *record = ReclamationRecord::GetFirst();
+    while(record != nullptr) {
+      for(std::size_t index = 0; index < ReclamationRecord::HazardSlotCount; ++index) {
+        const void *hazard = record->Hazards[index].load(std::memory_order_seq_cst);
+        if(hazard != nullptr) {
+          hazards.push_back(hazard);
+        }
+      }
+      record = record->Next;
+    }
+
+    std::sort(hazards.begin(), hazards.end());
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // anonymous namespace
+
+namespace Nuclex { namespace Support { namespace Threading {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  HazardPointerDomain::HazardPointerDomain() :
+    retiredInstances(nullptr),
+    retiredCount(0) {}
+
+  // ------------------------------------------------------------------------------------------- //
+
+  HazardPointerDomain::~HazardPointerDomain() {
+    FreeRetiredInstances(this->retiredInstances.load(std::memory_order_acquire));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void HazardPointerDomain::Retire(void *instance, void (*deleter)(void *)) noexcept {
+    RetiredInstance *retired = new(std::nothrow) RetiredInstance;
+    if(unlikely(retired == nullptr)) {
+      return; // Leaking the instance is the only safe thing to do
+    }
+
+    retired->Instance = instance;
+    retired->Deleter = deleter;
+    retired->Epoch = 0;
+    PushRetiredInstances(this->retiredInstances, retired, retired);
+
+    std::size_t count = this->retiredCount.fetch_add(1, std::memory_order_relaxed) + 1;
+    if(count >= ReclaimThreshold) {
+      Reclaim();
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void HazardPointerDomain::Reclaim() noexcept {
+    this->retiredCount.store(0, std::memory_order_relaxed);
+
+    RetiredInstance *retired = this->retiredInstances.exchange(
+      nullptr, std::memory_order_acquire
+    );
+    if(retired == nullptr) {
+      return;
+    }
+
+    std::vector<const void *> hazards;
+    try {
+      collectHazards(hazards);
+    }
+    catch(...) {
+      RetiredInstance *last = retired;
+      while(last->Next != nullptr) {
+        last = last->Next;
+      }
+      PushRetiredInstances(this->retiredInstances, retired, last);
+      return; // Out of memory, try again on the next reclamation
+    }
+
+    RetiredInstance *firstKept = nullptr, *lastKept = nullptr;
+    RetiredInstance *firstFreed = nullptr;
+    while(retired != nullptr) {
+      RetiredInstance *next = retired->Next;
+      if(std::binary_search(hazards.begin(), hazards.end(), retired->Instance)) {
+        retired->Next = firstKept;
+        firstKept = retired;
+        if(lastKept == nullptr) {
+          lastKept = retired;
+        }
+      } else {
+        retired->Next = firstFreed;
+        firstFreed = retired;
+      }
+      retired = next;
+    }
+
+    if(firstKept != nullptr) {
+      PushRetiredInstances(this->retiredInstances, firstKept, lastKept);
+    }
+    FreeRetiredInstances(firstFreed);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::atomic<const void *> *HazardPointerDomain::takeHazardSlot(ReclamationRecord *&record) {
+    ReclamationRecord &threadRecord = ReclamationRecord::GetForCurrentThread();
+
+    std::atomic<const void *> *slot = threadRecord.TryTakeHazardSlot();
+    if(likely(slot != nullptr)) {
+      record = &threadRecord;
+      return slot;
+    }
+
+    // The thread is holding more guards than its own record has slots. Take
+    // an extra record for this guard alone, it's slower but doesn't limit the user.
+    record = ReclamationRecord::Acquire();
+    return record->TryTakeHazardSlot();
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void HazardPointerDomain::giveBackHazardSlot(
+    ReclamationRecord *record, std::atomic<const void *> *slot
+  ) noexcept {
+    record->GiveBackHazardSlot(slot);
+    if(unlikely(record != &ReclamationRecord::GetForCurrentThread())) {
+      ReclamationRecord::Release(record);
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Threading
@@ -37,6 +37,13 @@ limitations under the License.
 
 #include <atomic> // for std::atomic
 #include <cassert> // for assert()
+#include <algorithm> // for std::min()
+#include <limits> // for std::numeric_limits
+
+#if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+#include "AsyncWaitList.h" // for AsyncWaitList
+#include "AdaptiveSpinner.h" // for AdaptiveSpinner
+#endif
 
 #if !defined(NUCLEX_SUPPORT_LINUX) && !defined(NUCLEX_SUPPORT_WINDOWS)
   // Just some safety checks to make sure pthread_condattr_setclock() is available.
@@ -81,6 +88,10 @@ namespace Nuclex { namespace Support { namespace Threading {
 #endif
     /// <summary>How many tasks the latch is waiting on</summary>
     public: std::atomic<std::size_t> Countdown;
+#if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+    /// <summary>Lets waiting threads spin briefly before they go to sleep</summary>
+    public: mutable AdaptiveSpinner Spinner;
+#endif
 
   };
 
@@ -90,7 +101,8 @@ namespace Nuclex { namespace Support { namespace Threading {
     std::size_t initialCount
   ) :
     FutexWord((initialCount > 0) ? 0 : 1),
-    Countdown(initialCount) {}
+    Countdown(initialCount),
+    Spinner() {}
 #endif
   // ------------------------------------------------------------------------------------------- //
 #if defined(NUCLEX_SUPPORT_WINDOWS)
@@ -98,7 +110,8 @@ namespace Nuclex { namespace Support { namespace Threading {
     std::size_t initialCount
   ) :
     WaitWord((initialCount > 0) ? 0 : 1),
-    Countdown(initialCount) {}
+    Countdown(initialCount),
+    Spinner() {}
 #endif
   // ------------------------------------------------------------------------------------------- //
 #if !defined(NUCLEX_SUPPORT_LINUX) && !defined(NUCLEX_SUPPORT_WINDOWS) // -> Posix
@@ -161,15 +174,35 @@ namespace Nuclex { namespace Support { namespace Threading {
       u8"Private implementation data for Nuclex::Support::Threading::Latch fits in buffer"
     );
     new(this->implementationDataBuffer) PlatformDependentImplementationData(initialCount);
+#if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+    this->asyncWaitList.store(nullptr, std::memory_order_relaxed);
+#endif
   }
 
   // ------------------------------------------------------------------------------------------- //
 
   Latch::~Latch() {
+#if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+    delete this->asyncWaitList.load(std::memory_order_acquire);
+#endif
     getImplementationData().~PlatformDependentImplementationData();
   }
 
   // ------------------------------------------------------------------------------------------- //
+
+  void Latch::SetMaximumSpinCount(std::size_t maximumSpinCount) {
+#if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+    getImplementationData().Spinner.SetMaximumSpinCount(
+      static_cast<std::uint32_t>(
+        std::min<std::size_t>(maximumSpinCount, std::numeric_limits<std::uint32_t>::max())
+      )
+    );
+#else
+    (void)maximumSpinCount; // The pthreads-based implementation always sleeps right away
+#endif
+  }
+
+  // ------------------------------------------------------------------------------------------- //
 #if defined(NUCLEX_SUPPORT_LINUX)
   void Latch::Post(std::size_t count /* = 1 */) {
     PlatformDependentImplementationData &impl = getImplementationData();
@@ -312,6 +345,12 @@ namespace Nuclex { namespace Support { namespace Threading {
       //
       Platform::LinuxFutexApi::PrivateFutexWakeAll(impl.FutexWord);
 
+      // Post any continuations that were waiting asynchronously for the countdown
+      AsyncWaitList::DispatchIfWaiting(
+        this->asyncWaitList,
+        [&impl]() { return (impl.Countdown.load(std::memory_order_acquire) == 0); }
+      );
+
     } // if latch counter decremented to zero
   }
 #endif
@@ -351,6 +390,12 @@ namespace Nuclex { namespace Support { namespace Threading {
       //
       Platform::WindowsSyncApi::WakeByAddressAll(impl.WaitWord);
 
+      // Post any continuations that were waiting asynchronously for the countdown
+      AsyncWaitList::DispatchIfWaiting(
+        this->asyncWaitList,
+        [&impl]() { return (impl.Countdown.load(std::memory_order_acquire) == 0); }
+      );
+
     } // if latch counter decremented to zero
   }
 #endif
@@ -395,10 +440,31 @@ namespace Nuclex { namespace Support { namespace Threading {
   }
 #endif
   // ------------------------------------------------------------------------------------------- //
+#if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+  void Latch::WaitAsync(ThreadPool &threadPool, std::function<void()> continuation) {
+    PlatformDependentImplementationData &impl = getImplementationData();
+
+    AsyncWaitList::GetOrCreate(this->asyncWaitList).Add(
+      threadPool, std::move(continuation),
+      [&impl]() { return (impl.Countdown.load(std::memory_order_acquire) == 0); }
+    );
+  }
+#endif
+  // ------------------------------------------------------------------------------------------- //
 #if defined(NUCLEX_SUPPORT_LINUX)
   void Latch::Wait() const {
     const PlatformDependentImplementationData &impl = getImplementationData();
 
+    // Busy-wait for a short while before going to sleep. If the latch reaches zero
+    // within microseconds, this saves the system calls on both sides.
+    bool wasOpened = impl.Spinner.SpinUntil(
+      [&impl]() { return (impl.Countdown.load(std::memory_order_consume) == 0); }
+    );
+    if(wasOpened) {
+      return; // Latch reached zero while spinning
+    }
+    AdaptiveSpinner::SleepMeasurement sleepMeasurement(impl.Spinner);
+
     // Loop until we find the latch to be open
     std::size_t safeCountdown = impl.Countdown.load(std::memory_order_consume);
     for(;;) {
@@ -440,6 +506,16 @@ namespace Nuclex { namespace Support { namespace Threading {
   void Latch::Wait() const {
     const PlatformDependentImplementationData &impl = getImplementationData();
 
+    // Busy-wait for a short while before going to sleep. If the latch reaches zero
+    // within microseconds, this saves the system calls on both sides.
+    bool wasOpened = impl.Spinner.SpinUntil(
+      [&impl]() { return (impl.Countdown.load(std::memory_order_consume) == 0); }
+    );
+    if(wasOpened) {
+      return; // Latch reached zero while spinning
+    }
+    AdaptiveSpinner::SleepMeasurement sleepMeasurement(impl.Spinner);
+
     // Loop until we can snatch an available ticket
     std::size_t safeCountdown = impl.Countdown.load(std::memory_order_consume);
     for(;;) {
@@ -516,6 +592,18 @@ namespace Nuclex { namespace Support { namespace Threading {
   bool Latch::WaitFor(const std::chrono::microseconds &patience) const {
     const PlatformDependentImplementationData &impl = getImplementationData();
 
+    // Busy-wait for a short while before going to sleep. If the latch reaches zero
+    // within microseconds, this saves the system calls on both sides.
+    if(patience.count() > 0) {
+      bool wasOpened = impl.Spinner.SpinUntil(
+        [&impl]() { return (impl.Countdown.load(std::memory_order_consume) == 0); }
+      );
+      if(wasOpened) {
+        return true; // Latch reached zero while spinning
+      }
+    }
+    AdaptiveSpinner::SleepMeasurement sleepMeasurement(impl.Spinner, patience.count() > 0);
+
     // Obtain the starting time, but don't do anything with it yet (the futex
     // wait is relative, so unless we get EINTR, the time isn't even needed)
     struct ::timespec startTime;
@@ -577,6 +665,18 @@ namespace Nuclex { namespace Support { namespace Threading {
   bool Latch::WaitFor(const std::chrono::microseconds &patience) const {
     const PlatformDependentImplementationData &impl = getImplementationData();
 
+    // Busy-wait for a short while before going to sleep. If the latch reaches zero
+    // within microseconds, this saves the system calls on both sides.
+    if(patience.count() > 0) {
+      bool wasOpened = impl.Spinner.SpinUntil(
+        [&impl]() { return (impl.Countdown.load(std::memory_order_consume) == 0); }
+      );
+      if(wasOpened) {
+        return true; // Latch reached zero while spinning
+      }
+    }
+    AdaptiveSpinner::SleepMeasurement sleepMeasurement(impl.Spinner, patience.count() > 0);
+
     // Query the tick counter, but don't do anything with it yet (the wait time is
     // relative, so unless we get a spurious wait, the tick counter isn't even needed)
     std::chrono::milliseconds startTickCount(::GetTickCount64());
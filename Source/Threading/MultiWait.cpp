@@ -0,0 +1,292 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the library is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_SUPPORT_SOURCE 1
+
+#include "Nuclex/Support/Threading/MultiWait.h"
+
+#if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+
+#include "Nuclex/Support/Threading/Gate.h" // for Gate
+#include "Nuclex/Support/Threading/Semaphore.h" // for Semaphore
+#include "Nuclex/Support/Threading/StopToken.h" // for StopToken
+#include "Nuclex/Support/ScopeGuard.h" // for ON_SCOPE_EXIT
+
+#include "MultiWaitNotifier.h" // for MultiWaitNotifier
+#include "WaitWord.h" // for WaitWord
+
+#include <atomic> // for std::atomic
+#include <algorithm> // for std::fill()
+#include <vector> // for std::vector
+
+namespace {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Calculates the time remaining until the specified deadline</summary>
+  /// <param name="deadline">Deadline for which the remaining time will be calculated</param>
+  /// <returns>The remaining time, rounded up to whole microseconds</returns>
+  std::chrono::microseconds getRemainingTime(
+    const std::chrono::steady_clock::time_point &deadline
+  ) {
+    std::chrono::steady_clock::duration remaining = (
+      deadline - std::chrono::steady_clock::now()
+    );
+    if(remaining <= std::chrono::steady_clock::duration::zero()) {
+      return std::chrono::microseconds::zero();
+    }
+
+    return std::chrono::ceil<std::chrono::microseconds>(remaining);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+}
+
+namespace Nuclex { namespace Support { namespace Threading {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::size_t MultiWait::WaitAny(const Target *targets, std::size_t targetCount) {
+    return waitAny(targets, targetCount, nullptr);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::size_t MultiWait::WaitAnyFor(
+    const Target *targets, std::size_t targetCount, const std::chrono::microseconds &patience
+  ) {
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + patience;
+    return waitAny(targets, targetCount, &deadline);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void MultiWait::WaitAll(const Target *targets, std::size_t targetCount) {
+    waitAll(targets, targetCount, nullptr);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  bool MultiWait::WaitAllFor(
+    const Target *targets, std::size_t targetCount, const std::chrono::microseconds &patience
+  ) {
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + patience;
+    return waitAll(targets, targetCount, &deadline);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::size_t MultiWait::waitAny(
+    const Target *targets,
+    std::size_t targetCount,
+    const std::chrono::steady_clock::time_point *deadline
+  ) {
+
+    // Fast path: if any of the targets lets us through already, there's no need
+    // to set up anything for sleeping
+    for(std::size_t index = 0; index < targetCount; ++index) {
+      if(tryPass(targets[index])) {
+        return index;
+      }
+    }
+
+#if defined(NUCLEX_SUPPORT_LINUX)
+    // If the kernel can sleep on all the wait words at once, do that. Each target's
+    // wait word is 0 while the target blocks, so any change to it wakes us up.
+    if(
+      (targetCount <= Platform::LinuxFutexApi::MaximumWaitTargetCount) &&
+      Platform::LinuxFutexApi::IsPrivateFutexWaitMultipleSupported()
+    ) {
+      Platform::LinuxFutexApi::WaitTarget waitTargets[
+        Platform::LinuxFutexApi::MaximumWaitTargetCount
+      ];
+      for(;;) {
+        if(deadline != nullptr) {
+          if(std::chrono::steady_clock::now() >= *deadline) {
+            return TimedOut;
+          }
+        }
+
+        // Collect the wait words. A semaphore may notice that a ticket arrived while
+        // it was being prepared for waiting, in which case we try to take it right away.
+        bool isAnyTargetReady = false;
+        for(std::size_t index = 0; index < targetCount; ++index) {
+          waitTargets[index].FutexWord = prepareToWait(targets[index]);
+          if(waitTargets[index].FutexWord == nullptr) {
+            isAnyTargetReady = true;
+            break;
+          }
+          waitTargets[index].ComparisonValue = 0;
+        }
+
+        // Sleep until any of the wait words changes. All wake-ups, including spurious
+        // ones, lead to the targets being checked again.
+        if(likely(!isAnyTargetReady)) {
+          if(deadline == nullptr) {
+            Platform::LinuxFutexApi::PrivateFutexWaitMultiple(waitTargets, targetCount);
+          } else {
+            std::chrono::microseconds remaining = getRemainingTime(*deadline);
+            struct ::timespec patience;
+            patience.tv_sec = static_cast<std::time_t>(remaining.count() / 1000000);
+            patience.tv_nsec = static_cast<long>((remaining.count() % 1000000) * 1000);
+            Platform::LinuxFutexApi::PrivateFutexWaitMultiple(
+              waitTargets, targetCount, patience
+            );
+          }
+        }
+
+        for(std::size_t index = 0; index < targetCount; ++index) {
+          if(tryPass(targets[index])) {
+            return index;
+          }
+        }
+      } // for(;;)
+    }
+#endif
+
+    // No way to sleep on several wait words at once. Register as a multi-waiter so that
+    // the targets bump the global generation word when they let threads through.
+    MultiWaitNotifier::WaiterCount.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    ON_SCOPE_EXIT {
+      MultiWaitNotifier::WaiterCount.fetch_sub(1, std::memory_order_relaxed);
+    };
+
+    for(;;) {
+      std::uint32_t generation = MultiWaitNotifier::Generation.load(std::memory_order_acquire);
+
+      // Check the targets after sampling the generation, so a target changing its state
+      // between our check and going to sleep has changed the generation, too
+      for(std::size_t index = 0; index < targetCount; ++index) {
+        if(tryPass(targets[index])) {
+          return index;
+        }
+      }
+
+      if(deadline == nullptr) {
+        WaitWord::Wait(MultiWaitNotifier::Generation, generation);
+      } else {
+        std::chrono::microseconds remaining = getRemainingTime(*deadline);
+        if(remaining == std::chrono::microseconds::zero()) {
+          return TimedOut;
+        }
+        WaitWord::WaitFor(MultiWaitNotifier::Generation, generation, remaining);
+      }
+    } // for(;;)
+
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  bool MultiWait::waitAll(
+    const Target *targets,
+    std::size_t targetCount,
+    const std::chrono::steady_clock::time_point *deadline
+  ) {
+
+    // Semaphore tickets are taken as soon as they're available and held until either
+    // all targets let us through or the wait times out
+    std::vector<bool> isTicketHeld(targetCount, false);
+    ON_SCOPE_EXIT {
+      for(std::size_t index = 0; index < targetCount; ++index) {
+        if(isTicketHeld[index]) {
+          static_cast<Semaphore *>(const_cast<void *>(targets[index].object))->Post();
+        }
+      }
+    };
+
+    for(;;) {
+
+      // Wait for each target that doesn't let us through yet. Gates and stop tokens
+      // are only observed, so a gate may close again while we wait for the others.
+      for(std::size_t index = 0; index < targetCount; ++index) {
+        if(isTicketHeld[index]) {
+          continue;
+        }
+
+        if(waitAny(targets + index, 1, deadline) == TimedOut) {
+          return false; // Scope exit gives back the tickets held so far
+        }
+        if(targets[index].kind == Target::Kind::Semaphore) {
+          isTicketHeld[index] = true;
+        }
+      }
+
+      // Now check whether all the gates and stop tokens are still passable. Stop tokens
+      // never revert, but a gate may have been closed while we were waiting.
+      bool areAllTargetsPassable = true;
+      for(std::size_t index = 0; index < targetCount; ++index) {
+        if(!isTicketHeld[index]) {
+          if(!tryPass(targets[index])) {
+            areAllTargetsPassable = false;
+            break;
+          }
+        }
+      }
+      if(areAllTargetsPassable) {
+        break;
+      }
+
+    } // for(;;)
+
+    // The tickets are now owned by the caller, don't give them back on scope exit
+    std::fill(isTicketHeld.begin(), isTicketHeld.end(), false);
+    return true;
+
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  bool MultiWait::tryPass(const Target &target) {
+    switch(target.kind) {
+      case Target::Kind::Gate: {
+        return static_cast<const Gate *>(target.object)->isOpen();
+      }
+      case Target::Kind::Semaphore: {
+        return static_cast<Semaphore *>(const_cast<void *>(target.object))->tryDecrement();
+      }
+      default: {
+        return static_cast<const StopToken *>(target.object)->IsCanceled();
+      }
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  const volatile std::uint32_t *MultiWait::prepareToWait(const Target &target) {
+    switch(target.kind) {
+      case Target::Kind::Gate: {
+        return &static_cast<const Gate *>(target.object)->getWaitWord();
+      }
+      case Target::Kind::Semaphore: {
+        return static_cast<Semaphore *>(const_cast<void *>(target.object))->prepareToWait();
+      }
+      default: {
+        return &WaitWord::ToVolatileWord(static_cast<const StopToken *>(target.object)->Canceled);
+      }
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Threading
+
+#endif // defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
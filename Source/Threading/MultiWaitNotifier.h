@@ -0,0 +1,78 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+#ifndef NUCLEX_SUPPORT_THREADING_MULTIWAITNOTIFIER_H
+#define NUCLEX_SUPPORT_THREADING_MULTIWAITNOTIFIER_H
+
+#include "Nuclex/Support/Config.h"
+
+#if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+
+#include <atomic> // for std::atomic
+#include <cstddef> // for std::size_t
+#include <cstdint> // for std::uint32_t
+
+namespace Nuclex { namespace Support { namespace Threading {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Wakes threads waiting on several synchronization primitives at once</summary>
+  /// <remarks>
+  ///   <para>
+  ///     Where the operating system can't sleep on several wait words at once (Windows and
+  ///     Linux kernels older than 5.16), <see cref="MultiWait" /> sleeps on a single global
+  ///     generation word instead. Every primitive that can be waited on through it calls
+  ///     <see cref="NotifyIfWaiting" /> after it changed to a state that lets threads
+  ///     through, which bumps the generation and wakes all multi-waiters to re-check.
+  ///   </para>
+  ///   <para>
+  ///     While nobody is waiting this way, notifying costs a fence and a load. The waiter
+  ///     first registers, then checks the primitives, while the primitive first changes its
+  ///     state, then checks for registered waiters, so one of them always sees the other.
+  ///   </para>
+  /// </remarks>
+  class MultiWaitNotifier {
+
+    /// <summary>Wakes all threads in a multi-object wait if there are any</summary>
+    public: static void NotifyIfWaiting() {
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if(likely(WaiterCount.load(std::memory_order_relaxed) == 0)) {
+        return;
+      }
+
+      notifyWaiters();
+    }
+
+    /// <summary>Bumps the generation word and wakes all threads sleeping on it</summary>
+    private: static void notifyWaiters();
+
+    /// <summary>Incremented each time the state of any watched primitive changes</summary>
+    public: static std::atomic<std::uint32_t> Generation;
+    /// <summary>Number of threads currently waiting on the generation word</summary>
+    public: static std::atomic<std::size_t> WaiterCount;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Threading
+
+#endif // defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+
+#endif // NUCLEX_SUPPORT_THREADING_MULTIWAITNOTIFIER_H
@@ -0,0 +1,172 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the library is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_SUPPORT_SOURCE 1
+
+#include "Nuclex/Support/Threading/Mutex.h"
+
+#if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+
+#include "AdaptiveSpinner.h" // for AdaptiveSpinner
+#include "WaitWord.h" // for WaitWord
+
+#include <atomic> // for std::atomic
+#include <algorithm> // for std::min()
+#include <limits> // for std::numeric_limits
+#include <new> // for placement new
+
+namespace {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Lock word value when the mutex is not locked</summary>
+  const constexpr std::uint32_t Unlocked = 0;
+
+  /// <summary>Lock word value when the mutex is locked and nobody is sleeping on it</summary>
+  const constexpr std::uint32_t Locked = 1;
+
+  /// <summary>Lock word value when the mutex is locked and threads may be sleeping</summary>
+  const constexpr std::uint32_t LockedWithWaiters = 2;
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // anonymous namespace
+
+namespace Nuclex { namespace Support { namespace Threading {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  // Implementation details only known on the library-internal side
+  struct Mutex::PlatformDependentImplementationData {
+
+    /// <summary>Initializes the lock word and spinner of the mutex</summary>
+    public: PlatformDependentImplementationData() :
+      LockWord(Unlocked),
+      Spinner() {}
+
+    /// <summary>Whether the mutex is locked and whether threads are sleeping on it</summary>
+    public: std::atomic<std::uint32_t> LockWord;
+    /// <summary>Lets waiting threads spin briefly before they go to sleep</summary>
+    public: AdaptiveSpinner Spinner;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+  Mutex::Mutex() {
+    static_assert(
+      sizeof(implementationDataBuffer) >= sizeof(PlatformDependentImplementationData),
+      u8"Private implementation data for Nuclex::Support::Threading::Mutex fits in buffer"
+    );
+    new(this->implementationDataBuffer) PlatformDependentImplementationData();
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  Mutex::~Mutex() {
+    getImplementationData().~PlatformDependentImplementationData();
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void Mutex::Lock() {
+    PlatformDependentImplementationData &impl = getImplementationData();
+
+    // Fast path, if the mutex is not locked, a single compare-and-swap takes it
+    std::uint32_t expected = Unlocked;
+    bool wasLocked = impl.LockWord.compare_exchange_strong(
+      expected, Locked, std::memory_order_acquire, std::memory_order_relaxed
+    );
+    if(likely(wasLocked)) {
+      return;
+    }
+
+    // Busy-wait for a short while before going to sleep. Critical sections are usually
+    // short, so there's a good chance the owner is about to unlock the mutex.
+    wasLocked = impl.Spinner.SpinUntil(
+      [&impl]() {
+        std::uint32_t unlocked = Unlocked;
+        return (
+          (impl.LockWord.load(std::memory_order_relaxed) == Unlocked) &&
+          impl.LockWord.compare_exchange_weak(
+            unlocked, Locked, std::memory_order_acquire, std::memory_order_relaxed
+          )
+        );
+      }
+    );
+    if(wasLocked) {
+      return;
+    }
+    AdaptiveSpinner::SleepMeasurement sleepMeasurement(impl.Spinner);
+
+    // Mark the mutex as having waiters, then sleep until it is unlocked. Whoever finds
+    // the mutex unlocked in the exchange owns it, but since there may be more threads
+    // sleeping, the lock word stays at 'locked with waiters', costing at most one
+    // unnecessary wake-up call when the mutex is unlocked again.
+    while(impl.LockWord.exchange(LockedWithWaiters, std::memory_order_acquire) != Unlocked) {
+      WaitWord::Wait(impl.LockWord, LockedWithWaiters);
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  bool Mutex::TryLock() {
+    PlatformDependentImplementationData &impl = getImplementationData();
+
+    std::uint32_t expected = Unlocked;
+    return impl.LockWord.compare_exchange_strong(
+      expected, Locked, std::memory_order_acquire, std::memory_order_relaxed
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void Mutex::Unlock() {
+    PlatformDependentImplementationData &impl = getImplementationData();
+
+    std::uint32_t previous = impl.LockWord.exchange(Unlocked, std::memory_order_release);
+    if(unlikely(previous == LockedWithWaiters)) {
+      WaitWord::WakeOne(impl.LockWord);
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void Mutex::SetMaximumSpinCount(std::size_t maximumSpinCount) {
+    getImplementationData().Spinner.SetMaximumSpinCount(
+      static_cast<std::uint32_t>(
+        std::min<std::size_t>(maximumSpinCount, std::numeric_limits<std::uint32_t>::max())
+      )
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  Mutex::PlatformDependentImplementationData &Mutex::getImplementationData() {
+    return *reinterpret_cast<PlatformDependentImplementationData *>(
+      this->implementationDataBuffer
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Threading
+
+#endif // defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
@@ -0,0 +1,267 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the library is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_SUPPORT_SOURCE 1
+
+#include "Nuclex/Support/Threading/ReaderWriterLock.h"
+
+#if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+
+#include "WaitWord.h" // for WaitWord
+
+#include <thread> // for std::thread::hardware_concurrency()
+
+namespace {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Writer word value when no writer holds or waits for the lock</summary>
+  const constexpr std::uint32_t NoWriter = 0;
+
+  /// <summary>Writer word value when a writer is present and no reader is sleeping</summary>
+  const constexpr std::uint32_t WriterPresent = 1;
+
+  /// <summary>Writer word value when a writer is present and readers may be sleeping</summary>
+  const constexpr std::uint32_t WriterPresentWithWaiters = 2;
+
+  /// <summary>Upper limit for the number of reader counters per lock</summary>
+  /// <remarks>
+  ///   Each counter takes up a cache line and writers have to check all of them,
+  ///   so on systems with huge numbers of cores, cores share counters beyond this.
+  /// </remarks>
+  const constexpr std::size_t MaximumReaderSlotCount = 256;
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Determines the number of reader counters to use for each lock</summary>
+  /// <returns>The number of reader counters, always a power of two</returns>
+  std::size_t getReaderSlotCount() {
+    static const std::size_t readerSlotCount = []() {
+      std::size_t processorCount = std::thread::hardware_concurrency();
+
+      std::size_t slotCount = 1;
+      while((slotCount < processorCount) && (slotCount < MaximumReaderSlotCount)) {
+        slotCount <<= 1;
+      }
+
+      return slotCount;
+    }();
+    return readerSlotCount;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Retrieves the slot number assigned to the calling thread</summary>
+  /// <returns>The slot number of the calling thread</returns>
+  /// <remarks>
+  ///   Threads are numbered in the order they first take a read lock. The number is
+  ///   fixed for the lifetime of the thread, so a thread always finds the counter it
+  ///   incremented, even if the operating system moved it to another CPU core while it
+  ///   was holding the read lock.
+  /// </remarks>
+  std::size_t getThreadSlotNumber() {
+    static std::atomic<std::size_t> nextThreadSlotNumber(0);
+    thread_local const std::size_t threadSlotNumber = (
+      nextThreadSlotNumber.fetch_add(1, std::memory_order_relaxed)
+    );
+    return threadSlotNumber;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // anonymous namespace
+
+namespace Nuclex { namespace Support { namespace Threading {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Reader counter padded to fill an entire cache line</summary>
+  struct alignas(64) ReaderWriterLock::ReaderSlot {
+
+    /// <summary>Initializes a new, empty reader counter</summary>
+    public: ReaderSlot() :
+      ReaderCount(0) {}
+
+    /// <summary>Number of readers currently holding the lock through this counter</summary>
+    public: std::atomic<std::size_t> ReaderCount;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+  ReaderWriterLock::ReaderWriterLock() :
+    readerSlots(new ReaderSlot[getReaderSlotCount()]),
+    readerSlotMask(getReaderSlotCount() - 1),
+    writerWord(NoWriter),
+    drainWord(0),
+    writerMutex() {}
+
+  // ------------------------------------------------------------------------------------------- //
+
+  ReaderWriterLock::~ReaderWriterLock() {
+    delete[] this->readerSlots;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void ReaderWriterLock::LockShared() {
+    std::atomic<std::size_t> &readerCount = getReaderCount();
+    for(;;) {
+
+      // Announce ourselves as a reader, then check for writers. A writer does the same
+      // in reverse, so either we see the writer or the writer sees us (or both).
+      readerCount.fetch_add(1, std::memory_order_seq_cst);
+      if(likely(this->writerWord.load(std::memory_order_seq_cst) == NoWriter)) {
+        return;
+      }
+
+      // A writer is present, step back out of its way and wait until it is done
+      leaveReaderCount(readerCount);
+
+      std::uint32_t writerState = this->writerWord.load(std::memory_order_acquire);
+      while(writerState != NoWriter) {
+        if(writerState == WriterPresent) {
+          bool wasChanged = this->writerWord.compare_exchange_weak(
+            writerState, WriterPresentWithWaiters,
+            std::memory_order_acquire, std::memory_order_acquire
+          );
+          if(!wasChanged) {
+            continue; // The writer may have left or another reader set the flag
+          }
+        }
+
+        WaitWord::Wait(this->writerWord, WriterPresentWithWaiters);
+        writerState = this->writerWord.load(std::memory_order_acquire);
+      }
+
+    } // for(;;)
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  bool ReaderWriterLock::TryLockShared() {
+    std::atomic<std::size_t> &readerCount = getReaderCount();
+
+    readerCount.fetch_add(1, std::memory_order_seq_cst);
+    if(likely(this->writerWord.load(std::memory_order_seq_cst) == NoWriter)) {
+      return true;
+    }
+
+    leaveReaderCount(readerCount);
+    return false;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void ReaderWriterLock::UnlockShared() {
+    leaveReaderCount(getReaderCount());
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void ReaderWriterLock::Lock() {
+    this->writerMutex.Lock();
+
+    // Raise the writer flag so new readers back off, then wait for the readers
+    // that are already inside to leave.
+    this->writerWord.store(WriterPresent, std::memory_order_seq_cst);
+    waitForReadersToDrain();
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  bool ReaderWriterLock::TryLock() {
+    if(!this->writerMutex.TryLock()) {
+      return false;
+    }
+
+    this->writerWord.store(WriterPresent, std::memory_order_seq_cst);
+    for(std::size_t index = 0; index <= this->readerSlotMask; ++index) {
+      std::size_t readerCount = this->readerSlots[index].ReaderCount.load(
+        std::memory_order_seq_cst
+      );
+      if(readerCount != 0) {
+        Unlock(); // Also wakes up any readers that backed off in the meantime
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void ReaderWriterLock::Unlock() {
+    std::uint32_t previousState = this->writerWord.exchange(
+      NoWriter, std::memory_order_seq_cst
+    );
+    if(previousState == WriterPresentWithWaiters) {
+      WaitWord::WakeAll(this->writerWord);
+    }
+
+    this->writerMutex.Unlock();
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::atomic<std::size_t> &ReaderWriterLock::getReaderCount() {
+    return this->readerSlots[getThreadSlotNumber() & this->readerSlotMask].ReaderCount;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void ReaderWriterLock::leaveReaderCount(std::atomic<std::size_t> &readerCount) {
+    readerCount.fetch_sub(1, std::memory_order_seq_cst);
+
+    // If a writer is present, it may be sleeping until the readers have drained.
+    // Changing the drain word after the decrement guarantees that a writer which
+    // still saw our count will either see the changed drain word or be woken up.
+    if(unlikely(this->writerWord.load(std::memory_order_seq_cst) != NoWriter)) {
+      this->drainWord.fetch_add(1, std::memory_order_seq_cst);
+      WaitWord::WakeOne(this->drainWord);
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void ReaderWriterLock::waitForReadersToDrain() {
+    for(std::size_t index = 0; index <= this->readerSlotMask; ++index) {
+      const std::atomic<std::size_t> &readerCount = this->readerSlots[index].ReaderCount;
+      for(;;) {
+
+        // Take note of the drain word before looking at the counter. If a reader
+        // leaves after we looked, it will have changed the drain word and the wait
+        // returns immediately.
+        std::uint32_t drainState = this->drainWord.load(std::memory_order_seq_cst);
+        if(readerCount.load(std::memory_order_seq_cst) == 0) {
+          break;
+        }
+
+        WaitWord::Wait(this->drainWord, drainState);
+
+      } // for(;;)
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Threading
+
+#endif // defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
@@ -0,0 +1,126 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the library is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_SUPPORT_SOURCE 1
+#include "ReclamationRecord.h"
+
+namespace {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Hands the reclamation record of a thread back when the thread ends</summary>
+  class ThreadReclamationRecord {
+
+    /// <summary>Releases the reclamation record if the thread had acquired one</summary>
+    public: ~ThreadReclamationRecord() {
+      if(this->Record != nullptr) {
+        Nuclex::Support::Threading::ReclamationRecord::Release(this->Record);
+      }
+    }
+
+    /// <summary>Record owned by the thread, null until the thread first needs one</summary>
+    public: Nuclex::Support::Threading::ReclamationRecord *Record = nullptr;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Reclamation record of the calling thread</summary>
+  thread_local ThreadReclamationRecord threadReclamationRecord;
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // anonymous namespace
+
+namespace Nuclex { namespace Support { namespace Threading {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::atomic<ReclamationRecord *> ReclamationRecord::firstRecord(nullptr);
+
+  // ------------------------------------------------------------------------------------------- //
+
+  ReclamationRecord::ReclamationRecord() :
+    Epoch(0),
+    EpochNestingDepth(0),
+    Hazards(),
+    FreeHazardSlotMask((std::uint32_t(1) << HazardSlotCount) - 1),
+    IsInUse(true),
+    Next(nullptr) {
+    for(std::size_t index = 0; index < HazardSlotCount; ++index) {
+      this->Hazards[index].store(nullptr, std::memory_order_relaxed);
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  ReclamationRecord &ReclamationRecord::GetForCurrentThread() {
+    ReclamationRecord *record = threadReclamationRecord.Record;
+    if(unlikely(record == nullptr)) {
+      record = Acquire();
+      threadReclamationRecord.Record = record;
+    }
+
+    return *record;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  ReclamationRecord *ReclamationRecord::Acquire() {
+    ReclamationRecord *record = firstRecord.load(std::memory_order_acquire);
+    while(record != nullptr) {
+      if(!record->IsInUse.load(std::memory_order_relaxed)) {
+        bool wasInUse = false;
+        if(record->IsInUse.compare_exchange_strong(wasInUse, true, std::memory_order_acquire)) {
+          return record;
+        }
+      }
+      record = record->Next;
+    }
+
+    record = new ReclamationRecord();
+    ReclamationRecord *first = firstRecord.load(std::memory_order_relaxed);
+    do {
+      record->Next = first;
+    } while(
+      !firstRecord.compare_exchange_weak(
+        first, record, std::memory_order_release, std::memory_order_relaxed
+      )
+    );
+
+    return record;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void ReclamationRecord::Release(ReclamationRecord *record) noexcept {
+    record->Epoch.store(0, std::memory_order_release);
+    record->EpochNestingDepth = 0;
+    for(std::size_t index = 0; index < HazardSlotCount; ++index) {
+      record->Hazards[index].store(nullptr, std::memory_order_release);
+    }
+    record->FreeHazardSlotMask = (std::uint32_t(1) << HazardSlotCount) - 1;
+
+    record->IsInUse.store(false, std::memory_order_release);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Threading
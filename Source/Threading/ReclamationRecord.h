@@ -0,0 +1,172 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+#ifndef NUCLEX_SUPPORT_THREADING_RECLAMATIONRECORD_H
+#define NUCLEX_SUPPORT_THREADING_RECLAMATIONRECORD_H
+
+#include "Nuclex/Support/Config.h"
+
+#include <atomic> // for std::atomic
+#include <cstddef> // for std::size_t
+#include <cstdint> // for std::uint64_t, std::uint32_t
+
+namespace Nuclex { namespace Support { namespace Threading {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Instance that has been retired and waits until it can be freed</summary>
+  struct RetiredInstance {
+
+    /// <summary>Instance that will be freed</summary>
+    public: void *Instance;
+    /// <summary>Method that will be called to free the instance</summary>
+    public: void (*Deleter)(void *);
+    /// <summary>Epoch the instance was retired in, only used by the epoch domain</summary>
+    public: std::uint64_t Epoch;
+    /// <summary>Next instance in the list of retired instances</summary>
+    public: RetiredInstance *Next;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Announces what a thread is currently reading to the reclaiming threads</summary>
+  /// <remarks>
+  ///   <para>
+  ///     Each thread that reads through an <see cref="EpochDomain" /> or protects pointers
+  ///     through a <see cref="HazardPointerDomain" /> owns one of these records and is
+  ///     the only one ever writing to it, so readers don't contend with each other. Threads
+  ///     reclaiming memory scan the records of all threads.
+  ///   </para>
+  ///   <para>
+  ///     Records are never freed. When a thread ends, its record is handed back and picked
+  ///     up by the next thread that needs one, so the list of records only grows up to
+  ///     the highest number of reading threads that existed at the same time.
+  ///   </para>
+  /// </remarks>
+  class alignas(64) ReclamationRecord {
+
+    /// <summary>Number of hazard pointers each record can hold</summary>
+    public: static const constexpr std::size_t HazardSlotCount = 8;
+
+    /// <summary>Initializes a new reclamation record</summary>
+    public: ReclamationRecord();
+
+    /// <summary>Retrieves the first record in the list of all records</summary>
+    /// <returns>The first reclamation record or null if none exist yet</returns>
+    public: static ReclamationRecord *GetFirst() noexcept {
+      return firstRecord.load(std::memory_order_acquire);
+    }
+
+    /// <summary>Retrieves the record owned by the calling thread</summary>
+    /// <returns>The calling thread's reclamation record</returns>
+    public: static ReclamationRecord &GetForCurrentThread();
+
+    /// <summary>Takes an unused record or creates a new one</summary>
+    /// <returns>A record now owned by the caller</returns>
+    /// <remarks>
+    ///   This is used for records that don't belong to a thread, such as when a thread
+    ///   needs more hazard slots than its own record has.
+    /// </remarks>
+    public: static ReclamationRecord *Acquire();
+
+    /// <summary>Hands a record back so it can be reused</summary>
+    /// <param name="record">Record that will be handed back</param>
+    public: static void Release(ReclamationRecord *record) noexcept;
+
+    /// <summary>Takes a hazard slot from the record, if any are left</summary>
+    /// <returns>A free hazard slot or null if all slots are taken</returns>
+    /// <remarks>Must only be called by the record's owner</remarks>
+    public: std::atomic<const void *> *TryTakeHazardSlot() noexcept {
+      if(this->FreeHazardSlotMask == 0) {
+        return nullptr;
+      }
+
+      std::size_t index = 0;
+      while((this->FreeHazardSlotMask & (std::uint32_t(1) << index)) == 0) {
+        ++index;
+      }
+      this->FreeHazardSlotMask &= ~(std::uint32_t(1) << index);
+
+      return &this->Hazards[index];
+    }
+
+    /// <summary>Gives a hazard slot taken from the record back</summary>
+    /// <param name="slot">Hazard slot that will be given back</param>
+    /// <remarks>Must only be called by the record's owner</remarks>
+    public: void GiveBackHazardSlot(std::atomic<const void *> *slot) noexcept {
+      slot->store(nullptr, std::memory_order_release);
+      this->FreeHazardSlotMask |= std::uint32_t(1) << (slot - this->Hazards);
+    }
+
+    /// <summary>Epoch the owner entered its read section in, 0 if not reading</summary>
+    public: std::atomic<std::uint64_t> Epoch;
+    /// <summary>Number of read sections the owner is currently in</summary>
+    public: std::size_t EpochNestingDepth;
+    /// <summary>Pointers the owner is accessing and that must not be freed</summary>
+    public: std::atomic<const void *> Hazards[HazardSlotCount];
+    /// <summary>Bit mask of the hazard slots that are not taken</summary>
+    public: std::uint32_t FreeHazardSlotMask;
+    /// <summary>Whether the record currently has an owner</summary>
+    public: std::atomic<bool> IsInUse;
+    /// <summary>Next record in the list of all records</summary>
+    public: ReclamationRecord *Next;
+
+    /// <summary>First record in the list of all records ever created</summary>
+    private: static std::atomic<ReclamationRecord *> firstRecord;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Frees a chain of retired instances</summary>
+  /// <param name="first">First instance in the chain, may be null</param>
+  inline void FreeRetiredInstances(RetiredInstance *first) noexcept {
+    while(first != nullptr) {
+      RetiredInstance *next = first->Next;
+      first->Deleter(first->Instance);
+      delete first;
+      first = next;
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Pushes a chain of retired instances onto a lock-free stack</summary>
+  /// <param name="stack">Head of the stack the chain will be pushed onto</param>
+  /// <param name="first">First instance in the chain</param>
+  /// <param name="last">Last instance in the chain</param>
+  inline void PushRetiredInstances(
+    std::atomic<RetiredInstance *> &stack, RetiredInstance *first, RetiredInstance *last
+  ) noexcept {
+    RetiredInstance *head = stack.load(std::memory_order_relaxed);
+    do {
+      last->Next = head;
+    } while(
+      !stack.compare_exchange_weak(
+        head, first, std::memory_order_release, std::memory_order_relaxed
+      )
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Threading
+
+#endif // NUCLEX_SUPPORT_THREADING_RECLAMATIONRECORD_H
@@ -37,6 +37,14 @@ limitations under the License.
 
 #include <atomic> // for std::atomic
 #include <cassert> // for assert()
+#include <algorithm> // for std::min()
+#include <limits> // for std::numeric_limits
+
+#if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+#include "AsyncWaitList.h" // for AsyncWaitList
+#include "AdaptiveSpinner.h" // for AdaptiveSpinner
+#include "MultiWaitNotifier.h" // for MultiWaitNotifier
+#endif
 
 #if !defined(NUCLEX_SUPPORT_LINUX) && !defined(NUCLEX_SUPPORT_WINDOWS)
   // Just some safety checks to make sure pthread_condattr_setclock() is available.
@@ -73,6 +81,35 @@ limitations under the License.
 // report ETIMEOUT after less than 1 ms.
 //
 
+#if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+namespace {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Takes a ticket from the semaphore if one is available</summary>
+  /// <typeparam name="TImplementationData">Semaphore's private implementation data</typeparam>
+  /// <param name="impl">Implementation data holding the admit counter</param>
+  /// <returns>True if a ticket was taken, false if none were available</returns>
+  template<typename TImplementationData>
+  bool trySnatchTicket(TImplementationData &impl) {
+    std::size_t admitCounter = impl.AdmitCounter.load(std::memory_order_consume);
+    while(admitCounter > 0) {
+      bool success = impl.AdmitCounter.compare_exchange_weak(
+        admitCounter, admitCounter - 1, std::memory_order_release
+      );
+      if(success) {
+        return true; // We snatched a ticket!
+      }
+    }
+
+    return false;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // anonymous namespace
+#endif // defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+
 namespace Nuclex { namespace Support { namespace Threading {
 
   // ------------------------------------------------------------------------------------------- //
@@ -101,6 +138,10 @@ namespace Nuclex { namespace Support { namespace Threading {
 #endif
     /// <summary>Available tickets, negative for each thread waiting for a ticket</summary>
     public: std::atomic<std::size_t> AdmitCounter;
+#if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+    /// <summary>Lets waiting threads spin briefly before they go to sleep</summary>
+    public: AdaptiveSpinner Spinner;
+#endif
 
   };
 
@@ -110,7 +151,8 @@ namespace Nuclex { namespace Support { namespace Threading {
     std::size_t initialCount
   ) :
     FutexWord(0),
-    AdmitCounter(initialCount) {}
+    AdmitCounter(initialCount),
+    Spinner() {}
 #endif
   // ------------------------------------------------------------------------------------------- //
 #if defined(NUCLEX_SUPPORT_WINDOWS)
@@ -118,7 +160,8 @@ namespace Nuclex { namespace Support { namespace Threading {
     std::size_t initialCount
   ) :
     WaitWord(0),
-    AdmitCounter(initialCount) {}
+    AdmitCounter(initialCount),
+    Spinner() {}
 #endif
   // ------------------------------------------------------------------------------------------- //
 #if !defined(NUCLEX_SUPPORT_LINUX) && !defined(NUCLEX_SUPPORT_WINDOWS) // -> Posix
@@ -181,17 +224,52 @@ namespace Nuclex { namespace Support { namespace Threading {
       u8"Private implementation data for Nuclex::Support::Threading::Process fits in buffer"
     );
     new(this->implementationDataBuffer) PlatformDependentImplementationData(initialCount);
+#if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+    this->asyncWaitList.store(nullptr, std::memory_order_relaxed);
+#endif
   }
 
   // ------------------------------------------------------------------------------------------- //
 
   Semaphore::~Semaphore() {
+#if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+    delete this->asyncWaitList.load(std::memory_order_acquire);
+#endif
     getImplementationData().~PlatformDependentImplementationData();
   }
 
   // ------------------------------------------------------------------------------------------- //
-#if defined(NUCLEX_SUPPORT_LINUX)
+
+  void Semaphore::SetMaximumSpinCount(std::size_t maximumSpinCount) {
+#if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+    getImplementationData().Spinner.SetMaximumSpinCount(
+      static_cast<std::uint32_t>(
+        std::min<std::size_t>(maximumSpinCount, std::numeric_limits<std::uint32_t>::max())
+      )
+    );
+#else
+    (void)maximumSpinCount; // The pthreads-based implementation always sleeps right away
+#endif
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+#if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
   void Semaphore::Post(std::size_t count /* = 1 */) {
+    admit(count);
+
+    // Hand tickets to any continuations that were waiting asynchronously. Tickets taken
+    // for continuations that could not be posted are returned without dispatching again.
+    PlatformDependentImplementationData &impl = getImplementationData();
+    AsyncWaitList::DispatchIfWaiting(
+      this->asyncWaitList,
+      [&impl]() { return trySnatchTicket(impl); },
+      [this]() { admit(1); }
+    );
+  }
+#endif
+  // ------------------------------------------------------------------------------------------- //
+#if defined(NUCLEX_SUPPORT_LINUX)
+  void Semaphore::admit(std::size_t count) {
     PlatformDependentImplementationData &impl = getImplementationData();
 
     // Increment the semaphore admit counter so for each posted ticket,
@@ -227,13 +305,14 @@ namespace Nuclex { namespace Support { namespace Threading {
       // re-check the semaphore's status and resume running
       //
       Platform::LinuxFutexApi::PrivateFutexWakeAll(impl.FutexWord);
+      MultiWaitNotifier::NotifyIfWaiting();
 
     } // if(previousAdmitCounter < 0)
   }
 #endif
   // ------------------------------------------------------------------------------------------- //
 #if defined(NUCLEX_SUPPORT_WINDOWS)
-  void Semaphore::Post(std::size_t count /* = 1 */) {
+  void Semaphore::admit(std::size_t count) {
     PlatformDependentImplementationData &impl = getImplementationData();
 
     // Increment the semaphore admit counter so for each posted ticket,
@@ -270,6 +349,7 @@ namespace Nuclex { namespace Support { namespace Threading {
       // the latch counter and resume running
       //
       Platform::WindowsSyncApi::WakeByAddressAll(impl.WaitWord);
+      MultiWaitNotifier::NotifyIfWaiting();
 
     } // if(previousAdmitCounter < 0)
   }
@@ -311,10 +391,76 @@ namespace Nuclex { namespace Support { namespace Threading {
   }
 #endif
   // ------------------------------------------------------------------------------------------- //
+#if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+  void Semaphore::WaitThenDecrementAsync(
+    ThreadPool &threadPool, std::function<void()> continuation
+  ) {
+    PlatformDependentImplementationData &impl = getImplementationData();
+
+    AsyncWaitList::GetOrCreate(this->asyncWaitList).Add(
+      threadPool, std::move(continuation),
+      [&impl]() { return trySnatchTicket(impl); },
+      [this]() { admit(1); }
+    );
+  }
+#endif
+  // ------------------------------------------------------------------------------------------- //
+#if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+  bool Semaphore::tryDecrement() {
+    return trySnatchTicket(getImplementationData());
+  }
+#endif
+  // ------------------------------------------------------------------------------------------- //
+#if defined(NUCLEX_SUPPORT_LINUX)
+  const volatile std::uint32_t *Semaphore::prepareToWait() {
+    PlatformDependentImplementationData &impl = getImplementationData();
+
+    // Same double-check as in WaitThenDecrement(): switch the futex word to 0, then
+    // make sure no ticket was posted before the switch, which would have been missed
+    if(__atomic_load_n(&impl.FutexWord, __ATOMIC_CONSUME) != 0) {
+      __atomic_store_n(&impl.FutexWord, 0, __ATOMIC_RELEASE); // 0 -> threads waiting
+      if(unlikely(impl.AdmitCounter.load(std::memory_order_consume) > 0)) {
+        __atomic_store_n(&impl.FutexWord, 1, __ATOMIC_RELEASE); // 1 -> tickets available
+        return nullptr;
+      }
+    }
+
+    return &impl.FutexWord;
+  }
+#endif
+  // ------------------------------------------------------------------------------------------- //
+#if defined(NUCLEX_SUPPORT_WINDOWS)
+  const volatile std::uint32_t *Semaphore::prepareToWait() {
+    PlatformDependentImplementationData &impl = getImplementationData();
+
+    // Same double-check as in WaitThenDecrement(): switch the wait word to 0, then
+    // make sure no ticket was posted before the switch, which would have been missed
+    if(impl.WaitWord != 0) {
+      impl.WaitWord = 0; // 0 -> threads waiting
+      std::atomic_thread_fence(std::memory_order::memory_order_release);
+
+      if(unlikely(impl.AdmitCounter.load(std::memory_order_consume) > 0)) {
+        impl.WaitWord = 1; // 1 -> tickets available
+        std::atomic_thread_fence(std::memory_order::memory_order_release);
+        return nullptr;
+      }
+    }
+
+    return &impl.WaitWord;
+  }
+#endif
+  // ------------------------------------------------------------------------------------------- //
 #if defined(NUCLEX_SUPPORT_LINUX)
   void Semaphore::WaitThenDecrement() {
     PlatformDependentImplementationData &impl = getImplementationData();
 
+    // Busy-wait for a short while first. If a ticket is posted within microseconds,
+    // this saves us from going to sleep and the posting thread from waking us up.
+    if(impl.Spinner.SpinUntil([&impl]() { return trySnatchTicket(impl); })) {
+      return;
+    }
+    AdaptiveSpinner::SleepMeasurement sleepMeasurement(impl.Spinner);
+
     // Loop until we can snatch an available ticket
     std::size_t initialAdmitCounter = impl.AdmitCounter.load(std::memory_order_consume);
     for(;;) {
@@ -333,8 +479,10 @@ namespace Nuclex { namespace Support { namespace Threading {
         }
       }
 
-      // If we observed some other thread snatching the last ticket and need to go
-      // to sleep, switch the futex word to the contested state.
+      // If the futex word still indicates that tickets are available (because we
+      // observed some other thread snatching the last ticket or because a ticket was
+      // taken without ever waiting), switch the futex word to the contested state.
+      // Otherwise, the futex wait below would return immediately, over and over.
       //
       // At this point, we're in a race with the Post() method which may just now
       // have incremented the ticket counter and be trying to pre-empt us by
@@ -342,7 +490,7 @@ namespace Nuclex { namespace Support { namespace Threading {
       //
       // Thus we need to do some double-checking here.
       //
-      if(initialAdmitCounter > 0) {
+      if(__atomic_load_n(&impl.FutexWord, __ATOMIC_CONSUME) != 0) {
         __atomic_store_n(&impl.FutexWord, 0, __ATOMIC_RELEASE); // 0 -> threads waiting
         initialAdmitCounter = impl.AdmitCounter.load(std::memory_order_consume);
         if(unlikely(initialAdmitCounter > 0)) {
@@ -383,6 +531,13 @@ namespace Nuclex { namespace Support { namespace Threading {
   void Semaphore::WaitThenDecrement() {
     PlatformDependentImplementationData &impl = getImplementationData();
 
+    // Busy-wait for a short while first. If a ticket is posted within microseconds,
+    // this saves us from going to sleep and the posting thread from waking us up.
+    if(impl.Spinner.SpinUntil([&impl]() { return trySnatchTicket(impl); })) {
+      return;
+    }
+    AdaptiveSpinner::SleepMeasurement sleepMeasurement(impl.Spinner);
+
     // Loop until we can snatch an available ticket
     std::size_t initialAdmitCounter = impl.AdmitCounter.load(std::memory_order_consume);
     for(;;) {
@@ -401,8 +556,10 @@ namespace Nuclex { namespace Support { namespace Threading {
         }
       }
 
-      // If we observed some other thread snatching the last ticket and need to go
-      // to sleep, switch the futex word to the contested state.
+      // If the futex word still indicates that tickets are available (because we
+      // observed some other thread snatching the last ticket or because a ticket was
+      // taken without ever waiting), switch the futex word to the contested state.
+      // Otherwise, the futex wait below would return immediately, over and over.
       //
       // At this point, we're in a race with the Post() method which may just now
       // have incremented the ticket counter and be trying to pre-empt us by
@@ -410,7 +567,7 @@ namespace Nuclex { namespace Support { namespace Threading {
       //
       // Thus we need to do some double-checking here.
       //
-      if(initialAdmitCounter > 0) {
+      if(impl.WaitWord != 0) {
         impl.WaitWord = 0; // 0 -> threads waiting
         std::atomic_thread_fence(std::memory_order::memory_order_release);
 
@@ -493,6 +650,15 @@ namespace Nuclex { namespace Support { namespace Threading {
   bool Semaphore::WaitForThenDecrement(const std::chrono::microseconds &patience)  {
     PlatformDependentImplementationData &impl = getImplementationData();
 
+    // Busy-wait for a short while first. If a ticket is posted within microseconds,
+    // this saves us from going to sleep and the posting thread from waking us up.
+    if(patience.count() > 0) {
+      if(impl.Spinner.SpinUntil([&impl]() { return trySnatchTicket(impl); })) {
+        return true;
+      }
+    }
+    AdaptiveSpinner::SleepMeasurement sleepMeasurement(impl.Spinner, patience.count() > 0);
+
     // Obtain the starting time, but don't do anything with it yet (the futex
     // wait is relative, so unless we get EINTR, the time isn't even needed)
     struct ::timespec startTime;
@@ -523,8 +689,10 @@ namespace Nuclex { namespace Support { namespace Threading {
         }
       }
 
-      // If we observed some other thread snatching the last ticket and need to go
-      // to sleep, switch the futex word to the contested state.
+      // If the futex word still indicates that tickets are available (because we
+      // observed some other thread snatching the last ticket or because a ticket was
+      // taken without ever waiting), switch the futex word to the contested state.
+      // Otherwise, the futex wait below would return immediately, over and over.
       //
       // At this point, we're in a race with the Post() method which may just now
       // have incremented the ticket counter and be trying to pre-empt us by
@@ -532,7 +700,7 @@ namespace Nuclex { namespace Support { namespace Threading {
       //
       // Thus we need to do some double-checking here.
       //
-      if(initialAdmitCounter > 0) {
+      if(__atomic_load_n(&impl.FutexWord, __ATOMIC_CONSUME) != 0) {
         __atomic_store_n(&impl.FutexWord, 0, __ATOMIC_RELEASE); // 0 -> threads waiting
         initialAdmitCounter = impl.AdmitCounter.load(std::memory_order_consume);
         if(unlikely(initialAdmitCounter > 0)) {
@@ -592,6 +760,15 @@ namespace Nuclex { namespace Support { namespace Threading {
   bool Semaphore::WaitForThenDecrement(const std::chrono::microseconds &patience)  {
     PlatformDependentImplementationData &impl = getImplementationData();
 
+    // Busy-wait for a short while first. If a ticket is posted within microseconds,
+    // this saves us from going to sleep and the posting thread from waking us up.
+    if(patience.count() > 0) {
+      if(impl.Spinner.SpinUntil([&impl]() { return trySnatchTicket(impl); })) {
+        return true;
+      }
+    }
+    AdaptiveSpinner::SleepMeasurement sleepMeasurement(impl.Spinner, patience.count() > 0);
+
     // Query the tick counter, but don't do anything with it yet (the wait time is
     // relative, so unless we get a spurious wait, the tick counter isn't even needed)
     std::chrono::milliseconds startTickCount(::GetTickCount64());
@@ -619,8 +796,10 @@ namespace Nuclex { namespace Support { namespace Threading {
         }
       }
 
-      // If we observed some other thread snatching the last ticket and need to go
-      // to sleep, switch the futex word to the contested state.
+      // If the futex word still indicates that tickets are available (because we
+      // observed some other thread snatching the last ticket or because a ticket was
+      // taken without ever waiting), switch the futex word to the contested state.
+      // Otherwise, the futex wait below would return immediately, over and over.
       //
       // At this point, we're in a race with the Post() method which may just now
       // have incremented the ticket counter and be trying to pre-empt us by
@@ -628,7 +807,7 @@ namespace Nuclex { namespace Support { namespace Threading {
       //
       // Thus we need to do some double-checking here.
       //
-      if(initialAdmitCounter > 0) {
+      if(impl.WaitWord != 0) {
         impl.WaitWord = 0; // 0 -> threads waiting
         std::atomic_thread_fence(std::memory_order::memory_order_release);
 
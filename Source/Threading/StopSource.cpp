@@ -19,12 +19,33 @@ limitations under the License.
 
 // If the library is compiled as a DLL, this ensures symbols are exported
 #define NUCLEX_SUPPORT_SOURCE 1
-
 #include "Nuclex/Support/Threading/StopSource.h"
 
-// --------------------------------------------------------------------------------------------- //
+#if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+#include "WaitWord.h" // for WaitWord
+#include "MultiWaitNotifier.h" // for MultiWaitNotifier
+#endif
+
+#include <cassert> // for assert()
+
+namespace Nuclex { namespace Support { namespace Threading {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void StopSource::Cancel(const std::string &reason /* = std::string() */) {
+    assert((IsCanceled() == false) && u8"Cancellation is triggered only once");
+
+    this->CancellationReason = reason;
+    std::atomic_thread_fence(std::memory_order::memory_order_release);
+    this->Canceled.store(1, std::memory_order::memory_order_relaxed);
+
+#if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+    // Wake up any threads waiting for the cancellation through MultiWait
+    WaitWord::WakeAll(this->Canceled);
+    MultiWaitNotifier::NotifyIfWaiting();
+#endif
+  }
 
-// This file is only here to guarantee that its associated header has no hidden
-// dependencies and can be included on its own
+  // ------------------------------------------------------------------------------------------- //
 
-// --------------------------------------------------------------------------------------------- //
+}}} // namespace Nuclex::Support::Threading
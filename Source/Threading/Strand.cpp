@@ -0,0 +1,257 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the library is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_SUPPORT_SOURCE 1
+
+#include "Nuclex/Support/Threading/Strand.h"
+
+#if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+
+#include "Nuclex/Support/Threading/ThreadPool.h" // for ThreadPool
+#include "Nuclex/Support/ScopeGuard.h" // for ON_SCOPE_EXIT
+#include "ThreadPoolConfig.h" // for ThreadPoolConfig
+
+#include <atomic> // for std::atomic
+#include <cstdint> // for std::uintptr_t
+
+namespace {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Flag in the queue head that indicates a drain task is posted or running</summary>
+  /// <remarks>
+  ///   Tasks are allocated with new, so they are aligned to at least the pointer size
+  ///   and the lowest bit of a task address is always free to carry this flag.
+  /// </remarks>
+  const constexpr std::uintptr_t DrainScheduledFlag = 1;
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Strand state whose tasks the calling thread is currently executing</summary>
+  thread_local const void *CurrentStrandState = nullptr;
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // anonymous namespace
+
+namespace Nuclex { namespace Support { namespace Threading {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>State shared between the strand and its drain task</summary>
+  /// <remarks>
+  ///   <para>
+  ///     Submitted tasks are pushed onto a lock-free stack whose head also carries
+  ///     a flag indicating whether a drain task is already posted to the thread pool.
+  ///     Pushing a task and checking (and setting) the flag is a single atomic operation,
+  ///     so only the submitter that finds the strand idle posts a drain task.
+  ///   </para>
+  ///   <para>
+  ///     The drain task takes the whole stack at once, reverses it into submission
+  ///     order and executes the tasks from this private batch. Only when the batch is
+  ///     used up does it look at the stack again. Once the stack is empty, it clears
+  ///     the flag with a compare-and-swap that fails if another task was pushed in
+  ///     the meantime, so no task can get stranded without a drain task.
+  ///   </para>
+  ///   <para>
+  ///     If the drain task cannot be posted, the submitter takes its task back off
+  ///     the stack and reports the error. Should other tasks already have been pushed
+  ///     on top of it, those rely on the drain task, so the submitter drains the strand
+  ///     on its own thread instead. A drain task that fails to post itself again after
+  ///     a batch likewise just continues with the next batch.
+  ///   </para>
+  /// </remarks>
+  struct Strand::State {
+
+    /// <summary>Initializes a new strand state</summary>
+    /// <param name="threadPool">Thread pool that will execute the strand's tasks</param>
+    public: State(ThreadPool &threadPool) :
+      TargetThreadPool(threadPool),
+      Head(0),
+      Batch(nullptr) {}
+
+    /// <summary>Destroys all tasks that have not been executed</summary>
+    public: ~State() {
+      deleteTasks(this->Batch);
+      deleteTasks(
+        reinterpret_cast<Task *>(
+          this->Head.load(std::memory_order_acquire) & ~DrainScheduledFlag
+        )
+      );
+    }
+
+    /// <summary>Executes a batch of the strand's tasks on a thread pool thread</summary>
+    /// <param name="self">Shared pointer to the state, kept for posting again</param>
+    public: static void Drain(const std::shared_ptr<State> &self) {
+      State &state = *self;
+
+      const void *previousStrandState = CurrentStrandState;
+      CurrentStrandState = &state;
+      ON_SCOPE_EXIT {
+        CurrentStrandState = previousStrandState;
+      };
+
+      for(std::size_t executedTaskCount = 0;;) {
+        if(state.Batch == nullptr) {
+
+          // If no new tasks were pushed, try to mark the strand as idle. This fails
+          // if a task was pushed since we last looked, in which case we take the stack.
+          std::uintptr_t expected = DrainScheduledFlag;
+          bool wentIdle = state.Head.compare_exchange_strong(
+            expected, 0, std::memory_order_release, std::memory_order_relaxed
+          );
+          if(wentIdle) {
+            return;
+          }
+
+          std::uintptr_t head = state.Head.exchange(
+            DrainScheduledFlag, std::memory_order_acquire
+          );
+          state.Batch = reverseTasks(reinterpret_cast<Task *>(head & ~DrainScheduledFlag));
+
+        }
+
+        // Step aside after a batch so other strands and tasks get their turn,
+        // the drain task will continue where it left off when it is executed again.
+        if(unlikely(executedTaskCount >= ThreadPoolConfig::StrandBatchSize)) {
+          try {
+            state.TargetThreadPool.Post(&State::Drain, self);
+            return;
+          }
+          catch(...) {
+            executedTaskCount = 0; // Couldn't step aside, so keep draining on this thread
+          }
+        }
+
+        Task *task = state.Batch;
+        state.Batch = task->Next;
+        task->operator()();
+        delete task;
+
+        ++executedTaskCount;
+      }
+    }
+
+    /// <summary>Reverses a singly linked list of tasks</summary>
+    /// <param name="task">First task in the list that will be reversed</param>
+    /// <returns>The first task in the reversed list</returns>
+    private: static Task *reverseTasks(Task *task) {
+      Task *reversed = nullptr;
+      while(task != nullptr) {
+        Task *next = task->Next;
+        task->Next = reversed;
+        reversed = task;
+        task = next;
+      }
+      return reversed;
+    }
+
+    /// <summary>Deletes all tasks in a singly linked list of tasks</summary>
+    /// <param name="task">First task in the list that will be deleted</param>
+    private: static void deleteTasks(Task *task) {
+      while(task != nullptr) {
+        Task *next = task->Next;
+        delete task;
+        task = next;
+      }
+    }
+
+    /// <summary>Thread pool that executes the drain task</summary>
+    public: ThreadPool &TargetThreadPool;
+    /// <summary>Most recently submitted task with the drain scheduled flag</summary>
+    public: std::atomic<std::uintptr_t> Head;
+    /// <summary>Tasks taken by the drain task in submission order</summary>
+    /// <remarks>
+    ///   This is only accessed from within the drain task, of which there is only
+    ///   ever one posted or running at a time.
+    /// </remarks>
+    public: Task *Batch;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+  Strand::Strand(ThreadPool &threadPool) :
+    state(std::make_shared<State>(threadPool)) {}
+
+  // ------------------------------------------------------------------------------------------- //
+
+  Strand::~Strand() = default;
+
+  // ------------------------------------------------------------------------------------------- //
+
+  bool Strand::IsRunningInThisThread() const {
+    return (CurrentStrandState == this->state.get());
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void Strand::submit(Task *task) {
+    State &state = *this->state;
+
+    std::uintptr_t head = state.Head.load(std::memory_order_relaxed);
+    for(;;) {
+      task->Next = reinterpret_cast<Task *>(head & ~DrainScheduledFlag);
+      bool wasPushed = state.Head.compare_exchange_weak(
+        head,
+        reinterpret_cast<std::uintptr_t>(task) | DrainScheduledFlag,
+        std::memory_order_acq_rel,
+        std::memory_order_relaxed
+      );
+      if(likely(wasPushed)) {
+        break;
+      }
+    }
+
+    // If the strand was idle, we're responsible for posting the drain task
+    if((head & DrainScheduledFlag) == 0) {
+      bool mustDrainHere = false;
+      try {
+        state.TargetThreadPool.Post(&State::Drain, this->state);
+      }
+      catch(...) {
+
+        // Take our task back off unless another one was pushed on top of it. The strand
+        // was idle and thus empty before, so this returns it to its idle state.
+        std::uintptr_t expected = reinterpret_cast<std::uintptr_t>(task) | DrainScheduledFlag;
+        bool wasRemoved = state.Head.compare_exchange_strong(
+          expected, 0, std::memory_order_acq_rel, std::memory_order_relaxed
+        );
+        if(wasRemoved) {
+          delete task;
+          throw;
+        }
+
+        // Other threads queued tasks behind ours that rely on the drain task we failed
+        // to post, so the only way to keep the strand going is to drain it ourselves.
+        mustDrainHere = true;
+
+      }
+      if(mustDrainHere) {
+        State::Drain(this->state);
+      }
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Threading
+
+#endif // defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
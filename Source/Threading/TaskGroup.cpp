@@ -0,0 +1,228 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the library is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_SUPPORT_SOURCE 1
+
+#include "Nuclex/Support/Threading/TaskGroup.h"
+
+#if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+
+#include "Nuclex/Support/Threading/ThreadPool.h" // for ThreadPool
+#include "Nuclex/Support/Threading/Semaphore.h" // for Semaphore
+#include "Nuclex/Support/ScopeGuard.h" // for ON_SCOPE_EXIT
+
+#include <atomic> // for std::atomic
+#include <mutex> // for std::mutex
+
+// Boost-licensed MoodyCamel queue, see ThreadPoolTaskPool.h. It includes
+// a lot of other headers and preprocessor constants, so we include it last.
+#include <concurrentqueue.h>
+
+namespace Nuclex { namespace Support { namespace Threading {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>State shared between the task group and its scheduled tasks</summary>
+  /// <remarks>
+  ///   <para>
+  ///     The tasks themselves are kept in a queue owned by the group. For each task,
+  ///     a small helper is posted to the thread pool that takes one task from the queue
+  ///     and executes it. A thread waiting for the group takes tasks from the same queue,
+  ///     so whichever gets to a task first executes it and the other finds nothing.
+  ///   </para>
+  ///   <para>
+  ///     A waiting thread sleeps on a semaphore when the queue is empty but tasks are
+  ///     still running elsewhere. Both adding a task and completing the last task wake it
+  ///     up. The waiter first announces itself, then checks the outstanding task count,
+  ///     while the other side first changes the count, then checks for waiters, both with
+  ///     sequentially consistent ordering, so at least one side sees the other.
+  ///   </para>
+  /// </remarks>
+  struct TaskGroup::State {
+
+    /// <summary>Initializes a new task group state</summary>
+    public: State() :
+      QueuedTasks(),
+      OutstandingTaskCount(0),
+      WaiterCount(0),
+      WakeUpSemaphore(0),
+      ExceptionMutex(),
+      Exceptions() {}
+
+    /// <summary>Destroys all tasks that have not been executed</summary>
+    public: ~State() {
+      Task *task;
+      while(this->QueuedTasks.try_dequeue(task)) {
+        delete task;
+      }
+    }
+
+    /// <summary>Executes the next queued task, if there is one</summary>
+    /// <returns>True if a task was executed, false if the queue was empty</returns>
+    public: bool TryRunOneTask() {
+      Task *task;
+      if(!this->QueuedTasks.try_dequeue(task)) {
+        return false;
+      }
+
+      {
+        ON_SCOPE_EXIT {
+          delete task;
+          completeTask();
+        };
+        try {
+          task->operator()();
+        }
+        catch(...) {
+          std::lock_guard<std::mutex> exceptionScope(this->ExceptionMutex);
+          this->Exceptions.push_back(std::current_exception());
+        }
+      }
+
+      return true;
+    }
+
+    /// <summary>Wakes up a waiting thread, if there is one</summary>
+    /// <param name="all">Whether to wake up all waiting threads rather than one</param>
+    public: void WakeWaiters(bool all) {
+      std::size_t waiterCount = this->WaiterCount.load(std::memory_order_seq_cst);
+      if(unlikely(waiterCount > 0)) {
+        this->WakeUpSemaphore.Post(all ? waiterCount : 1);
+      }
+    }
+
+    /// <summary>Counts down the outstanding tasks after a task has finished</summary>
+    private: void completeTask() {
+      std::size_t previousCount = this->OutstandingTaskCount.fetch_sub(
+        1, std::memory_order_seq_cst
+      );
+      if(previousCount == 1) {
+        WakeWaiters(true);
+      }
+    }
+
+    /// <summary>Tasks that have not been picked up by any thread yet</summary>
+    public: moodycamel::ConcurrentQueue<Task *> QueuedTasks;
+    /// <summary>Number of tasks that have been added but not completed yet</summary>
+    public: std::atomic<std::size_t> OutstandingTaskCount;
+    /// <summary>Number of threads currently inside Wait()</summary>
+    public: std::atomic<std::size_t> WaiterCount;
+    /// <summary>Wakes up waiting threads when there's a task to help with or all are done</summary>
+    public: Semaphore WakeUpSemaphore;
+    /// <summary>Must be held when accessing the list of exceptions</summary>
+    public: mutable std::mutex ExceptionMutex;
+    /// <summary>Exceptions thrown by the tasks</summary>
+    public: std::vector<std::exception_ptr> Exceptions;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TaskGroup::TaskGroup(ThreadPool &threadPool) :
+    threadPool(threadPool),
+    state(std::make_shared<State>()) {}
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TaskGroup::~TaskGroup() {
+    try {
+      Wait();
+    }
+    catch(...) {
+      // Exceptions have been documented to be discarded if nobody called Wait()
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void TaskGroup::Wait() {
+    State &state = *this->state;
+
+    state.WaiterCount.fetch_add(1, std::memory_order_seq_cst);
+    {
+      ON_SCOPE_EXIT {
+        state.WaiterCount.fetch_sub(1, std::memory_order_seq_cst);
+      };
+
+      // Help out with the queued tasks. Once there are none left, sleep until another
+      // task gets added (possibly by a running task) or the last task completes.
+      for(;;) {
+        while(state.TryRunOneTask()) {}
+
+        if(state.OutstandingTaskCount.load(std::memory_order_seq_cst) == 0) {
+          break;
+        }
+        state.WakeUpSemaphore.WaitThenDecrement();
+      }
+    }
+
+    std::lock_guard<std::mutex> exceptionScope(state.ExceptionMutex);
+    if(unlikely(!state.Exceptions.empty())) {
+      std::rethrow_exception(state.Exceptions.front());
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::vector<std::exception_ptr> TaskGroup::GetExceptions() const {
+    std::lock_guard<std::mutex> exceptionScope(this->state->ExceptionMutex);
+    return this->state->Exceptions;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void TaskGroup::add(Task *task) {
+    State &state = *this->state;
+
+    // The task needs to be counted before it is queued, otherwise a waiting thread
+    // could pick it up and count it down before it was even counted.
+    state.OutstandingTaskCount.fetch_add(1, std::memory_order_seq_cst);
+    {
+      auto rollbackScope = ON_SCOPE_EXIT_TRANSACTION {
+        state.OutstandingTaskCount.fetch_sub(1, std::memory_order_seq_cst);
+        delete task;
+      };
+      state.QueuedTasks.enqueue(task);
+      rollbackScope.Commit();
+    }
+
+    state.WakeWaiters(false);
+
+    // Post a helper that executes one task from the queue. If the task has already
+    // been taken by a waiting thread by the time the helper runs, it does nothing.
+    try {
+      std::shared_ptr<State> sharedState = this->state;
+      this->threadPool.Post(
+        [sharedState] {
+          sharedState->TryRunOneTask();
+        }
+      );
+    }
+    catch(...) {
+      // The task is still queued for Wait() to execute. Reporting the error would
+      // only make callers retry and end up running the task twice.
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Threading
+
+#endif // defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
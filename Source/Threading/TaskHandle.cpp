@@ -0,0 +1,361 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the library is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_SUPPORT_SOURCE 1
+
+#include "Nuclex/Support/Threading/TaskHandle.h"
+
+#if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+
+#include "Nuclex/Support/Threading/ThreadPool.h" // for ThreadPool
+
+#include <future> // for std::future_error
+#include <stdexcept> // for std::invalid_argument
+#include <cassert> // for assert()
+
+namespace {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Task graph node the calling thread is currently posting to a thread pool</summary>
+  thread_local const void *NodeBeingPosted = nullptr;
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // anonymous namespace
+
+namespace Nuclex { namespace Support { namespace Threading {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Posted to the thread pool to execute a task graph node</summary>
+  /// <remarks>
+  ///   <para>
+  ///     If the thread pool shuts down before the node got to run, this is destroyed
+  ///     without being called, in which case it completes the node as canceled so that
+  ///     neither waiting threads nor successors of the node are left hanging.
+  ///   </para>
+  ///   <para>
+  ///     If posting fails, this is destroyed while the thread is still inside Post().
+  ///     The node is left alone in that case so it can complete with the actual error.
+  ///   </para>
+  /// </remarks>
+  struct TaskHandle::Node::Execution {
+
+    /// <summary>Initializes a new execution for the specified node</summary>
+    /// <param name="node">Node that will be executed</param>
+    public: explicit Execution(Node *node) : node(node) {}
+
+    /// <summary>Takes over the node from another execution</summary>
+    /// <param name="other">Execution whose node will be taken over</param>
+    public: Execution(Execution &&other) noexcept : node(other.node) {
+      other.node = nullptr;
+    }
+
+    /// <summary>Cancels the node if it has not been executed</summary>
+    public: ~Execution() {
+      if(unlikely(this->node != nullptr)) {
+        if(this->node != NodeBeingPosted) {
+          this->node->Cancel();
+        }
+      }
+    }
+
+    /// <summary>Executes the node. Called on a thread pool thread</summary>
+    public: void operator()() noexcept {
+      Node *executedNode = this->node;
+      this->node = nullptr;
+      executedNode->Execute();
+    }
+
+    /// <summary>Node that will be executed, null after execution</summary>
+    private: Node *node;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TaskHandle::Node::Successor TaskHandle::Node::closedSuccessorList = { nullptr, nullptr };
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TaskHandle::Node::Node(
+    ThreadPool *threadPool,
+    std::size_t predecessorCount,
+    bool completesOnFirst /* = false */,
+    bool hasMethod /* = false */
+  ) :
+    threadPool(threadPool),
+    referenceCount(1),
+    pendingPredecessorCount(completesOnFirst ? 1 : predecessorCount),
+    hasFailedPredecessor(false),
+    completesOnFirst(completesOnFirst),
+    hasMethod(hasMethod),
+    successors(nullptr),
+    isFirstSuccessorTaken(false),
+    firstSuccessor { nullptr, nullptr },
+    error(),
+    isCompleted(false),
+    completionGate(false) {}
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TaskHandle::Node::~Node() {
+    assert(
+      (
+        (this->successors.load(std::memory_order_relaxed) == nullptr) ||
+        (this->successors.load(std::memory_order_relaxed) == &closedSuccessorList)
+      ) && u8"Node is not destroyed while successors are still registered"
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void TaskHandle::Node::AddSuccessor(Node *successor) {
+
+    // Most nodes only ever get a single successor (continuations chained via Then() and
+    // tasks joined by WhenAll() or WhenAny()), so the first link is embedded in the node
+    Successor *link;
+    bool wasFirstSuccessorTaken = this->isFirstSuccessorTaken.exchange(
+      true, std::memory_order_relaxed
+    );
+    if(likely(!wasFirstSuccessorTaken)) {
+      link = &this->firstSuccessor;
+      link->Target = successor;
+    } else {
+      link = new Successor { successor, nullptr };
+    }
+    successor->AddReference();
+
+    Successor *head = this->successors.load(std::memory_order_acquire);
+    for(;;) {
+
+      // If this node has already completed, its successors have been notified and
+      // the list is closed. Notify the new successor directly in that case.
+      if(head == &closedSuccessorList) {
+        if(link != &this->firstSuccessor) {
+          delete link;
+        }
+        successor->NotifyPredecessorCompleted(this->error);
+        successor->Release();
+        return;
+      }
+
+      link->Next = head;
+      bool wasAdded = this->successors.compare_exchange_weak(
+        head, link, std::memory_order_release, std::memory_order_acquire
+      );
+      if(likely(wasAdded)) {
+        return;
+      }
+
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void TaskHandle::Node::NotifyPredecessorCompleted(const std::exception_ptr &error) {
+
+    // In 'any' mode, only the first predecessor to complete counts and decides
+    // whether this node succeeds or fails. All later notifications are ignored.
+    if(this->completesOnFirst) {
+      std::size_t previousCount = this->pendingPredecessorCount.exchange(
+        0, std::memory_order_acq_rel
+      );
+      if(previousCount == 1) {
+        this->error = error;
+        Start();
+      }
+      return;
+    }
+
+    // In 'all' mode, the first failure is recorded. The decrement below publishes it
+    // to whichever thread ends up notifying the last predecessor and starting the node.
+    if(unlikely(static_cast<bool>(error))) {
+      bool hadFailedPredecessor = this->hasFailedPredecessor.exchange(
+        true, std::memory_order_relaxed
+      );
+      if(!hadFailedPredecessor) {
+        this->error = error;
+      }
+    }
+
+    std::size_t previousCount = this->pendingPredecessorCount.fetch_sub(
+      1, std::memory_order_acq_rel
+    );
+    if(previousCount == 1) {
+      Start();
+    }
+
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void TaskHandle::Node::Start() {
+
+    // Keeps the node alive until it has completed, even if all handles are dropped
+    AddReference();
+
+    // Nodes without a method (joins) and nodes whose predecessors failed complete
+    // right away on the calling thread. There's nothing to run for them.
+    if(!this->hasMethod || static_cast<bool>(this->error)) {
+      complete();
+      return;
+    }
+
+    // Without a thread pool (i.e. a continuation of an empty join), the method runs
+    // directly on the calling thread
+    if(unlikely(this->threadPool == nullptr)) {
+      Execute();
+      return;
+    }
+
+    // Callers should see why the node couldn't be posted (i.e. std::bad_alloc) rather
+    // than the broken_promise the execution would complete the node with otherwise
+    NodeBeingPosted = this;
+    try {
+      this->threadPool->Post(Execution(this));
+    }
+    catch(...) {
+      NodeBeingPosted = nullptr;
+      this->error = std::current_exception();
+      complete();
+      return;
+    }
+    NodeBeingPosted = nullptr;
+
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void TaskHandle::Node::Execute() noexcept {
+    try {
+      invoke();
+    }
+    catch(...) {
+      this->error = std::current_exception();
+    }
+
+    complete();
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void TaskHandle::Node::Cancel() noexcept {
+    this->error = std::make_exception_ptr(
+      std::future_error(std::future_errc::broken_promise)
+    );
+
+    complete();
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void TaskHandle::Node::complete() noexcept {
+    this->isCompleted.store(true, std::memory_order_release);
+    this->completionGate.Open();
+
+    // Close the list of successors so that any successors added from now on are
+    // notified directly, then notify all successors that were registered so far
+    Successor *link = this->successors.exchange(
+      &closedSuccessorList, std::memory_order_acq_rel
+    );
+    while(link != nullptr) {
+      Successor *next = link->Next;
+
+      link->Target->NotifyPredecessorCompleted(this->error);
+      link->Target->Release();
+      if(link != &this->firstSuccessor) {
+        delete link;
+      }
+
+      link = next;
+    }
+
+    // Drop the reference taken when the node was started
+    Release();
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TaskHandle TaskHandle::WhenAll(const std::vector<TaskHandle> &tasks) {
+    for(const TaskHandle &task : tasks) {
+      task.requireNode();
+    }
+
+    ThreadPool *threadPool = tasks.empty() ? nullptr : tasks.front().node->GetThreadPool();
+    return attach(new Node(threadPool, tasks.size()), tasks.data(), tasks.size());
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TaskHandle TaskHandle::WhenAny(const std::vector<TaskHandle> &tasks) {
+    if(unlikely(tasks.empty())) {
+      throw std::invalid_argument(u8"At least one task needs to be specified");
+    }
+    for(const TaskHandle &task : tasks) {
+      task.requireNode();
+    }
+
+    ThreadPool *threadPool = tasks.front().node->GetThreadPool();
+    return attach(new Node(threadPool, 1, true), tasks.data(), tasks.size());
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void TaskHandle::Get() const {
+    requireNode();
+    this->node->Wait();
+
+    const std::exception_ptr &error = this->node->GetError();
+    if(unlikely(static_cast<bool>(error))) {
+      std::rethrow_exception(error);
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void TaskHandle::throwEmptyHandleError() {
+    throw std::invalid_argument(u8"Task handle does not refer to a task");
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TaskHandle TaskHandle::attach(
+    Node *node, const TaskHandle *predecessors, std::size_t predecessorCount
+  ) {
+    TaskHandle handle(node);
+
+    if(predecessorCount == 0) {
+      node->Start();
+    } else {
+      for(std::size_t index = 0; index < predecessorCount; ++index) {
+        predecessors[index].node->AddSuccessor(node);
+      }
+    }
+
+    return handle;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Threading
+
+#endif // defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
@@ -31,6 +31,14 @@ limitations under the License.
 #include "../Platform/WindowsApi.h" // for ::Sleep(), ::GetCurrentThreadId() and more
 #else
 #include "../Platform/PosixProcessApi.h" // for PosixProcessApi
+#include <algorithm> // for std::min()
+#endif
+
+#if !defined(NUCLEX_SUPPORT_WINDOWS)
+#include "Nuclex/Support/ScopeGuard.h" // for ON_SCOPE_EXIT
+#include <unistd.h> // for ::sysconf()
+#include <cerrno> // for EINVAL
+#include <new> // for std::bad_alloc
 #endif
 
 #include "ThreadPoolConfig.h" // for ThreadPoolConfig::IsThreadPoolThread
@@ -38,24 +46,24 @@ limitations under the License.
 #include <thread> // for std::thread
 #include <cstring> // for std::memcpy()
 #include <cassert> // for assert()
+#include <vector> // for std::vector
+#include <stdexcept> // for std::invalid_argument
 
-// Design: currently this does not take NUMA and >64 CPUs into account
+// Design: the bit mask methods only cover the first 64 CPUs
 //
 // Reasoning:
 //
-// While there's potential to use many more cores than the average application in 2020 uses,
-// use cases with more than 64 cores are usually found in AI and raytracing. I'm making the bet
-// here that consumer CPUs will not grow above 64 cores for a decade.
+// The original affinity methods took a plain 64 bit mask, betting that consumer CPUs would
+// not grow beyond 64 cores for a decade. Servers with two sockets and 128 or more hardware
+// threads are common by now, however, and with a bit mask, all threads would pile up on
+// the lower 64 cores.
 //
-// When dealing with more than 64 cores, additional precautions are needed for optimal
-// performance, such as being aware of NUMA nodes (how many physical chips there are.).
-// On Linux, this requires libnuma. On Windows, this is done via "processor groups".
-// Microsoft's API also exposes up to 64 cores without processor group awareness.
+// The bit mask methods are kept for convenience and compatibility, but the CpuSet overloads
+// can address any number of CPUs. On Linux, they size the cpu_set_t dynamically via
+// CPU_ALLOC(). On Windows, they use the processor group APIs, which limit a thread to
+// the CPUs of a single processor group (of up to 64 CPUs).
 //
-// Counter arguments:
-//
-// If more than 64 cores become very common, applications built with Nuclex.Support.Native that
-// make use of CPU affinity will all be hogging the lower 64 cores.
+// Which CPUs belong to which NUMA node is provided by the CpuTopology class.
 //
 
 namespace {
@@ -141,7 +149,7 @@ namespace {
       std::size_t maxCpuIndex = std::min(64, CPU_SETSIZE);
       for(std::size_t index = 0; index < maxCpuIndex; ++index) {
         if(CPU_ISSET(index, &cpuSet)) {
-          result |= (1 << index);
+          result |= (std::uint64_t(1) << index);
         }
       }
     }
@@ -170,7 +178,7 @@ namespace {
 
       std::size_t maxCpuIndex = std::min(64, CPU_SETSIZE);
       for(std::size_t index = 0; index < maxCpuIndex; ++index) {
-        if((affinityMask & (1 << index)) != 0) {
+        if((affinityMask & (std::uint64_t(1) << index)) != 0) {
           CPU_SET(index, &cpuSet);
         }
       }
@@ -188,6 +196,163 @@ namespace {
 #endif // !defined(NUCLEX_SUPPORT_WINDOWS)
   // ------------------------------------------------------------------------------------------- //
 
+#if defined(NUCLEX_SUPPORT_WINDOWS)
+  /// <summary>Queries the processor group affinity of the specified thread</summary>
+  /// <param name="windowsThreadHandle">
+  ///   Handle of the thread or current thread pseudo handle for the thread to check
+  /// </param>
+  /// <returns>The set of CPUs the thread can be scheduled on</returns>
+  Nuclex::Support::Threading::CpuSet getWindowsThreadCpuSet(HANDLE windowsThreadHandle) {
+    ::GROUP_AFFINITY groupAffinity = {0};
+    BOOL result = ::GetThreadGroupAffinity(windowsThreadHandle, &groupAffinity);
+    if(result == FALSE) {
+      DWORD errorCode = ::GetLastError();
+      Nuclex::Support::Platform::WindowsApi::ThrowExceptionForSystemError(
+        u8"Could not query thread affinity via ::GetThreadGroupAffinity()", errorCode
+      );
+    }
+
+    Nuclex::Support::Threading::CpuSet cpus;
+    {
+      std::size_t firstCpuIndex = static_cast<std::size_t>(groupAffinity.Group) * 64;
+      std::uint64_t mask = static_cast<std::uint64_t>(groupAffinity.Mask);
+      for(std::size_t index = 0; index < 64; ++index) {
+        if((mask & (std::uint64_t(1) << index)) != 0) {
+          cpus.Add(firstCpuIndex + index);
+        }
+      }
+    }
+
+    return cpus;
+  }
+#endif // defined(NUCLEX_SUPPORT_WINDOWS)
+  // ------------------------------------------------------------------------------------------- //
+#if defined(NUCLEX_SUPPORT_WINDOWS)
+  /// <summary>Changes the processor group affinity of the specified thread</summary>
+  /// <param name="windowsThreadHandle">
+  ///   Handle of the thread or current thread pseudo handle for the thread to change
+  /// </param>
+  /// <param name="cpus">Set of CPUs the thread can be scheduled on</param>
+  void setWindowsThreadCpuSet(
+    HANDLE windowsThreadHandle, const Nuclex::Support::Threading::CpuSet &cpus
+  ) {
+    if(cpus.IsEmpty()) {
+      throw std::invalid_argument(u8"CPU set must contain at least one CPU");
+    }
+
+    // Windows can only assign a thread to CPUs within a single processor group
+    std::vector<std::size_t> cpuIndices = cpus.GetIndices();
+    std::size_t groupIndex = cpuIndices.front() / 64;
+    if((cpuIndices.back() / 64) != groupIndex) {
+      throw std::invalid_argument(
+        u8"CPU set spans multiple processor groups, Windows can only assign a thread to "
+        u8"the CPUs of a single processor group"
+      );
+    }
+
+    ::GROUP_AFFINITY groupAffinity = {0};
+    groupAffinity.Group = static_cast<WORD>(groupIndex);
+    {
+      std::uint64_t mask = 0;
+      for(std::size_t index = 0; index < cpuIndices.size(); ++index) {
+        mask |= (std::uint64_t(1) << (cpuIndices[index] % 64));
+      }
+      groupAffinity.Mask = static_cast<KAFFINITY>(mask);
+    }
+
+    BOOL result = ::SetThreadGroupAffinity(windowsThreadHandle, &groupAffinity, nullptr);
+    if(result == FALSE) {
+      DWORD errorCode = ::GetLastError();
+      Nuclex::Support::Platform::WindowsApi::ThrowExceptionForSystemError(
+        u8"Could not change thread affinity via ::SetThreadGroupAffinity()", errorCode
+      );
+    }
+  }
+#endif // defined(NUCLEX_SUPPORT_WINDOWS)
+  // ------------------------------------------------------------------------------------------- //
+#if !defined(NUCLEX_SUPPORT_WINDOWS)
+  /// <summary>Queries the CPUs the specified thread is allowed to run on</summary>
+  /// <param name="thread">Thread for which the CPU affinity will be queried</param>
+  /// <returns>The set of CPUs the thread can be scheduled on</returns>
+  Nuclex::Support::Threading::CpuSet queryPThreadThreadCpuSet(const ::pthread_t &thread) {
+    long configuredCpuCount = ::sysconf(_SC_NPROCESSORS_CONF);
+    std::size_t cpuCount = std::max<std::size_t>(
+      (configuredCpuCount > 0) ? static_cast<std::size_t>(configuredCpuCount) : 0, CPU_SETSIZE
+    );
+
+    // The kernel's CPU mask may be larger than the number of configured CPUs suggests,
+    // in which case the call fails with EINVAL and we retry with a larger set.
+    for(;;) {
+      ::cpu_set_t *cpuSet = CPU_ALLOC(cpuCount);
+      if(unlikely(cpuSet == nullptr)) {
+        throw std::bad_alloc();
+      }
+      ON_SCOPE_EXIT { CPU_FREE(cpuSet); };
+
+      std::size_t cpuSetSize = CPU_ALLOC_SIZE(cpuCount);
+      CPU_ZERO_S(cpuSetSize, cpuSet);
+
+      int errorNumber = ::pthread_getaffinity_np(thread, cpuSetSize, cpuSet);
+      if(errorNumber == EINVAL) {
+        cpuCount *= 2;
+        continue;
+      }
+      if(errorNumber != 0) {
+        Nuclex::Support::Platform::PosixApi::ThrowExceptionForSystemError(
+          u8"Error querying CPU affinity via pthread_getaffinity_np()", errorNumber
+        );
+      }
+
+      Nuclex::Support::Threading::CpuSet cpus;
+      for(std::size_t index = 0; index < cpuCount; ++index) {
+        if(CPU_ISSET_S(index, cpuSetSize, cpuSet)) {
+          cpus.Add(index);
+        }
+      }
+
+      return cpus;
+    }
+  }
+#endif // !defined(NUCLEX_SUPPORT_WINDOWS)
+  // ------------------------------------------------------------------------------------------- //
+#if !defined(NUCLEX_SUPPORT_WINDOWS)
+  /// <summary>Changes the CPUs the specified thread is allowed to run on</summary>
+  /// <param name="thread">Thread whose CPU affinity will be changed</param>
+  /// <param name="cpus">Set of CPUs the thread can be scheduled on</param>
+  void changePThreadThreadCpuSet(
+    const ::pthread_t &thread, const Nuclex::Support::Threading::CpuSet &cpus
+  ) {
+    if(cpus.IsEmpty()) {
+      throw std::invalid_argument(u8"CPU set must contain at least one CPU");
+    }
+
+    std::size_t cpuCount = cpus.GetUpperBound();
+
+    ::cpu_set_t *cpuSet = CPU_ALLOC(cpuCount);
+    if(unlikely(cpuSet == nullptr)) {
+      throw std::bad_alloc();
+    }
+    ON_SCOPE_EXIT { CPU_FREE(cpuSet); };
+
+    std::size_t cpuSetSize = CPU_ALLOC_SIZE(cpuCount);
+    CPU_ZERO_S(cpuSetSize, cpuSet);
+    {
+      std::vector<std::size_t> cpuIndices = cpus.GetIndices();
+      for(std::size_t index = 0; index < cpuIndices.size(); ++index) {
+        CPU_SET_S(cpuIndices[index], cpuSetSize, cpuSet);
+      }
+    }
+
+    int errorNumber = ::pthread_setaffinity_np(thread, cpuSetSize, cpuSet);
+    if(errorNumber != 0) {
+      Nuclex::Support::Platform::PosixApi::ThrowExceptionForSystemError(
+        u8"Error changing CPU affinity via pthread_setaffinity_np()", errorNumber
+      );
+    }
+  }
+#endif // !defined(NUCLEX_SUPPORT_WINDOWS)
+  // ------------------------------------------------------------------------------------------- //
+
 } // anonymous namespace
 
 namespace Nuclex { namespace Support { namespace Threading {
@@ -420,4 +585,50 @@ namespace Nuclex { namespace Support { namespace Threading {
 
   // ------------------------------------------------------------------------------------------- //
 
+  CpuSet Thread::GetCpuAffinity(std::uintptr_t threadId) {
+#if defined(NUCLEX_SUPPORT_WINDOWS)
+    HANDLE threadHandle = *reinterpret_cast<HANDLE *>(&threadId);
+    return getWindowsThreadCpuSet(threadHandle);
+#else // LINUX and POSIX
+    ::pthread_t thread;
+    std::memcpy(&thread, &threadId, sizeof(thread));
+    return queryPThreadThreadCpuSet(thread);
+#endif
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  CpuSet Thread::GetCpuAffinity() {
+#if defined(NUCLEX_SUPPORT_WINDOWS)
+    return getWindowsThreadCpuSet(::GetCurrentThread());
+#else // LINUX and POSIX
+    return queryPThreadThreadCpuSet(::pthread_self());
+#endif
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void Thread::SetCpuAffinity(std::uintptr_t threadId, const CpuSet &cpus) {
+#if defined(NUCLEX_SUPPORT_WINDOWS)
+    HANDLE threadHandle = *reinterpret_cast<HANDLE *>(&threadId);
+    setWindowsThreadCpuSet(threadHandle, cpus);
+#else // LINUX and POSIX
+    ::pthread_t thread;
+    std::memcpy(&thread, &threadId, sizeof(thread));
+    changePThreadThreadCpuSet(thread, cpus);
+#endif
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void Thread::SetCpuAffinity(const CpuSet &cpus) {
+#if defined(NUCLEX_SUPPORT_WINDOWS)
+    setWindowsThreadCpuSet(::GetCurrentThread(), cpus);
+#else // LINUX and POSIX
+    changePThreadThreadCpuSet(::pthread_self(), cpus);
+#endif
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
 }}} // namespace Nuclex::Support::Threading
@@ -29,10 +29,12 @@ limitations under the License.
 #include "./cameron314-concurrentqueue-1.0.4//concurrentqueue.h"
 
 #include "ThreadPoolTaskPool.h" // thread pool settings + task pool
+#include "ThreadPoolTimerQueue.h" // for ThreadPoolTimerQueue
 #include "../Platform/WindowsApi.h" // error handling helpers
 
 #include <cassert> // for assert()
 #include <atomic> // for std;:atomic
+#include <mutex> // for std::mutex
 
 #include <VersionHelpers.h> // for ::IsWindowsVistaOrGreater()
 
@@ -84,6 +86,8 @@ namespace Nuclex { namespace Support { namespace Threading {
       public: PlatformDependentImplementation *Implementation;
       /// <summary>The thread pool work item, if the new thread pool API is used</summary>
       public: ::TP_WORK *Work;
+      /// <summary>Priority of the callback environment the work item was created in</summary>
+      public: Priority WorkPriority;
       // <summary>The task instance living in the payload</summary>
       public: ThreadPool::Task *Task;
       /// <summary>This contains a ThreadPool::Task (actually a derived type)</summary>
@@ -117,20 +121,37 @@ namespace Nuclex { namespace Support { namespace Threading {
       ::TP_CALLBACK_INSTANCE *instance, void *context, ::TP_WORK *workItem
     );
 
+    /// <summary>Maximum number of threads to create under high load</summary>
+    public: std::size_t MaximumThreadCount;
     /// <summary>Whether the thread pool is shutting down</summary>
     public: std::atomic<bool> IsShuttingDown;
     /// <summary>Whether the thread pool should use the Vista-and-later API</summary>
     public: bool UseNewThreadPoolApi;
-    /// <summary>Describes this application (WinSDK version etc.) to the thread pool</summary>
-    public: ::TP_CALLBACK_ENVIRON NewCallbackEnvironment;
+    /// <summary>Creates a work item for a task in the specified priority's environment</summary>
+    /// <param name="submittedTask">Submitted task the work item will execute</param>
+    /// <param name="priority">Priority the work item's callbacks will run with</param>
+    /// <returns>The new work item</returns>
+    public: ::TP_WORK *CreateWork(SubmittedTask *submittedTask, Priority priority);
+
+    /// <summary>
+    ///   Describes this application (WinSDK version etc.) to the thread pool, one for
+    ///   each priority lane (indexed by the numeric value of the priority)
+    /// </summary>
+    public: ::TP_CALLBACK_ENVIRON NewCallbackEnvironments[3];
     /// <summary>Thread pool on which tasks get scheduled if new TP api is used</summary>
     public: ::TP_POOL *NewThreadPool;
     /// <summary>Signaled when there are no tasks left awaiting execution</summary>
     public: Latch LightsOutLatch;
+    /// <summary>Protects the sizing options while they're being changed or copied</summary>
+    public: std::mutex SizingOptionsMutex;
+    /// <summary>Sizing options, only stored since the Windows thread pool sizes itself</summary>
+    public: SizingOptions Sizing;
     /// <summary>Submitted tasks for re-use</summary>
     public: ThreadPoolTaskPool<
       SubmittedTask, offsetof(SubmittedTask, Payload)
     > SubmittedTaskPool;
+    /// <summary>Posts delayed and periodic tasks when they become due</summary>
+    public: std::unique_ptr<ThreadPoolTimerQueue> Timers;
 
   };
 
@@ -139,17 +160,22 @@ namespace Nuclex { namespace Support { namespace Threading {
   ThreadPool::PlatformDependentImplementation::PlatformDependentImplementation(
     std::size_t minimumThreadCount, std::size_t maximumThreadCount
   ) :
+    MaximumThreadCount(maximumThreadCount),
     IsShuttingDown(false),
     UseNewThreadPoolApi(::IsWindowsVistaOrGreater()),
-    NewCallbackEnvironment(),
+    NewCallbackEnvironments(),
     NewThreadPool(nullptr),
     LightsOutLatch(),
+    SizingOptionsMutex(),
+    Sizing(),
     SubmittedTaskPool() {
 
     // The new thread pool API introduced with Windows Vista allows us to honor
     // the minimum and maximum thread count parameters, so if possible set it up.
     if(this->UseNewThreadPoolApi) {
-      ::TpInitializeCallbackEnviron(&this->NewCallbackEnvironment);
+      for(std::size_t index = 0; index < 3; ++index) {
+        ::TpInitializeCallbackEnviron(&this->NewCallbackEnvironments[index]);
+      }
 
       // Create a new thread pool. There is no documentation on how many threads it
       // will create or run by default.
@@ -182,10 +208,26 @@ namespace Nuclex { namespace Support { namespace Threading {
           );
         }
 
-        // Connect the environment structure describing this application with
+        // Connect the environment structures describing this application with
         // the thread pool. Needed to submit tasks to this pool instead of the default pool
         // (which probably gets created when the first task is submitted to it).
-        ::SetThreadpoolCallbackPool(&this->NewCallbackEnvironment, this->NewThreadPool);
+        // Each priority lane gets its own environment with a matching callback priority,
+        // the Windows thread pool then runs the higher priority callbacks first.
+        for(std::size_t index = 0; index < 3; ++index) {
+          ::SetThreadpoolCallbackPool(&this->NewCallbackEnvironments[index], this->NewThreadPool);
+        }
+        ::SetThreadpoolCallbackPriority(
+          &this->NewCallbackEnvironments[static_cast<std::size_t>(Priority::High)],
+          TP_CALLBACK_PRIORITY_HIGH
+        );
+        ::SetThreadpoolCallbackPriority(
+          &this->NewCallbackEnvironments[static_cast<std::size_t>(Priority::Normal)],
+          TP_CALLBACK_PRIORITY_NORMAL
+        );
+        ::SetThreadpoolCallbackPriority(
+          &this->NewCallbackEnvironments[static_cast<std::size_t>(Priority::Low)],
+          TP_CALLBACK_PRIORITY_LOW
+        );
 
         closeThreadPoolScope.Commit(); // Everything worked out, don't close the thread pool
       }
@@ -224,12 +266,20 @@ namespace Nuclex { namespace Support { namespace Threading {
 
     ThreadPoolConfig::IsThreadPoolThread = true;
 
-    // See if the thread pool is shutting down. If so, fast-forward through any scheduled
-    // task, destroying it without executing it (this will cancel the owner's std::futures).
-    bool isShuttingDown = submittedTask->Implementation->IsShuttingDown.load(
+    // See if the thread pool is shutting down or the task was canceled. If so, destroy
+    // the task without executing it (this will cancel the owner's std::futures).
+    bool isCanceled = submittedTask->Implementation->IsShuttingDown.load(
       std::memory_order_consume // if() below carries dependency
     );
-    if(unlikely(isShuttingDown)) {
+    if(likely(!isCanceled)) {
+      const std::shared_ptr<const StopToken> &cancellationToken = (
+        submittedTask->Task->CancellationToken
+      );
+      if(unlikely(static_cast<bool>(cancellationToken))) {
+        isCanceled = cancellationToken->IsCanceled();
+      }
+    }
+    if(unlikely(isCanceled)) {
       submittedTask->Task->~Task();
       implementation.SubmittedTaskPool.DeleteTask(submittedTask);
     } else {
@@ -245,6 +295,26 @@ namespace Nuclex { namespace Support { namespace Threading {
 
   // ------------------------------------------------------------------------------------------- //
 
+  ::TP_WORK *ThreadPool::PlatformDependentImplementation::CreateWork(
+    SubmittedTask *submittedTask, Priority priority
+  ) {
+    ::TP_WORK *work = ::CreateThreadpoolWork(
+      &PlatformDependentImplementation::newThreadPoolWorkCallback,
+      reinterpret_cast<void *>(submittedTask),
+      &this->NewCallbackEnvironments[static_cast<std::size_t>(priority)]
+    );
+    if(unlikely(work == nullptr)) {
+      DWORD lastErrorCode = ::GetLastError();
+      Nuclex::Support::Platform::WindowsApi::ThrowExceptionForSystemError(
+        u8"Could not create thread pool work item", lastErrorCode
+      );
+    }
+
+    return work;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
   void NTAPI ThreadPool::PlatformDependentImplementation::newThreadPoolWorkCallback(
     ::TP_CALLBACK_INSTANCE *instance, void *context, ::TP_WORK *workItem
   ) {
@@ -273,15 +343,26 @@ namespace Nuclex { namespace Support { namespace Threading {
 
   ThreadPool::ThreadPool(
     std::size_t minimumThreadCount /* = GetDefaultMinimumThreadCount() */,
-    std::size_t maximumThreadCount /* = GetDefaultMaximumThreadCount() */
+    std::size_t maximumThreadCount /* = GetDefaultMaximumThreadCount() */,
+    NumaMode /* numaMode = NumaMode::Ignored */ // Windows does its own thread placement
   ) :
     implementation(
       new PlatformDependentImplementation(minimumThreadCount, maximumThreadCount)
-    ) {}
+    ) {
+    auto destroyImplementationScope = ON_SCOPE_EXIT_TRANSACTION {
+      delete this->implementation;
+    };
+    this->implementation->Timers.reset(new ThreadPoolTimerQueue(*this));
+    destroyImplementationScope.Commit();
+  }
 
   // ------------------------------------------------------------------------------------------- //
 
   ThreadPool::~ThreadPool() {
+
+    // Stop posting delayed and periodic tasks before flushing the queue
+    this->implementation->Timers->Stop();
+
     this->implementation->IsShuttingDown.store(
       true, std::memory_order_release
     );
@@ -309,19 +390,14 @@ namespace Nuclex { namespace Support { namespace Threading {
     if(unlikely(submittedTask->Implementation == nullptr)) {
       submittedTask->Implementation = this->implementation;
       if(this->implementation->UseNewThreadPoolApi) {
-        submittedTask->Work = ::CreateThreadpoolWork(
-          &PlatformDependentImplementation::newThreadPoolWorkCallback,
-          reinterpret_cast<void *>(submittedTask),
-          //nullptr,
-          &this->implementation->NewCallbackEnvironment
-        );
-        if(unlikely(submittedTask->Work == nullptr)) {
-          DWORD lastErrorCode = ::GetLastError();
+        auto deleteTaskScope = ON_SCOPE_EXIT_TRANSACTION {
           this->implementation->SubmittedTaskPool.DeleteTask(submittedTask);
-          Nuclex::Support::Platform::WindowsApi::ThrowExceptionForSystemError(
-            u8"Could not create thread pool work item", lastErrorCode
-          );
-        }
+        };
+        submittedTask->Work = this->implementation->CreateWork(
+          submittedTask, Priority::Normal
+        );
+        submittedTask->WorkPriority = Priority::Normal;
+        deleteTaskScope.Commit();
       }
     }
 
@@ -333,7 +409,7 @@ namespace Nuclex { namespace Support { namespace Threading {
 
   // ------------------------------------------------------------------------------------------- //
 
-  void ThreadPool::submitTask(std::uint8_t *taskMemory, Task *task) {
+  void ThreadPool::submitTask(std::uint8_t *taskMemory, Task *task, Priority priority) {
     std::uint8_t *submittedTaskMemory = (
       taskMemory - offsetof(PlatformDependentImplementation::SubmittedTask, Payload)
     );
@@ -344,6 +420,25 @@ namespace Nuclex { namespace Support { namespace Threading {
     );
     submittedTask->Task = task;
 
+    // Work items are bound to the callback environment they were created in, which
+    // determines their priority. A recycled task keeps the work item of its last use,
+    // so if that was for another priority lane, the work item has to be replaced. The old
+    // thread pool API (before Windows Vista) has no priorities, so they're ignored there.
+    if(this->implementation->UseNewThreadPoolApi) {
+      if(unlikely(submittedTask->WorkPriority != priority)) {
+        auto deleteTaskScope = ON_SCOPE_EXIT_TRANSACTION {
+          submittedTask->Task->~Task();
+          this->implementation->SubmittedTaskPool.DeleteTask(submittedTask);
+        };
+        ::TP_WORK *work = this->implementation->CreateWork(submittedTask, priority);
+        deleteTaskScope.Commit();
+
+        ::CloseThreadpoolWork(submittedTask->Work);
+        submittedTask->Work = work;
+        submittedTask->WorkPriority = priority;
+      }
+    }
+
     // Increment task count before executing so we don't risk the task finishing
     // before the increment, dropping the counter lower than 0. If this is
     // the first task being scheduled after the thread pool was idle, reset
@@ -370,6 +465,95 @@ namespace Nuclex { namespace Support { namespace Threading {
 
   // ------------------------------------------------------------------------------------------- //
 
+  void ThreadPool::submitTasks(
+    std::uint8_t *const *taskMemories, Task *const *tasks, std::size_t count
+  ) {
+
+    // The Windows thread pool has no bulk submission, so submit the tasks one by one.
+    // If a submission fails, the tasks that were not submitted yet are destroyed.
+    std::size_t submittedCount = 0;
+    auto deleteTasksScope = ON_SCOPE_EXIT_TRANSACTION {
+      ++submittedCount; // submitTask() already destroyed the failing task
+      while(submittedCount < count) {
+        tasks[submittedCount]->~Task();
+        discardTaskMemory(taskMemories[submittedCount]);
+        ++submittedCount;
+      }
+    };
+    while(submittedCount < count) {
+      submitTask(taskMemories[submittedCount], tasks[submittedCount]);
+      ++submittedCount;
+    }
+    deleteTasksScope.Commit();
+
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void ThreadPool::discardTaskMemory(std::uint8_t *taskMemory) {
+    this->implementation->SubmittedTaskPool.DeleteTask(
+      reinterpret_cast<PlatformDependentImplementation::SubmittedTask *>(
+        taskMemory - offsetof(PlatformDependentImplementation::SubmittedTask, Payload)
+      )
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  ThreadPool::SizingOptions ThreadPool::GetSizingOptions() const {
+    std::lock_guard<std::mutex> sizingOptionsScope(this->implementation->SizingOptionsMutex);
+    return this->implementation->Sizing;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void ThreadPool::SetSizingOptions(const SizingOptions &options) {
+    std::lock_guard<std::mutex> sizingOptionsScope(this->implementation->SizingOptionsMutex);
+    this->implementation->Sizing = options;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void ThreadPool::startTimer(
+    const std::shared_ptr<TimerTask> &task,
+    std::chrono::microseconds delay, std::chrono::microseconds interval
+  ) {
+    task->Owner = this;
+    this->implementation->Timers->Schedule(task, delay, interval);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  bool ThreadPool::cancelTimer(TimerTask &task) {
+    int expected = TimerTask::Pending;
+    bool wasCanceled = task.State.compare_exchange_strong(
+      expected, TimerTask::Canceled, std::memory_order_acq_rel, std::memory_order_relaxed
+    );
+    if(wasCanceled) {
+      task.Owner->implementation->Timers->Remove(task);
+    }
+
+    return wasCanceled;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  ThreadPool::Statistics ThreadPool::GetStatistics() const {
+    Statistics statistics = Statistics();
+    statistics.TaskMemoryAllocationCount = (
+      this->implementation->SubmittedTaskPool.CountAllocations()
+    );
+    return statistics;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::size_t ThreadPool::getMaximumThreadCount() const {
+    return this->implementation->MaximumThreadCount;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
 }}} // namespace Nuclex::Support::Threading
 
 #endif // defined(NUCLEX_SUPPORT_WINDOWS) && defined(NUCLEX_SUPPORT_USE_MICROSOFT_THREADPOOL)
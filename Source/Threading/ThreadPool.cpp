@@ -26,14 +26,25 @@ limitations under the License.
 #if !(defined(NUCLEX_SUPPORT_WINDOWS) && defined(NUCLEX_SUPPORT_USE_MICROSOFT_THREADPOOL))
 
 #include "Nuclex/Support/ScopeGuard.h" // for ScopeGuard
+#include "Nuclex/Support/BitTricks.h" // for BitTricks
 #include "Nuclex/Support/Threading/Gate.h" // for Gate
 #include "Nuclex/Support/Threading/Semaphore.h" // for Semaphore
+#include "Nuclex/Support/Threading/Thread.h" // for Thread::SetCpuAffinity()
+#include "Nuclex/Support/Threading/CpuTopology.h" // for CpuTopology
 
 #include "ThreadPoolTaskPool.h" // thread pool settings + task pool
+#include "ThreadPoolTimerQueue.h" // for ThreadPoolTimerQueue
+#include "ThreadPoolWorkDeque.h" // for ThreadPoolWorkDeque
+#include "ThreadPoolSizer.h" // for ThreadPoolSizer
 
 #include <cassert> // for assert()
+#include <algorithm> // for std::min()
 #include <atomic> // for std::atomic
+#include <chrono> // for std::chrono::steady_clock
 #include <thread> // for std::thread
+#include <memory> // for std::unique_ptr
+#include <mutex> // for std::mutex
+#include <vector> // for std::vector
 
 #if defined(NUCLEX_SUPPORT_LINUX)
 #include "../Platform/PosixTimeApi.h" // error handling helpers, time helpers
@@ -54,6 +65,73 @@ limitations under the License.
 // (supporting both the legacy variant and the modern variant), but it suffers from
 // sporadic barfs during shutdown.
 //
+// Each worker thread owns a work-stealing deque. Tasks scheduled from outside of
+// the thread pool go into a shared queue, but tasks scheduled by a worker thread
+// (i.e. a task spawning more tasks) are pushed into that worker's own deque, so
+// fine-grained, recursive work never touches the shared queue or the semaphore.
+// Workers with nothing to do steal from the other workers' deques.
+//
+// Tasks can also be scheduled with high or low priority. Those go into separate
+// shared queues (one per priority lane) that are checked before and after the normal
+// priority tasks respectively. Every few tasks, the lanes are checked in reverse order
+// so that saturating the high priority lane cannot completely starve the others.
+//
+// In NUMA mode, the worker threads are pinned to the CPUs of one NUMA node each and
+// every NUMA node gets its own set of shared queues. Tasks scheduled from outside of
+// the thread pool go into the queues of the NUMA node the scheduling thread runs on,
+// so they are likely to be picked up by a worker near the memory they were prepared in.
+// Workers check the queues of their own NUMA node first and steal from workers of
+// their own NUMA node before going after the workers of other nodes.
+//
+// The number of threads is controlled by the ThreadPoolSizer, fed by a sizing thread.
+// Whenever tasks pile up (more tasks than threads), the sizing thread is woken up and
+// takes a sample of the load every sample interval until the backlog is gone. It needs
+// to be a separate thread because, when all workers are blocked, none of them would be
+// around to notice. Each worker thread bumps a counter when it starts and when it
+// finishes a task, so by comparing these counters between samples, the number of busy
+// and blocked workers as well as the number of tasks completed can be determined without
+// any shared counters being hammered. Idle workers exit on their own once they have been
+// idle long enough, but only one per sample interval and not right after the pool grew.
+//
+
+namespace {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Increments a counter that is only ever written by a single thread</summary>
+  /// <param name="counter">Counter that will be incremented</param>
+  /// <remarks>
+  ///   Other threads may read the counter at any time, which is why it is an atomic,
+  ///   but since only the owning thread writes to it, no locked instruction is needed.
+  /// </remarks>
+  void incrementOwnCounter(std::atomic<std::size_t> &counter) {
+    counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Determines the statistics histogram bucket a duration falls into</summary>
+  /// <param name="duration">Duration for which the bucket will be determined</param>
+  /// <returns>The index of the histogram bucket counting the duration</returns>
+  std::size_t getHistogramBucket(std::chrono::steady_clock::duration duration) {
+    typedef Nuclex::Support::Threading::ThreadPool::Statistics Statistics;
+
+    std::chrono::microseconds::rep microseconds = (
+      std::chrono::duration_cast<std::chrono::microseconds>(duration).count()
+    );
+    if(microseconds < 1) {
+      return 0;
+    }
+
+    std::size_t bucket = static_cast<std::size_t>(
+      Nuclex::Support::BitTricks::GetLogBase2(static_cast<std::uint64_t>(microseconds))
+    ) + 1;
+    return std::min(bucket, Statistics::HistogramBucketCount - 1);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // anonymous namespace
 
 namespace Nuclex { namespace Support { namespace Threading {
 
@@ -71,6 +149,8 @@ namespace Nuclex { namespace Support { namespace Threading {
       public: std::size_t PayloadSize;
       /// <summary>The task instance living in the payload</summary>
       public: ThreadPool::Task *Task;
+      /// <summary>Steady clock ticks when the task was submitted, 0 if not timed</summary>
+      public: std::chrono::steady_clock::rep SubmitTicks;
       /// <summary>This contains a ThreadPool::Task (actually a derived type)</summary>
       public: std::uint8_t Payload[sizeof(std::intptr_t)];
 
@@ -78,9 +158,40 @@ namespace Nuclex { namespace Support { namespace Threading {
 
     #pragma endregion // SubmittedTask
 
+    #pragma region struct WorkerActivity
+
+    /// <summary>Tracks the progress of a worker thread for sizing and statistics</summary>
+    public: struct WorkerActivity {
+
+      /// <summary>Incremented when the worker starts and when it finishes a task</summary>
+      /// <remarks>
+      ///   Only written by the worker thread owning it. The value is odd while
+      ///   the worker thread is executing a task.
+      /// </remarks>
+      public: alignas(64) std::atomic<std::size_t> TransitionCount;
+      /// <summary>Transition count seen by the previous sample</summary>
+      public: std::size_t SampledTransitionCount;
+      /// <summary>Time at which the sample first saw the current task running</summary>
+      public: std::chrono::steady_clock::time_point BusySince;
+      /// <summary>Number of tasks the worker stole from other workers</summary>
+      public: std::atomic<std::size_t> StolenTaskCount;
+      /// <summary>Number of tasks the worker dropped without executing them</summary>
+      public: std::atomic<std::size_t> CanceledTaskCount;
+      /// <summary>Queue wait times of the timed tasks the worker executed</summary>
+      public: std::atomic<std::size_t> QueueWaitHistogram[Statistics::HistogramBucketCount];
+      /// <summary>Execution times of the timed tasks the worker executed</summary>
+      public: std::atomic<std::size_t> ExecutionTimeHistogram[
+        Statistics::HistogramBucketCount
+      ];
+
+    };
+
+    #pragma endregion // struct WorkerActivity
+
     /// <summary>Creates an instance of the platform dependent data container</summary>
     /// <param name="minimumThreadCount">Minimum number of threads to keep running</param>
     /// <param name="maximumThreadcount">Maximum number of threads to start up</param>
+    /// <param name="numaMode">Whether to pin the worker threads to NUMA nodes</param>
     /// <returns>The new data container instance</returns>
     /// <remarks>
     ///   This will result in a vanilla instance. The trickery you see in the code
@@ -88,7 +199,7 @@ namespace Nuclex { namespace Support { namespace Threading {
     ///   the std::thread array (which gets put directly after in memory).
     /// </remarks>
     public: static PlatformDependentImplementation *CreateInstance(
-      std::size_t minimumThreadCount, std::size_t maximumThreadCount
+      std::size_t minimumThreadCount, std::size_t maximumThreadCount, NumaMode numaMode
     );
 
     /// <summary>Destroys an instance of the platform dependent data container</summary>
@@ -98,8 +209,9 @@ namespace Nuclex { namespace Support { namespace Threading {
     /// <summary>Initializes a platform dependent data members of the process</summary>
     /// <param name="minimumThreadCount">Minimum number of threads to keep running</param>
     /// <param name="maximumThreadcount">Maximum number of threads to start up</param>
+    /// <param name="numaMode">Whether to pin the worker threads to NUMA nodes</param>
     protected: PlatformDependentImplementation(
-      std::size_t minimumThreadCount, std::size_t maximumThreadCount
+      std::size_t minimumThreadCount, std::size_t maximumThreadCount, NumaMode numaMode
     );
 
     /// <summary>Destroys the resources owned by the platform dependent data container</summary>
@@ -113,29 +225,181 @@ namespace Nuclex { namespace Support { namespace Threading {
     /// <param name="threadIndex">Unique index of the thread</param>
     private: void runThreadWorkLoop(std::size_t threadIndex);
 
+    /// <summary>Looks for a task the specified worker thread can execute</summary>
+    /// <param name="threadIndex">Index of the worker thread looking for work</param>
+    /// <param name="executedTaskCount">Number of tasks the worker has executed so far</param>
+    /// <param name="submittedTask">Receives the task if one was found</param>
+    /// <returns>True if a task was found, false otherwise</returns>
+    private: bool tryTakeTask(
+      std::size_t threadIndex, std::size_t executedTaskCount, SubmittedTask *&submittedTask
+    );
+
+    /// <summary>Looks for a normal priority task the worker thread can execute</summary>
+    /// <param name="threadIndex">Index of the worker thread looking for work</param>
+    /// <param name="preferSharedQueue">
+    ///   Whether to check the shared queue before the worker's own deque
+    /// </param>
+    /// <param name="submittedTask">Receives the task if one was found</param>
+    /// <returns>True if a task was found, false otherwise</returns>
+    private: bool tryTakeNormalPriorityTask(
+      std::size_t threadIndex, bool preferSharedQueue, SubmittedTask *&submittedTask
+    );
+
+    /// <summary>Tries to take a task from the shared queues of a priority lane</summary>
+    /// <param name="nodeIndex">NUMA node whose shared queue will be checked first</param>
+    /// <param name="priority">Priority lane from which a task will be taken</param>
+    /// <param name="submittedTask">Receives the task if one was found</param>
+    /// <returns>True if a task was taken, false if the lane was empty</returns>
+    private: bool tryTakeSharedTask(
+      std::size_t nodeIndex, Priority priority, SubmittedTask *&submittedTask
+    );
+
+    /// <summary>Tries to steal a task from another worker thread's deque</summary>
+    /// <param name="threadIndex">Index of the worker thread looking for work</param>
+    /// <param name="submittedTask">Receives the task if one could be stolen</param>
+    /// <returns>True if a task was stolen, false otherwise</returns>
+    private: bool tryStealTask(std::size_t threadIndex, SubmittedTask *&submittedTask);
+
+    /// <summary>Destroys a task without executing it</summary>
+    /// <param name="threadIndex">Index of the worker thread doing the cancellation</param>
+    /// <param name="submittedTask">Task that will be destroyed</param>
+    private: void cancelTask(std::size_t threadIndex, SubmittedTask *submittedTask);
+
     /// <summary>Fast-forwards through all tasks, destroying them</summary>
-    private: void cancelAllTasks();
+    /// <param name="threadIndex">Index of the worker thread doing the cancellation</param>
+    private: void cancelAllTasks(std::size_t threadIndex);
+
+    /// <summary>Determines the NUMA node whose queues a new task should go into</summary>
+    /// <returns>The index of the NUMA node the calling thread is running on</returns>
+    public: std::size_t GetSubmittingNodeIndex() const;
+
+    /// <summary>Looks up the shared queue for a priority lane in a NUMA node</summary>
+    /// <param name="nodeIndex">Index of the NUMA node whose queue will be returned</param>
+    /// <param name="priority">Priority lane whose queue will be returned</param>
+    /// <returns>The shared queue for the specified NUMA node and priority lane</returns>
+    public: moodycamel::ConcurrentQueue<SubmittedTask *> &GetSharedQueue(
+      std::size_t nodeIndex, Priority priority
+    ) {
+      return this->ScheduledTasks[nodeIndex * 3 + static_cast<std::size_t>(priority)];
+    }
+
+    /// <summary>Wakes up sleeping worker threads if there are any</summary>
+    /// <param name="taskCount">Number of tasks that have been added</param>
+    public: void WakeIdleThreads(std::size_t taskCount = 1);
+
+    /// <summary>Stamps a task with its submission time if it is chosen to be timed</summary>
+    /// <param name="submittedTask">Task that is about to be submitted</param>
+    public: static void StampSubmissionTime(SubmittedTask &submittedTask);
+
+    /// <summary>Adds up the statistics counters of all worker threads</summary>
+    /// <returns>A snapshot of the thread pool's counters</returns>
+    public: Statistics GetStatistics() const;
+
+    /// <summary>Wakes up the sizing thread unless it is already awake</summary>
+    public: void WakeSizingThread();
+
+    /// <summary>Starts the thread that adds threads when tasks pile up</summary>
+    public: void StartSizingThread();
+
+    /// <summary>Stops the sizing thread again</summary>
+    public: void StopSizingThread();
+
+    /// <summary>Retrieves the thresholds that control the thread pool's size</summary>
+    /// <returns>A copy of the current sizing options</returns>
+    public: SizingOptions GetSizingOptions() const;
+
+    /// <summary>Method that is executed by the thread pool's sizing thread</summary>
+    private: void runSizingLoop();
+
+    /// <summary>Looks at the worker threads' progress since the previous sample</summary>
+    /// <param name="now">Current time</param>
+    /// <param name="options">Thresholds used to detect blocked worker threads</param>
+    /// <returns>A sample describing the load of the thread pool</returns>
+    private: ThreadPoolSizer::Sample takeSample(
+      std::chrono::steady_clock::time_point now, const SizingOptions &options
+    );
+
+    /// <summary>Checks whether an idle worker thread is allowed to exit</summary>
+    /// <param name="idleSince">Time at which the worker thread ran out of work</param>
+    /// <returns>True if the worker thread may exit, false if it should stay around</returns>
+    private: bool mayRetireIdleThread(std::chrono::steady_clock::time_point idleSince);
+
+    /// <summary>Gives up the calling worker thread's place in the thread count</summary>
+    /// <param name="previousThreadCount">Receives the thread count before giving it up</param>
+    /// <returns>True if the thread can exit, false if the pool is at its minimum</returns>
+    private: bool tryGiveUpThreadSlot(int &previousThreadCount);
+
+    /// <summary>Thread pool the calling thread is a worker thread of</summary>
+    public: thread_local static PlatformDependentImplementation *CurrentWorkerPool;
+    /// <summary>Index of the calling worker thread within its thread pool</summary>
+    public: thread_local static std::size_t CurrentWorkerIndex;
+    /// <summary>Number of tasks the calling thread has submitted to any thread pool</summary>
+    public: thread_local static std::size_t SubmissionCount;
 
     /// <summary>Minimum number of threads to always keep running</summary>
     public: std::size_t MinimumThreadCount;
     /// <summary>Maximum number of threads to create under high load</summary>
     public: std::size_t MaximumThreadCount;
+    /// <summary>Number of NUMA nodes the worker threads are distributed over</summary>
+    /// <remarks>
+    ///   Always 1 unless the thread pool was created with NumaMode::PinnedPerNode.
+    ///   Worker thread <c>n</c> belongs to NUMA node <c>n % NumaNodeCount</c>.
+    /// </remarks>
+    public: std::size_t NumaNodeCount;
+    /// <summary>CPU topology of the system, only queried in NUMA mode</summary>
+    public: std::unique_ptr<CpuTopology> Topology;
+    /// <summary>CPUs the worker threads of each NUMA node will be pinned to</summary>
+    public: std::vector<CpuSet> NumaNodeCpus;
     /// <summary>Number of threads currently running</summary>
     public: std::atomic<int> ThreadCount;
     /// <summary>Number of threads that are currently processing a task</summary>
     public: std::atomic<std::size_t> TaskCount;
     /// <summary>Whether the thread pool is in the process of shutting down</summary>
     public: std::atomic<bool> IsShuttingDown;
-    /// <summary>Semaphore that allows one thread for each task to pass</summary>
+    /// <summary>Number of worker threads that have gone or are going to sleep</summary>
+    public: std::atomic<std::size_t> IdleThreadCount;
+    /// <summary>Semaphore through which sleeping worker threads are woken up</summary>
     public: Semaphore TaskSemaphore;
     /// <summary>Incremented by the last thread exiting when IsShuttingDown is true</summary>
     public: Gate LightsOut;
-    /// <summary>Tasks that have been scheduled for execution in the thread pool</summary>
-    public: moodycamel::ConcurrentQueue<SubmittedTask *> ScheduledTasks;
-    /// <summary>Submitted tasks for re-use</summary>
-    public: ThreadPoolTaskPool<
+    /// <summary>Tasks that have been scheduled for execution</summary>
+    /// <remarks>
+    ///   Each NUMA node has one queue per priority lane, use GetSharedQueue() to access.
+    /// </remarks>
+    public: std::unique_ptr<moodycamel::ConcurrentQueue<SubmittedTask *>[]> ScheduledTasks;
+    /// <summary>Tasks scheduled from within the worker threads, one deque per thread</summary>
+    public: std::unique_ptr<ThreadPoolWorkDeque<SubmittedTask *>[]> WorkerDeques;
+    /// <summary>Progress of each worker thread, observed by the sizing samples</summary>
+    public: std::unique_ptr<WorkerActivity[]> WorkerActivities;
+    /// <summary>Protects the sizing options while they're being changed or copied</summary>
+    public: mutable std::mutex SizingOptionsMutex;
+    /// <summary>Thresholds that control how the thread pool grows and shrinks</summary>
+    public: SizingOptions Sizing;
+    /// <summary>Takes samples of the load while tasks are piling up</summary>
+    public: std::thread SizingThread;
+    /// <summary>Used to wake up the sizing thread and to let it sleep between samples</summary>
+    public: Semaphore SizingSemaphore;
+    /// <summary>Whether the sizing thread has been woken up and is taking samples</summary>
+    public: std::atomic<bool> IsSizingThreadAwake;
+    /// <summary>Time at which the previous sample was taken</summary>
+    public: std::chrono::steady_clock::time_point PreviousSampleTime;
+    /// <summary>Decides whether threads should be added or removed</summary>
+    public: ThreadPoolSizer Sizer;
+    /// <summary>Steady clock ticks at which the thread pool last grew</summary>
+    public: std::atomic<std::chrono::steady_clock::rep> LastGrowthTicks;
+    /// <summary>Steady clock ticks at which an idle thread last exited</summary>
+    public: std::atomic<std::chrono::steady_clock::rep> LastRetirementTicks;
+    /// <summary>Number of threads the sizer wants to get rid of</summary>
+    public: std::atomic<std::size_t> RequestedRetirementCount;
+    /// <summary>Task pool type used to recycle the memory of submitted tasks</summary>
+    public: typedef ThreadPoolTaskPool<
       SubmittedTask, offsetof(SubmittedTask, Payload)
-    > SubmittedTaskPool;
+    > SubmittedTaskPoolType;
+
+    /// <summary>Submitted tasks for re-use, with one shard per worker thread</summary>
+    public: SubmittedTaskPoolType SubmittedTaskPool;
+    /// <summary>Posts delayed and periodic tasks when they become due</summary>
+    public: std::unique_ptr<ThreadPoolTimerQueue> Timers;
     /// <summary>Status of all allocated thread slots</summary>
     /// <remarks>
     ///   -1: killed, 0: unused, 1: under construction, 2: running, 3: shutting down
@@ -148,9 +412,22 @@ namespace Nuclex { namespace Support { namespace Threading {
 
   // ------------------------------------------------------------------------------------------- //
 
+  thread_local ThreadPool::PlatformDependentImplementation *
+  ThreadPool::PlatformDependentImplementation::CurrentWorkerPool = nullptr;
+
+  // ------------------------------------------------------------------------------------------- //
+
+  thread_local std::size_t ThreadPool::PlatformDependentImplementation::CurrentWorkerIndex = 0;
+
+  // ------------------------------------------------------------------------------------------- //
+
+  thread_local std::size_t ThreadPool::PlatformDependentImplementation::SubmissionCount = 0;
+
+  // ------------------------------------------------------------------------------------------- //
+
   ThreadPool::PlatformDependentImplementation *
   ThreadPool::PlatformDependentImplementation::CreateInstance(
-    std::size_t minimumThreadCount, std::size_t maximumThreadCount
+    std::size_t minimumThreadCount, std::size_t maximumThreadCount, NumaMode numaMode
   ) {
     std::size_t requiredByteCount = (
       sizeof(PlatformDependentImplementation) +
@@ -164,7 +441,9 @@ namespace Nuclex { namespace Support { namespace Threading {
 
     // Construct the platform-dependent implementation in-place
     PlatformDependentImplementation *instance = (
-      new(buffer.get()) PlatformDependentImplementation(minimumThreadCount, maximumThreadCount)
+      new(buffer.get()) PlatformDependentImplementation(
+        minimumThreadCount, maximumThreadCount, numaMode
+      )
     );
 
     // Thread status atomics directly follow the main structure
@@ -228,7 +507,14 @@ namespace Nuclex { namespace Support { namespace Threading {
 
     // Before shutting down, the worker threads should have called cancelAllTasks(),
     // destroying all scheduled tasks without invoking their callbacks.
-    assert(instance->ScheduledTasks.size_approx() == 0);
+#if !defined(NDEBUG)
+    for(std::size_t index = 0; index < instance->NumaNodeCount * 3; ++index) {
+      assert(instance->ScheduledTasks[index].size_approx() == 0);
+    }
+    for(std::size_t index = 0; index < instance->MaximumThreadCount; ++index) {
+      assert(instance->WorkerDeques[index].IsEmpty());
+    }
+#endif
 
     // Leave the rest up to the normal destructor, them reclaim the memory
     instance->~PlatformDependentImplementation();
@@ -239,19 +525,77 @@ namespace Nuclex { namespace Support { namespace Threading {
   // ------------------------------------------------------------------------------------------- //
 
   ThreadPool::PlatformDependentImplementation::PlatformDependentImplementation(
-    std::size_t minimumThreadCount, std::size_t maximumThreadCount
+    std::size_t minimumThreadCount, std::size_t maximumThreadCount, NumaMode numaMode
   ) :
     MinimumThreadCount(minimumThreadCount),
     MaximumThreadCount(maximumThreadCount),
+    NumaNodeCount(1),
+    Topology(),
+    NumaNodeCpus(),
     ThreadCount(0),
     TaskCount(0),
     IsShuttingDown(false),
+    IdleThreadCount(0),
     TaskSemaphore(0),
     LightsOut(false),
     ScheduledTasks(),
-    SubmittedTaskPool(),
+    WorkerDeques(new ThreadPoolWorkDeque<SubmittedTask *>[maximumThreadCount]),
+    WorkerActivities(new WorkerActivity[maximumThreadCount]),
+    SizingOptionsMutex(),
+    Sizing(),
+    SizingThread(),
+    SizingSemaphore(0),
+    IsSizingThreadAwake(false),
+    PreviousSampleTime(std::chrono::steady_clock::now()),
+    Sizer(minimumThreadCount, maximumThreadCount),
+    LastGrowthTicks(0),
+    LastRetirementTicks(0),
+    RequestedRetirementCount(0),
+    SubmittedTaskPool(maximumThreadCount),
     ThreadStatus(nullptr),
-    Threads(nullptr) {}
+    Threads(nullptr) {
+
+    if(numaMode == NumaMode::PinnedPerNode) {
+      this->Topology.reset(new CpuTopology(CpuTopology::Query()));
+      this->NumaNodeCount = this->Topology->CountNumaNodes();
+
+      // If the process has been restricted to a subset of CPUs (i.e. via taskset or
+      // a container's cpuset), stay within those CPUs when pinning the workers.
+      CpuSet allowedCpus = this->Topology->GetOnlineCpus();
+      try {
+        allowedCpus &= Thread::GetCpuAffinity();
+      }
+      catch(const std::exception &) {
+        // Affinity could not be queried, assume all online CPUs are allowed
+      }
+
+      this->NumaNodeCpus.reserve(this->NumaNodeCount);
+      for(std::size_t index = 0; index < this->NumaNodeCount; ++index) {
+        CpuSet nodeCpus = this->Topology->GetNumaNodeCpus(index) & allowedCpus;
+        if(nodeCpus.IsEmpty()) {
+          nodeCpus = this->Topology->GetNumaNodeCpus(index);
+        }
+        this->NumaNodeCpus.push_back(nodeCpus);
+      }
+    }
+
+    this->ScheduledTasks.reset(
+      new moodycamel::ConcurrentQueue<SubmittedTask *>[this->NumaNodeCount * 3]
+    );
+
+    for(std::size_t index = 0; index < maximumThreadCount; ++index) {
+      WorkerActivity &activity = this->WorkerActivities[index];
+      activity.TransitionCount.store(0, std::memory_order_relaxed);
+      activity.SampledTransitionCount = 0;
+      activity.StolenTaskCount.store(0, std::memory_order_relaxed);
+      activity.CanceledTaskCount.store(0, std::memory_order_relaxed);
+      for(std::size_t bucket = 0; bucket < Statistics::HistogramBucketCount; ++bucket) {
+        activity.QueueWaitHistogram[bucket].store(0, std::memory_order_relaxed);
+        activity.ExecutionTimeHistogram[bucket].store(0, std::memory_order_relaxed);
+      }
+    }
+
+  }
 
   // ------------------------------------------------------------------------------------------- //
 
@@ -334,96 +678,311 @@ namespace Nuclex { namespace Support { namespace Threading {
 
   void ThreadPool::PlatformDependentImplementation::runThreadWorkLoop(std::size_t threadIndex) {
     ThreadPoolConfig::IsThreadPoolThread = true;
+    CurrentWorkerPool = this;
+    CurrentWorkerIndex = threadIndex;
+
+    // Set when the thread already gave up its place in the thread count
+    // because it was idle for too long
+    int previousThreadCount = 0;
+
+    // In NUMA mode, keep the worker thread on the CPUs of its NUMA node. If this fails
+    // (for example because the CPUs went offline), the thread simply runs unpinned.
+    if(!this->NumaNodeCpus.empty()) {
+      try {
+        Thread::SetCpuAffinity(this->NumaNodeCpus[threadIndex % this->NumaNodeCount]);
+      }
+      catch(const std::exception &) {
+        // Pinning is an optimization, the worker thread is still fully functional
+      }
+    }
 
     // Mark the thread as running
     this->ThreadStatus[threadIndex].store(2, std::memory_order_release);
     ON_SCOPE_EXIT {
+      CurrentWorkerPool = nullptr;
       this->ThreadStatus[threadIndex].store(-1, std::memory_order_release);
-      std::size_t remainingThreadCount = this->ThreadCount.fetch_sub(
-        1, std::memory_order_consume // if() below carries dependency
-      );
-      if(unlikely(remainingThreadCount == 1)) { // 1 because we're getting the previous value
+      if(likely(previousThreadCount == 0)) {
+        previousThreadCount = this->ThreadCount.fetch_sub(
+          1, std::memory_order_consume // if() below carries dependency
+        );
+      }
+      if(unlikely(previousThreadCount == 1)) { // 1 because we're getting the previous value
         this->LightsOut.Open();
       }
     };
 
-    // Number of heart beats we went through without anything to do
-    std::size_t idleHeartBeatCount = 0;
+    // Time at which this thread ran out of work, only valid while it is idle
+    std::chrono::steady_clock::time_point idleSince;
+    bool isIdle = false;
+    // Number of tasks this thread has executed, used to poll the shared queue regularly
+    std::size_t executedTaskCount = 0;
+    WorkerActivity &activity = this->WorkerActivities[threadIndex];
 
     // Keep looking for work to do
     for(;;) {
       bool isShuttingDown = this->IsShuttingDown.load(std::memory_order_consume);
       if(unlikely(isShuttingDown)) {
-        cancelAllTasks();
+        cancelAllTasks(threadIndex);
         break;
       }
 
-      // Wait for work to become available. This semaphore is incremented each time
-      // a task is scheduled, meaning it will let one thread from the pool come through
-      // to process each task. The wait timeout is our heart beat interval.
-      bool gotWoken = this->TaskSemaphore.WaitForThenDecrement(
-        std::chrono::milliseconds(ThreadPoolConfig::WorkerHeartBeatMilliseconds)
-      );
-      if(!gotWoken) {
-        ++idleHeartBeatCount;
-        if(idleHeartBeatCount > ThreadPoolConfig::IdleShutDownHeartBeats) {
-          int oldThreadCount = this->ThreadCount.fetch_sub(1, std::memory_order_release);
-          bool canTerminate = (
-            (oldThreadCount > 0) &&
-            (static_cast<std::size_t>(oldThreadCount) > this->MinimumThreadCount)
+      // Look for work in the priority lanes, our own deque, the shared queue and
+      // the other threads' deques.
+      SubmittedTask *submittedTask;
+      bool wasTaken = tryTakeTask(threadIndex, executedTaskCount, submittedTask);
+      if(!wasTaken) {
+
+        // Announce that we're about to go to sleep, then look once more. Any thread
+        // scheduling a task after our announcement will see it and wake us up and any
+        // task scheduled before our announcement will be found by the second look.
+        this->IdleThreadCount.fetch_add(1, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        wasTaken = tryTakeTask(threadIndex, executedTaskCount, submittedTask);
+        if(!wasTaken) {
+          if(!isIdle) {
+            idleSince = std::chrono::steady_clock::now();
+            isIdle = true;
+          }
+
+          // Wait for work to become available. The semaphore is incremented each time
+          // a task is scheduled while threads are sleeping. The wait timeout is our
+          // heart beat interval.
+          bool gotWoken = this->TaskSemaphore.WaitForThenDecrement(
+            std::chrono::milliseconds(ThreadPoolConfig::WorkerHeartBeatMilliseconds)
           );
-          if(canTerminate) {
-            break; // Thread was idle for too long and can shut down
-          } else {
-            this->ThreadCount.fetch_add(1, std::memory_order_release);
-            idleHeartBeatCount = ThreadPoolConfig::IdleShutDownHeartBeats;
+          this->IdleThreadCount.fetch_sub(1, std::memory_order_release);
+          if(!gotWoken) {
+            if(mayRetireIdleThread(idleSince)) {
+              if(tryGiveUpThreadSlot(previousThreadCount)) {
+                break; // Thread was idle for too long and can shut down
+              }
+            }
           }
+
+          continue;
+        }
+
+        this->IdleThreadCount.fetch_sub(1, std::memory_order_release);
+      }
+
+      // If the task's stop token was canceled while it sat in the queue, nobody is
+      // interested in its outcome anymore, so drop it without wasting time on it
+      const std::shared_ptr<const StopToken> &cancellationToken = (
+        submittedTask->Task->CancellationToken
+      );
+      if(unlikely(static_cast<bool>(cancellationToken))) {
+        if(cancellationToken->IsCanceled()) {
+          cancelTask(threadIndex, submittedTask);
+          continue;
         }
       }
 
-      // If we have more tasks than running threads, spawn another thread in
-      // case there's still room.
+      // Execute the task and return the submitted task container to the pool
       {
-        std::size_t safeThreadCount = this->ThreadCount.load(
-          std::memory_order_consume
+        // Only tasks stamped by the submitting thread are timed for the statistics
+        std::chrono::steady_clock::rep submitTicks = submittedTask->SubmitTicks;
+        std::chrono::steady_clock::time_point startTime;
+        if(unlikely(submitTicks != 0)) {
+          startTime = std::chrono::steady_clock::now();
+          std::chrono::steady_clock::duration queueWait = (
+            startTime.time_since_epoch() - std::chrono::steady_clock::duration(submitTicks)
+          );
+          incrementOwnCounter(activity.QueueWaitHistogram[getHistogramBucket(queueWait)]);
+        }
+
+        ON_SCOPE_EXIT {
+          if(unlikely(submitTicks != 0)) {
+            std::chrono::steady_clock::duration executionTime = (
+              std::chrono::steady_clock::now() - startTime
+            );
+            incrementOwnCounter(
+              activity.ExecutionTimeHistogram[getHistogramBucket(executionTime)]
+            );
+          }
+          activity.TransitionCount.store(
+            activity.TransitionCount.load(std::memory_order_relaxed) + 1,
+            std::memory_order_release
+          );
+          this->TaskCount.fetch_sub(1, std::memory_order_release);
+          submittedTask->Task->~Task();
+          this->SubmittedTaskPool.ReturnTask(submittedTask, threadIndex);
+        };
+
+        isIdle = false;
+        ++executedTaskCount;
+        activity.TransitionCount.store(
+          activity.TransitionCount.load(std::memory_order_relaxed) + 1,
+          std::memory_order_release
         );
-        if(safeThreadCount < this->MaximumThreadCount) {
-          std::size_t safeTaskCount = this->TaskCount.load(
-            std::memory_order_consume
+        submittedTask->Task->operator()();
+      }
+
+      // If the sizer decided that there are too many threads, leave (but only if our
+      // own deque is empty, otherwise its tasks would have to wait for a thief)
+      std::size_t requestedRetirementCount = this->RequestedRetirementCount.load(
+        std::memory_order_relaxed
+      );
+      if(unlikely(requestedRetirementCount > 0)) {
+        if(this->WorkerDeques[threadIndex].IsEmpty()) {
+          bool wasClaimed = this->RequestedRetirementCount.compare_exchange_strong(
+            requestedRetirementCount, requestedRetirementCount - 1,
+            std::memory_order_relaxed, std::memory_order_relaxed
           );
-          if(safeTaskCount > safeThreadCount + 1) {
-            AddThread();
+          if(wasClaimed) {
+            if(tryGiveUpThreadSlot(previousThreadCount)) {
+              break;
+            }
           }
         }
       }
+    } // for(;;)
+  }
 
-      // Execute a task and return the submitted task container to the pool
-      {
-        SubmittedTask *submittedTask;
-        bool wasDequeued = this->ScheduledTasks.try_dequeue(submittedTask);
-        if(wasDequeued) {
-          ON_SCOPE_EXIT {
-            this->TaskCount.fetch_sub(1, std::memory_order_release);
-            submittedTask->Task->~Task();
-            this->SubmittedTaskPool.ReturnTask(submittedTask);
-          };
-
-          idleHeartBeatCount = 0;
-          submittedTask->Task->operator()();
+  // ------------------------------------------------------------------------------------------- //
+
+  bool ThreadPool::PlatformDependentImplementation::tryTakeTask(
+    std::size_t threadIndex, std::size_t executedTaskCount, SubmittedTask *&submittedTask
+  ) {
+
+    // Every so often, check the lanes from lowest to highest priority so that
+    // background work still progresses when the higher lanes are saturated
+    std::size_t nodeIndex = threadIndex % this->NumaNodeCount;
+    bool isReverseOrderTurn = (
+      (executedTaskCount % ThreadPoolConfig::LowPriorityShareInterval) ==
+      (ThreadPoolConfig::LowPriorityShareInterval - 1)
+    );
+    if(unlikely(isReverseOrderTurn)) {
+      return (
+        tryTakeSharedTask(nodeIndex, Priority::Low, submittedTask) ||
+        tryTakeNormalPriorityTask(threadIndex, true, submittedTask) ||
+        tryTakeSharedTask(nodeIndex, Priority::High, submittedTask)
+      );
+    }
+
+    // Also every so often, the normal priority shared queue is checked before our own
+    // deque so that tasks scheduled from outside of the thread pool do not starve while
+    // the worker threads keep feeding their own deques.
+    bool preferSharedQueue = (
+      (executedTaskCount % ThreadPoolConfig::SharedQueuePollInterval) == 0
+    );
+    return (
+      tryTakeSharedTask(nodeIndex, Priority::High, submittedTask) ||
+      tryTakeNormalPriorityTask(threadIndex, preferSharedQueue, submittedTask) ||
+      tryTakeSharedTask(nodeIndex, Priority::Low, submittedTask)
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  bool ThreadPool::PlatformDependentImplementation::tryTakeNormalPriorityTask(
+    std::size_t threadIndex, bool preferSharedQueue, SubmittedTask *&submittedTask
+  ) {
+    std::size_t nodeIndex = threadIndex % this->NumaNodeCount;
+    if(unlikely(preferSharedQueue)) {
+      if(tryTakeSharedTask(nodeIndex, Priority::Normal, submittedTask)) {
+        return true;
+      }
+    }
+
+    // Our own deque is popped from the end, so the most recently scheduled task,
+    // whose data is most likely still in the CPU cache, gets executed first.
+    if(this->WorkerDeques[threadIndex].TryPop(submittedTask)) {
+      return true;
+    }
+
+    if(likely(!preferSharedQueue)) {
+      if(tryTakeSharedTask(nodeIndex, Priority::Normal, submittedTask)) {
+        return true;
+      }
+    }
+
+    return tryStealTask(threadIndex, submittedTask);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  bool ThreadPool::PlatformDependentImplementation::tryTakeSharedTask(
+    std::size_t nodeIndex, Priority priority, SubmittedTask *&submittedTask
+  ) {
+    if(GetSharedQueue(nodeIndex, priority).try_dequeue(submittedTask)) {
+      return true;
+    }
+
+    // Nothing in our own NUMA node's queue, help out the other NUMA nodes
+    for(std::size_t offset = 1; offset < this->NumaNodeCount; ++offset) {
+      std::size_t otherNodeIndex = (nodeIndex + offset) % this->NumaNodeCount;
+      if(GetSharedQueue(otherNodeIndex, priority).try_dequeue(submittedTask)) {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  bool ThreadPool::PlatformDependentImplementation::tryStealTask(
+    std::size_t threadIndex, SubmittedTask *&submittedTask
+  ) {
+    std::size_t nodeIndex = threadIndex % this->NumaNodeCount;
+
+    // Go through the other threads' deques, starting with our neighbor so that
+    // the thieves spread out over the deques rather than all hitting the first one.
+    // The first pass only visits threads in our own NUMA node, the second pass
+    // (only done if there are multiple NUMA nodes) visits all the other threads.
+    for(std::size_t pass = 0; pass < 2; ++pass) {
+      bool isSameNodePass = (pass == 0);
+      for(std::size_t offset = 1; offset < this->MaximumThreadCount; ++offset) {
+        std::size_t victimIndex = (threadIndex + offset) % this->MaximumThreadCount;
+        if(((victimIndex % this->NumaNodeCount) == nodeIndex) != isSameNodePass) {
+          continue;
         }
-      } // take and execute one submitted task
-    } // for(;;)
+
+        // A steal attempt fails if another thread took the task first,
+        // so keep trying for as long as the deque has tasks left in it.
+        ThreadPoolWorkDeque<SubmittedTask *> &victimDeque = this->WorkerDeques[victimIndex];
+        while(!victimDeque.IsEmpty()) {
+          if(victimDeque.TrySteal(submittedTask)) {
+            incrementOwnCounter(this->WorkerActivities[threadIndex].StolenTaskCount);
+            return true;
+          }
+        }
+      }
+
+      if(this->NumaNodeCount < 2) {
+        break;
+      }
+    }
+
+    return false;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void ThreadPool::PlatformDependentImplementation::cancelTask(
+    std::size_t threadIndex, SubmittedTask *submittedTask
+  ) {
+    incrementOwnCounter(this->WorkerActivities[threadIndex].CanceledTaskCount);
+    this->TaskCount.fetch_sub(1, std::memory_order_release);
+    submittedTask->Task->~Task();
+    this->SubmittedTaskPool.ReturnTask(submittedTask, threadIndex);
   }
 
   // ------------------------------------------------------------------------------------------- //
 
-  void ThreadPool::PlatformDependentImplementation::cancelAllTasks() {
+  void ThreadPool::PlatformDependentImplementation::cancelAllTasks(std::size_t threadIndex) {
+    std::size_t nodeIndex = threadIndex % this->NumaNodeCount;
     for(;;) {
       SubmittedTask *submittedTask;
-      bool wasDequeued = this->ScheduledTasks.try_dequeue(submittedTask);
-      if(wasDequeued) {
-        submittedTask->Task->~Task();
-        this->SubmittedTaskPool.DeleteTask(submittedTask);
+      bool wasTaken = (
+        this->WorkerDeques[threadIndex].TryPop(submittedTask) ||
+        tryTakeSharedTask(nodeIndex, Priority::High, submittedTask) ||
+        tryTakeSharedTask(nodeIndex, Priority::Normal, submittedTask) ||
+        tryTakeSharedTask(nodeIndex, Priority::Low, submittedTask) ||
+        tryStealTask(threadIndex, submittedTask)
+      );
+      if(wasTaken) {
+        cancelTask(threadIndex, submittedTask);
       } else {
         break;
       }
@@ -432,6 +991,328 @@ namespace Nuclex { namespace Support { namespace Threading {
 
   // ------------------------------------------------------------------------------------------- //
 
+  std::size_t ThreadPool::PlatformDependentImplementation::GetSubmittingNodeIndex() const {
+    if(likely(this->NumaNodeCount < 2)) {
+      return 0;
+    }
+
+    // Worker threads are pinned to their NUMA node, so we already know where they are
+    if(CurrentWorkerPool == this) {
+      return CurrentWorkerIndex % this->NumaNodeCount;
+    }
+
+    return this->Topology->GetNumaNodeOfCpu(CpuTopology::GetCurrentCpuIndex());
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void ThreadPool::PlatformDependentImplementation::WakeIdleThreads(std::size_t taskCount) {
+
+    // This fence pairs with the one in the worker thread's sleep announcement. Either
+    // we see the worker's announcement here or the worker sees the task we just added.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    std::size_t idleThreadCount = this->IdleThreadCount.load(std::memory_order_relaxed);
+    if(idleThreadCount > 0) {
+      this->TaskSemaphore.Post(std::min(idleThreadCount, taskCount));
+    }
+
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void ThreadPool::PlatformDependentImplementation::StampSubmissionTime(
+    SubmittedTask &submittedTask
+  ) {
+    ++SubmissionCount;
+    if(unlikely((SubmissionCount % ThreadPoolConfig::TimingSampleInterval) == 0)) {
+      submittedTask.SubmitTicks = std::chrono::steady_clock::now().time_since_epoch().count();
+      if(unlikely(submittedTask.SubmitTicks == 0)) {
+        submittedTask.SubmitTicks = 1; // Zero means untimed, so dodge it
+      }
+    } else {
+      submittedTask.SubmitTicks = 0;
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  ThreadPool::Statistics ThreadPool::PlatformDependentImplementation::GetStatistics() const {
+    Statistics statistics;
+    statistics.CompletedTaskCount = 0;
+    statistics.StolenTaskCount = 0;
+    statistics.CanceledTaskCount = 0;
+    statistics.QueueWaitHistogram.fill(0);
+    statistics.ExecutionTimeHistogram.fill(0);
+
+    std::size_t busyThreadCount = 0;
+    for(std::size_t index = 0; index < this->MaximumThreadCount; ++index) {
+      const WorkerActivity &activity = this->WorkerActivities[index];
+      std::size_t transitionCount = activity.TransitionCount.load(std::memory_order_acquire);
+      statistics.CompletedTaskCount += transitionCount / 2;
+      if((transitionCount & 1) != 0) {
+        ++busyThreadCount;
+      }
+
+      statistics.StolenTaskCount += activity.StolenTaskCount.load(std::memory_order_relaxed);
+      statistics.CanceledTaskCount += activity.CanceledTaskCount.load(
+        std::memory_order_relaxed
+      );
+      for(std::size_t bucket = 0; bucket < Statistics::HistogramBucketCount; ++bucket) {
+        statistics.QueueWaitHistogram[bucket] += activity.QueueWaitHistogram[bucket].load(
+          std::memory_order_relaxed
+        );
+        statistics.ExecutionTimeHistogram[bucket] += (
+          activity.ExecutionTimeHistogram[bucket].load(std::memory_order_relaxed)
+        );
+      }
+    }
+
+    // The task count includes both the queued tasks and the tasks being executed
+    std::size_t taskCount = this->TaskCount.load(std::memory_order_relaxed);
+    statistics.RunningTaskCount = std::min(busyThreadCount, taskCount);
+    statistics.QueuedTaskCount = taskCount - statistics.RunningTaskCount;
+
+    int threadCount = this->ThreadCount.load(std::memory_order_relaxed);
+    statistics.ThreadCount = static_cast<std::size_t>(std::max(threadCount, 0));
+    statistics.IdleThreadCount = std::min(
+      this->IdleThreadCount.load(std::memory_order_relaxed), statistics.ThreadCount
+    );
+
+    // Each task that didn't require an allocation has reused the memory of an earlier
+    // task. Counting reuses directly would need a shared counter on the hot path.
+    statistics.TaskMemoryAllocationCount = this->SubmittedTaskPool.CountAllocations();
+    std::size_t submittedTaskCount = (
+      statistics.CompletedTaskCount + statistics.CanceledTaskCount + taskCount
+    );
+    if(submittedTaskCount > statistics.TaskMemoryAllocationCount) {
+      statistics.TaskMemoryReuseCount = (
+        submittedTaskCount - statistics.TaskMemoryAllocationCount
+      );
+    } else {
+      statistics.TaskMemoryReuseCount = 0;
+    }
+
+    return statistics;
+  }
+  // ------------------------------------------------------------------------------------------- //
+
+  void ThreadPool::PlatformDependentImplementation::WakeSizingThread() {
+
+    // Cheap check first, an awake sizing thread will notice the backlog by itself
+    if(this->IsSizingThreadAwake.load(std::memory_order_relaxed)) {
+      return;
+    }
+
+    bool wasAwake = this->IsSizingThreadAwake.exchange(true, std::memory_order_seq_cst);
+    if(!wasAwake) {
+      this->SizingSemaphore.Post();
+    }
+
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void ThreadPool::PlatformDependentImplementation::StartSizingThread() {
+    std::thread newThread(&PlatformDependentImplementation::runSizingLoop, this);
+    this->SizingThread.swap(newThread);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void ThreadPool::PlatformDependentImplementation::StopSizingThread() {
+    if(this->SizingThread.joinable()) {
+      this->SizingSemaphore.Post();
+      this->SizingThread.join();
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void ThreadPool::PlatformDependentImplementation::runSizingLoop() {
+    for(;;) {
+      this->SizingSemaphore.WaitThenDecrement();
+
+      // Take a baseline sample right away, the decision is only made after one sample
+      // interval so that a backlog lasting a few microseconds doesn't add threads.
+      SizingOptions options = GetSizingOptions();
+      takeSample(std::chrono::steady_clock::now(), options);
+
+      // Keep taking samples for as long as tasks are waiting
+      for(;;) {
+        bool isShuttingDown = this->IsShuttingDown.load(std::memory_order_consume);
+        if(unlikely(isShuttingDown)) {
+          return;
+        }
+
+        this->SizingSemaphore.WaitForThenDecrement(options.SampleInterval);
+
+        isShuttingDown = this->IsShuttingDown.load(std::memory_order_consume);
+        if(unlikely(isShuttingDown)) {
+          return;
+        }
+
+        options = GetSizingOptions();
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        ThreadPoolSizer::Sample sample = takeSample(now, options);
+
+        // Let the sizer decide. Growing happens right here, shrinking is done by
+        // the worker threads themselves when they finish their current task.
+        std::ptrdiff_t adjustment = this->Sizer.Evaluate(sample, options);
+        if(adjustment > 0) {
+          this->RequestedRetirementCount.store(0, std::memory_order_relaxed);
+          this->LastGrowthTicks.store(
+            now.time_since_epoch().count(), std::memory_order_relaxed
+          );
+          while(adjustment > 0) {
+            if(!AddThread()) {
+              break;
+            }
+            --adjustment;
+          }
+        } else {
+          this->RequestedRetirementCount.store(
+            static_cast<std::size_t>(-adjustment), std::memory_order_relaxed
+          );
+        }
+
+        if(sample.QueuedTaskCount == 0) {
+          break;
+        }
+      }
+
+      // Go back to sleep. A thread scheduling a task may have seen us as still awake,
+      // so after announcing that we're asleep, check once more whether tasks are waiting.
+      this->IsSizingThreadAwake.store(false, std::memory_order_seq_cst);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+
+      std::size_t taskCount = this->TaskCount.load(std::memory_order_relaxed);
+      int threadCount = this->ThreadCount.load(std::memory_order_relaxed);
+      if(taskCount > static_cast<std::size_t>(std::max(threadCount, 0))) {
+        WakeSizingThread();
+      }
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  ThreadPoolSizer::Sample ThreadPool::PlatformDependentImplementation::takeSample(
+    std::chrono::steady_clock::time_point now, const SizingOptions &options
+  ) {
+    ThreadPoolSizer::Sample sample;
+    sample.Elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+      now - this->PreviousSampleTime
+    );
+    this->PreviousSampleTime = now;
+
+    // Look at the progress of each worker thread. Busy workers are in the middle of
+    // a task and if that task is still the same one after a while, the worker is blocked.
+    sample.BusyThreadCount = 0;
+    sample.BlockedThreadCount = 0;
+    sample.CompletedTaskCount = 0;
+    for(std::size_t index = 0; index < this->MaximumThreadCount; ++index) {
+      WorkerActivity &activity = this->WorkerActivities[index];
+      std::size_t transitionCount = activity.TransitionCount.load(std::memory_order_acquire);
+      sample.CompletedTaskCount += (
+        (transitionCount / 2) - (activity.SampledTransitionCount / 2)
+      );
+      if((transitionCount & 1) != 0) {
+        ++sample.BusyThreadCount;
+        if(transitionCount != activity.SampledTransitionCount) {
+          activity.BusySince = now;
+        } else if((now - activity.BusySince) >= options.BlockedWorkerThreshold) {
+          ++sample.BlockedThreadCount;
+        }
+      }
+      activity.SampledTransitionCount = transitionCount;
+    }
+
+    int threadCount = this->ThreadCount.load(std::memory_order_relaxed);
+    sample.ThreadCount = static_cast<std::size_t>(std::max(threadCount, 0));
+
+    std::size_t taskCount = this->TaskCount.load(std::memory_order_relaxed);
+    if(taskCount > sample.BusyThreadCount) {
+      sample.QueuedTaskCount = taskCount - sample.BusyThreadCount;
+    } else {
+      sample.QueuedTaskCount = 0;
+    }
+
+    return sample;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  ThreadPool::SizingOptions ThreadPool::PlatformDependentImplementation::GetSizingOptions(
+  ) const {
+    std::lock_guard<std::mutex> sizingOptionsScope(this->SizingOptionsMutex);
+    return this->Sizing;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  bool ThreadPool::PlatformDependentImplementation::mayRetireIdleThread(
+    std::chrono::steady_clock::time_point idleSince
+  ) {
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    SizingOptions options = GetSizingOptions();
+    if((now - idleSince) < options.IdleShutDownDelay) {
+      return false;
+    }
+
+    // Do not shrink right after the thread pool grew, the burst of work that
+    // made it grow may just be taking a breather
+    std::chrono::steady_clock::rep nowTicks = now.time_since_epoch().count();
+    std::chrono::steady_clock::rep idleShutDownDelayTicks = (
+      std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        options.IdleShutDownDelay
+      ).count()
+    );
+    std::chrono::steady_clock::rep lastGrowthTicks = this->LastGrowthTicks.load(
+      std::memory_order_relaxed
+    );
+    if((nowTicks - lastGrowthTicks) < idleShutDownDelayTicks) {
+      return false;
+    }
+
+    // Let only one thread exit per sample interval so the thread pool shrinks gradually
+    std::chrono::steady_clock::rep sampleIntervalTicks = (
+      std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        options.SampleInterval
+      ).count()
+    );
+    std::chrono::steady_clock::rep lastRetirementTicks = this->LastRetirementTicks.load(
+      std::memory_order_relaxed
+    );
+    if((nowTicks - lastRetirementTicks) < sampleIntervalTicks) {
+      return false;
+    }
+
+    return this->LastRetirementTicks.compare_exchange_strong(
+      lastRetirementTicks, nowTicks, std::memory_order_relaxed, std::memory_order_relaxed
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  bool ThreadPool::PlatformDependentImplementation::tryGiveUpThreadSlot(
+    int &previousThreadCount
+  ) {
+    int oldThreadCount = this->ThreadCount.fetch_sub(1, std::memory_order_release);
+    bool canTerminate = (
+      (oldThreadCount > 0) &&
+      (static_cast<std::size_t>(oldThreadCount) > this->MinimumThreadCount)
+    );
+    if(canTerminate) {
+      previousThreadCount = oldThreadCount;
+      return true;
+    } else {
+      this->ThreadCount.fetch_add(1, std::memory_order_release);
+      return false;
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
   std::size_t ThreadPool::GetDefaultMinimumThreadCount() {
 #if defined(NUCLEX_SUPPORT_LINUX)
     return ThreadPoolConfig::GuessDefaultMinimumThreadCount(
@@ -466,18 +1347,23 @@ namespace Nuclex { namespace Support { namespace Threading {
 
   ThreadPool::ThreadPool(
     std::size_t minimumThreadCount /* = GetDefaultMinimumThreadCount() */,
-    std::size_t maximumThreadCount /* = GetDefaultMaximumThreadCount() */
+    std::size_t maximumThreadCount /* = GetDefaultMaximumThreadCount() */,
+    NumaMode numaMode /* = NumaMode::Ignored */
   ) :
     implementation(
-      PlatformDependentImplementation::CreateInstance(minimumThreadCount, maximumThreadCount)
+      PlatformDependentImplementation::CreateInstance(
+        minimumThreadCount, maximumThreadCount, numaMode
+      )
     ) {
 
     auto destroyImplementationScope = ON_SCOPE_EXIT_TRANSACTION {
       PlatformDependentImplementation::DestroyInstance(this->implementation);
     };
+    this->implementation->Timers.reset(new ThreadPoolTimerQueue(*this));
     for(std::size_t index = 0; index < minimumThreadCount; ++index) {
       this->implementation->AddThread();
     }
+    this->implementation->StartSizingThread();
     destroyImplementationScope.Commit();
   }
 
@@ -485,11 +1371,18 @@ namespace Nuclex { namespace Support { namespace Threading {
 
   ThreadPool::~ThreadPool() {
 
+    // Stop posting delayed and periodic tasks, the timer thread would otherwise
+    // keep adding tasks to the queues while the worker threads try to empty them
+    this->implementation->Timers->Stop();
+
     // Set the shutdown flag (this causes the worker threads to shut down)
     this->implementation->IsShuttingDown.store(
       true, std::memory_order_release
     );
 
+    // Stop the sizing thread first so it can't add any more threads while we shut down
+    this->implementation->StopSizingThread();
+
     // Wake up all the worker threads by incrementing the semaphore enough times
     // (each thread will see the IsShuttingDown signal and not wait on the semaphore again)
     this->implementation->TaskSemaphore.Post(this->implementation->MaximumThreadCount);
@@ -511,8 +1404,15 @@ namespace Nuclex { namespace Support { namespace Threading {
   // ------------------------------------------------------------------------------------------- //
 
   std::uint8_t *ThreadPool::getOrCreateTaskMemory(std::size_t payload) {
+
+    // Worker threads of this thread pool have their own cache of reusable tasks
+    std::size_t shardIndex = PlatformDependentImplementation::SubmittedTaskPoolType::NoShard;
+    if(PlatformDependentImplementation::CurrentWorkerPool == this->implementation) {
+      shardIndex = PlatformDependentImplementation::CurrentWorkerIndex;
+    }
+
     std::uint8_t *submittedTaskMemory = reinterpret_cast<std::uint8_t *>(
-      this->implementation->SubmittedTaskPool.GetNewTask(payload)
+      this->implementation->SubmittedTaskPool.GetNewTask(payload, shardIndex)
     );
     return (
       submittedTaskMemory + offsetof(PlatformDependentImplementation::SubmittedTask, Payload)
@@ -521,7 +1421,7 @@ namespace Nuclex { namespace Support { namespace Threading {
 
   // ------------------------------------------------------------------------------------------- //
 
-  void ThreadPool::submitTask(std::uint8_t *taskMemory, Task *task) {
+  void ThreadPool::submitTask(std::uint8_t *taskMemory, Task *task, Priority priority) {
     std::uint8_t *submittedTaskMemory = (
       taskMemory - offsetof(PlatformDependentImplementation::SubmittedTask, Payload)
     );
@@ -532,21 +1432,176 @@ namespace Nuclex { namespace Support { namespace Threading {
     );
 
     submittedTask->Task = task;
+    PlatformDependentImplementation::StampSubmissionTime(*submittedTask);
+
+    // If a normal priority task is scheduled by one of our own worker threads, it goes
+    // into that thread's deque, otherwise it is placed in its priority lane's queue
+    // (of the NUMA node the calling thread is running on, if in NUMA mode)
+    bool isLocalTask = (
+      (priority == Priority::Normal) &&
+      (PlatformDependentImplementation::CurrentWorkerPool == this->implementation)
+    );
 
-    // Task is ready, schedule it for execution by a worker thread
-    bool wasEnqueued = this->implementation->ScheduledTasks.enqueue(submittedTask);
-    if(likely(wasEnqueued)) {
-      this->implementation->TaskCount.fetch_add(1, std::memory_order_release);
+    // The task needs to be counted before it is queued, otherwise an idle worker
+    // could pick it up and count it down before it was even counted.
+    std::size_t previousTaskCount = this->implementation->TaskCount.fetch_add(
+      1, std::memory_order_release
+    );
+    if(isLocalTask) {
+      auto deleteTaskScope = ON_SCOPE_EXIT_TRANSACTION {
+        this->implementation->TaskCount.fetch_sub(1, std::memory_order_release);
+        submittedTask->Task->~Task();
+        this->implementation->SubmittedTaskPool.DeleteTask(submittedTask);
+      };
+      this->implementation->WorkerDeques[
+        PlatformDependentImplementation::CurrentWorkerIndex
+      ].Push(submittedTask);
+      deleteTaskScope.Commit();
     } else {
-      submittedTask->Task->~Task();
-      this->implementation->SubmittedTaskPool.DeleteTask(submittedTask);
-      throw std::runtime_error(u8"Could not schedule task for thread pool execution");
+      bool wasEnqueued = this->implementation->GetSharedQueue(
+        this->implementation->GetSubmittingNodeIndex(), priority
+      ).enqueue(submittedTask);
+      if(unlikely(!wasEnqueued)) {
+        this->implementation->TaskCount.fetch_sub(1, std::memory_order_release);
+        submittedTask->Task->~Task();
+        this->implementation->SubmittedTaskPool.DeleteTask(submittedTask);
+        throw std::runtime_error(u8"Could not schedule task for thread pool execution");
+      }
     }
 
-    // Wake up a worker thread (or prevent the next thread finishing
-    // its task from going to sleep again)
-    this->implementation->TaskSemaphore.Post();
+    // If any worker threads are sleeping, wake one of them up. Busy worker threads
+    // will find the task by themselves once they finish their current task.
+    this->implementation->WakeIdleThreads();
+
+    // If tasks are piling up, let the sizing thread check whether the pool should grow
+    int threadCount = this->implementation->ThreadCount.load(std::memory_order_relaxed);
+    if(previousTaskCount >= static_cast<std::size_t>(std::max(threadCount, 0))) {
+      this->implementation->WakeSizingThread();
+    }
+
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void ThreadPool::submitTasks(
+    std::uint8_t *const *taskMemories, Task *const *tasks, std::size_t count
+  ) {
+    typedef PlatformDependentImplementation::SubmittedTask SubmittedTask;
+    assert((count <= BulkSubmissionBatchSize) && u8"Batch fits within batch size limit");
+
+    SubmittedTask *submittedTasks[BulkSubmissionBatchSize];
+    for(std::size_t index = 0; index < count; ++index) {
+      submittedTasks[index] = reinterpret_cast<SubmittedTask *>(
+        taskMemories[index] - offsetof(SubmittedTask, Payload)
+      );
+      submittedTasks[index]->Task = tasks[index];
+      PlatformDependentImplementation::StampSubmissionTime(*submittedTasks[index]);
+    }
+
+    // Same as in submitTask(), but each batch only needs a single enqueue operation
+    // and wakes up all the worker threads it needs in one go.
+    std::size_t previousTaskCount = this->implementation->TaskCount.fetch_add(
+      count, std::memory_order_release
+    );
+    if(PlatformDependentImplementation::CurrentWorkerPool == this->implementation) {
+      std::size_t pushedCount = 0;
+      auto deleteTasksScope = ON_SCOPE_EXIT_TRANSACTION {
+        this->implementation->TaskCount.fetch_sub(
+          count - pushedCount, std::memory_order_release
+        );
+        while(pushedCount < count) {
+          submittedTasks[pushedCount]->Task->~Task();
+          this->implementation->SubmittedTaskPool.DeleteTask(submittedTasks[pushedCount]);
+          ++pushedCount;
+        }
+      };
+      ThreadPoolWorkDeque<SubmittedTask *> &workerDeque = this->implementation->WorkerDeques[
+        PlatformDependentImplementation::CurrentWorkerIndex
+      ];
+      while(pushedCount < count) {
+        workerDeque.Push(submittedTasks[pushedCount]);
+        ++pushedCount;
+      }
+      deleteTasksScope.Commit();
+    } else {
+      bool wasEnqueued = this->implementation->GetSharedQueue(
+        this->implementation->GetSubmittingNodeIndex(), Priority::Normal
+      ).enqueue_bulk(submittedTasks, count);
+      if(unlikely(!wasEnqueued)) {
+        this->implementation->TaskCount.fetch_sub(count, std::memory_order_release);
+        for(std::size_t index = 0; index < count; ++index) {
+          submittedTasks[index]->Task->~Task();
+          this->implementation->SubmittedTaskPool.DeleteTask(submittedTasks[index]);
+        }
+        throw std::runtime_error(u8"Could not schedule tasks for thread pool execution");
+      }
+    }
+
+    this->implementation->WakeIdleThreads(count);
+
+    int threadCount = this->implementation->ThreadCount.load(std::memory_order_relaxed);
+    if(previousTaskCount + count > static_cast<std::size_t>(std::max(threadCount, 0))) {
+      this->implementation->WakeSizingThread();
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void ThreadPool::discardTaskMemory(std::uint8_t *taskMemory) {
+    this->implementation->SubmittedTaskPool.DeleteTask(
+      reinterpret_cast<PlatformDependentImplementation::SubmittedTask *>(
+        taskMemory - offsetof(PlatformDependentImplementation::SubmittedTask, Payload)
+      )
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  ThreadPool::SizingOptions ThreadPool::GetSizingOptions() const {
+    return this->implementation->GetSizingOptions();
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void ThreadPool::SetSizingOptions(const SizingOptions &options) {
+    std::lock_guard<std::mutex> sizingOptionsScope(this->implementation->SizingOptionsMutex);
+    this->implementation->Sizing = options;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void ThreadPool::startTimer(
+    const std::shared_ptr<TimerTask> &task,
+    std::chrono::microseconds delay, std::chrono::microseconds interval
+  ) {
+    task->Owner = this;
+    this->implementation->Timers->Schedule(task, delay, interval);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  bool ThreadPool::cancelTimer(TimerTask &task) {
+    int expected = TimerTask::Pending;
+    bool wasCanceled = task.State.compare_exchange_strong(
+      expected, TimerTask::Canceled, std::memory_order_acq_rel, std::memory_order_relaxed
+    );
+    if(wasCanceled) {
+      task.Owner->implementation->Timers->Remove(task);
+    }
+
+    return wasCanceled;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  ThreadPool::Statistics ThreadPool::GetStatistics() const {
+    return this->implementation->GetStatistics();
+  }
+
+  // ------------------------------------------------------------------------------------------- //
 
+  std::size_t ThreadPool::getMaximumThreadCount() const {
+    return this->implementation->MaximumThreadCount;
   }
 
   // ------------------------------------------------------------------------------------------- //
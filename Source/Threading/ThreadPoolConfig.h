@@ -57,8 +57,34 @@ namespace Nuclex { namespace Support { namespace Threading {
     ///     requiring another allocation when another gigantic task is scheduled.
     ///     Eventually, only oversized memory blocks would be circulating around.
     ///   </para>
+    ///   <para>
+    ///     Tasks posted via ThreadPool::Post() carry their method and arguments (or
+    ///     a lambda with all its captures) directly in this memory block, so the limit
+    ///     is chosen to comfortably fit lambdas capturing a handful of values.
+    ///   </para>
+    /// </remarks>
+    public: static const constexpr std::size_t SubmittedTaskReuseLimit = 256;
+
+    /// <summary>Number of reusable tasks each worker thread caches per size class</summary>
+    /// <remarks>
+    ///   <para>
+    ///     Each worker thread keeps a small stack of finished tasks for every size class
+    ///     so it can reuse task memory without touching any shared state. When the stack
+    ///     is full, half of it is handed to a shared queue where threads outside of
+    ///     the thread pool (or other worker threads) can pick the tasks up.
+    ///   </para>
+    ///   <para>
+    ///     This value is only used by the Linux implementation of the thread pool
+    ///   </para>
+    /// </remarks>
+    public: static const constexpr std::size_t SubmittedTaskCacheSize = 32;
+
+    /// <summary>Maximum number of bytes parked in the shared queue of reusable tasks</summary>
+    /// <remarks>
+    ///   After a burst of tasks, a lot of task memory is returned at once. Instead of
+    ///   holding onto all of it forever, tasks returned beyond this limit are freed.
     /// </remarks>
-    public: static const constexpr std::size_t SubmittedTaskReuseLimit = 128;
+    public: static const constexpr std::size_t SubmittedTaskRetentionLimit = 1048576;
 
     /// <summary>Once per how many milliseconds each worker thread wakes up</summary>
     /// <remarks>
@@ -68,10 +94,9 @@ namespace Nuclex { namespace Support { namespace Threading {
     ///   </para>
     ///   <para>
     ///     If worker threads are idle, however, they will once in a while check if
-    ///     they can shut down (until the minimumThreadCount parameter is reached).
-    ///     This interval specifies, how often threads will check if they can shut down
-    ///     and look for hanging work (the latter should never be the case, but as
-    ///     a matter of defensive programming, it is done anyway).
+    ///     they have been idle long enough to shut down (see the IdleShutDownDelay in
+    ///     ThreadPool::SizingOptions) and look for hanging work (the latter should never
+    ///     be the case, but as a matter of defensive programming, it is done anyway).
     ///   </para>
     ///   <para>
     ///     Should work be issued at a faster rate than the heart beat interval,
@@ -85,18 +110,92 @@ namespace Nuclex { namespace Support { namespace Threading {
     /// </remarks>
     public: static const constexpr std::size_t WorkerHeartBeatMilliseconds = 50;
 
-    /// <summary>Number of heartbeats after which a thread tries shutting down</summary>
+    /// <summary>Once per how many tasks a worker checks the shared queue first</summary>
     /// <remarks>
     ///   <para>
-    ///     If a thread has consecutively woken this number of times due to having
-    ///     no work, it will terminate unless the thread pool already is at
-    ///     the minimum number of threads specified during construction.
+    ///     Worker threads prefer the tasks in their own deque (which are the tasks they
+    ///     scheduled themselves and whose data is likely still in the CPU cache) over
+    ///     the shared queue receiving tasks scheduled from outside the thread pool.
+    ///   </para>
+    ///   <para>
+    ///     If tasks keep scheduling more tasks, the shared queue would never be looked
+    ///     at, so every this many tasks, a worker thread will look there first.
     ///   </para>
     ///   <para>
     ///     This value is only used by the Linux implementation of the thread pool
     ///   </para>
     /// </remarks>
-    public: static const constexpr std::size_t IdleShutDownHeartBeats = 10;
+    public: static const constexpr std::size_t SharedQueuePollInterval = 61;
+
+    /// <summary>Once per how many tasks a worker checks the priority lanes in reverse</summary>
+    /// <remarks>
+    ///   <para>
+    ///     Worker threads normally take high priority tasks first, then normal priority
+    ///     tasks and only if there's nothing else to do, low priority tasks.
+    ///   </para>
+    ///   <para>
+    ///     To avoid starving the lower priority lanes when the higher priority lanes are
+    ///     saturated, every this many tasks, a worker thread looks at the lanes starting
+    ///     from the lowest priority. Under full load, the low priority lane thus still
+    ///     gets at least one in this many tasks executed.
+    ///   </para>
+    ///   <para>
+    ///     This is a fixed share, not aging: how long a low priority task has been
+    ///     waiting does not change when it gets to run.
+    ///   </para>
+    ///   <para>
+    ///     This value is only used by the Linux implementation of the thread pool
+    ///   </para>
+    /// </remarks>
+    public: static const constexpr std::size_t LowPriorityShareInterval = 8;
+
+    /// <summary>Once per how many submitted tasks a task is timed for the statistics</summary>
+    /// <remarks>
+    ///   <para>
+    ///     The thread pool keeps histograms of how long tasks wait in the queue and how
+    ///     long they take to execute. Timing a task means querying the clock when it is
+    ///     submitted, when it starts and when it ends, which would add noticeably to
+    ///     the cost of very small tasks.
+    ///   </para>
+    ///   <para>
+    ///     So each thread submitting tasks only timestamps one in this many tasks, and only
+    ///     the timestamped tasks are timed by the worker threads. That is plenty to get
+    ///     a good picture of the distribution of wait and execution times.
+    ///   </para>
+    ///   <para>
+    ///     This value is only used by the Linux implementation of the thread pool
+    ///   </para>
+    /// </remarks>
+    public: static const constexpr std::size_t TimingSampleInterval = 16;
+
+    /// <summary>Length of one tick of the timer thread in microseconds</summary>
+    /// <remarks>
+    ///   <para>
+    ///     Delayed and periodic tasks are kept in a timing wheel that advances in ticks
+    ///     of this length. Delays are rounded up to whole ticks, so a task never becomes
+    ///     due early, but may be posted up to one tick late.
+    ///   </para>
+    ///   <para>
+    ///     Shorter ticks don't cost anything while no timer is pending, but if timers
+    ///     are scattered over many ticks, the timer thread will wake up more often.
+    ///   </para>
+    /// </remarks>
+    public: static const constexpr std::size_t TimerTickMicroseconds = 1000;
+
+    /// <summary>Number of tasks a strand executes before yielding its worker thread</summary>
+    /// <remarks>
+    ///   <para>
+    ///     A strand with queued tasks occupies one worker thread to execute them in
+    ///     order. Executing several tasks per visit saves handing the strand back to
+    ///     the thread pool after every single task.
+    ///   </para>
+    ///   <para>
+    ///     After this many tasks, the strand posts itself to the thread pool again, so
+    ///     a strand that is continuously fed tasks doesn't keep other strands or tasks
+    ///     waiting for a worker thread.
+    ///   </para>
+    /// </remarks>
+    public: static const constexpr std::size_t StrandBatchSize = 64;
 
     /// <summary>Guesses a good default for the number of threads to keep alive</summary>
     /// <param name="processorCount">Number of processors (CPU cores) in the system</param>
@@ -0,0 +1,232 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+#ifndef NUCLEX_SUPPORT_THREADING_THREADPOOLSIZER_H
+#define NUCLEX_SUPPORT_THREADING_THREADPOOLSIZER_H
+
+#include "Nuclex/Support/Config.h"
+
+#if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+
+#include "Nuclex/Support/Threading/ThreadPool.h" // for ThreadPool::SizingOptions
+
+#include <cstddef> // for std::size_t, std::ptrdiff_t
+#include <chrono> // for std::chrono::microseconds
+#include <algorithm> // for std::min(), std::max()
+
+namespace Nuclex { namespace Support { namespace Threading {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Decides when the thread pool should add or remove threads</summary>
+  /// <remarks>
+  ///   <para>
+  ///     The thread pool periodically takes a sample of its load (queued tasks, completed
+  ///     tasks, busy and blocked worker threads) and hands it to this class, which replies
+  ///     with the number of threads that should be added (or removed, if negative).
+  ///   </para>
+  ///   <para>
+  ///     If the tasks in the queue would take longer than the queue delay threshold to
+  ///     drain at the current completion rate, or if worker threads are blocked while tasks
+  ///     are waiting, the thread pool is starved and may at most double its threads at once.
+  ///     Blocked worker threads are always compensated one-for-one.
+  ///   </para>
+  ///   <para>
+  ///     Under a steady backlog, the sizer does hill climbing: it adds a thread, then checks
+  ///     in the next sample whether throughput improved. If it did, it adds another thread,
+  ///     if not, the thread is removed again and the sizer holds still for a few samples
+  ///     before probing again. Removing threads this way needs a worker to finish its task,
+  ///     so shrinking when there is no backlog is left to idle workers timing out.
+  ///   </para>
+  ///   <para>
+  ///     This class is not thread-safe, the thread pool ensures that only one thread at
+  ///     a time takes a sample.
+  ///   </para>
+  /// </remarks>
+  class ThreadPoolSizer {
+
+    #pragma region struct Sample
+
+    /// <summary>Load of the thread pool observed during one sample interval</summary>
+    public: struct Sample {
+
+      /// <summary>Number of worker threads currently running</summary>
+      public: std::size_t ThreadCount;
+      /// <summary>Number of worker threads that are currently executing a task</summary>
+      public: std::size_t BusyThreadCount;
+      /// <summary>Number of busy worker threads that are stuck in the same task</summary>
+      public: std::size_t BlockedThreadCount;
+      /// <summary>Number of tasks waiting for a worker thread</summary>
+      public: std::size_t QueuedTaskCount;
+      /// <summary>Number of tasks completed since the previous sample</summary>
+      public: std::size_t CompletedTaskCount;
+      /// <summary>Time that has passed since the previous sample</summary>
+      public: std::chrono::microseconds Elapsed;
+
+    };
+
+    #pragma endregion // struct Sample
+
+    /// <summary>Number of samples to wait before probing again after a reversal</summary>
+    public: static const constexpr std::size_t HoldSampleCount = 8;
+
+    /// <summary>Initializes a new thread pool sizer</summary>
+    /// <param name="minimumThreadCount">Number of threads the pool never goes below</param>
+    /// <param name="maximumThreadCount">Number of threads the pool never goes above</param>
+    public: ThreadPoolSizer(std::size_t minimumThreadCount, std::size_t maximumThreadCount) :
+      minimumThreadCount(minimumThreadCount),
+      maximumThreadCount(maximumThreadCount),
+      previousThroughput(0.0),
+      previousAdjustment(0),
+      remainingHoldSampleCount(0) {}
+
+    /// <summary>Evaluates a sample and decides how the thread count should change</summary>
+    /// <param name="sample">Load the thread pool has observed</param>
+    /// <param name="options">Thresholds currently configured for the thread pool</param>
+    /// <returns>
+    ///   The number of threads to add or, if negative, the number of threads to remove
+    /// </returns>
+    public: std::ptrdiff_t Evaluate(
+      const Sample &sample, const ThreadPool::SizingOptions &options
+    ) {
+      double throughput = 0.0; // in tasks per microsecond
+      if(sample.Elapsed.count() > 0) {
+        throughput = (
+          static_cast<double>(sample.CompletedTaskCount) /
+          static_cast<double>(sample.Elapsed.count())
+        );
+      }
+
+      // Without a backlog, there's nothing to grow for. Idle workers will time out
+      // and exit by themselves, so all we do is start hill climbing afresh next time.
+      if(sample.QueuedTaskCount == 0) {
+        restartHillClimbing();
+        return 0;
+      }
+
+      // Estimate how long the queued tasks would take to drain at the current rate.
+      // If nothing completed at all while tasks were waiting, we're starved for sure.
+      bool isStarved = true;
+      if(throughput > 0.0) {
+        double queueDelayMicroseconds = (
+          static_cast<double>(sample.QueuedTaskCount) / throughput
+        );
+        isStarved = (
+          queueDelayMicroseconds > static_cast<double>(options.QueueDelayThreshold.count())
+        );
+      }
+
+      // Starved or blocked: grow quickly, by up to as many threads as are already running
+      // (but no more than there are tasks waiting) and compensate for each blocked worker
+      if(isStarved || (sample.BlockedThreadCount > 0)) {
+        std::size_t growth = std::min(sample.BlockedThreadCount, sample.QueuedTaskCount);
+        if(isStarved) {
+          growth = std::max(
+            growth, std::min(sample.QueuedTaskCount, std::max<std::size_t>(sample.ThreadCount, 1))
+          );
+        }
+
+        restartHillClimbing();
+        return clampAdjustment(sample.ThreadCount, static_cast<std::ptrdiff_t>(growth));
+      }
+
+      // Steady backlog, do hill climbing: keep moving in the same direction while
+      // throughput improves, revert a move that didn't pay off and then hold still.
+      std::ptrdiff_t adjustment = 0;
+      if(this->previousThroughput > 0.0) {
+        double change = (throughput - this->previousThroughput) / this->previousThroughput;
+        double threshold = static_cast<double>(options.ThroughputGainThreshold);
+        if(this->previousAdjustment > 0) {
+          if(change >= threshold) {
+            adjustment = 1; // The added thread helped, try another one
+          } else {
+            adjustment = -1; // The added thread didn't help, remove it again
+            this->remainingHoldSampleCount = HoldSampleCount;
+          }
+        } else if(this->previousAdjustment < 0) {
+          if(change <= -threshold) {
+            adjustment = 1; // Removing the thread hurt, bring it back
+          }
+          this->remainingHoldSampleCount = HoldSampleCount;
+        } else if(this->remainingHoldSampleCount > 0) {
+          --this->remainingHoldSampleCount;
+        } else {
+          adjustment = 1; // Probe whether another thread would help
+        }
+      }
+
+      adjustment = clampAdjustment(sample.ThreadCount, adjustment);
+      this->previousThroughput = throughput;
+      this->previousAdjustment = adjustment;
+      return adjustment;
+    }
+
+    /// <summary>Forgets the hill climbing history so it will start with a new baseline</summary>
+    private: void restartHillClimbing() {
+      this->previousThroughput = 0.0;
+      this->previousAdjustment = 0;
+      this->remainingHoldSampleCount = 0;
+    }
+
+    /// <summary>Limits an adjustment so the thread count stays within its bounds</summary>
+    /// <param name="threadCount">Number of threads currently running</param>
+    /// <param name="adjustment">Adjustment that will be limited</param>
+    /// <returns>The adjustment, limited to the range allowed by the thread limits</returns>
+    private: std::ptrdiff_t clampAdjustment(
+      std::size_t threadCount, std::ptrdiff_t adjustment
+    ) const {
+      if(adjustment > 0) {
+        if(threadCount >= this->maximumThreadCount) {
+          return 0;
+        }
+        return std::min(
+          adjustment, static_cast<std::ptrdiff_t>(this->maximumThreadCount - threadCount)
+        );
+      } else if(adjustment < 0) {
+        if(threadCount <= this->minimumThreadCount) {
+          return 0;
+        }
+        return std::max(
+          adjustment, -static_cast<std::ptrdiff_t>(threadCount - this->minimumThreadCount)
+        );
+      } else {
+        return 0;
+      }
+    }
+
+    /// <summary>Number of threads the thread pool will never go below</summary>
+    private: std::size_t minimumThreadCount;
+    /// <summary>Number of threads the thread pool will never go above</summary>
+    private: std::size_t maximumThreadCount;
+    /// <summary>Throughput, in tasks per microsecond, seen in the previous sample</summary>
+    private: double previousThroughput;
+    /// <summary>Adjustment that was made after the previous sample</summary>
+    private: std::ptrdiff_t previousAdjustment;
+    /// <summary>Number of samples to hold still before probing again</summary>
+    private: std::size_t remainingHoldSampleCount;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Threading
+
+#endif // defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+
+#endif // NUCLEX_SUPPORT_THREADING_THREADPOOLSIZER_H
@@ -23,6 +23,9 @@ limitations under the License.
 #include "Nuclex/Support/Config.h"
 #include "ThreadPoolConfig.h"
 
+#include <atomic> // for std::atomic
+#include <memory> // for std::unique_ptr
+
 // Boost-licensed MoodyCamel queue.
 // This is a lock-free, unbounded queue that works on Windows and Linux.
 // Its performance is at the top end of such queues. The header does a lot of stuff,
@@ -36,6 +39,27 @@ namespace Nuclex { namespace Support { namespace Threading {
   /// <summary>Manages reusable tasks for the thread pool</summary>
   /// <typeparam name="TSubmittedTask">Store all informations about a submitted task</typeparam>
   /// <typeparam name="PayloadOffset">Offset at which the variable payload begins</typeparam>
+  /// <remarks>
+  ///   <para>
+  ///     Task memory is handed out in size classes, each a multiple of
+  ///     <see cref="SizeClassGranularity" /> bytes, so any returned task can be reused by
+  ///     any later task of the same size class, no matter how the payload sizes mix.
+  ///   </para>
+  ///   <para>
+  ///     The pool can be split into shards, each owned by exactly one thread (the thread
+  ///     pool gives each worker thread its own shard). A shard keeps a small stack of
+  ///     tasks per size class that its owner can take from and return to without any
+  ///     synchronization. When a shard's stack overflows, half of it is moved to a shared
+  ///     queue, when it runs dry, it is refilled from there. Threads without a shard
+  ///     use the shared queues directly.
+  ///   </para>
+  ///   <para>
+  ///     The memory parked in the shared queues is capped by
+  ///     <see cref="ThreadPoolConfig.SubmittedTaskRetentionLimit" />, tasks returned
+  ///     beyond that are freed. With the shards' stacks being limited, too, the memory
+  ///     retained by the pool stays bounded after a burst of tasks.
+  ///   </para>
+  /// </remarks>
   template<typename TSubmittedTask, std::size_t PayloadOffset>
   class ThreadPoolTaskPool {
 
@@ -61,7 +85,38 @@ namespace Nuclex { namespace Support { namespace Threading {
 
     #pragma endregion // struct SubmittedTaskTemplate
 
-    public: ThreadPoolTaskPool() {
+    /// <summary>Size classes of reusable tasks are multiples of this many bytes</summary>
+    public: static const constexpr std::size_t SizeClassGranularity = 64;
+    /// <summary>Number of size classes reusable tasks are sorted into</summary>
+    public: static const constexpr std::size_t SizeClassCount = (
+      (ThreadPoolConfig::SubmittedTaskReuseLimit + SizeClassGranularity - 1) /
+      SizeClassGranularity
+    );
+    /// <summary>Shard index passed by threads that don't own a shard</summary>
+    public: static const constexpr std::size_t NoShard = std::size_t(-1);
+
+    #pragma region struct Shard
+
+    /// <summary>Reusable tasks cached for the exclusive use of one thread</summary>
+    private: struct alignas(64) Shard {
+
+      /// <summary>Number of cached tasks in each size class</summary>
+      public: std::size_t Counts[SizeClassCount];
+      /// <summary>Cached tasks for each size class</summary>
+      public: TSubmittedTask *Tasks[SizeClassCount][ThreadPoolConfig::SubmittedTaskCacheSize];
+
+    };
+
+    #pragma endregion // struct Shard
+
+    /// <summary>Initializes a new task pool</summary>
+    /// <param name="shardCount">Number of shards to split the pool into</param>
+    public: ThreadPoolTaskPool(std::size_t shardCount = 0) :
+      returnedTasks(),
+      shards(),
+      shardCount(shardCount),
+      retainedByteCount(0),
+      allocationCount(0) {
 #if defined(NUCLEX_SUPPORT_ENABLE_TASK_POOL_VERIFICATION)
       // This will both check that an attribute 'PayloadSize' is present in the submitted
       // task structure and that it is at the beginning of the structure. If this assertion
@@ -70,6 +125,14 @@ namespace Nuclex { namespace Support { namespace Threading {
         offsetof(TSubmittedTask, PayloadSize) == offsetof(SubmittedTaskTemplate, PayloadSize)
       );
 #endif // defined(NUCLEX_SUPPORT_ENABLE_TASK_POOL_VERIFICATION)
+      if(shardCount > 0) {
+        this->shards.reset(new Shard[shardCount]);
+        for(std::size_t shardIndex = 0; shardIndex < shardCount; ++shardIndex) {
+          for(std::size_t sizeClass = 0; sizeClass < SizeClassCount; ++sizeClass) {
+            this->shards[shardIndex].Counts[sizeClass] = 0;
+          }
+        }
+      }
     }
 
     /// <summary>Destroys all remaining tasks</summary>
@@ -78,38 +141,68 @@ namespace Nuclex { namespace Support { namespace Threading {
     }
 
     /// <summary>Destroys all tasks currently waiting to be recycled</summary>
+    /// <remarks>
+    ///   This also empties the shards, so no other thread may be using the pool.
+    /// </remarks>
     public: void DeleteAllRecyclableTasks() {
+      for(std::size_t shardIndex = 0; shardIndex < this->shardCount; ++shardIndex) {
+        Shard &shard = this->shards[shardIndex];
+        for(std::size_t sizeClass = 0; sizeClass < SizeClassCount; ++sizeClass) {
+          while(shard.Counts[sizeClass] > 0) {
+            --shard.Counts[sizeClass];
+            DeleteTask(shard.Tasks[sizeClass][shard.Counts[sizeClass]]);
+          }
+        }
+      }
+
       TSubmittedTask *submittedTask;
-      while(this->returnedTasks.try_dequeue(submittedTask)) {
-        DeleteTask(submittedTask);
+      for(std::size_t sizeClass = 0; sizeClass < SizeClassCount; ++sizeClass) {
+        while(this->returnedTasks[sizeClass].try_dequeue(submittedTask)) {
+          DeleteTask(submittedTask);
+        }
       }
+      this->retainedByteCount.store(0, std::memory_order_relaxed);
     }
 
     /// <summary>Creates a new task with the specified payload size</summary>
     /// <param name="payloadSize">Size of the payload the new task must carry</param>
-    /// <returns>A new blob containing the
-    public: TSubmittedTask *GetNewTask(std::size_t payloadSize) {
+    /// <param name="shardIndex">
+    ///   Shard owned by the calling thread or <see cref="NoShard" /> if it owns none
+    /// </param>
+    /// <returns>A new or reused task with the requested payload size</returns>
+    public: TSubmittedTask *GetNewTask(std::size_t payloadSize, std::size_t shardIndex = NoShard) {
       std::size_t totalRequiredMemory = (PayloadOffset + payloadSize);
 
-      // Try to obtain a returned task with adequate payload size that can
+      // Try to obtain a returned task of the same size class that can
       // be re-used instead of allocating a new one
-      if(likely(totalRequiredMemory < ThreadPoolConfig::SubmittedTaskReuseLimit)) {
+      if(likely(totalRequiredMemory <= ThreadPoolConfig::SubmittedTaskReuseLimit)) {
+        std::size_t sizeClass = getSizeClass(totalRequiredMemory);
+
         TSubmittedTask *submittedTask;
-        for(std::size_t attempt = 0; attempt < 3; ++attempt) {
-          if(this->returnedTasks.try_dequeue(submittedTask)) {
-            if(submittedTask->PayloadSize >= payloadSize) {
-              return submittedTask;
-            } else {
-              DeleteTask(submittedTask);
-            }
-          } else {
-            break; // No more submitted tasks in queue
+        bool wasTaken;
+        if(shardIndex == NoShard) {
+          wasTaken = this->returnedTasks[sizeClass].try_dequeue(submittedTask);
+          if(wasTaken) {
+            this->retainedByteCount.fetch_sub(
+              getSizeClassBytes(sizeClass), std::memory_order_relaxed
+            );
           }
+        } else {
+          wasTaken = tryTakeFromShard(this->shards[shardIndex], sizeClass, submittedTask);
+        }
+        if(wasTaken) {
+          submittedTask->PayloadSize = payloadSize;
+          return submittedTask;
         }
+
+        // Reusable tasks are allocated with the full size of their size class
+        totalRequiredMemory = getSizeClassBytes(sizeClass);
       }
 
-      // We found no task that we could re-use, so create a new one
+      // We found no task that we could re-use, so create a new one. Counting these
+      // is cheap compared to the allocation, so a shared counter is fine here.
       {
+        this->allocationCount.fetch_add(1, std::memory_order_relaxed);
         std::uint8_t *taskMemory = new std::uint8_t[totalRequiredMemory];
         TSubmittedTask *submittedTask = new(taskMemory) TSubmittedTask();
         submittedTask->PayloadSize = payloadSize;
@@ -122,20 +215,53 @@ namespace Nuclex { namespace Support { namespace Threading {
     /// <returns>True if the task is suitable to be returned to the pool</returns>
     public: static bool IsReturnable(TSubmittedTask *task) {
       std::size_t totalSize = task->PayloadSize + PayloadOffset;
-      return (totalSize < ThreadPoolConfig::SubmittedTaskReuseLimit);
+      return (totalSize <= ThreadPoolConfig::SubmittedTaskReuseLimit);
     }
 
     /// <summary>Returns a task to the task pool, allowing for it to be re-used</summary>
     /// <param name="submittedTask">Task that will be returned for re-use</param>
-    public: void ReturnTask(TSubmittedTask *submittedTask) {
-      //assert(
-      //  IsReturnable(submittedTask) && u8"Task is small enough to be returned to the pool"
-      //);
-      if(IsReturnable(submittedTask)) {
-        this->returnedTasks.enqueue(submittedTask);
-      } else {
+    /// <param name="shardIndex">
+    ///   Shard owned by the calling thread or <see cref="NoShard" /> if it owns none
+    /// </param>
+    public: void ReturnTask(TSubmittedTask *submittedTask, std::size_t shardIndex = NoShard) {
+      if(unlikely(!IsReturnable(submittedTask))) {
         DeleteTask(submittedTask);
+        return;
+      }
+
+      std::size_t sizeClass = getSizeClass(PayloadOffset + submittedTask->PayloadSize);
+      if(shardIndex == NoShard) {
+        if(tryReserveRetainedBytes(getSizeClassBytes(sizeClass))) {
+          this->returnedTasks[sizeClass].enqueue(submittedTask);
+        } else {
+          DeleteTask(submittedTask);
+        }
+        return;
+      }
+
+      // If the shard is full, move the older half of its tasks to the shared queue
+      // so threads without a shard (or with an empty one) can pick them up
+      Shard &shard = this->shards[shardIndex];
+      std::size_t count = shard.Counts[sizeClass];
+      if(unlikely(count == ThreadPoolConfig::SubmittedTaskCacheSize)) {
+        std::size_t spillCount = count / 2;
+        TSubmittedTask **spilledTasks = shard.Tasks[sizeClass];
+        if(tryReserveRetainedBytes(getSizeClassBytes(sizeClass) * spillCount)) {
+          this->returnedTasks[sizeClass].enqueue_bulk(spilledTasks, spillCount);
+        } else {
+          for(std::size_t index = 0; index < spillCount; ++index) {
+            DeleteTask(spilledTasks[index]);
+          }
+        }
+
+        count -= spillCount;
+        for(std::size_t index = 0; index < count; ++index) {
+          spilledTasks[index] = spilledTasks[index + spillCount];
+        }
       }
+
+      shard.Tasks[sizeClass][count] = submittedTask;
+      shard.Counts[sizeClass] = count + 1;
     }
 
     /// <summary>Frees the memory used by a task</summary>
@@ -145,8 +271,78 @@ namespace Nuclex { namespace Support { namespace Threading {
       delete[] reinterpret_cast<std::uint8_t *>(submittedTask);
     }
 
+    /// <summary>Counts the number of times new task memory had to be allocated</summary>
+    /// <returns>The number of tasks that could not reuse the memory of an earlier task</returns>
+    public: std::size_t CountAllocations() const {
+      return this->allocationCount.load(std::memory_order_relaxed);
+    }
+
+    /// <summary>Determines the size class for a task of the specified total size</summary>
+    /// <param name="totalSize">Total size of the task, including its payload</param>
+    /// <returns>The size class the task belongs into</returns>
+    private: static std::size_t getSizeClass(std::size_t totalSize) {
+      return (totalSize + SizeClassGranularity - 1) / SizeClassGranularity - 1;
+    }
+
+    /// <summary>Determines the number of bytes allocated for tasks of a size class</summary>
+    /// <param name="sizeClass">Size class whose allocation size will be returned</param>
+    /// <returns>The number of bytes allocated for each task of the size class</returns>
+    private: static std::size_t getSizeClassBytes(std::size_t sizeClass) {
+      return (sizeClass + 1) * SizeClassGranularity;
+    }
+
+    /// <summary>Takes a task from a shard, refilling it from the shared queue if needed</summary>
+    /// <param name="shard">Shard owned by the calling thread</param>
+    /// <param name="sizeClass">Size class of the task that will be taken</param>
+    /// <param name="submittedTask">Receives the task if one was available</param>
+    /// <returns>True if a task was taken, false if none were available</returns>
+    private: bool tryTakeFromShard(
+      Shard &shard, std::size_t sizeClass, TSubmittedTask *&submittedTask
+    ) {
+      std::size_t count = shard.Counts[sizeClass];
+      if(unlikely(count == 0)) {
+        count = this->returnedTasks[sizeClass].try_dequeue_bulk(
+          shard.Tasks[sizeClass], ThreadPoolConfig::SubmittedTaskCacheSize / 2
+        );
+        if(count == 0) {
+          return false;
+        }
+        this->retainedByteCount.fetch_sub(
+          getSizeClassBytes(sizeClass) * count, std::memory_order_relaxed
+        );
+      }
+
+      --count;
+      submittedTask = shard.Tasks[sizeClass][count];
+      shard.Counts[sizeClass] = count;
+      return true;
+    }
+
+    /// <summary>Accounts for memory that is about to be parked in the shared queues</summary>
+    /// <param name="byteCount">Number of bytes that will be parked</param>
+    /// <returns>True if the memory can be parked, false if it would exceed the cap</returns>
+    private: bool tryReserveRetainedBytes(std::size_t byteCount) {
+      std::size_t previousByteCount = this->retainedByteCount.fetch_add(
+        byteCount, std::memory_order_relaxed
+      );
+      if(likely(previousByteCount + byteCount <= ThreadPoolConfig::SubmittedTaskRetentionLimit)) {
+        return true;
+      }
+
+      this->retainedByteCount.fetch_sub(byteCount, std::memory_order_relaxed);
+      return false;
+    }
+
     /// <summary>Tasks that have been given back and wait for their reuse</summary>
-    private: moodycamel::ConcurrentQueue<TSubmittedTask *> returnedTasks;
+    private: moodycamel::ConcurrentQueue<TSubmittedTask *> returnedTasks[SizeClassCount];
+    /// <summary>Tasks cached for the exclusive use of individual threads</summary>
+    private: std::unique_ptr<Shard[]> shards;
+    /// <summary>Number of shards the pool has been split into</summary>
+    private: std::size_t shardCount;
+    /// <summary>Number of bytes held by the tasks in the shared queues</summary>
+    private: std::atomic<std::size_t> retainedByteCount;
+    /// <summary>Number of times new task memory has been allocated</summary>
+    private: std::atomic<std::size_t> allocationCount;
 
   };
 
@@ -0,0 +1,282 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the library is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_SUPPORT_SOURCE 1
+
+#include "ThreadPoolTimerQueue.h"
+
+#if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+
+#include "ThreadPoolConfig.h" // for ThreadPoolConfig
+
+#include <algorithm> // for std::min()
+
+namespace {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Longest delay accepted, longer delays are clamped to this</summary>
+  /// <remarks>
+  ///   Keeps the addition of the current time and the delay from overflowing. It's still
+  ///   about 146 thousand years, so no timer will ever notice the difference.
+  /// </remarks>
+  const std::chrono::microseconds MaximumDelay(
+    std::chrono::microseconds::max().count() / 2
+  );
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // anonymous namespace
+
+namespace Nuclex { namespace Support { namespace Threading {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  ThreadPoolTimerQueue::ThreadPoolTimerQueue(ThreadPool &threadPool) :
+    threadPool(threadPool),
+    startTime(std::chrono::steady_clock::now()),
+    mutex(),
+    wheel(0),
+    timerThread(),
+    wakeUpSemaphore(0),
+    plannedWakeUpTick(0),
+    isStopping(false) {}
+
+  // ------------------------------------------------------------------------------------------- //
+
+  ThreadPoolTimerQueue::~ThreadPoolTimerQueue() {
+    Stop();
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void ThreadPoolTimerQueue::Schedule(
+    const std::shared_ptr<ThreadPool::TimerTask> &task,
+    std::chrono::microseconds delay, std::chrono::microseconds interval
+  ) {
+    if(delay.count() < 0) {
+      delay = std::chrono::microseconds(0);
+    }
+    if(interval.count() > 0) {
+      task->IntervalTicks = std::max<std::uint64_t>(toTicks(interval), 1);
+    }
+
+    std::lock_guard<std::mutex> timerScope(this->mutex);
+    if(this->isStopping) {
+      task->State.store(ThreadPool::TimerTask::Finished, std::memory_order_release);
+      return;
+    }
+
+    // Start the timer thread when the first timer is scheduled. It will block on
+    // the mutex until we're done linking the timer into the wheel.
+    if(!this->timerThread.joinable()) {
+      std::thread newThread(&ThreadPoolTimerQueue::runTimerLoop, this);
+      this->timerThread.swap(newThread);
+    }
+
+    // Round the due time up so that the timer never fires early
+    std::chrono::steady_clock::duration dueTime = (
+      (std::chrono::steady_clock::now() - this->startTime) + std::min(delay, MaximumDelay)
+    );
+    task->DueTick = toTicks(std::chrono::duration_cast<std::chrono::microseconds>(dueTime));
+    task->SelfReference = task;
+    this->wheel.Insert(task.get());
+
+    // If the timer thread plans to sleep past the new timer, wake it up
+    if(task->DueTick < this->plannedWakeUpTick) {
+      this->plannedWakeUpTick = 0;
+      this->wakeUpSemaphore.Post();
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void ThreadPoolTimerQueue::Remove(ThreadPool::TimerTask &task) {
+    std::shared_ptr<ThreadPool::TimerTask> removedTask;
+    {
+      std::lock_guard<std::mutex> timerScope(this->mutex);
+
+      // If the timer thread got to the task first, it has already taken care of it
+      if(task.SlotIndex != ThreadPoolTimerWheel<ThreadPool::TimerTask>::Unlinked) {
+        this->wheel.Remove(&task);
+        removedTask.swap(task.SelfReference);
+      }
+    }
+
+    // The task, if it was the last reference, is destroyed out here, outside the lock
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void ThreadPoolTimerQueue::Stop() {
+    {
+      std::lock_guard<std::mutex> timerScope(this->mutex);
+      this->isStopping = true;
+    }
+
+    if(this->timerThread.joinable()) {
+      this->wakeUpSemaphore.Post();
+      this->timerThread.join();
+    }
+
+    // Discard all remaining timers. Marking them as finished means the handles
+    // held by the user will no longer try to reach back into the timer queue.
+    std::vector<std::shared_ptr<ThreadPool::TimerTask>> discardedTasks;
+    {
+      std::lock_guard<std::mutex> timerScope(this->mutex);
+      ThreadPool::TimerTask *task = this->wheel.Clear();
+      while(task != nullptr) {
+        ThreadPool::TimerTask *next = task->Next;
+        task->Next = nullptr;
+
+        int expected = ThreadPool::TimerTask::Pending;
+        task->State.compare_exchange_strong(
+          expected, ThreadPool::TimerTask::Finished,
+          std::memory_order_acq_rel, std::memory_order_relaxed
+        );
+        discardedTasks.push_back(std::move(task->SelfReference));
+
+        task = next;
+      }
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::uint64_t ThreadPoolTimerQueue::toTicks(std::chrono::microseconds time) {
+    const std::uint64_t tickLength = ThreadPoolConfig::TimerTickMicroseconds;
+    return (static_cast<std::uint64_t>(time.count()) + tickLength - 1) / tickLength;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::uint64_t ThreadPoolTimerQueue::getCurrentTick() const {
+    std::chrono::microseconds elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - this->startTime
+    );
+    return (
+      static_cast<std::uint64_t>(elapsed.count()) / ThreadPoolConfig::TimerTickMicroseconds
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void ThreadPoolTimerQueue::runTask(const std::shared_ptr<ThreadPool::TimerTask> &task) {
+    int state = task->State.load(std::memory_order_acquire);
+    if(state != ThreadPool::TimerTask::Canceled) {
+      task->operator()();
+    }
+    task->IsQueued.store(false, std::memory_order_release);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void ThreadPoolTimerQueue::runTimerLoop() {
+    std::vector<std::shared_ptr<ThreadPool::TimerTask>> dueTasks;
+
+    std::unique_lock<std::mutex> timerScope(this->mutex);
+    while(!this->isStopping) {
+      std::uint64_t currentTick = getCurrentTick();
+
+      // Collect all timers that are due. One-shot timers leave the wheel for good,
+      // periodic timers are linked back in at their next due tick.
+      ThreadPool::TimerTask *task = this->wheel.Advance(currentTick);
+      while(task != nullptr) {
+        ThreadPool::TimerTask *next = task->Next;
+        task->Next = nullptr;
+
+        if(task->IntervalTicks == 0) {
+          int expected = ThreadPool::TimerTask::Pending;
+          task->State.compare_exchange_strong(
+            expected, ThreadPool::TimerTask::Finished,
+            std::memory_order_acq_rel, std::memory_order_relaxed
+          );
+          dueTasks.push_back(std::move(task->SelfReference)); // canceled ones aren't posted
+        } else if(task->State.load(std::memory_order_acquire) == ThreadPool::TimerTask::Pending) {
+          task->DueTick += task->IntervalTicks;
+          if(task->DueTick <= currentTick) {
+            task->DueTick = currentTick + task->IntervalTicks; // Skip missed executions
+          }
+          this->wheel.Insert(task);
+
+          // Executions don't overlap, if the previous one is still queued, skip this one
+          if(!task->IsQueued.exchange(true, std::memory_order_acq_rel)) {
+            dueTasks.push_back(task->SelfReference);
+          }
+        } else { // Periodic timer was canceled while we were advancing the wheel
+          dueTasks.push_back(std::move(task->SelfReference));
+        }
+
+        task = next;
+      }
+
+      std::uint64_t nextEventTick = this->wheel.GetNextEventTick();
+      this->plannedWakeUpTick = nextEventTick;
+      timerScope.unlock();
+
+      // Post the due tasks outside of the lock, cancellation may have happened
+      // in the meantime, too, in which case runTask() would skip them anyway.
+      for(std::size_t index = 0; index < dueTasks.size(); ++index) {
+        std::shared_ptr<ThreadPool::TimerTask> &dueTask = dueTasks[index];
+        int state = dueTask->State.load(std::memory_order_acquire);
+        if(state != ThreadPool::TimerTask::Canceled) {
+          try {
+            this->threadPool.Post(&ThreadPoolTimerQueue::runTask, dueTask);
+          }
+          catch(...) {
+            // There is nobody on this thread to report the error to and letting it escape
+            // would terminate the process. A one-shot timer is already marked as finished
+            // and is dropped just like when the thread pool discards it during shutdown.
+            // A periodic timer is still in the wheel, so it will be posted again on its
+            // next due tick once it is no longer flagged as queued.
+            if(dueTask->IntervalTicks != 0) {
+              dueTask->IsQueued.store(false, std::memory_order_release);
+            }
+          }
+        }
+      }
+      dueTasks.clear();
+
+      // Sleep until the next event in the timing wheel or until woken up because
+      // an earlier timer was scheduled (or the timer queue is being stopped)
+      if(nextEventTick == ThreadPoolTimerWheel<ThreadPool::TimerTask>::Never) {
+        this->wakeUpSemaphore.WaitThenDecrement();
+      } else {
+        std::chrono::steady_clock::time_point wakeUpTime = this->startTime + (
+          std::chrono::microseconds(nextEventTick * ThreadPoolConfig::TimerTickMicroseconds)
+        );
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if(wakeUpTime > now) {
+          this->wakeUpSemaphore.WaitForThenDecrement(
+            std::chrono::duration_cast<std::chrono::microseconds>(wakeUpTime - now) +
+            std::chrono::microseconds(1)
+          );
+        }
+      }
+
+      timerScope.lock();
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Threading
+
+#endif // defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
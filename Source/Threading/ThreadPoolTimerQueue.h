@@ -0,0 +1,130 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+#ifndef NUCLEX_SUPPORT_THREADING_THREADPOOLTIMERQUEUE_H
+#define NUCLEX_SUPPORT_THREADING_THREADPOOLTIMERQUEUE_H
+
+#include "Nuclex/Support/Config.h"
+
+#if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+
+#include "Nuclex/Support/Threading/ThreadPool.h" // for ThreadPool
+#include "Nuclex/Support/Threading/Semaphore.h" // for Semaphore
+
+#include "ThreadPoolTimerWheel.h" // for ThreadPoolTimerWheel
+
+#include <cstdint> // for std::uint64_t
+#include <chrono> // for std::chrono::steady_clock
+#include <memory> // for std::shared_ptr
+#include <mutex> // for std::mutex
+#include <thread> // for std::thread
+#include <vector> // for std::vector
+
+namespace Nuclex { namespace Support { namespace Threading {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Posts delayed and periodic tasks to a thread pool when they become due</summary>
+  /// <remarks>
+  ///   <para>
+  ///     All pending timers of a thread pool live in a single timing wheel that is
+  ///     advanced by one timer thread. The timer thread sleeps until the wheel's next
+  ///     event and is woken up early only when a timer is scheduled that becomes due
+  ///     before the tick it planned to wake up at.
+  ///   </para>
+  ///   <para>
+  ///     The timer thread is only started when the first timer is scheduled, so thread
+  ///     pools that never use timers don't pay for it.
+  ///   </para>
+  /// </remarks>
+  class ThreadPoolTimerQueue {
+
+    /// <summary>Initializes a new timer queue posting to the specified thread pool</summary>
+    /// <param name="threadPool">Thread pool due tasks will be posted to</param>
+    public: explicit ThreadPoolTimerQueue(ThreadPool &threadPool);
+
+    /// <summary>Stops the timer thread and discards all pending timers</summary>
+    public: ~ThreadPoolTimerQueue();
+
+    /// <summary>Adds a timer task to the queue</summary>
+    /// <param name="task">Timer task that will be added</param>
+    /// <param name="delay">Time until the task will be posted the first time</param>
+    /// <param name="interval">Time between executions, zero for one-shot tasks</param>
+    public: void Schedule(
+      const std::shared_ptr<ThreadPool::TimerTask> &task,
+      std::chrono::microseconds delay, std::chrono::microseconds interval
+    );
+
+    /// <summary>Removes a canceled timer task from the queue</summary>
+    /// <param name="task">Timer task that will be removed</param>
+    public: void Remove(ThreadPool::TimerTask &task);
+
+    /// <summary>Stops the timer thread and discards all pending timers</summary>
+    /// <remarks>
+    ///   Called by the thread pool before it shuts down its worker threads so that no
+    ///   more tasks are posted while it is shutting down.
+    /// </remarks>
+    public: void Stop();
+
+    /// <summary>Converts a time span into a number of ticks, rounding up</summary>
+    /// <param name="time">Time span that will be converted</param>
+    /// <returns>The number of ticks covering the time span</returns>
+    private: static std::uint64_t toTicks(std::chrono::microseconds time);
+
+    /// <summary>Determines the tick the timer thread's clock is currently at</summary>
+    /// <returns>The number of whole ticks since the timer queue was created</returns>
+    private: std::uint64_t getCurrentTick() const;
+
+    /// <summary>Executes a due timer task on a thread pool thread</summary>
+    /// <param name="task">Timer task that will be executed</param>
+    private: static void runTask(const std::shared_ptr<ThreadPool::TimerTask> &task);
+
+    /// <summary>Method that is executed by the timer thread</summary>
+    private: void runTimerLoop();
+
+    /// <summary>Thread pool due tasks are posted to</summary>
+    private: ThreadPool &threadPool;
+    /// <summary>Point in time that is counted as tick zero</summary>
+    private: std::chrono::steady_clock::time_point startTime;
+    /// <summary>Protects the timing wheel and the timer thread's planning</summary>
+    private: std::mutex mutex;
+    /// <summary>Timing wheel holding the pending timers</summary>
+    private: ThreadPoolTimerWheel<ThreadPool::TimerTask> wheel;
+    /// <summary>Thread that advances the wheel and posts due tasks</summary>
+    private: std::thread timerThread;
+    /// <summary>Wakes up the timer thread before its planned wake-up tick</summary>
+    private: Semaphore wakeUpSemaphore;
+    /// <summary>Tick at which the timer thread plans to wake up</summary>
+    /// <remarks>
+    ///   Zero while the timer thread is awake or has already been woken up, so that
+    ///   it doesn't receive more than one wake-up signal for the same sleep.
+    /// </remarks>
+    private: std::uint64_t plannedWakeUpTick;
+    /// <summary>Whether the timer thread has been asked to stop</summary>
+    private: bool isStopping;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Threading
+
+#endif // defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+
+#endif // NUCLEX_SUPPORT_THREADING_THREADPOOLTIMERQUEUE_H
@@ -0,0 +1,326 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+#ifndef NUCLEX_SUPPORT_THREADING_THREADPOOLTIMERWHEEL_H
+#define NUCLEX_SUPPORT_THREADING_THREADPOOLTIMERWHEEL_H
+
+#include "Nuclex/Support/Config.h"
+#include "Nuclex/Support/BitTricks.h" // for BitTricks
+
+#include <cstddef> // for std::size_t
+#include <cstdint> // for std::uint64_t
+#include <limits> // for std::numeric_limits
+#include <algorithm> // for std::min()
+
+namespace Nuclex { namespace Support { namespace Threading {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Hierarchical timing wheel keeping track of pending timers</summary>
+  /// <typeparam name="TNode">
+  ///   Type of the timers, must provide the members <code>Previous</code>,
+  ///   <code>Next</code>, <code>DueTick</code> and <code>SlotIndex</code>
+  /// </typeparam>
+  /// <remarks>
+  ///   <para>
+  ///     Time is counted in ticks. The wheel has several levels of 64 slots each, where
+  ///     a slot on the lowest level covers a single tick, a slot on the next level covers
+  ///     64 ticks and so on. Each timer is linked into the slot of the lowest level that
+  ///     can tell its due tick apart from the current tick, so inserting and removing
+  ///     a timer is just a matter of linking or unlinking a list node.
+  ///   </para>
+  ///   <para>
+  ///     When the current tick reaches the start of a slot on a higher level, the timers
+  ///     in that slot are redistributed into the lower levels. Each timer moves down at
+  ///     most once per level, so advancing the wheel costs the number of expired timers
+  ///     plus a small constant, no matter how many ticks have passed.
+  ///   </para>
+  ///   <para>
+  ///     The timers are intrusive list nodes, the wheel never allocates memory. It is
+  ///     not thread-safe, the thread pool protects it with a mutex.
+  ///   </para>
+  /// </remarks>
+  template<typename TNode>
+  class ThreadPoolTimerWheel {
+
+    /// <summary>Number of bits of the tick covered by each level of the wheel</summary>
+    public: static const constexpr std::size_t SlotBits = 6;
+    /// <summary>Number of slots in each level of the wheel</summary>
+    public: static const constexpr std::size_t SlotCount = (1 << SlotBits);
+    /// <summary>Number of levels, enough to cover the entire 64 bit tick range</summary>
+    public: static const constexpr std::size_t LevelCount = (64 + SlotBits - 1) / SlotBits;
+    /// <summary>Slot index of timers that are not linked into the wheel</summary>
+    public: static const constexpr std::size_t Unlinked = std::size_t(-1);
+    /// <summary>Tick returned as the next event if the wheel is empty</summary>
+    public: static const constexpr std::uint64_t Never = (
+      std::numeric_limits<std::uint64_t>::max()
+    );
+
+    /// <summary>Initializes a new, empty timer wheel</summary>
+    /// <param name="currentTick">Tick the wheel starts out at</param>
+    public: explicit ThreadPoolTimerWheel(std::uint64_t currentTick = 0) :
+      currentTick(currentTick),
+      count(0) {
+      for(std::size_t index = 0; index < LevelCount * SlotCount; ++index) {
+        this->slots[index] = nullptr;
+      }
+      for(std::size_t level = 0; level < LevelCount; ++level) {
+        this->occupiedSlots[level] = 0;
+      }
+    }
+
+    /// <summary>Returns the tick the wheel has advanced to</summary>
+    /// <returns>The current tick of the wheel</returns>
+    public: std::uint64_t GetCurrentTick() const { return this->currentTick; }
+
+    /// <summary>Counts the number of timers linked into the wheel</summary>
+    /// <returns>The number of pending timers</returns>
+    public: std::size_t Count() const { return this->count; }
+
+    /// <summary>Checks whether no timers are linked into the wheel</summary>
+    /// <returns>True if the wheel holds no timers</returns>
+    public: bool IsEmpty() const { return (this->count == 0); }
+
+    /// <summary>Links a timer into the wheel</summary>
+    /// <param name="node">Timer that will be linked, must not be linked already</param>
+    /// <remarks>
+    ///   A timer whose due tick lies in the past is moved up to the current tick and
+    ///   will expire the next time the wheel is advanced.
+    /// </remarks>
+    public: void Insert(TNode *node) {
+      if(node->DueTick < this->currentTick) {
+        node->DueTick = this->currentTick;
+      }
+      link(node);
+      ++this->count;
+    }
+
+    /// <summary>Unlinks a timer from the wheel</summary>
+    /// <param name="node">Timer that will be unlinked, must be linked into the wheel</param>
+    public: void Remove(TNode *node) {
+      unlink(node);
+      --this->count;
+    }
+
+    /// <summary>Determines the next tick at which the wheel has work to do</summary>
+    /// <returns>
+    ///   The earliest tick at which timers expire or need to be moved to a lower level
+    /// </returns>
+    /// <remarks>
+    ///   The returned tick can be earlier than the due tick of the earliest timer, in which
+    ///   case advancing to it only redistributes timers. It is never later, though.
+    /// </remarks>
+    public: std::uint64_t GetNextEventTick() const {
+      std::uint64_t nextEventTick = Never;
+      for(std::size_t level = 0; level < LevelCount; ++level) {
+        std::size_t shift = level * SlotBits;
+        std::size_t currentSlot = static_cast<std::size_t>(
+          (this->currentTick >> shift) & (SlotCount - 1)
+        );
+
+        // On the lowest level, the current slot may hold timers that are due right now.
+        // On the higher levels, timers are only ever linked into slots ahead of the current.
+        std::uint64_t candidates = this->occupiedSlots[level];
+        if(level == 0) {
+          candidates &= ~((std::uint64_t(1) << currentSlot) - 1);
+        } else {
+          candidates &= ~((std::uint64_t(2) << currentSlot) - 1);
+        }
+        if(candidates == 0) {
+          continue;
+        }
+
+        std::uint64_t slot = BitTricks::GetLogBase2(candidates & (~candidates + 1));
+        std::uint64_t eventTick = (slot << shift);
+        if(shift + SlotBits < 64) {
+          eventTick |= (this->currentTick >> (shift + SlotBits)) << (shift + SlotBits);
+        }
+
+        nextEventTick = std::min(nextEventTick, eventTick);
+      }
+
+      return nextEventTick;
+    }
+
+    /// <summary>Advances the wheel to the specified tick, collecting expired timers</summary>
+    /// <param name="tick">Tick up to which the wheel will be advanced</param>
+    /// <returns>
+    ///   A list, chained through the <code>Next</code> members, of all timers due at
+    ///   or before the specified tick. The expired timers are unlinked from the wheel.
+    /// </returns>
+    public: TNode *Advance(std::uint64_t tick) {
+      TNode *expired = nullptr;
+      if(tick < this->currentTick) {
+        return expired;
+      }
+
+      for(;;) {
+        std::uint64_t nextEventTick = GetNextEventTick();
+        if(nextEventTick > tick) {
+          this->currentTick = tick;
+          break;
+        }
+        this->currentTick = nextEventTick;
+
+        // Move the timers out of any higher-level slot that begins at the current tick.
+        // Going from the top down, timers moving down will be picked up by the lower levels.
+        for(std::size_t level = LevelCount - 1; level > 0; --level) {
+          std::size_t shift = level * SlotBits;
+          if((this->currentTick & ((std::uint64_t(1) << shift) - 1)) != 0) {
+            continue;
+          }
+
+          std::size_t slotIndex = level * SlotCount + static_cast<std::size_t>(
+            (this->currentTick >> shift) & (SlotCount - 1)
+          );
+          TNode *node = detachSlot(slotIndex);
+          while(node != nullptr) {
+            TNode *next = node->Next;
+            link(node);
+            node = next;
+          }
+        }
+
+        // Everything in the current slot of the lowest level has expired
+        TNode *node = detachSlot(
+          static_cast<std::size_t>(this->currentTick & (SlotCount - 1))
+        );
+        while(node != nullptr) {
+          TNode *next = node->Next;
+          node->Next = expired;
+          expired = node;
+          --this->count;
+          node = next;
+        }
+      }
+
+      return expired;
+    }
+
+    /// <summary>Unlinks all timers from the wheel</summary>
+    /// <returns>
+    ///   A list, chained through the <code>Next</code> members, of all the timers
+    /// </returns>
+    public: TNode *Clear() {
+      TNode *all = nullptr;
+      for(std::size_t slotIndex = 0; slotIndex < LevelCount * SlotCount; ++slotIndex) {
+        TNode *node = this->slots[slotIndex];
+        if(node != nullptr) {
+          node = detachSlot(slotIndex);
+          while(node != nullptr) {
+            TNode *next = node->Next;
+            node->Next = all;
+            all = node;
+            node = next;
+          }
+        }
+      }
+
+      this->count = 0;
+      return all;
+    }
+
+    /// <summary>Links a timer into the slot matching its due tick</summary>
+    /// <param name="node">Timer that will be linked</param>
+    private: void link(TNode *node) {
+
+      // The level is chosen by the highest bit in which the due tick differs from
+      // the current tick, so the timer ends up in a slot ahead of the current one.
+      std::uint64_t difference = node->DueTick ^ this->currentTick;
+      std::size_t level = 0;
+      if(difference >= SlotCount) {
+        level = BitTricks::GetLogBase2(difference) / SlotBits;
+      }
+
+      std::size_t slot = static_cast<std::size_t>(
+        (node->DueTick >> (level * SlotBits)) & (SlotCount - 1)
+      );
+      std::size_t slotIndex = level * SlotCount + slot;
+
+      TNode *head = this->slots[slotIndex];
+      node->Previous = nullptr;
+      node->Next = head;
+      node->SlotIndex = slotIndex;
+      if(head != nullptr) {
+        head->Previous = node;
+      }
+      this->slots[slotIndex] = node;
+      this->occupiedSlots[level] |= (std::uint64_t(1) << slot);
+    }
+
+    /// <summary>Unlinks a timer from the slot it is linked into</summary>
+    /// <param name="node">Timer that will be unlinked</param>
+    private: void unlink(TNode *node) {
+      std::size_t slotIndex = node->SlotIndex;
+      if(node->Previous != nullptr) {
+        node->Previous->Next = node->Next;
+      } else {
+        this->slots[slotIndex] = node->Next;
+        if(node->Next == nullptr) {
+          this->occupiedSlots[slotIndex / SlotCount] &= ~(
+            std::uint64_t(1) << (slotIndex % SlotCount)
+          );
+        }
+      }
+      if(node->Next != nullptr) {
+        node->Next->Previous = node->Previous;
+      }
+
+      node->Previous = nullptr;
+      node->Next = nullptr;
+      node->SlotIndex = Unlinked;
+    }
+
+    /// <summary>Takes all timers out of a slot</summary>
+    /// <param name="slotIndex">Index of the slot that will be emptied</param>
+    /// <returns>
+    ///   The first timer of the slot, the others are chained via <code>Next</code>
+    /// </returns>
+    private: TNode *detachSlot(std::size_t slotIndex) {
+      TNode *head = this->slots[slotIndex];
+      if(head != nullptr) {
+        this->slots[slotIndex] = nullptr;
+        this->occupiedSlots[slotIndex / SlotCount] &= ~(
+          std::uint64_t(1) << (slotIndex % SlotCount)
+        );
+        for(TNode *node = head; node != nullptr; node = node->Next) {
+          node->Previous = nullptr;
+          node->SlotIndex = Unlinked;
+        }
+      }
+
+      return head;
+    }
+
+    /// <summary>Tick the wheel has been advanced to</summary>
+    private: std::uint64_t currentTick;
+    /// <summary>Number of timers linked into the wheel</summary>
+    private: std::size_t count;
+    /// <summary>First timer in each slot of each level</summary>
+    private: TNode *slots[LevelCount * SlotCount];
+    /// <summary>Bit mask of the slots holding timers for each level</summary>
+    private: std::uint64_t occupiedSlots[LevelCount];
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Threading
+
+#endif // NUCLEX_SUPPORT_THREADING_THREADPOOLTIMERWHEEL_H
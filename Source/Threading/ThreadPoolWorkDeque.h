@@ -0,0 +1,276 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+#ifndef NUCLEX_SUPPORT_THREADING_THREADPOOLWORKDEQUE_H
+#define NUCLEX_SUPPORT_THREADING_THREADPOOLWORKDEQUE_H
+
+#include "Nuclex/Support/Config.h"
+
+#include <atomic> // for std::atomic
+#include <cstddef> // for std::size_t, std::ptrdiff_t
+#include <type_traits> // for std::is_trivially_copyable
+
+namespace Nuclex { namespace Support { namespace Threading {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Task queue owned by one worker thread that others can steal from</summary>
+  /// <typeparam name="TElement">Type of elements stored in the deque, usually a pointer</typeparam>
+  /// <remarks>
+  ///   <para>
+  ///     This is a Chase-Lev deque (with the memory orderings worked out by L&ecirc; et al.
+  ///     in "Correct and Efficient Work-Stealing for Weak Memory Models"). The owning
+  ///     thread pushes and pops at the bottom end without any locked instructions in
+  ///     the common case while other threads can steal from the top end using a single
+  ///     compare-and-exchange. A C-A-S on the owner's side is only needed when the owner
+  ///     and a thief race for the very last element.
+  ///   </para>
+  ///   <para>
+  ///     Push() and TryPop() may only ever be called by the thread owning the deque.
+  ///     TrySteal() can be called by any thread at any time.
+  ///   </para>
+  ///   <para>
+  ///     When the deque runs full, its ring buffer is doubled in size. Because a thief
+  ///     might still be reading from the old ring buffer, retired ring buffers are kept
+  ///     around until the deque is destroyed. Since each ring buffer is twice the size of
+  ///     its predecessor, this at most doubles the memory used by the deque.
+  ///   </para>
+  /// </remarks>
+  template<typename TElement>
+  class ThreadPoolWorkDeque {
+
+    static_assert(
+      std::is_trivially_copyable<TElement>::value,
+      u8"Work deque elements must be trivially copyable (these are meant to be pointers)"
+    );
+
+    /// <summary>Initializes a new work deque</summary>
+    /// <param name="initialCapacity">
+    ///   Number of elements the deque can hold before its buffer needs to grow,
+    ///   should be a power of two (it will be rounded up otherwise)
+    /// </param>
+    public: explicit ThreadPoolWorkDeque(std::size_t initialCapacity = 256) :
+      top(0),
+      bottom(0),
+      buffer(new RingBuffer(roundUpToPowerOfTwo(initialCapacity), nullptr)) {}
+
+    /// <summary>Frees all memory owned by the work deque</summary>
+    /// <remarks>
+    ///   Elements still stored in the deque are not touched, the owner needs to
+    ///   remove them before destroying the deque if they require any cleanup.
+    /// </remarks>
+    public: ~ThreadPoolWorkDeque() {
+      RingBuffer *ringBuffer = this->buffer.load(std::memory_order_relaxed);
+      while(ringBuffer != nullptr) {
+        RingBuffer *previous = ringBuffer->Previous;
+        delete ringBuffer;
+        ringBuffer = previous;
+      }
+    }
+
+    /// <summary>Adds an element to the bottom of the deque</summary>
+    /// <param name="element">Element that will be added</param>
+    /// <remarks>
+    ///   Only the owning thread is allowed to call this method.
+    /// </remarks>
+    public: void Push(const TElement &element) {
+      std::ptrdiff_t safeBottom = this->bottom.load(std::memory_order_relaxed);
+      std::ptrdiff_t safeTop = this->top.load(std::memory_order_acquire);
+      RingBuffer *ringBuffer = this->buffer.load(std::memory_order_relaxed);
+
+      // If the ring buffer is full, replace it with one that is twice as large
+      if(unlikely(static_cast<std::size_t>(safeBottom - safeTop) > ringBuffer->Mask)) {
+        ringBuffer = grow(ringBuffer, safeTop, safeBottom);
+      }
+
+      ringBuffer->Elements[safeBottom & ringBuffer->Mask].store(
+        element, std::memory_order_relaxed
+      );
+      std::atomic_thread_fence(std::memory_order_release);
+      this->bottom.store(safeBottom + 1, std::memory_order_relaxed);
+    }
+
+    /// <summary>Tries to take the most recently pushed element from the deque</summary>
+    /// <param name="element">Receives the element if one could be taken</param>
+    /// <returns>True if an element was taken, false if the deque was empty</returns>
+    /// <remarks>
+    ///   Only the owning thread is allowed to call this method.
+    /// </remarks>
+    public: bool TryPop(TElement &element) {
+      std::ptrdiff_t safeBottom = this->bottom.load(std::memory_order_relaxed) - 1;
+      RingBuffer *ringBuffer = this->buffer.load(std::memory_order_relaxed);
+      this->bottom.store(safeBottom, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      std::ptrdiff_t safeTop = this->top.load(std::memory_order_relaxed);
+
+      // Is the deque empty? Then restore the bottom index we just decremented
+      if(safeTop > safeBottom) {
+        this->bottom.store(safeBottom + 1, std::memory_order_relaxed);
+        return false;
+      }
+
+      element = ringBuffer->Elements[safeBottom & ringBuffer->Mask].load(
+        std::memory_order_relaxed
+      );
+
+      // If this was the last element, a thief may be attempting to steal it at the same
+      // time. Whoever manages to advance the top index gets to keep it.
+      if(safeTop == safeBottom) {
+        bool wasTaken = this->top.compare_exchange_strong(
+          safeTop, safeTop + 1, std::memory_order_seq_cst, std::memory_order_relaxed
+        );
+        this->bottom.store(safeBottom + 1, std::memory_order_relaxed);
+        return wasTaken;
+      }
+
+      return true;
+    }
+
+    /// <summary>Tries to take the oldest element from the deque</summary>
+    /// <param name="element">Receives the element if one could be stolen</param>
+    /// <returns>
+    ///   True if an element was stolen, false if the deque was empty or another thread
+    ///   took the element first
+    /// </returns>
+    /// <remarks>
+    ///   This method can be called from any thread.
+    /// </remarks>
+    public: bool TrySteal(TElement &element) {
+      std::ptrdiff_t safeTop = this->top.load(std::memory_order_acquire);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      std::ptrdiff_t safeBottom = this->bottom.load(std::memory_order_acquire);
+      if(safeTop >= safeBottom) {
+        return false;
+      }
+
+      // The ring buffer is read after the indices, so if the owner just replaced it,
+      // we'll either see the new buffer or the old one, both hold our element.
+      RingBuffer *ringBuffer = this->buffer.load(std::memory_order_acquire);
+      TElement stolenElement = ringBuffer->Elements[safeTop & ringBuffer->Mask].load(
+        std::memory_order_relaxed
+      );
+
+      bool wasTaken = this->top.compare_exchange_strong(
+        safeTop, safeTop + 1, std::memory_order_seq_cst, std::memory_order_relaxed
+      );
+      if(wasTaken) {
+        element = stolenElement;
+      }
+
+      return wasTaken;
+    }
+
+    /// <summary>Checks whether the deque is empty</summary>
+    /// <returns>True if the deque appeared to be empty at the time of the check</returns>
+    /// <remarks>
+    ///   This is only a snapshot. Unless called by the owning thread, elements can
+    ///   be added to or removed from the deque right after the check was made.
+    /// </remarks>
+    public: bool IsEmpty() const {
+      std::ptrdiff_t safeTop = this->top.load(std::memory_order_relaxed);
+      std::ptrdiff_t safeBottom = this->bottom.load(std::memory_order_relaxed);
+      return (safeTop >= safeBottom);
+    }
+
+    /// <summary>Counts the number of elements currently stored in the deque</summary>
+    /// <returns>The approximate number of elements in the deque</returns>
+    public: std::size_t CountApproximately() const {
+      std::ptrdiff_t safeTop = this->top.load(std::memory_order_relaxed);
+      std::ptrdiff_t safeBottom = this->bottom.load(std::memory_order_relaxed);
+      if(safeTop >= safeBottom) {
+        return 0;
+      } else {
+        return static_cast<std::size_t>(safeBottom - safeTop);
+      }
+    }
+
+    #pragma region struct RingBuffer
+
+    /// <summary>Fixed-size ring buffer holding the elements of the deque</summary>
+    private: struct RingBuffer {
+
+      /// <summary>Initializes a new ring buffer</summary>
+      /// <param name="capacity">Number of elements the ring buffer can hold</param>
+      /// <param name="previous">Ring buffer that has been replaced by this one</param>
+      public: RingBuffer(std::size_t capacity, RingBuffer *previous) :
+        Mask(capacity - 1),
+        Elements(new std::atomic<TElement>[capacity]),
+        Previous(previous) {}
+
+      /// <summary>Frees the memory used by the ring buffer</summary>
+      public: ~RingBuffer() {
+        delete[] this->Elements;
+      }
+
+      /// <summary>Bit mask that wraps an index into the ring buffer</summary>
+      public: std::size_t Mask;
+      /// <summary>Slots that can hold the elements of the deque</summary>
+      public: std::atomic<TElement> *Elements;
+      /// <summary>Ring buffer that has been replaced by this one, retired</summary>
+      public: RingBuffer *Previous;
+
+    };
+
+    #pragma endregion // struct RingBuffer
+
+    /// <summary>Replaces the ring buffer with one twice as large</summary>
+    /// <param name="ringBuffer">Ring buffer that has run full</param>
+    /// <param name="safeTop">Index of the oldest element in the deque</param>
+    /// <param name="safeBottom">Index one past the newest element in the deque</param>
+    /// <returns>The new ring buffer</returns>
+    private: RingBuffer *grow(
+      RingBuffer *ringBuffer, std::ptrdiff_t safeTop, std::ptrdiff_t safeBottom
+    ) {
+      RingBuffer *newRingBuffer = new RingBuffer((ringBuffer->Mask + 1) * 2, ringBuffer);
+      for(std::ptrdiff_t index = safeTop; index < safeBottom; ++index) {
+        newRingBuffer->Elements[index & newRingBuffer->Mask].store(
+          ringBuffer->Elements[index & ringBuffer->Mask].load(std::memory_order_relaxed),
+          std::memory_order_relaxed
+        );
+      }
+
+      this->buffer.store(newRingBuffer, std::memory_order_release);
+      return newRingBuffer;
+    }
+
+    /// <summary>Rounds a capacity up to the next power of two</summary>
+    /// <param name="capacity">Capacity that will be rounded up</param>
+    /// <returns>The smallest power of two that is equal to or larger than the input</returns>
+    private: static std::size_t roundUpToPowerOfTwo(std::size_t capacity) {
+      std::size_t powerOfTwo = 2;
+      while(powerOfTwo < capacity) {
+        powerOfTwo <<= 1;
+      }
+      return powerOfTwo;
+    }
+
+    /// <summary>Index of the oldest element, advanced by thieves</summary>
+    private: alignas(64) std::atomic<std::ptrdiff_t> top;
+    /// <summary>Index one past the newest element, only modified by the owner</summary>
+    private: alignas(64) std::atomic<std::ptrdiff_t> bottom;
+    /// <summary>Ring buffer currently holding the elements</summary>
+    private: std::atomic<RingBuffer *> buffer;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Threading
+
+#endif // NUCLEX_SUPPORT_THREADING_THREADPOOLWORKDEQUE_H
@@ -0,0 +1,153 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+#ifndef NUCLEX_SUPPORT_THREADING_WAITWORD_H
+#define NUCLEX_SUPPORT_THREADING_WAITWORD_H
+
+#include "Nuclex/Support/Config.h"
+
+#if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+
+#if defined(NUCLEX_SUPPORT_LINUX)
+#include "../Platform/LinuxFutexApi.h" // for LinuxFutexApi::PrivateFutexWait() and more
+#elif defined(NUCLEX_SUPPORT_WINDOWS)
+#include "../Platform/WindowsSyncApi.h" // for WindowsSyncApi::WaitOnAddress() and more
+#endif
+
+#include <atomic> // for std::atomic
+#include <cstdint> // for std::uint32_t
+#include <chrono> // for std::chrono::microseconds
+
+namespace Nuclex { namespace Support { namespace Threading {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Lets threads sleep until an atomic 32 bit word changes its value</summary>
+  /// <remarks>
+  ///   <para>
+  ///     The <see cref="Gate" />, <see cref="Latch" /> and <see cref="Semaphore" /> each
+  ///     carry their own futex (or WaitOnAddress()) code paths. Synchronization primitives
+  ///     whose logic is the same on both platforms and which only need to sleep while
+  ///     a word has a certain value use this helper instead.
+  ///   </para>
+  ///   <para>
+  ///     Both the futex syscall and WaitOnAddress() check the word against the expected
+  ///     value atomically with going to sleep, so a wake-up between checking the word in
+  ///     user space and calling <see cref="Wait" /> is never lost. Both may also return
+  ///     spuriously, callers always need to re-check the word in a loop.
+  ///   </para>
+  /// </remarks>
+  class WaitWord {
+
+    /// <summary>Sleeps while the word has the expected value</summary>
+    /// <param name="word">Word that will be watched</param>
+    /// <param name="expectedValue">
+    ///   Value the word is expected to have, if it has any other value, the method
+    ///   returns immediately
+    /// </param>
+    public: static void Wait(
+      const std::atomic<std::uint32_t> &word, std::uint32_t expectedValue
+    ) {
+#if defined(NUCLEX_SUPPORT_LINUX)
+      Platform::LinuxFutexApi::PrivateFutexWait(ToVolatileWord(word), expectedValue);
+#else
+      Platform::WindowsSyncApi::WaitOnAddress(ToVolatileWord(word), expectedValue);
+#endif
+    }
+
+    /// <summary>Sleeps while the word has the expected value or until a timeout</summary>
+    /// <param name="word">Word that will be watched</param>
+    /// <param name="expectedValue">
+    ///   Value the word is expected to have, if it has any other value, the method
+    ///   returns immediately
+    /// </param>
+    /// <param name="patience">Maximum amount of time to sleep</param>
+    /// <returns>False if the timeout was reached, true otherwise</returns>
+    public: static bool WaitFor(
+      const std::atomic<std::uint32_t> &word,
+      std::uint32_t expectedValue,
+      std::chrono::microseconds patience
+    ) {
+#if defined(NUCLEX_SUPPORT_LINUX)
+      struct ::timespec timeout;
+      timeout.tv_sec = static_cast<std::time_t>(patience.count() / 1000000);
+      timeout.tv_nsec = static_cast<long>((patience.count() % 1000000) * 1000);
+      return (
+        Platform::LinuxFutexApi::PrivateFutexWait(ToVolatileWord(word), expectedValue, timeout) !=
+        Platform::LinuxFutexApi::WaitResult::TimedOut
+      );
+#else
+      return (
+        Platform::WindowsSyncApi::WaitOnAddress(
+          ToVolatileWord(word),
+          expectedValue,
+          std::chrono::duration_cast<std::chrono::milliseconds>(
+            patience + std::chrono::microseconds(999)
+          )
+        ) != Platform::WindowsSyncApi::WaitResult::TimedOut
+      );
+#endif
+    }
+
+    /// <summary>Wakes up a single thread sleeping on the word</summary>
+    /// <param name="word">Word the thread to wake up is sleeping on</param>
+    public: static void WakeOne(const std::atomic<std::uint32_t> &word) {
+#if defined(NUCLEX_SUPPORT_LINUX)
+      Platform::LinuxFutexApi::PrivateFutexWakeSingle(ToVolatileWord(word));
+#else
+      Platform::WindowsSyncApi::WakeByAddressSingle(ToVolatileWord(word));
+#endif
+    }
+
+    /// <summary>Wakes up all threads sleeping on the word</summary>
+    /// <param name="word">Word the threads to wake up are sleeping on</param>
+    public: static void WakeAll(const std::atomic<std::uint32_t> &word) {
+#if defined(NUCLEX_SUPPORT_LINUX)
+      Platform::LinuxFutexApi::PrivateFutexWakeAll(ToVolatileWord(word));
+#else
+      Platform::WindowsSyncApi::WakeByAddressAll(ToVolatileWord(word));
+#endif
+    }
+
+    /// <summary>Accesses the raw 32 bit word stored inside an atomic</summary>
+    /// <param name="word">Atomic whose raw word will be returned</param>
+    /// <returns>The raw word the operating system can watch</returns>
+    public: static const volatile std::uint32_t &ToVolatileWord(
+      const std::atomic<std::uint32_t> &word
+    ) {
+      static_assert(
+        sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t),
+        u8"Atomic 32 bit words are stored as plain 32 bit words"
+      );
+      static_assert(
+        std::atomic<std::uint32_t>::is_always_lock_free,
+        u8"Atomic 32 bit words do not need a lock"
+      );
+      return *reinterpret_cast<const volatile std::uint32_t *>(&word);
+    }
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Threading
+
+#endif // defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+
+#endif // NUCLEX_SUPPORT_THREADING_WAITWORD_H
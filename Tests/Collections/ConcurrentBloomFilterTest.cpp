@@ -0,0 +1,129 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the library is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_SUPPORT_SOURCE 1
+
+#include "Nuclex/Support/Collections/ConcurrentBloomFilter.h"
+
+#include <gtest/gtest.h>
+
+#include <thread> // for std::thread
+#include <vector> // for std::vector
+#include <string> // for std::string
+
+namespace Nuclex { namespace Support { namespace Collections {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ConcurrentBloomFilterTest, InstancesCanBeCreated) {
+    EXPECT_NO_THROW(
+      ConcurrentBloomFilter<std::string> filter(1000);
+    );
+    EXPECT_NO_THROW(
+      ConcurrentBloomFilter<std::string> filter(0);
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ConcurrentBloomFilterTest, NewInstanceContainsNothing) {
+    ConcurrentBloomFilter<std::size_t> filter(1000);
+    for(std::size_t key = 0; key < 1000; ++key) {
+      EXPECT_FALSE(filter.MightContain(key));
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ConcurrentBloomFilterTest, InsertedKeysAreNeverMissed) {
+    ConcurrentBloomFilter<std::string> filter(1000);
+    for(std::size_t key = 0; key < 1000; ++key) {
+      filter.Insert(std::to_string(key));
+    }
+    for(std::size_t key = 0; key < 1000; ++key) {
+      EXPECT_TRUE(filter.MightContain(std::to_string(key)));
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ConcurrentBloomFilterTest, FalsePositivesAreRare) {
+    const std::size_t KeyCount = 100000;
+    ConcurrentBloomFilter<std::size_t> filter(KeyCount);
+    for(std::size_t key = 0; key < KeyCount; ++key) {
+      filter.Insert(key);
+    }
+
+    std::size_t falsePositiveCount = 0;
+    for(std::size_t key = KeyCount; key < KeyCount * 11; ++key) {
+      if(filter.MightContain(key)) {
+        ++falsePositiveCount;
+      }
+    }
+
+    // About one in 1000 is expected, allow for some slack
+    EXPECT_LT(falsePositiveCount, KeyCount * 10 / 100);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ConcurrentBloomFilterTest, ClearForgetsAllKeys) {
+    ConcurrentBloomFilter<std::size_t> filter(100);
+    for(std::size_t key = 0; key < 100; ++key) {
+      filter.Insert(key);
+    }
+
+    filter.Clear();
+    for(std::size_t key = 0; key < 100; ++key) {
+      EXPECT_FALSE(filter.MightContain(key));
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ConcurrentBloomFilterTest, ThreadsCanInsertConcurrently) {
+    const std::size_t KeysPerThread = 20000;
+    const std::size_t ThreadCount = 4;
+    ConcurrentBloomFilter<std::size_t> filter(KeysPerThread * ThreadCount);
+
+    std::vector<std::thread> threads;
+    for(std::size_t index = 0; index < ThreadCount; ++index) {
+      threads.emplace_back(
+        [&filter, index, KeysPerThread]() {
+          std::size_t first = index * KeysPerThread;
+          for(std::size_t key = first; key < first + KeysPerThread; ++key) {
+            filter.Insert(key);
+          }
+        }
+      );
+    }
+
+    for(std::size_t index = 0; index < threads.size(); ++index) {
+      threads[index].join();
+    }
+
+    for(std::size_t key = 0; key < KeysPerThread * ThreadCount; ++key) {
+      EXPECT_TRUE(filter.MightContain(key));
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Collections
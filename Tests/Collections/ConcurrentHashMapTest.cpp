@@ -0,0 +1,217 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the library is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_SUPPORT_SOURCE 1
+
+#include "Nuclex/Support/Collections/ConcurrentHashMap.h"
+#include "BufferTest.h"
+
+#include <gtest/gtest.h>
+
+#include <thread> // for std::thread
+#include <vector> // for std::vector
+#include <string> // for std::string
+#include <stdexcept> // for std::runtime_error
+
+namespace Nuclex { namespace Support { namespace Collections {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ConcurrentHashMapTest, InstancesCanBeCreated) {
+    typedef ConcurrentHashMap<int, std::string> StringMap;
+    EXPECT_NO_THROW(
+      StringMap map;
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ConcurrentHashMapTest, NewInstanceIsEmpty) {
+    ConcurrentHashMap<int, std::string> map;
+    EXPECT_TRUE(map.IsEmpty());
+    EXPECT_EQ(map.Count(), 0U);
+
+    std::string value;
+    EXPECT_FALSE(map.TryGet(123, value));
+    EXPECT_FALSE(map.TryTake(123, value));
+    EXPECT_FALSE(map.TryRemove(123));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ConcurrentHashMapTest, ElementsCanBeInsertedAndLookedUp) {
+    ConcurrentHashMap<int, std::string> map;
+    EXPECT_TRUE(map.TryInsert(1, u8"One"));
+    EXPECT_TRUE(map.TryInsert(2, u8"Two"));
+    EXPECT_FALSE(map.TryInsert(1, u8"Uno"));
+    EXPECT_EQ(map.Count(), 2U);
+
+    std::string value;
+    EXPECT_TRUE(map.TryGet(1, value));
+    EXPECT_EQ(value, u8"One");
+    EXPECT_TRUE(map.TryGet(2, value));
+    EXPECT_EQ(value, u8"Two");
+    EXPECT_FALSE(map.TryGet(3, value));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ConcurrentHashMapTest, ElementsCanBeTakenAndRemoved) {
+    ConcurrentHashMap<int, std::string> map;
+    map.TryInsert(1, u8"One");
+    map.TryInsert(2, u8"Two");
+
+    std::string value;
+    EXPECT_TRUE(map.TryTake(1, value));
+    EXPECT_EQ(value, u8"One");
+    EXPECT_FALSE(map.TryTake(1, value));
+    EXPECT_FALSE(map.TryGet(1, value));
+
+    EXPECT_TRUE(map.TryRemove(2));
+    EXPECT_FALSE(map.TryRemove(2));
+    EXPECT_TRUE(map.IsEmpty());
+
+    EXPECT_TRUE(map.TryInsert(1, u8"Uno"));
+    EXPECT_TRUE(map.TryGet(1, value));
+    EXPECT_EQ(value, u8"Uno");
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ConcurrentHashMapTest, ElementsSurviveGrowth) {
+    const std::size_t ElementCount = 10000;
+    ConcurrentHashMap<std::size_t, std::size_t> map(16);
+
+    for(std::size_t index = 0; index < ElementCount; ++index) {
+      EXPECT_TRUE(map.TryInsert(index, index * 3));
+    }
+    for(std::size_t index = 0; index < ElementCount; index += 2) {
+      EXPECT_TRUE(map.TryRemove(index));
+    }
+    EXPECT_EQ(map.Count(), ElementCount / 2);
+
+    for(std::size_t index = 0; index < ElementCount; ++index) {
+      std::size_t value = 0;
+      if((index & 1) == 0) {
+        EXPECT_FALSE(map.TryGet(index, value));
+      } else {
+        ASSERT_TRUE(map.TryGet(index, value));
+        EXPECT_EQ(value, index * 3);
+      }
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ConcurrentHashMapTest, RemainingElementsAreDestroyed) {
+    std::vector<std::shared_ptr<TestItemStats>> stats = makeStats(1);
+    {
+      TestItem item(stats[0]);
+      ConcurrentHashMap<int, TestItem> map;
+      for(int index = 0; index < 500; ++index) {
+        EXPECT_TRUE(map.TryInsert(index, item));
+      }
+      for(int index = 0; index < 500; index += 3) {
+        EXPECT_TRUE(map.TryRemove(index));
+      }
+    }
+
+    // Copies are also made when the map grows, but each must be destroyed exactly once
+    EXPECT_GE(stats[0]->CopyCount, 500);
+    EXPECT_EQ(stats[0]->DestroyCount, stats[0]->CopyCount + 1);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ConcurrentHashMapTest, ThrowingCopyDoesNotInsertElement) {
+    std::vector<std::shared_ptr<TestItemStats>> stats = makeStats(2);
+    std::vector<TestItem> items;
+    makeItems(items, stats);
+
+    ConcurrentHashMap<int, TestItem> map;
+    stats[0]->ThrowOnCopy = true;
+    EXPECT_THROW(map.TryInsert(1, items[0]), std::runtime_error);
+    EXPECT_TRUE(map.IsEmpty());
+
+    EXPECT_TRUE(map.TryInsert(1, items[1]));
+    EXPECT_EQ(map.Count(), 1U);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ConcurrentHashMapTest, ThreadsCanInsertLookUpAndRemoveConcurrently) {
+    const std::size_t ElementsPerThread = 20000;
+    const std::size_t ThreadCount = 4;
+    ConcurrentHashMap<std::size_t, std::size_t> map;
+
+    std::atomic<std::size_t> mismatchCount(0);
+
+    std::vector<std::thread> threads;
+    for(std::size_t index = 0; index < ThreadCount; ++index) {
+      threads.emplace_back(
+        [&map, &mismatchCount, index, ElementsPerThread]() {
+          std::size_t first = index * ElementsPerThread;
+          for(std::size_t key = first; key < first + ElementsPerThread; ++key) {
+            if(!map.TryInsert(key, key + 1)) {
+              mismatchCount.fetch_add(1, std::memory_order_relaxed);
+            }
+          }
+          for(std::size_t key = first; key < first + ElementsPerThread; ++key) {
+            std::size_t value = 0;
+            if(!map.TryGet(key, value) || (value != key + 1)) {
+              mismatchCount.fetch_add(1, std::memory_order_relaxed);
+            }
+            if((key & 1) == 0) {
+              if(!map.TryTake(key, value) || (value != key + 1)) {
+                mismatchCount.fetch_add(1, std::memory_order_relaxed);
+              }
+            }
+          }
+        }
+      );
+
+      // Readers looking at the keys of the writers, they may or may not find them
+      threads.emplace_back(
+        [&map, &mismatchCount, ElementsPerThread, ThreadCount]() {
+          for(std::size_t key = 0; key < ElementsPerThread * ThreadCount; ++key) {
+            std::size_t value = 0;
+            if(map.TryGet(key, value) && (value != key + 1)) {
+              mismatchCount.fetch_add(1, std::memory_order_relaxed);
+            }
+          }
+        }
+      );
+    }
+
+    for(std::size_t index = 0; index < threads.size(); ++index) {
+      threads[index].join();
+    }
+
+    EXPECT_EQ(mismatchCount.load(), 0U);
+    EXPECT_EQ(map.Count(), ElementsPerThread * ThreadCount / 2);
+    for(std::size_t key = 0; key < ElementsPerThread * ThreadCount; ++key) {
+      std::size_t value = 0;
+      EXPECT_EQ(map.TryGet(key, value), (key & 1) != 0);
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Collections
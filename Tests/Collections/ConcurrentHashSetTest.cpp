@@ -0,0 +1,136 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the library is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_SUPPORT_SOURCE 1
+
+#include "Nuclex/Support/Collections/ConcurrentHashSet.h"
+
+#include <gtest/gtest.h>
+
+#include <thread> // for std::thread
+#include <vector> // for std::vector
+#include <string> // for std::string
+
+namespace Nuclex { namespace Support { namespace Collections {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ConcurrentHashSetTest, InstancesCanBeCreated) {
+    EXPECT_NO_THROW(
+      ConcurrentHashSet<std::string> set;
+    );
+    EXPECT_NO_THROW(
+      ConcurrentHashSet<std::string> set(16, 1000);
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ConcurrentHashSetTest, NewInstanceIsEmpty) {
+    ConcurrentHashSet<int> set;
+    EXPECT_TRUE(set.IsEmpty());
+    EXPECT_EQ(set.Count(), 0U);
+    EXPECT_FALSE(set.Contains(123));
+    EXPECT_FALSE(set.TryRemove(123));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ConcurrentHashSetTest, KeysCanBeInsertedAndRemoved) {
+    ConcurrentHashSet<std::string> set;
+    EXPECT_TRUE(set.TryInsert(u8"Hello"));
+    EXPECT_TRUE(set.TryInsert(u8"World"));
+    EXPECT_FALSE(set.TryInsert(u8"Hello"));
+    EXPECT_EQ(set.Count(), 2U);
+
+    EXPECT_TRUE(set.Contains(u8"Hello"));
+    EXPECT_TRUE(set.Contains(u8"World"));
+    EXPECT_FALSE(set.Contains(u8"Goodbye"));
+
+    EXPECT_TRUE(set.TryRemove(u8"Hello"));
+    EXPECT_FALSE(set.TryRemove(u8"Hello"));
+    EXPECT_FALSE(set.Contains(u8"Hello"));
+    EXPECT_EQ(set.Count(), 1U);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ConcurrentHashSetTest, FilteredSetFindsAllKeys) {
+    const std::size_t KeyCount = 10000;
+    ConcurrentHashSet<std::size_t> set(16, KeyCount);
+
+    for(std::size_t key = 0; key < KeyCount; ++key) {
+      EXPECT_TRUE(set.TryInsert(key * 7));
+    }
+    for(std::size_t key = 0; key < KeyCount * 7; ++key) {
+      EXPECT_EQ(set.Contains(key), (key % 7) == 0);
+    }
+
+    // Removed keys must be reported as missing even though the filter still has them
+    for(std::size_t key = 0; key < KeyCount; key += 2) {
+      EXPECT_TRUE(set.TryRemove(key * 7));
+    }
+    for(std::size_t key = 0; key < KeyCount; ++key) {
+      EXPECT_EQ(set.Contains(key * 7), (key & 1) != 0);
+    }
+    EXPECT_EQ(set.Count(), KeyCount / 2);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ConcurrentHashSetTest, ThreadsCanInsertAndCheckConcurrently) {
+    const std::size_t KeysPerThread = 20000;
+    const std::size_t ThreadCount = 4;
+    ConcurrentHashSet<std::size_t> set(16, KeysPerThread * ThreadCount);
+
+    // All threads try to insert the same keys, each key must be inserted exactly once
+    std::atomic<std::size_t> insertedCount(0);
+    std::atomic<std::size_t> missingCount(0);
+
+    std::vector<std::thread> threads;
+    for(std::size_t index = 0; index < ThreadCount; ++index) {
+      threads.emplace_back(
+        [&set, &insertedCount, &missingCount, index, KeysPerThread, ThreadCount]() {
+          std::size_t keyCount = KeysPerThread * ThreadCount;
+          for(std::size_t counter = 0; counter < keyCount; ++counter) {
+            std::size_t key = (counter + index * KeysPerThread) % keyCount;
+            if(set.TryInsert(key)) {
+              insertedCount.fetch_add(1, std::memory_order_relaxed);
+            }
+            if(!set.Contains(key)) {
+              missingCount.fetch_add(1, std::memory_order_relaxed);
+            }
+          }
+        }
+      );
+    }
+
+    for(std::size_t index = 0; index < threads.size(); ++index) {
+      threads[index].join();
+    }
+
+    EXPECT_EQ(insertedCount.load(), KeysPerThread * ThreadCount);
+    EXPECT_EQ(missingCount.load(), 0U);
+    EXPECT_EQ(set.Count(), KeysPerThread * ThreadCount);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Collections
@@ -0,0 +1,197 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the library is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_SUPPORT_SOURCE 1
+
+#include "Nuclex/Support/Collections/ConcurrentMultiQueue.h"
+
+#if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+
+#include "BufferTest.h"
+
+#include <gtest/gtest.h>
+
+#include <thread> // for std::thread
+#include <vector> // for std::vector
+#include <stdexcept> // for std::runtime_error
+
+namespace {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Comparison under which all test items are equal</summary>
+  struct UnorderedTestItems {
+
+    /// <summary>Checks whether the left test item comes before the right one</summary>
+    /// <returns>Always false</returns>
+    public: bool operator()(const TestItem &, const TestItem &) const {
+      return false;
+    }
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // anonymous namespace
+
+namespace Nuclex { namespace Support { namespace Collections {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ConcurrentMultiQueueTest, InstancesCanBeCreated) {
+    EXPECT_NO_THROW(
+      ConcurrentMultiQueue<int> queue;
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ConcurrentMultiQueueTest, NewInstanceIsEmpty) {
+    ConcurrentMultiQueue<int> queue;
+    EXPECT_TRUE(queue.IsEmpty());
+    EXPECT_EQ(queue.Count(), 0U);
+
+    int element = 0;
+    EXPECT_FALSE(queue.TryTakeMin(element));
+    EXPECT_FALSE(queue.TryTake(element));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ConcurrentMultiQueueTest, SingleHeapTakesElementsInOrder) {
+    const std::size_t ElementCount = 1000;
+    ConcurrentMultiQueue<std::size_t> queue(1);
+
+    for(std::size_t index = 0; index < ElementCount; ++index) {
+      EXPECT_TRUE(queue.TryAppend((index * 7919) % ElementCount));
+    }
+    for(std::size_t index = 0; index < ElementCount; ++index) {
+      std::size_t element = ElementCount;
+      ASSERT_TRUE(queue.TryTakeMin(element));
+      EXPECT_EQ(element, index);
+    }
+    EXPECT_TRUE(queue.IsEmpty());
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ConcurrentMultiQueueTest, TakenElementsAreAmongTheSmallest) {
+    const std::size_t ElementCount = 10000;
+    ConcurrentMultiQueue<std::size_t> queue(8);
+
+    for(std::size_t index = 0; index < ElementCount; ++index) {
+      queue.TryAppend((index * 7919) % ElementCount);
+    }
+    EXPECT_EQ(queue.Count(), ElementCount);
+
+    // Each heap holds about an eighth of the elements, so the smallest element of any
+    // heap should never be far away from the smallest element remaining overall
+    std::vector<bool> isTaken(ElementCount, false);
+    std::size_t smallestRemaining = 0;
+    std::size_t largestDistance = 0;
+    for(std::size_t index = 0; index < ElementCount; ++index) {
+      std::size_t element = ElementCount;
+      ASSERT_TRUE(queue.TryTakeMin(element));
+      ASSERT_LT(element, ElementCount);
+      ASSERT_FALSE(isTaken[element]);
+      isTaken[element] = true;
+
+      if(element - smallestRemaining > largestDistance) {
+        largestDistance = element - smallestRemaining;
+      }
+      while((smallestRemaining < ElementCount) && isTaken[smallestRemaining]) {
+        ++smallestRemaining;
+      }
+    }
+
+    EXPECT_EQ(smallestRemaining, ElementCount);
+    EXPECT_LT(largestDistance, 1000U);
+    EXPECT_TRUE(queue.IsEmpty());
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ConcurrentMultiQueueTest, ThrowingMoveLeavesElementInQueue) {
+    std::vector<std::shared_ptr<TestItemStats>> stats = makeStats(2);
+    std::vector<TestItem> items;
+    makeItems(items, stats);
+
+    ConcurrentMultiQueue<TestItem, UnorderedTestItems> queue(2);
+    EXPECT_TRUE(queue.TryAppend(items[0]));
+
+    stats[0]->ThrowOnMove = true;
+    EXPECT_THROW(queue.TryTakeMin(items[1]), std::runtime_error);
+    EXPECT_EQ(queue.Count(), 1U);
+
+    stats[0]->ThrowOnMove = false;
+    EXPECT_TRUE(queue.TryTakeMin(items[1]));
+    EXPECT_TRUE(queue.IsEmpty());
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ConcurrentMultiQueueTest, TransfersAllElementsBetweenThreads) {
+    const std::size_t ElementsPerProducer = 20000;
+    const std::size_t ThreadCount = 4;
+    ConcurrentMultiQueue<std::size_t> queue(ThreadCount * 2);
+
+    std::atomic<std::size_t> takenCount(0);
+    std::atomic<std::size_t> takenSum(0);
+
+    std::vector<std::thread> threads;
+    for(std::size_t index = 0; index < ThreadCount; ++index) {
+      threads.emplace_back(
+        [&queue, index, ElementsPerProducer]() {
+          std::size_t first = index * ElementsPerProducer;
+          for(std::size_t element = first; element < first + ElementsPerProducer; ++element) {
+            queue.TryAppend(element);
+          }
+        }
+      );
+      threads.emplace_back(
+        [&queue, &takenCount, &takenSum, ElementsPerProducer, ThreadCount]() {
+          std::size_t element;
+          while(takenCount.load(std::memory_order_relaxed) < ElementsPerProducer * ThreadCount) {
+            if(queue.TryTakeMin(element)) {
+              takenSum.fetch_add(element, std::memory_order_relaxed);
+              takenCount.fetch_add(1, std::memory_order_relaxed);
+            } else {
+              std::this_thread::yield();
+            }
+          }
+        }
+      );
+    }
+
+    for(std::size_t index = 0; index < threads.size(); ++index) {
+      threads[index].join();
+    }
+
+    const std::size_t totalCount = ElementsPerProducer * ThreadCount;
+    EXPECT_EQ(takenCount.load(), totalCount);
+    EXPECT_EQ(takenSum.load(), totalCount * (totalCount - 1) / 2);
+    EXPECT_TRUE(queue.IsEmpty());
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Collections
+
+#endif // defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
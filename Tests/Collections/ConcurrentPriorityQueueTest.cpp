@@ -0,0 +1,249 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the library is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_SUPPORT_SOURCE 1
+
+#include "Nuclex/Support/Collections/ConcurrentPriorityQueue.h"
+#include "BufferTest.h"
+
+#include <gtest/gtest.h>
+
+#include <thread> // for std::thread
+#include <vector> // for std::vector
+#include <functional> // for std::greater
+#include <stdexcept> // for std::runtime_error
+
+namespace {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Comparison under which all test items are equal</summary>
+  struct UnorderedTestItems {
+
+    /// <summary>Checks whether the left test item comes before the right one</summary>
+    /// <returns>Always false</returns>
+    public: bool operator()(const TestItem &, const TestItem &) const {
+      return false;
+    }
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // anonymous namespace
+
+namespace Nuclex { namespace Support { namespace Collections {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ConcurrentPriorityQueueTest, InstancesCanBeCreated) {
+    EXPECT_NO_THROW(
+      ConcurrentPriorityQueue<int> queue;
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ConcurrentPriorityQueueTest, NewInstanceIsEmpty) {
+    ConcurrentPriorityQueue<int> queue;
+    EXPECT_TRUE(queue.IsEmpty());
+    EXPECT_EQ(queue.Count(), 0U);
+
+    int element = 0;
+    EXPECT_FALSE(queue.TryTakeMin(element));
+    EXPECT_FALSE(queue.TryTake(element));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ConcurrentPriorityQueueTest, ElementsAreTakenInOrder) {
+    const std::size_t ElementCount = 10000;
+    ConcurrentPriorityQueue<std::size_t> queue;
+
+    // 7919 is prime, so this appends every number once in a scrambled order
+    for(std::size_t index = 0; index < ElementCount; ++index) {
+      EXPECT_TRUE(queue.TryAppend((index * 7919) % ElementCount));
+    }
+    EXPECT_EQ(queue.Count(), ElementCount);
+
+    for(std::size_t index = 0; index < ElementCount; ++index) {
+      std::size_t element = ElementCount;
+      ASSERT_TRUE(queue.TryTakeMin(element));
+      EXPECT_EQ(element, index);
+    }
+
+    std::size_t element = 0;
+    EXPECT_FALSE(queue.TryTakeMin(element));
+    EXPECT_TRUE(queue.IsEmpty());
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ConcurrentPriorityQueueTest, EqualElementsAreAllKept) {
+    ConcurrentPriorityQueue<int> queue;
+    for(std::size_t index = 0; index < 100; ++index) {
+      queue.TryAppend(static_cast<int>(index % 3));
+    }
+
+    int previous = 0;
+    for(std::size_t index = 0; index < 100; ++index) {
+      int element = -1;
+      ASSERT_TRUE(queue.TryTakeMin(element));
+      EXPECT_GE(element, previous);
+      previous = element;
+    }
+    EXPECT_TRUE(queue.IsEmpty());
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ConcurrentPriorityQueueTest, ComparisonCanBeCustomized) {
+    ConcurrentPriorityQueue<int, std::greater<int>> queue;
+    queue.TryAppend(1);
+    queue.TryAppend(3);
+    queue.TryAppend(2);
+
+    int element = 0;
+    EXPECT_TRUE(queue.TryTakeMin(element));
+    EXPECT_EQ(element, 3);
+    EXPECT_TRUE(queue.TryTakeMin(element));
+    EXPECT_EQ(element, 2);
+    EXPECT_TRUE(queue.TryTakeMin(element));
+    EXPECT_EQ(element, 1);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ConcurrentPriorityQueueTest, RemainingElementsAreDestroyed) {
+    std::vector<std::shared_ptr<TestItemStats>> stats = makeStats(1);
+    {
+      TestItem item(stats[0]);
+      TestItem taken(stats[0]);
+      ConcurrentPriorityQueue<TestItem, UnorderedTestItems> queue;
+      for(std::size_t index = 0; index < 100; ++index) {
+        queue.TryAppend(item);
+      }
+      for(std::size_t index = 0; index < 40; ++index) {
+        EXPECT_TRUE(queue.TryTakeMin(taken));
+      }
+    }
+
+    // Taken elements are assigned, not constructed. Everything constructed as a copy
+    // has to be destroyed, plus the two items created by the test.
+    EXPECT_EQ(stats[0]->OverwriteCount, 40);
+    EXPECT_EQ(stats[0]->DestroyCount, stats[0]->CopyCount - stats[0]->OverwriteCount + 2);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ConcurrentPriorityQueueTest, ThrowingCopyLeavesElementInQueue) {
+    std::vector<std::shared_ptr<TestItemStats>> stats = makeStats(2);
+    std::vector<TestItem> items;
+    makeItems(items, stats);
+
+    ConcurrentPriorityQueue<TestItem, UnorderedTestItems> queue;
+    EXPECT_TRUE(queue.TryAppend(items[0]));
+
+    stats[0]->ThrowOnCopy = true;
+    EXPECT_THROW(queue.TryTakeMin(items[1]), std::runtime_error);
+    EXPECT_EQ(queue.Count(), 1U);
+
+    stats[0]->ThrowOnCopy = false;
+    EXPECT_TRUE(queue.TryTakeMin(items[1]));
+    EXPECT_TRUE(queue.IsEmpty());
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ConcurrentPriorityQueueTest, ConcurrentlyAppendedElementsAreTakenInOrder) {
+    const std::size_t ElementsPerThread = 10000;
+    const std::size_t ThreadCount = 4;
+    ConcurrentPriorityQueue<std::size_t> queue;
+
+    std::vector<std::thread> threads;
+    for(std::size_t index = 0; index < ThreadCount; ++index) {
+      threads.emplace_back(
+        [&queue, index, ElementsPerThread, ThreadCount]() {
+          for(std::size_t counter = 0; counter < ElementsPerThread; ++counter) {
+            queue.TryAppend(counter * ThreadCount + index);
+          }
+        }
+      );
+    }
+    for(std::size_t index = 0; index < threads.size(); ++index) {
+      threads[index].join();
+    }
+
+    for(std::size_t index = 0; index < ElementsPerThread * ThreadCount; ++index) {
+      std::size_t element = 0;
+      ASSERT_TRUE(queue.TryTakeMin(element));
+      EXPECT_EQ(element, index);
+    }
+    EXPECT_TRUE(queue.IsEmpty());
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ConcurrentPriorityQueueTest, TransfersAllElementsBetweenThreads) {
+    const std::size_t ElementsPerProducer = 20000;
+    const std::size_t ThreadCount = 4;
+    ConcurrentPriorityQueue<std::size_t> queue;
+
+    std::atomic<std::size_t> takenCount(0);
+    std::atomic<std::size_t> takenSum(0);
+
+    std::vector<std::thread> threads;
+    for(std::size_t index = 0; index < ThreadCount; ++index) {
+      threads.emplace_back(
+        [&queue, index, ElementsPerProducer]() {
+          std::size_t first = index * ElementsPerProducer;
+          for(std::size_t element = first; element < first + ElementsPerProducer; ++element) {
+            queue.TryAppend(element);
+          }
+        }
+      );
+      threads.emplace_back(
+        [&queue, &takenCount, &takenSum, ElementsPerProducer, ThreadCount]() {
+          std::size_t element;
+          while(takenCount.load(std::memory_order_relaxed) < ElementsPerProducer * ThreadCount) {
+            if(queue.TryTakeMin(element)) {
+              takenSum.fetch_add(element, std::memory_order_relaxed);
+              takenCount.fetch_add(1, std::memory_order_relaxed);
+            } else {
+              std::this_thread::yield();
+            }
+          }
+        }
+      );
+    }
+
+    for(std::size_t index = 0; index < threads.size(); ++index) {
+      threads[index].join();
+    }
+
+    const std::size_t totalCount = ElementsPerProducer * ThreadCount;
+    EXPECT_EQ(takenCount.load(), totalCount);
+    EXPECT_EQ(takenSum.load(), totalCount * (totalCount - 1) / 2);
+    EXPECT_TRUE(queue.IsEmpty());
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Collections
@@ -0,0 +1,422 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the library is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_SUPPORT_SOURCE 1
+
+#include "Nuclex/Support/Collections/ConcurrentRingBuffer.h"
+#include "BufferTest.h"
+#include "ConcurrentBufferTest.h"
+
+#include <gtest/gtest.h>
+
+#include <thread> // for std::thread
+#include <vector> // for std::vector
+#include <stdexcept> // for std::runtime_error
+
+namespace {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Ring buffer for one producer and one consumer</summary>
+  template<typename TElement>
+  using SpscRingBuffer = Nuclex::Support::Collections::ConcurrentRingBuffer<
+    TElement, Nuclex::Support::Collections::ConcurrentAccessBehavior::SingleProducerSingleConsumer
+  >;
+
+  /// <summary>Ring buffer for multiple producers and one consumer</summary>
+  template<typename TElement>
+  using MpscRingBuffer = Nuclex::Support::Collections::ConcurrentRingBuffer<
+    TElement,
+    Nuclex::Support::Collections::ConcurrentAccessBehavior::MultipleProducersSingleConsumer
+  >;
+
+  /// <summary>Ring buffer for multiple producers and multiple consumers</summary>
+  template<typename TElement>
+  using MpmcRingBuffer = Nuclex::Support::Collections::ConcurrentRingBuffer<
+    TElement,
+    Nuclex::Support::Collections::ConcurrentAccessBehavior::MultipleProducersMultipleConsumers
+  >;
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Checks that elements come out of the buffer in the order they went in</summary>
+  template<template<typename TElement> class TRingBuffer>
+  void checkElementsAreTakenInOrder() {
+    TRingBuffer<int> buffer(8);
+    EXPECT_TRUE(buffer.TryAppend(0));
+    for(int index = 0; index < 20; ++index) { // wraps around several times
+      EXPECT_TRUE(buffer.TryAppend(index * 2 + 1));
+      EXPECT_TRUE(buffer.TryAppend(index * 2 + 2));
+
+      int element = -1;
+      EXPECT_TRUE(buffer.TryTake(element));
+      EXPECT_EQ(element, index * 2);
+      EXPECT_TRUE(buffer.TryTake(element));
+      EXPECT_EQ(element, index * 2 + 1);
+    }
+
+    EXPECT_EQ(buffer.Count(), 1U);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Checks that the buffer refuses elements when full and empty</summary>
+  template<template<typename TElement> class TRingBuffer>
+  void checkCapacityIsEnforced() {
+    TRingBuffer<int> buffer(5);
+    EXPECT_EQ(buffer.GetCapacity(), 8U);
+    EXPECT_TRUE(buffer.IsEmpty());
+
+    int element = 0;
+    EXPECT_FALSE(buffer.TryTake(element));
+
+    for(int index = 0; index < 8; ++index) {
+      EXPECT_TRUE(buffer.TryAppend(index));
+    }
+    EXPECT_FALSE(buffer.TryAppend(8));
+    EXPECT_EQ(buffer.Count(), 8U);
+
+    EXPECT_TRUE(buffer.TryTake(element));
+    EXPECT_EQ(element, 0);
+    EXPECT_TRUE(buffer.TryAppend(8));
+    EXPECT_FALSE(buffer.TryAppend(9));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Checks that tiny capacities still result in a working buffer</summary>
+  template<template<typename TElement> class TRingBuffer>
+  void checkCapacityOfOneIsEnforced() {
+    for(std::size_t capacity = 0; capacity < 2; ++capacity) {
+      TRingBuffer<int> buffer(capacity);
+      EXPECT_EQ(buffer.GetCapacity(), 2U);
+
+      EXPECT_TRUE(buffer.TryAppend(1));
+      EXPECT_TRUE(buffer.TryAppend(2));
+      EXPECT_FALSE(buffer.TryAppend(3));
+      EXPECT_EQ(buffer.Count(), 2U);
+
+      int element = 0;
+      EXPECT_TRUE(buffer.TryTake(element));
+      EXPECT_EQ(element, 1);
+      EXPECT_TRUE(buffer.TryAppend(3));
+      EXPECT_TRUE(buffer.TryTake(element));
+      EXPECT_EQ(element, 2);
+      EXPECT_TRUE(buffer.TryTake(element));
+      EXPECT_EQ(element, 3);
+      EXPECT_FALSE(buffer.TryTake(element));
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Checks that batch operations transfer as many elements as possible</summary>
+  template<template<typename TElement> class TRingBuffer>
+  void checkBatchOperationsArePartial() {
+    TRingBuffer<int> buffer(16);
+
+    int elements[20];
+    for(int index = 0; index < 20; ++index) {
+      elements[index] = index;
+    }
+
+    EXPECT_EQ(buffer.TryAppend(elements, 10), 10U);
+    EXPECT_EQ(buffer.TryAppend(elements + 10, 10), 6U);
+    EXPECT_EQ(buffer.TryAppend(elements, 1), 0U);
+
+    int taken[20] = { 0 };
+    EXPECT_EQ(buffer.TryTake(taken, 4), 4U);
+    EXPECT_EQ(buffer.TryTake(taken + 4, 20), 12U);
+    EXPECT_EQ(buffer.TryTake(taken, 1), 0U);
+
+    for(int index = 0; index < 16; ++index) {
+      EXPECT_EQ(taken[index], index);
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Checks that elements left in the buffer are destroyed with it</summary>
+  template<template<typename TElement> class TRingBuffer>
+  void checkRemainingElementsAreDestroyed() {
+    std::vector<std::shared_ptr<TestItemStats>> stats = makeStats(3);
+    {
+      std::vector<TestItem> items;
+      makeItems(items, stats);
+
+      TRingBuffer<TestItem> buffer(4);
+      EXPECT_EQ(buffer.TryAppend(items.data(), 3), 3U);
+    }
+
+    for(std::size_t index = 0; index < 3; ++index) {
+      EXPECT_EQ(stats[index]->CopyCount, 1);
+      EXPECT_EQ(stats[index]->DestroyCount, 2); // original item and copy in the buffer
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Checks that an element whose copy constructor throws isn't appended</summary>
+  template<template<typename TElement> class TRingBuffer>
+  void checkThrowingCopyDoesNotCorruptBuffer() {
+    std::vector<std::shared_ptr<TestItemStats>> stats = makeStats(3);
+    std::vector<TestItem> items;
+    makeItems(items, stats);
+
+    TRingBuffer<TestItem> buffer(8);
+    EXPECT_TRUE(buffer.TryAppend(items[0]));
+
+    stats[1]->ThrowOnCopy = true;
+    EXPECT_THROW(buffer.TryAppend(items.data() + 1, 2), std::runtime_error);
+    stats[1]->ThrowOnCopy = false;
+
+    EXPECT_TRUE(buffer.TryAppend(items[2]));
+
+    // The element that failed to copy must not be handed out. For the SPSC buffer, the
+    // element after it wasn't appended either, for the others, its slot is skipped.
+    TestItem taken(stats[0]);
+    EXPECT_TRUE(buffer.TryTake(taken));
+    EXPECT_TRUE(buffer.TryTake(taken));
+    EXPECT_EQ(stats[1]->DestroyCount, 0);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Appends a range of numbers to a buffer, retrying when it is full</summary>
+  /// <param name="buffer">Buffer to which the numbers will be appended</param>
+  /// <param name="first">First number that will be appended</param>
+  /// <param name="count">Number of numbers that will be appended</param>
+  template<typename TRingBuffer>
+  void appendRange(TRingBuffer &buffer, std::size_t first, std::size_t count) {
+    std::size_t batch[7];
+    std::size_t end = first + count;
+    while(first < end) {
+      if(first % 3 == 0) {
+        if(buffer.TryAppend(first)) {
+          ++first;
+        } else {
+          std::this_thread::yield();
+        }
+      } else {
+        std::size_t batchSize = std::min<std::size_t>(7, end - first);
+        for(std::size_t index = 0; index < batchSize; ++index) {
+          batch[index] = first + index;
+        }
+        std::size_t appendedCount = buffer.TryAppend(batch, batchSize);
+        if(appendedCount == 0) {
+          std::this_thread::yield();
+        }
+        first += appendedCount;
+      }
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // anonymous namespace
+
+namespace Nuclex { namespace Support { namespace Collections {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ConcurrentRingBufferTest, ElementsAreTakenInOrder) {
+    checkElementsAreTakenInOrder<SpscRingBuffer>();
+    checkElementsAreTakenInOrder<MpscRingBuffer>();
+    checkElementsAreTakenInOrder<MpmcRingBuffer>();
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ConcurrentRingBufferTest, CapacityIsEnforced) {
+    checkCapacityIsEnforced<SpscRingBuffer>();
+    checkCapacityIsEnforced<MpscRingBuffer>();
+    checkCapacityIsEnforced<MpmcRingBuffer>();
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ConcurrentRingBufferTest, CapacityOfOneIsEnforced) {
+    checkCapacityOfOneIsEnforced<SpscRingBuffer>();
+    checkCapacityOfOneIsEnforced<MpscRingBuffer>();
+    checkCapacityOfOneIsEnforced<MpmcRingBuffer>();
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ConcurrentRingBufferTest, BatchOperationsArePartial) {
+    checkBatchOperationsArePartial<SpscRingBuffer>();
+    checkBatchOperationsArePartial<MpscRingBuffer>();
+    checkBatchOperationsArePartial<MpmcRingBuffer>();
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ConcurrentRingBufferTest, RemainingElementsAreDestroyed) {
+    checkRemainingElementsAreDestroyed<SpscRingBuffer>();
+    checkRemainingElementsAreDestroyed<MpscRingBuffer>();
+    checkRemainingElementsAreDestroyed<MpmcRingBuffer>();
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ConcurrentRingBufferTest, ThrowingCopyDoesNotCorruptBuffer) {
+    checkThrowingCopyDoesNotCorruptBuffer<SpscRingBuffer>();
+    checkThrowingCopyDoesNotCorruptBuffer<MpscRingBuffer>();
+    checkThrowingCopyDoesNotCorruptBuffer<MpmcRingBuffer>();
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ConcurrentRingBufferTest, SpscBufferTransfersAllElementsBetweenThreads) {
+    const std::size_t ElementCount = 100000;
+    SpscRingBuffer<std::size_t> buffer(64);
+
+    std::thread producer(
+      [&buffer, ElementCount]() { appendRange(buffer, 0, ElementCount); }
+    );
+
+    std::size_t expected = 0;
+    std::size_t taken[16];
+    while(expected < ElementCount) {
+      std::size_t takenCount = buffer.TryTake(taken, 16);
+      for(std::size_t index = 0; index < takenCount; ++index) {
+        EXPECT_EQ(taken[index], expected);
+        ++expected;
+      }
+      if(takenCount == 0) {
+        std::this_thread::yield();
+      }
+    }
+
+    producer.join();
+    EXPECT_TRUE(buffer.IsEmpty());
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ConcurrentRingBufferTest, MpscBufferTransfersAllElementsBetweenThreads) {
+    const std::size_t ElementsPerProducer = 25000;
+    const std::size_t ProducerCount = 4;
+    MpscRingBuffer<std::size_t> buffer(64);
+
+    std::vector<std::thread> producers;
+    for(std::size_t index = 0; index < ProducerCount; ++index) {
+      producers.emplace_back(
+        [&buffer, index, ElementsPerProducer]() {
+          appendRange(buffer, index * ElementsPerProducer, ElementsPerProducer);
+        }
+      );
+    }
+
+    // Elements of each producer must arrive in the order the producer appended them
+    std::vector<std::size_t> nextExpected(ProducerCount);
+    for(std::size_t index = 0; index < ProducerCount; ++index) {
+      nextExpected[index] = index * ElementsPerProducer;
+    }
+
+    std::size_t takenCount = 0;
+    while(takenCount < ElementsPerProducer * ProducerCount) {
+      std::size_t element;
+      if(buffer.TryTake(element)) {
+        std::size_t producerIndex = element / ElementsPerProducer;
+        EXPECT_EQ(element, nextExpected[producerIndex]);
+        nextExpected[producerIndex] = element + 1;
+        ++takenCount;
+      } else {
+        std::this_thread::yield();
+      }
+    }
+
+    for(std::size_t index = 0; index < ProducerCount; ++index) {
+      producers[index].join();
+    }
+    EXPECT_TRUE(buffer.IsEmpty());
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ConcurrentRingBufferTest, MpmcBufferTransfersAllElementsBetweenThreads) {
+    const std::size_t ElementsPerProducer = 25000;
+    const std::size_t ThreadCount = 4;
+    MpmcRingBuffer<std::size_t> buffer(64);
+
+    std::atomic<std::size_t> takenCount(0);
+    std::atomic<std::size_t> takenSum(0);
+
+    std::vector<std::thread> threads;
+    for(std::size_t index = 0; index < ThreadCount; ++index) {
+      threads.emplace_back(
+        [&buffer, index, ElementsPerProducer]() {
+          appendRange(buffer, index * ElementsPerProducer, ElementsPerProducer);
+        }
+      );
+      threads.emplace_back(
+        [&buffer, &takenCount, &takenSum, ElementsPerProducer, ThreadCount]() {
+          std::size_t taken[5];
+          while(takenCount.load(std::memory_order_relaxed) < ElementsPerProducer * ThreadCount) {
+            std::size_t count = buffer.TryTake(taken, 5);
+            for(std::size_t index = 0; index < count; ++index) {
+              takenSum.fetch_add(taken[index], std::memory_order_relaxed);
+            }
+            if(count == 0) {
+              std::this_thread::yield();
+            } else {
+              takenCount.fetch_add(count, std::memory_order_relaxed);
+            }
+          }
+        }
+      );
+    }
+
+    for(std::size_t index = 0; index < threads.size(); ++index) {
+      threads[index].join();
+    }
+
+    const std::size_t totalCount = ElementsPerProducer * ThreadCount;
+    EXPECT_EQ(takenCount.load(), totalCount);
+    EXPECT_EQ(takenSum.load(), totalCount * (totalCount - 1) / 2);
+    EXPECT_TRUE(buffer.IsEmpty());
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ConcurrentRingBufferTest, BenchmarkSpscBuffer) {
+    benchmarkSingleItemAppends<SpscRingBuffer>(1);
+    benchmarkSingleItemTakes<SpscRingBuffer>(1);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ConcurrentRingBufferTest, BenchmarkMpscBuffer) {
+    benchmarkSingleItemAppends<MpscRingBuffer>();
+    benchmarkSingleItemTakes<MpscRingBuffer>(1);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ConcurrentRingBufferTest, BenchmarkMpmcBuffer) {
+    benchmarkSingleItemAppends<MpmcRingBuffer>();
+    benchmarkSingleItemTakes<MpmcRingBuffer>();
+    benchmarkSingleItemMixed<MpmcRingBuffer>();
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Collections
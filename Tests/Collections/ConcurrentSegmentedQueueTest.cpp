@@ -0,0 +1,195 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the library is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_SUPPORT_SOURCE 1
+
+#include "Nuclex/Support/Collections/ConcurrentSegmentedQueue.h"
+#include "BufferTest.h"
+#include "ConcurrentBufferTest.h"
+
+#include <gtest/gtest.h>
+
+#include <thread> // for std::thread
+#include <vector> // for std::vector
+#include <stdexcept> // for std::runtime_error
+
+namespace {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Segmented queue with a constructor that fits the benchmark harness</summary>
+  /// <typeparam name="TElement">Type of elements that will be stored in the queue</typeparam>
+  template<typename TElement>
+  class BenchmarkedSegmentedQueue :
+    public Nuclex::Support::Collections::ConcurrentSegmentedQueue<TElement> {
+
+    /// <summary>Initializes a new segmented queue, ignoring the requested capacity</summary>
+    public: BenchmarkedSegmentedQueue(std::size_t) {}
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // anonymous namespace
+
+namespace Nuclex { namespace Support { namespace Collections {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ConcurrentSegmentedQueueTest, InstancesCanBeCreated) {
+    EXPECT_NO_THROW(
+      ConcurrentSegmentedQueue<int> queue;
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ConcurrentSegmentedQueueTest, NewInstanceIsEmpty) {
+    ConcurrentSegmentedQueue<int> queue;
+    EXPECT_TRUE(queue.IsEmpty());
+    EXPECT_EQ(queue.Count(), 0U);
+
+    int element = 0;
+    EXPECT_FALSE(queue.TryTake(element));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ConcurrentSegmentedQueueTest, ElementsAreTakenInOrderAcrossSegments) {
+    typedef ConcurrentSegmentedQueue<std::size_t> QueueType;
+    const std::size_t ElementCount = QueueType::SegmentSize * 5 + 3;
+
+    QueueType queue;
+    for(std::size_t index = 0; index < ElementCount; ++index) {
+      EXPECT_TRUE(queue.TryAppend(index));
+    }
+    EXPECT_EQ(queue.Count(), ElementCount);
+
+    for(std::size_t index = 0; index < ElementCount; ++index) {
+      std::size_t element = 0;
+      ASSERT_TRUE(queue.TryTake(element));
+      EXPECT_EQ(element, index);
+    }
+
+    std::size_t element = 0;
+    EXPECT_FALSE(queue.TryTake(element));
+    EXPECT_TRUE(queue.IsEmpty());
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ConcurrentSegmentedQueueTest, RemainingElementsAreDestroyed) {
+    typedef ConcurrentSegmentedQueue<TestItem> QueueType;
+
+    std::vector<std::shared_ptr<TestItemStats>> stats = makeStats(1);
+    {
+      TestItem item(stats[0]);
+      QueueType queue;
+      for(std::size_t index = 0; index < QueueType::SegmentSize * 2; ++index) {
+        queue.TryAppend(item);
+      }
+      for(std::size_t index = 0; index < QueueType::SegmentSize + 10; ++index) {
+        TestItem taken(stats[0]);
+        EXPECT_TRUE(queue.TryTake(taken));
+      }
+    }
+
+    // Every copy placed in the queue must have been destroyed exactly once. The items
+    // created for taking elements out add one destruction each, the original one more.
+    const int copyCount = static_cast<int>(ConcurrentSegmentedQueue<TestItem>::SegmentSize * 2);
+    const int takeCount = static_cast<int>(ConcurrentSegmentedQueue<TestItem>::SegmentSize + 10);
+    EXPECT_EQ(stats[0]->CopyCount, copyCount);
+    EXPECT_EQ(stats[0]->DestroyCount, copyCount + takeCount + 1);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ConcurrentSegmentedQueueTest, ThrowingCopyDoesNotAppendElement) {
+    std::vector<std::shared_ptr<TestItemStats>> stats = makeStats(2);
+    std::vector<TestItem> items;
+    makeItems(items, stats);
+
+    ConcurrentSegmentedQueue<TestItem> queue;
+    stats[0]->ThrowOnCopy = true;
+    EXPECT_THROW(queue.TryAppend(items[0]), std::runtime_error);
+    EXPECT_TRUE(queue.TryAppend(items[1]));
+
+    TestItem taken(stats[0]);
+    EXPECT_TRUE(queue.TryTake(taken));
+    EXPECT_EQ(stats[1]->CopyCount, 1);
+    EXPECT_FALSE(queue.TryTake(taken));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ConcurrentSegmentedQueueTest, TransfersAllElementsBetweenThreads) {
+    const std::size_t ElementsPerProducer = 50000;
+    const std::size_t ThreadCount = 4;
+    ConcurrentSegmentedQueue<std::size_t> queue;
+
+    std::atomic<std::size_t> takenCount(0);
+    std::atomic<std::size_t> takenSum(0);
+
+    std::vector<std::thread> threads;
+    for(std::size_t index = 0; index < ThreadCount; ++index) {
+      threads.emplace_back(
+        [&queue, index, ElementsPerProducer]() {
+          std::size_t first = index * ElementsPerProducer;
+          for(std::size_t element = first; element < first + ElementsPerProducer; ++element) {
+            queue.TryAppend(element);
+          }
+        }
+      );
+      threads.emplace_back(
+        [&queue, &takenCount, &takenSum, ElementsPerProducer, ThreadCount]() {
+          std::size_t element;
+          while(takenCount.load(std::memory_order_relaxed) < ElementsPerProducer * ThreadCount) {
+            if(queue.TryTake(element)) {
+              takenSum.fetch_add(element, std::memory_order_relaxed);
+              takenCount.fetch_add(1, std::memory_order_relaxed);
+            } else {
+              std::this_thread::yield();
+            }
+          }
+        }
+      );
+    }
+
+    for(std::size_t index = 0; index < threads.size(); ++index) {
+      threads[index].join();
+    }
+
+    const std::size_t totalCount = ElementsPerProducer * ThreadCount;
+    EXPECT_EQ(takenCount.load(), totalCount);
+    EXPECT_EQ(takenSum.load(), totalCount * (totalCount - 1) / 2);
+    EXPECT_TRUE(queue.IsEmpty());
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ConcurrentSegmentedQueueTest, BenchmarkSegmentedQueue) {
+    benchmarkSingleItemAppends<BenchmarkedSegmentedQueue>();
+    benchmarkSingleItemTakes<BenchmarkedSegmentedQueue>();
+    benchmarkSingleItemMixed<BenchmarkedSegmentedQueue>();
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Collections
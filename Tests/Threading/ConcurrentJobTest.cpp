@@ -25,6 +25,7 @@ limitations under the License.
 #if defined(NUCLEX_SUPPORT_WINDOWS) || defined(NUCLEX_SUPPORT_LINUX)
 
 #include "Nuclex/Support/Threading/Latch.h"
+#include "Nuclex/Support/Threading/Gate.h"
 #include "Nuclex/Support/Threading/StopToken.h"
 #include "Nuclex/Support/Threading/ThreadPool.h"
 
@@ -241,6 +242,50 @@ namespace Nuclex { namespace Support { namespace Threading {
 
   // ------------------------------------------------------------------------------------------- //
 
+  TEST(ConcurrentJobTest, JobsOnThreadPoolCanBeRestarted) {
+    ThreadPool threadPool(1, 2);
+    {
+      ExampleJob test(threadPool);
+      test.WaitLatch.Post(); // lock the latch
+
+      test.StartOrRestart();
+      bool wasRunning = test.RunLatch.WaitFor(std::chrono::microseconds(25000));
+      test.StartOrRestart();
+      test.WaitLatch.CountDown();
+      test.Join();
+
+      EXPECT_TRUE(wasRunning);
+      EXPECT_EQ(test.RunCount.load(std::memory_order::memory_order_acquire), 2U);
+      EXPECT_TRUE(test.WasCanceled.load(std::memory_order::memory_order_acquire));
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ConcurrentJobTest, RestartsOnThreadPoolAreCoalesced) {
+    ThreadPool threadPool(1, 1);
+
+    // Keep the only worker thread busy so the job stays queued
+    Gate startedGate, releaseGate;
+    threadPool.Post([&startedGate, &releaseGate] { startedGate.Open(); releaseGate.Wait(); });
+    startedGate.Wait();
+    {
+      ExampleJob test(threadPool);
+      for(std::size_t index = 0; index < 100; ++index) {
+        test.StartOrRestart();
+      }
+      EXPECT_TRUE(test.IsRunning());
+
+      releaseGate.Open();
+      test.Join();
+
+      EXPECT_EQ(test.RunCount.load(std::memory_order::memory_order_acquire), 1U);
+      EXPECT_FALSE(test.WasCanceled.load(std::memory_order::memory_order_acquire));
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
 }}} // namespace Nuclex::Support::Threading
 
 #endif // defined(NUCLEX_SUPPORT_WINDOWS) || defined(NUCLEX_SUPPORT_LINUX)
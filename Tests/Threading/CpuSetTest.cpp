@@ -0,0 +1,201 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the library is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_SUPPORT_SOURCE 1
+
+#include "Nuclex/Support/Threading/CpuSet.h"
+
+#include <stdexcept> // for std::invalid_argument
+
+#include <gtest/gtest.h>
+
+namespace Nuclex { namespace Support { namespace Threading {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(CpuSetTest, HasDefaultConstructor) {
+    EXPECT_NO_THROW(
+      CpuSet cpus;
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(CpuSetTest, NewSetIsEmpty) {
+    CpuSet cpus;
+    EXPECT_TRUE(cpus.IsEmpty());
+    EXPECT_EQ(cpus.Count(), 0U);
+    EXPECT_EQ(cpus.GetUpperBound(), 0U);
+    EXPECT_FALSE(cpus.Contains(0));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(CpuSetTest, CpusCanBeAddedAndRemoved) {
+    CpuSet cpus;
+    cpus.Add(3);
+    cpus.Add(5);
+
+    EXPECT_FALSE(cpus.IsEmpty());
+    EXPECT_EQ(cpus.Count(), 2U);
+    EXPECT_TRUE(cpus.Contains(3));
+    EXPECT_TRUE(cpus.Contains(5));
+    EXPECT_FALSE(cpus.Contains(4));
+
+    cpus.Remove(3);
+    EXPECT_EQ(cpus.Count(), 1U);
+    EXPECT_FALSE(cpus.Contains(3));
+
+    cpus.Remove(5);
+    EXPECT_TRUE(cpus.IsEmpty());
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(CpuSetTest, CanHoldMoreThan64Cpus) {
+    CpuSet cpus;
+    cpus.Add(1);
+    cpus.Add(64);
+    cpus.Add(127);
+    cpus.Add(200);
+
+    EXPECT_EQ(cpus.Count(), 4U);
+    EXPECT_TRUE(cpus.Contains(64));
+    EXPECT_TRUE(cpus.Contains(127));
+    EXPECT_TRUE(cpus.Contains(200));
+    EXPECT_FALSE(cpus.Contains(128));
+    EXPECT_EQ(cpus.GetUpperBound(), 201U);
+
+    std::vector<std::size_t> indices = cpus.GetIndices();
+    ASSERT_EQ(indices.size(), 4U);
+    EXPECT_EQ(indices[0], 1U);
+    EXPECT_EQ(indices[1], 64U);
+    EXPECT_EQ(indices[2], 127U);
+    EXPECT_EQ(indices[3], 200U);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(CpuSetTest, RemovingHighestCpuShrinksUpperBound) {
+    CpuSet cpus;
+    cpus.Add(2);
+    cpus.Add(130);
+    cpus.Remove(130);
+
+    EXPECT_EQ(cpus.GetUpperBound(), 3U);
+
+    CpuSet other;
+    other.Add(2);
+    EXPECT_EQ(cpus, other);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(CpuSetTest, CanBeConvertedFromAndToMask) {
+    CpuSet cpus = CpuSet::FromMask(0x8000000000000005ULL);
+    EXPECT_EQ(cpus.Count(), 3U);
+    EXPECT_TRUE(cpus.Contains(0));
+    EXPECT_TRUE(cpus.Contains(2));
+    EXPECT_TRUE(cpus.Contains(63));
+    EXPECT_EQ(cpus.ToMask(), 0x8000000000000005ULL);
+
+    // CPUs beyond the first 64 cannot be represented in a mask
+    cpus.Add(64);
+    EXPECT_EQ(cpus.ToMask(), 0x8000000000000005ULL);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(CpuSetTest, CanParseLinuxCpuLists) {
+    CpuSet cpus = CpuSet::Parse(u8"0-3,8,62-65\n");
+
+    std::vector<std::size_t> indices = cpus.GetIndices();
+    ASSERT_EQ(indices.size(), 9U);
+    EXPECT_EQ(indices[0], 0U);
+    EXPECT_EQ(indices[3], 3U);
+    EXPECT_EQ(indices[4], 8U);
+    EXPECT_EQ(indices[5], 62U);
+    EXPECT_EQ(indices[8], 65U);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(CpuSetTest, EmptyCpuListYieldsEmptySet) {
+    EXPECT_TRUE(CpuSet::Parse(std::string()).IsEmpty());
+    EXPECT_TRUE(CpuSet::Parse(u8"\n").IsEmpty());
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(CpuSetTest, ParsingInvalidCpuListThrows) {
+    EXPECT_THROW(CpuSet::Parse(u8"0-"), std::invalid_argument);
+    EXPECT_THROW(CpuSet::Parse(u8"3-1"), std::invalid_argument);
+    EXPECT_THROW(CpuSet::Parse(u8"1,,2"), std::invalid_argument);
+    EXPECT_THROW(CpuSet::Parse(u8"abc"), std::invalid_argument);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(CpuSetTest, ParsingOutOfRangeCpuIndexThrows) {
+    EXPECT_THROW(CpuSet::Parse(u8"0-4294967295"), std::invalid_argument);
+    EXPECT_THROW(CpuSet::Parse(u8"99999999999999999999999"), std::invalid_argument);
+    EXPECT_THROW(CpuSet::Parse(u8"8192"), std::invalid_argument);
+
+    CpuSet cpus = CpuSet::Parse(u8"8191");
+    EXPECT_EQ(cpus.Count(), 1U);
+    EXPECT_EQ(cpus.GetUpperBound(), 8192U);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(CpuSetTest, CanBeFormattedAsCpuList) {
+    CpuSet cpus;
+    EXPECT_EQ(cpus.ToString(), std::string());
+
+    cpus.Add(0);
+    cpus.Add(1);
+    cpus.Add(2);
+    cpus.Add(5);
+    cpus.Add(63);
+    cpus.Add(64);
+    EXPECT_EQ(cpus.ToString(), std::string(u8"0-2,5,63-64"));
+
+    EXPECT_EQ(CpuSet::Parse(cpus.ToString()), cpus);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(CpuSetTest, SupportsUnionAndIntersection) {
+    CpuSet first = CpuSet::Parse(u8"0-3,100");
+    CpuSet second = CpuSet::Parse(u8"2-5");
+
+    EXPECT_EQ(first | second, CpuSet::Parse(u8"0-5,100"));
+    EXPECT_EQ(first & second, CpuSet::Parse(u8"2-3"));
+    EXPECT_EQ(second & first, CpuSet::Parse(u8"2-3"));
+    EXPECT_NE(first, second);
+
+    // Intersecting with a set holding only low CPUs must drop the high ones
+    first &= second;
+    EXPECT_EQ(first.GetUpperBound(), 4U);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Threading
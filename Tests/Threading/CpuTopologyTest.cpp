@@ -0,0 +1,85 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the library is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_SUPPORT_SOURCE 1
+
+#include "Nuclex/Support/Threading/CpuTopology.h"
+
+#include <gtest/gtest.h>
+
+namespace Nuclex { namespace Support { namespace Threading {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(CpuTopologyTest, ReportsOnlineCpus) {
+    CpuTopology topology = CpuTopology::Query();
+    EXPECT_FALSE(topology.GetOnlineCpus().IsEmpty());
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(CpuTopologyTest, NumaNodesCoverAllOnlineCpus) {
+    CpuTopology topology = CpuTopology::Query();
+    ASSERT_GE(topology.CountNumaNodes(), 1U);
+
+    CpuSet allNodeCpus;
+    for(std::size_t index = 0; index < topology.CountNumaNodes(); ++index) {
+      const CpuSet &nodeCpus = topology.GetNumaNodeCpus(index);
+      EXPECT_FALSE(nodeCpus.IsEmpty());
+
+      // No CPU may belong to two NUMA nodes
+      EXPECT_TRUE((allNodeCpus & nodeCpus).IsEmpty());
+      allNodeCpus |= nodeCpus;
+    }
+
+    EXPECT_EQ(allNodeCpus, topology.GetOnlineCpus());
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(CpuTopologyTest, CpusMapToTheirNumaNode) {
+    CpuTopology topology = CpuTopology::Query();
+
+    std::vector<std::size_t> cpuIndices = topology.GetOnlineCpus().GetIndices();
+    for(std::size_t index = 0; index < cpuIndices.size(); ++index) {
+      std::size_t nodeIndex = topology.GetNumaNodeOfCpu(cpuIndices[index]);
+      ASSERT_LT(nodeIndex, topology.CountNumaNodes());
+      EXPECT_TRUE(topology.GetNumaNodeCpus(nodeIndex).Contains(cpuIndices[index]));
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(CpuTopologyTest, PhysicalCoreCountIsPlausible) {
+    CpuTopology topology = CpuTopology::Query();
+    EXPECT_GE(topology.CountPhysicalCores(), 1U);
+    EXPECT_LE(topology.CountPhysicalCores(), topology.GetOnlineCpus().Count());
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(CpuTopologyTest, CurrentCpuIsOnline) {
+    CpuTopology topology = CpuTopology::Query();
+    EXPECT_TRUE(topology.GetOnlineCpus().Contains(CpuTopology::GetCurrentCpuIndex()));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Threading
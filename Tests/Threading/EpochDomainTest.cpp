@@ -0,0 +1,193 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the library is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_SUPPORT_SOURCE 1
+
+#include "Nuclex/Support/Threading/EpochDomain.h"
+
+#include <atomic> // for std::atomic
+#include <thread> // for std::thread
+#include <vector> // for std::vector
+
+#include <gtest/gtest.h>
+
+namespace {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Node that counts how many of its instances have been destroyed</summary>
+  struct CountedNode {
+
+    /// <summary>Initializes a new counted node</summary>
+    /// <param name="value">Value that will be stored in the node</param>
+    /// <param name="destroyedCount">Counter that will be incremented on destruction</param>
+    public: CountedNode(std::size_t value, std::atomic<std::size_t> &destroyedCount) :
+      Value(value),
+      DestroyedCount(destroyedCount) {}
+
+    /// <summary>Overwrites the value and increments the destruction counter</summary>
+    public: ~CountedNode() {
+      this->Value = 0xDEADBEEF;
+      this->DestroyedCount.fetch_add(1);
+    }
+
+    /// <summary>Value stored in the node</summary>
+    public: std::size_t Value;
+    /// <summary>Counter that will be incremented when the node is destroyed</summary>
+    public: std::atomic<std::size_t> &DestroyedCount;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // anonymous namespace
+
+namespace Nuclex { namespace Support { namespace Threading {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(EpochDomainTest, InstancesCanBeCreated) {
+    EXPECT_NO_THROW(
+      EpochDomain domain;
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(EpochDomainTest, UnobservedObjectsAreFreedOnReclaim) {
+    std::atomic<std::size_t> destroyedCount(0);
+    EpochDomain domain;
+
+    domain.Retire(new CountedNode(1, destroyedCount));
+    domain.Retire(new CountedNode(2, destroyedCount));
+    domain.Reclaim();
+
+    EXPECT_EQ(destroyedCount.load(), 2U);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(EpochDomainTest, ObjectsAreKeptWhileReadScopeExists) {
+    std::atomic<std::size_t> destroyedCount(0);
+    EpochDomain domain;
+    {
+      EpochDomain::ReadScope readScope(domain);
+      domain.Retire(new CountedNode(1, destroyedCount));
+      domain.Reclaim();
+      EXPECT_EQ(destroyedCount.load(), 0U);
+
+      // Read scopes can be nested without ending the outer one early
+      {
+        EpochDomain::ReadScope nestedScope(domain);
+      }
+      domain.Reclaim();
+      EXPECT_EQ(destroyedCount.load(), 0U);
+    }
+
+    domain.Reclaim();
+    EXPECT_EQ(destroyedCount.load(), 1U);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(EpochDomainTest, ReadScopeInOtherThreadKeepsObjects) {
+    std::atomic<std::size_t> destroyedCount(0);
+    std::atomic<int> readerState(0);
+    EpochDomain domain;
+
+    std::thread reader(
+      [&] {
+        EpochDomain::ReadScope readScope(domain);
+        readerState.store(1);
+        while(readerState.load() != 2) {
+          std::this_thread::yield();
+        }
+      }
+    );
+    while(readerState.load() != 1) {
+      std::this_thread::yield();
+    }
+
+    domain.Retire(new CountedNode(1, destroyedCount));
+    domain.Reclaim();
+    EXPECT_EQ(destroyedCount.load(), 0U);
+
+    readerState.store(2);
+    reader.join();
+
+    domain.Reclaim();
+    EXPECT_EQ(destroyedCount.load(), 1U);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(EpochDomainTest, DestroyingDomainFreesRetiredObjects) {
+    std::atomic<std::size_t> destroyedCount(0);
+    {
+      EpochDomain domain;
+      EpochDomain::ReadScope readScope(domain);
+      domain.Retire(new CountedNode(1, destroyedCount));
+      EXPECT_EQ(destroyedCount.load(), 0U);
+    }
+    EXPECT_EQ(destroyedCount.load(), 1U);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(EpochDomainTest, ReadersNeverSeeFreedObjects) {
+    std::atomic<std::size_t> destroyedCount(0);
+    std::atomic<CountedNode *> current(new CountedNode(1, destroyedCount));
+    std::atomic<bool> writerFinished(false);
+    std::atomic<std::size_t> freedReadCount(0);
+    {
+      EpochDomain domain;
+
+      std::vector<std::thread> readers;
+      for(std::size_t readerIndex = 0; readerIndex < 4; ++readerIndex) {
+        readers.emplace_back(
+          [&] {
+            while(!writerFinished.load(std::memory_order_relaxed)) {
+              EpochDomain::ReadScope readScope(domain);
+              if(current.load()->Value == 0xDEADBEEF) {
+                freedReadCount.fetch_add(1);
+              }
+            }
+          }
+        );
+      }
+
+      for(std::size_t index = 2; index < 5000; ++index) {
+        domain.Retire(current.exchange(new CountedNode(index, destroyedCount)));
+      }
+      writerFinished.store(true);
+
+      for(std::thread &reader : readers) {
+        reader.join();
+      }
+      delete current.load();
+    }
+
+    EXPECT_EQ(freedReadCount.load(), 0U);
+    EXPECT_EQ(destroyedCount.load(), 4999U);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Threading
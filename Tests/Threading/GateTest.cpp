@@ -21,6 +21,8 @@ limitations under the License.
 #define NUCLEX_SUPPORT_SOURCE 1
 
 #include "Nuclex/Support/Threading/Gate.h"
+#include "Nuclex/Support/Threading/ThreadPool.h" // for ThreadPool
+#include "Nuclex/Support/Threading/Latch.h" // for Latch
 #include "Nuclex/Support/Threading/Thread.h"
 
 #include <gtest/gtest.h>
@@ -187,6 +189,55 @@ namespace Nuclex { namespace Support { namespace Threading {
     EXPECT_TRUE(hasPassed);
   }
 
+  // ------------------------------------------------------------------------------------------- //
+#if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+  TEST(GateTest, AsyncWaitRunsContinuationWhenGateOpens) {
+    ThreadPool testPool;
+    Gate gate;
+    Latch finished(16);
+
+    std::atomic<int> runCount(0);
+    for(std::size_t index = 0; index < 16; ++index) {
+      gate.WaitAsync(testPool, [&]() { ++runCount; finished.CountDown(); });
+    }
+
+    EXPECT_FALSE(finished.WaitFor(std::chrono::microseconds(10000)));
+    EXPECT_EQ(runCount.load(), 0);
+
+    gate.Open();
+    finished.Wait();
+    EXPECT_EQ(runCount.load(), 16);
+  }
+#endif
+  // ------------------------------------------------------------------------------------------- //
+#if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+  TEST(GateTest, AsyncWaitOnOpenGateRunsContinuationImmediately) {
+    ThreadPool testPool;
+    Gate gate(true);
+    Latch finished(1);
+
+    gate.WaitAsync(testPool, [&finished]() { finished.CountDown(); });
+    finished.Wait();
+  }
+#endif
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(GateTest, ThreadWaitsBeforeClosedGateWithSpinningDisabled) {
+    Gate gate(false);
+    gate.SetMaximumSpinCount(0);
+
+    TestThread test(gate);
+    test.LaunchThread();
+
+    Thread::Sleep(std::chrono::microseconds(25000)); // 25 ms
+    EXPECT_FALSE(test.HasPassed());
+
+    gate.Open();
+
+    test.JoinThread();
+    EXPECT_TRUE(test.HasPassed());
+  }
+
   // ------------------------------------------------------------------------------------------- //
 
 }}} // namespace Nuclex::Support::Threading
@@ -0,0 +1,185 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the library is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_SUPPORT_SOURCE 1
+
+#include "Nuclex/Support/Threading/HazardPointerDomain.h"
+
+#include <atomic> // for std::atomic
+#include <memory> // for std::unique_ptr
+#include <thread> // for std::thread
+#include <vector> // for std::vector
+
+#include <gtest/gtest.h>
+
+namespace {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Node that counts how many of its instances have been destroyed</summary>
+  struct CountedNode {
+
+    /// <summary>Initializes a new counted node</summary>
+    /// <param name="value">Value that will be stored in the node</param>
+    /// <param name="destroyedCount">Counter that will be incremented on destruction</param>
+    public: CountedNode(std::size_t value, std::atomic<std::size_t> &destroyedCount) :
+      Value(value),
+      DestroyedCount(destroyedCount) {}
+
+    /// <summary>Overwrites the value and increments the destruction counter</summary>
+    public: ~CountedNode() {
+      this->Value = 0xDEADBEEF;
+      this->DestroyedCount.fetch_add(1);
+    }
+
+    /// <summary>Value stored in the node</summary>
+    public: std::size_t Value;
+    /// <summary>Counter that will be incremented when the node is destroyed</summary>
+    public: std::atomic<std::size_t> &DestroyedCount;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // anonymous namespace
+
+namespace Nuclex { namespace Support { namespace Threading {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(HazardPointerDomainTest, InstancesCanBeCreated) {
+    EXPECT_NO_THROW(
+      HazardPointerDomain domain;
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(HazardPointerDomainTest, UnprotectedObjectsAreFreedOnReclaim) {
+    std::atomic<std::size_t> destroyedCount(0);
+    HazardPointerDomain domain;
+
+    domain.Retire(new CountedNode(1, destroyedCount));
+    domain.Retire(new CountedNode(2, destroyedCount));
+    domain.Reclaim();
+
+    EXPECT_EQ(destroyedCount.load(), 2U);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(HazardPointerDomainTest, ProtectedObjectIsKept) {
+    std::atomic<std::size_t> destroyedCount(0);
+    std::atomic<CountedNode *> current(new CountedNode(1, destroyedCount));
+    HazardPointerDomain domain;
+    {
+      HazardPointerDomain::Guard guard(domain);
+      CountedNode *protectedNode = guard.Protect(current);
+      ASSERT_EQ(protectedNode->Value, 1U);
+
+      CountedNode *unprotectedNode = new CountedNode(2, destroyedCount);
+      domain.Retire(current.exchange(unprotectedNode));
+      domain.Retire(current.exchange(new CountedNode(3, destroyedCount)));
+      domain.Reclaim();
+
+      // Only the node that is not protected by the guard may have been freed
+      EXPECT_EQ(destroyedCount.load(), 1U);
+      EXPECT_EQ(protectedNode->Value, 1U);
+
+      guard.Reset();
+      domain.Reclaim();
+      EXPECT_EQ(destroyedCount.load(), 2U);
+    }
+
+    delete current.load();
+    EXPECT_EQ(destroyedCount.load(), 3U);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(HazardPointerDomainTest, ThreadCanHoldManyGuards) {
+    std::atomic<std::size_t> destroyedCount(0);
+    HazardPointerDomain domain;
+
+    std::vector<std::atomic<CountedNode *>> nodes(32);
+    for(std::size_t index = 0; index < nodes.size(); ++index) {
+      nodes[index].store(new CountedNode(index, destroyedCount));
+    }
+    {
+      std::vector<std::unique_ptr<HazardPointerDomain::Guard>> guards;
+      for(std::size_t index = 0; index < nodes.size(); ++index) {
+        guards.emplace_back(new HazardPointerDomain::Guard(domain));
+        guards.back()->Protect(nodes[index]);
+      }
+
+      for(std::size_t index = 0; index < nodes.size(); ++index) {
+        domain.Retire(nodes[index].exchange(nullptr));
+      }
+      domain.Reclaim();
+      EXPECT_EQ(destroyedCount.load(), 0U);
+    }
+
+    domain.Reclaim();
+    EXPECT_EQ(destroyedCount.load(), 32U);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(HazardPointerDomainTest, ReadersNeverSeeFreedObjects) {
+    std::atomic<std::size_t> destroyedCount(0);
+    std::atomic<CountedNode *> current(new CountedNode(1, destroyedCount));
+    std::atomic<bool> writerFinished(false);
+    std::atomic<std::size_t> freedReadCount(0);
+    {
+      HazardPointerDomain domain;
+
+      std::vector<std::thread> readers;
+      for(std::size_t readerIndex = 0; readerIndex < 4; ++readerIndex) {
+        readers.emplace_back(
+          [&] {
+            HazardPointerDomain::Guard guard(domain);
+            while(!writerFinished.load(std::memory_order_relaxed)) {
+              if(guard.Protect(current)->Value == 0xDEADBEEF) {
+                freedReadCount.fetch_add(1);
+              }
+              guard.Reset();
+            }
+          }
+        );
+      }
+
+      for(std::size_t index = 2; index < 5000; ++index) {
+        domain.Retire(current.exchange(new CountedNode(index, destroyedCount)));
+      }
+      writerFinished.store(true);
+
+      for(std::thread &reader : readers) {
+        reader.join();
+      }
+      delete current.load();
+    }
+
+    EXPECT_EQ(freedReadCount.load(), 0U);
+    EXPECT_EQ(destroyedCount.load(), 4999U);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Threading
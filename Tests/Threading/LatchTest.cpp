@@ -21,6 +21,7 @@ limitations under the License.
 #define NUCLEX_SUPPORT_SOURCE 1
 
 #include "Nuclex/Support/Threading/Latch.h"
+#include "Nuclex/Support/Threading/ThreadPool.h" // for ThreadPool
 #include "Nuclex/Support/Threading/Thread.h"
 
 #include <gtest/gtest.h>
@@ -201,6 +202,46 @@ namespace Nuclex { namespace Support { namespace Threading {
     EXPECT_TRUE(hasPassed);
   }
 
+  // ------------------------------------------------------------------------------------------- //
+#if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+  TEST(LatchTest, AsyncWaitRunsContinuationWhenCountReachesZero) {
+    ThreadPool testPool;
+    Latch latch(2);
+    Latch finished(1);
+
+    std::atomic<bool> hasRun(false);
+    latch.WaitAsync(testPool, [&]() { hasRun = true; finished.CountDown(); });
+
+    latch.CountDown();
+    EXPECT_FALSE(finished.WaitFor(std::chrono::microseconds(10000)));
+    EXPECT_FALSE(hasRun.load());
+
+    latch.CountDown();
+    finished.Wait();
+    EXPECT_TRUE(hasRun.load());
+  }
+#endif
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(LatchTest, ThreadWaitsBeforeIncrementedLatchWithLongSpins) {
+    Latch latch(1);
+    latch.SetMaximumSpinCount(100000);
+
+    TestThread test(latch);
+    test.LaunchThread();
+
+    Thread::Sleep(std::chrono::microseconds(25000)); // 25 ms
+    EXPECT_FALSE(test.HasPassed());
+
+    latch.CountDown();
+
+    test.JoinThread();
+    EXPECT_TRUE(test.HasPassed());
+
+    // A timed wait on the open latch must still succeed right away
+    EXPECT_TRUE(latch.WaitFor(std::chrono::microseconds(0)));
+  }
+
   // ------------------------------------------------------------------------------------------- //
 
 }}} // namespace Nuclex::Support::Threading
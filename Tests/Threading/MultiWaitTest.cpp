@@ -0,0 +1,173 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the library is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_SUPPORT_SOURCE 1
+
+#include "Nuclex/Support/Threading/MultiWait.h"
+
+#if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+
+#include "Nuclex/Support/Threading/Gate.h" // for Gate
+#include "Nuclex/Support/Threading/Semaphore.h" // for Semaphore
+#include "Nuclex/Support/Threading/StopSource.h" // for StopSource
+
+#include <gtest/gtest.h>
+
+#include <thread> // for std::thread
+#include <chrono> // for std::chrono::milliseconds
+#include <memory> // for std::shared_ptr
+
+namespace Nuclex { namespace Support { namespace Threading {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(MultiWaitTest, WaitAnyReturnsIndexOfOpenGate) {
+    Gate first, second(true), third(true);
+
+    std::size_t index = MultiWait::WaitAny({ first, second, third });
+    EXPECT_EQ(index, 1U);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(MultiWaitTest, WaitAnyOnlyTakesTicketFromReturnedSemaphore) {
+    Semaphore first(1), second(1);
+
+    EXPECT_EQ(MultiWait::WaitAny({ first, second }), 0U);
+    EXPECT_EQ(MultiWait::WaitAny({ first, second }), 1U);
+    EXPECT_EQ(
+      MultiWait::WaitAnyFor({ first, second }, std::chrono::microseconds(1000)),
+      MultiWait::TimedOut
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(MultiWaitTest, WaitAnyForTimesOut) {
+    Gate gate;
+    Semaphore semaphore;
+    std::shared_ptr<StopSource> stopSource = StopSource::Create();
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::size_t index = MultiWait::WaitAnyFor(
+      { gate, semaphore, *stopSource->GetToken() }, std::chrono::microseconds(10000)
+    );
+    EXPECT_EQ(index, MultiWait::TimedOut);
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::microseconds(10000));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(MultiWaitTest, WaitAnyWakesWhenGateOpens) {
+    Gate first, second;
+
+    std::thread opener(
+      [&second]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        second.Open();
+      }
+    );
+
+    std::size_t index = MultiWait::WaitAny({ first, second });
+    opener.join();
+
+    EXPECT_EQ(index, 1U);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(MultiWaitTest, WaitAnyWakesWhenSemaphoreIsPosted) {
+    Gate gate;
+    Semaphore semaphore;
+
+    std::thread poster(
+      [&semaphore]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        semaphore.Post();
+      }
+    );
+
+    std::size_t index = MultiWait::WaitAny({ gate, semaphore });
+    poster.join();
+
+    EXPECT_EQ(index, 1U);
+    EXPECT_FALSE(semaphore.WaitForThenDecrement(std::chrono::microseconds(0)));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(MultiWaitTest, WaitAnyWakesWhenStopTokenIsCanceled) {
+    Semaphore semaphore;
+    std::shared_ptr<StopSource> stopSource = StopSource::Create();
+    std::shared_ptr<const StopToken> stopToken = stopSource->GetToken();
+
+    std::thread canceler(
+      [&stopSource]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        stopSource->Cancel();
+      }
+    );
+
+    std::size_t index = MultiWait::WaitAny({ semaphore, *stopToken });
+    canceler.join();
+
+    EXPECT_EQ(index, 1U);
+    EXPECT_TRUE(stopToken->IsCanceled());
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(MultiWaitTest, WaitAllWaitsForEveryTarget) {
+    Gate gate;
+    Semaphore semaphore;
+
+    std::thread signaler(
+      [&gate, &semaphore]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        semaphore.Post();
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        gate.Open();
+      }
+    );
+
+    MultiWait::WaitAll({ semaphore, gate });
+    signaler.join();
+
+    EXPECT_FALSE(semaphore.WaitForThenDecrement(std::chrono::microseconds(0)));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(MultiWaitTest, WaitAllForGivesBackTicketsOnTimeout) {
+    Gate gate;
+    Semaphore semaphore(1);
+
+    bool result = MultiWait::WaitAllFor({ semaphore, gate }, std::chrono::microseconds(5000));
+    EXPECT_FALSE(result);
+
+    // The ticket taken while waiting for the gate must have been returned
+    EXPECT_TRUE(semaphore.WaitForThenDecrement(std::chrono::microseconds(0)));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Threading
+
+#endif // defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
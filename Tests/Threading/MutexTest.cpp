@@ -0,0 +1,134 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the library is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_SUPPORT_SOURCE 1
+
+#include "Nuclex/Support/Threading/Mutex.h"
+
+#if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+
+#include <mutex> // for std::lock_guard, std::unique_lock
+#include <thread> // for std::thread
+#include <vector> // for std::vector
+
+#include <gtest/gtest.h>
+
+namespace Nuclex { namespace Support { namespace Threading {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(MutexTest, InstancesCanBeCreated) {
+    EXPECT_NO_THROW(
+      Mutex mutex;
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(MutexTest, CanBeLockedAndUnlocked) {
+    Mutex mutex;
+    mutex.Lock();
+    mutex.Unlock();
+    mutex.Lock();
+    mutex.Unlock();
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(MutexTest, TryLockFailsWhileLocked) {
+    Mutex mutex;
+
+    EXPECT_TRUE(mutex.TryLock());
+    EXPECT_FALSE(mutex.TryLock());
+    mutex.Unlock();
+    EXPECT_TRUE(mutex.TryLock());
+    mutex.Unlock();
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(MutexTest, WorksWithStandardLockGuards) {
+    Mutex mutex;
+    {
+      std::lock_guard<Mutex> lockScope(mutex);
+      EXPECT_FALSE(mutex.TryLock());
+    }
+    {
+      std::unique_lock<Mutex> lockScope(mutex, std::try_to_lock);
+      EXPECT_TRUE(lockScope.owns_lock());
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(MutexTest, ProvidesMutualExclusion) {
+    Mutex mutex;
+    std::size_t unprotectedCounter = 0;
+
+    std::vector<std::thread> threads;
+    for(std::size_t threadIndex = 0; threadIndex < 8; ++threadIndex) {
+      threads.emplace_back(
+        [&mutex, &unprotectedCounter] {
+          for(std::size_t index = 0; index < 20000; ++index) {
+            mutex.Lock();
+            ++unprotectedCounter;
+            mutex.Unlock();
+          }
+        }
+      );
+    }
+    for(std::thread &thread : threads) {
+      thread.join();
+    }
+
+    EXPECT_EQ(unprotectedCounter, 160000U);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(MutexTest, SleepingThreadsAreWokenUp) {
+    Mutex mutex;
+    mutex.SetMaximumSpinCount(0); // Go to sleep right away
+    std::size_t unprotectedCounter = 0;
+
+    mutex.Lock();
+    std::vector<std::thread> threads;
+    for(std::size_t threadIndex = 0; threadIndex < 4; ++threadIndex) {
+      threads.emplace_back(
+        [&mutex, &unprotectedCounter] {
+          std::lock_guard<Mutex> lockScope(mutex);
+          ++unprotectedCounter;
+        }
+      );
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    mutex.Unlock();
+
+    for(std::thread &thread : threads) {
+      thread.join();
+    }
+    EXPECT_EQ(unprotectedCounter, 4U);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Threading
+
+#endif // defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
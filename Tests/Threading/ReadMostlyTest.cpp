@@ -0,0 +1,249 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the library is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_SUPPORT_SOURCE 1
+
+#include "Nuclex/Support/Threading/ReadMostly.h"
+
+#include <atomic> // for std::atomic
+#include <stdexcept> // for std::runtime_error
+#include <string> // for std::string
+#include <thread> // for std::thread
+#include <vector> // for std::vector
+
+#include <gtest/gtest.h>
+
+namespace {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Value that counts how many of its instances have been destroyed</summary>
+  class CountedValue {
+
+    /// <summary>Initializes a new counted value</summary>
+    /// <param name="number">Number that will be stored in the value</param>
+    /// <param name="destroyedCount">Counter that will be incremented on destruction</param>
+    public: CountedValue(int number, std::atomic<std::size_t> &destroyedCount) :
+      Number(number),
+      DestroyedCount(destroyedCount) {}
+
+    /// <summary>Initializes a new counted value as a copy of another one</summary>
+    /// <param name="other">Counted value that will be copied</param>
+    public: CountedValue(const CountedValue &other) = default;
+
+    /// <summary>Increments the destruction counter</summary>
+    public: ~CountedValue() {
+      this->DestroyedCount.fetch_add(1);
+    }
+
+    /// <summary>Number stored in the value</summary>
+    public: int Number;
+    /// <summary>Counter that will be incremented when the value is destroyed</summary>
+    public: std::atomic<std::size_t> &DestroyedCount;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Pair of numbers that writers always keep equal to each other</summary>
+  struct MatchedPair {
+    /// <summary>First number, always equal to the second number</summary>
+    public: std::size_t First = 0;
+    /// <summary>Second number, always equal to the first number</summary>
+    public: std::size_t Second = 0;
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // anonymous namespace
+
+namespace Nuclex { namespace Support { namespace Threading {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ReadMostlyTest, InstancesCanBeCreated) {
+    EXPECT_NO_THROW(
+      ReadMostly<int> value;
+    );
+    EXPECT_NO_THROW(
+      ReadMostly<std::string> value(u8"Hello");
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ReadMostlyTest, InitialValueCanBeRead) {
+    ReadMostly<std::string> value(u8"Hello World");
+
+    ReadMostly<std::string>::ReadScope scope = value.Read();
+    EXPECT_EQ(*scope, u8"Hello World");
+    EXPECT_EQ(scope->length(), 11U);
+    EXPECT_EQ(value.Load(), u8"Hello World");
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ReadMostlyTest, PublishedValueReplacesCurrentValue) {
+    ReadMostly<int> value(1);
+
+    value.Publish(2);
+    EXPECT_EQ(value.Load(), 2);
+
+    int three = 3;
+    value.Publish(three);
+    EXPECT_EQ(value.Load(), 3);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ReadMostlyTest, UpdateModifiesCopyOfCurrentValue) {
+    ReadMostly<std::vector<int>> value;
+
+    value.Update([](std::vector<int> &numbers) { numbers.push_back(123); });
+    value.Update([](std::vector<int> &numbers) { numbers.push_back(456); });
+
+    std::vector<int> numbers = value.Load();
+    ASSERT_EQ(numbers.size(), 2U);
+    EXPECT_EQ(numbers[0], 123);
+    EXPECT_EQ(numbers[1], 456);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ReadMostlyTest, FailedUpdateKeepsCurrentValue) {
+    ReadMostly<int> value(10);
+
+    EXPECT_THROW(
+      value.Update([](int &number) { number = 20; throw std::runtime_error(u8"Test"); }),
+      std::runtime_error
+    );
+    EXPECT_EQ(value.Load(), 10);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ReadMostlyTest, ReadScopeKeepsSeeingOldValue) {
+    ReadMostly<int> value(1);
+
+    ReadMostly<int>::ReadScope scope = value.Read();
+    value.Publish(2);
+
+    EXPECT_EQ(*scope, 1);
+    EXPECT_EQ(value.Load(), 2);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ReadMostlyTest, ReplacedValuesAreFreedWhenUnobserved) {
+    std::atomic<std::size_t> destroyedCount(0);
+    {
+      ReadMostly<CountedValue> value(CountedValue(1, destroyedCount));
+      destroyedCount.store(0); // The temporary was destroyed
+
+      value.Publish(CountedValue(2, destroyedCount));
+      EXPECT_EQ(destroyedCount.load(), 2U); // The temporary and the replaced value
+
+      value.Publish(CountedValue(3, destroyedCount));
+      EXPECT_EQ(destroyedCount.load(), 4U);
+    }
+    EXPECT_EQ(destroyedCount.load(), 5U);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ReadMostlyTest, ReplacedValuesAreKeptWhileObserved) {
+    std::atomic<std::size_t> destroyedCount(0);
+    {
+      ReadMostly<CountedValue> value(CountedValue(1, destroyedCount));
+      destroyedCount.store(0);
+      {
+        ReadMostly<CountedValue>::ReadScope scope = value.Read();
+
+        // Updates don't create temporaries, so only replaced values would count
+        value.Update([](CountedValue &counted) { counted.Number = 2; });
+        value.Update([](CountedValue &counted) { counted.Number = 3; });
+        EXPECT_EQ(destroyedCount.load(), 0U);
+        EXPECT_EQ(scope->Number, 1);
+
+        // Nested read sections must not cut the outer read section short
+        {
+          ReadMostly<CountedValue>::ReadScope nestedScope = value.Read();
+          EXPECT_EQ(nestedScope->Number, 3);
+        }
+        value.Update([](CountedValue &counted) { counted.Number = 4; });
+        EXPECT_EQ(destroyedCount.load(), 0U);
+        EXPECT_EQ(scope->Number, 1);
+      }
+
+      value.Update([](CountedValue &counted) { counted.Number = 5; });
+      EXPECT_EQ(destroyedCount.load(), 4U);
+    }
+    EXPECT_EQ(destroyedCount.load(), 5U);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ReadMostlyTest, ReadersNeverSeeHalfWrittenValues) {
+    ReadMostly<MatchedPair> value;
+    std::atomic<bool> writersFinished(false);
+    std::atomic<std::size_t> inconsistentReadCount(0);
+
+    std::vector<std::thread> readers;
+    for(std::size_t readerIndex = 0; readerIndex < 4; ++readerIndex) {
+      readers.emplace_back(
+        [&] {
+          std::size_t lastSeen = 0;
+          while(!writersFinished.load(std::memory_order_relaxed)) {
+            ReadMostly<MatchedPair>::ReadScope scope = value.Read();
+            if((scope->First != scope->Second) || (scope->First < lastSeen)) {
+              inconsistentReadCount.fetch_add(1);
+            }
+            lastSeen = scope->First;
+          }
+        }
+      );
+    }
+
+    std::vector<std::thread> writers;
+    for(std::size_t writerIndex = 0; writerIndex < 2; ++writerIndex) {
+      writers.emplace_back(
+        [&] {
+          for(std::size_t index = 0; index < 2000; ++index) {
+            value.Update([](MatchedPair &pair) { ++pair.First; ++pair.Second; });
+          }
+        }
+      );
+    }
+
+    for(std::thread &writer : writers) {
+      writer.join();
+    }
+    writersFinished.store(true);
+    for(std::thread &reader : readers) {
+      reader.join();
+    }
+
+    EXPECT_EQ(inconsistentReadCount.load(), 0U);
+    EXPECT_EQ(value.Load().First, 4000U);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Threading
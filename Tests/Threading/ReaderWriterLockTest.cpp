@@ -0,0 +1,182 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the library is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_SUPPORT_SOURCE 1
+
+#include "Nuclex/Support/Threading/ReaderWriterLock.h"
+
+#if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+
+#include "Nuclex/Support/Threading/Gate.h" // for Gate
+
+#include <atomic> // for std::atomic
+#include <mutex> // for std::unique_lock
+#include <shared_mutex> // for std::shared_lock
+#include <thread> // for std::thread
+#include <vector> // for std::vector
+
+#include <gtest/gtest.h>
+
+namespace Nuclex { namespace Support { namespace Threading {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ReaderWriterLockTest, InstancesCanBeCreated) {
+    EXPECT_NO_THROW(
+      ReaderWriterLock lock;
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ReaderWriterLockTest, MultipleReadersCanHoldLock) {
+    ReaderWriterLock lock;
+
+    lock.LockShared();
+    std::thread otherReader(
+      [&lock] {
+        EXPECT_TRUE(lock.TryLockShared());
+        lock.UnlockShared();
+      }
+    );
+    otherReader.join();
+    lock.UnlockShared();
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ReaderWriterLockTest, WriterExcludesReadersAndWriters) {
+    ReaderWriterLock lock;
+
+    lock.Lock();
+    std::thread otherThread(
+      [&lock] {
+        EXPECT_FALSE(lock.TryLockShared());
+        EXPECT_FALSE(lock.TryLock());
+      }
+    );
+    otherThread.join();
+    lock.Unlock();
+
+    EXPECT_TRUE(lock.TryLock());
+    lock.Unlock();
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ReaderWriterLockTest, ReaderExcludesWriter) {
+    ReaderWriterLock lock;
+
+    lock.LockShared();
+    std::thread writer(
+      [&lock] {
+        EXPECT_FALSE(lock.TryLock());
+      }
+    );
+    writer.join();
+    lock.UnlockShared();
+
+    EXPECT_TRUE(lock.TryLock());
+    lock.Unlock();
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ReaderWriterLockTest, WorksWithStandardLockGuards) {
+    ReaderWriterLock lock;
+    {
+      std::shared_lock<ReaderWriterLock> readScope(lock);
+      EXPECT_TRUE(readScope.owns_lock());
+    }
+    {
+      std::unique_lock<ReaderWriterLock> writeScope(lock);
+      EXPECT_TRUE(writeScope.owns_lock());
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ReaderWriterLockTest, WriterWaitsForReadersToLeave) {
+    ReaderWriterLock lock;
+    Gate writerStartedGate;
+    std::atomic<bool> writerEntered(false);
+
+    lock.LockShared();
+    std::thread writer(
+      [&] {
+        writerStartedGate.Open();
+        lock.Lock();
+        writerEntered.store(true);
+        lock.Unlock();
+      }
+    );
+    writerStartedGate.Wait();
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    EXPECT_FALSE(writerEntered.load());
+
+    lock.UnlockShared();
+    writer.join();
+    EXPECT_TRUE(writerEntered.load());
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ReaderWriterLockTest, ReadersNeverSeeHalfWrittenData) {
+    ReaderWriterLock lock;
+
+    // The writers keep both values equal, readers check that they always are
+    std::size_t first = 0, second = 0;
+    std::atomic<std::size_t> inconsistentReadCount(0);
+
+    std::vector<std::thread> threads;
+    for(std::size_t threadIndex = 0; threadIndex < 6; ++threadIndex) {
+      threads.emplace_back(
+        [&, threadIndex] {
+          for(std::size_t index = 0; index < 10000; ++index) {
+            if((threadIndex < 2) && ((index % 16) == 0)) {
+              lock.Lock();
+              ++first;
+              ++second;
+              lock.Unlock();
+            } else {
+              lock.LockShared();
+              if(first != second) {
+                inconsistentReadCount.fetch_add(1);
+              }
+              lock.UnlockShared();
+            }
+          }
+        }
+      );
+    }
+    for(std::thread &thread : threads) {
+      thread.join();
+    }
+
+    EXPECT_EQ(inconsistentReadCount.load(), 0U);
+    EXPECT_EQ(first, 1250U);
+    EXPECT_EQ(second, 1250U);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Threading
+
+#endif // defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
@@ -28,12 +28,15 @@ limitations under the License.
 #include "Nuclex/Support/Threading/Thread.h"
 
 #include "../Collections/ConcurrentBufferTest.h" // HighContentionBufferTest
-#include "../../Source/Helpers/PosixApi.h" // PosixApi
+#include "../../Source/Platform/PosixApi.h" // PosixApi
 
 #include <gtest/gtest.h>
 
 #include <atomic> // for std::atomic
 #include <thread> // for std::thread
+#include <chrono> // for std::chrono::steady_clock
+#include <iostream> // for std::cout
+#include <cassert> // for assert()
 
 #if !defined(NUCLEX_SUPPORT_WINDOWS)
 #include <semaphore.h> // for ::sem_t, ::sem_init(), ::sem_post(), ::sem_wait()...
@@ -205,6 +208,52 @@ namespace {
 
   // ------------------------------------------------------------------------------------------- //
 
+  /// <summary>Number of round trips the hand-off benchmark performs</summary>
+  const std::size_t HandOffRoundTripCount = 100000;
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Bounces a ticket between two threads via a pair of semaphores</summary>
+  /// <param name="maximumSpinCount">Spin count the semaphores will be configured with</param>
+  /// <returns>The average time a single round trip took in nanoseconds</returns>
+  /// <remarks>
+  ///   This measures the wake-up latency of the semaphore: each thread posts to the other
+  ///   thread's semaphore and then immediately waits on its own, so every wait is satisfied
+  ///   shortly after it begins. That is exactly the case adaptive spinning is for.
+  /// </remarks>
+  double measureHandOffNanoseconds(std::size_t maximumSpinCount) {
+    Nuclex::Support::Threading::Semaphore ping(0), pong(0);
+    ping.SetMaximumSpinCount(maximumSpinCount);
+    pong.SetMaximumSpinCount(maximumSpinCount);
+
+    std::thread responder(
+      [&ping, &pong]() {
+        for(std::size_t index = 0; index < HandOffRoundTripCount; ++index) {
+          ping.WaitThenDecrement();
+          pong.Post();
+        }
+      }
+    );
+
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+    for(std::size_t index = 0; index < HandOffRoundTripCount; ++index) {
+      ping.Post();
+      pong.WaitThenDecrement();
+    }
+    std::chrono::steady_clock::time_point endTime = std::chrono::steady_clock::now();
+
+    responder.join();
+
+    std::chrono::nanoseconds elapsed = (
+      std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime)
+    );
+    return (
+      static_cast<double>(elapsed.count()) / static_cast<double>(HandOffRoundTripCount)
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
 } // anonymous namespace
 
 namespace Nuclex { namespace Support { namespace Threading {
@@ -244,6 +293,19 @@ namespace Nuclex { namespace Support { namespace Threading {
 
   // ------------------------------------------------------------------------------------------- //
 
+  TEST(SemaphoreTest, HandOffBenchmarkSucceeds) {
+    double sleepingNanoseconds = measureHandOffNanoseconds(0);
+    double spinningNanoseconds = measureHandOffNanoseconds(1000);
+
+    std::cout <<
+      "Handing off " << HandOffRoundTripCount << " times " <<
+      "without spinning: " << std::fixed << sleepingNanoseconds << " ns per round trip, " <<
+      "with spinning: " << std::fixed << spinningNanoseconds << " ns per round trip" <<
+      std::endl;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
 }}} // namespace Nuclex::Support::Threading
 
 #endif // defined(NUCLEX_SUPPORT_ENABLE_BENCHMARKS)
\ No newline at end of file
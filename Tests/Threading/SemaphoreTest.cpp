@@ -21,6 +21,8 @@ limitations under the License.
 #define NUCLEX_SUPPORT_SOURCE 1
 
 #include "Nuclex/Support/Threading/Semaphore.h"
+#include "Nuclex/Support/Threading/ThreadPool.h" // for ThreadPool
+#include "Nuclex/Support/Threading/Latch.h" // for Latch
 #include "Nuclex/Support/Threading/Thread.h"
 
 #include <gtest/gtest.h>
@@ -28,6 +30,7 @@ limitations under the License.
 #include <atomic> // for std::atomic
 #include <thread> // for std::thread
 #include <stdexcept> // for std::system_error
+#include <ctime> // for std::clock()
 
 namespace {
 
@@ -143,6 +146,36 @@ namespace Nuclex { namespace Support { namespace Threading {
 
   // ------------------------------------------------------------------------------------------- //
 
+  TEST(SemaphoreTest, WaitingThreadSleepsAfterTicketWasTaken) {
+    Semaphore semaphore;
+    semaphore.SetMaximumSpinCount(0);
+
+    // Post a ticket, switching the wait word to 'tickets available', and take it again
+    // without ever having to wait. The wait word stays in the 'tickets available' state
+    // even though the admit counter is zero now.
+    semaphore.Post();
+    semaphore.WaitThenDecrement();
+
+    TestThread test(semaphore);
+    test.LaunchThread();
+
+    // If the waiting thread fails to switch the wait word over before sleeping on it,
+    // its wait returns immediately, over and over, and it burns all the CPU time
+    // it can get while we sleep here.
+    std::clock_t startTime = std::clock();
+    Thread::Sleep(std::chrono::microseconds(100000)); // 100 ms
+    std::clock_t cpuTimeUsed = std::clock() - startTime;
+
+    EXPECT_FALSE(test.HasPassed());
+    EXPECT_LT(cpuTimeUsed, CLOCKS_PER_SEC / 20); // less than 50 ms
+
+    semaphore.Post();
+    test.JoinThread();
+    EXPECT_TRUE(test.HasPassed());
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
   TEST(SemaphoreTest, WaitCanTimeOut) {
     Semaphore semaphore;
 
@@ -159,6 +192,58 @@ namespace Nuclex { namespace Support { namespace Threading {
     EXPECT_TRUE(hasPassed);
   }
 
+  // ------------------------------------------------------------------------------------------- //
+#if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+  TEST(SemaphoreTest, AsyncWaitConsumesOneTicketPerContinuation) {
+    ThreadPool testPool;
+    Semaphore semaphore(1);
+    Latch finished(3);
+
+    std::atomic<int> runCount(0);
+    for(std::size_t index = 0; index < 3; ++index) {
+      semaphore.WaitThenDecrementAsync(
+        testPool, [&]() { ++runCount; finished.CountDown(); }
+      );
+    }
+
+    // Only one ticket was available, so only one continuation may run
+    EXPECT_FALSE(finished.WaitFor(std::chrono::microseconds(10000)));
+    EXPECT_EQ(runCount.load(), 1);
+
+    semaphore.Post(2);
+    finished.Wait();
+    EXPECT_EQ(runCount.load(), 3);
+
+    // All tickets have been used up by the continuations
+    EXPECT_FALSE(semaphore.WaitForThenDecrement(std::chrono::microseconds(1000)));
+  }
+#endif
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(SemaphoreTest, HandOffWorksWithAnySpinCount) {
+    for(std::size_t maximumSpinCount : { 0, 16, 100000 }) {
+      Semaphore ping, pong;
+      ping.SetMaximumSpinCount(maximumSpinCount);
+      pong.SetMaximumSpinCount(maximumSpinCount);
+
+      std::thread responder(
+        [&ping, &pong]() {
+          for(std::size_t index = 0; index < 1000; ++index) {
+            ping.WaitThenDecrement();
+            pong.Post();
+          }
+        }
+      );
+      for(std::size_t index = 0; index < 1000; ++index) {
+        ping.Post();
+        pong.WaitThenDecrement();
+      }
+      responder.join();
+
+      EXPECT_FALSE(pong.WaitForThenDecrement(std::chrono::microseconds(0)));
+    }
+  }
+
   // ------------------------------------------------------------------------------------------- //
 
 }}} // namespace Nuclex::Support::Threading
@@ -0,0 +1,204 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the library is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_SUPPORT_SOURCE 1
+
+#include "Nuclex/Support/Threading/Strand.h"
+
+#if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+
+#include "Nuclex/Support/Threading/ThreadPool.h" // for ThreadPool
+#include "Nuclex/Support/Threading/Latch.h" // for Latch
+
+#include <atomic> // for std::atomic
+#include <memory> // for std::unique_ptr
+#include <stdexcept> // for std::runtime_error
+#include <thread> // for std::thread
+#include <vector> // for std::vector
+
+#include <gtest/gtest.h>
+
+namespace Nuclex { namespace Support { namespace Threading {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(StrandTest, CanScheduleTaskWithResult) {
+    ThreadPool testPool;
+    Strand strand(testPool);
+
+    std::future<int> result = strand.Schedule([](int a, int b) { return a * b; }, 12, 34);
+    EXPECT_EQ(result.get(), 408);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(StrandTest, ExceptionsAreDeliveredThroughFuture) {
+    ThreadPool testPool;
+    Strand strand(testPool);
+
+    std::future<void> result = strand.Schedule([] { throw std::runtime_error(u8"Hello"); });
+    EXPECT_THROW(result.get(), std::runtime_error);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(StrandTest, TasksRunInSubmissionOrder) {
+    ThreadPool testPool;
+    Strand strand(testPool);
+
+    // Not atomic on purpose, the strand guarantees tasks don't overlap
+    std::vector<std::size_t> order;
+    for(std::size_t index = 0; index < 1000; ++index) {
+      strand.Post([&order, index] { order.push_back(index); });
+    }
+    strand.Schedule([] {}).get();
+
+    ASSERT_EQ(order.size(), 1000U);
+    for(std::size_t index = 0; index < 1000; ++index) {
+      EXPECT_EQ(order[index], index);
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(StrandTest, TasksFromManyThreadsNeverOverlap) {
+    ThreadPool testPool;
+    Strand strand(testPool);
+
+    std::atomic<std::size_t> runningCount(0);
+    std::atomic<std::size_t> overlapCount(0);
+    std::size_t unprotectedCounter = 0;
+
+    std::vector<std::thread> threads;
+    for(std::size_t threadIndex = 0; threadIndex < 4; ++threadIndex) {
+      threads.emplace_back(
+        [&] {
+          for(std::size_t index = 0; index < 2500; ++index) {
+            strand.Post(
+              [&] {
+                if(runningCount.fetch_add(1) != 0) {
+                  overlapCount.fetch_add(1);
+                }
+                ++unprotectedCounter;
+                runningCount.fetch_sub(1);
+              }
+            );
+          }
+        }
+      );
+    }
+    for(std::thread &thread : threads) {
+      thread.join();
+    }
+    strand.Schedule([] {}).get();
+
+    EXPECT_EQ(overlapCount.load(), 0U);
+    EXPECT_EQ(unprotectedCounter, 10000U);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(StrandTest, CanTellWhetherRunningInStrand) {
+    ThreadPool testPool;
+    Strand strand(testPool);
+    Strand otherStrand(testPool);
+
+    EXPECT_FALSE(strand.IsRunningInThisThread());
+
+    bool isInStrand = strand.Schedule([&strand] { return strand.IsRunningInThisThread(); }).get();
+    EXPECT_TRUE(isInStrand);
+    bool isInOtherStrand = otherStrand.Schedule(
+      [&strand] { return strand.IsRunningInThisThread(); }
+    ).get();
+    EXPECT_FALSE(isInOtherStrand);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(StrandTest, TasksCanPostToTheirOwnStrand) {
+    ThreadPool testPool;
+    Strand strand(testPool);
+    Latch doneLatch(1);
+
+    std::vector<std::size_t> order;
+    strand.Post(
+      [&] {
+        order.push_back(1);
+        strand.Post([&] { order.push_back(3); doneLatch.CountDown(); });
+        order.push_back(2);
+      }
+    );
+    doneLatch.Wait();
+
+    ASSERT_EQ(order.size(), 3U);
+    EXPECT_EQ(order[0], 1U);
+    EXPECT_EQ(order[1], 2U);
+    EXPECT_EQ(order[2], 3U);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(StrandTest, ManyStrandsShareOneThreadPool) {
+    ThreadPool testPool;
+
+    const std::size_t StrandCount = 10000;
+    std::vector<std::unique_ptr<Strand>> strands;
+    std::vector<std::size_t> counters(StrandCount, 0);
+    strands.reserve(StrandCount);
+    for(std::size_t index = 0; index < StrandCount; ++index) {
+      strands.push_back(std::make_unique<Strand>(testPool));
+    }
+
+    Latch doneLatch(StrandCount);
+    for(std::size_t round = 0; round < 10; ++round) {
+      for(std::size_t index = 0; index < StrandCount; ++index) {
+        strands[index]->Post([&counters, index] { ++counters[index]; });
+      }
+    }
+    for(std::size_t index = 0; index < StrandCount; ++index) {
+      strands[index]->Post([&doneLatch] { doneLatch.CountDown(); });
+    }
+    doneLatch.Wait();
+
+    for(std::size_t index = 0; index < StrandCount; ++index) {
+      EXPECT_EQ(counters[index], 10U);
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(StrandTest, QueuedTasksSurviveStrandDestruction) {
+    ThreadPool testPool;
+    Latch doneLatch(100);
+    {
+      Strand strand(testPool);
+      for(std::size_t index = 0; index < 100; ++index) {
+        strand.Post([&doneLatch] { doneLatch.CountDown(); });
+      }
+    }
+    doneLatch.Wait();
+    SUCCEED();
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Threading
+
+#endif // defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
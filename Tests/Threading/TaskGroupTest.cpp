@@ -0,0 +1,197 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the library is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_SUPPORT_SOURCE 1
+
+#include "Nuclex/Support/Threading/TaskGroup.h"
+
+#if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+
+#include "Nuclex/Support/Threading/ThreadPool.h" // for ThreadPool
+#include "Nuclex/Support/Threading/Gate.h" // for Gate
+
+#include <atomic> // for std::atomic
+#include <stdexcept> // for std::runtime_error, std::logic_error
+#include <future> // for std::future
+#include <thread> // for std::this_thread
+#include <vector> // for std::vector
+
+#include <gtest/gtest.h>
+
+namespace Nuclex { namespace Support { namespace Threading {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(TaskGroupTest, CanWaitOnEmptyGroup) {
+    ThreadPool testPool;
+    TaskGroup group(testPool);
+    EXPECT_NO_THROW(group.Wait());
+    EXPECT_TRUE(group.GetExceptions().empty());
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(TaskGroupTest, AllTasksRunBeforeWaitReturns) {
+    ThreadPool testPool;
+    std::atomic<std::size_t> sum(0);
+
+    TaskGroup group(testPool);
+    for(std::size_t index = 1; index <= 100; ++index) {
+      group.Run([&sum](std::size_t value) { sum.fetch_add(value); }, index);
+    }
+    group.Wait();
+
+    EXPECT_EQ(sum.load(), 5050U);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(TaskGroupTest, WaitRethrowsFirstExceptionAndCollectsAll) {
+    ThreadPool testPool;
+    std::atomic<std::size_t> completedCount(0);
+
+    TaskGroup group(testPool);
+    group.Run([] { throw std::runtime_error(u8"Hello"); });
+    group.Run([&completedCount] { completedCount.fetch_add(1); });
+    group.Run([] { throw std::logic_error(u8"World"); });
+
+    EXPECT_THROW(group.Wait(), std::exception);
+    EXPECT_EQ(completedCount.load(), 1U);
+
+    std::vector<std::exception_ptr> exceptions = group.GetExceptions();
+    ASSERT_EQ(exceptions.size(), 2U);
+
+    std::size_t runtimeErrorCount = 0, logicErrorCount = 0;
+    for(const std::exception_ptr &exception : exceptions) {
+      try {
+        std::rethrow_exception(exception);
+      }
+      catch(const std::runtime_error &) {
+        ++runtimeErrorCount;
+      }
+      catch(const std::logic_error &) {
+        ++logicErrorCount;
+      }
+    }
+    EXPECT_EQ(runtimeErrorCount, 1U);
+    EXPECT_EQ(logicErrorCount, 1U);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(TaskGroupTest, WaitingThreadRunsTasksWhenPoolIsBlocked) {
+    ThreadPool testPool(1, 1);
+    Gate startedGate, releaseGate;
+
+    // Block the only worker thread of the pool
+    std::future<void> blocker = testPool.Schedule(
+      [&startedGate, &releaseGate] { startedGate.Open(); releaseGate.Wait(); }
+    );
+    startedGate.Wait();
+
+    std::atomic<std::size_t> inlineCount(0);
+    std::thread::id waitingThreadId = std::this_thread::get_id();
+    {
+      TaskGroup group(testPool);
+      for(std::size_t index = 0; index < 10; ++index) {
+        group.Run(
+          [&inlineCount, waitingThreadId] {
+            if(std::this_thread::get_id() == waitingThreadId) {
+              inlineCount.fetch_add(1);
+            }
+          }
+        );
+      }
+      group.Wait();
+    }
+
+    EXPECT_EQ(inlineCount.load(), 10U);
+
+    releaseGate.Open();
+    blocker.get();
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(TaskGroupTest, NestedGroupsDoNotStarveSingleThreadedPool) {
+    ThreadPool testPool(1, 1);
+    std::atomic<std::size_t> leafCount(0);
+
+    // Each outer task waits for an inner group from within the only worker thread.
+    // With futures, this would deadlock as soon as the worker waits on itself.
+    TaskGroup outerGroup(testPool);
+    for(std::size_t outerIndex = 0; outerIndex < 4; ++outerIndex) {
+      outerGroup.Run(
+        [&testPool, &leafCount] {
+          TaskGroup innerGroup(testPool);
+          for(std::size_t innerIndex = 0; innerIndex < 8; ++innerIndex) {
+            innerGroup.Run([&leafCount] { leafCount.fetch_add(1); });
+          }
+          innerGroup.Wait();
+        }
+      );
+    }
+    outerGroup.Wait();
+
+    EXPECT_EQ(leafCount.load(), 32U);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(TaskGroupTest, TasksCanAddMoreTasksToTheirGroup) {
+    ThreadPool testPool;
+    std::atomic<std::size_t> runCount(0);
+
+    TaskGroup group(testPool);
+    for(std::size_t index = 0; index < 4; ++index) {
+      group.Run(
+        [&group, &runCount] {
+          runCount.fetch_add(1);
+          for(std::size_t childIndex = 0; childIndex < 4; ++childIndex) {
+            group.Run([&runCount] { runCount.fetch_add(1); });
+          }
+        }
+      );
+    }
+    group.Wait();
+
+    EXPECT_EQ(runCount.load(), 20U);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(TaskGroupTest, DestructorWaitsForTasks) {
+    ThreadPool testPool;
+    std::atomic<std::size_t> runCount(0);
+    {
+      TaskGroup group(testPool);
+      for(std::size_t index = 0; index < 16; ++index) {
+        group.Run([&runCount] { runCount.fetch_add(1); });
+      }
+      group.Run([] { throw std::runtime_error(u8"Discarded"); });
+    }
+    EXPECT_EQ(runCount.load(), 16U);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Threading
+
+#endif // defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
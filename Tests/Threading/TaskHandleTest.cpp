@@ -0,0 +1,267 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the library is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_SUPPORT_SOURCE 1
+
+#include "Nuclex/Support/Threading/TaskHandle.h"
+
+#if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+
+#include "Nuclex/Support/Threading/ThreadPool.h" // for ThreadPool
+#include "Nuclex/Support/Threading/Gate.h" // for Gate
+
+#include <atomic> // for std::atomic
+#include <vector> // for std::vector
+#include <stdexcept> // for std::underflow_error, std::invalid_argument
+#include <future> // for std::future_error
+#include <memory> // for std::unique_ptr
+
+#include <gtest/gtest.h>
+
+namespace Nuclex { namespace Support { namespace Threading {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(TaskHandleTest, DefaultConstructedHandleIsInvalid) {
+    TaskHandle handle;
+    EXPECT_FALSE(handle.IsValid());
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(TaskHandleTest, EmptyHandleThrowsInvalidArgument) {
+    TaskHandle handle;
+    EXPECT_THROW(handle.IsCompleted(), std::invalid_argument);
+    EXPECT_THROW(handle.Wait(), std::invalid_argument);
+    EXPECT_THROW(handle.WaitFor(std::chrono::microseconds(1)), std::invalid_argument);
+    EXPECT_THROW(handle.Get(), std::invalid_argument);
+    EXPECT_THROW(handle.Then([]() {}), std::invalid_argument);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(TaskHandleTest, JoiningEmptyHandlesThrowsInvalidArgument) {
+    ThreadPool testPool;
+    TaskHandle task = testPool.Spawn([]() {});
+
+    EXPECT_THROW(TaskHandle::WhenAll({ task, TaskHandle() }), std::invalid_argument);
+    EXPECT_THROW(TaskHandle::WhenAny({ TaskHandle(), task }), std::invalid_argument);
+
+    task.Wait();
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(TaskHandleTest, WhenAnyOfNothingThrowsInvalidArgument) {
+    EXPECT_THROW(TaskHandle::WhenAny(std::vector<TaskHandle>()), std::invalid_argument);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(TaskHandleTest, SpawnedTaskRuns) {
+    ThreadPool testPool;
+    std::atomic<int> result(0);
+
+    TaskHandle handle = testPool.Spawn(
+      [&result](int a, int b) { result.store(a * b); }, 12, 34
+    );
+    ASSERT_TRUE(handle.IsValid());
+    handle.Get();
+
+    EXPECT_TRUE(handle.IsCompleted());
+    EXPECT_EQ(result.load(), 408);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(TaskHandleTest, ContinuationRunsAfterTask) {
+    ThreadPool testPool;
+    Gate startGate;
+    std::atomic<int> step(0);
+    std::atomic<int> stepSeenByContinuation(-1);
+
+    TaskHandle first = testPool.Spawn(
+      [&]() { startGate.Wait(); step.store(1); }
+    );
+    TaskHandle second = first.Then(
+      [&]() { stepSeenByContinuation.store(step.load()); }
+    );
+
+    EXPECT_FALSE(second.WaitFor(std::chrono::microseconds(10000)));
+    startGate.Open();
+    second.Get();
+
+    EXPECT_EQ(stepSeenByContinuation.load(), 1);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(TaskHandleTest, TaskCanHaveManyContinuations) {
+    ThreadPool testPool;
+    Gate startGate;
+    std::atomic<int> runCount(0);
+
+    TaskHandle first = testPool.Spawn([&startGate]() { startGate.Wait(); });
+
+    std::vector<TaskHandle> continuations;
+    for(std::size_t index = 0; index < 8; ++index) {
+      continuations.push_back(first.Then([&runCount]() { ++runCount; }));
+    }
+    startGate.Open();
+
+    // Also attach some continuations after the task has completed
+    first.Wait();
+    for(std::size_t index = 0; index < 8; ++index) {
+      continuations.push_back(first.Then([&runCount]() { ++runCount; }));
+    }
+
+    TaskHandle::WhenAll(continuations).Get();
+    EXPECT_EQ(runCount.load(), 16);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(TaskHandleTest, ContinuationOfCompletedTaskRunsImmediately) {
+    ThreadPool testPool;
+    std::atomic<int> runCount(0);
+
+    TaskHandle first = testPool.Spawn([&runCount]() { ++runCount; });
+    first.Wait();
+
+    TaskHandle second = first.Then([&runCount]() { ++runCount; });
+    second.Get();
+
+    EXPECT_EQ(runCount.load(), 2);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(TaskHandleTest, WhenAllWaitsForAllTasks) {
+    ThreadPool testPool;
+    Gate startGate;
+    std::atomic<int> completedCount(0);
+
+    std::vector<TaskHandle> tasks;
+    for(std::size_t index = 0; index < 8; ++index) {
+      tasks.push_back(
+        testPool.Spawn([&]() { startGate.Wait(); ++completedCount; })
+      );
+    }
+
+    TaskHandle all = TaskHandle::WhenAll(tasks);
+    EXPECT_FALSE(all.IsCompleted());
+
+    startGate.Open();
+    all.Get();
+    EXPECT_EQ(completedCount.load(), 8);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(TaskHandleTest, WhenAllOfNothingIsCompleted) {
+    TaskHandle all = TaskHandle::WhenAll(std::vector<TaskHandle>());
+    EXPECT_TRUE(all.IsCompleted());
+    EXPECT_NO_THROW(all.Get());
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(TaskHandleTest, WhenAnyCompletesWithFirstTask) {
+    ThreadPool testPool;
+    Gate blockingGate;
+
+    TaskHandle slow = testPool.Spawn([&blockingGate]() { blockingGate.Wait(); });
+    TaskHandle fast = testPool.Spawn([]() {});
+
+    TaskHandle any = TaskHandle::WhenAny({ slow, fast });
+    any.Get();
+    EXPECT_FALSE(slow.IsCompleted());
+
+    blockingGate.Open();
+    slow.Wait();
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(TaskHandleTest, ExceptionsPropagateThroughContinuations) {
+    ThreadPool testPool;
+    std::atomic<bool> continuationRan(false);
+
+    TaskHandle failing = testPool.Spawn(
+      []() { throw std::underflow_error(u8"Hur dur, I'm an underflow error"); }
+    );
+    TaskHandle continuation = failing.Then([&continuationRan]() { continuationRan = true; });
+    TaskHandle joined = TaskHandle::WhenAll({ continuation, testPool.Spawn([]() {}) });
+
+    EXPECT_THROW(failing.Get(), std::underflow_error);
+    EXPECT_THROW(continuation.Get(), std::underflow_error);
+    EXPECT_THROW(joined.Get(), std::underflow_error);
+    EXPECT_FALSE(continuationRan.load());
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(TaskHandleTest, LargeTaskGraphCompletesOnSingleThread) {
+    ThreadPool testPool(1, 1);
+    std::atomic<std::size_t> executedCount(0);
+
+    // Build layers of tasks where each task depends on the whole previous layer.
+    // With only one worker thread, any task blocking on another would deadlock.
+    std::vector<TaskHandle> previousLayer;
+    previousLayer.push_back(testPool.Spawn([&executedCount]() { ++executedCount; }));
+    for(std::size_t layer = 0; layer < 100; ++layer) {
+      TaskHandle join = TaskHandle::WhenAll(previousLayer);
+
+      std::vector<TaskHandle> currentLayer;
+      for(std::size_t index = 0; index < 10; ++index) {
+        currentLayer.push_back(join.Then([&executedCount]() { ++executedCount; }));
+      }
+      previousLayer.swap(currentLayer);
+    }
+
+    TaskHandle::WhenAll(previousLayer).Get();
+    EXPECT_EQ(executedCount.load(), 1001U);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(TaskHandleTest, ShutdownCancelsPendingTasks) {
+    Gate blockingGate;
+    TaskHandle blocking, pending;
+    {
+      ThreadPool testPool(1, 1);
+
+      blocking = testPool.Spawn([&blockingGate]() { blockingGate.Wait(); });
+      pending = testPool.Spawn([]() {});
+
+      blockingGate.Open();
+    }
+
+    // The pending task was either run before the thread pool shut down or canceled,
+    // either way, it must be completed and not leave anyone waiting
+    EXPECT_TRUE(blocking.IsCompleted());
+    EXPECT_TRUE(pending.IsCompleted());
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Threading
+
+#endif // defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
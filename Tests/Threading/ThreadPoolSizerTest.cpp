@@ -0,0 +1,171 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the library is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_SUPPORT_SOURCE 1
+
+#include "../Source/Threading/ThreadPoolSizer.h"
+
+#if defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
+
+#include <gtest/gtest.h>
+
+namespace {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Builds a sample of the thread pool's load</summary>
+  /// <param name="threadCount">Number of running threads</param>
+  /// <param name="queuedTaskCount">Number of tasks waiting in the queue</param>
+  /// <param name="completedTaskCount">Tasks completed during the sample interval</param>
+  /// <param name="blockedThreadCount">Number of worker threads stuck in a task</param>
+  /// <returns>A sample for a 10 millisecond interval with all threads busy</returns>
+  Nuclex::Support::Threading::ThreadPoolSizer::Sample makeSample(
+    std::size_t threadCount,
+    std::size_t queuedTaskCount,
+    std::size_t completedTaskCount,
+    std::size_t blockedThreadCount = 0
+  ) {
+    Nuclex::Support::Threading::ThreadPoolSizer::Sample sample;
+    sample.ThreadCount = threadCount;
+    sample.BusyThreadCount = threadCount;
+    sample.BlockedThreadCount = blockedThreadCount;
+    sample.QueuedTaskCount = queuedTaskCount;
+    sample.CompletedTaskCount = completedTaskCount;
+    sample.Elapsed = std::chrono::microseconds(10000);
+    return sample;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // anonymous namespace
+
+namespace Nuclex { namespace Support { namespace Threading {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ThreadPoolSizerTest, DoesNothingWithoutBacklog) {
+    ThreadPoolSizer sizer(1, 16);
+    ThreadPool::SizingOptions options;
+
+    EXPECT_EQ(sizer.Evaluate(makeSample(4, 0, 0), options), 0);
+    EXPECT_EQ(sizer.Evaluate(makeSample(4, 0, 10000), options), 0);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ThreadPoolSizerTest, StarvedPoolGrowsQuickly) {
+    ThreadPoolSizer sizer(1, 16);
+    ThreadPool::SizingOptions options;
+
+    // Nothing completed while tasks were waiting, thread count doubles
+    EXPECT_EQ(sizer.Evaluate(makeSample(2, 100, 0), options), 2);
+    EXPECT_EQ(sizer.Evaluate(makeSample(4, 100, 0), options), 4);
+
+    // But never by more threads than there are tasks waiting
+    EXPECT_EQ(sizer.Evaluate(makeSample(8, 3, 0), options), 3);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ThreadPoolSizerTest, GrowthRespectsMaximumThreadCount) {
+    ThreadPoolSizer sizer(1, 6);
+    ThreadPool::SizingOptions options;
+
+    EXPECT_EQ(sizer.Evaluate(makeSample(4, 100, 0), options), 2);
+    EXPECT_EQ(sizer.Evaluate(makeSample(6, 100, 0), options), 0);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ThreadPoolSizerTest, BlockedWorkersAreCompensated) {
+    ThreadPoolSizer sizer(1, 16);
+    ThreadPool::SizingOptions options;
+
+    // Tasks are flowing fast enough (4 tasks at 1 task per microsecond), but two of
+    // the workers are stuck, so two more threads should be added
+    EXPECT_EQ(sizer.Evaluate(makeSample(4, 4, 10000, 2), options), 2);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ThreadPoolSizerTest, HillClimbingKeepsHelpfulThreads) {
+    ThreadPoolSizer sizer(1, 16);
+    ThreadPool::SizingOptions options;
+
+    // First sample under a steady backlog only establishes the baseline
+    EXPECT_EQ(sizer.Evaluate(makeSample(4, 4, 10000), options), 0);
+
+    // Then a thread is added to see whether it helps, and it does
+    EXPECT_EQ(sizer.Evaluate(makeSample(4, 4, 10000), options), 1);
+    EXPECT_EQ(sizer.Evaluate(makeSample(5, 4, 12000), options), 1);
+    EXPECT_EQ(sizer.Evaluate(makeSample(6, 4, 14000), options), 1);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ThreadPoolSizerTest, HillClimbingRevertsUselessThreads) {
+    ThreadPoolSizer sizer(1, 16);
+    ThreadPool::SizingOptions options;
+
+    EXPECT_EQ(sizer.Evaluate(makeSample(4, 4, 10000), options), 0);
+    EXPECT_EQ(sizer.Evaluate(makeSample(4, 4, 10000), options), 1);
+
+    // The added thread didn't improve throughput, so it gets removed again
+    EXPECT_EQ(sizer.Evaluate(makeSample(5, 4, 10000), options), -1);
+
+    // After that, the sizer holds still for a while rather than oscillating
+    for(std::size_t index = 0; index < ThreadPoolSizer::HoldSampleCount + 1; ++index) {
+      EXPECT_EQ(sizer.Evaluate(makeSample(4, 4, 10000), options), 0);
+    }
+
+    // Eventually, it probes again
+    EXPECT_EQ(sizer.Evaluate(makeSample(4, 4, 10000), options), 1);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ThreadPoolSizerTest, NeverShrinksBelowMinimumThreadCount) {
+    ThreadPoolSizer sizer(5, 5);
+    ThreadPool::SizingOptions options;
+
+    EXPECT_EQ(sizer.Evaluate(makeSample(5, 4, 10000), options), 0);
+    EXPECT_EQ(sizer.Evaluate(makeSample(5, 4, 10000), options), 0);
+    EXPECT_EQ(sizer.Evaluate(makeSample(5, 4, 10000), options), 0);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ThreadPoolSizerTest, QueueDelayThresholdCanBeTuned) {
+    ThreadPoolSizer sizer(1, 16);
+    ThreadPool::SizingOptions options;
+
+    // 400 tasks waiting at 1 task per microsecond is 400 microseconds of delay,
+    // which is fine by the default threshold but not by a stricter one.
+    EXPECT_EQ(sizer.Evaluate(makeSample(4, 400, 10000), options), 0);
+
+    options.QueueDelayThreshold = std::chrono::microseconds(100);
+    EXPECT_EQ(sizer.Evaluate(makeSample(4, 400, 10000), options), 4);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Threading
+
+#endif // defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
@@ -168,19 +168,14 @@ namespace Nuclex { namespace Support { namespace Threading {
       EXPECT_EQ(TestTask::ConstructorCallCount, previousConstructorCallCount + 1);
       EXPECT_EQ(TestTask::DestructorCallCount, previousDestructorCallCount);
 
-      TestTask *anotherTask = taskPool.GetNewTask(32);
+      // A payload of this size falls into a larger size class than the original task
+      TestTask *anotherTask = taskPool.GetNewTask(TestTaskPool::SizeClassGranularity * 2);
 
       EXPECT_EQ(TestTask::ConstructorCallCount, previousConstructorCallCount + 2);
-      //EXPECT_EQ(TestTask::DestructorCallCount, previousDestructorCallCount);
+      EXPECT_EQ(TestTask::DestructorCallCount, previousDestructorCallCount);
 
-      // Originally, I tested like this:
-      // EXPECT_NE(anotherTask, originalTask);
-      //
-      // but GetNewTask() calls free upon encountering the 16 byte payload task,
-      // and the C++ memory allocator then can allocate the 32 byte payload task
-      // at the exact same memory address. This caused spurious failures.
-      //
-      EXPECT_EQ(anotherTask->PayloadSize, 32U);
+      EXPECT_NE(anotherTask, originalTask);
+      EXPECT_EQ(anotherTask->PayloadSize, TestTaskPool::SizeClassGranularity * 2);
 
       taskPool.DeleteTask(anotherTask);
     }
@@ -247,4 +242,62 @@ namespace Nuclex { namespace Support { namespace Threading {
 
   // ------------------------------------------------------------------------------------------- //
 
+  TEST(ThreadPoolTaskPoolTest, TasksOfTheSameSizeClassAreInterchangeable) {
+    TestTaskPool taskPool;
+
+    {
+      std::lock_guard callCountScope(CallCountMutex);
+
+      std::size_t previousConstructorCallCount = TestTask::ConstructorCallCount;
+
+      // Both payload sizes fit into the first size class
+      TestTask *smallTask = taskPool.GetNewTask(4);
+      taskPool.ReturnTask(smallTask);
+
+      TestTask *largerTask = taskPool.GetNewTask(TestTaskPool::SizeClassGranularity / 2);
+      EXPECT_EQ(TestTask::ConstructorCallCount, previousConstructorCallCount + 1);
+      EXPECT_EQ(largerTask, smallTask);
+      EXPECT_EQ(largerTask->PayloadSize, TestTaskPool::SizeClassGranularity / 2);
+
+      taskPool.DeleteTask(largerTask);
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ThreadPoolTaskPoolTest, ShardsReachSteadyStateWithoutAllocations) {
+    TestTaskPool taskPool(2);
+
+    // Mixed payload sizes taken and returned through a shard, more than a shard holds
+    const std::size_t payloadSizes[] = { 8, 40, 100, 180, 24, 64 };
+    const std::size_t BatchSize = ThreadPoolConfig::SubmittedTaskCacheSize * 3;
+    TestTask *tasks[BatchSize];
+
+    for(std::size_t round = 0; round < 10; ++round) {
+      std::size_t allocationCountBefore = taskPool.CountAllocations();
+
+      for(std::size_t index = 0; index < BatchSize; ++index) {
+        tasks[index] = taskPool.GetNewTask(payloadSizes[index % 6], 0);
+      }
+      for(std::size_t index = 0; index < BatchSize; ++index) {
+        taskPool.ReturnTask(tasks[index], 0);
+      }
+
+      // After the first round, the overflow in the shared queue covers the rest
+      if(round >= 1) {
+        EXPECT_EQ(taskPool.CountAllocations(), allocationCountBefore);
+      }
+    }
+
+    // Tasks spilled to the shared queue are available to other threads, too
+    std::size_t allocationCountBefore = taskPool.CountAllocations();
+    TestTask *sharedTask = taskPool.GetNewTask(8);
+    TestTask *otherShardTask = taskPool.GetNewTask(8, 1);
+    EXPECT_EQ(taskPool.CountAllocations(), allocationCountBefore);
+    taskPool.ReturnTask(sharedTask);
+    taskPool.ReturnTask(otherShardTask, 1);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
 }}} // namespace Nuclex::Support::Threading
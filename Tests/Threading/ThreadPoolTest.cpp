@@ -26,8 +26,15 @@ limitations under the License.
 
 #include "Nuclex/Support/Threading/Thread.h" // for Thread
 #include "Nuclex/Support/Threading/Gate.h" // for Gate
+#include "Nuclex/Support/Threading/Latch.h" // for Latch
+#include "Nuclex/Support/Threading/CpuTopology.h" // for CpuTopology
+#include "Nuclex/Support/Threading/StopSource.h" // for StopSource
 
 #include <memory> // for std::unique_ptr
+#include <atomic> // for std::atomic
+#include <vector> // for std::vector
+#include <algorithm> // for std::sort(), std::max()
+#include <thread> // for std::thread
 
 #include <gtest/gtest.h>
 
@@ -204,6 +211,713 @@ namespace Nuclex { namespace Support { namespace Threading {
 
   // ------------------------------------------------------------------------------------------- //
 
+  TEST(ThreadPoolTest, TasksCanScheduleMoreTasks) {
+    ThreadPool testPool(1, 4);
+
+    const std::size_t ParentTaskCount = 8;
+    const std::size_t ChildTaskCount = 250;
+
+    std::atomic<std::size_t> executedChildCount(0);
+    Latch remainingTasks(ParentTaskCount * ChildTaskCount);
+
+    // Each parent task schedules a bunch of child tasks from within the thread pool.
+    // These go into the worker thread's own deque where other threads can steal them.
+    for(std::size_t parent = 0; parent < ParentTaskCount; ++parent) {
+      testPool.Schedule(
+        [&testPool, &executedChildCount, &remainingTasks] {
+          for(std::size_t child = 0; child < ChildTaskCount; ++child) {
+            testPool.Schedule(
+              [&executedChildCount, &remainingTasks] {
+                executedChildCount.fetch_add(1, std::memory_order_relaxed);
+                remainingTasks.CountDown();
+              }
+            );
+          }
+        }
+      );
+    }
+
+    ASSERT_TRUE(remainingTasks.WaitFor(std::chrono::seconds(10)));
+    EXPECT_EQ(executedChildCount.load(), ParentTaskCount * ChildTaskCount);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ThreadPoolTest, ShutdownCancelsTasksScheduledByWorkerThreads) {
+    std::future<int> canceledFuture;
+    {
+      Gate childScheduled;
+      ThreadPool testPool(1, 1);
+
+      // The only worker thread schedules a task into its own deque and then blocks
+      // so that the child task is still waiting when the thread pool is destroyed.
+      testPool.Schedule(
+        [&testPool, &canceledFuture, &childScheduled] {
+          canceledFuture = testPool.Schedule(&testMethod, 12, 34);
+          childScheduled.Open();
+          slowMethod();
+        }
+      );
+
+      childScheduled.Wait();
+    }
+
+    EXPECT_THROW(
+      {
+        int result = canceledFuture.get();
+        (void)result;
+      },
+      std::future_error
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ThreadPoolTest, CanPostTasks) {
+    ThreadPool testPool;
+
+    std::atomic<int> result(0);
+    Gate finishedGate;
+
+    testPool.Post(
+      [&result, &finishedGate](int a, int b) {
+        result.store(testMethod(a, b));
+        finishedGate.Open();
+      },
+      12, 34
+    );
+
+    finishedGate.Wait();
+    EXPECT_EQ(result.load(), 362);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ThreadPoolTest, PostedTasksCanTakeMoveOnlyArguments) {
+    ThreadPool testPool;
+
+    int result = 0;
+    Gate finishedGate;
+
+    testPool.Post(
+      [&result, &finishedGate](std::unique_ptr<int> value) {
+        result = *value;
+        finishedGate.Open();
+      },
+      std::make_unique<int>(42)
+    );
+
+    finishedGate.Wait();
+    EXPECT_EQ(result, 42);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ThreadPoolTest, ShutdownDestroysPostedTasks) {
+    std::shared_ptr<int> sharedValue = std::make_shared<int>(123);
+    bool wasCalled = false;
+    {
+      std::unique_ptr<ThreadPool> testPool = std::make_unique<ThreadPool>(1, 1);
+
+      // Block the only worker thread, then post a task holding a reference
+      // to our shared value that will be canceled during shutdown
+      testPool->Schedule(&slowMethod);
+      testPool->Post(
+        [&wasCalled](std::shared_ptr<int>) { wasCalled = true; },
+        sharedValue
+      );
+      EXPECT_EQ(sharedValue.use_count(), 2);
+
+      testPool.reset();
+    }
+
+    EXPECT_FALSE(wasCalled);
+    EXPECT_EQ(sharedValue.use_count(), 1);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ThreadPoolTest, CanPostTasksInBulk) {
+    ThreadPool testPool;
+
+    const std::size_t TaskCount = 1000;
+    std::vector<std::atomic<std::size_t>> callCounts(TaskCount);
+    Latch remainingTasks(TaskCount);
+
+    testPool.PostBulk(
+      TaskCount,
+      [&callCounts, &remainingTasks](std::size_t index) {
+        callCounts[index].fetch_add(1, std::memory_order_relaxed);
+        remainingTasks.CountDown();
+      }
+    );
+
+    ASSERT_TRUE(remainingTasks.WaitFor(std::chrono::seconds(10)));
+    for(std::size_t index = 0; index < TaskCount; ++index) {
+      EXPECT_EQ(callCounts[index].load(), 1U);
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ThreadPoolTest, ParallelForProcessesEachIndexOnce) {
+    ThreadPool testPool;
+
+    std::vector<std::atomic<std::size_t>> callCounts(10000);
+    testPool.ParallelFor(
+      100, 9900, 16,
+      [&callCounts](std::size_t begin, std::size_t end) {
+        EXPECT_LT(begin, end);
+        for(std::size_t index = begin; index < end; ++index) {
+          callCounts[index].fetch_add(1, std::memory_order_relaxed);
+        }
+      }
+    );
+
+    for(std::size_t index = 0; index < callCounts.size(); ++index) {
+      if((index < 100) || (index >= 9900)) {
+        EXPECT_EQ(callCounts[index].load(), 0U);
+      } else {
+        EXPECT_EQ(callCounts[index].load(), 1U);
+      }
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ThreadPoolTest, ParallelForRethrowsException) {
+    ThreadPool testPool;
+
+    EXPECT_THROW(
+      testPool.ParallelFor(
+        0, 1000, 10,
+        [](std::size_t begin, std::size_t end) {
+          if((begin <= 500) && (end > 500)) {
+            throw std::underflow_error(u8"Hur dur, I'm an underflow error");
+          }
+        }
+      ),
+      std::underflow_error
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ThreadPoolTest, ParallelForCanBeUsedFromWorkerThread) {
+    ThreadPool testPool(1, 1);
+
+    // With a single worker thread, the nested ParallelFor() can only complete
+    // because the calling thread processes the range itself
+    std::future<std::size_t> sum = testPool.Schedule(
+      [&testPool]() {
+        std::atomic<std::size_t> total(0);
+        testPool.ParallelFor(
+          0, 1000, 1,
+          [&total](std::size_t begin, std::size_t end) {
+            for(std::size_t index = begin; index < end; ++index) {
+              total.fetch_add(index, std::memory_order_relaxed);
+            }
+          }
+        );
+        return total.load();
+      }
+    );
+
+    ASSERT_EQ(sum.wait_for(std::chrono::seconds(10)), std::future_status::ready);
+    EXPECT_EQ(sum.get(), 499500U);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ThreadPoolTest, HigherPriorityTasksRunFirst) {
+    ThreadPool testPool(1, 1);
+
+    // Block the only worker thread so that the tasks pile up in their lanes
+    Gate blockerStarted, releaseBlocker;
+    testPool.Post(
+      [&blockerStarted, &releaseBlocker] {
+        blockerStarted.Open();
+        releaseBlocker.Wait();
+      }
+    );
+    blockerStarted.Wait();
+
+    std::vector<int> executionOrder;
+    Latch remainingTasks(3);
+    testPool.PostWithPriority(
+      ThreadPool::Priority::Low,
+      [&executionOrder, &remainingTasks] {
+        executionOrder.push_back(3);
+        remainingTasks.CountDown();
+      }
+    );
+    testPool.PostWithPriority(
+      ThreadPool::Priority::Normal,
+      [&executionOrder, &remainingTasks] {
+        executionOrder.push_back(2);
+        remainingTasks.CountDown();
+      }
+    );
+    testPool.PostWithPriority(
+      ThreadPool::Priority::High,
+      [&executionOrder, &remainingTasks] {
+        executionOrder.push_back(1);
+        remainingTasks.CountDown();
+      }
+    );
+
+    releaseBlocker.Open();
+    ASSERT_TRUE(remainingTasks.WaitFor(std::chrono::seconds(10)));
+
+    ASSERT_EQ(executionOrder.size(), 3U);
+    EXPECT_EQ(executionOrder[0], 1);
+    EXPECT_EQ(executionOrder[1], 2);
+    EXPECT_EQ(executionOrder[2], 3);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ThreadPoolTest, LowPriorityTasksDoNotStarve) {
+    ThreadPool testPool(1, 1);
+
+    Gate blockerStarted, releaseBlocker;
+    testPool.Post(
+      [&blockerStarted, &releaseBlocker] {
+        blockerStarted.Open();
+        releaseBlocker.Wait();
+      }
+    );
+    blockerStarted.Wait();
+
+    // Queue a low priority task behind a wall of high priority tasks
+    const std::size_t HighPriorityTaskCount = 200;
+    std::size_t executedTaskCount = 0;
+    std::size_t lowPriorityTaskPosition = 0;
+    Latch remainingTasks(HighPriorityTaskCount + 1);
+    testPool.PostWithPriority(
+      ThreadPool::Priority::Low,
+      [&executedTaskCount, &lowPriorityTaskPosition, &remainingTasks] {
+        lowPriorityTaskPosition = executedTaskCount++;
+        remainingTasks.CountDown();
+      }
+    );
+    for(std::size_t index = 0; index < HighPriorityTaskCount; ++index) {
+      testPool.PostWithPriority(
+        ThreadPool::Priority::High,
+        [&executedTaskCount, &remainingTasks] {
+          ++executedTaskCount;
+          remainingTasks.CountDown();
+        }
+      );
+    }
+
+    releaseBlocker.Open();
+    ASSERT_TRUE(remainingTasks.WaitFor(std::chrono::seconds(10)));
+
+    // Because the lanes are checked in reverse every few tasks, the low priority
+    // task gets its turn long before the high priority lane runs dry
+    EXPECT_LT(lowPriorityTaskPosition, 20U);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ThreadPoolTest, HighPriorityLatencyStaysLowUnderBackgroundSaturation) {
+    ThreadPool testPool(2, 2);
+
+    // Saturate the thread pool with background work that would take
+    // at least half a second to get through
+    const std::size_t BackgroundTaskCount = 1000;
+    for(std::size_t index = 0; index < BackgroundTaskCount; ++index) {
+      testPool.PostWithPriority(
+        ThreadPool::Priority::Low,
+        [] { Thread::Sleep(std::chrono::milliseconds(1)); }
+      );
+    }
+
+    // Now measure how long high priority tasks have to wait before they are executed
+    const std::size_t SampleCount = 50;
+    std::vector<std::chrono::steady_clock::duration> latencies(SampleCount);
+    Latch remainingSamples(SampleCount);
+    for(std::size_t index = 0; index < SampleCount; ++index) {
+      std::chrono::steady_clock::time_point submissionTime = std::chrono::steady_clock::now();
+      testPool.PostWithPriority(
+        ThreadPool::Priority::High,
+        [&latencies, &remainingSamples, index, submissionTime] {
+          latencies[index] = std::chrono::steady_clock::now() - submissionTime;
+          remainingSamples.CountDown();
+        }
+      );
+      Thread::Sleep(std::chrono::milliseconds(2));
+    }
+    ASSERT_TRUE(remainingSamples.WaitFor(std::chrono::seconds(10)));
+
+    // Behind a single FIFO, the p99 latency would be hundreds of milliseconds. With
+    // the priority lanes, a high priority task only waits for a worker to finish its
+    // current task. The limit is very generous to tolerate slow or overloaded machines.
+    std::sort(latencies.begin(), latencies.end());
+    std::chrono::steady_clock::duration p99Latency = latencies[(SampleCount * 99) / 100];
+    EXPECT_LT(p99Latency, std::chrono::milliseconds(100));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ThreadPoolTest, NumaModeRunsTasksOnNodeCpus) {
+    ThreadPool testPool(2, 4, ThreadPool::NumaMode::PinnedPerNode);
+    CpuTopology topology = CpuTopology::Query();
+
+    const std::size_t ParentTaskCount = 8;
+    const std::size_t ChildTaskCount = 100;
+
+    std::atomic<std::size_t> tasksOutsideOfNode(0);
+    Latch remainingTasks(ParentTaskCount * ChildTaskCount);
+
+    // Each worker thread should be pinned to the CPUs of exactly one NUMA node
+    auto checkAffinity = [&topology, &tasksOutsideOfNode] {
+      CpuSet affinity = Thread::GetCpuAffinity();
+      bool isWithinOneNode = false;
+      for(std::size_t index = 0; index < topology.CountNumaNodes(); ++index) {
+        if((affinity & topology.GetNumaNodeCpus(index)) == affinity) {
+          isWithinOneNode = true;
+        }
+      }
+      if(!isWithinOneNode) {
+        tasksOutsideOfNode.fetch_add(1, std::memory_order_relaxed);
+      }
+    };
+
+    for(std::size_t parent = 0; parent < ParentTaskCount; ++parent) {
+      testPool.Schedule(
+        [&testPool, &remainingTasks, &checkAffinity] {
+          for(std::size_t child = 0; child < ChildTaskCount; ++child) {
+            testPool.Post(
+              [&remainingTasks, &checkAffinity] {
+                checkAffinity();
+                remainingTasks.CountDown();
+              }
+            );
+          }
+        }
+      );
+    }
+
+    ASSERT_TRUE(remainingTasks.WaitFor(std::chrono::seconds(10)));
+    EXPECT_EQ(tasksOutsideOfNode.load(), 0U);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ThreadPoolTest, SizingOptionsCanBeChanged) {
+    ThreadPool testPool(1, 4);
+
+    ThreadPool::SizingOptions options = testPool.GetSizingOptions();
+    options.SampleInterval = std::chrono::microseconds(2000);
+    options.QueueDelayThreshold = std::chrono::microseconds(3000);
+    options.BlockedWorkerThreshold = std::chrono::microseconds(4000);
+    options.IdleShutDownDelay = std::chrono::microseconds(5000);
+    options.ThroughputGainThreshold = 0.25f;
+    testPool.SetSizingOptions(options);
+
+    ThreadPool::SizingOptions changedOptions = testPool.GetSizingOptions();
+    EXPECT_EQ(changedOptions.SampleInterval.count(), 2000);
+    EXPECT_EQ(changedOptions.QueueDelayThreshold.count(), 3000);
+    EXPECT_EQ(changedOptions.BlockedWorkerThreshold.count(), 4000);
+    EXPECT_EQ(changedOptions.IdleShutDownDelay.count(), 5000);
+    EXPECT_EQ(changedOptions.ThroughputGainThreshold, 0.25f);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ThreadPoolTest, ThreadPoolGrowsWhenAllWorkersAreBlocked) {
+    ThreadPool testPool(1, 4);
+    Latch allTasksRunning(4);
+
+    // Each task waits until all four tasks are running at the same time. The thread pool
+    // starts with a single thread, so this only completes if the pool notices that its
+    // worker threads are blocked and tasks are piling up.
+    std::atomic<std::size_t> completedTaskCount(0);
+    for(std::size_t index = 0; index < 4; ++index) {
+      testPool.Post(
+        [&allTasksRunning, &completedTaskCount] {
+          allTasksRunning.CountDown();
+          if(allTasksRunning.WaitFor(std::chrono::seconds(10))) {
+            completedTaskCount.fetch_add(1, std::memory_order_relaxed);
+          }
+        }
+      );
+    }
+
+    EXPECT_TRUE(allTasksRunning.WaitFor(std::chrono::seconds(10)));
+    while(completedTaskCount.load(std::memory_order_relaxed) < 4) {
+      Thread::Sleep(std::chrono::microseconds(1000));
+    }
+    EXPECT_EQ(completedTaskCount.load(), 4U);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ThreadPoolTest, StatisticsCountCompletedTasks) {
+    ThreadPool testPool(2, 2);
+
+    ThreadPool::Statistics statistics = testPool.GetStatistics();
+    EXPECT_EQ(statistics.CompletedTaskCount, 0U);
+    EXPECT_EQ(statistics.QueuedTaskCount, 0U);
+    EXPECT_EQ(statistics.RunningTaskCount, 0U);
+
+    const std::size_t TaskCount = 64;
+    std::atomic<std::size_t> executedTaskCount(0);
+    for(std::size_t index = 0; index < TaskCount; ++index) {
+      testPool.Post(
+        [&executedTaskCount] { executedTaskCount.fetch_add(1, std::memory_order_relaxed); }
+      );
+    }
+
+    // The counters are updated after the task returns, so wait for them to catch up
+    for(std::size_t attempt = 0; attempt < 1000; ++attempt) {
+      statistics = testPool.GetStatistics();
+      if(statistics.CompletedTaskCount >= TaskCount) {
+        break;
+      }
+      Thread::Sleep(std::chrono::microseconds(1000));
+    }
+
+    EXPECT_EQ(executedTaskCount.load(), TaskCount);
+    EXPECT_EQ(statistics.CompletedTaskCount, TaskCount);
+    EXPECT_EQ(statistics.QueuedTaskCount, 0U);
+    EXPECT_EQ(statistics.RunningTaskCount, 0U);
+    EXPECT_GE(statistics.ThreadCount, 1U);
+    EXPECT_EQ(
+      statistics.TaskMemoryAllocationCount + statistics.TaskMemoryReuseCount, TaskCount
+    );
+
+    // One in every few tasks is timed, each timed task lands in both histograms once
+    std::size_t queueWaitSampleCount = 0;
+    std::size_t executionTimeSampleCount = 0;
+    for(std::size_t bucket = 0; bucket < ThreadPool::Statistics::HistogramBucketCount; ++bucket) {
+      queueWaitSampleCount += statistics.QueueWaitHistogram[bucket];
+      executionTimeSampleCount += statistics.ExecutionTimeHistogram[bucket];
+    }
+    EXPECT_GT(queueWaitSampleCount, 0U);
+    EXPECT_EQ(queueWaitSampleCount, executionTimeSampleCount);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ThreadPoolTest, StatisticsNeverReportMoreTasksThanSubmitted) {
+    ThreadPool testPool(4, 4);
+
+    const std::size_t SubmitterCount = 4;
+    const std::size_t TasksPerSubmitter = 2000;
+    const std::size_t TotalTaskCount = SubmitterCount * TasksPerSubmitter;
+
+    // Each submitter posts some tasks from its own thread and lets the tasks post
+    // more tasks from inside the pool, covering both the shared queues and the deques
+    std::atomic<std::size_t> executedTaskCount(0);
+    std::atomic<std::size_t> finishedSubmitterCount(0);
+    std::vector<std::thread> submitters;
+    for(std::size_t submitterIndex = 0; submitterIndex < SubmitterCount; ++submitterIndex) {
+      submitters.emplace_back(
+        [&testPool, &executedTaskCount, &finishedSubmitterCount] {
+          for(std::size_t index = 0; index < TasksPerSubmitter; index += 2) {
+            testPool.Post(
+              [&testPool, &executedTaskCount] {
+                testPool.Post(
+                  [&executedTaskCount] {
+                    executedTaskCount.fetch_add(1, std::memory_order_relaxed);
+                  }
+                );
+                executedTaskCount.fetch_add(1, std::memory_order_relaxed);
+              }
+            );
+          }
+          finishedSubmitterCount.fetch_add(1, std::memory_order_release);
+        }
+      );
+    }
+
+    // Read the statistics while the tasks are being submitted and executed. A task
+    // that finishes before it was counted would make the counts wrap around.
+    std::size_t largestQueuedTaskCount = 0;
+    std::size_t largestTaskCount = 0;
+    for(;;) {
+      bool isFinished = (
+        (finishedSubmitterCount.load(std::memory_order_acquire) == SubmitterCount) &&
+        (executedTaskCount.load(std::memory_order_relaxed) == TotalTaskCount)
+      );
+
+      ThreadPool::Statistics statistics = testPool.GetStatistics();
+      largestQueuedTaskCount = std::max(largestQueuedTaskCount, statistics.QueuedTaskCount);
+      largestTaskCount = std::max(
+        largestTaskCount, statistics.QueuedTaskCount + statistics.RunningTaskCount
+      );
+
+      if(isFinished) {
+        break;
+      }
+    }
+
+    for(std::thread &submitter : submitters) {
+      submitter.join();
+    }
+
+    EXPECT_EQ(executedTaskCount.load(), TotalTaskCount);
+    EXPECT_LE(largestQueuedTaskCount, TotalTaskCount);
+    EXPECT_LE(largestTaskCount, TotalTaskCount);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ThreadPoolTest, CanceledTasksAreDroppedWithoutRunning) {
+    ThreadPool testPool(1, 1);
+
+    // Keep the only worker thread busy so the following tasks stay in the queue
+    Gate releaseGate;
+    Gate blockingTaskStarted;
+    testPool.Post(
+      [&releaseGate, &blockingTaskStarted] {
+        blockingTaskStarted.Open();
+        releaseGate.Wait();
+      }
+    );
+    blockingTaskStarted.Wait();
+
+    std::shared_ptr<StopSource> canceledSource = StopSource::Create();
+    std::shared_ptr<StopSource> activeSource = StopSource::Create();
+
+    std::atomic<int> canceledRunCount(0);
+    std::atomic<int> activeRunCount(0);
+    testPool.PostWithStopToken(
+      canceledSource->GetToken(),
+      [&canceledRunCount] { canceledRunCount.fetch_add(1, std::memory_order_relaxed); }
+    );
+    std::future<int> canceledResult = testPool.ScheduleWithStopToken(
+      canceledSource->GetToken(),
+      [&canceledRunCount] { canceledRunCount.fetch_add(1); return 1; }
+    );
+    std::future<int> activeResult = testPool.ScheduleWithStopToken(
+      activeSource->GetToken(),
+      [&activeRunCount] { activeRunCount.fetch_add(1); return 2; }
+    );
+
+    canceledSource->Cancel();
+    releaseGate.Open();
+
+    EXPECT_EQ(activeResult.get(), 2);
+    EXPECT_THROW(canceledResult.get(), std::future_error);
+    EXPECT_EQ(canceledRunCount.load(), 0);
+    EXPECT_EQ(activeRunCount.load(), 1);
+
+    // The counters are updated after the task returns, so wait for them to catch up
+    ThreadPool::Statistics statistics;
+    for(std::size_t attempt = 0; attempt < 1000; ++attempt) {
+      statistics = testPool.GetStatistics();
+      if(statistics.CompletedTaskCount >= 2) {
+        break;
+      }
+      Thread::Sleep(std::chrono::microseconds(1000));
+    }
+    EXPECT_EQ(statistics.CompletedTaskCount, 2U);
+    EXPECT_EQ(statistics.CanceledTaskCount, 2U);
+    EXPECT_EQ(statistics.QueuedTaskCount, 0U);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ThreadPoolTest, DelayedTaskRunsAfterItsDelay) {
+    ThreadPool testPool(1, 1);
+
+    Gate finishedGate;
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point runTime;
+    ThreadPool::Timer timer = testPool.ScheduleAfter(
+      std::chrono::microseconds(20000),
+      [&finishedGate, &runTime] {
+        runTime = std::chrono::steady_clock::now();
+        finishedGate.Open();
+      }
+    );
+    EXPECT_TRUE(timer.IsPending());
+
+    ASSERT_TRUE(finishedGate.WaitFor(std::chrono::microseconds(5000000)));
+    EXPECT_GE(runTime - startTime, std::chrono::microseconds(20000));
+    EXPECT_FALSE(timer.IsPending());
+    EXPECT_FALSE(timer.Cancel());
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ThreadPoolTest, CanceledDelayedTaskDoesNotRun) {
+    ThreadPool testPool(1, 1);
+
+    std::atomic<int> canceledRunCount(0);
+    ThreadPool::Timer canceledTimer = testPool.ScheduleAfter(
+      std::chrono::microseconds(10000),
+      [&canceledRunCount] { canceledRunCount.fetch_add(1); }
+    );
+
+    Gate finishedGate;
+    testPool.ScheduleAfter(
+      std::chrono::microseconds(30000), [&finishedGate] { finishedGate.Open(); }
+    );
+
+    EXPECT_TRUE(canceledTimer.Cancel());
+    EXPECT_FALSE(canceledTimer.Cancel());
+    EXPECT_FALSE(canceledTimer.IsPending());
+
+    ASSERT_TRUE(finishedGate.WaitFor(std::chrono::microseconds(5000000)));
+    EXPECT_EQ(canceledRunCount.load(), 0);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ThreadPoolTest, PeriodicTaskRunsUntilCanceled) {
+    ThreadPool testPool(1, 1);
+
+    std::atomic<int> runCount(0);
+    Gate thirdRunGate;
+    ThreadPool::Timer timer = testPool.ScheduleEvery(
+      std::chrono::microseconds(2000),
+      [&runCount, &thirdRunGate] {
+        if(runCount.fetch_add(1) == 2) {
+          thirdRunGate.Open();
+        }
+      }
+    );
+
+    ASSERT_TRUE(thirdRunGate.WaitFor(std::chrono::microseconds(5000000)));
+    EXPECT_TRUE(timer.Cancel());
+
+    // An execution may have been posted just before the cancellation, but
+    // it will have been dropped or finished by the time this task runs
+    Gate flushedGate;
+    Thread::Sleep(std::chrono::microseconds(10000));
+    testPool.Post([&flushedGate] { flushedGate.Open(); });
+    flushedGate.Wait();
+
+    int runCountAfterCancel = runCount.load();
+    Thread::Sleep(std::chrono::microseconds(10000));
+    EXPECT_EQ(runCount.load(), runCountAfterCancel);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ThreadPoolTest, PendingTimersAreDiscardedOnShutdown) {
+    ThreadPool::Timer timer;
+    std::atomic<int> runCount(0);
+    {
+      ThreadPool testPool(1, 1);
+      timer = testPool.ScheduleAfter(
+        std::chrono::microseconds(60000000), [&runCount] { runCount.fetch_add(1); }
+      );
+      EXPECT_TRUE(timer.IsPending());
+    }
+
+    EXPECT_FALSE(timer.IsPending());
+    EXPECT_FALSE(timer.Cancel());
+    EXPECT_EQ(runCount.load(), 0);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
 }}} // namespace Nuclex::Support::Threading
 
 #endif // defined(NUCLEX_SUPPORT_LINUX) || defined(NUCLEX_SUPPORT_WINDOWS)
@@ -0,0 +1,261 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the library is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_SUPPORT_SOURCE 1
+
+#include "../Source/Threading/ThreadPoolTimerWheel.h"
+
+#include <vector> // for std::vector
+#include <cstdint> // for std::uint64_t
+
+#include <gtest/gtest.h>
+
+namespace {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Timer as it will be linked into the timing wheel by the unit tests</summary>
+  struct TestTimer {
+
+    /// <summary>Previous timer in the same slot of the timing wheel</summary>
+    public: TestTimer *Previous;
+    /// <summary>Next timer in the same slot of the timing wheel</summary>
+    public: TestTimer *Next;
+    /// <summary>Tick at which the timer is due</summary>
+    public: std::uint64_t DueTick;
+    /// <summary>Index of the slot the timer is linked into</summary>
+    public: std::size_t SlotIndex;
+    /// <summary>Tick at which the timer was reported as expired</summary>
+    public: std::uint64_t ExpiredTick;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Timing wheel holding test timers</summary>
+  typedef Nuclex::Support::Threading::ThreadPoolTimerWheel<TestTimer> TestWheel;
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Prepares a timer to be inserted into the timing wheel</summary>
+  /// <param name="timer">Timer that will be prepared</param>
+  /// <param name="dueTick">Tick at which the timer will be due</param>
+  void initializeTimer(TestTimer &timer, std::uint64_t dueTick) {
+    timer.Previous = nullptr;
+    timer.Next = nullptr;
+    timer.DueTick = dueTick;
+    timer.SlotIndex = TestWheel::Unlinked;
+    timer.ExpiredTick = TestWheel::Never;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Counts the timers in a list of expired timers and records the tick</summary>
+  /// <param name="expired">List of expired timers returned by the wheel</param>
+  /// <param name="tick">Tick that will be recorded as the expiration tick</param>
+  /// <returns>The number of timers in the list</returns>
+  std::size_t recordExpiredTimers(TestTimer *expired, std::uint64_t tick) {
+    std::size_t count = 0;
+    while(expired != nullptr) {
+      expired->ExpiredTick = tick;
+      expired = expired->Next;
+      ++count;
+    }
+    return count;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // anonymous namespace
+
+namespace Nuclex { namespace Support { namespace Threading {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ThreadPoolTimerWheelTest, NewWheelIsEmpty) {
+    TestWheel wheel(123);
+    EXPECT_TRUE(wheel.IsEmpty());
+    EXPECT_EQ(wheel.Count(), 0U);
+    EXPECT_EQ(wheel.GetCurrentTick(), 123U);
+    EXPECT_EQ(wheel.GetNextEventTick(), TestWheel::Never);
+    EXPECT_EQ(wheel.Advance(1000000), nullptr);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ThreadPoolTimerWheelTest, TimerExpiresAtItsDueTick) {
+    TestWheel wheel;
+    TestTimer timer;
+    initializeTimer(timer, 10);
+    wheel.Insert(&timer);
+    EXPECT_EQ(wheel.Count(), 1U);
+    EXPECT_EQ(wheel.GetNextEventTick(), 10U);
+
+    EXPECT_EQ(wheel.Advance(9), nullptr);
+    EXPECT_EQ(wheel.Advance(10), &timer);
+    EXPECT_EQ(timer.SlotIndex, TestWheel::Unlinked);
+    EXPECT_TRUE(wheel.IsEmpty());
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ThreadPoolTimerWheelTest, OverdueTimerExpiresOnNextAdvance) {
+    TestWheel wheel(500);
+    TestTimer timer;
+    initializeTimer(timer, 100);
+    wheel.Insert(&timer);
+    EXPECT_EQ(timer.DueTick, 500U);
+    EXPECT_EQ(wheel.Advance(500), &timer);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ThreadPoolTimerWheelTest, DistantTimerCascadesDownToItsTick) {
+    TestWheel wheel(7);
+    TestTimer timer;
+    initializeTimer(timer, 7 + 5000000);
+    wheel.Insert(&timer);
+
+    // The wheel may need a few stops to move the timer down through the levels,
+    // but it must neither expire early nor skip the timer's due tick
+    std::uint64_t tick = wheel.GetNextEventTick();
+    std::size_t stopCount = 0;
+    while(tick < timer.DueTick) {
+      EXPECT_EQ(wheel.Advance(tick), nullptr);
+      tick = wheel.GetNextEventTick();
+      ++stopCount;
+    }
+    EXPECT_LT(stopCount, TestWheel::LevelCount);
+    EXPECT_EQ(tick, 7U + 5000000U);
+    EXPECT_EQ(wheel.Advance(tick), &timer);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ThreadPoolTimerWheelTest, RemovedTimerDoesNotExpire) {
+    TestWheel wheel;
+    TestTimer first, second, third;
+    initializeTimer(first, 100);
+    initializeTimer(second, 100);
+    initializeTimer(third, 100);
+    wheel.Insert(&first);
+    wheel.Insert(&second);
+    wheel.Insert(&third);
+
+    wheel.Remove(&second);
+    EXPECT_EQ(second.SlotIndex, TestWheel::Unlinked);
+    EXPECT_EQ(wheel.Count(), 2U);
+
+    EXPECT_EQ(recordExpiredTimers(wheel.Advance(100), 100), 2U);
+    EXPECT_EQ(first.ExpiredTick, 100U);
+    EXPECT_EQ(second.ExpiredTick, TestWheel::Never);
+    EXPECT_EQ(third.ExpiredTick, 100U);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ThreadPoolTimerWheelTest, ClearReturnsAllTimers) {
+    TestWheel wheel;
+    TestTimer near, far;
+    initializeTimer(near, 3);
+    initializeTimer(far, 3000000000ULL);
+    wheel.Insert(&near);
+    wheel.Insert(&far);
+
+    EXPECT_EQ(recordExpiredTimers(wheel.Clear(), 0), 2U);
+    EXPECT_TRUE(wheel.IsEmpty());
+    EXPECT_EQ(wheel.GetNextEventTick(), TestWheel::Never);
+    EXPECT_EQ(near.SlotIndex, TestWheel::Unlinked);
+    EXPECT_EQ(far.SlotIndex, TestWheel::Unlinked);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ThreadPoolTimerWheelTest, MillionTimersExpireExactlyOnTime) {
+    const std::size_t TimerCount = 1000000;
+    std::vector<TestTimer> timers(TimerCount);
+
+    // Spread the timers over a wide range of ticks using a cheap pseudo-random sequence
+    TestWheel wheel(42);
+    std::uint64_t random = 0x9E3779B97F4A7C15ULL;
+    for(std::size_t index = 0; index < TimerCount; ++index) {
+      random ^= random << 13;
+      random ^= random >> 7;
+      random ^= random << 17;
+      initializeTimer(timers[index], 42 + (random % 10000000));
+      wheel.Insert(&timers[index]);
+    }
+    EXPECT_EQ(wheel.Count(), TimerCount);
+
+    // Cancel every other timer
+    for(std::size_t index = 0; index < TimerCount; index += 2) {
+      wheel.Remove(&timers[index]);
+    }
+    EXPECT_EQ(wheel.Count(), TimerCount / 2);
+
+    // Advance in uneven steps, the wheel must report each timer on its due tick
+    std::size_t expiredCount = 0;
+    for(;;) {
+      std::uint64_t tick = wheel.GetNextEventTick();
+      if(tick == TestWheel::Never) {
+        break;
+      }
+      expiredCount += recordExpiredTimers(wheel.Advance(tick), tick);
+    }
+    EXPECT_EQ(expiredCount, TimerCount / 2);
+
+    std::size_t mismatchCount = 0;
+    for(std::size_t index = 0; index < TimerCount; ++index) {
+      if((index % 2) == 0) {
+        mismatchCount += (timers[index].ExpiredTick == TestWheel::Never) ? 0 : 1;
+      } else {
+        mismatchCount += (timers[index].ExpiredTick == timers[index].DueTick) ? 0 : 1;
+      }
+    }
+    EXPECT_EQ(mismatchCount, 0U);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ThreadPoolTimerWheelTest, AdvancingPastDueTicksStillExpiresTimers) {
+    TestWheel wheel;
+    std::vector<TestTimer> timers(1000);
+    for(std::size_t index = 0; index < timers.size(); ++index) {
+      initializeTimer(timers[index], index * 97);
+      wheel.Insert(&timers[index]);
+    }
+
+    // Jump in large steps, timers due in between expire with the next step
+    std::size_t expiredCount = 0;
+    for(std::uint64_t tick = 0; tick < 100000; tick += 4999) {
+      expiredCount += recordExpiredTimers(wheel.Advance(tick), tick);
+    }
+    expiredCount += recordExpiredTimers(wheel.Advance(100000), 100000);
+    EXPECT_EQ(expiredCount, timers.size());
+
+    for(std::size_t index = 0; index < timers.size(); ++index) {
+      EXPECT_GE(timers[index].ExpiredTick, timers[index].DueTick);
+      EXPECT_LT(timers[index].ExpiredTick, timers[index].DueTick + 4999);
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Threading
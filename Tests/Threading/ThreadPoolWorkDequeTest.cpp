@@ -0,0 +1,168 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Native Framework
+Copyright (C) 2002-2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the library is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_SUPPORT_SOURCE 1
+
+#include "../Source/Threading/ThreadPoolWorkDeque.h"
+
+#include <atomic> // for std::atomic
+#include <thread> // for std::thread
+#include <vector> // for std::vector
+
+#include <gtest/gtest.h>
+
+namespace Nuclex { namespace Support { namespace Threading {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ThreadPoolWorkDequeTest, HasDefaultConstructor) {
+    EXPECT_NO_THROW(
+      ThreadPoolWorkDeque<int *> deque;
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ThreadPoolWorkDequeTest, NewDequeIsEmpty) {
+    ThreadPoolWorkDeque<std::size_t> deque;
+    EXPECT_TRUE(deque.IsEmpty());
+    EXPECT_EQ(deque.CountApproximately(), 0U);
+
+    std::size_t element;
+    EXPECT_FALSE(deque.TryPop(element));
+    EXPECT_FALSE(deque.TrySteal(element));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ThreadPoolWorkDequeTest, PopTakesNewestElement) {
+    ThreadPoolWorkDeque<std::size_t> deque;
+    deque.Push(1);
+    deque.Push(2);
+    deque.Push(3);
+    EXPECT_EQ(deque.CountApproximately(), 3U);
+
+    std::size_t element;
+    ASSERT_TRUE(deque.TryPop(element));
+    EXPECT_EQ(element, 3U);
+    ASSERT_TRUE(deque.TryPop(element));
+    EXPECT_EQ(element, 2U);
+    ASSERT_TRUE(deque.TryPop(element));
+    EXPECT_EQ(element, 1U);
+    EXPECT_FALSE(deque.TryPop(element));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ThreadPoolWorkDequeTest, StealTakesOldestElement) {
+    ThreadPoolWorkDeque<std::size_t> deque;
+    deque.Push(1);
+    deque.Push(2);
+    deque.Push(3);
+
+    std::size_t element;
+    ASSERT_TRUE(deque.TrySteal(element));
+    EXPECT_EQ(element, 1U);
+    ASSERT_TRUE(deque.TrySteal(element));
+    EXPECT_EQ(element, 2U);
+    ASSERT_TRUE(deque.TryPop(element));
+    EXPECT_EQ(element, 3U);
+    EXPECT_TRUE(deque.IsEmpty());
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ThreadPoolWorkDequeTest, DequeGrowsWhenFull) {
+    ThreadPoolWorkDeque<std::size_t> deque(4);
+    for(std::size_t index = 0; index < 100; ++index) {
+      deque.Push(index);
+    }
+    EXPECT_EQ(deque.CountApproximately(), 100U);
+
+    std::size_t element;
+    for(std::size_t index = 0; index < 50; ++index) {
+      ASSERT_TRUE(deque.TrySteal(element));
+      EXPECT_EQ(element, index);
+    }
+    for(std::size_t index = 100; index > 50; --index) {
+      ASSERT_TRUE(deque.TryPop(element));
+      EXPECT_EQ(element, index - 1);
+    }
+    EXPECT_TRUE(deque.IsEmpty());
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ThreadPoolWorkDequeTest, ElementsAreTakenExactlyOnceUnderContention) {
+    const std::size_t ElementCount = 100000;
+    const std::size_t ThiefCount = 3;
+
+    ThreadPoolWorkDeque<std::size_t> deque(16);
+    std::vector<std::atomic<std::size_t>> takeCounts(ElementCount);
+    for(std::size_t index = 0; index < ElementCount; ++index) {
+      takeCounts[index].store(0, std::memory_order_relaxed);
+    }
+
+    // Thieves keep stealing until the owner has pushed and popped everything
+    std::atomic<bool> ownerFinished(false);
+    std::vector<std::thread> thieves;
+    for(std::size_t index = 0; index < ThiefCount; ++index) {
+      thieves.emplace_back(
+        [&deque, &takeCounts, &ownerFinished] {
+          std::size_t element;
+          while(!ownerFinished.load(std::memory_order_acquire) || !deque.IsEmpty()) {
+            if(deque.TrySteal(element)) {
+              takeCounts[element].fetch_add(1, std::memory_order_relaxed);
+            }
+          }
+        }
+      );
+    }
+
+    // The owner pushes elements and pops every third one, racing with the thieves
+    {
+      std::size_t element;
+      for(std::size_t index = 0; index < ElementCount; ++index) {
+        deque.Push(index);
+        if((index % 3) == 0) {
+          if(deque.TryPop(element)) {
+            takeCounts[element].fetch_add(1, std::memory_order_relaxed);
+          }
+        }
+      }
+      while(deque.TryPop(element)) {
+        takeCounts[element].fetch_add(1, std::memory_order_relaxed);
+      }
+      ownerFinished.store(true, std::memory_order_release);
+    }
+
+    for(std::size_t index = 0; index < ThiefCount; ++index) {
+      thieves[index].join();
+    }
+
+    // Each element must have been taken by exactly one thread
+    for(std::size_t index = 0; index < ElementCount; ++index) {
+      ASSERT_EQ(takeCounts[index].load(std::memory_order_relaxed), 1U);
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+}}} // namespace Nuclex::Support::Threading
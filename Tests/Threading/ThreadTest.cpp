@@ -26,6 +26,7 @@ limitations under the License.
 
 #include <thread>
 #include <atomic>
+#include <stdexcept>
 
 namespace Nuclex { namespace Support { namespace Threading {
 
@@ -204,4 +205,94 @@ namespace Nuclex { namespace Support { namespace Threading {
 
   // ------------------------------------------------------------------------------------------- //
 
+  TEST(ThreadTest, CpuSetAffinityMatchesAffinityMask) {
+    std::uint64_t affinityMask = 0;
+    CpuSet affinity;
+    {
+      std::thread otherThread(
+        [&] {
+          affinityMask = Thread::GetCpuAffinityMask();
+          affinity = Thread::GetCpuAffinity();
+        }
+      );
+      otherThread.join();
+    }
+
+    EXPECT_FALSE(affinity.IsEmpty());
+    EXPECT_EQ(affinity.ToMask(), affinityMask);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ThreadTest, OwnCpuSetAffinityCanBeChanged) {
+    CpuSet unchangedAffinity, testedAffinity, changedAffinity;
+
+    {
+      std::thread otherThread(
+        [&] {
+          unchangedAffinity = Thread::GetCpuAffinity();
+
+          // Pick the highest CPU the thread is allowed to run on
+          testedAffinity.Add(unchangedAffinity.GetUpperBound() - 1);
+
+          Thread::SetCpuAffinity(testedAffinity);
+          changedAffinity = Thread::GetCpuAffinity();
+        }
+      );
+      otherThread.join();
+    }
+
+    EXPECT_EQ(changedAffinity, testedAffinity);
+    EXPECT_EQ(changedAffinity.Count(), 1U);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ThreadTest, OtherThreadsCpuSetAffinityCanBeChanged) {
+    CpuSet unchangedAffinity, testedAffinity, changedAffinity;
+
+    {
+      std::atomic<bool> spinRelease = false;
+      std::thread otherThread(
+        [&] { while(spinRelease.load(std::memory_order_consume) == false) {} }
+      );
+
+      std::uintptr_t otherThreadId = Thread::GetStdThreadId(otherThread);
+      unchangedAffinity = Thread::GetCpuAffinity(otherThreadId);
+      testedAffinity.Add(unchangedAffinity.GetIndices().front());
+      Thread::SetCpuAffinity(otherThreadId, testedAffinity);
+      changedAffinity = Thread::GetCpuAffinity(otherThreadId);
+
+      spinRelease.store(true, std::memory_order_release);
+      otherThread.join();
+    }
+
+    EXPECT_EQ(changedAffinity, testedAffinity);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(ThreadTest, EmptyCpuSetAffinityIsRejected) {
+    CpuSet unchangedAffinity, changedAffinity;
+
+    {
+      std::thread otherThread(
+        [&] {
+          unchangedAffinity = Thread::GetCpuAffinity();
+          EXPECT_THROW(Thread::SetCpuAffinity(CpuSet()), std::invalid_argument);
+          changedAffinity = Thread::GetCpuAffinity();
+        }
+      );
+
+      std::uintptr_t otherThreadId = Thread::GetStdThreadId(otherThread);
+      EXPECT_THROW(Thread::SetCpuAffinity(otherThreadId, CpuSet()), std::invalid_argument);
+
+      otherThread.join();
+    }
+
+    EXPECT_EQ(changedAffinity, unchangedAffinity);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
 }}} // namespace Nuclex::Support::Threading